@@ -0,0 +1,101 @@
+# Run the casstcl benchmarks.
+#
+#     tclsh benchmarks/all.tcl ?-match pattern? ?-output file? ?-offline?
+#         ?-passes count? ?-scale multiplier?
+#
+# Each *.bench file in this directory whose name matches the pattern, "*"
+# by default, is run in a tclsh of its own and its measurements are printed
+# as they are made, one line each (see bench.tcl), and also written to the
+# output file if one is given.  With -offline only the benchmarks that don't
+# need a cluster are run; the others are also skipped, with a comment line
+# saying so, if the cluster can't be reached.
+#
+# The output of two runs can be compared with compare.tcl.  "make bench"
+# runs this against the casstcl just built, passing it $(BENCHFLAGS).
+#
+# See the file "license.terms" for information on usage and redistribution
+# of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+
+proc usage {} {
+  puts stderr "usage: $::argv0 ?-match pattern? ?-output file? ?-offline?\
+      ?-passes count? ?-scale multiplier?"
+  exit 1
+}
+
+set directory [file normalize [file dirname [info script]]]
+set pattern *
+set outputFile ""
+
+while {[llength $argv] > 0} {
+  set argv [lassign $argv option]
+  switch -- $option {
+    -offline {
+      set env(CASSTCL_BENCH_OFFLINE) 1
+      continue
+    }
+    -match - -output - -passes - -scale {
+      if {[llength $argv] == 0} then {
+        usage
+      }
+      set argv [lassign $argv value]
+    }
+    default {
+      usage
+    }
+  }
+
+  switch -- $option {
+    -match {
+      set pattern $value
+    }
+    -output {
+      set outputFile $value
+    }
+    -passes {
+      set env(CASSTCL_BENCH_PASSES) $value
+    }
+    -scale {
+      set env(CASSTCL_BENCH_SCALE) $value
+    }
+  }
+}
+
+set out ""
+if {$outputFile ne ""} then {
+  set out [open $outputFile w]
+}
+
+set header [list "# casstcl benchmarks" [clock format [clock seconds] \
+    -format "%Y-%m-%dT%H:%M:%S"] "tcl [info patchlevel]" \
+    "$tcl_platform(os) $tcl_platform(machine)"]
+puts [join $header ", "]
+if {$out ne ""} then {
+  puts $out [join $header ", "]
+}
+
+set status 0
+
+foreach file [lsort [glob -nocomplain -directory $directory -tails \
+    $pattern.bench]] {
+  puts "# $file"
+
+  set channel [open |[list [info nameofexecutable] \
+      [file join $directory $file] 2>@1]]
+  while {[gets $channel line] >= 0} {
+    puts $line
+    if {$out ne "" && [string match "name *" $line]} then {
+      puts $out $line
+    }
+  }
+
+  if {[catch {close $channel} errMsg]} then {
+    puts "# $file failed: $errMsg"
+    set status 1
+  }
+}
+
+if {$out ne ""} then {
+  close $out
+}
+
+exit $status
@@ -0,0 +1,166 @@
+# Support procedures shared by the benchmarks.
+#
+# Each *.bench file in this directory sources this file and then times one
+# area of casstcl with bench::measure, which prints one line per
+# measurement.  A line is a list of key value pairs:
+#
+#     name convert.int ops 100000 us 812 ns_per_op 8.12 passes 3
+#
+# "name" identifies the measurement, "ops" is the number of operations
+# (values, rows, statements or requests) timed, "us" is the best elapsed
+# time in microseconds of "passes" runs and "ns_per_op" is that time per
+# operation.  Other lines start with "#" and are comments.
+#
+# These environment variables control the benchmarks:
+#
+#     CASSTCL_BENCH_PASSES   how many times to run each measurement, the
+#                            best time being reported (default 3)
+#     CASSTCL_BENCH_SCALE    a multiplier on the number of operations of
+#                            each measurement (default 1)
+#     CASSTCL_BENCH_OFFLINE  if true, skip the benchmarks needing a cluster
+#
+# The server, port and credentials are taken from the same environment
+# variables as the tests: CASSTCL_CONTACT_POINTS, CASSTCL_PORT,
+# CASSTCL_USERNAME and CASSTCL_PASSWORD.
+#
+# See the file "license.terms" for information on usage and redistribution
+# of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+
+package require casstcl
+
+# ::casstcl::benchmark isn't part of the package itself; it is added by an
+# entry point of its own in the casstcl library
+foreach loaded [info loaded] {
+  if {[lindex $loaded 1] eq "Casstcl"} then {
+    load [lindex $loaded 0] Casstcl_bench
+    break
+  }
+}
+unset -nocomplain loaded
+
+namespace eval ::bench {
+  variable passes
+  variable scale
+}
+
+proc ::bench::getEnvVar { name default } {
+  if {[info exists ::env($name)]} then {
+    return $::env($name)
+  }
+  return $default
+}
+
+set ::bench::passes [::bench::getEnvVar CASSTCL_BENCH_PASSES 3]
+set ::bench::scale [::bench::getEnvVar CASSTCL_BENCH_SCALE 1]
+
+#
+# scaled - the number of operations a benchmark should do, given the number
+#   it does at a scale of 1
+#
+proc ::bench::scaled { count } {
+  return [expr {max(1, int($count * $::bench::scale))}]
+}
+
+#
+# report - print the line for a measurement
+#
+proc ::bench::report { name ops us } {
+  puts [list name $name ops $ops us $us \
+      ns_per_op [format %.2f [expr {$ops > 0 ? $us * 1000.0 / $ops : 0.0}]] \
+      passes $::bench::passes]
+  flush stdout
+}
+
+#
+# measure - run script in the caller's scope passes times, and report the
+#   best of the times as that of ops operations
+#
+proc ::bench::measure { name ops script } {
+  set best ""
+  for {set pass 0} {$pass < $::bench::passes} {incr pass} {
+    set us [lindex [time {uplevel 1 $script}] 0]
+    if {$best eq "" || $us < $best} then {
+      set best $us
+    }
+  }
+  report $name $ops $best
+}
+
+#
+# measure_conversion - time ::casstcl::benchmark, which does its own
+#   timing, reporting the best pass.  The arguments are those of the
+#   subcommand: a type and a list of values for bind, a session and a
+#   query for convert
+#
+proc ::bench::measure_conversion { name subcommand arg1 arg2 iterations } {
+  set best ""
+  for {set pass 0} {$pass < $::bench::passes} {incr pass} {
+    set result [::casstcl::benchmark $subcommand $arg1 $arg2 $iterations]
+    if {$best eq "" || [dict get $result us] < $best} then {
+      set best [dict get $result us]
+    }
+  }
+  report $name [dict get $result conversions] $best
+}
+
+#
+# skip - say why a benchmark isn't being run, and stop it
+#
+proc ::bench::skip { reason } {
+  puts "# skipped [file tail [info script]]: $reason"
+  exit 0
+}
+
+#
+# connect - return a new session connected to the cluster, or skip the
+#   benchmark if running offline or the cluster can't be reached
+#
+proc ::bench::connect {} {
+  if {[string is true -strict [getEnvVar CASSTCL_BENCH_OFFLINE 0]]} then {
+    skip "needs a cluster"
+  }
+
+  set cass [::casstcl::cass create #auto]
+  $cass contact_points [getEnvVar CASSTCL_CONTACT_POINTS 127.0.0.1]
+  $cass port [getEnvVar CASSTCL_PORT 9042]
+  if {[getEnvVar CASSTCL_USERNAME ""] ne ""} then {
+    $cass credentials [getEnvVar CASSTCL_USERNAME ""] \
+        [getEnvVar CASSTCL_PASSWORD ""]
+  }
+
+  if {[catch {$cass connect} errMsg]} then {
+    $cass delete
+    skip "can't connect: $errMsg"
+  }
+  return $cass
+}
+
+#
+# create_keyspace - create a scratch keyspace for a benchmark and return its
+#   name
+#
+proc ::bench::create_keyspace { cass name } {
+  set keyspace casstcl_bench_${name}_[pid]
+  $cass exec "CREATE KEYSPACE $keyspace WITH REPLICATION = {\
+      'class' : 'SimpleStrategy', 'replication_factor' : 1 }"
+  return $keyspace
+}
+
+#
+# finish - drop the scratch keyspace and delete the session
+#
+proc ::bench::finish { cass keyspace } {
+  $cass exec "DROP KEYSPACE $keyspace"
+  $cass delete
+}
+
+#
+# drain - service events until none of the session's asynchronous requests
+#   are outstanding
+#
+proc ::bench::drain { cass } {
+  while {[dict get [$cass in_flight] current] > 0} {
+    after 1 [list set ::bench::tick 1]
+    vwait ::bench::tick
+  }
+}
@@ -0,0 +1,94 @@
+# Compare two runs of the casstcl benchmarks.
+#
+#     tclsh benchmarks/compare.tcl ?-threshold percent? baseline current
+#
+# baseline and current are files written by all.tcl -output.  For every
+# measurement in both, the nanoseconds per operation of the two are printed
+# along with the change between them.  Measurements that got slower by more
+# than the threshold, 10 percent by default, are marked as regressions and
+# make the exit status 1, so that this can be used to hold back a casstcl
+# build that slows a hot path down.  Measurements in only one of the files
+# are listed but don't count as regressions.
+#
+# See the file "license.terms" for information on usage and redistribution
+# of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+
+proc usage {} {
+  puts stderr "usage: $::argv0 ?-threshold percent? baseline current"
+  exit 2
+}
+
+#
+# read_results - read the measurements in a file into an array of
+#   nanoseconds per operation, by name
+#
+proc read_results { file _results } {
+  upvar $_results results
+
+  set channel [open $file]
+  while {[gets $channel line] >= 0} {
+    if {![string match "name *" $line]} then {
+      continue
+    }
+    set results([dict get $line name]) [dict get $line ns_per_op]
+  }
+  close $channel
+}
+
+set threshold 10.0
+if {[lindex $argv 0] eq "-threshold"} then {
+  if {[llength $argv] < 2 ||
+      ![string is double -strict [lindex $argv 1]]} then {
+    usage
+  }
+  set threshold [lindex $argv 1]
+  set argv [lrange $argv 2 end]
+}
+
+if {[llength $argv] != 2} then {
+  usage
+}
+
+lassign $argv baselineFile currentFile
+read_results $baselineFile baseline
+read_results $currentFile current
+
+set regressions 0
+set names [lsort -unique [concat [array names baseline] \
+    [array names current]]]
+
+foreach name $names {
+  if {![info exists baseline($name)]} then {
+    puts [format "%-32s %12s %12.2f  new" $name - $current($name)]
+    continue
+  }
+
+  if {![info exists current($name)]} then {
+    puts [format "%-32s %12.2f %12s  missing" $name $baseline($name) -]
+    continue
+  }
+
+  if {$baseline($name) > 0} then {
+    set change [expr {($current($name) - $baseline($name)) * 100.0 /
+        $baseline($name)}]
+  } else {
+    set change 0.0
+  }
+
+  set note ""
+  if {$change > $threshold} then {
+    set note "  REGRESSION"
+    incr regressions
+  }
+
+  puts [format "%-32s %12.2f %12.2f %+7.1f%%%s" $name $baseline($name) \
+      $current($name) $change $note]
+}
+
+if {$regressions > 0} then {
+  puts "$regressions of [llength $names] measurements regressed by more than\
+      $threshold%"
+  exit 1
+}
+
+exit 0
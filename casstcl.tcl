@@ -100,24 +100,15 @@ proc validator_to_type {validator} {
 }
 
 #
-# import_column_type_map - given a casstcl object, traverse the metadata
-#   identifying the keyspaces and, for each keyspace, the table and, for
-#   each table, the columns.  For eacch column write the keyspace, table,
-#   and column as the key of the columnTypeMap array with the textual
-#   type being the value.
+# import_column_type_map - given a casstcl object, have it traverse the
+#   metadata identifying the keyspaces and, for each keyspace, the table
+#   and, for each table, the columns, rebuilding the object's native column
+#   type map.  The columnTypeMap array is refilled as a mirror of it, the
+#   key being keyspace.table.column and the value being the textual type.
+#   casstcl itself does not consult the array.
 #
 proc import_column_type_map {obj} {
-	variable columnTypeMap
-
-	unset -nocomplain columnTypeMap
-
-	foreach keyspace [$obj keyspaces] {
-		foreach table [$obj tables $keyspace] {
-			foreach "column type" [$obj columns_with_types $keyspace $table] {
-				set columnTypeMap($keyspace.$table.$column) $type
-			}
-		}
-	}
+	$obj reimport_column_type_map
 }
 
 proc typeof {name {subType ""}} {
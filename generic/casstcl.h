@@ -28,16 +28,193 @@
 	(TCL_MAJOR_VERSION < 8) || ((TCL_MAJOR_VERSION == 8) && \
 	(TCL_MINOR_VERSION < 6))
 #  define Tcl_GetErrorLine(interp)	((interp)->errorLine)
+#else
+#  define CASSTCL_HAVE_NRE 1
+#endif
+
+/*
+ * NOTE: Some of the cpp-driver's features only exist in its later versions.
+ *       casstcl builds against the earlier ones too, reporting the features
+ *       they lack as errors when they are asked for.
+ */
+#define CASSTCL_DRIVER_AT_LEAST(major, minor) \
+	((CASS_VERSION_MAJOR > (major)) || ((CASS_VERSION_MAJOR == (major)) && \
+	(CASS_VERSION_MINOR >= (minor))))
+
+#if CASSTCL_DRIVER_AT_LEAST(2, 2)
+#  define CASSTCL_HAVE_SCHEMA_META 1
+#endif
+
+#if CASSTCL_DRIVER_AT_LEAST(2, 3)
+#  define CASSTCL_HAVE_PARAMETER_TYPES 1
+#endif
+
+#if CASSTCL_DRIVER_AT_LEAST(2, 5)
+#  define CASSTCL_HAVE_SPECULATIVE_EXECUTION 1
+#  define CASSTCL_HAVE_STATEMENT_REQUEST_TIMEOUT 1
+#endif
+
+#if CASSTCL_DRIVER_AT_LEAST(2, 10)
+#  define CASSTCL_HAVE_TRACING 1
 #endif
 
 #define CASS_SESSION_MAGIC 7138570
 #define CASS_FUTURE_MAGIC 71077345
 #define CASS_BATCH_MAGIC 14215469
 #define CASS_PREPARED_MAGIC 713832281
+#define CASS_SELECT_MAGIC 51277230
+#define CASS_PARTITIONED_BATCH_MAGIC 41277305
+#define CASS_COUNTER_ACCUMULATOR_MAGIC 60742153
 
 #define CASSTCL_FUTURE_QUEUE_HEAD_FLAG 1
 #define CASSTCL_FUTURE_CALLBACK_ON_ERROR_ONLY 2
 
+// internal flags of handle futures: the driver hasn't called back yet,
+// and the future was deleted before it did
+#define CASSTCL_FUTURE_CALLBACK_PENDING_FLAG 4
+#define CASSTCL_FUTURE_DELETED_FLAG 8
+
+// internal flags of futures whose request counts against the session's
+// in-flight window, and of those whose request is still on the session's
+// queue waiting for room in it
+#define CASSTCL_FUTURE_COUNTED_FLAG 16
+#define CASSTCL_FUTURE_QUEUED_FLAG 32
+
+// internal flag of handle futures made by await, whose callback resumes
+// the coroutine that is waiting for them
+#define CASSTCL_FUTURE_AWAIT_FLAG 64
+
+// internal flag of the future of a connect with -prepare, whose callback
+// waits for the statements of its manifest to be prepared
+#define CASSTCL_FUTURE_MANIFEST_FLAG 128
+
+// internal flag of futures with no callback of their own that are given
+// one by $future await, so that their completion wakes it up
+#define CASSTCL_FUTURE_WAKEUP_FLAG 256
+
+/*
+ * These say what async and exec -callback do when the session's in-flight
+ * window is full: wait in the event loop until there is room, or put the
+ * request on a queue to be executed when there is.
+ */
+#define CASSTCL_INFLIGHT_BLOCK 0
+#define CASSTCL_INFLIGHT_QUEUE 1
+
+/*
+ * These select how the rows of a result are delivered to Tcl: one row at
+ * a time into an array, or a whole page at a time as a list of lists or
+ * as a list of dicts.
+ */
+#define CASSTCL_ROWS_ARRAY 0
+#define CASSTCL_ROWS_LIST 1
+#define CASSTCL_ROWS_DICT 2
+
+/*
+ * A select given this as its page size pages adaptively, as set by its
+ * session's paging policy; see casstcl_paging.c.  These are the defaults of
+ * the policy: page sizes start at 100 rows and stay between 10 and 10000,
+ * aiming for pages of about a megabyte that come back within 200ms.
+ */
+#define CASSTCL_PAGING_ADAPTIVE -1
+
+#define CASSTCL_DEFAULT_PAGING_INITIAL_ROWS 100
+#define CASSTCL_DEFAULT_PAGING_MIN_ROWS 10
+#define CASSTCL_DEFAULT_PAGING_MAX_ROWS 10000
+#define CASSTCL_DEFAULT_PAGING_TARGET_BYTES 1048576
+#define CASSTCL_DEFAULT_PAGING_TARGET_LATENCY_MS 200
+
+/*
+ * This is the default number of distinct upsert statement shapes whose
+ * prepared statements are kept per session.  Setting the limit to zero
+ * disables the cache and upserts go back to using unprepared statements.
+ */
+#define CASSTCL_DEFAULT_PREPARED_CACHE_LIMIT 256
+
+/*
+ * This is the default number of future callbacks that are run each time
+ * the completions collected from the driver's threads are drained.  The
+ * rest wait for the next pass through the event loop so that other event
+ * sources get a turn.
+ */
+#define CASSTCL_DEFAULT_COMPLETION_BUDGET 1000
+
+/*
+ * Futures created with async -handle live in slots of a per-session slab
+ * instead of having a Tcl command each.  The slab grows by this many slots
+ * at a time and the slots never move, so the driver can be handed a
+ * pointer to one.
+ */
+#define CASSTCL_FUTURE_SLAB_CHUNK 256
+
+/*
+ * The load method keeps up to this many writes in flight unless told
+ * otherwise, and reports the first few rows it couldn't load.
+ */
+#define CASSTCL_LOAD_DEFAULT_WINDOW 128
+#define CASSTCL_LOAD_ERRORS_KEPT 10
+
+#define CASSTCL_LOAD_FORMAT_CSV 0
+#define CASSTCL_LOAD_FORMAT_TSV 1
+#define CASSTCL_LOAD_FORMAT_DICTLINES 2
+
+/*
+ * The export method pages through its query this many rows at a time
+ * unless told otherwise.
+ */
+#define CASSTCL_EXPORT_DEFAULT_PAGESIZE 1000
+
+#define CASSTCL_EXPORT_FORMAT_CSV 0
+#define CASSTCL_EXPORT_FORMAT_TSV 1
+#define CASSTCL_EXPORT_FORMAT_JSON 2
+
+/*
+ * The scan method queries this many token ranges at once unless told
+ * otherwise and, unless told how many ranges to cut the ring into, gives
+ * each of them this many ranges to work through.
+ */
+#define CASSTCL_SCAN_DEFAULT_PARALLELISM 8
+#define CASSTCL_SCAN_SPLITS_PER_STREAM 4
+
+/*
+ * The multiget method looks up this many keys at once unless told
+ * otherwise.
+ */
+#define CASSTCL_MULTIGET_DEFAULT_CONCURRENCY 32
+
+/*
+ * Driver log messages are put in a ring of this many slots (a power of
+ * two) by the driver's threads and taken out in batches by the thread
+ * that set the logging callback.  Messages logged while the ring is full
+ * are counted and dropped.
+ */
+#define CASSTCL_LOG_RING_SIZE 512
+
+/*
+ * The slow request log keeps this many of the slowest requests once it
+ * is turned on without saying how many.
+ */
+#define CASSTCL_SLOWLOG_DEFAULT_LIMIT 32
+
+/*
+ * Request statistics are kept separately for each kind of request.  Their
+ * latencies, in microseconds, go into log-linear histograms: values below
+ * 2^CASSTCL_STATS_SUB_BUCKET_BITS have a bucket each, and every power of
+ * two above that is split into that many buckets, which keeps each
+ * bucket within about 6% of the values in it.  Values from 2^40 us (about
+ * 12 days) up all go in the last bucket.
+ */
+#define CASSTCL_STATS_NONE -1
+#define CASSTCL_STATS_EXEC 0
+#define CASSTCL_STATS_ASYNC 1
+#define CASSTCL_STATS_SELECT 2
+#define CASSTCL_STATS_BATCH 3
+#define CASSTCL_STATS_COUNTER 4
+#define CASSTCL_STATS_KINDS 5
+
+#define CASSTCL_STATS_SUB_BUCKET_BITS 4
+#define CASSTCL_STATS_MAX_BITS 40
+#define CASSTCL_STATS_BUCKETS (((CASSTCL_STATS_MAX_BITS - CASSTCL_STATS_SUB_BUCKET_BITS) + 1) << CASSTCL_STATS_SUB_BUCKET_BITS)
+
 /*
  * This is the absolute limit on the whole number of seconds that we can
  * support for the Cassandra 'timestamp' data type normalization routines.
@@ -50,8 +227,14 @@
 #define CASS_TIMESTAMP_LOWER_LIMIT (-CASS_TIMESTAMP_UPPER_LIMIT)
 
 extern Tcl_ObjType casstcl_cassTypeTclType;
+extern Tcl_ObjType casstcl_futureHandleTclType;
+extern Tcl_ObjType casstcl_timestampTclType;
+extern Tcl_ObjType casstcl_uuidTclType;
+extern Tcl_ObjType casstcl_inetTclType;
+extern Tcl_ObjType casstcl_blobRefTclType;
 extern Tcl_Obj *casstcl_loggingCallbackObj;
 extern Tcl_ThreadId casstcl_loggingCallbackThreadId;
+extern int casstcl_loggingCallbackList;
 /*
 ** NOTE: The types in this section were "borrowed" from version 1.0 of the
 **       cpp-driver.
@@ -81,6 +264,421 @@ typedef struct casstcl_cassTypeInfo {
 	CassValueType valueSubType2;
 } casstcl_cassTypeInfo;
 
+/*
+ * The schema metadata maintained by the driver.  Before version 2.2 of the
+ * cpp-driver keyspaces, tables and columns were all described by a
+ * CassSchemaMeta, with their properties in fields named after the columns
+ * of the system tables; from 2.2 each has a type of its own.  The
+ * functions of casstcl_schema.c that read the metadata take whichever it
+ * is.
+ */
+#ifdef CASSTCL_HAVE_SCHEMA_META
+typedef CassSchemaMeta casstcl_schema;
+typedef CassKeyspaceMeta casstcl_keyspaceMeta;
+typedef CassTableMeta casstcl_tableMeta;
+typedef CassColumnMeta casstcl_columnMeta;
+#else
+typedef CassSchema casstcl_schema;
+typedef CassSchemaMeta casstcl_keyspaceMeta;
+typedef CassSchemaMeta casstcl_tableMeta;
+typedef CassSchemaMeta casstcl_columnMeta;
+#endif
+
+/*
+ * The column type map holds, for each keyspace, each table and, for each
+ * table, a descriptor for each of its columns, imported from the schema
+ * metadata maintained by the driver.  Tables are found by their fully
+ * qualified name (keyspace.table) and columns by their name within the
+ * table.  The columns of a table's partition key are also listed in key
+ * order; partitionKeyIndex is a column's position in the key, or -1.
+ */
+typedef struct casstcl_columnInfo
+{
+	char *name;
+	int index;
+	int typeStatus;
+	char *typeString;
+	casstcl_cassTypeInfo typeInfo;
+	int partitionKeyIndex;
+} casstcl_columnInfo;
+
+typedef struct casstcl_tableInfo
+{
+	char *keyspace;
+	char *name;
+	char *fullName;
+	int nColumns;
+	casstcl_columnInfo *columns;
+	Tcl_HashTable columnHash;
+	int nPartitionKeys;
+	casstcl_columnInfo **partitionKey;
+
+	// a descriptor may be held by the column type maps of several sessions
+	// sharing one driver session, on different threads, and by the shared
+	// session's cache of them.  it's freed when the last reference goes
+	// away, and is marked stale when a newer one replaces it in the cache
+	int refCount;
+	int stale;
+} casstcl_tableInfo;
+
+typedef struct casstcl_keyspaceInfo
+{
+	char *name;
+	Tcl_HashTable tableHash;
+} casstcl_keyspaceInfo;
+
+/*
+ * When lazy is set, tables aren't imported when the session connects but
+ * the first time they are looked up.  Either way, an entry in tableHash
+ * whose value is NULL marks a table that has been changed by a schema
+ * statement and must be reimported before it is next used.
+ */
+typedef struct casstcl_columnTypeMap
+{
+	Tcl_HashTable keyspaceHash;
+	Tcl_HashTable tableHash;
+	int lazy;
+} casstcl_columnTypeMap;
+
+/*
+ * One of these exists for each distinct statement shape held in a
+ * session's prepared statement cache.  Entries are kept on a doubly
+ * linked list in most recently used order so the least recently used
+ * one can be evicted when the cache is full.
+ */
+typedef struct casstcl_preparedCacheEntry
+{
+	struct casstcl_preparedCacheEntry *prev;
+	struct casstcl_preparedCacheEntry *next;
+	Tcl_HashEntry *hashEntry;
+	const CassPrepared *prepared;
+} casstcl_preparedCacheEntry;
+
+/*
+ * The upserts into a table that are in flight, for the row cache, which
+ * doesn't read or keep rows of a table while any are.  pending counts
+ * the upserts made that haven't completed, or been thrown away without
+ * being executed; it is changed by whichever thread sees that happen.
+ * These are kept until the session is deleted, so that requests can
+ * hold on to them.
+ */
+typedef struct casstcl_tableWrites
+{
+	int pending;
+} casstcl_tableWrites;
+
+/*
+ * The tables a request writes to, one for each upsert in it, which it
+ * holds a pending write of until it completes.
+ */
+typedef struct casstcl_writeList
+{
+	casstcl_tableWrites **tables;
+	int count;
+} casstcl_writeList;
+
+/*
+ * The row cache holds the rows of selects made with -cache, converted to
+ * Tcl objects, so that repeating a point read doesn't go to the cluster.
+ * Entries are found by what was selected: the text of the statement, or
+ * the serial number of a prepared statement and the values bound to it,
+ * along with the form of the rows.  They are kept on a doubly linked list
+ * in most recently used order, so that the least recently used can be
+ * evicted to keep the cache within its byte limit, and on a list for the
+ * table they were read from, so that an upsert into the table can throw
+ * them away.  writeHash has the writes in flight of each table that has
+ * been upserted into.  A limit of zero turns the cache off.
+ */
+typedef struct casstcl_rowCacheEntry
+{
+	struct casstcl_rowCacheEntry *prev;
+	struct casstcl_rowCacheEntry *next;
+	struct casstcl_rowCacheEntry *tablePrev;
+	struct casstcl_rowCacheEntry *tableNext;
+	Tcl_HashEntry *hashEntry;
+	Tcl_HashEntry *tableEntry;
+	Tcl_Obj *columnsObj;
+	Tcl_Obj *rowsObj;
+	int bytes;
+	Tcl_WideInt expires;
+} casstcl_rowCacheEntry;
+
+typedef struct casstcl_rowCache
+{
+	Tcl_HashTable hashTable;
+	Tcl_HashTable tableHash;
+	Tcl_HashTable writeHash;
+	casstcl_rowCacheEntry *head;
+	casstcl_rowCacheEntry *tail;
+	Tcl_WideInt bytes;
+	Tcl_WideInt limit;
+	int ttl;
+	Tcl_WideInt hits;
+	Tcl_WideInt misses;
+	Tcl_WideInt stores;
+	Tcl_WideInt uncacheable;
+	Tcl_WideInt evictions;
+	Tcl_WideInt expirations;
+	Tcl_WideInt invalidations;
+} casstcl_rowCache;
+
+typedef struct casstcl_preparedCache
+{
+	Tcl_HashTable hashTable;
+	casstcl_preparedCacheEntry *head;
+	casstcl_preparedCacheEntry *tail;
+	int size;
+	int limit;
+	Tcl_WideInt hits;
+	Tcl_WideInt misses;
+	Tcl_WideInt evictions;
+} casstcl_preparedCache;
+
+struct casstcl_selectClientData;
+struct casstcl_futureClientData;
+
+/*
+ * A session's adaptive paging policy.  If enabled, selects made without
+ * -pagesize page adaptively as well as those made with -pagesize adaptive.
+ * A targetLatencyMS of zero means the page size isn't limited by latency.
+ */
+typedef struct casstcl_pagingPolicy
+{
+	int enabled;
+	int initialRows;
+	int minRows;
+	int maxRows;
+	Tcl_WideInt targetBytes;
+	int targetLatencyMS;
+} casstcl_pagingPolicy;
+
+/*
+ * What adaptive paging has done since the session's statistics were last
+ * reset: the selects and pages, the rows and bytes of the pages, the page
+ * size last chosen, the smallest and largest chosen, and how many times the
+ * page size went up and down.
+ */
+typedef struct casstcl_pagingStats
+{
+	Tcl_WideInt selects;
+	Tcl_WideInt pages;
+	Tcl_WideInt rows;
+	Tcl_WideInt bytes;
+	int lastSize;
+	int smallestSize;
+	int largestSize;
+	Tcl_WideInt grown;
+	Tcl_WideInt shrunk;
+} casstcl_pagingStats;
+
+/*
+ * The paging of one select.  pageSize is the page size of the next
+ * request, bytesPerRow the smoothed size of the rows seen so far and
+ * requestTime when the latest page was requested, in microseconds.
+ */
+typedef struct casstcl_pager
+{
+	int adaptive;
+	int pageSize;
+	double bytesPerRow;
+	Tcl_WideInt requestTime;
+} casstcl_pager;
+
+/*
+ * Something for the thread that runs the futures of a multiget or scan to
+ * sleep on until one of them is done.  The callback of each future being
+ * watched adds one to nReady and wakes the thread, which rechecks them;
+ * as a future can be taken before its callback has run, nReady may be
+ * more than the futures left to take.  The callbacks and the thread each
+ * hold a reference, and whichever is last frees it, since a future freed
+ * by the thread is still called back for.
+ */
+typedef struct casstcl_futureWaiter
+{
+	Tcl_Condition ready;
+	int nReady;
+	int refCount;
+} casstcl_futureWaiter;
+
+/*
+ * A page of results shared by the rows built from it and by any blob
+ * values that still point into it.  The result is freed when the last
+ * reference goes away.
+ */
+typedef struct casstcl_resultRef
+{
+	const CassResult *result;
+	int refCount;
+} casstcl_resultRef;
+
+/*
+ * The counters and latency histogram of one kind of request.  They are
+ * updated from the driver's threads as requests complete, with atomic
+ * operations and without a lock, so a snapshot of them taken while
+ * requests are completing may be off by the few that are in progress.
+ */
+typedef struct casstcl_requestStats
+{
+	Tcl_WideInt requests;
+	Tcl_WideInt errors;
+	Tcl_WideInt sourceErrors[4];
+	Tcl_WideInt timeouts;
+	Tcl_WideInt unavailable;
+	int inFlight;
+	int peakInFlight;
+	Tcl_WideInt latencyTotal;
+	Tcl_WideInt latencyMax;
+	Tcl_WideInt histogram[CASSTCL_STATS_BUCKETS];
+} casstcl_requestStats;
+
+/*
+ * What the slow request log says about a statement: its text, or that of
+ * the prepared statement it was bound from, and the consistency level it
+ * was given, or CASSTCL_CONSISTENCY_DEFAULT if it was left to the default.
+ * The text only has to last until the request is handed to the driver.
+ */
+#define CASSTCL_CONSISTENCY_DEFAULT -1
+
+typedef struct casstcl_statementInfo
+{
+	const char *text;
+	int consistency;
+} casstcl_statementInfo;
+
+/*
+ * What the slow request log keeps of a request while it is in flight,
+ * with a copy of its text after the structure, and whether tracing was
+ * turned on for it.
+ */
+typedef struct casstcl_slowlogRequest
+{
+	int consistency;
+	int traced;
+	char text[1];
+} casstcl_slowlogRequest;
+
+/*
+ * What's needed to record a request when it completes: the kind of
+ * request, which is CASSTCL_STATS_NONE for requests that aren't counted,
+ * and when it was handed to the driver, in microseconds.  request is
+ * NULL unless the slow request log is on.  writes are the upserts of the
+ * request, whose tables the row cache leaves alone until it completes.
+ */
+typedef struct casstcl_requestTimer
+{
+	struct casstcl_sessionClientData *ct;
+	int kind;
+	Tcl_WideInt startTime;
+	casstcl_slowlogRequest *request;
+	casstcl_writeList writes;
+} casstcl_requestTimer;
+
+/*
+ * The slow request log: the slowest limit requests since it was last
+ * reset, in no particular order.  Requests are added by whichever thread
+ * sees them complete, under the mutex, but floor, the latency of the
+ * fastest of them once there are limit of them, is read without it so
+ * that the rest don't have to take it.  A sampleRate above zero turns on
+ * tracing for that fraction of the requests timed, so that the slowest
+ * of them can be looked up in system_traces.  The coordinator of a
+ * traced entry is filled in from there once its trace has been written.
+ */
+typedef struct casstcl_slowlogEntry
+{
+	Tcl_WideInt latency;
+	Tcl_WideInt startTime;
+	int kind;
+	CassError rc;
+	int haveTracingId;
+	CassUuid tracingId;
+	int haveCoordinator;
+	CassInet coordinator;
+	casstcl_slowlogRequest *request;
+} casstcl_slowlogEntry;
+
+typedef struct casstcl_slowlog
+{
+	Tcl_Mutex mutex;
+	casstcl_slowlogEntry *entries;
+	int limit;
+	int count;
+	Tcl_WideInt floor;
+	double sampleRate;
+	unsigned int sampleSeed;
+	Tcl_WideInt seen;
+} casstcl_slowlog;
+
+/*
+ * A request made while the in-flight window was full in queue mode.  The
+ * future it belongs to has been created without a driver future; it gets
+ * one when the statement is executed.
+ */
+typedef struct casstcl_queuedRequest
+{
+	struct casstcl_queuedRequest *next;
+	CassStatement *statement;
+	struct casstcl_futureClientData *fcd;
+} casstcl_queuedRequest;
+
+/*
+ * A driver session published under a name so that session objects in
+ * other interpreters, on any thread, can attach to it instead of opening
+ * connections of their own.  Each object attached to it, including the one
+ * that published it, holds a reference, and the driver session is closed
+ * when the last one goes away.  The descriptors of the tables imported by
+ * any of them are kept in tableHash, by fully qualified name, for the
+ * others to use; complete says that the whole schema has been imported.
+ * The list of shared sessions is guarded by a global mutex and the tables
+ * of each by its own.
+ */
+typedef struct casstcl_sharedSession
+{
+	struct casstcl_sharedSession *next;
+	char *name;
+	int refCount;
+	CassCluster *cluster;
+	CassSession *session;
+	CassSsl *ssl;
+	Tcl_Mutex mutex;
+	Tcl_HashTable tableHash;
+	int complete;
+} casstcl_sharedSession;
+
+/*
+ * The statements given to connect -prepare, from when they are sent to be
+ * prepared until prepared objects have been made of them.  For a connect
+ * with -callback, pending counts the statements still being prepared, plus
+ * one while they are being sent; the driver thread that takes it to zero
+ * completes the connect future again, so that its callback runs.
+ */
+typedef struct casstcl_manifestStatement
+{
+	Tcl_Obj *nameObj;
+	Tcl_Obj *tableObj;
+	Tcl_Obj *statementObj;
+	CassFuture *future;
+} casstcl_manifestStatement;
+
+typedef struct casstcl_manifest
+{
+	struct casstcl_sessionClientData *ct;
+	struct casstcl_futureClientData *fcd;
+	casstcl_manifestStatement *statements;
+	int count;
+	int started;
+	int pending;
+} casstcl_manifest;
+
+/*
+ * What became of a statement of a connect manifest, by its name: the
+ * prepared object made of it, or the error preparing it.
+ */
+typedef struct casstcl_manifestEntry
+{
+	Tcl_Obj *commandObj;
+	Tcl_Obj *errorObj;
+} casstcl_manifestEntry;
+
 typedef struct casstcl_sessionClientData
 {
     int cass_session_magic;
@@ -91,6 +689,76 @@ typedef struct casstcl_sessionClientData
     Tcl_Command cmdToken;
 	Tcl_ThreadId threadId;
 	Tcl_Obj *loggingCallbackObj;
+	casstcl_preparedCache preparedCache;
+	casstcl_rowCache rowCache;
+	casstcl_columnTypeMap columnTypeMap;
+	struct casstcl_selectClientData *selectList;
+
+	// futures whose callbacks are ready to run.  the driver's threads
+	// push them onto completionStack without locking; the event source
+	// moves them from there, in order, onto the priority list (for
+	// -head) or the normal one, from which they are run in batches
+	struct casstcl_futureClientData *completionStack;
+	struct casstcl_futureClientData *priorityHead;
+	struct casstcl_futureClientData *priorityTail;
+	struct casstcl_futureClientData *completionHead;
+	struct casstcl_futureClientData *completionTail;
+	int completionBudget;
+	int completionEventQueued;
+
+	// the slab of slots for handle futures and the list of free ones
+	struct casstcl_futureClientData **futureSlab;
+	int futureSlabChunks;
+	struct casstcl_futureClientData *futureFreeList;
+
+	// the in-flight window.  inFlight is decremented, and inFlightWakeup
+	// set when the window stops being full, from the driver's threads;
+	// a maxInFlight of zero means there is no limit
+	int inFlight;
+	int peakInFlight;
+	int maxInFlight;
+	int inFlightMode;
+	int inFlightWaiters;
+	int inFlightWakeup;
+	casstcl_queuedRequest *requestQueueHead;
+	casstcl_queuedRequest *requestQueueTail;
+	int queuedCount;
+	int peakQueued;
+
+	// coroutines awaiting futures with $future await.  the driver's
+	// threads set awaitWakeup as requests complete while awaitCount
+	// isn't zero, and the event source resumes those whose futures are
+	// ready
+	struct casstcl_awaitState *awaitHead;
+	int awaitCount;
+	int awaitWakeup;
+
+	// blobs at least blobRefMinimum bytes long are fetched as references
+	// into the result they came from rather than as copies; zero turns
+	// that off.  blobSource is the result whose rows are being converted
+	int blobRefMinimum;
+	casstcl_resultRef *blobSource;
+
+	casstcl_requestStats requestStats[CASSTCL_STATS_KINDS];
+
+	casstcl_pagingPolicy pagingPolicy;
+	casstcl_pagingStats pagingStats;
+
+	casstcl_slowlog slowlog;
+
+	// the shared session this object is attached to, if any, and the
+	// number of driver callbacks that may still use this object.  an
+	// attached object can't wait for cass_session_free to run them all
+	// when it is deleted, so it waits on callbacksDone for this to drop
+	// to zero instead
+	casstcl_sharedSession *shared;
+	int pendingCallbacks;
+	Tcl_Condition callbacksDone;
+
+	// the manifest of a connect -callback -prepare that is under way, and
+	// the statements of the last manifests by name
+	casstcl_manifest *connectManifest;
+	Tcl_HashTable manifestHash;
 } casstcl_sessionClientData;
 
 typedef struct casstcl_futureClientData
@@ -101,6 +769,15 @@ typedef struct casstcl_futureClientData
 	CassFuture *future;
 	Tcl_Command cmdToken;
 	Tcl_Obj *callbackObj;
+	struct casstcl_futureClientData *nextCompletion;
+
+	// for a handle future, cmdToken is NULL and these identify it in the
+	// slab; the generation changes every time the slot is reused so that
+	// old handles to it are recognized as stale
+	int slot;
+	unsigned long generation;
+
+	casstcl_requestTimer timer;
 } casstcl_futureClientData;
 
 typedef struct casstcl_batchClientData
@@ -112,8 +789,117 @@ typedef struct casstcl_batchClientData
 	Tcl_Command cmdToken;
 	CassConsistency consistency;
 	int count;
+
+	// auto flush: when the batch reaches maxStatements statements or
+	// about maxBytes bytes, or maxAge milliseconds after the first
+	// statement was added to it, it is sent and reset.  zero means no
+	// limit.  bytes is an estimate made from the arguments of add and
+	// upsert, since the driver can't tell us the size of a statement
+	int maxStatements;
+	int maxBytes;
+	int maxAge;
+	int bytes;
+	Tcl_TimerToken ageTimer;
+	Tcl_Obj *flushCallbackObj;
+
+	// the kind of request flushes are counted as in the session's
+	// statistics, CASSTCL_STATS_BATCH but for counter accumulators
+	int statsKind;
+
+	// the upserts in the batch, which are writes in flight for the row
+	// cache from when they are added until they have been executed
+	casstcl_writeList writes;
+
+	// called after the age timer has flushed the batch, if it is still
+	// empty; used by partitioned batches to drop their per partition batches
+	void (*emptiedProc) (struct casstcl_batchClientData *bcd);
+	ClientData emptiedData;
 } casstcl_batchClientData;
 
+/*
+ * A partitioned batch keeps a batch, without a command of its own, for
+ * each partition that rows have been upserted into, found by the key made
+ * from the row's partition key values.  The auto flush limits and callback
+ * are copied to each of them.
+ */
+typedef struct casstcl_partitionedBatchClientData
+{
+	int cass_partitioned_batch_magic;
+	casstcl_sessionClientData *ct;
+	CassBatchType batchType;
+	Tcl_Command cmdToken;
+	CassConsistency consistency;
+	Tcl_HashTable partitionHash;
+	int maxStatements;
+	int maxBytes;
+	int maxAge;
+	Tcl_Obj *flushCallbackObj;
+} casstcl_partitionedBatchClientData;
+
+/*
+ * A counter accumulator sums the increments made to counter columns,
+ * keeping one delta for each distinct table, primary key and column, and
+ * sends the sums as updates in counter batches.  The key a delta is filed
+ * under is the table, the values of its key columns, those of the
+ * partition key first, and the column, so that the first partitionLength
+ * bytes of it pick out the partition.  Each delta keeps the statement
+ * that will update it, with its key already bound.
+ */
+typedef struct casstcl_counterDelta
+{
+	CassStatement *statement;
+	Tcl_WideInt delta;
+	int partitionLength;
+	int bytes;
+	struct casstcl_counterDelta *next;
+} casstcl_counterDelta;
+
+typedef struct casstcl_counterAccumulatorClientData
+{
+	int cass_counter_accumulator_magic;
+	casstcl_sessionClientData *ct;
+	Tcl_Command cmdToken;
+	Tcl_HashTable deltaHash;
+	int bytes;
+
+	// the batch that flushes are sent through, which has no command of
+	// its own and no auto flush limits
+	casstcl_batchClientData *bcd;
+
+	// auto flush: the pending deltas are sent when there are maxKeys of
+	// them or interval milliseconds after the first of them was made,
+	// in batches of at most batchSize updates.  zero means no limit
+	int maxKeys;
+	int interval;
+	int batchSize;
+	Tcl_TimerToken intervalTimer;
+	Tcl_Obj *flushCallbackObj;
+
+	Tcl_WideInt increments;
+	Tcl_WideInt coalesced;
+	Tcl_WideInt flushes;
+	Tcl_WideInt keysFlushed;
+	Tcl_WideInt batches;
+	Tcl_WideInt dropped;
+	Tcl_WideInt flushTimeTotal;
+	Tcl_WideInt flushTimeLast;
+	Tcl_WideInt flushTimeMax;
+} casstcl_counterAccumulatorClientData;
+
+/*
+ * A parameter of a prepared statement, as worked out from the text of the
+ * statement: the name the driver knows it by (the column it is compared
+ * with or assigned to, a named marker's name, or [ttl], [timestamp] or
+ * [limit]) and, if typeStatus is TCL_OK, the type to bind it as.
+ */
+typedef struct casstcl_preparedParameter
+{
+	char *name;
+	int typeStatus;
+	char *typeString;
+	casstcl_cassTypeInfo typeInfo;
+} casstcl_preparedParameter;
+
 typedef struct casstcl_preparedClientData
 {
     int cass_prepared_magic;
@@ -122,21 +908,66 @@ typedef struct casstcl_preparedClientData
 	char *string;
 	Tcl_Obj *tableNameObj;
 	Tcl_Command cmdToken;
+
+	// the parameters in order, or an nParameters of -1 if the statement
+	// couldn't be scanned.  parameterHash gives the index of each name,
+	// or -1 for a name used by more than one parameter.  serial tells the
+	// names cached on Tcl objects by this statement from those cached by
+	// any other, since the structure's address may be reused
+	int nParameters;
+	casstcl_preparedParameter *parameters;
+	Tcl_HashTable parameterHash;
+	unsigned long serial;
 } casstcl_preparedClientData;
 
+/*
+ * One of these exists for each select started with a callback, from when
+ * its first page is requested until its last page has been delivered.
+ * While one page is being delivered to Tcl the next one is already being
+ * fetched as the future in this structure.
+ */
+typedef struct casstcl_selectClientData
+{
+	int cass_select_magic;
+	casstcl_sessionClientData *ct;
+	Tcl_ThreadId threadId;
+	struct casstcl_selectClientData *prev;
+	struct casstcl_selectClientData *next;
+	CassStatement *statement;
+	CassFuture *future;
+	Tcl_Obj *callbackObj;
+	int rowStyle;
+	int pageCount;
+	int delivering;
+	int cancelled;
+	Tcl_Obj **columnNames;
+	int columnCount;
+	casstcl_requestTimer timer;
+	casstcl_pager pager;
+
+	// what the slow request log is told about each page.  the text is
+	// a copy, made only if the log was on when the select started
+	casstcl_statementInfo info;
+} casstcl_selectClientData;
+
 typedef struct casstcl_loggingEvent
 {
 	Tcl_Event event;
 	Tcl_Interp *interp;
-	CassLogMessage message;
 } casstcl_loggingEvent;
 
 typedef struct casstcl_futureEvent
 {
 	Tcl_Event event;
-	casstcl_futureClientData *fcd;
+	casstcl_sessionClientData *ct;
 } casstcl_futureEvent;
 
+typedef struct casstcl_selectEvent
+{
+	Tcl_Event event;
+	casstcl_selectClientData *scd;
+} casstcl_selectEvent;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -0,0 +1,943 @@
+/*
+ * casstcl_await - Functions for waiting for requests from a coroutine,
+ *                 which lets the event loop run other work while the
+ *                 request is in flight
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_await.h"
+#include "casstcl_cassandra.h"
+#include "casstcl_error.h"
+#include "casstcl_future.h"
+#include "casstcl_result.h"
+#include "casstcl_shared.h"
+
+#ifdef CASSTCL_HAVE_NRE
+
+/*
+ * How an awaited future is found again when the coroutine is resumed: a
+ * future object through its client data, which is preserved for the
+ * wait, or a handle future through its session and handle.  The session
+ * is preserved either way.  While the future hasn't completed the state
+ * is on the session's list of awaiters, and once it has, timer is the
+ * handler that resumes the coroutine.
+ */
+typedef struct casstcl_awaitState {
+	casstcl_futureClientData *fcd;
+	casstcl_sessionClientData *ct;
+	Tcl_Obj *handleObj;
+	Tcl_Interp *interp;
+	Tcl_Obj *coroObj;
+	int rowStyle;
+	int waiting;
+	struct casstcl_awaitState *prev;
+	struct casstcl_awaitState *next;
+	Tcl_TimerToken timer;
+} casstcl_awaitState;
+
+static int casstcl_await_future_resumed (ClientData data[], Tcl_Interp *interp, int result);
+static void casstcl_await_state_free (casstcl_awaitState *state);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_coroutine -- find the coroutine await was called
+ *   from
+ *
+ * Results:
+ *      A standard Tcl result; the fully qualified name of the
+ *      coroutine is stored in *coroObjPtr, with a reference held.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_await_coroutine (Tcl_Interp *interp, Tcl_Obj **coroObjPtr)
+{
+	if (Tcl_EvalEx (interp, "::info coroutine", -1, TCL_EVAL_GLOBAL) == TCL_ERROR) {
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetCharLength (Tcl_GetObjResult (interp)) == 0) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "await can only be used inside a coroutine", NULL);
+		return TCL_ERROR;
+	}
+
+	*coroObjPtr = Tcl_GetObjResult (interp);
+	Tcl_IncrRefCount (*coroObjPtr);
+	Tcl_ResetResult (interp);
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_yield -- yield from the coroutine, arranging for
+ *   postProc to be called with state when it is resumed
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      The coroutine yields.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_await_yield (Tcl_Interp *interp, Tcl_NRPostProc *postProc, casstcl_awaitState *state)
+{
+	Tcl_Obj *yieldObj = Tcl_NewStringObj ("::yield", -1);
+
+	Tcl_NRAddCallback (interp, postProc, state, NULL, NULL, NULL);
+	return Tcl_NREvalObj (interp, Tcl_NewListObj (1, &yieldObj), 0);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_result -- make the result of await from its
+ *   completed future, the same as the rows method of the future
+ *   would
+ *
+ * Results:
+ *      A standard Tcl result; the interpreter result is the rows,
+ *      or the error of the request.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_await_result (casstcl_sessionClientData *ct, CassFuture *future, int rowStyle)
+{
+	Tcl_Interp *interp = ct->interp;
+	const CassResult *result;
+	casstcl_resultRef *resultRef;
+	Tcl_Obj **columnNames;
+	Tcl_Obj *rowsObj = NULL;
+	int columnCount = 0;
+	int tclReturn;
+
+	CassError rc = cass_future_error_code (future);
+	if (rc != CASS_OK) {
+		return casstcl_future_error_to_tcl (ct, rc, future);
+	}
+
+	// an insert, for one, has no result and so no rows
+	Tcl_ResetResult (interp);
+	result = cass_future_get_result (future);
+	if (result == NULL) {
+		return TCL_OK;
+	}
+
+	columnNames = casstcl_result_column_names (result, &columnCount);
+	resultRef = casstcl_result_ref_new (result);
+	tclReturn = casstcl_result_rows_to_obj (ct, resultRef, columnNames, columnCount, rowStyle, &rowsObj);
+	casstcl_free_column_names (columnNames, columnCount);
+	casstcl_result_ref_release (resultRef);
+
+	if (tclReturn == TCL_OK) {
+		Tcl_SetObjResult (interp, rowsObj);
+	}
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_row_style -- parse the -list or -dict option
+ *   that may start the arguments of await
+ *
+ * Results:
+ *      The row style; *argPtr is moved past the option if there
+ *      was one.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_await_row_style (int objc, Tcl_Obj *CONST objv[], int *argPtr)
+{
+	int arg = *argPtr;
+
+	if (arg < objc) {
+		char *option = Tcl_GetString (objv[arg]);
+
+		if (strcmp (option, "-list") == 0) {
+			*argPtr = arg + 1;
+			return CASSTCL_ROWS_LIST;
+		}
+
+		if (strcmp (option, "-dict") == 0) {
+			*argPtr = arg + 1;
+			return CASSTCL_ROWS_DICT;
+		}
+	}
+
+	return CASSTCL_ROWS_LIST;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_resumed -- called when the coroutine of a session
+ *   await is resumed, normally by casstcl_future_run_callback with
+ *   the handle of the completed future
+ *
+ *   If it was resumed with anything else, or deleted, the future is
+ *   left for casstcl_future_run_callback to get rid of when its
+ *   request completes.
+ *
+ * Results:
+ *      A standard Tcl result, that of the awaited request.
+ *
+ * Side effects:
+ *      The future is deleted.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_await_resumed (ClientData data[], Tcl_Interp *interp, int result)
+{
+	casstcl_awaitState *state = (casstcl_awaitState *)data[0];
+	casstcl_sessionClientData *ct = state->ct;
+	casstcl_futureClientData *fcd = NULL;
+
+	if (ct->cass_session_magic == CASS_SESSION_MAGIC) {
+		fcd = casstcl_future_handle_to_futureClientData (ct, state->handleObj);
+	}
+
+	if (result == TCL_OK && fcd != NULL && strcmp (Tcl_GetString (Tcl_GetObjResult (interp)), Tcl_GetString (state->handleObj)) == 0) {
+		result = casstcl_await_result (ct, fcd->future, state->rowStyle);
+		casstcl_future_slot_release (fcd);
+	} else {
+		if (fcd != NULL && fcd->callbackObj != NULL) {
+			Tcl_DecrRefCount (fcd->callbackObj);
+			fcd->callbackObj = NULL;
+		}
+
+		if (result == TCL_OK) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "coroutine was resumed before the request it was awaiting completed", NULL);
+			result = TCL_ERROR;
+		}
+	}
+
+	Tcl_DecrRefCount (state->handleObj);
+	Tcl_DecrRefCount (state->coroObj);
+	Tcl_Release ((ClientData)ct);
+	ckfree ((char *)state);
+	return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_session_await -- issue a request the way async does and
+ *   yield from the coroutine until it completes
+ *
+ *   $cass await ?-list|-dict? ?async options? statement ?args?
+ *
+ *   The request is made as a handle future whose callback resumes
+ *   the coroutine, so no command or callback script is made for it;
+ *   casstcl_future_run_callback knows the future by its
+ *   CASSTCL_FUTURE_AWAIT_FLAG.
+ *
+ * Results:
+ *      A standard Tcl result; once resumed, the interpreter result
+ *      is the rows of the request, as lists or with -dict as dicts,
+ *      or its error.
+ *
+ * Side effects:
+ *      The coroutine yields.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_session_await (casstcl_sessionClientData *ct, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	casstcl_awaitState *state;
+	casstcl_futureClientData *fcd;
+	Tcl_Obj *coroObj;
+	Tcl_Obj **newObjv;
+	int rowStyle;
+	int arg = 2;
+	int tclReturn;
+	int i;
+
+	static CONST char *valueOptions[] = {
+		"-batch",
+		"-timeout",
+		"-array",
+		"-table",
+		"-prepared",
+		"-values",
+		"-consistency",
+		"-mapunknown",
+		NULL
+	};
+
+	static CONST char *flagOptions[] = {
+		"-head",
+		"-handle",
+		"-idempotent",
+		"-upsert",
+		"-nocomplain",
+		"-ifnotexists",
+		NULL
+	};
+
+	if (objc < 3) {
+		Tcl_WrongNumArgs (interp, 2, objv, "?-list|-dict? ?-batch batchObject? ?-head? ?-idempotent? ?-timeout ms? ?-array arrayName? ?-table tableName? ?-prepared preparedName? ?-values list? ?-consistency level? statement ?args? OR ?-upsert ?-mapunkown? ?-nocomplain? ?-ifnotexists??");
+		return TCL_ERROR;
+	}
+
+	rowStyle = casstcl_await_row_style (objc, objv, &arg);
+
+	// the options of async come first, then those of the statement or
+	// the upsert, and await brings its own callback, so none of them
+	// may be -callback or -error_only
+	for (i = arg; i < objc; i++) {
+		char *option = Tcl_GetString (objv[i]);
+		int optIndex;
+
+		if (strcmp (option, "-callback") == 0 || strcmp (option, "-error_only") == 0) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, option, " can't be used with await", NULL);
+			return TCL_ERROR;
+		}
+
+		if (Tcl_GetIndexFromObj (NULL, objv[i], valueOptions, "option", TCL_EXACT, &optIndex) == TCL_OK) {
+			i++;
+		} else if (Tcl_GetIndexFromObj (NULL, objv[i], flagOptions, "option", TCL_EXACT, &optIndex) != TCL_OK) {
+			break;
+		}
+	}
+
+	if (casstcl_await_coroutine (interp, &coroObj) == TCL_ERROR) {
+		return TCL_ERROR;
+	}
+
+	// $cass async -handle -callback coroutine ?async options? ...
+	newObjv = (Tcl_Obj **)ckalloc (sizeof (Tcl_Obj *) * (objc - arg + 5));
+	newObjv[0] = objv[0];
+	newObjv[1] = Tcl_NewStringObj ("async", -1);
+	newObjv[2] = Tcl_NewStringObj ("-handle", -1);
+	newObjv[3] = Tcl_NewStringObj ("-callback", -1);
+	newObjv[4] = coroObj;
+	for (i = 1; i < 4; i++) {
+		Tcl_IncrRefCount (newObjv[i]);
+	}
+	for (i = arg; i < objc; i++) {
+		newObjv[i - arg + 5] = objv[i];
+	}
+
+	tclReturn = casstcl_cassObjectObjCmd ((ClientData)ct, interp, objc - arg + 5, newObjv);
+
+	for (i = 1; i < 4; i++) {
+		Tcl_DecrRefCount (newObjv[i]);
+	}
+	ckfree ((char *)newObjv);
+
+	if (tclReturn == TCL_ERROR) {
+		Tcl_DecrRefCount (coroObj);
+		return TCL_ERROR;
+	}
+
+	state = (casstcl_awaitState *)ckalloc (sizeof (casstcl_awaitState));
+	state->fcd = NULL;
+	state->ct = ct;
+	state->handleObj = Tcl_GetObjResult (interp);
+	Tcl_IncrRefCount (state->handleObj);
+	state->interp = interp;
+	state->coroObj = coroObj;
+	state->rowStyle = rowStyle;
+	state->waiting = 0;
+	state->prev = NULL;
+	state->next = NULL;
+	state->timer = NULL;
+	Tcl_Preserve ((ClientData)ct);
+
+	// nothing calls back before the event loop runs, so there is time
+	// to mark the future
+	fcd = casstcl_future_handle_to_futureClientData (ct, state->handleObj);
+	fcd->flags |= CASSTCL_FUTURE_AWAIT_FLAG;
+
+	Tcl_ResetResult (interp);
+	return casstcl_await_yield (interp, casstcl_await_resumed, state);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_poll -- timer handler that resumes a coroutine
+ *   awaiting a future once the future has completed
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The coroutine is resumed if it still exists.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_await_poll (ClientData clientData)
+{
+	casstcl_awaitState *state = (casstcl_awaitState *)clientData;
+
+	state->timer = NULL;
+	if (Tcl_FindCommand (state->interp, Tcl_GetString (state->coroObj), NULL, TCL_GLOBAL_ONLY) != NULL) {
+		casstcl_invoke_callback_with_argument (state->interp, state->coroObj, Tcl_NewObj ());
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_find -- find the future an await is waiting for
+ *
+ * Results:
+ *      The future's client data, or NULL if it has been deleted.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static casstcl_futureClientData *
+casstcl_await_find (casstcl_awaitState *state)
+{
+	if (state->fcd != NULL) {
+		return (state->fcd->cass_future_magic == CASS_FUTURE_MAGIC) ? state->fcd : NULL;
+	}
+
+	if (state->ct->cass_session_magic != CASS_SESSION_MAGIC) {
+		return NULL;
+	}
+	return casstcl_future_handle_to_futureClientData (state->ct, state->handleObj);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_ready -- see if there is no more waiting to do
+ *   for the future an await is waiting for
+ *
+ *   A future still queued for room in the in-flight window has
+ *   no driver future yet.  One that has gone, or was never
+ *   executed, is as ready as it will ever be.
+ *
+ * Results:
+ *      1 if the coroutine can go on, otherwise 0.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_await_ready (casstcl_awaitState *state)
+{
+	casstcl_futureClientData *fcd = casstcl_await_find (state);
+
+	if (fcd == NULL) {
+		return 1;
+	}
+
+	if (fcd->future == NULL) {
+		return ((fcd->flags & CASSTCL_FUTURE_QUEUED_FLAG) == 0);
+	}
+	return cass_future_ready (fcd->future);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_wakeup_callback -- driver callback for a future
+ *   nothing else hears from, which $future await has given it
+ *   so that its completion wakes the session's awaiters up
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_await_wakeup_callback (CassFuture *future, void *data)
+{
+	casstcl_sessionClientData *ct = (casstcl_sessionClientData *)data;
+
+	casstcl_await_wakeup (ct);
+	casstcl_callback_finished (ct);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_wait -- put an await on its session's list of
+ *   awaiters, to be resumed when its future completes
+ *
+ *   A future that has been executed has a driver callback if it
+ *   has a Tcl callback or counts against the in-flight window, and
+ *   either one wakes the awaiters up.  Any other future is given
+ *   one here, and a queued future gets one when it is executed.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_await_wait (casstcl_awaitState *state)
+{
+	casstcl_sessionClientData *ct = state->ct;
+	casstcl_futureClientData *fcd = casstcl_await_find (state);
+
+	if (fcd != NULL && fcd->future != NULL && fcd->callbackObj == NULL && (fcd->flags & (CASSTCL_FUTURE_COUNTED_FLAG | CASSTCL_FUTURE_WAKEUP_FLAG)) == 0) {
+		fcd->flags |= CASSTCL_FUTURE_WAKEUP_FLAG;
+		casstcl_callback_started (ct);
+		if (cass_future_set_callback (fcd->future, casstcl_await_wakeup_callback, ct) != CASS_OK) {
+			casstcl_callback_finished (ct);
+		}
+	}
+
+	state->prev = NULL;
+	state->next = ct->awaitHead;
+	if (ct->awaitHead != NULL) {
+		ct->awaitHead->prev = state;
+	}
+	ct->awaitHead = state;
+	state->waiting = 1;
+
+	// the driver's threads look at the count after the future is ready,
+	// so this has to be seen before the future is looked at again
+	__atomic_add_fetch (&ct->awaitCount, 1, __ATOMIC_SEQ_CST);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_unwait -- take an await off its session's list
+ *   of awaiters, if it is on it
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_await_unwait (casstcl_awaitState *state)
+{
+	casstcl_sessionClientData *ct = state->ct;
+
+	if (!state->waiting) {
+		return;
+	}
+
+	if (state->prev != NULL) {
+		state->prev->next = state->next;
+	} else {
+		ct->awaitHead = state->next;
+	}
+	if (state->next != NULL) {
+		state->next->prev = state->prev;
+	}
+	state->prev = state->next = NULL;
+	state->waiting = 0;
+
+	__atomic_sub_fetch (&ct->awaitCount, 1, __ATOMIC_SEQ_CST);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_future_check -- see if an awaited future has
+ *   completed, yielding until it has if it hasn't
+ *
+ *   The coroutine is resumed by casstcl_await_check, called from
+ *   the session's event source once the driver has said that a
+ *   request has completed.
+ *
+ * Results:
+ *      A standard Tcl result; once the future has completed, the
+ *      interpreter result is its rows or its error.
+ *
+ * Side effects:
+ *      The state is freed once the future has completed.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_await_future_check (Tcl_Interp *interp, casstcl_awaitState *state)
+{
+	casstcl_futureClientData *fcd;
+	int result = TCL_OK;
+
+	if (!casstcl_await_ready (state)) {
+		// nothing is left to wake us up once the session is gone
+		if (state->ct->cass_session_magic != CASS_SESSION_MAGIC) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "session was deleted while the future was being awaited", NULL);
+			casstcl_await_state_free (state);
+			return TCL_ERROR;
+		}
+
+		casstcl_await_wait (state);
+
+		// the request may have completed before the session knew
+		// that there was anybody to wake up
+		if (!casstcl_await_ready (state)) {
+			return casstcl_await_yield (interp, casstcl_await_future_resumed, state);
+		}
+		casstcl_await_unwait (state);
+	}
+
+	fcd = casstcl_await_find (state);
+	if (fcd == NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "future was deleted while it was being awaited", NULL);
+		result = TCL_ERROR;
+	} else if (fcd->future == NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "future's request was never executed", NULL);
+		result = TCL_ERROR;
+	} else {
+		result = casstcl_await_result (fcd->ct, fcd->future, state->rowStyle);
+	}
+
+	casstcl_await_state_free (state);
+	return result;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_future_resumed -- called when a coroutine
+ *   awaiting a future is resumed, by casstcl_await_check or
+ *   otherwise
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_await_future_resumed (ClientData data[], Tcl_Interp *interp, int result)
+{
+	casstcl_awaitState *state = (casstcl_awaitState *)data[0];
+
+	casstcl_await_unwait (state);
+	if (state->timer != NULL) {
+		Tcl_DeleteTimerHandler (state->timer);
+		state->timer = NULL;
+	}
+
+	// a coroutine being deleted can't wait any more
+	if (result != TCL_OK) {
+		casstcl_await_state_free (state);
+		return result;
+	}
+
+	return casstcl_await_future_check (interp, state);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_state_free -- let go of the future an await on a
+ *   future was waiting for, and free its state
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_await_state_free (casstcl_awaitState *state)
+{
+	casstcl_await_unwait (state);
+	if (state->fcd != NULL) {
+		Tcl_Release ((ClientData)state->fcd);
+	} else {
+		Tcl_DecrRefCount (state->handleObj);
+	}
+	Tcl_Release ((ClientData)state->ct);
+	Tcl_DecrRefCount (state->coroObj);
+	ckfree ((char *)state);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_future_await -- yield from the coroutine until a future
+ *   has completed
+ *
+ *   $future await ?-list|-dict?
+ *   $cass future $handle await ?-list|-dict?
+ *
+ *   The future isn't deleted.
+ *
+ * Results:
+ *      A standard Tcl result; the interpreter result is the rows
+ *      of the future's request, as for its rows method, or its
+ *      error.
+ *
+ * Side effects:
+ *      The coroutine may yield.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_future_await (casstcl_futureClientData *fcd, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], Tcl_Obj *handleObj)
+{
+	casstcl_awaitState *state;
+	Tcl_Obj *coroObj;
+	int arg = 2;
+	int rowStyle = casstcl_await_row_style (objc, objv, &arg);
+
+	if (arg != objc) {
+		Tcl_WrongNumArgs (interp, 2, objv, "?-list|-dict?");
+		return TCL_ERROR;
+	}
+
+	if (casstcl_await_coroutine (interp, &coroObj) == TCL_ERROR) {
+		return TCL_ERROR;
+	}
+
+	state = (casstcl_awaitState *)ckalloc (sizeof (casstcl_awaitState));
+	state->interp = interp;
+	state->coroObj = coroObj;
+	state->rowStyle = rowStyle;
+	state->waiting = 0;
+	state->prev = NULL;
+	state->next = NULL;
+	state->timer = NULL;
+	state->ct = fcd->ct;
+	Tcl_Preserve ((ClientData)fcd->ct);
+
+	if (handleObj != NULL) {
+		state->fcd = NULL;
+		state->handleObj = handleObj;
+		Tcl_IncrRefCount (handleObj);
+	} else {
+		state->fcd = fcd;
+		state->handleObj = NULL;
+		Tcl_Preserve ((ClientData)fcd);
+	}
+
+	return casstcl_await_future_check (interp, state);
+}
+
+#endif
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_wakeup -- called from the driver's threads as a
+ *   request of a session completes, to wake up the session's
+ *   thread if there are coroutines awaiting futures
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_await_wakeup (casstcl_sessionClientData *ct)
+{
+	if (__atomic_load_n (&ct->awaitCount, __ATOMIC_SEQ_CST) > 0) {
+		__atomic_store_n (&ct->awaitWakeup, 1, __ATOMIC_RELEASE);
+		Tcl_ThreadAlert (ct->threadId);
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_wakeup_pending -- see if the session's event
+ *   source has awaiters to look at
+ *
+ * Results:
+ *      1 if casstcl_await_wakeup has had awaiters to wake up since
+ *      the last casstcl_await_check, otherwise 0.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_await_wakeup_pending (casstcl_sessionClientData *ct)
+{
+	return __atomic_load_n (&ct->awaitWakeup, __ATOMIC_ACQUIRE);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_check -- called from the session's event source
+ *   to resume the coroutines whose awaited futures have completed
+ *
+ *   The coroutines are resumed from timer handlers rather than
+ *   from here, so that they run as events of their own.  If all
+ *   is set, as it is when the session is being deleted, every one
+ *   is resumed, since nothing will wake them up after that.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_await_check (casstcl_sessionClientData *ct, int all)
+{
+#ifdef CASSTCL_HAVE_NRE
+	casstcl_awaitState *state;
+	casstcl_awaitState *next;
+
+	if (!__atomic_exchange_n (&ct->awaitWakeup, 0, __ATOMIC_ACQ_REL) && !all) {
+		return;
+	}
+
+	for (state = ct->awaitHead; state != NULL; state = next) {
+		next = state->next;
+		if (all || casstcl_await_ready (state)) {
+			casstcl_await_unwait (state);
+			state->timer = Tcl_CreateTimerHandler (0, casstcl_await_poll, state);
+		}
+	}
+#endif
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_cassObjectNRObjCmd -- the nonrecursive implementation
+ *   of the methods of a cassandra object, so that await can yield
+ *   from a coroutine
+ *
+ *   Everything but await, and the await method of handle
+ *   futures, is passed on to casstcl_cassObjectObjCmd.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_cassObjectNRObjCmd (ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+#ifdef CASSTCL_HAVE_NRE
+	casstcl_sessionClientData *ct = (casstcl_sessionClientData *)cData;
+
+	if (objc >= 2 && strcmp (Tcl_GetString (objv[1]), "await") == 0) {
+		return casstcl_session_await (ct, interp, objc, objv);
+	}
+
+	if (objc >= 4 && strcmp (Tcl_GetString (objv[1]), "future") == 0 && strcmp (Tcl_GetString (objv[3]), "await") == 0) {
+		casstcl_futureClientData *fcd = casstcl_future_handle_to_futureClientData (ct, objv[2]);
+
+		if (fcd != NULL) {
+			return casstcl_future_await (fcd, interp, objc - 2, objv + 2, objv[2]);
+		}
+	}
+#endif
+
+	return casstcl_cassObjectObjCmd (cData, interp, objc, objv);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_futureObjectNRObjCmd -- the nonrecursive implementation
+ *   of the methods of a future object, so that await can yield
+ *   from a coroutine
+ *
+ *   Everything but await is passed on to
+ *   casstcl_futureObjectObjCmd.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_futureObjectNRObjCmd (ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+#ifdef CASSTCL_HAVE_NRE
+	if (objc >= 2 && strcmp (Tcl_GetString (objv[1]), "await") == 0) {
+		return casstcl_future_await ((casstcl_futureClientData *)cData, interp, objc, objv, NULL);
+	}
+#endif
+
+	return casstcl_futureObjectObjCmd (cData, interp, objc, objv);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_unavailable -- report that await was called
+ *   where it can't yield: outside of a coroutine or, without
+ *   Tcl 8.6, at all
+ *
+ * Results:
+ *      TCL_ERROR, with a message in the interpreter result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_await_unavailable (Tcl_Interp *interp)
+{
+	Tcl_ResetResult (interp);
+#ifdef CASSTCL_HAVE_NRE
+	Tcl_AppendResult (interp, "await can only be used inside a coroutine", NULL);
+#else
+	Tcl_AppendResult (interp, "await needs the coroutines of Tcl 8.6", NULL);
+#endif
+	return TCL_ERROR;
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
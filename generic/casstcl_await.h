@@ -0,0 +1,123 @@
+/*
+ *
+ * Include file for casstcl_await
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_cassObjectNRObjCmd -- the nonrecursive implementation
+ *   of the methods of a cassandra object, so that await can yield
+ *   from a coroutine
+ *
+ *   Everything but await, and the await method of handle
+ *   futures, is passed on to casstcl_cassObjectObjCmd.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_cassObjectNRObjCmd (ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_futureObjectNRObjCmd -- the nonrecursive implementation
+ *   of the methods of a future object, so that await can yield
+ *   from a coroutine
+ *
+ *   Everything but await is passed on to
+ *   casstcl_futureObjectObjCmd.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_futureObjectNRObjCmd (ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_unavailable -- report that await was called
+ *   where it can't yield: outside of a coroutine or, without
+ *   Tcl 8.6, at all
+ *
+ * Results:
+ *      TCL_ERROR, with a message in the interpreter result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_await_unavailable (Tcl_Interp *interp);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_wakeup -- called from the driver's threads as a
+ *   request of a session completes, to wake up the session's
+ *   thread if there are coroutines awaiting futures
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_await_wakeup (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_wakeup_pending -- see if the session's event
+ *   source has awaiters to look at
+ *
+ * Results:
+ *      1 if casstcl_await_wakeup has had awaiters to wake up since
+ *      the last casstcl_await_check, otherwise 0.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_await_wakeup_pending (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_await_check -- called from the session's event source
+ *   to resume the coroutines whose awaited futures have completed
+ *
+ *   The coroutines are resumed from timer handlers rather than
+ *   from here, so that they run as events of their own.  If all
+ *   is set, as it is when the session is being deleted, every one
+ *   is resumed, since nothing will wake them up after that.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_await_check (casstcl_sessionClientData *ct, int all);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
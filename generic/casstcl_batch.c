@@ -13,9 +13,129 @@
 #include "casstcl_cassandra.h"
 #include "casstcl_error.h"
 #include "casstcl_consistency.h"
+#include "casstcl_future.h"
+#include "casstcl_inflight.h"
+#include "casstcl_stats.h"
+#include "casstcl_shared.h"
+#include "casstcl_slowlog.h"
+#include "casstcl_rowcache.h"
 
 #include <assert.h>
 
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_new -- allocate and initialize the client data
+ *   of a batch, without creating a command for it
+ *
+ *   Batch objects are made from these, and so are the per
+ *   partition batches of a partitioned batch object.
+ *
+ * Results:
+ *      The new client data.
+ *
+ * Side effects:
+ *      The session is preserved until the batch is freed with
+ *      casstcl_batch_free, so that an auto flush timer can tell if
+ *      it has been deleted.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_batchClientData *
+casstcl_batch_new (casstcl_sessionClientData *ct, CassBatchType cassBatchType)
+{
+	casstcl_batchClientData *bcd = (casstcl_batchClientData *)ckalloc (sizeof (casstcl_batchClientData));
+
+	bcd->cass_batch_magic = CASS_BATCH_MAGIC;
+	bcd->ct = ct;
+	bcd->batch = cass_batch_new (cassBatchType);
+	bcd->batchType = cassBatchType;
+	bcd->cmdToken = NULL;
+	bcd->consistency = CASS_CONSISTENCY_ONE;
+	bcd->count = 0;
+	bcd->maxStatements = 0;
+	bcd->maxBytes = 0;
+	bcd->maxAge = 0;
+	bcd->bytes = 0;
+	bcd->ageTimer = NULL;
+	bcd->flushCallbackObj = NULL;
+	bcd->statsKind = CASSTCL_STATS_BATCH;
+	bcd->emptiedProc = NULL;
+	bcd->emptiedData = NULL;
+	bcd->writes.tables = NULL;
+	bcd->writes.count = 0;
+
+	Tcl_Preserve ((ClientData)ct);
+	return bcd;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_release_writes -- finish the upserts a batch
+ *   was holding for the row cache, which it isn't going to make
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The list is emptied.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_batch_release_writes (casstcl_sessionClientData *ct, casstcl_writeList *writes)
+{
+	// the row cache goes with a deleted session, leaving nothing to tell
+	if (ct->cass_session_magic == CASS_SESSION_MAGIC) {
+		casstcl_row_cache_writes_finished (writes);
+		return;
+	}
+
+	if (writes->tables != NULL) {
+		ckfree ((char *)writes->tables);
+	}
+	writes->tables = NULL;
+	writes->count = 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_free -- free the client data of a batch and the
+ *   statements in it
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The memory is released with Tcl_EventuallyFree, since
+ *      casstcl_batch_add_statement may be holding on to it.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_batch_free (casstcl_batchClientData *bcd)
+{
+    assert (bcd->cass_batch_magic == CASS_BATCH_MAGIC);
+
+	if (bcd->ageTimer != NULL) {
+		Tcl_DeleteTimerHandler (bcd->ageTimer);
+	}
+
+	if (bcd->flushCallbackObj != NULL) {
+		Tcl_DecrRefCount (bcd->flushCallbackObj);
+	}
+
+	cass_batch_free (bcd->batch);
+	casstcl_batch_release_writes (bcd->ct, &bcd->writes);
+	Tcl_Release ((ClientData)bcd->ct);
+
+	bcd->batch = NULL;
+	bcd->cass_batch_magic = 0;
+    Tcl_EventuallyFree((ClientData)bcd, TCL_DYNAMIC);
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -33,12 +153,7 @@
 void
 casstcl_batchObjectDelete (ClientData clientData)
 {
-    casstcl_batchClientData *bcd = (casstcl_batchClientData *)clientData;
-
-    assert (bcd->cass_batch_magic == CASS_BATCH_MAGIC);
-
-	cass_batch_free (bcd->batch);
-    ckfree((char *)clientData);
+	casstcl_batch_free ((casstcl_batchClientData *)clientData);
 }
 
 /*
@@ -164,6 +279,384 @@ casstcl_batch_command_to_batchClientData (Tcl_Interp *interp, char *batchCommand
 }
 
 
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_estimate_bytes -- estimate how many bytes the
+ *   statement made from some arguments of add or upsert will add
+ *   to the serialized batch
+ *
+ *   The driver doesn't tell us how big a statement is once its
+ *   values are bound, so this is the length of the string of each
+ *   argument plus a few bytes for the length that goes in front of
+ *   each value.
+ *
+ * Results:
+ *      The estimate.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_batch_estimate_bytes (int objc, Tcl_Obj *CONST objv[])
+{
+	int bytes = 0;
+	int i;
+
+	for (i = 0; i < objc; i++) {
+		int length;
+
+		Tcl_GetStringFromObj (objv[i], &length);
+		bytes += length + 4;
+	}
+
+	return bytes;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_reset -- throw away the statements of a batch
+ *   and start a new, empty one with the same type and consistency
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      Any pending auto flush timer is cancelled.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_batch_reset (casstcl_batchClientData *bcd)
+{
+	if (bcd->ageTimer != NULL) {
+		Tcl_DeleteTimerHandler (bcd->ageTimer);
+		bcd->ageTimer = NULL;
+	}
+
+	if (bcd->batch != NULL) {
+		cass_batch_free (bcd->batch);
+	}
+	casstcl_batch_release_writes (bcd->ct, &bcd->writes);
+	bcd->batch = cass_batch_new (bcd->batchType);
+	bcd->count = 0;
+	bcd->bytes = 0;
+	CassError cassError = cass_batch_set_consistency (bcd->batch, bcd->consistency);
+	if (cassError != CASS_OK) {
+		return casstcl_cass_error_to_tcl (bcd->ct, cassError);
+	}
+
+	return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_batch_flush_callback --
+ *
+ *    driver callback for a flushed batch that nobody asked to hear
+ *    about; the request is recorded with the copy of its timer it is
+ *    given and taken out of the session's in-flight window, and the
+ *    future is freed
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+static void
+casstcl_batch_flush_callback (CassFuture* future, void* data)
+{
+	casstcl_stats_timer_callback (future, data);
+	cass_future_free (future);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_flush -- send the statements of a batch to the
+ *   cluster without waiting for them and reset the batch so that
+ *   more can be added straight away
+ *
+ *   If callbackObj isn't NULL a future object is created and the
+ *   callback is invoked with it when the batch completes, as with
+ *   async -callback; otherwise nothing is reported.  Flushes count
+ *   against the session's in-flight window, waiting for room in it
+ *   the same as async -batch does.
+ *
+ *   Waiting runs events, which may delete the batch, so nothing in
+ *   it is used once the statements have been taken out of it, and
+ *   callbackObj, which may be the batch's flush callback, is held
+ *   on to until the flush is done.  Callers must check that the
+ *   batch still exists before using it afterwards.
+ *
+ * Results:
+ *      A standard Tcl result; the name of the future, if one was
+ *      created, is the interpreter result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_batch_flush (casstcl_batchClientData *bcd, Tcl_Obj *callbackObj)
+{
+	casstcl_sessionClientData *ct = bcd->ct;
+	Tcl_Interp *interp = ct->interp;
+	CassBatch *batch;
+	CassFuture *future;
+	casstcl_futureClientData *fcd;
+	casstcl_requestTimer timer;
+	casstcl_statementInfo info;
+	casstcl_writeList writes;
+	int statsKind;
+	int tclReturn = TCL_OK;
+
+	Tcl_ResetResult (interp);
+	if (bcd->count == 0) {
+		return TCL_OK;
+	}
+
+	// take the statements out of the batch object first, since waiting
+	// for room in the window runs events that could add to it, and the
+	// writes to the tables they upsert into with them
+	batch = bcd->batch;
+	bcd->batch = NULL;
+	writes = bcd->writes;
+	bcd->writes.tables = NULL;
+	bcd->writes.count = 0;
+	if (casstcl_batch_reset (bcd) == TCL_ERROR) {
+		cass_batch_free (batch);
+		casstcl_batch_release_writes (ct, &writes);
+		return TCL_ERROR;
+	}
+
+	// and anything else needed from it, since those events could also
+	// delete it
+	statsKind = bcd->statsKind;
+	info.text = "BATCH";
+	info.consistency = bcd->consistency;
+
+	Tcl_Preserve ((ClientData)bcd);
+	if (callbackObj != NULL) {
+		Tcl_IncrRefCount (callbackObj);
+	}
+
+	if (casstcl_inflight_full (ct) && (casstcl_inflight_wait (ct, NULL) == TCL_ERROR)) {
+		cass_batch_free (batch);
+		casstcl_batch_release_writes (ct, &writes);
+		tclReturn = TCL_ERROR;
+		goto done;
+	}
+
+	casstcl_inflight_started (ct);
+	casstcl_stats_start (ct, statsKind, &timer);
+	timer.writes = writes;
+	casstcl_slowlog_start (ct, &timer, NULL, &info);
+	future = cass_session_execute_batch (ct->session, batch);
+	cass_batch_free (batch);
+
+	if (callbackObj == NULL) {
+		casstcl_callback_started (ct);
+		cass_future_set_callback (future, casstcl_batch_flush_callback, casstcl_stats_timer_copy (&timer));
+		goto done;
+	}
+
+	// the future is attached after the command is created so that, as
+	// with queued requests, creating it doesn't wait for the request
+	if (casstcl_createFutureObjectCommand (ct, NULL, callbackObj, CASSTCL_FUTURE_COUNTED_FLAG, &timer, &fcd) == TCL_ERROR) {
+		casstcl_callback_started (ct);
+		cass_future_set_callback (future, casstcl_batch_flush_callback, casstcl_stats_timer_copy (&timer));
+		tclReturn = TCL_ERROR;
+		goto done;
+	}
+	casstcl_future_attach (fcd, future);
+
+  done:
+	if (callbackObj != NULL) {
+		Tcl_DecrRefCount (callbackObj);
+	}
+	Tcl_Release ((ClientData)bcd);
+	return tclReturn;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_batch_age_proc --
+ *
+ *    timer handler that flushes a batch when it has held its first
+ *    statement for its maximum age
+ *
+ * Results:
+ *    None; a background error is raised if the flush fails.
+ *
+ *----------------------------------------------------------------------
+ */
+static void
+casstcl_batch_age_proc (ClientData clientData)
+{
+	casstcl_batchClientData *bcd = (casstcl_batchClientData *)clientData;
+	Tcl_Interp *interp = bcd->ct->interp;
+	int tclReturn;
+
+	bcd->ageTimer = NULL;
+
+	// the session may have been deleted out from under the batch
+	if (bcd->ct->cass_session_magic != CASS_SESSION_MAGIC) {
+		return;
+	}
+
+	// flushing can wait for room in the in-flight window, running
+	// events that might delete the batch
+	Tcl_Preserve ((ClientData)bcd);
+	tclReturn = casstcl_batch_flush (bcd, bcd->flushCallbackObj);
+	if (tclReturn == TCL_ERROR) {
+		Tcl_BackgroundError (interp);
+	} else if ((bcd->cass_batch_magic == CASS_BATCH_MAGIC) && (bcd->count == 0) && (bcd->emptiedProc != NULL)) {
+		// the events run by the flush may have refilled the batch, in
+		// which case it isn't empty and has to be kept
+		(*bcd->emptiedProc) (bcd);
+	}
+	Tcl_Release ((ClientData)bcd);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_add_statement -- add a statement made from some
+ *   arguments of add or upsert to a batch, flushing the batch
+ *   before or after as its auto flush limits say
+ *
+ *   A statement that would take the batch over its byte limit is
+ *   put in a new batch, after the one it would have gone in is
+ *   flushed, unless it is the first statement of the batch.
+ *
+ *   objc and objv are the arguments the statement was made from,
+ *   for estimating its size, and table is the table an upsert
+ *   writes to, or NULL for other statements.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      The statement is freed.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_batch_add_statement (casstcl_batchClientData *bcd, CassStatement *statement, const char *table, int objc, Tcl_Obj *CONST objv[])
+{
+	Tcl_Interp *interp = bcd->ct->interp;
+	int bytes = casstcl_batch_estimate_bytes (objc, objv);
+	CassError cassError;
+
+	if ((bcd->maxBytes > 0) && (bcd->count > 0) && (bcd->bytes + bytes > bcd->maxBytes)) {
+		int tclReturn;
+
+		// flushing can wait for room in the in-flight window, running
+		// events that might delete the batch
+		Tcl_Preserve ((ClientData)bcd);
+		tclReturn = casstcl_batch_flush (bcd, bcd->flushCallbackObj);
+		if ((tclReturn == TCL_OK) && (bcd->cass_batch_magic != CASS_BATCH_MAGIC)) {
+			Tcl_AppendResult (interp, "batch was deleted while it was being flushed", NULL);
+			tclReturn = TCL_ERROR;
+		}
+		Tcl_Release ((ClientData)bcd);
+
+		if (tclReturn == TCL_ERROR) {
+			cass_statement_free (statement);
+			return TCL_ERROR;
+		}
+	}
+
+	cassError = cass_batch_add_statement (bcd->batch, statement);
+	cass_statement_free (statement);
+
+	if (cassError != CASS_OK) {
+		return casstcl_cass_error_to_tcl (bcd->ct, cassError);
+	}
+
+	casstcl_row_cache_write_started (bcd->ct, table, &bcd->writes);
+	bcd->count++;
+	bcd->bytes += bytes;
+
+	if ((bcd->count == 1) && (bcd->maxAge > 0)) {
+		bcd->ageTimer = Tcl_CreateTimerHandler (bcd->maxAge, casstcl_batch_age_proc, (ClientData)bcd);
+	}
+
+	if (((bcd->maxStatements > 0) && (bcd->count >= bcd->maxStatements)) ||
+		((bcd->maxBytes > 0) && (bcd->bytes >= bcd->maxBytes))) {
+		if (casstcl_batch_flush (bcd, bcd->flushCallbackObj) == TCL_ERROR) {
+			return TCL_ERROR;
+		}
+	}
+
+	Tcl_ResetResult (interp);
+	return TCL_OK;
+}
+
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_set_max_age -- set the auto flush age of a
+ *   batch, starting the clock again if it has statements in it
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_batch_set_max_age (casstcl_batchClientData *bcd, int maxAge)
+{
+	if (bcd->ageTimer != NULL) {
+		Tcl_DeleteTimerHandler (bcd->ageTimer);
+		bcd->ageTimer = NULL;
+	}
+
+	bcd->maxAge = maxAge;
+	if ((bcd->count > 0) && (bcd->maxAge > 0)) {
+		bcd->ageTimer = Tcl_CreateTimerHandler (bcd->maxAge, casstcl_batch_age_proc, (ClientData)bcd);
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_set_flush_callback -- set or, if callbackObj is
+ *   NULL or empty, remove the callback of a batch's auto flushes
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_batch_set_flush_callback (casstcl_batchClientData *bcd, Tcl_Obj *callbackObj)
+{
+	if (bcd->flushCallbackObj != NULL) {
+		Tcl_DecrRefCount (bcd->flushCallbackObj);
+		bcd->flushCallbackObj = NULL;
+	}
+
+	if ((callbackObj != NULL) && (Tcl_GetCharLength (callbackObj) > 0)) {
+		bcd->flushCallbackObj = callbackObj;
+		Tcl_IncrRefCount (bcd->flushCallbackObj);
+	}
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -181,16 +674,9 @@ int
 casstcl_createBatchObjectCommand (casstcl_sessionClientData *ct, char *commandName, CassBatchType cassBatchType)
 {
 	// allocate one of our cass client data objects for Tcl and configure it
-	casstcl_batchClientData *bcd = (casstcl_batchClientData *)ckalloc (sizeof (casstcl_batchClientData));
+	casstcl_batchClientData *bcd = casstcl_batch_new (ct, cassBatchType);
 	Tcl_Interp *interp = ct->interp;
 
-	bcd->cass_batch_magic = CASS_BATCH_MAGIC;
-	bcd->ct = ct;
-	bcd->batch = cass_batch_new (cassBatchType);
-	bcd->batchType = cassBatchType;
-	bcd->consistency = CASS_CONSISTENCY_ONE;
-	bcd->count = 0;
-
 #define BATCH_STRING_FORMAT "batch%lu"
 	// if commandName is #auto, generate a unique name for the object
 	int autoGeneratedName = 0;
@@ -237,7 +723,10 @@ casstcl_batchObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Ob
         "add",
 		"upsert",
 		"count",
+		"bytes",
         "consistency",
+		"auto_flush",
+		"flush",
 		"reset",
         "delete",
         NULL
@@ -247,7 +736,10 @@ casstcl_batchObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Ob
         OPT_ADD,
         OPT_UPSERT,
 		OPT_COUNT,
+		OPT_BYTES,
         OPT_CONSISTENCY,
+		OPT_AUTO_FLUSH,
+		OPT_FLUSH,
 		OPT_RESET,
 		OPT_DELETE
     };
@@ -265,18 +757,13 @@ casstcl_batchObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Ob
     switch ((enum options) optIndex) {
 		case OPT_ADD: {
 			CassStatement* statement = NULL;
-			if (casstcl_make_statement_from_objv (bcd->ct, objc, objv, 2, &statement) == TCL_ERROR) {
+			if (casstcl_make_statement_from_objv (bcd->ct, objc, objv, 2, &statement, NULL) == TCL_ERROR) {
 				return TCL_ERROR;
 			}
 
-			CassError cassError = cass_batch_add_statement (bcd->batch, statement);
-			cass_statement_free (statement);
-
-			if (cassError == CASS_OK) {
-				bcd->count++;
-			} else {
+			if (casstcl_batch_add_statement (bcd, statement, NULL, objc - 2, &objv[2]) == TCL_ERROR) {
 				Tcl_AppendResult (interp, " while adding statement to batch", NULL);
-				return casstcl_cass_error_to_tcl (bcd->ct, cassError);
+				return TCL_ERROR;
 			}
 
 			break;
@@ -288,17 +775,7 @@ casstcl_batchObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Ob
 			resultCode = casstcl_make_upsert_statement_from_objv (bcd->ct, objc - 2, &objv[2], NULL, &statement);
 
 			if (resultCode != TCL_ERROR) {
-//printf("calling cass_batch_add_statement\n");
-				CassError cassError;
-				cassError = cass_batch_add_statement (bcd->batch, statement);
-				cass_statement_free (statement);
-//printf("returned from cass_batch_add_statement, cassError %d\n", cassError);
-
-				if (cassError == CASS_OK) {
-				bcd->count++;
-				} else {
-					return casstcl_cass_error_to_tcl (bcd->ct, cassError);
-				}
+				resultCode = casstcl_batch_add_statement (bcd, statement, Tcl_GetString (objv[objc - 2]), objc - 2, &objv[2]);
 			}
 
 			break;
@@ -315,6 +792,17 @@ casstcl_batchObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Ob
 			break;
 		}
 
+		// bytes - return the estimated size of the statements in the batch
+		case OPT_BYTES: {
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
+			}
+
+			Tcl_SetObjResult (interp, Tcl_NewIntObj (bcd->bytes));
+			break;
+		}
+
 
 		case OPT_CONSISTENCY: {
 			CassConsistency cassConsistency;
@@ -341,20 +829,112 @@ casstcl_batchObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Ob
 			break;
 		}
 
+		case OPT_AUTO_FLUSH: {
+			int arg;
+			int subOptIndex;
+
+			static CONST char *subOptions[] = {
+				"-statements",
+				"-bytes",
+				"-age",
+				"-callback",
+				NULL
+			};
+
+			enum subOptions {
+				SUBOPT_STATEMENTS,
+				SUBOPT_BYTES,
+				SUBOPT_AGE,
+				SUBOPT_CALLBACK
+			};
+
+			if ((objc % 2) != 0) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-statements count? ?-bytes bytes? ?-age ms? ?-callback callback?");
+				return TCL_ERROR;
+			}
+
+			for (arg = 2; arg < objc; arg += 2) {
+				int value = 0;
+
+				if (Tcl_GetIndexFromObj (interp, objv[arg], subOptions, "subOption", TCL_EXACT, &subOptIndex) != TCL_OK) {
+					return TCL_ERROR;
+				}
+
+				if ((enum subOptions) subOptIndex == SUBOPT_CALLBACK) {
+					casstcl_batch_set_flush_callback (bcd, objv[arg + 1]);
+					continue;
+				}
+
+				if (Tcl_GetIntFromObj (interp, objv[arg + 1], &value) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting ", Tcl_GetString (objv[arg]), " element", NULL);
+					return TCL_ERROR;
+				}
+
+				if (value < 0) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "auto flush limit ", Tcl_GetString (objv[arg]), " must not be negative", NULL);
+					return TCL_ERROR;
+				}
+
+				switch ((enum subOptions) subOptIndex) {
+					case SUBOPT_STATEMENTS: {
+						bcd->maxStatements = value;
+						break;
+					}
+
+					case SUBOPT_BYTES: {
+						bcd->maxBytes = value;
+						break;
+					}
+
+					case SUBOPT_AGE: {
+						casstcl_batch_set_max_age (bcd, value);
+						break;
+					}
+
+					case SUBOPT_CALLBACK: {
+						break;
+					}
+				}
+			}
+
+			Tcl_Obj *listObjv[8];
+
+			listObjv[0] = Tcl_NewStringObj ("-statements", -1);
+			listObjv[1] = Tcl_NewIntObj (bcd->maxStatements);
+			listObjv[2] = Tcl_NewStringObj ("-bytes", -1);
+			listObjv[3] = Tcl_NewIntObj (bcd->maxBytes);
+			listObjv[4] = Tcl_NewStringObj ("-age", -1);
+			listObjv[5] = Tcl_NewIntObj (bcd->maxAge);
+			listObjv[6] = Tcl_NewStringObj ("-callback", -1);
+			listObjv[7] = (bcd->flushCallbackObj != NULL) ? bcd->flushCallbackObj : Tcl_NewObj ();
+			Tcl_SetObjResult (interp, Tcl_NewListObj (8, listObjv));
+			break;
+		}
+
+		case OPT_FLUSH: {
+			Tcl_Obj *callbackObj = bcd->flushCallbackObj;
+
+			if ((objc != 2) && !((objc == 4) && (strcmp (Tcl_GetString (objv[2]), "-callback") == 0))) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-callback callback?");
+				return TCL_ERROR;
+			}
+
+			if (objc == 4) {
+				callbackObj = (Tcl_GetCharLength (objv[3]) > 0) ? objv[3] : NULL;
+			}
+
+			resultCode = casstcl_batch_flush (bcd, callbackObj);
+			break;
+		}
+
 		case OPT_RESET: {
 			if (objc != 2) {
 				Tcl_WrongNumArgs (interp, 2, objv, "");
 				return TCL_ERROR;
 			}
 
-			cass_batch_free (bcd->batch);
-			bcd->batch = cass_batch_new (bcd->batchType);
-			bcd->count = 0;
-			CassError cassError = cass_batch_set_consistency (bcd->batch, bcd->consistency);
-			if (cassError != CASS_OK) {
-				return casstcl_cass_error_to_tcl (bcd->ct, cassError);
-			}
-
+			resultCode = casstcl_batch_reset (bcd);
 			break;
 		}
 
@@ -73,6 +73,87 @@ casstcl_batchClientData * casstcl_batch_command_to_batchClientData (Tcl_Interp *
  */
 int casstcl_createBatchObjectCommand (casstcl_sessionClientData *ct, char *commandName, CassBatchType cassBatchType);
 
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_flush -- send the statements of a batch to the
+ *   cluster without waiting for them and reset the batch so that
+ *   more can be added straight away
+ *
+ *   If callbackObj isn't NULL a future object is created and the
+ *   callback is invoked with it when the batch completes, as with
+ *   async -callback; otherwise nothing is reported.  Flushes count
+ *   against the session's in-flight window, waiting for room in it
+ *   the same as async -batch does.
+ *
+ * Results:
+ *      A standard Tcl result; the name of the future, if one was
+ *      created, is the interpreter result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_batch_flush (casstcl_batchClientData *bcd, Tcl_Obj *callbackObj);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_add_statement -- add a statement made from some
+ *   arguments of add or upsert to a batch, flushing the batch
+ *   before or after as its auto flush limits say
+ *
+ *   A statement that would take the batch over its byte limit is
+ *   put in a new batch, after the one it would have gone in is
+ *   flushed, unless it is the first statement of the batch.
+ *
+ *   objc and objv are the arguments the statement was made from,
+ *   for estimating its size, and table is the table an upsert
+ *   writes to, or NULL for other statements.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      The statement is freed.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_batch_add_statement (casstcl_batchClientData *bcd, CassStatement *statement, const char *table, int objc, Tcl_Obj *CONST objv[]);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_set_max_age -- set the auto flush age of a
+ *   batch, starting the clock again if it has statements in it
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_batch_set_max_age (casstcl_batchClientData *bcd, int maxAge);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_set_flush_callback -- set or, if callbackObj is
+ *   NULL or empty, remove the callback of a batch's auto flushes
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_batch_set_flush_callback (casstcl_batchClientData *bcd, Tcl_Obj *callbackObj);
+
 /*
  *----------------------------------------------------------------------
  *
@@ -103,4 +184,42 @@ int casstcl_batchObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tc
  */
 void casstcl_batchObjectDelete (ClientData clientData);
 
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_new -- allocate and initialize the client data
+ *   of a batch, without creating a command for it
+ *
+ *   Batch objects are made from these, and so are the per
+ *   partition batches of a partitioned batch object.
+ *
+ * Results:
+ *      The new client data.
+ *
+ * Side effects:
+ *      The session is preserved until the batch is freed with
+ *      casstcl_batch_free, so that an auto flush timer can tell if
+ *      it has been deleted.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_batchClientData *casstcl_batch_new (casstcl_sessionClientData *ct, CassBatchType cassBatchType);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_batch_free -- free the client data of a batch and the
+ *   statements in it
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The memory is released with Tcl_EventuallyFree, since
+ *      casstcl_batch_add_statement may be holding on to it.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_batch_free (casstcl_batchClientData *bcd);
+
 /* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,328 @@
+/*
+ * casstcl_bench - Functions for timing the conversion of values between
+ *                 Tcl and the types of cassandra
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_bench.h"
+#include "casstcl_cassandra.h"
+#include "casstcl_error.h"
+#include "casstcl_result.h"
+#include "casstcl_types.h"
+#include "casstcl_objtypes.h"
+
+#include <assert.h>
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_bench_bind -- time binding each of a list of values
+ *   to a statement iterations times
+ *
+ *   Each value is bound from a fresh copy of its string, the way
+ *   values that arrive as text are, so that the time includes
+ *   parsing them and not just an internal representation cached
+ *   by the previous pass.
+ *
+ * Results:
+ *      A standard Tcl result.  The elapsed microseconds are stored
+ *      in *elapsedPtr.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_bench_bind (Tcl_Interp *interp, casstcl_cassTypeInfo *typeInfo, int valueCount, Tcl_Obj **values, int iterations, Tcl_WideInt *elapsedPtr)
+{
+	casstcl_sessionClientData *ct;
+	CassStatement *statement;
+	Tcl_Time start;
+	Tcl_Time end;
+	int tclReturn = TCL_OK;
+	int iteration;
+	int i;
+
+	// binding only reports errors through the session's interpreter
+	ct = (casstcl_sessionClientData *)ckalloc (sizeof (casstcl_sessionClientData));
+	memset (ct, 0, sizeof (casstcl_sessionClientData));
+	ct->interp = interp;
+
+	statement = cass_statement_new ("", 1);
+
+	Tcl_GetTime (&start);
+	for (iteration = 0; iteration < iterations && tclReturn == TCL_OK; iteration++) {
+		for (i = 0; i < valueCount; i++) {
+			int length;
+			char *string = Tcl_GetStringFromObj (values[i], &length);
+			Tcl_Obj *valueObj = Tcl_NewStringObj (string, length);
+
+			Tcl_IncrRefCount (valueObj);
+			tclReturn = casstcl_bind_tcl_obj (ct, statement, NULL, 0, 0, typeInfo, valueObj);
+			Tcl_DecrRefCount (valueObj);
+
+			if (tclReturn != TCL_OK) {
+				break;
+			}
+		}
+	}
+	Tcl_GetTime (&end);
+
+	cass_statement_free (statement);
+	ckfree ((char *)ct);
+
+	*elapsedPtr = ((Tcl_WideInt)(end.sec - start.sec) * 1000000) + (end.usec - start.usec);
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_bench_session -- find the session of a cassdb object
+ *   command
+ *
+ * Results:
+ *      The session, or NULL with an error in the interpreter if
+ *      the command isn't a cassdb object.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static casstcl_sessionClientData *
+casstcl_bench_session (Tcl_Interp *interp, Tcl_Obj *nameObj)
+{
+	Tcl_CmdInfo cmdInfo;
+	casstcl_sessionClientData *ct;
+
+	if (!Tcl_GetCommandInfo (interp, Tcl_GetString (nameObj), &cmdInfo) || cmdInfo.objProc != casstcl_cassObjectObjCmd) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "'", Tcl_GetString (nameObj), "' isn't a cassdb object", NULL);
+		return NULL;
+	}
+
+	ct = (casstcl_sessionClientData *)cmdInfo.objClientData;
+	assert (ct->cass_session_magic == CASS_SESSION_MAGIC);
+	return ct;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_bench_convert -- time making Tcl objects of each of the
+ *   values in the result of a query iterations times
+ *
+ *   The query is run once, and every value that isn't null is
+ *   converted with casstcl_cass_value_to_tcl_obj each time over,
+ *   just as the rows of a select are, blob references and all.
+ *   The time includes walking the rows of the result.
+ *
+ * Results:
+ *      A standard Tcl result.  The number of values converted
+ *      is stored in *conversionsPtr and the elapsed microseconds
+ *      in *elapsedPtr.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_bench_convert (casstcl_sessionClientData *ct, const char *query, int iterations, Tcl_WideInt *conversionsPtr, Tcl_WideInt *elapsedPtr)
+{
+	CassStatement *statement;
+	CassFuture *future;
+	const CassResult *result;
+	casstcl_resultRef *resultRef;
+	casstcl_resultRef *savedBlobSource;
+	Tcl_WideInt conversions = 0;
+	Tcl_Time start;
+	Tcl_Time end;
+	CassError rc;
+	int columnCount;
+	int tclReturn = TCL_OK;
+	int iteration;
+
+	statement = cass_statement_new (query, 0);
+	future = cass_session_execute (ct->session, statement);
+	cass_statement_free (statement);
+
+	rc = cass_future_error_code (future);
+	if (rc != CASS_OK) {
+		tclReturn = casstcl_future_error_to_tcl (ct, rc, future);
+		cass_future_free (future);
+		return tclReturn;
+	}
+
+	result = cass_future_get_result (future);
+	cass_future_free (future);
+	if (result == NULL) {
+		Tcl_ResetResult (ct->interp);
+		Tcl_AppendResult (ct->interp, "query returned no result", NULL);
+		return TCL_ERROR;
+	}
+
+	resultRef = casstcl_result_ref_new (result);
+	columnCount = cass_result_column_count (result);
+	savedBlobSource = ct->blobSource;
+	ct->blobSource = resultRef;
+
+	Tcl_GetTime (&start);
+	for (iteration = 0; iteration < iterations && tclReturn == TCL_OK; iteration++) {
+		CassIterator *iterator = cass_iterator_from_result (result);
+
+		while (tclReturn == TCL_OK && cass_iterator_next (iterator)) {
+			const CassRow *row = cass_iterator_get_row (iterator);
+			int i;
+
+			for (i = 0; i < columnCount; i++) {
+				const CassValue *columnValue = cass_row_get_column (row, i);
+				Tcl_Obj *valueObj = NULL;
+
+				if (cass_value_is_null (columnValue)) {
+					continue;
+				}
+
+				if (casstcl_cass_value_to_tcl_obj (ct, columnValue, &valueObj) == TCL_ERROR) {
+					tclReturn = TCL_ERROR;
+					break;
+				}
+
+				if (valueObj != NULL) {
+					Tcl_IncrRefCount (valueObj);
+					Tcl_DecrRefCount (valueObj);
+				}
+				conversions++;
+			}
+		}
+		cass_iterator_free (iterator);
+	}
+	Tcl_GetTime (&end);
+
+	ct->blobSource = savedBlobSource;
+	casstcl_result_ref_release (resultRef);
+
+	*conversionsPtr = conversions;
+	*elapsedPtr = ((Tcl_WideInt)(end.sec - start.sec) * 1000000) + (end.usec - start.usec);
+	return tclReturn;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_benchmarkObjCmd --
+ *
+ *      ::casstcl::benchmark bind type values ?iterations?
+ *      ::casstcl::benchmark convert cassdb query ?iterations?
+ *
+ *      bind times binding each of the values to the cassandra type,
+ *      which is given as in the value and type arguments of exec, such
+ *      as "int" or "map text bigint", iterations times over, without a
+ *      session.  convert times making Tcl objects of the values in the
+ *      result of the query, run once with the cassdb object given,
+ *      iterations times over.
+ *
+ *      The command is added to an interpreter by Casstcl_bench_Init.
+ *
+ * Results:
+ *      A standard Tcl result.  The interpreter result is a list of key
+ *      value pairs of the number of values converted, the elapsed
+ *      microseconds and the nanoseconds per value.
+ *
+ * Side effects:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_benchmarkObjCmd (ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	casstcl_cassTypeInfo typeInfo;
+	casstcl_sessionClientData *ct;
+	Tcl_Obj **values;
+	Tcl_Obj *listObj;
+	Tcl_WideInt elapsed;
+	Tcl_WideInt conversions;
+	int valueCount;
+	int iterations = 1;
+	int optIndex;
+	int tclReturn;
+
+	static CONST char *options[] = {
+		"bind",
+		"convert",
+		NULL
+	};
+
+	enum options {
+		OPT_BIND,
+		OPT_CONVERT
+	};
+
+	if (objc < 4 || objc > 5) {
+		Tcl_WrongNumArgs (interp, 1, objv, "bind type values ?iterations? | convert cassdb query ?iterations?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj (interp, objv[1], options, "subcommand", TCL_EXACT, &optIndex) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	if (objc == 5) {
+		if (Tcl_GetIntFromObj (interp, objv[4], &iterations) == TCL_ERROR) {
+			Tcl_AppendResult (interp, " while converting iterations", NULL);
+			return TCL_ERROR;
+		}
+
+		if (iterations < 1) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "iterations must be at least 1", NULL);
+			return TCL_ERROR;
+		}
+	}
+
+	if ((enum options) optIndex == OPT_BIND) {
+		if (casstcl_obj_to_compound_cass_value_types (interp, objv[2], &typeInfo) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		if (Tcl_ListObjGetElements (interp, objv[3], &valueCount, &values) == TCL_ERROR) {
+			return TCL_ERROR;
+		}
+
+		tclReturn = casstcl_bench_bind (interp, &typeInfo, valueCount, values, iterations, &elapsed);
+		conversions = (Tcl_WideInt)valueCount * iterations;
+	} else {
+		ct = casstcl_bench_session (interp, objv[2]);
+		if (ct == NULL) {
+			return TCL_ERROR;
+		}
+
+		tclReturn = casstcl_bench_convert (ct, Tcl_GetString (objv[3]), iterations, &conversions, &elapsed);
+	}
+
+	if (tclReturn != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	listObj = Tcl_NewObj ();
+	Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ("conversions", -1));
+	Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewWideIntObj (conversions));
+	Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ("us", -1));
+	Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewWideIntObj (elapsed));
+	Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ("ns_per_value", -1));
+	Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewDoubleObj (conversions > 0 ? (elapsed * 1000.0) / conversions : 0.0));
+
+	Tcl_SetObjResult (interp, listObj);
+	return TCL_OK;
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,40 @@
+/*
+ *
+ * Include file for casstcl_bench
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_benchmarkObjCmd --
+ *
+ *      ::casstcl::benchmark bind type values ?iterations?
+ *      ::casstcl::benchmark convert cassdb query ?iterations?
+ *
+ *      bind times binding each of the values to the cassandra type,
+ *      which is given as in the value and type arguments of exec, such
+ *      as "int" or "map text bigint", iterations times over, without a
+ *      session.  convert times making Tcl objects of the values in the
+ *      result of the query, run once with the cassdb object given,
+ *      iterations times over.
+ *
+ *      The command is added to an interpreter by Casstcl_bench_Init.
+ *
+ * Results:
+ *      A standard Tcl result.  The interpreter result is a list of key
+ *      value pairs of the number of values converted, the elapsed
+ *      microseconds and the nanoseconds per value.
+ *
+ * Side effects:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_benchmarkObjCmd (ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -13,26 +13,38 @@
 #include "casstcl_log.h"
 #include "casstcl_prepared.h"
 #include "casstcl_batch.h"
+#include "casstcl_partitioned.h"
+#include "casstcl_counter.h"
 #include "casstcl_cassandra.h"
 #include "casstcl_types.h"
+#include "casstcl_objtypes.h"
+#include "casstcl_paging.h"
 #include "casstcl_error.h"
 #include "casstcl_consistency.h"
 #include "casstcl_event.h"
+#include "casstcl_export.h"
+#include "casstcl_execution.h"
 #include "casstcl_future.h"
+#include "casstcl_inflight.h"
+#include "casstcl_load.h"
+#include "casstcl_manifest.h"
+#include "casstcl_multiget.h"
+#include "casstcl_await.h"
+#include "casstcl_schema.h"
+#include "casstcl_result.h"
+#include "casstcl_scan.h"
+#include "casstcl_select.h"
+#include "casstcl_rowcache.h"
+#include "casstcl_shared.h"
+#include "casstcl_slowlog.h"
+#include "casstcl_stats.h"
 
 #include <assert.h>
 
-// Function Declarations
-int casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]);
-int casstcl_reimport_column_type_map (casstcl_sessionClientData *ct);
-int casstcl_list_columns (casstcl_sessionClientData *ct, char *keyspace, char *table, 
-	int includeTypes, Tcl_Obj **objPtr);
-int casstcl_list_tables (casstcl_sessionClientData *ct, char *keyspace, Tcl_Obj **objPtr);
-int casstcl_list_keyspaces (casstcl_sessionClientData *ct, Tcl_Obj **objPtr);
-
 // possibly unfortunately, the cassandra cpp-driver logging stuff is global
 Tcl_Obj *casstcl_loggingCallbackObj = NULL;
 Tcl_ThreadId casstcl_loggingCallbackThreadId = NULL;
+int casstcl_loggingCallbackList = 0;
 
 /*
  *--------------------------------------------------------------
@@ -55,11 +67,38 @@ casstcl_cassObjectDelete (ClientData clientData)
 
     assert (ct->cass_session_magic == CASS_SESSION_MAGIC);
 
-	cass_ssl_free (ct->ssl);
-    cass_cluster_free (ct->cluster);
-    cass_session_free (ct->session);
+	casstcl_select_orphan_all (ct);
+	casstcl_inflight_discard (ct);
+	casstcl_prepared_cache_free (&ct->preparedCache);
+	casstcl_column_type_map_free (&ct->columnTypeMap);
+
+	if (ct->shared != NULL) {
+		// the driver session carries on for the other objects attached
+		// to it, so wait for just this object's callbacks to have run
+		casstcl_callbacks_wait (ct);
+		casstcl_shared_release (ct->shared);
+	} else {
+		cass_ssl_free (ct->ssl);
+		cass_cluster_free (ct->cluster);
+		cass_session_free (ct->session);
+	}
 
-    ckfree((char *)clientData);
+	// freeing the session may have completed some more futures, so the
+	// completions go after it
+	Tcl_DeleteEventSource (casstcl_EventSetupProc, casstcl_EventCheckProc, ct);
+	casstcl_future_discard_completions (ct);
+	casstcl_await_check (ct, 1);
+	casstcl_future_slab_free (ct);
+	casstcl_manifest_forget (ct);
+	casstcl_slowlog_free (ct);
+
+	// completing requests finish the writes the row cache counts for
+	// their tables
+	casstcl_row_cache_free (ct);
+
+	// casstcl_inflight_wait may be holding on to it
+	ct->cass_session_magic = 0;
+    Tcl_EventuallyFree((ClientData)clientData, TCL_DYNAMIC);
 }
 
 
@@ -129,6 +168,112 @@ casstcl_invoke_callback_with_argument (Tcl_Interp *interp, Tcl_Obj *callbackObj,
 	return tclReturnCode;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_create_session_object --
+ *
+ *      Create a cass object named by nameObj, or with a name made from
+ *      classObj if that is #auto, and set the interpreter result to its
+ *      name.
+ *
+ *      If shared isn't NULL, the object uses the cluster, session and
+ *      ssl context of that shared session, taking over the caller's
+ *      reference to it, instead of having its own.  Either way the
+ *      object has its own event source, completion lists, caches and
+ *      statistics, so its requests are completed on this thread.
+ *
+ * Results:
+ *      The new object.
+ *
+ *----------------------------------------------------------------------
+ */
+static casstcl_sessionClientData *
+casstcl_create_session_object (Tcl_Interp *interp, Tcl_Obj *classObj, Tcl_Obj *nameObj, casstcl_sharedSession *shared)
+{
+	casstcl_sessionClientData *ct;
+	char *commandName;
+	int autoGeneratedName;
+
+	// allocate one of our cass client data objects for Tcl and configure it
+	ct = (casstcl_sessionClientData *)ckalloc (sizeof (casstcl_sessionClientData));
+
+	ct->cass_session_magic = CASS_SESSION_MAGIC;
+	ct->interp = interp;
+	ct->shared = shared;
+	ct->pendingCallbacks = 0;
+	ct->callbacksDone = NULL;
+	if (shared != NULL) {
+		ct->session = shared->session;
+		ct->cluster = shared->cluster;
+		ct->ssl = shared->ssl;
+	} else {
+		ct->session = cass_session_new ();
+		ct->cluster = cass_cluster_new ();
+		ct->ssl = cass_ssl_new ();
+	}
+
+	ct->threadId = Tcl_GetCurrentThread();
+
+	casstcl_prepared_cache_init (&ct->preparedCache, CASSTCL_DEFAULT_PREPARED_CACHE_LIMIT);
+	casstcl_row_cache_init (ct);
+	casstcl_column_type_map_init (&ct->columnTypeMap);
+	casstcl_manifest_init (ct);
+	ct->selectList = NULL;
+
+	ct->completionStack = NULL;
+	ct->priorityHead = ct->priorityTail = NULL;
+	ct->completionHead = ct->completionTail = NULL;
+	ct->completionBudget = CASSTCL_DEFAULT_COMPLETION_BUDGET;
+	ct->completionEventQueued = 0;
+
+	ct->futureSlab = NULL;
+	ct->futureSlabChunks = 0;
+	ct->futureFreeList = NULL;
+
+	ct->blobRefMinimum = 0;
+	ct->blobSource = NULL;
+
+	ct->awaitHead = NULL;
+	ct->awaitCount = 0;
+	ct->awaitWakeup = 0;
+
+	casstcl_inflight_init (ct);
+	casstcl_stats_init (ct);
+	casstcl_slowlog_init (ct);
+	casstcl_paging_init (ct);
+
+	Tcl_CreateEventSource (casstcl_EventSetupProc, casstcl_EventCheckProc, ct);
+
+	commandName = Tcl_GetString (nameObj);
+
+	// if commandName is #auto, generate a unique name for the object
+	autoGeneratedName = 0;
+	if (strcmp (commandName, "#auto") == 0) {
+		static unsigned long nextAutoCounter = 0;
+		char *objName;
+		int    baseNameLength;
+
+		objName = Tcl_GetStringFromObj (classObj, &baseNameLength);
+		baseNameLength += snprintf (NULL, 0, "%lu", nextAutoCounter) + 1;
+		commandName = ckalloc (baseNameLength);
+		snprintf (commandName, baseNameLength, "%s%lu", objName, nextAutoCounter++);
+		autoGeneratedName = 1;
+	}
+
+	// create a Tcl command to interface to cass
+#ifdef CASSTCL_HAVE_NRE
+	ct->cmdToken = Tcl_NRCreateCommand (interp, commandName, casstcl_cassObjectObjCmd, casstcl_cassObjectNRObjCmd, ct, casstcl_cassObjectDelete);
+#else
+	ct->cmdToken = Tcl_CreateObjCommand (interp, commandName, casstcl_cassObjectObjCmd, ct, casstcl_cassObjectDelete);
+#endif
+	Tcl_SetObjResult (interp, Tcl_NewStringObj (commandName, -1));
+	if (autoGeneratedName == 1) {
+		ckfree(commandName);
+	}
+	return ct;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -138,6 +283,7 @@ casstcl_invoke_callback_with_argument (Tcl_Interp *interp, Tcl_Obj *callbackObj,
  *
  *      cass create my_cass
  *      cass create #auto
+ *      cass attach my_cass sharedName
  *
  * The created object is invoked to do things with a CassDB
  *
@@ -154,20 +300,24 @@ casstcl_cassObjCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj
 {
     casstcl_sessionClientData *ct;
     int                 optIndex;
-    char               *commandName;
-    int                 autoGeneratedName;
 
     static CONST char *options[] = {
         "create",
+        "attach",
+        "shared_sessions",
         "logging_callback",
         "log_level",
+        "log_rate_limit",
         NULL
     };
 
     enum options {
         OPT_CREATE,
+		OPT_ATTACH,
+		OPT_SHARED_SESSIONS,
 		OPT_LOGGING_CALLBACK,
-		OPT_LOG_LEVEL
+		OPT_LOG_LEVEL,
+		OPT_LOG_RATE_LIMIT
     };
 
     // basic command line processing
@@ -189,47 +339,59 @@ casstcl_cassObjCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj
 				return TCL_ERROR;
 			}
 
-			// allocate one of our cass client data objects for Tcl and configure it
-			ct = (casstcl_sessionClientData *)ckalloc (sizeof (casstcl_sessionClientData));
+			casstcl_create_session_object (interp, objv[0], objv[2], NULL);
+			break;
+		}
 
-			ct->cass_session_magic = CASS_SESSION_MAGIC;
-			ct->interp = interp;
-			ct->session = cass_session_new ();
-			ct->cluster = cass_cluster_new ();
-			ct->ssl = cass_ssl_new ();
+		case OPT_ATTACH: {
+			casstcl_sharedSession *shared;
 
-			ct->threadId = Tcl_GetCurrentThread();
+			if (objc != 4) {
+				Tcl_WrongNumArgs (interp, 2, objv, "objName sharedName");
+				return TCL_ERROR;
+			}
 
-			Tcl_CreateEventSource (casstcl_EventSetupProc, casstcl_EventCheckProc, NULL);
+			shared = casstcl_shared_attach (interp, Tcl_GetString (objv[3]));
+			if (shared == NULL) {
+				return TCL_ERROR;
+			}
 
-			commandName = Tcl_GetString (objv[2]);
+			ct = casstcl_create_session_object (interp, objv[0], objv[2], shared);
 
-			// if commandName is #auto, generate a unique name for the object
-			autoGeneratedName = 0;
-			if (strcmp (commandName, "#auto") == 0) {
-				static unsigned long nextAutoCounter = 0;
-				char *objName;
-				int    baseNameLength;
+			// take the tables the other sessions have imported, or
+			// import them if nobody has imported all of them yet
+			if (!casstcl_adopt_shared_column_type_map (ct)) {
+				Tcl_Obj *nameObj = Tcl_GetObjResult (interp);
 
-				objName = Tcl_GetStringFromObj (objv[0], &baseNameLength);
-				baseNameLength += snprintf (NULL, 0, "%lu", nextAutoCounter) + 1;
-				commandName = ckalloc (baseNameLength);
-				snprintf (commandName, baseNameLength, "%s%lu", objName, nextAutoCounter++);
-				autoGeneratedName = 1;
+				Tcl_IncrRefCount (nameObj);
+				casstcl_reimport_column_type_map (ct);
+				Tcl_SetObjResult (interp, nameObj);
+				Tcl_DecrRefCount (nameObj);
 			}
+			break;
+		}
 
-			// create a Tcl command to interface to cass
-			ct->cmdToken = Tcl_CreateObjCommand (interp, commandName, casstcl_cassObjectObjCmd, ct, casstcl_cassObjectDelete);
-			Tcl_SetObjResult (interp, Tcl_NewStringObj (commandName, -1));
-			if (autoGeneratedName == 1) {
-				ckfree(commandName);
+		case OPT_SHARED_SESSIONS: {
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
 			}
+
+			casstcl_shared_list (interp);
 			break;
 		}
 
 		case OPT_LOGGING_CALLBACK: {
+			int listMode = 0;
+
+			if (objc == 4 && strcmp (Tcl_GetString (objv[2]), "-list") == 0) {
+				listMode = 1;
+				objv++;
+				objc--;
+			}
+
 			if (objc != 3) {
-				Tcl_WrongNumArgs (interp, 1, objv, "option arg");
+				Tcl_WrongNumArgs (interp, 2, objv, "?-list? callback");
 				return TCL_ERROR;
 			}
 
@@ -245,10 +407,42 @@ casstcl_cassObjCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj
 			Tcl_IncrRefCount (casstcl_loggingCallbackObj);
 
 			casstcl_loggingCallbackThreadId = Tcl_GetCurrentThread();
+			casstcl_loggingCallbackList = listMode;
 
+			casstcl_log_ring_init ();
 			cass_log_set_callback (casstcl_logging_callback, interp);
 			break;
 		}
+
+		case OPT_LOG_RATE_LIMIT: {
+			CassLogLevel cassLogLevel;
+			int limit = -1;
+
+			if (objc < 3 || objc > 4) {
+				Tcl_WrongNumArgs (interp, 2, objv, "level ?perSecond?");
+				return TCL_ERROR;
+			}
+
+			if (casstcl_obj_to_cass_log_level (interp, objv[2], &cassLogLevel) != TCL_OK) {
+				return TCL_ERROR;
+			}
+
+			if (objc == 4) {
+				if (Tcl_GetIntFromObj (interp, objv[3], &limit) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting rate limit", NULL);
+					return TCL_ERROR;
+				}
+
+				if (limit < 0) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "rate limit must not be negative", NULL);
+					return TCL_ERROR;
+				}
+			}
+
+			Tcl_SetObjResult (interp, Tcl_NewIntObj (casstcl_log_rate_limit (cassLogLevel, limit)));
+			break;
+		}
 		case OPT_LOG_LEVEL: {
 			CassLogLevel cassLogLevel;
 
@@ -274,9 +468,24 @@ casstcl_cassObjCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj
  *
  * casstcl_select --
  *
- *      Given a cassandra query, array name and Tcl_Obj pointing to some
+ *      Given a cassandra statement, array name and Tcl_Obj pointing to some
  *      Tcl code, perform the select, filling the named array with elements
- *      from each row in turn and executing code against it.
+ *      from each row in turn and executing code against it.  The statement
+ *      is freed when the select is done.
+ *
+ *      If rowStyle is CASSTCL_ROWS_LIST or CASSTCL_ROWS_DICT, the named
+ *      variable is instead set to all of the rows of a page at once, as
+ *      a list of lists or of dicts, and the code is executed once for
+ *      each page.
+ *
+ *      timeoutMS, unless it is -1, is the request timeout of each page.
+ *      pagingSize is the number of rows per page, or as for
+ *      casstcl_pager_start.  info describes the statement to the slow
+ *      request log.
+ *
+ *      If cacheKey isn't NULL and the result fits in a single page, its
+ *      rows are stored in the session's row cache under that key, filed
+ *      under cacheTable, see casstcl_row_cache_key.
  *
  *      break, continue and return are supported (probably)
  *
@@ -290,29 +499,42 @@ casstcl_cassObjCmd(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj
  *----------------------------------------------------------------------
  */
 
-int casstcl_select (casstcl_sessionClientData *ct, char *query, char *arrayName, Tcl_Obj *codeObj, int pagingSize, CassConsistency *consistencyPtr) {
-	CassStatement* statement = NULL;
+int casstcl_select (casstcl_sessionClientData *ct, CassStatement *statement, casstcl_statementInfo *info, char *arrayName, Tcl_Obj *codeObj, int pagingSize, int timeoutMS, int rowStyle, const char *cacheKey, const char *cacheTable) {
 	int tclReturn = TCL_OK;
 	Tcl_Interp *interp = ct->interp;
 
-	statement = cass_statement_new(query, 0);
-
 	cass_bool_t has_more_pages = cass_false;
 	const CassResult* result = NULL;
+	casstcl_resultRef *resultRef = NULL;
 	CassError rc = CASS_OK;
-	int columnCount = -1;
-
-	if (casstcl_setStatementConsistency(ct, statement, consistencyPtr) != TCL_OK) {
-		return TCL_ERROR;
-	}
+	int columnCount = 0;
+	Tcl_Obj **columnNames = NULL;
+	Tcl_Obj *arrayNameObj;
+	casstcl_pager pager;
 
+	pagingSize = casstcl_pager_start (ct, &pager, pagingSize);
 	cass_statement_set_paging_size(statement, pagingSize);
 
+	// reads can always be retried or sent to another replica
+	casstcl_statement_set_execution (statement, 1, timeoutMS);
+
+	// the variable name is used for every row of every page, keep it in
+	// an object so that it doesn't have to be looked up from a string
+	arrayNameObj = Tcl_NewStringObj (arrayName, -1);
+	Tcl_IncrRefCount (arrayNameObj);
+
 	do {
-		CassIterator* iterator;
-		CassFuture* future = cass_session_execute(ct->session, statement);
+		casstcl_requestTimer timer;
+		CassFuture* future;
+		int evalReturnCode;
+
+		casstcl_stats_start (ct, CASSTCL_STATS_SELECT, &timer);
+		casstcl_slowlog_start (ct, &timer, statement, info);
+		casstcl_pager_requested (&pager);
+		future = cass_session_execute(ct->session, statement);
 
 		rc = cass_future_error_code(future);
+		casstcl_stats_finish (&timer, future, rc);
 		if (rc != CASS_OK) {
 			tclReturn = casstcl_future_error_to_tcl (ct, rc, future);
 			cass_future_free(future);
@@ -326,6 +548,7 @@ int casstcl_select (casstcl_sessionClientData *ct, char *query, char *arrayName,
 		 *       no result.
 		 */
 		result = cass_future_get_result(future);
+		cass_future_free(future);
 
 		if (result == NULL) {
 			Tcl_ResetResult (interp);
@@ -334,93 +557,92 @@ int casstcl_select (casstcl_sessionClientData *ct, char *query, char *arrayName,
 			break;
 		}
 
-		iterator = cass_iterator_from_result(result);
-		cass_future_free(future);
-
-		if (columnCount == -1) {
-			columnCount = cass_result_column_count (result);
+		// the column names are the same for every page so they are
+		// made once and shared by all of the rows
+		if (columnNames == NULL) {
+			columnNames = casstcl_result_column_names (result, &columnCount);
 		}
 
-		while (cass_iterator_next(iterator)) {
-			CassString cassNameString;
-			int i;
-
-			const CassRow* row = cass_iterator_get_row(iterator);
-
-			// process all the columns into the tcl array
-			for (i = 0; i < columnCount; i++) {
-				Tcl_Obj *newObj = NULL;
-				const char *columnName;
-				const CassValue *columnValue;
-
-				cass_result_column_name (result, i, &cassNameString.data, &cassNameString.length);
-				columnName = cassNameString.data;
-
-				columnValue = cass_row_get_column (row, i);
-
-				if (cass_value_is_null (columnValue)) {
-					Tcl_UnsetVar2 (interp, arrayName, columnName, 0);
-					continue;
-				}
-
-				if (casstcl_cass_value_to_tcl_obj (ct, columnValue, &newObj) == TCL_ERROR) {
-					tclReturn = TCL_ERROR;
-					break;
-				}
+		// blobs fetched as references keep the page alive after we
+		// let go of it
+		resultRef = casstcl_result_ref_new (result);
 
-				if (newObj == NULL) {
-					Tcl_UnsetVar2 (interp, arrayName, columnName, 0);
-				} else {
-					if (Tcl_SetVar2Ex (interp, arrayName, columnName, newObj, (TCL_LEAVE_ERR_MSG)) == NULL) {
-						tclReturn = TCL_ERROR;
-						break;
-					}
-				}
+		// only a result that came in one page is cached, as the
+		// rows of the pages after it would have to be fetched anyway
+		if (cacheKey != NULL && !cass_result_has_more_pages (result)) {
+			evalReturnCode = casstcl_row_cache_eval_page (ct, resultRef, columnNames, columnCount, rowStyle, cacheKey, cacheTable, arrayNameObj, codeObj);
+		} else {
+			if (cacheKey != NULL) {
+				ct->rowCache.uncacheable++;
 			}
+			evalReturnCode = casstcl_result_eval_page (ct, resultRef, columnNames, columnCount, rowStyle, arrayNameObj, codeObj);
+		}
+		cacheKey = NULL;
 
-			// now execute the code body
-			int evalReturnCode = Tcl_EvalObjEx(interp, codeObj, 0);
-			if ((evalReturnCode != TCL_OK) && (evalReturnCode != TCL_CONTINUE)) {
-				// if it's TCL_BREAK we fall through to the break; tclReturn
-				// is still TCL_OK so we don't have to change anything and
-				// we don't want to propogate TCL_BREAK or TCL_CONTINE;
-				// they are for us, not for our caller.  TCL_RETURN,
-				// on the other hand, is return for our caller as well.
-				//
-				if (evalReturnCode == TCL_RETURN) {
-					tclReturn = TCL_RETURN;
-				} else if (evalReturnCode == TCL_ERROR) {
-					char        msg[60];
-
-					tclReturn = TCL_ERROR;
-
-					sprintf(msg, "\n    (\"select\" body line %d)",
-							Tcl_GetErrorLine(interp));
-					Tcl_AddErrorInfo(interp, msg);
-				}
-
-				break;
-			}
+		// if it's TCL_BREAK we stop fetching pages but tclReturn is
+		// still TCL_OK; we don't want to propogate TCL_BREAK or
+		// TCL_CONTINUE, they are for us, not for our caller.  TCL_RETURN,
+		// on the other hand, is return for our caller as well.
+		if ((evalReturnCode == TCL_ERROR) || (evalReturnCode == TCL_RETURN)) {
+			tclReturn = evalReturnCode;
 		}
 
-		has_more_pages = cass_result_has_more_pages(result);
+		if ((evalReturnCode == TCL_OK) || (evalReturnCode == TCL_CONTINUE)) {
+			has_more_pages = cass_result_has_more_pages(result);
+		} else {
+			has_more_pages = cass_false;
+		}
 
 		if (has_more_pages) {
+			int nextSize = casstcl_pager_next (ct, &pager, result, columnCount);
+
+			if (nextSize != pagingSize) {
+				pagingSize = nextSize;
+				cass_statement_set_paging_size(statement, pagingSize);
+			}
 			cass_statement_set_paging_state(statement, result);
 		}
 
-		cass_iterator_free(iterator);
-		cass_result_free(result);
-	} while (has_more_pages && tclReturn == TCL_OK);
+		casstcl_result_ref_release (resultRef);
+	} while (has_more_pages);
 
+	casstcl_free_column_names (columnNames, columnCount);
 	cass_statement_free(statement);
 	Tcl_UnsetVar (interp, arrayName, 0);
+	Tcl_DecrRefCount (arrayNameObj);
 
 	return tclReturn;
 }
 
 
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_session_not_shared --
+ *
+ *      Check that a session object isn't attached to a shared session
+ *      before doing something to its driver session that would affect
+ *      the other objects attached to it.
+ *
+ * Results:
+ *      A standard Tcl result, with an error saying what can't be done
+ *      if the session is shared.
+ *
+ *----------------------------------------------------------------------
+ */
+static int
+casstcl_session_not_shared (casstcl_sessionClientData *ct, const char *what)
+{
+	if (ct->shared == NULL) {
+		return TCL_OK;
+	}
+
+	Tcl_ResetResult (ct->interp);
+	Tcl_AppendResult (ct->interp, "session is shared as '", ct->shared->name, "' and can't be ", what, NULL);
+	return TCL_ERROR;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -442,16 +664,42 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 
     static CONST char *options[] = {
         "async",
+        "await",
         "select",
         "exec",
         "connect",
 		"prepare",
+		"prepared",
 		"batch",
+		"partitioned_batch",
+		"counter_accumulator",
+		"load",
+		"export",
+		"scan",
+		"multiget",
 		"keyspaces",
 		"tables",
 		"columns",
 		"columns_with_types",
 		"reimport_column_type_map",
+		"column_type_map_mode",
+		"upsert_cache_limit",
+		"upsert_cache_stats",
+		"upsert_cache_flush",
+		"row_cache",
+		"row_cache_stats",
+		"row_cache_flush",
+		"blob_references",
+		"read_blob",
+		"write_blob",
+		"completion_budget",
+		"max_in_flight",
+		"in_flight",
+		"stats",
+		"slowlog",
+		"slowlog_config",
+		"adaptive_paging",
+		"future",
         "contact_points",
         "port",
         "protocol_version",
@@ -477,6 +725,7 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 		"load_balance_dc_aware",
 		"token_aware_routing",
 		"latency_aware_routing",
+		"speculative_execution",
 		"tcp_keepalive",
 		"add_trusted_cert",
 		"ssl_cert",
@@ -485,21 +734,49 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 		"ssl_enable",
 		"delete",
 		"close",
+		"share",
+		"shared",
         NULL
     };
 
     enum options {
         OPT_ASYNC,
+        OPT_AWAIT,
         OPT_SELECT,
         OPT_EXEC,
         OPT_CONNECT,
 		OPT_PREPARE,
+		OPT_PREPARED_MANIFEST,
 		OPT_BATCH,
+		OPT_PARTITIONED_BATCH,
+		OPT_COUNTER_ACCUMULATOR,
+		OPT_LOAD,
+		OPT_EXPORT,
+		OPT_SCAN,
+		OPT_MULTIGET,
 		OPT_LIST_KEYSPACES,
 		OPT_LIST_TABLES,
 		OPT_LIST_COLUMNS,
 		OPT_LIST_COLUMN_TYPES,
 		OPT_REIMPORT_COLUMN_TYPE_MAP,
+		OPT_COLUMN_TYPE_MAP_MODE,
+		OPT_UPSERT_CACHE_LIMIT,
+		OPT_UPSERT_CACHE_STATS,
+		OPT_UPSERT_CACHE_FLUSH,
+		OPT_ROW_CACHE,
+		OPT_ROW_CACHE_STATS,
+		OPT_ROW_CACHE_FLUSH,
+		OPT_BLOB_REFERENCES,
+		OPT_READ_BLOB,
+		OPT_WRITE_BLOB,
+		OPT_COMPLETION_BUDGET,
+		OPT_MAX_IN_FLIGHT,
+		OPT_IN_FLIGHT,
+		OPT_STATS,
+		OPT_SLOWLOG,
+		OPT_SLOWLOG_CONFIG,
+		OPT_ADAPTIVE_PAGING,
+		OPT_FUTURE,
         OPT_CONTACT_POINTS,
         OPT_PORT,
         OPT_PROTOCOL_VERSION,
@@ -525,6 +802,7 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 		OPT_LOAD_BALANCE_DC_AWARE,
 		OPT_TOKEN_AWARE_ROUTING,
 		OPT_LATENCY_AWARE_ROUTING,
+		OPT_SPECULATIVE_EXECUTION,
 		OPT_TCP_KEEPALIVE,
 		OPT_ADD_TRUSTED_CERT,
 		OPT_SSL_CERT,
@@ -532,7 +810,9 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 		OPT_SSL_VERIFY_FLAG,
 		OPT_SSL_ENABLE,
 		OPT_DELETE,
-		OPT_CLOSE
+		OPT_CLOSE,
+		OPT_SHARE,
+		OPT_SHARED
     };
 
     /* basic validation of command line arguments */
@@ -547,45 +827,78 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 
     switch ((enum options) optIndex) {
 		case OPT_SELECT: {
-			char *query;
+			char *query = NULL;
 			char *arrayName;
 			char *consistencyName = NULL;
+			char *preparedName = NULL;
 			Tcl_Obj *consistencyObj = NULL;
 			CassConsistency consistency;
+			CassStatement *statement = NULL;
+			casstcl_preparedClientData *pcd = NULL;
 			Tcl_Obj *code;
-			int pagingSize = 100;
+			Tcl_Obj *callbackObj = NULL;
+			int pagingSize = 0;
+			int timeoutMS = -1;
+			int rowStyle = CASSTCL_ROWS_ARRAY;
+			int cache = 0;
 			int arg = 2;
 			int      subOptIndex;
 
 			static CONST char *subOptions[] = {
 				"-pagesize",
 				"-consistency",
+				"-list",
+				"-dict",
+				"-callback",
+				"-timeout",
+				"-cache",
+				"-prepared",
 				NULL
 			};
 
 			enum subOptions {
 				SUBOPT_PAGESIZE,
-				SUBOPT_CONSISTENCY
+				SUBOPT_CONSISTENCY,
+				SUBOPT_LIST,
+				SUBOPT_DICT,
+				SUBOPT_CALLBACK,
+				SUBOPT_TIMEOUT,
+				SUBOPT_CACHE,
+				SUBOPT_PREPARED
 			};
 
-			// if we don't have at least five arguments and an odd number
-			// of arguments at that, it's an error
-			if ((objc < 5) || ((objc & 1) == 0)) {
-				Tcl_WrongNumArgs (interp, 2, objv, "?-pagesize n? query arrayName code");
+			// if we don't have at least three arguments, it's an error
+			if (objc < 3) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-pagesize n|adaptive? ?-consistency level? ?-timeout ms? ?-list|-dict? ?-cache? ?-callback callback? ?-prepared prepared? query|values ?arrayName code?");
 				return TCL_ERROR;
 			}
 
-			while (arg + 3 < objc) {
-				if (Tcl_GetIndexFromObj (interp, objv[arg++], subOptions, "subOption", TCL_EXACT, &subOptIndex) != TCL_OK) {
-					return TCL_ERROR;
+			// stop at the first thing that isn't an option, which is
+			// the query or the values, even if it starts with a dash
+			while (arg + 1 < objc) {
+				if (Tcl_GetIndexFromObj (NULL, objv[arg], subOptions, "subOption", TCL_EXACT, &subOptIndex) != TCL_OK) {
+					break;
 				}
+				arg++;
 
 				switch ((enum subOptions) subOptIndex) {
 					case SUBOPT_PAGESIZE: {
+						if (strcmp (Tcl_GetString (objv[arg]), "adaptive") == 0) {
+							pagingSize = CASSTCL_PAGING_ADAPTIVE;
+							arg++;
+							break;
+						}
+
 						if (Tcl_GetIntFromObj (interp, objv[arg++], &pagingSize) == TCL_ERROR) {
 							Tcl_AppendResult (interp, " while converting paging size", NULL);
 							return TCL_ERROR;
 						}
+
+						if (pagingSize < 1) {
+							Tcl_ResetResult (interp);
+							Tcl_AppendResult (interp, "paging size must be at least 1 or adaptive", NULL);
+							return TCL_ERROR;
+						}
 						break;
 					}
 					case SUBOPT_CONSISTENCY: {
@@ -596,14 +909,133 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 						}
 						break;
 					}
+					case SUBOPT_LIST: {
+						rowStyle = CASSTCL_ROWS_LIST;
+						break;
+					}
+					case SUBOPT_DICT: {
+						rowStyle = CASSTCL_ROWS_DICT;
+						break;
+					}
+					case SUBOPT_CALLBACK: {
+						callbackObj = objv[arg++];
+						break;
+					}
+					case SUBOPT_TIMEOUT: {
+						if (casstcl_obj_to_request_timeout (ct, objv[arg++], &timeoutMS) == TCL_ERROR) {
+							return TCL_ERROR;
+						}
+						break;
+					}
+					case SUBOPT_CACHE: {
+						cache = 1;
+						break;
+					}
+					case SUBOPT_PREPARED: {
+						preparedName = Tcl_GetString (objv[arg++]);
+						break;
+					}
+				}
+			}
+
+			// with a callback the rows go to the callback a page at a
+			// time, without it there has to be an array name and code
+			if (arg + ((callbackObj != NULL) ? 1 : 3) != objc) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-pagesize n|adaptive? ?-consistency level? ?-timeout ms? ?-list|-dict? ?-cache? ?-callback callback? ?-prepared prepared? query|values ?arrayName code?");
+				return TCL_ERROR;
+			}
+
+			if (cache && callbackObj != NULL) {
+				Tcl_ResetResult (interp);
+				Tcl_AppendResult (interp, "-cache can't be used with -callback", NULL);
+				return TCL_ERROR;
+			}
+
+			// with -prepared the argument in place of the query is the
+			// list of values to bind to the prepared statement
+			if (preparedName != NULL) {
+				pcd = casstcl_prepared_command_to_preparedClientData (interp, preparedName);
+				if (pcd == NULL) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "-prepared argument '", preparedName, "' isn't a valid prepared statement object", NULL);
+					return TCL_ERROR;
+				}
+			} else {
+				query = Tcl_GetString (objv[arg]);
+			}
+
+			Tcl_DString cacheKey;
+			Tcl_DString cacheTable;
+
+			Tcl_DStringInit (&cacheKey);
+			Tcl_DStringInit (&cacheTable);
+
+			// the cache is looked in before anything is bound, and
+			// not at all while it is off or the table has upserts
+			// in flight that the cluster may not have made yet
+			if (cache && ct->rowCache.limit > 0 && casstcl_row_cache_key (rowStyle, (consistencyObj != NULL && *consistencyName != '\0') ? &consistency : NULL, query, pcd, objv[arg], &cacheKey, &cacheTable) && !casstcl_row_cache_writing (ct, Tcl_DStringValue (&cacheTable))) {
+				casstcl_rowCacheEntry *entry;
+
+				entry = casstcl_row_cache_lookup (ct, Tcl_DStringValue (&cacheKey));
+				if (entry != NULL) {
+					int evalReturnCode = casstcl_row_cache_eval (ct, entry->columnsObj, entry->rowsObj, rowStyle, objv[arg + 1], objv[arg + 2]);
+
+					Tcl_DStringFree (&cacheKey);
+					Tcl_DStringFree (&cacheTable);
+					Tcl_UnsetVar (interp, Tcl_GetString (objv[arg + 1]), 0);
+					if ((evalReturnCode == TCL_ERROR) || (evalReturnCode == TCL_RETURN)) {
+						return evalReturnCode;
+					}
+					return TCL_OK;
 				}
+			} else {
+				cache = 0;
+			}
+
+			if (pcd != NULL) {
+				int listObjc = 0;
+				Tcl_Obj **listObjv = NULL;
+
+				if (Tcl_ListObjGetElements (interp, objv[arg], &listObjc, &listObjv) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while parsing list of values", NULL);
+					resultCode = TCL_ERROR;
+				} else {
+					resultCode = casstcl_bind_values_from_prepared (pcd, listObjc, listObjv, (consistencyObj != NULL) ? &consistency : NULL, &statement);
+				}
+			} else {
+				statement = cass_statement_new (query, 0);
+				resultCode = casstcl_setStatementConsistency (ct, statement, (consistencyObj != NULL) ? &consistency : NULL);
+			}
+
+			if (resultCode == TCL_ERROR) {
+				Tcl_DStringFree (&cacheKey);
+				Tcl_DStringFree (&cacheTable);
+				return TCL_ERROR;
 			}
 
-			query = Tcl_GetString (objv[arg++]);
+			casstcl_statementInfo info;
+
+			info.text = (pcd != NULL) ? pcd->string : query;
+			info.consistency = (consistencyObj != NULL && *consistencyName != '\0') ? (int)consistency : CASSTCL_CONSISTENCY_DEFAULT;
+
+			if (callbackObj != NULL) {
+				return casstcl_select_async (ct, statement, &info, callbackObj, pagingSize, timeoutMS, rowStyle);
+			}
+
+			arg++;
 			arrayName = Tcl_GetString (objv[arg++]);
 			code = objv[arg++];
 
-			return casstcl_select (ct, query, arrayName, code, pagingSize, (consistencyObj != NULL) ? &consistency : NULL);
+			resultCode = casstcl_select (ct, statement, &info, arrayName, code, pagingSize, timeoutMS, rowStyle, cache ? Tcl_DStringValue (&cacheKey) : NULL, Tcl_DStringValue (&cacheTable));
+			Tcl_DStringFree (&cacheKey);
+			Tcl_DStringFree (&cacheTable);
+			return resultCode;
+		}
+
+		case OPT_AWAIT: {
+			// only reached when await can't yield, see
+			// casstcl_cassObjectNRObjCmd
+			return casstcl_await_unavailable (interp);
 		}
 
 		case OPT_EXEC:
@@ -616,6 +1048,12 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 			char *batchObjName = NULL;
 			int futureFlags = 0;
 			int upsert = 0;
+			int useHandle = 0;
+			int idempotent = 0;
+			int timeoutMS = -1;
+			int statsKind;
+			casstcl_requestTimer timer;
+			casstcl_statementInfo info;
 
 			static CONST char *subOptions[] = {
 				"-callback",
@@ -623,6 +1061,9 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 				"-head",
 				"-error_only",
 				"-upsert",
+				"-handle",
+				"-idempotent",
+				"-timeout",
 				NULL
 			};
 
@@ -631,12 +1072,15 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 				SUBOPT_BATCH,
 				SUBOPT_HEAD,
 				SUBOPT_ERRORONLY,
-				SUBOPT_UPSERT
+				SUBOPT_UPSERT,
+				SUBOPT_HANDLE,
+				SUBOPT_IDEMPOTENT,
+				SUBOPT_TIMEOUT
 			};
 
 			// if we don't have at least three arguments, it's an error
 			if (objc < 3) {
-				Tcl_WrongNumArgs (interp, 2, objv, "?-callback n? ?-batch batchObject? ?-head? ?-array arrayName? ?-table tableName? ?-prepared preparedName? ?-consistency level? statement ?args? OR ?-upsert ?-mapunkown? ?-nocomplain? ?-ifnotexists??");
+				Tcl_WrongNumArgs (interp, 2, objv, "?-callback n? ?-batch batchObject? ?-head? ?-error_only? ?-handle? ?-idempotent? ?-timeout ms? ?-array arrayName? ?-table tableName? ?-prepared preparedName? ?-values list? ?-consistency level? statement ?args? OR ?-upsert ?-mapunkown? ?-nocomplain? ?-ifnotexists??");
 				return TCL_ERROR;
 			}
 
@@ -674,17 +1118,64 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 						upsert = 1;
 						break;
 					}
+
+					case SUBOPT_HANDLE: {
+						useHandle = 1;
+						break;
+					}
+
+					case SUBOPT_IDEMPOTENT: {
+						if (casstcl_idempotence_available (ct) == TCL_ERROR) {
+							return TCL_ERROR;
+						}
+						idempotent = 1;
+						break;
+					}
+
+					case SUBOPT_TIMEOUT: {
+						if (casstcl_obj_to_request_timeout (ct, objv[arg++], &timeoutMS) == TCL_ERROR) {
+							return TCL_ERROR;
+						}
+						break;
+					}
 					
 				}
 			}
 
+			// even with exec if you use -callback it's asynchronous, and
+			// only asynchronous requests count against the in-flight window
+			int async = (((enum options) optIndex == OPT_ASYNC) || (callbackObj != NULL));
+
 			if (batchObjName != NULL) {
+				statsKind = CASSTCL_STATS_BATCH;
+			} else if ((enum options) optIndex == OPT_ASYNC) {
+				statsKind = CASSTCL_STATS_ASYNC;
+			} else {
+				statsKind = CASSTCL_STATS_EXEC;
+			}
+
+			if (batchObjName != NULL) {
+				if (idempotent || timeoutMS >= 0) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "-idempotent and -timeout can't be used with -batch", NULL);
+					return TCL_ERROR;
+				}
+
 				if (arg != objc) {
 					Tcl_ResetResult (interp);
 					Tcl_AppendResult (interp, "batch usage: obj ?-callback callback? ?-head? -batch batchName", NULL);
 					return TCL_ERROR;
 				}
 
+				// a batch can be added to or reset after this returns, so
+				// it is never queued; it always waits for room instead.
+				// it is looked up afterwards since waiting runs events
+				if (async && casstcl_inflight_full (ct)) {
+					if (casstcl_inflight_wait (ct, NULL) == TCL_ERROR) {
+						return TCL_ERROR;
+					}
+				}
+
 				// get the batch object from the command name we extracted
 				casstcl_batchClientData *bcd = casstcl_batch_command_to_batchClientData (interp, batchObjName);
 				if (bcd == NULL) {
@@ -694,37 +1185,104 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 				}
 				const CassBatch *batch = bcd->batch;
 
+				if (async) {
+					futureFlags |= CASSTCL_FUTURE_COUNTED_FLAG;
+					casstcl_inflight_started (ct);
+				}
+				casstcl_stats_start (ct, statsKind, &timer);
+				casstcl_row_cache_writes_copy (&bcd->writes, &timer.writes);
+				info.text = "BATCH";
+				info.consistency = bcd->consistency;
+				casstcl_slowlog_start (ct, &timer, NULL, &info);
 				future = cass_session_execute_batch (ct->session, batch);
 
-			} else if (upsert) {
-				int newObjc = objc - arg;
-				Tcl_Obj *CONST *newObjv = objv + arg;
+			} else {
+				// the slow request log names an upsert by its table
+				Tcl_DString upsertText;
+				char *upsertTable = NULL;
 
-				if (casstcl_make_upsert_statement_from_objv (ct, newObjc, newObjv, NULL, &statement) == TCL_ERROR) {
-					return TCL_ERROR;
-	
-				}
-				
-                future = cass_session_execute (ct->session, statement);
-                cass_statement_free (statement);
+				Tcl_DStringInit (&upsertText);
+				if (upsert) {
+					int newObjc = objc - arg;
+					Tcl_Obj *CONST *newObjv = objv + arg;
 
-			} else {
-				// it's a statement, possibly with arguments
+					if (casstcl_make_upsert_statement_from_objv (ct, newObjc, newObjv, NULL, &statement) == TCL_ERROR) {
+						return TCL_ERROR;
+					}
+					upsertTable = Tcl_GetString (newObjv[newObjc - 2]);
+					Tcl_DStringAppend (&upsertText, "UPSERT ", -1);
+					Tcl_DStringAppend (&upsertText, upsertTable, -1);
+					info.text = Tcl_DStringValue (&upsertText);
+					info.consistency = CASSTCL_CONSISTENCY_DEFAULT;
+				} else {
+					// it's a statement, possibly with arguments
 
-				if (casstcl_make_statement_from_objv (ct, objc, objv, arg, &statement) == TCL_ERROR) {
-					return TCL_ERROR;
+					if (casstcl_make_statement_from_objv (ct, objc, objv, arg, &statement, &info) == TCL_ERROR) {
+						return TCL_ERROR;
+					}
 				}
+				casstcl_statement_set_execution (statement, idempotent, timeoutMS);
+
+				if (!async) {
+					casstcl_stats_start (ct, statsKind, &timer);
+					casstcl_row_cache_write_started (ct, upsertTable, &timer.writes);
+					casstcl_slowlog_start (ct, &timer, statement, &info);
+					future = cass_session_execute (ct->session, statement);
+				} else {
+					futureFlags |= CASSTCL_FUTURE_COUNTED_FLAG;
+
+					// with a full window in queue mode the future is
+					// created now and the statement executed later, from
+					// the event loop, when the window has room for it
+					if (casstcl_inflight_must_queue (ct)) {
+						casstcl_futureClientData *fcd = NULL;
+
+						// the timer is started when the request is
+						// executed rather than now
+						casstcl_stats_start (ct, CASSTCL_STATS_NONE, &timer);
+						timer.kind = statsKind;
+						casstcl_row_cache_write_started (ct, upsertTable, &timer.writes);
+						casstcl_slowlog_start (ct, &timer, statement, &info);
+						Tcl_DStringFree (&upsertText);
+
+						if (useHandle) {
+							resultCode = casstcl_createFutureHandle (ct, NULL, callbackObj, futureFlags, &timer, &fcd);
+						} else {
+							resultCode = casstcl_createFutureObjectCommand (ct, NULL, callbackObj, futureFlags, &timer, &fcd);
+						}
 
-				future = cass_session_execute (ct->session, statement);
+						if (resultCode == TCL_ERROR) {
+							casstcl_stats_discard (&timer);
+							cass_statement_free (statement);
+						} else {
+							casstcl_inflight_enqueue (ct, statement, fcd);
+						}
+						break;
+					}
+
+					if (casstcl_inflight_full (ct)) {
+						if (casstcl_inflight_wait (ct, NULL) == TCL_ERROR) {
+							Tcl_DStringFree (&upsertText);
+							cass_statement_free (statement);
+							return TCL_ERROR;
+						}
+					}
+
+					casstcl_stats_start (ct, statsKind, &timer);
+					casstcl_row_cache_write_started (ct, upsertTable, &timer.writes);
+					casstcl_slowlog_start (ct, &timer, statement, &info);
+					future = casstcl_inflight_execute (ct, statement);
+				}
+				Tcl_DStringFree (&upsertText);
 				cass_statement_free (statement);
 			}
 
-			// even with exec if you use -callback it's asynchronous
-			if (((enum options) optIndex == OPT_EXEC) && (callbackObj == NULL)) {
+			if (!async) {
 				// synchronous
 				cass_future_wait (future);
 
 				CassError rc = cass_future_error_code (future);
+				casstcl_stats_finish (&timer, future, rc);
 				if (rc != CASS_OK) {
 					resultCode = casstcl_future_error_to_tcl (ct, rc, future);
 				}
@@ -732,7 +1290,11 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 				cass_future_free (future);
 			} else {
 				// asynchronous
-				if (casstcl_createFutureObjectCommand (ct, future, callbackObj, futureFlags) == TCL_ERROR) {
+				if (useHandle) {
+					if (casstcl_createFutureHandle (ct, future, callbackObj, futureFlags, &timer, NULL) == TCL_ERROR) {
+						resultCode = TCL_ERROR;
+					}
+				} else if (casstcl_createFutureObjectCommand (ct, future, callbackObj, futureFlags, &timer, NULL) == TCL_ERROR) {
 					resultCode = TCL_ERROR;
 				}
 			}
@@ -747,18 +1309,23 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 			int arg = 2;
 			int      subOptIndex;
 			Tcl_Obj *callbackObj = NULL;
+			Tcl_Obj *manifestObj = NULL;
+			casstcl_manifest *manifest = NULL;
+			casstcl_futureClientData *fcd = NULL;
 
 			static CONST char *subOptions[] = {
 				"-callback",
+				"-prepare",
 				NULL
 			};
 
 			enum subOptions {
-				SUBOPT_CALLBACK
+				SUBOPT_CALLBACK,
+				SUBOPT_PREPARE
 			};
 
 			if (objc < 2) {
-				Tcl_WrongNumArgs (interp, 2, objv, "?keyspace?");
+				Tcl_WrongNumArgs (interp, 2, objv, "?-callback callback? ?-prepare manifest? ?keyspace?");
 				return TCL_ERROR;
 			}
 
@@ -776,6 +1343,28 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 						callbackObj = objv[arg++];
 						break;
 					}
+
+					case SUBOPT_PREPARE: {
+						manifestObj = objv[arg++];
+						break;
+					}
+				}
+			}
+
+			if (casstcl_session_not_shared (ct, "connected") == TCL_ERROR) {
+				return TCL_ERROR;
+			}
+
+			if (manifestObj != NULL) {
+				if (callbackObj != NULL && ct->connectManifest != NULL) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "a connect with -prepare is already under way", NULL);
+					return TCL_ERROR;
+				}
+
+				manifest = casstcl_manifest_new (ct, manifestObj);
+				if (manifest == NULL) {
+					return TCL_ERROR;
 				}
 			}
 
@@ -787,18 +1376,31 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 			}
 
 			if (callbackObj != NULL) {
-				// asynchronous
-				if (casstcl_createFutureObjectCommand (ct, future, callbackObj, 0) == TCL_ERROR) {
+				// asynchronous; the callback of a connect with a manifest
+				// isn't run until its statements have been prepared
+				if (casstcl_createFutureObjectCommand (ct, future, callbackObj, 0, NULL, &fcd) == TCL_ERROR) {
 					resultCode = TCL_ERROR;
+					if (manifest != NULL) {
+						casstcl_manifest_free (manifest);
+					}
+				} else if (manifest != NULL) {
+					casstcl_manifest_connect_async (manifest, fcd);
 				}
 			} else {
 				cass_future_wait (future);
 
 				rc = cass_future_error_code (future);
-				if (rc == CASS_OK) {
+				if (rc == CASS_OK && manifest != NULL) {
+					// the statements are prepared while the schema is
+					// imported
+					resultCode = casstcl_manifest_connect (manifest);
+				} else if (rc == CASS_OK) {
 					// import the schema keyspaces, tables, columns and types
 					casstcl_reimport_column_type_map (ct);
 				} else {
+					if (manifest != NULL) {
+						casstcl_manifest_free (manifest);
+					}
 					resultCode = casstcl_future_error_to_tcl (ct, rc, future);
 				}
 
@@ -808,20 +1410,15 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 		}
 
 		case OPT_PREPARE: {
-			char *query = NULL;
 			CassError rc = CASS_OK;
 			CassFuture *future;
-			char *statementString;
-			int statementStringLength;
 
 			if (objc != 5) {
 				Tcl_WrongNumArgs (interp, 2, objv, "name table statement");
 				return TCL_ERROR;
 			}
 
-			statementString = Tcl_GetStringFromObj (objv[4], &statementStringLength);
-
-			future = cass_session_prepare (ct->session, statementString);
+			future = cass_session_prepare (ct->session, Tcl_GetString (objv[4]));
 
 			cass_future_wait (future);
 
@@ -829,124 +1426,508 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 			if (rc != CASS_OK) {
 				resultCode = casstcl_future_error_to_tcl (ct, rc, future);
 				cass_future_free (future);
-				Tcl_AppendResult (interp, " while attempting to prepare statement '", query, "'", NULL);
+				Tcl_AppendResult (interp, " while attempting to prepare statement '", Tcl_GetString (objv[4]), "'", NULL);
 				break;
 			}
 
 			const CassPrepared *cassPrepared = cass_future_get_prepared (future);
 			cass_future_free (future);
 
-			// allocate one of our cass prepared data objects for Tcl
-			// and configure it
-			casstcl_preparedClientData *pcd = (casstcl_preparedClientData *)ckalloc (sizeof (casstcl_preparedClientData));
+			resultCode = casstcl_createPreparedObjectCommand (ct, Tcl_GetString (objv[2]), objv[3], objv[4], cassPrepared);
+			break;
+		}
+
+		case OPT_PREPARED_MANIFEST: {
+			if (objc > 3) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?name?");
+				return TCL_ERROR;
+			}
+
+			if (objc == 2) {
+				Tcl_SetObjResult (interp, casstcl_manifest_names (ct));
+				break;
+			}
+
+			return casstcl_manifest_lookup (ct, objv[2]);
+		}
+
+		case OPT_BATCH: {
+			CassBatchType cassBatchType = CASS_BATCH_TYPE_LOGGED;
+
+			if (objc < 3 || objc > 4) {
+				Tcl_WrongNumArgs (interp, 1, objv, "name ?type?");
+				return TCL_ERROR;
+			}
+
+			if (objc == 4) {
+				if (casstcl_obj_to_cass_batch_type (interp, objv[3], &cassBatchType) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while determining batch type", NULL);
+					return TCL_ERROR;
+				}
+			}
+
+			return casstcl_createBatchObjectCommand (ct, Tcl_GetString (objv[2]), cassBatchType);
+		}
+
+		case OPT_PARTITIONED_BATCH: {
+			// a batch that only ever holds one partition is the case for
+			// unlogged batches, so that is the default here
+			CassBatchType cassBatchType = CASS_BATCH_TYPE_UNLOGGED;
+
+			if (objc < 3 || objc > 4) {
+				Tcl_WrongNumArgs (interp, 2, objv, "name ?type?");
+				return TCL_ERROR;
+			}
+
+			if (objc == 4) {
+				if (casstcl_obj_to_cass_batch_type (interp, objv[3], &cassBatchType) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while determining batch type", NULL);
+					return TCL_ERROR;
+				}
+			}
+
+			return casstcl_createPartitionedBatchObjectCommand (ct, Tcl_GetString (objv[2]), cassBatchType);
+		}
+
+		case OPT_COUNTER_ACCUMULATOR: {
+			if (objc != 3) {
+				Tcl_WrongNumArgs (interp, 2, objv, "name");
+				return TCL_ERROR;
+			}
+
+			return casstcl_createCounterAccumulatorObjectCommand (ct, Tcl_GetString (objv[2]));
+		}
+
+		case OPT_LOAD: {
+			if (objc < 6) {
+				Tcl_WrongNumArgs (interp, 2, objv, "-table tableName -channel channel ?-format csv|tsv|dictlines? ?-columns columnList? ?-window n? ?-maxerrors n? ?-consistency level? ?-ifnotexists?");
+				return TCL_ERROR;
+			}
+
+			return casstcl_load_from_objv (ct, objc - 2, &objv[2]);
+		}
+
+		case OPT_EXPORT: {
+			if (objc < 5) {
+				Tcl_WrongNumArgs (interp, 2, objv, "-channel channel ?-format csv|tsv|json? ?-pagesize n? ?-consistency level? ?-noheader? query");
+				return TCL_ERROR;
+			}
+
+			return casstcl_export_from_objv (ct, objc - 2, &objv[2]);
+		}
+
+		case OPT_SCAN: {
+			if (objc < 5) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-columns list? ?-where condition? ?-splits n? ?-parallelism n? ?-pagesize n? ?-consistency level? ?-list|-dict? table arrayName code");
+				return TCL_ERROR;
+			}
+
+			return casstcl_scan_from_objv (ct, objc - 2, &objv[2]);
+		}
+
+		case OPT_MULTIGET: {
+			if (objc < 4) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-concurrency n? ?-consistency level? ?-timeout ms? ?-list|-dict? ?-array arrayName? ?-errors varName? prepared keyList");
+				return TCL_ERROR;
+			}
+
+			return casstcl_multiget_from_objv (ct, objc - 2, &objv[2]);
+		}
+
+		case OPT_LIST_KEYSPACES: {
+			Tcl_Obj *obj = NULL;
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
+			}
+
+			resultCode = casstcl_list_keyspaces (ct, &obj);
+			if (obj != NULL) {
+				Tcl_SetObjResult (ct->interp, obj);
+			}
+			break;
+		}
+
+		case OPT_LIST_TABLES: {
+			Tcl_Obj *obj = NULL;
+			if (objc != 3) {
+				Tcl_WrongNumArgs (interp, 2, objv, "keyspace");
+				return TCL_ERROR;
+			}
+
+			char *keyspace = Tcl_GetString (objv[2]);
+
+			resultCode = casstcl_list_tables (ct, keyspace, &obj);
+			if (obj != NULL) {
+				Tcl_SetObjResult (ct->interp, obj);
+			}
+			break;
+		}
+
+		case OPT_LIST_COLUMNS:
+		case OPT_LIST_COLUMN_TYPES: {
+			Tcl_Obj *obj = NULL;
+			if (objc != 4) {
+				Tcl_WrongNumArgs (interp, 2, objv, "keyspace tableName");
+				return TCL_ERROR;
+			}
+
+			char *keyspace = Tcl_GetString (objv[2]);
+			char *table = Tcl_GetString (objv[3]);
+
+			resultCode = casstcl_list_columns (ct, keyspace, table, (optIndex == OPT_LIST_COLUMN_TYPES), &obj);
+			if (obj != NULL) {
+				Tcl_SetObjResult (ct->interp, obj);
+			}
+			break;
+		}
+
+		case OPT_REIMPORT_COLUMN_TYPE_MAP: {
+			casstcl_tableInfo *tableInfo;
+
+			if (objc != 2 && objc != 3) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?keyspace.table?");
+				return TCL_ERROR;
+			}
+
+			if (objc == 2) {
+				resultCode = casstcl_reimport_column_type_map (ct);
+				break;
+			}
+
+			resultCode = casstcl_import_table (ct, Tcl_GetString (objv[2]), &tableInfo);
+			if (resultCode == TCL_OK && tableInfo == NULL) {
+				Tcl_ResetResult (interp);
+				Tcl_AppendResult (interp, "table '", Tcl_GetString (objv[2]), "' isn't in the schema metadata", NULL);
+				resultCode = TCL_ERROR;
+			}
+			break;
+		}
+
+		case OPT_COLUMN_TYPE_MAP_MODE: {
+			int mode;
+
+			static CONST char *modes[] = {
+				"eager",
+				"lazy",
+				NULL
+			};
+
+			if (objc != 2 && objc != 3) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?eager|lazy?");
+				return TCL_ERROR;
+			}
+
+			if (objc == 3) {
+				if (Tcl_GetIndexFromObj (interp, objv[2], modes, "mode", TCL_EXACT, &mode) != TCL_OK) {
+					return TCL_ERROR;
+				}
+
+				// the map is rebuilt to suit at the next connect or
+				// reimport; until then a lazy one fills in as it goes
+				ct->columnTypeMap.lazy = mode;
+			}
+
+			Tcl_SetObjResult (interp, Tcl_NewStringObj (modes[ct->columnTypeMap.lazy ? 1 : 0], -1));
+			break;
+		}
+
+		case OPT_UPSERT_CACHE_LIMIT: {
+			int limit = 0;
+
+			if (objc < 2 || objc > 3) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?limit?");
+				return TCL_ERROR;
+			}
+
+			if (objc == 3) {
+				if (Tcl_GetIntFromObj (interp, objv[2], &limit) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting limit element", NULL);
+					return TCL_ERROR;
+				}
+
+				if (limit < 0) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "upsert cache limit must not be negative", NULL);
+					return TCL_ERROR;
+				}
+
+				casstcl_prepared_cache_set_limit (&ct->preparedCache, limit);
+			}
+
+			Tcl_SetObjResult (interp, Tcl_NewIntObj (ct->preparedCache.limit));
+			break;
+		}
+
+		case OPT_UPSERT_CACHE_STATS: {
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
+			}
+
+			Tcl_SetObjResult (interp, casstcl_prepared_cache_stats_obj (&ct->preparedCache));
+			break;
+		}
+
+		case OPT_UPSERT_CACHE_FLUSH: {
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
+			}
+
+			casstcl_prepared_cache_flush (&ct->preparedCache);
+			break;
+		}
+
+		case OPT_ROW_CACHE: {
+			return casstcl_row_cache_configure (ct, objc, objv);
+		}
+
+		case OPT_ROW_CACHE_STATS: {
+			if (objc > 3 || (objc == 3 && strcmp (Tcl_GetString (objv[2]), "-reset") != 0)) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-reset?");
+				return TCL_ERROR;
+			}
+
+			Tcl_SetObjResult (interp, casstcl_row_cache_stats_obj (ct, (objc == 3)));
+			break;
+		}
+
+		case OPT_ROW_CACHE_FLUSH: {
+			if (objc > 3) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?table?");
+				return TCL_ERROR;
+			}
+
+			Tcl_SetObjResult (interp, Tcl_NewIntObj (casstcl_row_cache_invalidate (ct, (objc == 3) ? Tcl_GetString (objv[2]) : NULL)));
+			break;
+		}
+
+		case OPT_BLOB_REFERENCES: {
+			int minimum = 0;
+
+			if (objc < 2 || objc > 3) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?minimumSize?");
+				return TCL_ERROR;
+			}
+
+			if (objc == 3) {
+				if (Tcl_GetIntFromObj (interp, objv[2], &minimum) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting minimumSize element", NULL);
+					return TCL_ERROR;
+				}
+
+				if (minimum < 0) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "blob reference size must not be negative", NULL);
+					return TCL_ERROR;
+				}
+
+				ct->blobRefMinimum = minimum;
+			}
+
+			Tcl_SetObjResult (interp, Tcl_NewIntObj (ct->blobRefMinimum));
+			break;
+		}
+
+		case OPT_READ_BLOB: {
+			Tcl_Channel channel;
+			Tcl_WideInt size = -1;
+			int mode;
+
+			if (objc < 3 || objc > 4) {
+				Tcl_WrongNumArgs (interp, 2, objv, "channel ?size?");
+				return TCL_ERROR;
+			}
+
+			channel = Tcl_GetChannel (interp, Tcl_GetString (objv[2]), &mode);
+			if (channel == NULL) {
+				return TCL_ERROR;
+			}
+
+			if (!(mode & TCL_READABLE)) {
+				Tcl_ResetResult (interp);
+				Tcl_AppendResult (interp, "channel \"", Tcl_GetString (objv[2]), "\" wasn't opened for reading", NULL);
+				return TCL_ERROR;
+			}
+
+			if (objc == 4) {
+				if (Tcl_GetWideIntFromObj (interp, objv[3], &size) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting size element", NULL);
+					return TCL_ERROR;
+				}
+
+				if (size < 0) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "blob size must not be negative", NULL);
+					return TCL_ERROR;
+				}
+			}
+
+			return casstcl_blob_from_channel (interp, channel, size);
+		}
+
+		case OPT_WRITE_BLOB: {
+			Tcl_Channel channel;
+			int mode;
+
+			if (objc != 4) {
+				Tcl_WrongNumArgs (interp, 2, objv, "channel blob");
+				return TCL_ERROR;
+			}
+
+			channel = Tcl_GetChannel (interp, Tcl_GetString (objv[2]), &mode);
+			if (channel == NULL) {
+				return TCL_ERROR;
+			}
+
+			if (!(mode & TCL_WRITABLE)) {
+				Tcl_ResetResult (interp);
+				Tcl_AppendResult (interp, "channel \"", Tcl_GetString (objv[2]), "\" wasn't opened for writing", NULL);
+				return TCL_ERROR;
+			}
 
-			pcd->cass_prepared_magic = CASS_PREPARED_MAGIC;
-			pcd->ct = ct;
-			pcd->prepared = cassPrepared;
+			return casstcl_blob_to_channel (interp, channel, objv[3]);
+		}
 
-			pcd->string = ckalloc (statementStringLength + 1);
-			strncpy (pcd->string, statementString, statementStringLength);
+		case OPT_COMPLETION_BUDGET: {
+			int budget = 0;
 
-			pcd->tableNameObj = objv[3];
-			Tcl_IncrRefCount (pcd->tableNameObj);
+			if (objc < 2 || objc > 3) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?budget?");
+				return TCL_ERROR;
+			}
 
+			if (objc == 3) {
+				if (Tcl_GetIntFromObj (interp, objv[2], &budget) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting budget element", NULL);
+					return TCL_ERROR;
+				}
 
-			char *commandName = Tcl_GetString (objv[2]);
+				if (budget < 0) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "completion budget must not be negative", NULL);
+					return TCL_ERROR;
+				}
 
-#define PREPARED_STRING_FORMAT "prepared%lu"
-			// if commandName is #auto, generate a unique name for the object
-			int autoGeneratedName = 0;
-			if (strcmp (commandName, "#auto") == 0) {
-				static unsigned long nextAutoCounter = 0;
-				int baseNameLength = snprintf (NULL, 0, PREPARED_STRING_FORMAT, nextAutoCounter) + 1;
-				commandName = ckalloc (baseNameLength);
-				snprintf (commandName, baseNameLength, PREPARED_STRING_FORMAT, nextAutoCounter++);
-				autoGeneratedName = 1;
+				ct->completionBudget = budget;
 			}
 
-			// create a Tcl command to interface to cass
-			pcd->cmdToken = Tcl_CreateObjCommand (interp, commandName, casstcl_preparedObjectObjCmd, pcd, casstcl_preparedObjectDelete);
-			Tcl_SetObjResult (interp, Tcl_NewStringObj (commandName, -1));
-			if (autoGeneratedName == 1) {
-				ckfree(commandName);
-			}
+			Tcl_SetObjResult (interp, Tcl_NewIntObj (ct->completionBudget));
 			break;
 		}
 
-		case OPT_BATCH: {
-			CassBatchType cassBatchType = CASS_BATCH_TYPE_LOGGED;
+		case OPT_MAX_IN_FLIGHT: {
+			int limit = 0;
+			int mode = ct->inFlightMode;
 
-			if (objc < 3 || objc > 4) {
-				Tcl_WrongNumArgs (interp, 1, objv, "name ?type?");
+			static CONST char *modes[] = {
+				"block",
+				"queue",
+				NULL
+			};
+
+			if (objc != 2 && objc != 3 && objc != 5) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?limit? ?-mode block|queue?");
 				return TCL_ERROR;
 			}
 
-			if (objc == 4) {
-				if (casstcl_obj_to_cass_batch_type (interp, objv[3], &cassBatchType) == TCL_ERROR) {
-					Tcl_AppendResult (interp, " while determining batch type", NULL);
+			if (objc == 5) {
+				if (strcmp (Tcl_GetString (objv[3]), "-mode") != 0) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "bad option \"", Tcl_GetString (objv[3]), "\": must be -mode", NULL);
+					return TCL_ERROR;
+				}
+
+				if (Tcl_GetIndexFromObj (interp, objv[4], modes, "mode", TCL_EXACT, &mode) != TCL_OK) {
 					return TCL_ERROR;
 				}
 			}
 
-			return casstcl_createBatchObjectCommand (ct, Tcl_GetString (objv[2]), cassBatchType);
+			if (objc >= 3) {
+				if (Tcl_GetIntFromObj (interp, objv[2], &limit) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting limit element", NULL);
+					return TCL_ERROR;
+				}
+
+				if (limit < 0) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "in-flight limit must not be negative", NULL);
+					return TCL_ERROR;
+				}
+
+				// raising or removing the limit may let queued requests
+				// go, which the event source takes care of
+				ct->maxInFlight = limit;
+				ct->inFlightMode = (mode == 1) ? CASSTCL_INFLIGHT_QUEUE : CASSTCL_INFLIGHT_BLOCK;
+				Tcl_ThreadAlert (ct->threadId);
+			}
+
+			Tcl_SetObjResult (interp, Tcl_NewIntObj (ct->maxInFlight));
+			break;
 		}
 
-		case OPT_LIST_KEYSPACES: {
-			Tcl_Obj *obj = NULL;
+		case OPT_IN_FLIGHT: {
 			if (objc != 2) {
 				Tcl_WrongNumArgs (interp, 2, objv, "");
 				return TCL_ERROR;
 			}
 
-			resultCode = casstcl_list_keyspaces (ct, &obj);
-			if (obj != NULL) {
-				Tcl_SetObjResult (ct->interp, obj);
-			}
+			Tcl_SetObjResult (interp, casstcl_inflight_stats_obj (ct));
 			break;
 		}
 
-		case OPT_LIST_TABLES: {
-			Tcl_Obj *obj = NULL;
-			if (objc != 3) {
-				Tcl_WrongNumArgs (interp, 2, objv, "keyspace");
+		case OPT_STATS: {
+			if (objc > 3 || (objc == 3 && strcmp (Tcl_GetString (objv[2]), "-reset") != 0)) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-reset?");
 				return TCL_ERROR;
 			}
 
-			char *keyspace = Tcl_GetString (objv[2]);
-
-			resultCode = casstcl_list_tables (ct, keyspace, &obj);
-			if (obj != NULL) {
-				Tcl_SetObjResult (ct->interp, obj);
+			// the statistics up to the reset are returned, so that none
+			// are lost between looking at them and clearing them
+			Tcl_SetObjResult (interp, casstcl_stats_obj (ct));
+			if (objc == 3) {
+				casstcl_stats_reset (ct);
 			}
 			break;
 		}
 
-		case OPT_LIST_COLUMNS:
-		case OPT_LIST_COLUMN_TYPES: {
-			Tcl_Obj *obj = NULL;
-			if (objc != 4) {
-				Tcl_WrongNumArgs (interp, 2, objv, "keyspace tableName");
+		case OPT_SLOWLOG: {
+			if (objc > 3 || (objc == 3 && strcmp (Tcl_GetString (objv[2]), "-reset") != 0)) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-reset?");
 				return TCL_ERROR;
 			}
 
-			char *keyspace = Tcl_GetString (objv[2]);
-			char *table = Tcl_GetString (objv[3]);
-
-			resultCode = casstcl_list_columns (ct, keyspace, table, (optIndex == OPT_LIST_COLUMN_TYPES), &obj);
-			if (obj != NULL) {
-				Tcl_SetObjResult (ct->interp, obj);
-			}
+			Tcl_SetObjResult (interp, casstcl_slowlog_obj (ct, (objc == 3)));
 			break;
 		}
 
-		case OPT_REIMPORT_COLUMN_TYPE_MAP: {
-			if (objc != 2) {
-				Tcl_WrongNumArgs (interp, 2, objv, "");
+		case OPT_SLOWLOG_CONFIG: {
+			return casstcl_slowlog_configure (ct, objc, objv);
+		}
+
+		case OPT_ADAPTIVE_PAGING: {
+			return casstcl_paging_policy_cmd (ct, objc, objv);
+		}
+
+		case OPT_FUTURE: {
+			casstcl_futureClientData *fcd;
+
+			if (objc < 4) {
+				Tcl_WrongNumArgs (interp, 2, objv, "handle subcommand ?args?");
 				return TCL_ERROR;
 			}
 
-			resultCode = casstcl_reimport_column_type_map (ct);
-			break;
+			fcd = casstcl_future_handle_to_futureClientData (ct, objv[2]);
+			if (fcd == NULL) {
+				Tcl_ResetResult (interp);
+				Tcl_AppendResult (interp, "future handle '", Tcl_GetString (objv[2]), "' doesn't exist or has been deleted", NULL);
+				return TCL_ERROR;
+			}
+
+			// the handle and everything after it are the same as the
+			// arguments to a future object command
+			return casstcl_futureObjectObjCmd ((ClientData)fcd, interp, objc - 2, objv + 2);
 		}
 
 		case OPT_CONTACT_POINTS: {
@@ -1360,6 +2341,10 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 			break;
 		}
 
+		case OPT_SPECULATIVE_EXECUTION: {
+			return casstcl_speculative_execution (ct, objc, objv);
+		}
+
 		case OPT_TCP_KEEPALIVE: {
 			int enable = 0;
 			int delaySecs = 0;
@@ -1493,7 +2478,11 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 				return TCL_ERROR;
 			}
 
-			cass_session_close (ct->session);
+			// a shared session is closed when the last object attached
+			// to it goes away
+			if (ct->shared == NULL) {
+				cass_session_close (ct->session);
+			}
 			Tcl_DeleteCommandFromToken (ct->interp, ct->cmdToken);
 			break;
 		}
@@ -1504,9 +2493,33 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
 				return TCL_ERROR;
 			}
 
+			if (casstcl_session_not_shared (ct, "closed") == TCL_ERROR) {
+				return TCL_ERROR;
+			}
+
 			cass_session_close (ct->session);
 			break;
 		}
+
+		case OPT_SHARE: {
+			if (objc != 3) {
+				Tcl_WrongNumArgs (interp, 2, objv, "sharedName");
+				return TCL_ERROR;
+			}
+
+			resultCode = casstcl_shared_share (ct, Tcl_GetString (objv[2]));
+			break;
+		}
+
+		case OPT_SHARED: {
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
+			}
+
+			Tcl_SetObjResult (interp, Tcl_NewStringObj ((ct->shared != NULL) ? ct->shared->name : "", -1));
+			break;
+		}
 	}
 
     return resultCode;
@@ -1530,7 +2543,9 @@ casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj
  *   It returns TCL_OK if all went well
  *
  *   This uses casstcl_make_upsert_statement to make the statement after
- *   it figures the arguments thereto
+ *   it figures the arguments thereto.  Unless -ifnotexists is given the
+ *   statement is marked idempotent, so that the driver may retry it or
+ *   execute it speculatively
  *
  * Results:
  *      A standard Tcl result.
@@ -1597,233 +2612,18 @@ casstcl_make_upsert_statement_from_objv (casstcl_sessionClientData *ct, int objc
 
 	char *tableName = Tcl_GetString (objv[objc - 2]);
 
-	return casstcl_make_upsert_statement (ct, tableName, objv[objc - 1], consistencyPtr, statementPtr, mapUnknown, dropUnknown, ifNotExists);
-}
-
-/*
- *----------------------------------------------------------------------
- *
- * casstcl_list_keyspaces --
- *
- *      Return a list of the extant keyspaces in the cluster by
- *      examining the metadata managed by the driver.
- *
- *      The cpp-driver docs indicate that the driver stays abreast with
- *      changes to the schema so we prefer to ask it rather than
- *      caching our own copy, or something.
- *
- * Results:
- *      A standard Tcl result.
- *
- *----------------------------------------------------------------------
- */
-int
-casstcl_list_keyspaces (casstcl_sessionClientData *ct, Tcl_Obj **objPtr) {
-	const CassSchema *schema = cass_session_get_schema(ct->session);
-	CassIterator *iterator = cass_iterator_from_schema(schema);
-	Tcl_Obj *listObj = Tcl_NewObj();
-	int tclReturn = TCL_OK;
-
-	while (cass_iterator_next(iterator)) {
-		CassString name;
-		const CassSchemaMeta *schemaMeta = cass_iterator_get_schema_meta (iterator);
-
-		const CassSchemaMetaField* field = cass_schema_meta_get_field(schemaMeta, "keyspace_name");
-		cass_value_get_string(cass_schema_meta_field_value(field), &name.data, &name.length);
-		if (Tcl_ListObjAppendElement (ct->interp, listObj, Tcl_NewStringObj (name.data, name.length)) == TCL_ERROR) {
-			tclReturn = TCL_ERROR;
-			break;
-		}
-	}
-	cass_iterator_free(iterator);
-	cass_schema_free(schema);
-	*objPtr = listObj;
-	return tclReturn;
-}
-
-/*
- *----------------------------------------------------------------------
- *
- * casstcl_list_tables --
- *
- *      Set the Tcl result to a list of the extant tables in a keyspace by
- *      examining the metadata managed by the driver.
- *
- *      This is cool because the driver will update the metadata if the
- *      schema changes during the session and further examinations of the
- *      metadata by the casstcl metadata-accessing functions will see the
- *      changes
- *
- * Results:
- *      A standard Tcl result.
- *
- *----------------------------------------------------------------------
- */
-int
-casstcl_list_tables (casstcl_sessionClientData *ct, char *keyspace, Tcl_Obj **objPtr) {
-	const CassSchema *schema = cass_session_get_schema(ct->session);
-	const CassSchemaMeta *keyspaceMeta = cass_schema_get_keyspace (schema, keyspace);
-	Tcl_Interp *interp = ct->interp;
-
-	if (keyspaceMeta == NULL) {
-		Tcl_ResetResult (interp);
-		Tcl_AppendResult (interp, "keyspace '", keyspace, "' not found", NULL);
-		return TCL_ERROR;
-	}
-
-	CassIterator *iterator = cass_iterator_from_schema_meta (keyspaceMeta);
-	Tcl_Obj *listObj = Tcl_NewObj();
-	int tclReturn = TCL_OK;
-
-	while (cass_iterator_next(iterator)) {
-		CassString name;
-		const CassSchemaMeta *tableMeta = cass_iterator_get_schema_meta (iterator);
-
-		assert (cass_schema_meta_type(tableMeta) == CASS_SCHEMA_META_TYPE_TABLE);
-
-		const CassSchemaMetaField* field = cass_schema_meta_get_field(tableMeta, "columnfamily_name");
-		assert (field != NULL);
-		cass_value_get_string(cass_schema_meta_field_value(field), &name.data, &name.length);
-		if (Tcl_ListObjAppendElement (interp, listObj, Tcl_NewStringObj (name.data, name.length)) == TCL_ERROR) {
-			tclReturn = TCL_ERROR;
-			break;
-		}
-	}
-	cass_iterator_free(iterator);
-	cass_schema_free(schema);
-	*objPtr = listObj;
-	return tclReturn;
-}
-
-/*
- *----------------------------------------------------------------------
- *
- * casstcl_list_columns --
- *
- *      Set a Tcl object pointer to a list of the extant columns in the
- *      specified table in the specified keyspace by examining the
- *      metadata managed by the driver.
- *
- *      If includeTypes is 1 then instead of listing just the columns it
- *      also lists their data types, as a list of key-value pairs.
- *
- * Results:
- *      A standard Tcl result.
- *
- *----------------------------------------------------------------------
- */
-int
-casstcl_list_columns (casstcl_sessionClientData *ct, char *keyspace, char *table, int includeTypes, Tcl_Obj **objPtr) {
-	const CassSchema *schema = cass_session_get_schema(ct->session);
-	Tcl_Interp *interp = ct->interp;
-
-	// locate the keyspace
-	const CassSchemaMeta *keyspaceMeta = cass_schema_get_keyspace (schema, keyspace);
-
-	if (keyspaceMeta == NULL) {
-		Tcl_ResetResult (interp);
-		Tcl_AppendResult (interp, "keyspace '", keyspace, "' not found", NULL);
-		return TCL_ERROR;
-	}
-
-	// locate the table within the keyspace
-	const CassSchemaMeta *tableMeta = cass_schema_meta_get_entry (keyspaceMeta, table);
-
-	if (tableMeta == NULL) {
-		Tcl_ResetResult (interp);
-		Tcl_AppendResult (interp, "table '", table, "' not found in keyspace '", keyspace, "'", NULL);
+	if (casstcl_make_upsert_statement (ct, tableName, objv[objc - 1], consistencyPtr, statementPtr, mapUnknown, dropUnknown, ifNotExists) == TCL_ERROR) {
 		return TCL_ERROR;
 	}
 
-	// prepare to iterate on the columns within the table
-	CassIterator *iterator = cass_iterator_from_schema_meta (tableMeta);
-	Tcl_Obj *listObj = Tcl_NewObj();
-	int tclReturn = TCL_OK;
-
-	// iterate on the columns within the table
-	while (cass_iterator_next(iterator)) {
-		CassString name;
-		const CassSchemaMeta *columnMeta = cass_iterator_get_schema_meta (iterator);
-
-		assert (cass_schema_meta_type(columnMeta) == CASS_SCHEMA_META_TYPE_COLUMN);
-
-		// get the field name and append it to the list we are creating
-		const CassSchemaMetaField* field = cass_schema_meta_get_field(columnMeta, "column_name");
-		assert (field != NULL);
-		const CassValue *fieldValue = cass_schema_meta_field_value(field);
-		CassValueType valueType = cass_value_type (fieldValue);
-
-		// it's a crash if you don't check the data type of valueType
-		// there's something fishy in system.IndexInfo, a field that
-		// doesn't  have a column name
-		if (valueType != CASS_VALUE_TYPE_VARCHAR) {
-			continue;
-		}
-		cass_value_get_string(fieldValue, &name.data, &name.length);
-		if (Tcl_ListObjAppendElement (interp, listObj, Tcl_NewStringObj (name.data, name.length)) == TCL_ERROR) {
-			tclReturn = TCL_ERROR;
-			break;
-		}
-		// if including types then get the data type and append it to the
-		// list too
-		if (includeTypes) {
-			CassString name;
-			const CassSchemaMetaField* field = cass_schema_meta_get_field (columnMeta, "validator");
-			assert (field != NULL);
-
-			cass_value_get_string(cass_schema_meta_field_value(field), &name.data, &name.length);
-
-			// check the cache array directly from C to avoid calling
-			// Tcl_Eval if possible
-			Tcl_Obj *elementObj = Tcl_GetVar2Ex (interp, "::casstcl::validatorTypeLookupCache", name.data, (TCL_GLOBAL_ONLY));
-
-			// not there, gotta call Tcl to do the heavy lifting
-			if (elementObj == NULL) {
-				Tcl_Obj *evalObjv[2];
-				// construct a call to our casstcl.tcl library function
-				// validator_to_type to translate the value to a cassandra
-				// data type to text/list
-				evalObjv[0] = Tcl_NewStringObj ("::casstcl::validator_to_type", -1);
-
-				evalObjv[1] = Tcl_NewStringObj (name.data, name.length);
-
-				Tcl_IncrRefCount (evalObjv[0]);
-				Tcl_IncrRefCount (evalObjv[1]);
-				tclReturn = Tcl_EvalObjv (interp, 2, evalObjv, (TCL_EVAL_GLOBAL|TCL_EVAL_DIRECT));
-				Tcl_DecrRefCount(evalObjv[0]);
-				Tcl_DecrRefCount(evalObjv[1]);
-
-				if (tclReturn == TCL_ERROR) {
-					goto error;
-				}
-				tclReturn = TCL_OK;
-
-				elementObj = Tcl_GetObjResult (interp);
-			}
-
-			// we got here, either we found elementObj by looking it up
-			// from the ::casstcl::validatorTypeLookCache array or
-			// by invoking eval on ::casstcl::validator_to_type
-
-			if (Tcl_ListObjAppendElement (interp, listObj, elementObj) == TCL_ERROR) {
-				tclReturn = TCL_ERROR;
-				break;
-			}
-		}
-	}
-  error:
-	cass_iterator_free(iterator);
-	cass_schema_free(schema);
-	*objPtr = listObj;
-
-	if (tclReturn == TCL_OK) {
-		Tcl_ResetResult (interp);
+	// an insert sets the same values however many times it is applied,
+	// but a lightweight transaction's outcome depends on what was there
+	if (!ifNotExists) {
+		casstcl_statement_set_execution (*statementPtr, 1, -1);
 	}
-
-	return tclReturn;
+	return TCL_OK;
 }
 
-
 /*
  *----------------------------------------------------------------------
  *
@@ -1840,6 +2640,13 @@ casstcl_list_columns (casstcl_sessionClientData *ct, char *keyspace, char *table
  *     ...uses casstcl_bind_names_from_list to bind the data elements
  *     to the statement using the right data types
  *
+ *   Each distinct shape of insert is prepared the first time it is seen
+ *   and kept in the session's prepared statement cache, so subsequent
+ *   upserts of the same shape are bound from the prepared statement.
+ *
+ *   Rows of the table in the session's row cache are thrown away, as
+ *   they may no longer be what the table holds.
+ *
  *   It creates a cassandra statement and sets your pointer to it
  *
  * Results:
@@ -1865,6 +2672,8 @@ casstcl_make_upsert_statement (casstcl_sessionClientData *ct, char *tableName, T
 		return TCL_ERROR;
 	}
 
+	casstcl_row_cache_invalidate (ct, tableName);
+
 	Tcl_DString ds;
 	Tcl_DStringInit (&ds);
 	Tcl_DStringAppend (&ds, "INSERT INTO ", -1);
@@ -1877,11 +2686,12 @@ casstcl_make_upsert_statement (casstcl_sessionClientData *ct, char *tableName, T
 	int nUnknownToMap = 0;
 
 	casstcl_cassTypeInfo *typeInfo = (casstcl_cassTypeInfo *)ckalloc (sizeof (casstcl_cassTypeInfo) * (listObjc / 2));
+	casstcl_tableInfo *tableInfo = casstcl_lookup_table (ct, tableName);
 
 	for (i = 0; i < listObjc; i += 2) {
 		int varNameLength;
 
-		tclReturn = casstcl_typename_obj_to_cass_value_types (interp, tableName, listObjv[i], &typeInfo[i/2]);
+		tclReturn = casstcl_lookup_column_type (interp, tableInfo, listObjv[i], &typeInfo[i/2]);
 
 // printf("casstcl_make_upsert_statement figured out i %d table '%s' from '%s' type info %d, %d, %d\n", i, tableName, Tcl_GetString (listObjv[i]), typeInfo[i/2].cassValueType, typeInfo[i/2].valueSubType1, typeInfo[i/2].valueSubType2);
 
@@ -1958,9 +2768,25 @@ casstcl_make_upsert_statement (casstcl_sessionClientData *ct, char *tableName, T
 
 		char *query = Tcl_DStringValue (&ds);
 // printf("nFields %d, upsert query is '%s'\n", nFields, query);
-		CassStatement *statement = cass_statement_new (query, nFields);
+		const CassPrepared *prepared = NULL;
+		CassStatement *statement;
 		int bindField = 0;
 
+		// the text of the insert identifies the table, the ordered set of
+		// columns, the map column and IF NOT EXISTS, so it is the key for
+		// the session's cache of prepared upsert statements
+		tclReturn = casstcl_prepared_cache_lookup (ct, query, &prepared);
+
+		if (tclReturn != TCL_OK) {
+			goto cleanup;
+		}
+
+		if (prepared != NULL) {
+			statement = cass_prepared_bind (prepared);
+		} else {
+			statement = cass_statement_new (query, nFields);
+		}
+
 		tclReturn = casstcl_setStatementConsistency(ct, statement, consistencyPtr);
 
 		if (tclReturn != TCL_OK) {
@@ -1991,7 +2817,8 @@ casstcl_make_upsert_statement (casstcl_sessionClientData *ct, char *tableName, T
 		// if mapping of unknown column-value pairs is enabled and there are
 		// some, map them now
 		if (nUnknownToMap > 0) {
-			CassCollection *collection = cass_collection_new (CASS_COLLECTION_TYPE_MAP, nUnknownToMap);
+			CassCollection *collection = cass_collection_new (CASS_COLLECTION_TYPE_MAP, nUnknownToMap * 2);
+			casstcl_collectionAppendProc *appendText = casstcl_collection_append_proc (CASS_VALUE_TYPE_TEXT);
 
 			for (i = 0; i < listObjc; i += 2) {
 				// consult our cache of the types,
@@ -2001,17 +2828,15 @@ casstcl_make_upsert_statement (casstcl_sessionClientData *ct, char *tableName, T
 				}
 
 				// ok, got one, append the column name to the map
-				CassError cassError = casstcl_append_tcl_obj_to_collection (ct, collection, CASS_VALUE_TYPE_TEXT, listObjv[i]);
+				tclReturn = (*appendText) (ct, collection, listObjv[i]);
 				// i don't think these can really fail, a text conversion
-				if (cassError != CASS_OK) {
-					tclReturn = casstcl_cass_error_to_tcl (ct, cassError);
+				if (tclReturn != TCL_OK) {
 					break;
 				}
 
 				// now append the column value to the map
-				cassError = casstcl_append_tcl_obj_to_collection (ct, collection, CASS_VALUE_TYPE_TEXT, listObjv[i+1]);
-				if (cassError != CASS_OK) {
-					tclReturn = casstcl_cass_error_to_tcl (ct, cassError);
+				tclReturn = (*appendText) (ct, collection, listObjv[i+1]);
+				if (tclReturn != TCL_OK) {
 					break;
 				}
 			}
@@ -2068,17 +2893,21 @@ cleanup:
  *
  *   We then figure it out and invoke the underlying stuff.
  *
+ *   If infoPtr isn't NULL, it is set to the text of the statement and
+ *   the consistency level it was given, for the slow request log.
+ *
  * Results:
  *      A standard Tcl result.
  *
  *----------------------------------------------------------------------
  */
 int
-casstcl_make_statement_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[], int argOffset, CassStatement **statementPtr) {
+casstcl_make_statement_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[], int argOffset, CassStatement **statementPtr, casstcl_statementInfo *infoPtr) {
 	int arrayStyle = 0;
 	char *arrayName = NULL;
 	char *tableName = NULL;
 	char *preparedName = NULL;
+	Tcl_Obj *valuesObj = NULL;
 	char *consistencyName = NULL;
 	Tcl_Obj *consistencyObj = NULL;
 	CassConsistency consistency;
@@ -2088,6 +2917,7 @@ casstcl_make_statement_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_O
         "-array",
 		"-table",
 		"-prepared",
+		"-values",
 		"-consistency",
         NULL
     };
@@ -2096,6 +2926,7 @@ casstcl_make_statement_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_O
         OPT_ARRAY,
 		OPT_TABLE,
 		OPT_PREPARED,
+		OPT_VALUES,
 		OPT_CONSISTENCY
 	};
 
@@ -2104,6 +2935,11 @@ casstcl_make_statement_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_O
 	int optIndex;
 	int arg = 0;
 
+	if (infoPtr != NULL) {
+		infoPtr->text = NULL;
+		infoPtr->consistency = CASSTCL_CONSISTENCY_DEFAULT;
+	}
+
 	while (arg < newObjc) {
 		char *optionString = Tcl_GetString (newObjv[arg]);
 
@@ -2153,6 +2989,15 @@ casstcl_make_statement_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_O
 				break;
 			}
 
+			case OPT_VALUES: {
+				if (arg >= newObjc) {
+					goto wrong_numargs;
+				}
+
+				valuesObj = newObjv[arg++];
+				break;
+			}
+
 			case OPT_CONSISTENCY: {
 				if (arg >= newObjc) {
 					goto wrong_numargs;
@@ -2162,8 +3007,13 @@ casstcl_make_statement_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_O
 				consistencyName = Tcl_GetString(consistencyObj);
 // printf("saw consistency case, name = '%s'\n", consistencyName);
 
-				if (strlen(consistencyName) > 0 && casstcl_obj_to_cass_consistency(ct, consistencyObj, &consistency) != TCL_OK) {
-					return TCL_ERROR;
+				if (strlen(consistencyName) > 0) {
+					if (casstcl_obj_to_cass_consistency(ct, consistencyObj, &consistency) != TCL_OK) {
+						return TCL_ERROR;
+					}
+					if (infoPtr != NULL) {
+						infoPtr->consistency = consistency;
+					}
 				}
 				break;
 			}
@@ -2191,7 +3041,7 @@ casstcl_make_statement_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_O
 	//
 	if (arg >= newObjc && preparedName == NULL) {
 	  wrong_numargs:
-		Tcl_WrongNumArgs (interp, (argOffset <= 2) ? argOffset : 2, objv, "?-array arrayName? ?-table tableName? ?-prepared preparedName? ?-consistency level? ?query? ?arg...?");
+		Tcl_WrongNumArgs (interp, (argOffset <= 2) ? argOffset : 2, objv, "?-array arrayName? ?-table tableName? ?-prepared preparedName? ?-values list? ?-consistency level? ?query? ?arg...?");
 		return TCL_ERROR;
 	}
 
@@ -2201,6 +3051,12 @@ casstcl_make_statement_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_O
 		return TCL_ERROR;
 	}
 
+	if (valuesObj != NULL && preparedName == NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "-values can only be used with -prepared", NULL);
+		return TCL_ERROR;
+	}
+
 	// if prepared, handle it
 	if (preparedName != NULL) {
 // printf("prepared case branch, name = '%s'\n", preparedName);
@@ -2216,6 +3072,24 @@ casstcl_make_statement_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_O
 			return TCL_ERROR;
 		}
 
+		if (infoPtr != NULL) {
+			infoPtr->text = pcd->string;
+		}
+
+		// the values of all of the parameters, in order
+		if (valuesObj != NULL) {
+			if (arg != newObjc) {
+				Tcl_WrongNumArgs (interp, (argOffset <= 2) ? argOffset : 2, objv, "-prepared prepared -values list");
+				return TCL_ERROR;
+			}
+
+			if (Tcl_ListObjGetElements (interp, valuesObj, &listObjc, &listObjv) == TCL_ERROR) {
+				Tcl_AppendResult (interp, " while parsing list of values", NULL);
+				return TCL_ERROR;
+			}
+			return casstcl_bind_values_from_prepared (pcd, listObjc, listObjv, (consistencyObj != NULL) ? &consistency : NULL, statementPtr);
+		}
+
 		// there must be exactly one argument left.  the list of
 		// name/value pairs, which must contain an even number of
 		// elements.
@@ -2243,6 +3117,13 @@ casstcl_make_statement_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_O
 	char *query = Tcl_GetString (newObjv[arg++]);
 	// (whatever is left of the newObjv from arg to the end are column-related)
 
+	if (infoPtr != NULL) {
+		infoPtr->text = query;
+	}
+
+	// a statement that changes the schema invalidates what it touches
+	casstcl_schema_note_statement (ct, query);
+
 	if (arrayStyle) {
 		if (tableName == NULL) {
 			Tcl_ResetResult (interp);
@@ -2268,44 +3149,32 @@ casstcl_make_statement_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_O
  *----------------------------------------------------------------------
  *
  * casstcl_reimport_column_type_map --
- *    Call out to the Tcl interpreter to invoke
- *    ::casstcl::import_column_type_map from the casstcl library;
- *    the proc resides in source file is casstcl.tcl.
+ *    Walk the schema metadata maintained by the driver and rebuild the
+ *    session's native column type map, which is what casstcl consults
+ *    to find the data type of each column it binds.  The result is also
+ *    mirrored into the ::casstcl::columnTypeMap array for Tcl code.
+ *
+ *    If the map is lazy, it is just emptied instead, so that each table
+ *    is imported by itself the next time it is used.
  *
  *    This convenience function gets called from a method of the
  *    casstcl cass object and is invoked upon connection as well
  *
  * Results:
- *    The program compiles.
+ *    A standard Tcl result.
  *
  *----------------------------------------------------------------------
  */
 int
 casstcl_reimport_column_type_map (casstcl_sessionClientData *ct)
 {
-	int tclReturnCode;
-	Tcl_Interp *interp = ct->interp;
-	Tcl_Obj *evalObjv[2];
-
-	// construct an objv we'll pass to eval.
-	// first is the command
-	// second is the name of cassandra connection object
-	evalObjv[0] = Tcl_NewStringObj ("::casstcl::import_column_type_map", -1);
-	evalObjv[1] = Tcl_NewObj();
-	Tcl_GetCommandFullName(interp, ct->cmdToken, evalObjv[1]);
-
-	// eval the command.  this should traverse the metadata and extract
-	// the types of all the columns of all the tables of all the keyspaces
-
-	Tcl_IncrRefCount (evalObjv[0]);
-	Tcl_IncrRefCount (evalObjv[1]);
-
-	tclReturnCode = Tcl_EvalObjv (interp, 2, evalObjv, (TCL_EVAL_GLOBAL|TCL_EVAL_DIRECT));
-
-	Tcl_DecrRefCount(evalObjv[0]);
-	Tcl_DecrRefCount(evalObjv[1]);
+	if (ct->columnTypeMap.lazy) {
+		casstcl_column_type_map_clear (&ct->columnTypeMap);
+		Tcl_UnsetVar (ct->interp, "::casstcl::columnTypeMap", (TCL_GLOBAL_ONLY));
+		return TCL_OK;
+	}
 
-	return tclReturnCode;
+	return casstcl_import_column_type_map (ct);
 }
 
 
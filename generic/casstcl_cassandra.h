@@ -24,6 +24,42 @@
  */
 void casstcl_cassObjectDelete (ClientData clientData);
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_cassObjectObjCmd --
+ *
+ *    dispatches the subcommands of a cass object command
+ *
+ * Results:
+ *    stuff
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_cassObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_reimport_column_type_map --
+ *    Walk the schema metadata maintained by the driver and rebuild the
+ *    session's native column type map, which is what casstcl consults
+ *    to find the data type of each column it binds.  The result is also
+ *    mirrored into the ::casstcl::columnTypeMap array for Tcl code.
+ *
+ *    If the map is lazy, it is just emptied instead, so that each table
+ *    is imported by itself the next time it is used.
+ *
+ *    This convenience function gets called from a method of the
+ *    casstcl cass object and is invoked upon connection as well
+ *
+ * Results:
+ *    A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_reimport_column_type_map (casstcl_sessionClientData *ct);
+
 
 /*
  *--------------------------------------------------------------
@@ -122,6 +158,13 @@ int casstcl_cassObjCmd(
  *     ...uses casstcl_bind_names_from_list to bind the data elements
  *     to the statement using the right data types
  *
+ *   Each distinct shape of insert is prepared the first time it is seen
+ *   and kept in the session's prepared statement cache, so subsequent
+ *   upserts of the same shape are bound from the prepared statement.
+ *
+ *   Rows of the table in the session's row cache are thrown away, as
+ *   they may no longer be what the table holds.
+ *
  *   It creates a cassandra statement and sets your pointer to it
  *
  * Results:
@@ -163,6 +206,9 @@ int casstcl_make_upsert_statement (
  *
  *   We then figure it out and invoke the underlying stuff.
  *
+ *   If infoPtr isn't NULL, it is set to the text of the statement and
+ *   the consistency level it was given, for the slow request log.
+ *
  * Results:
  *      A standard Tcl result.
  *
@@ -172,6 +218,7 @@ int casstcl_make_statement_from_objv (
 	casstcl_sessionClientData *ct, 
 	int objc, Tcl_Obj *CONST objv[], 
 	int argOffset, 
-	CassStatement **statementPtr);
+	CassStatement **statementPtr,
+	casstcl_statementInfo *infoPtr);
 
 /* vim: set ts=4 sw=4 sts=4 noet : */
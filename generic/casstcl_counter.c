@@ -0,0 +1,974 @@
+/*
+ * casstcl_counter - Functions used to create, delete, and handle counter
+ *                   accumulators, which sum the increments made to counter
+ *                   columns and send them as counter batches
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_counter.h"
+#include "casstcl_batch.h"
+#include "casstcl_consistency.h"
+#include "casstcl_error.h"
+#include "casstcl_prepared.h"
+#include "casstcl_schema.h"
+#include "casstcl_types.h"
+
+#include <assert.h>
+
+// the key columns of an increment, in the order they go in its key
+typedef struct casstcl_counterKeyColumn
+{
+	casstcl_columnInfo *columnInfo;
+	Tcl_Obj *valueObj;
+	int order;
+} casstcl_counterKeyColumn;
+
+#define CASSTCL_COUNTER_STATIC_KEY_COLUMNS 8
+#define CASSTCL_COUNTER_DEFAULT_BATCH_SIZE 100
+
+static int casstcl_counter_flush (casstcl_counterAccumulatorClientData *ccd, Tcl_Obj *callbackObj);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_counter_now -- the current time in microseconds
+ *
+ * Results:
+ *      The time.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static Tcl_WideInt
+casstcl_counter_now (void)
+{
+	Tcl_Time now;
+
+	Tcl_GetTime (&now);
+	return ((Tcl_WideInt)now.sec * 1000000) + now.usec;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_counter_clear -- take all of the pending deltas out of
+ *   a counter accumulator, freeing them if freeDeltas is set
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      Any pending auto flush timer is cancelled.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_counter_clear (casstcl_counterAccumulatorClientData *ccd, int freeDeltas)
+{
+	Tcl_HashSearch search;
+	Tcl_HashEntry *hashEntry;
+
+	if (ccd->intervalTimer != NULL) {
+		Tcl_DeleteTimerHandler (ccd->intervalTimer);
+		ccd->intervalTimer = NULL;
+	}
+
+	if (freeDeltas) {
+		for (hashEntry = Tcl_FirstHashEntry (&ccd->deltaHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+			casstcl_counterDelta *delta = (casstcl_counterDelta *)Tcl_GetHashValue (hashEntry);
+
+			cass_statement_free (delta->statement);
+			ckfree ((char *)delta);
+		}
+	}
+
+	Tcl_DeleteHashTable (&ccd->deltaHash);
+	Tcl_InitHashTable (&ccd->deltaHash, TCL_STRING_KEYS);
+	ccd->bytes = 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_counterAccumulatorObjectDelete -- command deletion
+ *   callback routine.
+ *
+ * Results:
+ *      ...destroys the counter accumulator object, throwing away
+ *         any deltas that haven't been flushed.
+ *      ...frees memory.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_counterAccumulatorObjectDelete (ClientData clientData)
+{
+	casstcl_counterAccumulatorClientData *ccd = (casstcl_counterAccumulatorClientData *)clientData;
+
+	assert (ccd->cass_counter_accumulator_magic == CASS_COUNTER_ACCUMULATOR_MAGIC);
+
+	casstcl_counter_clear (ccd, 1);
+	Tcl_DeleteHashTable (&ccd->deltaHash);
+	casstcl_batch_free (ccd->bcd);
+
+	if (ccd->flushCallbackObj != NULL) {
+		Tcl_DecrRefCount (ccd->flushCallbackObj);
+	}
+
+	// a flush waiting for room in the in-flight window may be holding
+	// on to it
+	ccd->cass_counter_accumulator_magic = 0;
+	Tcl_EventuallyFree ((ClientData)ccd, TCL_DYNAMIC);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_counter_interval_proc --
+ *
+ *    timer handler that flushes a counter accumulator when its first
+ *    pending delta has waited for its auto flush interval
+ *
+ * Results:
+ *    None; a background error is raised if the flush fails.
+ *
+ *----------------------------------------------------------------------
+ */
+static void
+casstcl_counter_interval_proc (ClientData clientData)
+{
+	casstcl_counterAccumulatorClientData *ccd = (casstcl_counterAccumulatorClientData *)clientData;
+
+	ccd->intervalTimer = NULL;
+
+	// the session may have been deleted out from under the accumulator
+	if (ccd->ct->cass_session_magic != CASS_SESSION_MAGIC) {
+		return;
+	}
+
+	if (casstcl_counter_flush (ccd, ccd->flushCallbackObj) == TCL_ERROR) {
+		Tcl_BackgroundError (ccd->ct->interp);
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_counter_key_columns -- look up the columns of the
+ *   key-value list of an increment and put them in the order
+ *   they go in its key: the columns of the partition key, in
+ *   key order, then the rest in table order
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_counter_key_columns (Tcl_Interp *interp, casstcl_tableInfo *tableInfo, int listObjc, Tcl_Obj **listObjv, casstcl_counterKeyColumn *keys)
+{
+	int nKeys = listObjc / 2;
+	int i;
+	int j;
+
+	for (i = 0; i < nKeys; i++) {
+		casstcl_columnInfo *columnInfo = casstcl_lookup_column (tableInfo, listObjv[i * 2]);
+		casstcl_counterKeyColumn key;
+
+		if (columnInfo == NULL) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "unknown column '", Tcl_GetString (listObjv[i * 2]), "' in counter key for table '", tableInfo->fullName, "'", NULL);
+			return TCL_ERROR;
+		}
+
+		if (columnInfo->typeStatus != TCL_OK) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "unsupported cassandra type '", columnInfo->typeString, "' for column '", columnInfo->name, "' of table '", tableInfo->fullName, "'", NULL);
+			return TCL_ERROR;
+		}
+
+		if (columnInfo->typeInfo.cassValueType == CASS_VALUE_TYPE_COUNTER) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "counter column '", columnInfo->name, "' can't be part of the key of table '", tableInfo->fullName, "'", NULL);
+			return TCL_ERROR;
+		}
+
+		key.columnInfo = columnInfo;
+		key.valueObj = listObjv[i * 2 + 1];
+		key.order = (columnInfo->partitionKeyIndex >= 0) ? columnInfo->partitionKeyIndex : tableInfo->nPartitionKeys + columnInfo->index;
+
+		// there are only ever a few, so an insertion sort does
+		for (j = i; (j > 0) && (keys[j - 1].order > key.order); j--) {
+			keys[j] = keys[j - 1];
+		}
+		keys[j] = key;
+	}
+
+	for (i = 0; i < tableInfo->nPartitionKeys; i++) {
+		if ((i >= nKeys) || (keys[i].columnInfo != tableInfo->partitionKey[i])) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "counter key for '", tableInfo->fullName, "' is missing partition key column '", tableInfo->partitionKey[i]->name, "'", NULL);
+			return TCL_ERROR;
+		}
+	}
+
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_counter_make_statement -- make the update statement
+ *   that will add the delta of a key to its counter column, with
+ *   the key columns bound and the delta left to be bound when it
+ *   is flushed
+ *
+ *   The update is prepared through the session's prepared
+ *   statement cache, so there is one for each shape of key.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_counter_make_statement (casstcl_sessionClientData *ct, casstcl_tableInfo *tableInfo, casstcl_columnInfo *counterColumn, int nKeys, casstcl_counterKeyColumn *keys, CassStatement **statementPtr)
+{
+	Tcl_Interp *interp = ct->interp;
+	const CassPrepared *prepared = NULL;
+	CassStatement *statement;
+	Tcl_DString ds;
+	int tclReturn;
+	int i;
+
+	Tcl_DStringInit (&ds);
+	Tcl_DStringAppend (&ds, "UPDATE ", -1);
+	Tcl_DStringAppend (&ds, tableInfo->fullName, -1);
+	Tcl_DStringAppend (&ds, " SET ", -1);
+	Tcl_DStringAppend (&ds, counterColumn->name, -1);
+	Tcl_DStringAppend (&ds, " = ", -1);
+	Tcl_DStringAppend (&ds, counterColumn->name, -1);
+	Tcl_DStringAppend (&ds, " + ? WHERE ", -1);
+
+	for (i = 0; i < nKeys; i++) {
+		if (i > 0) {
+			Tcl_DStringAppend (&ds, " AND ", -1);
+		}
+		Tcl_DStringAppend (&ds, keys[i].columnInfo->name, -1);
+		Tcl_DStringAppend (&ds, " = ?", -1);
+	}
+
+	tclReturn = casstcl_prepared_cache_lookup (ct, Tcl_DStringValue (&ds), &prepared);
+	if (tclReturn != TCL_OK) {
+		Tcl_DStringFree (&ds);
+		return TCL_ERROR;
+	}
+
+	if (prepared != NULL) {
+		statement = cass_prepared_bind (prepared);
+	} else {
+		statement = cass_statement_new (Tcl_DStringValue (&ds), nKeys + 1);
+	}
+	Tcl_DStringFree (&ds);
+
+	for (i = 0; i < nKeys; i++) {
+		if (casstcl_bind_tcl_obj (ct, statement, NULL, 0, i + 1, &keys[i].columnInfo->typeInfo, keys[i].valueObj) == TCL_ERROR) {
+			Tcl_AppendResult (interp, " while binding key column '", keys[i].columnInfo->name, "' of counter increment for table '", tableInfo->fullName, "'", NULL);
+			cass_statement_free (statement);
+			return TCL_ERROR;
+		}
+	}
+
+	*statementPtr = statement;
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_counter_incr -- add to the delta of a table, key and
+ *   counter column from the arguments of a counter accumulator's
+ *   incr method, table keyList column ?delta?
+ *
+ *   The first increment of a key makes its update statement;
+ *   later ones only add to its delta.  If the accumulator then
+ *   holds its auto flush number of keys it is flushed.
+ *
+ * Results:
+ *      A standard Tcl result; on success the interpreter result is
+ *      the key's delta including this increment.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_counter_incr (casstcl_counterAccumulatorClientData *ccd, int objc, Tcl_Obj *CONST objv[])
+{
+	casstcl_sessionClientData *ct = ccd->ct;
+	Tcl_Interp *interp = ct->interp;
+	casstcl_counterKeyColumn staticKeys[CASSTCL_COUNTER_STATIC_KEY_COLUMNS];
+	casstcl_counterKeyColumn *keys = staticKeys;
+	casstcl_tableInfo *tableInfo;
+	casstcl_columnInfo *counterColumn;
+	casstcl_counterDelta *delta;
+	Tcl_HashEntry *hashEntry;
+	Tcl_Obj **listObjv;
+	Tcl_DString key;
+	Tcl_WideInt increment = 1;
+	Tcl_WideInt total;
+	char *tableName;
+	int partitionLength = 0;
+	int listObjc;
+	int nKeys;
+	int new;
+	int i;
+
+	if ((objc == 4) && (Tcl_GetWideIntFromObj (interp, objv[3], &increment) == TCL_ERROR)) {
+		Tcl_AppendResult (interp, " while converting delta element", NULL);
+		return TCL_ERROR;
+	}
+
+	tableName = Tcl_GetString (objv[0]);
+	tableInfo = casstcl_lookup_table (ct, tableName);
+
+	if (tableInfo == NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "table '", tableName, "' isn't in the column type map", NULL);
+		return TCL_ERROR;
+	}
+
+	if (tableInfo->nPartitionKeys == 0) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "the partition key of table '", tableName, "' isn't known", NULL);
+		return TCL_ERROR;
+	}
+
+	counterColumn = casstcl_lookup_column (tableInfo, objv[2]);
+	if ((counterColumn == NULL) || (counterColumn->typeStatus != TCL_OK) || (counterColumn->typeInfo.cassValueType != CASS_VALUE_TYPE_COUNTER)) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "column '", Tcl_GetString (objv[2]), "' of table '", tableName, "' isn't a counter", NULL);
+		return TCL_ERROR;
+	}
+
+	if (Tcl_ListObjGetElements (interp, objv[1], &listObjc, &listObjv) == TCL_ERROR) {
+		Tcl_AppendResult (interp, " while parsing list of key-value pairs", NULL);
+		return TCL_ERROR;
+	}
+
+	if (listObjc & 1) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "key-value pair list must contain an even number of elements", NULL);
+		return TCL_ERROR;
+	}
+
+	nKeys = listObjc / 2;
+	if (nKeys > CASSTCL_COUNTER_STATIC_KEY_COLUMNS) {
+		keys = (casstcl_counterKeyColumn *)ckalloc (sizeof (casstcl_counterKeyColumn) * nKeys);
+	}
+
+	if (casstcl_counter_key_columns (interp, tableInfo, listObjc, listObjv, keys) == TCL_ERROR) {
+		if (keys != staticKeys) {
+			ckfree ((char *)keys);
+		}
+		return TCL_ERROR;
+	}
+
+	// the key is the table, then each key value preceded by its length
+	// so that different values can't run together, then the column
+	Tcl_DStringInit (&key);
+	Tcl_DStringAppend (&key, tableInfo->fullName, -1);
+
+	for (i = 0; i < nKeys; i++) {
+		char lengthString[24];
+		char *value;
+		int length;
+
+		value = Tcl_GetStringFromObj (keys[i].valueObj, &length);
+		snprintf (lengthString, sizeof (lengthString), " %d:", length);
+		Tcl_DStringAppend (&key, lengthString, -1);
+		Tcl_DStringAppend (&key, value, length);
+
+		if (i + 1 == tableInfo->nPartitionKeys) {
+			partitionLength = Tcl_DStringLength (&key);
+		}
+	}
+
+	Tcl_DStringAppend (&key, " ", 1);
+	Tcl_DStringAppend (&key, counterColumn->name, -1);
+
+	hashEntry = Tcl_CreateHashEntry (&ccd->deltaHash, Tcl_DStringValue (&key), &new);
+	ccd->increments++;
+
+	if (!new) {
+		delta = (casstcl_counterDelta *)Tcl_GetHashValue (hashEntry);
+		delta->delta += increment;
+		ccd->coalesced++;
+	} else {
+		CassStatement *statement = NULL;
+
+		if (casstcl_counter_make_statement (ct, tableInfo, counterColumn, nKeys, keys, &statement) == TCL_ERROR) {
+			Tcl_DeleteHashEntry (hashEntry);
+			Tcl_DStringFree (&key);
+			if (keys != staticKeys) {
+				ckfree ((char *)keys);
+			}
+			ccd->increments--;
+			return TCL_ERROR;
+		}
+
+		delta = (casstcl_counterDelta *)ckalloc (sizeof (casstcl_counterDelta));
+		delta->statement = statement;
+		delta->delta = increment;
+		delta->partitionLength = partitionLength;
+		// the key is held by the hash table and, as bound values, by
+		// the statement
+		delta->bytes = sizeof (casstcl_counterDelta) + sizeof (Tcl_HashEntry) + Tcl_DStringLength (&key) * 2;
+		delta->next = NULL;
+		Tcl_SetHashValue (hashEntry, delta);
+		ccd->bytes += delta->bytes;
+
+		if ((ccd->deltaHash.numEntries == 1) && (ccd->interval > 0)) {
+			ccd->intervalTimer = Tcl_CreateTimerHandler (ccd->interval, casstcl_counter_interval_proc, (ClientData)ccd);
+		}
+	}
+
+	Tcl_DStringFree (&key);
+	if (keys != staticKeys) {
+		ckfree ((char *)keys);
+	}
+
+	total = delta->delta;
+	if ((ccd->maxKeys > 0) && (ccd->deltaHash.numEntries >= ccd->maxKeys)) {
+		if (casstcl_counter_flush (ccd, ccd->flushCallbackObj) == TCL_ERROR) {
+			return TCL_ERROR;
+		}
+	}
+
+	Tcl_SetObjResult (interp, Tcl_NewWideIntObj (total));
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_counter_send -- send the updates put in the batch of a
+ *   counter accumulator, appending the future created for them,
+ *   if there is a callback, to resultObj
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_counter_send (casstcl_counterAccumulatorClientData *ccd, Tcl_Obj *callbackObj, Tcl_Obj *resultObj)
+{
+	int count = ccd->bcd->count;
+
+	if (casstcl_batch_flush (ccd->bcd, callbackObj) == TCL_ERROR) {
+		ccd->dropped += count;
+		return TCL_ERROR;
+	}
+
+	ccd->batches++;
+	ccd->keysFlushed += count;
+	if (callbackObj != NULL) {
+		Tcl_ListObjAppendElement (NULL, resultObj, Tcl_GetObjResult (ccd->ct->interp));
+	}
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_counter_flush -- send the pending deltas of a counter
+ *   accumulator as counter batches, one or more for each
+ *   partition, of at most its batch size updates each
+ *
+ *   All of the deltas are taken out of the accumulator first,
+ *   since sending can wait for room in the in-flight window,
+ *   running events that might increment more.  If sending fails,
+ *   or the accumulator is deleted meanwhile, the deltas not sent
+ *   are thrown away and counted as dropped.
+ *
+ * Results:
+ *      A standard Tcl result; if there is a callback the
+ *      interpreter result is a list of the future objects created,
+ *      one per batch.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_counter_flush (casstcl_counterAccumulatorClientData *ccd, Tcl_Obj *callbackObj)
+{
+	Tcl_Interp *interp = ccd->ct->interp;
+	casstcl_batchClientData *bcd = ccd->bcd;
+	Tcl_HashTable partitionHash;
+	Tcl_HashSearch search;
+	Tcl_HashEntry *hashEntry;
+	Tcl_Obj *resultObj;
+	Tcl_WideInt startTime;
+	Tcl_WideInt elapsed;
+	int tclReturn = TCL_OK;
+
+	Tcl_ResetResult (interp);
+	if (ccd->deltaHash.numEntries == 0) {
+		return TCL_OK;
+	}
+
+	startTime = casstcl_counter_now ();
+
+	// chain the deltas of each partition together
+	Tcl_InitHashTable (&partitionHash, TCL_STRING_KEYS);
+	for (hashEntry = Tcl_FirstHashEntry (&ccd->deltaHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+		casstcl_counterDelta *delta = (casstcl_counterDelta *)Tcl_GetHashValue (hashEntry);
+		Tcl_HashEntry *partitionEntry;
+		Tcl_DString partition;
+		int new;
+
+		Tcl_DStringInit (&partition);
+		Tcl_DStringAppend (&partition, Tcl_GetHashKey (&ccd->deltaHash, hashEntry), delta->partitionLength);
+		partitionEntry = Tcl_CreateHashEntry (&partitionHash, Tcl_DStringValue (&partition), &new);
+		Tcl_DStringFree (&partition);
+
+		delta->next = new ? NULL : (casstcl_counterDelta *)Tcl_GetHashValue (partitionEntry);
+		Tcl_SetHashValue (partitionEntry, delta);
+	}
+
+	casstcl_counter_clear (ccd, 0);
+	ccd->flushes++;
+
+	resultObj = Tcl_NewObj ();
+	Tcl_IncrRefCount (resultObj);
+	Tcl_Preserve ((ClientData)ccd);
+	Tcl_Preserve ((ClientData)bcd);
+
+	for (hashEntry = Tcl_FirstHashEntry (&partitionHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+		casstcl_counterDelta *delta = (casstcl_counterDelta *)Tcl_GetHashValue (hashEntry);
+
+		while (delta != NULL) {
+			casstcl_counterDelta *next = delta->next;
+			CassError cassError = CASS_OK;
+
+			if ((tclReturn == TCL_OK) && (ccd->cass_counter_accumulator_magic == CASS_COUNTER_ACCUMULATOR_MAGIC)) {
+				cassError = cass_statement_bind_int64 (delta->statement, 0, (cass_int64_t)delta->delta);
+				if (cassError == CASS_OK) {
+					cassError = cass_batch_add_statement (bcd->batch, delta->statement);
+				}
+
+				if (cassError == CASS_OK) {
+					bcd->count++;
+				} else {
+					ccd->dropped++;
+				}
+			} else {
+				ccd->dropped++;
+			}
+
+			cass_statement_free (delta->statement);
+			ckfree ((char *)delta);
+			delta = next;
+
+			// send what has been put in the batch at the end of the
+			// partition, when the batch is full, or before giving up
+			if ((ccd->cass_counter_accumulator_magic == CASS_COUNTER_ACCUMULATOR_MAGIC) && (bcd->count > 0) &&
+				((delta == NULL) || (bcd->count == ccd->batchSize) || (cassError != CASS_OK))) {
+				tclReturn = casstcl_counter_send (ccd, callbackObj, resultObj);
+			}
+
+			if ((cassError != CASS_OK) && (tclReturn == TCL_OK)) {
+				tclReturn = casstcl_cass_error_to_tcl (ccd->ct, cassError);
+			}
+		}
+	}
+
+	Tcl_DeleteHashTable (&partitionHash);
+
+	elapsed = casstcl_counter_now () - startTime;
+	ccd->flushTimeLast = elapsed;
+	ccd->flushTimeTotal += elapsed;
+	if (elapsed > ccd->flushTimeMax) {
+		ccd->flushTimeMax = elapsed;
+	}
+
+	Tcl_Release ((ClientData)bcd);
+	Tcl_Release ((ClientData)ccd);
+
+	if (tclReturn == TCL_OK) {
+		Tcl_SetObjResult (interp, resultObj);
+	}
+	Tcl_DecrRefCount (resultObj);
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_counter_stats_obj -- describe what a counter
+ *   accumulator holds and has done
+ *
+ * Results:
+ *      A new list of key-value pairs.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static Tcl_Obj *
+casstcl_counter_stats_obj (casstcl_counterAccumulatorClientData *ccd)
+{
+	Tcl_Obj *listObj = Tcl_NewObj ();
+
+#define CASSTCL_COUNTER_APPEND(name, obj) \
+	Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ((name), -1)); \
+	Tcl_ListObjAppendElement (NULL, listObj, (obj))
+
+	CASSTCL_COUNTER_APPEND ("pending", Tcl_NewIntObj (ccd->deltaHash.numEntries));
+	CASSTCL_COUNTER_APPEND ("bytes", Tcl_NewIntObj (ccd->bytes));
+	CASSTCL_COUNTER_APPEND ("increments", Tcl_NewWideIntObj (ccd->increments));
+	CASSTCL_COUNTER_APPEND ("coalesced", Tcl_NewWideIntObj (ccd->coalesced));
+	CASSTCL_COUNTER_APPEND ("flushes", Tcl_NewWideIntObj (ccd->flushes));
+	CASSTCL_COUNTER_APPEND ("updates", Tcl_NewWideIntObj (ccd->keysFlushed));
+	CASSTCL_COUNTER_APPEND ("batches", Tcl_NewWideIntObj (ccd->batches));
+	CASSTCL_COUNTER_APPEND ("dropped", Tcl_NewWideIntObj (ccd->dropped));
+	CASSTCL_COUNTER_APPEND ("last_flush_us", Tcl_NewWideIntObj (ccd->flushTimeLast));
+	CASSTCL_COUNTER_APPEND ("max_flush_us", Tcl_NewWideIntObj (ccd->flushTimeMax));
+	CASSTCL_COUNTER_APPEND ("mean_flush_us", Tcl_NewWideIntObj ((ccd->flushes > 0) ? ccd->flushTimeTotal / ccd->flushes : 0));
+
+#undef CASSTCL_COUNTER_APPEND
+	return listObj;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_createCounterAccumulatorObjectCommand --
+ *
+ *    given a casstcl_sessionClientData pointer and an object name (or
+ *    "#auto"), create a counter accumulator object command
+ *
+ * Results:
+ *    A standard Tcl result
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_createCounterAccumulatorObjectCommand (casstcl_sessionClientData *ct, char *commandName)
+{
+	// allocate one of our counter accumulator objects for Tcl and configure it
+	casstcl_counterAccumulatorClientData *ccd = (casstcl_counterAccumulatorClientData *)ckalloc (sizeof (casstcl_counterAccumulatorClientData));
+	Tcl_Interp *interp = ct->interp;
+
+	memset (ccd, 0, sizeof (casstcl_counterAccumulatorClientData));
+	ccd->cass_counter_accumulator_magic = CASS_COUNTER_ACCUMULATOR_MAGIC;
+	ccd->ct = ct;
+	Tcl_InitHashTable (&ccd->deltaHash, TCL_STRING_KEYS);
+	ccd->bcd = casstcl_batch_new (ct, CASS_BATCH_TYPE_COUNTER);
+	ccd->bcd->statsKind = CASSTCL_STATS_COUNTER;
+	cass_batch_set_consistency (ccd->bcd->batch, ccd->bcd->consistency);
+	ccd->batchSize = CASSTCL_COUNTER_DEFAULT_BATCH_SIZE;
+	ccd->intervalTimer = NULL;
+	ccd->flushCallbackObj = NULL;
+
+#define COUNTER_ACCUMULATOR_STRING_FORMAT "counter_accumulator%lu"
+	// if commandName is #auto, generate a unique name for the object
+	int autoGeneratedName = 0;
+	if (strcmp (commandName, "#auto") == 0) {
+		static unsigned long nextAutoCounter = 0;
+		int baseNameLength = snprintf (NULL, 0, COUNTER_ACCUMULATOR_STRING_FORMAT, nextAutoCounter) + 1;
+		commandName = ckalloc (baseNameLength);
+		snprintf (commandName, baseNameLength, COUNTER_ACCUMULATOR_STRING_FORMAT, nextAutoCounter++);
+		autoGeneratedName = 1;
+	}
+
+	// create a Tcl command to interface to the counter accumulator object
+	ccd->cmdToken = Tcl_CreateObjCommand (interp, commandName, casstcl_counterAccumulatorObjectObjCmd, ccd, casstcl_counterAccumulatorObjectDelete);
+	// set the full name to the command in the interpreter result
+	Tcl_GetCommandFullName(interp, ccd->cmdToken, Tcl_GetObjResult (interp));
+	if (autoGeneratedName == 1) {
+		ckfree(commandName);
+	}
+
+	return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_counterAccumulatorObjectObjCmd --
+ *
+ *    dispatches the subcommands of a casstcl counter accumulator command
+ *
+ * Results:
+ *    stuff
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_counterAccumulatorObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	int optIndex;
+	casstcl_counterAccumulatorClientData *ccd = (casstcl_counterAccumulatorClientData *)cData;
+	int resultCode = TCL_OK;
+
+	static CONST char *options[] = {
+		"incr",
+		"pending",
+		"bytes",
+		"stats",
+		"consistency",
+		"auto_flush",
+		"flush",
+		"reset",
+		"delete",
+		NULL
+	};
+
+	enum options {
+		OPT_INCR,
+		OPT_PENDING,
+		OPT_BYTES,
+		OPT_STATS,
+		OPT_CONSISTENCY,
+		OPT_AUTO_FLUSH,
+		OPT_FLUSH,
+		OPT_RESET,
+		OPT_DELETE
+	};
+
+	/* basic validation of command line arguments */
+	if (objc < 2) {
+		Tcl_WrongNumArgs (interp, 1, objv, "subcommand ?args?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj (interp, objv[1], options, "option", TCL_EXACT, &optIndex) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	switch ((enum options) optIndex) {
+		case OPT_INCR: {
+			if ((objc < 5) || (objc > 6)) {
+				Tcl_WrongNumArgs (interp, 2, objv, "table keyList column ?delta?");
+				return TCL_ERROR;
+			}
+
+			resultCode = casstcl_counter_incr (ccd, objc - 2, &objv[2]);
+			break;
+		}
+
+		// pending and bytes - the number of keys with deltas waiting to
+		// be sent and the memory they take up
+		case OPT_PENDING:
+		case OPT_BYTES: {
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
+			}
+
+			Tcl_SetObjResult (interp, Tcl_NewIntObj (((enum options) optIndex == OPT_PENDING) ? ccd->deltaHash.numEntries : ccd->bytes));
+			break;
+		}
+
+		case OPT_STATS: {
+			if ((objc != 2) && !((objc == 3) && (strcmp (Tcl_GetString (objv[2]), "-reset") == 0))) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-reset?");
+				return TCL_ERROR;
+			}
+
+			Tcl_SetObjResult (interp, casstcl_counter_stats_obj (ccd));
+
+			if (objc == 3) {
+				ccd->increments = 0;
+				ccd->coalesced = 0;
+				ccd->flushes = 0;
+				ccd->keysFlushed = 0;
+				ccd->batches = 0;
+				ccd->dropped = 0;
+				ccd->flushTimeTotal = 0;
+				ccd->flushTimeLast = 0;
+				ccd->flushTimeMax = 0;
+			}
+			break;
+		}
+
+		case OPT_CONSISTENCY: {
+			CassConsistency cassConsistency;
+
+			if ((objc < 2) || (objc > 3)) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?consistency?");
+				return TCL_ERROR;
+			}
+
+			if (objc == 2) {
+				Tcl_SetObjResult (interp, Tcl_NewStringObj (casstcl_cass_consistency_to_string (ccd->bcd->consistency), -1));
+				return TCL_OK;
+			}
+
+			if (casstcl_obj_to_cass_consistency(ccd->ct, objv[2], &cassConsistency) == TCL_ERROR) {
+				return TCL_ERROR;
+			}
+
+			ccd->bcd->consistency = cassConsistency;
+			CassError cassError = cass_batch_set_consistency (ccd->bcd->batch, cassConsistency);
+			if (cassError != CASS_OK) {
+				return casstcl_cass_error_to_tcl (ccd->ct, cassError);
+			}
+			break;
+		}
+
+		case OPT_AUTO_FLUSH: {
+			int arg;
+			int subOptIndex;
+
+			static CONST char *subOptions[] = {
+				"-keys",
+				"-interval",
+				"-batch_size",
+				"-callback",
+				NULL
+			};
+
+			enum subOptions {
+				SUBOPT_KEYS,
+				SUBOPT_INTERVAL,
+				SUBOPT_BATCH_SIZE,
+				SUBOPT_CALLBACK
+			};
+
+			if ((objc % 2) != 0) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-keys count? ?-interval ms? ?-batch_size count? ?-callback callback?");
+				return TCL_ERROR;
+			}
+
+			for (arg = 2; arg < objc; arg += 2) {
+				int value = 0;
+
+				if (Tcl_GetIndexFromObj (interp, objv[arg], subOptions, "subOption", TCL_EXACT, &subOptIndex) != TCL_OK) {
+					return TCL_ERROR;
+				}
+
+				if ((enum subOptions) subOptIndex == SUBOPT_CALLBACK) {
+					if (ccd->flushCallbackObj != NULL) {
+						Tcl_DecrRefCount (ccd->flushCallbackObj);
+						ccd->flushCallbackObj = NULL;
+					}
+
+					if (Tcl_GetCharLength (objv[arg + 1]) > 0) {
+						ccd->flushCallbackObj = objv[arg + 1];
+						Tcl_IncrRefCount (ccd->flushCallbackObj);
+					}
+					continue;
+				}
+
+				if (Tcl_GetIntFromObj (interp, objv[arg + 1], &value) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting ", Tcl_GetString (objv[arg]), " element", NULL);
+					return TCL_ERROR;
+				}
+
+				if (value < 0) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "auto flush limit ", Tcl_GetString (objv[arg]), " must not be negative", NULL);
+					return TCL_ERROR;
+				}
+
+				if ((enum subOptions) subOptIndex == SUBOPT_KEYS) {
+					ccd->maxKeys = value;
+				} else if ((enum subOptions) subOptIndex == SUBOPT_BATCH_SIZE) {
+					ccd->batchSize = value;
+				} else if (value != ccd->interval) {
+					// start the clock again for the deltas already waiting
+					if (ccd->intervalTimer != NULL) {
+						Tcl_DeleteTimerHandler (ccd->intervalTimer);
+						ccd->intervalTimer = NULL;
+					}
+
+					ccd->interval = value;
+					if ((ccd->deltaHash.numEntries > 0) && (ccd->interval > 0)) {
+						ccd->intervalTimer = Tcl_CreateTimerHandler (ccd->interval, casstcl_counter_interval_proc, (ClientData)ccd);
+					}
+				}
+			}
+
+			Tcl_Obj *listObjv[8];
+
+			listObjv[0] = Tcl_NewStringObj ("-keys", -1);
+			listObjv[1] = Tcl_NewIntObj (ccd->maxKeys);
+			listObjv[2] = Tcl_NewStringObj ("-interval", -1);
+			listObjv[3] = Tcl_NewIntObj (ccd->interval);
+			listObjv[4] = Tcl_NewStringObj ("-batch_size", -1);
+			listObjv[5] = Tcl_NewIntObj (ccd->batchSize);
+			listObjv[6] = Tcl_NewStringObj ("-callback", -1);
+			listObjv[7] = (ccd->flushCallbackObj != NULL) ? ccd->flushCallbackObj : Tcl_NewObj ();
+			Tcl_SetObjResult (interp, Tcl_NewListObj (8, listObjv));
+			break;
+		}
+
+		case OPT_FLUSH: {
+			Tcl_Obj *callbackObj = ccd->flushCallbackObj;
+
+			if ((objc != 2) && !((objc == 4) && (strcmp (Tcl_GetString (objv[2]), "-callback") == 0))) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-callback callback?");
+				return TCL_ERROR;
+			}
+
+			if (objc == 4) {
+				callbackObj = (Tcl_GetCharLength (objv[3]) > 0) ? objv[3] : NULL;
+			}
+
+			resultCode = casstcl_counter_flush (ccd, callbackObj);
+			break;
+		}
+
+		case OPT_RESET: {
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
+			}
+
+			casstcl_counter_clear (ccd, 1);
+			break;
+		}
+
+		case OPT_DELETE: {
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
+			}
+
+			if (Tcl_DeleteCommandFromToken (ccd->ct->interp, ccd->cmdToken) == TCL_ERROR) {
+				resultCode = TCL_ERROR;
+			}
+			break;
+		}
+	}
+	return resultCode;
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
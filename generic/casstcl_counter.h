@@ -0,0 +1,58 @@
+/*
+ *
+ * Include file for casstcl_counter
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_counterAccumulatorObjectDelete -- command deletion
+ *   callback routine.
+ *
+ * Results:
+ *      ...destroys the counter accumulator object, throwing away
+ *         any deltas that haven't been flushed.
+ *      ...frees memory.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_counterAccumulatorObjectDelete (ClientData clientData);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_createCounterAccumulatorObjectCommand --
+ *
+ *    given a casstcl_sessionClientData pointer and an object name (or
+ *    "#auto"), create a counter accumulator object command
+ *
+ * Results:
+ *    A standard Tcl result
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_createCounterAccumulatorObjectCommand (casstcl_sessionClientData *ct, char *commandName);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_counterAccumulatorObjectObjCmd --
+ *
+ *    dispatches the subcommands of a casstcl counter accumulator command
+ *
+ * Results:
+ *    stuff
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_counterAccumulatorObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
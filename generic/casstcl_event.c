@@ -12,14 +12,18 @@
 #include "casstcl_log.h"
 #include "casstcl_event.h"
 #include "casstcl_cassandra.h"
+#include "casstcl_future.h"
+#include "casstcl_inflight.h"
+#include "casstcl_await.h"
 /*
  *----------------------------------------------------------------------
  *
  * casstcl_logging_eventProc --
  *
- *    this routine is called by the Tcl event handler to process callbacks
- *    we have set up from logging callbacks we've gotten from Cassandra
- *    loop is
+ *    this routine is called by the Tcl event handler when the driver
+ *    has put log messages in the ring with nothing yet waiting to take
+ *    them out.  it hands all of the messages there to the logging
+ *    callback, as described in casstcl_log_drain
  *
  * Results:
  *    returns 1 to say we handled the event and the dispatcher can delete it
@@ -28,53 +32,9 @@
  */
 int
 casstcl_logging_eventProc (Tcl_Event *tevPtr, int flags) {
-
-	// we got called with a Tcl_Event pointer but really it's a pointer to
-	// our casstcl_loggingEvent structure that has the Tcl_Event plus a pointer
-	// to casstcl_sessionClientData, which is our key to the kindgdom.
-	// Go get that.
-
 	casstcl_loggingEvent *evPtr = (casstcl_loggingEvent *)tevPtr;
-	Tcl_Interp *interp = evPtr->interp;
-
-#define CASSTCL_LOG_CALLBACK_LISTCOUNT 12
-
-	Tcl_Obj *listObjv[CASSTCL_LOG_CALLBACK_LISTCOUNT];
-
-	// probably won't happen but if we get a logging callback and have
-	// no callback object, return 1 saying we handled it and let the
-	// dispatcher delete the message NB this isn't exactly cool
-	if (casstcl_loggingCallbackObj == NULL) {
-		return 1;
-	}
-
-	// construct a list of key-value pairs representing the log message
-
-	listObjv[0] = Tcl_NewStringObj ("clock", -1);
-	listObjv[1] = Tcl_NewDoubleObj (evPtr->message.time_ms / 1000.0);
-
-	listObjv[2] = Tcl_NewStringObj ("severity", -1);
-	listObjv[3] = Tcl_NewStringObj (casstcl_cass_log_level_to_string (evPtr->message.severity), -1);
-
-	listObjv[4] = Tcl_NewStringObj ("file", -1);
-	listObjv[5] = Tcl_NewStringObj (evPtr->message.file, -1);
-
-	listObjv[6] = Tcl_NewStringObj ("line", -1);
-	listObjv[7] = Tcl_NewIntObj (evPtr->message.line);
-
-	listObjv[8] = Tcl_NewStringObj ("function", -1);
-	listObjv[9] = Tcl_NewStringObj (evPtr->message.function, -1);
-
-	listObjv[10] = Tcl_NewStringObj ("message", -1);
-	int messageLength = strnlen (evPtr->message.message, CASS_LOG_MAX_MESSAGE_SIZE);
-	listObjv[11] = Tcl_NewStringObj (evPtr->message.message, messageLength);
-
-	Tcl_Obj *listObj = Tcl_NewListObj (CASSTCL_LOG_CALLBACK_LISTCOUNT, listObjv);
 
-	// even if this fails we still want the event taken off the queue
-	// this function will do the background error thing if there is a tcl
-	// error running the callback
-	casstcl_invoke_callback_with_argument (interp, casstcl_loggingCallbackObj, listObj);
+	casstcl_log_drain (evPtr->interp);
 
 	// tell the dispatcher we handled it.  0 would mean we didn't deal with
 	// it and don't want it removed from the queue
@@ -90,21 +50,28 @@ casstcl_logging_eventProc (Tcl_Event *tevPtr, int flags) {
  *    when a log message has been received and cass_log_set_callback
  *    has been done to register this callback
  *
+ *    the message is put in the ring of log messages without taking a
+ *    lock.  only the first message since the ring was last drained
+ *    queues an event to drain it
+ *
  * Results:
- *    an event is queued to the thread that started our conversation with
- *    cassandra
+ *    an event may be queued to the thread that set the logging callback
  *
  *----------------------------------------------------------------------
  */
 void casstcl_logging_callback (const CassLogMessage *message, void *data) {
 	casstcl_loggingEvent *evPtr;
-	
 	Tcl_Interp *interp = data;
+
+	if (!casstcl_log_enqueue (message)) {
+		return;
+	}
+
 	evPtr = (casstcl_loggingEvent *)ckalloc (sizeof(casstcl_loggingEvent));
 	evPtr->event.proc = casstcl_logging_eventProc;
 	evPtr->interp = interp;
-	evPtr->message = *message; /* structure copy */
 	Tcl_ThreadQueueEvent(casstcl_loggingCallbackThreadId, (Tcl_Event *)evPtr, TCL_QUEUE_TAIL);
+	Tcl_ThreadAlert(casstcl_loggingCallbackThreadId);
 }
 
 
@@ -118,19 +85,35 @@ void casstcl_logging_callback (const CassLogMessage *message, void *data) {
  *    to make sure the application wakes up when events of the desired
  *    type occur.
  *
- *    We don't need to do anything here because we generate Tcl events
- *    onto the originating thread via the callbacks invoked from the
- *    Cassandra cpp-driver library and that's (apparently) all Tcl
- *    needs to do its thing.
+ *    The driver's threads wake us up with Tcl_ThreadAlert when the first
+ *    future completes after the session's completion stack has been
+ *    collected, so all we have to do is not block if there are already
+ *    completions waiting, for instance ones left over after the last
+ *    drain used up its budget.  The same goes for requests queued for
+ *    room in the session's in-flight window once there is room for them,
+ *    and for coroutines awaiting futures once one may have completed.
+ *
+ *    There is one of these event sources per session, the session's
+ *    client data being the client data of the event source.
  *
  * Results:
- *    The program compiles.
+ *    The maximum block time is set to zero if there is work waiting.
  *
  *----------------------------------------------------------------------
  */
 void
 casstcl_EventSetupProc (ClientData data, int flags)
 {
+	casstcl_sessionClientData *ct = (casstcl_sessionClientData *)data;
+
+	if (!(flags & TCL_FILE_EVENTS)) {
+		return;
+	}
+
+	if (casstcl_future_completions_pending (ct) || casstcl_inflight_ready (ct) || casstcl_await_wakeup_pending (ct)) {
+		Tcl_Time blockTime = {0, 0};
+		Tcl_SetMaxBlockTime (&blockTime);
+	}
 }
 
 /*
@@ -141,9 +124,15 @@ casstcl_EventSetupProc (ClientData data, int flags)
  *    Normally here an extension that generates events would look at its
  *    tables or whatnot to see what needs to be generated as an event.
  *
- *    We don't need to do that because we generate Tcl events
- *    onto the originating thread via the callbacks invoked from the
- *    Cassandra cpp-driver library, so we handle it that way.
+ *    Here we collect the futures that the driver's threads have pushed
+ *    onto the session's completion stack since the last time and queue
+ *    one event that runs as many of their callbacks as the completion
+ *    budget allows.
+ *
+ *    Before that, requests queued for room in the session's in-flight
+ *    window are executed while there is room, and anybody waiting for
+ *    room is woken up.  After it, coroutines awaiting futures that have
+ *    completed are resumed.
  *
  * Results:
  *    The program compiles.
@@ -153,6 +142,15 @@ casstcl_EventSetupProc (ClientData data, int flags)
 void
 casstcl_EventCheckProc (ClientData data, int flags)
 {
+	casstcl_sessionClientData *ct = (casstcl_sessionClientData *)data;
+
+	if (!(flags & TCL_FILE_EVENTS)) {
+		return;
+	}
+
+	casstcl_inflight_check (ct);
+	casstcl_future_collect_completions (ct);
+	casstcl_await_check (ct, 0);
 }
 
 /* vim: set ts=4 sw=4 sts=4 noet : */
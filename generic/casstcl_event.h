@@ -13,9 +13,10 @@
  *
  * casstcl_logging_eventProc --
  *
- *    this routine is called by the Tcl event handler to process callbacks
- *    we have set up from logging callbacks we've gotten from Cassandra
- *    loop is
+ *    this routine is called by the Tcl event handler when the driver
+ *    has put log messages in the ring with nothing yet waiting to take
+ *    them out.  it hands all of the messages there to the logging
+ *    callback, as described in casstcl_log_drain
  *
  * Results:
  *    returns 1 to say we handled the event and the dispatcher can delete it
@@ -34,9 +35,12 @@ casstcl_logging_eventProc (Tcl_Event *tevPtr, int flags);
  *    when a log message has been received and cass_log_set_callback
  *    has been done to register this callback
  *
+ *    the message is put in the ring of log messages without taking a
+ *    lock.  only the first message since the ring was last drained
+ *    queues an event to drain it
+ *
  * Results:
- *    an event is queued to the thread that started our conversation with
- *    cassandra
+ *    an event may be queued to the thread that set the logging callback
  *
  *----------------------------------------------------------------------
  */
@@ -53,13 +57,18 @@ void casstcl_logging_callback (const CassLogMessage *message, void *data);
  *    to make sure the application wakes up when events of the desired
  *    type occur.
  *
- *    We don't need to do anything here because we generate Tcl events
- *    onto the originating thread via the callbacks invoked from the
- *    Cassandra cpp-driver library and that's (apparently) all Tcl
- *    needs to do its thing.
+ *    The driver's threads wake us up with Tcl_ThreadAlert when the first
+ *    future completes after the session's completion stack has been
+ *    collected, so all we have to do is not block if there are already
+ *    completions waiting, for instance ones left over after the last
+ *    drain used up its budget.  The same goes for requests queued for
+ *    room in the session's in-flight window once there is room for them.
+ *
+ *    There is one of these event sources per session, the session's
+ *    client data being the client data of the event source.
  *
  * Results:
- *    The program compiles.
+ *    The maximum block time is set to zero if there is work waiting.
  *
  *----------------------------------------------------------------------
  */
@@ -73,9 +82,14 @@ void casstcl_EventSetupProc (ClientData data, int flags);
  *    Normally here an extension that generates events would look at its
  *    tables or whatnot to see what needs to be generated as an event.
  *
- *    We don't need to do that because we generate Tcl events
- *    onto the originating thread via the callbacks invoked from the
- *    Cassandra cpp-driver library, so we handle it that way.
+ *    Here we collect the futures that the driver's threads have pushed
+ *    onto the session's completion stack since the last time and queue
+ *    one event that runs as many of their callbacks as the completion
+ *    budget allows.
+ *
+ *    Before that, requests queued for room in the session's in-flight
+ *    window are executed while there is room, and anybody waiting for
+ *    room is woken up.
  *
  * Results:
  *    The program compiles.
@@ -0,0 +1,215 @@
+/*
+ * casstcl_execution - Functions for controlling how the driver executes
+ *   statements: idempotence, request timeouts and speculative execution
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_error.h"
+#include "casstcl_execution.h"
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_driver_lacks -- report that the cpp-driver casstcl
+ *   was built with doesn't have a feature
+ *
+ * Results:
+ *      TCL_ERROR, with a message in the interpreter result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_driver_lacks (Tcl_Interp *interp, const char *feature)
+{
+	char version[TCL_INTEGER_SPACE * 2 + 2];
+
+	sprintf (version, "%d.%d", CASS_VERSION_MAJOR, CASS_VERSION_MINOR);
+	Tcl_ResetResult (interp);
+	Tcl_AppendResult (interp, feature, " isn't supported by version ", version, " of the cpp-driver casstcl was built with", NULL);
+	return TCL_ERROR;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_idempotence_available -- check that statements can
+ *   be marked idempotent, before a -idempotent option is
+ *   accepted
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_idempotence_available (casstcl_sessionClientData *ct)
+{
+#ifdef CASSTCL_HAVE_SPECULATIVE_EXECUTION
+	return TCL_OK;
+#else
+	return casstcl_driver_lacks (ct->interp, "marking statements idempotent");
+#endif
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_obj_to_request_timeout -- get the value of a -timeout
+ *   option, a request timeout in milliseconds for one statement
+ *
+ * Results:
+ *      A standard Tcl result; the timeout is stored in *timeoutPtr.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_obj_to_request_timeout (casstcl_sessionClientData *ct, Tcl_Obj *timeoutObj, int *timeoutPtr)
+{
+	Tcl_Interp *interp = ct->interp;
+
+	if (Tcl_GetIntFromObj (interp, timeoutObj, timeoutPtr) == TCL_ERROR) {
+		Tcl_AppendResult (interp, " while converting timeout", NULL);
+		return TCL_ERROR;
+	}
+
+	if (*timeoutPtr < 0) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "timeout must be zero or more milliseconds", NULL);
+		return TCL_ERROR;
+	}
+
+#ifdef CASSTCL_HAVE_STATEMENT_REQUEST_TIMEOUT
+	return TCL_OK;
+#else
+	return casstcl_driver_lacks (interp, "a request timeout per statement");
+#endif
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_statement_set_execution -- mark a statement as
+ *   idempotent, if idempotent is nonzero, and give it a request
+ *   timeout overriding the cluster's, if timeoutMS isn't -1
+ *
+ *   The driver only retries or speculatively executes statements
+ *   that are idempotent.  With a driver lacking a feature the
+ *   statement runs the way it always has; callers that let the
+ *   user ask for a feature check it is there beforehand, with
+ *   casstcl_idempotence_available and
+ *   casstcl_obj_to_request_timeout.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_statement_set_execution (CassStatement *statement, int idempotent, int timeoutMS)
+{
+#ifdef CASSTCL_HAVE_SPECULATIVE_EXECUTION
+	if (idempotent) {
+		cass_statement_set_is_idempotent (statement, cass_true);
+	}
+#endif
+
+#ifdef CASSTCL_HAVE_STATEMENT_REQUEST_TIMEOUT
+	if (timeoutMS >= 0) {
+		cass_statement_set_request_timeout (statement, (cass_uint64_t)timeoutMS);
+	}
+#endif
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_speculative_execution -- set the cluster's speculative
+ *   execution policy from the arguments of the
+ *   speculative_execution method, either "none" or a delay in
+ *   milliseconds and the most speculative executions to start
+ *
+ *   With the constant policy, an idempotent statement that hasn't
+ *   been answered within the delay is also sent to the next host
+ *   in the query plan, and so on every delay up to the maximum,
+ *   the first answer being the one that is used.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_speculative_execution (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[])
+{
+	Tcl_Interp *interp = ct->interp;
+	int delayMS = 0;
+	int maxExecutions = 0;
+
+	if (objc == 3 && strcmp (Tcl_GetString (objv[2]), "none") == 0) {
+#ifdef CASSTCL_HAVE_SPECULATIVE_EXECUTION
+		CassError cassError = cass_cluster_set_no_speculative_execution_policy (ct->cluster);
+
+		if (cassError != CASS_OK) {
+			return casstcl_cass_error_to_tcl (ct, cassError);
+		}
+		return TCL_OK;
+#else
+		return casstcl_driver_lacks (interp, "speculative execution");
+#endif
+	}
+
+	if (objc != 4) {
+		Tcl_WrongNumArgs (interp, 2, objv, "delayMS maxExecutions | none");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIntFromObj (interp, objv[2], &delayMS) == TCL_ERROR) {
+		Tcl_AppendResult (interp, " while converting delayMS element", NULL);
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIntFromObj (interp, objv[3], &maxExecutions) == TCL_ERROR) {
+		Tcl_AppendResult (interp, " while converting maxExecutions element", NULL);
+		return TCL_ERROR;
+	}
+
+	if (delayMS < 0 || maxExecutions < 1) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "the delay can't be negative and there must be at least one speculative execution", NULL);
+		return TCL_ERROR;
+	}
+
+#ifdef CASSTCL_HAVE_SPECULATIVE_EXECUTION
+	CassError cassError = cass_cluster_set_constant_speculative_execution_policy (ct->cluster, (cass_int64_t)delayMS, maxExecutions);
+
+	if (cassError != CASS_OK) {
+		return casstcl_cass_error_to_tcl (ct, cassError);
+	}
+	return TCL_OK;
+#else
+	return casstcl_driver_lacks (interp, "speculative execution");
+#endif
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
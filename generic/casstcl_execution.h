@@ -0,0 +1,91 @@
+/*
+ *
+ * Include file for casstcl_execution
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_idempotence_available -- check that statements can
+ *   be marked idempotent, before a -idempotent option is
+ *   accepted
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_idempotence_available (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_obj_to_request_timeout -- get the value of a -timeout
+ *   option, a request timeout in milliseconds for one statement
+ *
+ * Results:
+ *      A standard Tcl result; the timeout is stored in *timeoutPtr.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_obj_to_request_timeout (casstcl_sessionClientData *ct, Tcl_Obj *timeoutObj, int *timeoutPtr);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_statement_set_execution -- mark a statement as
+ *   idempotent, if idempotent is nonzero, and give it a request
+ *   timeout overriding the cluster's, if timeoutMS isn't -1
+ *
+ *   The driver only retries or speculatively executes statements
+ *   that are idempotent.  With a driver lacking a feature the
+ *   statement runs the way it always has; callers that let the
+ *   user ask for a feature check it is there beforehand, with
+ *   casstcl_idempotence_available and
+ *   casstcl_obj_to_request_timeout.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_statement_set_execution (CassStatement *statement, int idempotent, int timeoutMS);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_speculative_execution -- set the cluster's speculative
+ *   execution policy from the arguments of the
+ *   speculative_execution method, either "none" or a delay in
+ *   milliseconds and the most speculative executions to start
+ *
+ *   With the constant policy, an idempotent statement that hasn't
+ *   been answered within the delay is also sent to the next host
+ *   in the query plan, and so on every delay up to the maximum,
+ *   the first answer being the one that is used.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_speculative_execution (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[]);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
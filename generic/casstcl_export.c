@@ -0,0 +1,827 @@
+/*
+ * casstcl_export - Functions for writing the results of a select to a
+ *                  channel as csv, tsv or json without going through Tcl
+ *                  objects for each row
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_export.h"
+#include "casstcl_consistency.h"
+#include "casstcl_error.h"
+#include "casstcl_execution.h"
+#include "casstcl_result.h"
+#include "casstcl_types.h"
+
+#include <assert.h>
+#include <math.h>
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_export_append_tcl -- append the string of the Tcl
+ *   object casstcl would make for a value
+ *
+ *   This is for the types that aren't formatted directly, so that
+ *   they come out the same as they do in a select.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_export_append_tcl (casstcl_sessionClientData *ct, const CassValue *value, Tcl_DString *dsPtr)
+{
+	Tcl_Obj *valueObj = NULL;
+	char *string;
+	int length;
+
+	if (casstcl_cass_value_to_tcl_obj (ct, value, &valueObj) == TCL_ERROR) {
+		return TCL_ERROR;
+	}
+
+	Tcl_IncrRefCount (valueObj);
+	string = Tcl_GetStringFromObj (valueObj, &length);
+	Tcl_DStringAppend (dsPtr, string, length);
+	Tcl_DecrRefCount (valueObj);
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_export_append_hex -- append a blob as 0x followed by
+ *   its bytes in hex, the way cqlsh shows blobs
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_export_append_hex (const CassValue *value, Tcl_DString *dsPtr)
+{
+	static const char hexDigits[] = "0123456789abcdef";
+	const cass_byte_t *data;
+	size_t size;
+	size_t i;
+	int start = Tcl_DStringLength (dsPtr);
+	char *dst;
+
+	cass_value_get_bytes (value, &data, &size);
+
+	Tcl_DStringSetLength (dsPtr, start + 2 + size * 2);
+	dst = Tcl_DStringValue (dsPtr) + start;
+	*dst++ = '0';
+	*dst++ = 'x';
+	for (i = 0; i < size; i++) {
+		*dst++ = hexDigits[data[i] >> 4];
+		*dst++ = hexDigits[data[i] & 0xf];
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_export_append_plain -- append the text of a value,
+ *   with nothing quoted or escaped
+ *
+ *   Text, numbers, booleans, uuids and blobs are formatted
+ *   straight from the value; everything else is formatted as a
+ *   select would return it.
+ *
+ *   *isTextPtr is set if the value is text, as opposed to a number
+ *   or a boolean that json would leave unquoted.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_export_append_plain (casstcl_sessionClientData *ct, const CassValue *value, Tcl_DString *dsPtr, int *isTextPtr)
+{
+	char buffer[TCL_DOUBLE_SPACE + CASS_UUID_STRING_LENGTH];
+
+	*isTextPtr = 0;
+
+	switch (cass_value_type (value)) {
+		case CASS_VALUE_TYPE_ASCII:
+		case CASS_VALUE_TYPE_TEXT:
+		case CASS_VALUE_TYPE_VARCHAR: {
+			const char *string;
+			size_t length;
+
+			cass_value_get_string (value, &string, &length);
+			Tcl_DStringAppend (dsPtr, string, length);
+			*isTextPtr = 1;
+			return TCL_OK;
+		}
+
+		case CASS_VALUE_TYPE_INT: {
+			cass_int32_t i32;
+
+			cass_value_get_int32 (value, &i32);
+			sprintf (buffer, "%d", (int)i32);
+			break;
+		}
+
+		case CASS_VALUE_TYPE_BIGINT:
+		case CASS_VALUE_TYPE_COUNTER: {
+			cass_int64_t i64;
+
+			cass_value_get_int64 (value, &i64);
+			sprintf (buffer, "%" TCL_LL_MODIFIER "d", (Tcl_WideInt)i64);
+			break;
+		}
+
+		case CASS_VALUE_TYPE_DOUBLE: {
+			cass_double_t d;
+
+			cass_value_get_double (value, &d);
+			Tcl_PrintDouble (NULL, d, buffer);
+			break;
+		}
+
+		case CASS_VALUE_TYPE_FLOAT: {
+			cass_float_t f;
+
+			cass_value_get_float (value, &f);
+			Tcl_PrintDouble (NULL, f, buffer);
+			break;
+		}
+
+		case CASS_VALUE_TYPE_BOOLEAN: {
+			cass_bool_t b;
+
+			cass_value_get_bool (value, &b);
+			strcpy (buffer, b ? "1" : "0");
+			break;
+		}
+
+		case CASS_VALUE_TYPE_UUID:
+		case CASS_VALUE_TYPE_TIMEUUID: {
+			CassUuid uuid;
+
+			cass_value_get_uuid (value, &uuid);
+			cass_uuid_string (uuid, buffer);
+			*isTextPtr = 1;
+			break;
+		}
+
+		case CASS_VALUE_TYPE_BLOB:
+		case CASS_VALUE_TYPE_CUSTOM:
+			casstcl_export_append_hex (value, dsPtr);
+			*isTextPtr = 1;
+			return TCL_OK;
+
+		case CASS_VALUE_TYPE_TIMESTAMP:
+		case CASS_VALUE_TYPE_VARINT:
+			return casstcl_export_append_tcl (ct, value, dsPtr);
+
+		default:
+			*isTextPtr = 1;
+			return casstcl_export_append_tcl (ct, value, dsPtr);
+	}
+
+	Tcl_DStringAppend (dsPtr, buffer, -1);
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_export_append_csv -- append a field to a csv row
+ *
+ *   The field is quoted if it has a comma, a double quote or a
+ *   line end in it, or is empty, so that it isn't taken for a
+ *   null, with double quotes doubled.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_export_append_csv (Tcl_DString *dsPtr, const char *string, int length)
+{
+	const char *end = string + length;
+	const char *p;
+
+	if (length > 0 && strcspn (string, ",\"\r\n") >= (size_t)length) {
+		Tcl_DStringAppend (dsPtr, string, length);
+		return;
+	}
+
+	Tcl_DStringAppend (dsPtr, "\"", 1);
+	while ((p = memchr (string, '"', end - string)) != NULL) {
+		Tcl_DStringAppend (dsPtr, string, p + 1 - string);
+		Tcl_DStringAppend (dsPtr, "\"", 1);
+		string = p + 1;
+	}
+	Tcl_DStringAppend (dsPtr, string, end - string);
+	Tcl_DStringAppend (dsPtr, "\"", 1);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_export_append_tsv -- append a field to a tsv row
+ *
+ *   Backslashes, tabs, newlines and carriage returns are written
+ *   as \\, \t, \n and \r, which is what load takes them as.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_export_append_tsv (Tcl_DString *dsPtr, const char *string, int length)
+{
+	const char *end = string + length;
+	const char *p = string;
+
+	for (p = string; p < end; p++) {
+		const char *escape;
+
+		switch (*p) {
+			case '\\': escape = "\\\\"; break;
+			case '\t': escape = "\\t"; break;
+			case '\n': escape = "\\n"; break;
+			case '\r': escape = "\\r"; break;
+			default: continue;
+		}
+
+		Tcl_DStringAppend (dsPtr, string, p - string);
+		Tcl_DStringAppend (dsPtr, escape, 2);
+		string = p + 1;
+	}
+	Tcl_DStringAppend (dsPtr, string, end - string);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_export_append_json_string -- append a string as a
+ *   json string
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_export_append_json_string (Tcl_DString *dsPtr, const char *string, int length)
+{
+	const char *end = string + length;
+	const char *p;
+
+	Tcl_DStringAppend (dsPtr, "\"", 1);
+
+	for (p = string; p < end; p++) {
+		unsigned char c = *p;
+		char escape[8];
+
+		if (c >= 0x20 && c != '"' && c != '\\') {
+			continue;
+		}
+
+		switch (c) {
+			case '"': strcpy (escape, "\\\""); break;
+			case '\\': strcpy (escape, "\\\\"); break;
+			case '\n': strcpy (escape, "\\n"); break;
+			case '\r': strcpy (escape, "\\r"); break;
+			case '\t': strcpy (escape, "\\t"); break;
+			default: sprintf (escape, "\\u%04x", c); break;
+		}
+
+		Tcl_DStringAppend (dsPtr, string, p - string);
+		Tcl_DStringAppend (dsPtr, escape, -1);
+		string = p + 1;
+	}
+
+	Tcl_DStringAppend (dsPtr, string, end - string);
+	Tcl_DStringAppend (dsPtr, "\"", 1);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_export_append_json -- append a value as json
+ *
+ *   Lists and sets become arrays and maps become objects, whose
+ *   keys are the text of the map's keys.  Numbers and booleans are
+ *   left bare, except for doubles that aren't finite, which json
+ *   has no way to write and so become null; anything else is
+ *   a string.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_export_append_json (casstcl_sessionClientData *ct, const CassValue *value, Tcl_DString *dsPtr, Tcl_DString *scratchPtr)
+{
+	CassValueType valueType = cass_value_type (value);
+	int isText;
+
+	switch (valueType) {
+		case CASS_VALUE_TYPE_LIST:
+		case CASS_VALUE_TYPE_SET:
+		case CASS_VALUE_TYPE_MAP: {
+			int isMap = (valueType == CASS_VALUE_TYPE_MAP);
+			CassIterator *iterator = isMap ? cass_iterator_from_map (value) : cass_iterator_from_collection (value);
+			int tclReturn = TCL_OK;
+			int didOne = 0;
+
+			Tcl_DStringAppend (dsPtr, isMap ? "{" : "[", 1);
+
+			while (tclReturn == TCL_OK && cass_iterator_next (iterator)) {
+				if (didOne) {
+					Tcl_DStringAppend (dsPtr, ",", 1);
+				}
+				didOne = 1;
+
+				if (!isMap) {
+					tclReturn = casstcl_export_append_json (ct, cass_iterator_get_value (iterator), dsPtr, scratchPtr);
+					continue;
+				}
+
+				// json keys can only be strings
+				Tcl_DStringSetLength (scratchPtr, 0);
+				tclReturn = casstcl_export_append_plain (ct, cass_iterator_get_map_key (iterator), scratchPtr, &isText);
+				if (tclReturn == TCL_OK) {
+					casstcl_export_append_json_string (dsPtr, Tcl_DStringValue (scratchPtr), Tcl_DStringLength (scratchPtr));
+					Tcl_DStringAppend (dsPtr, ":", 1);
+					tclReturn = casstcl_export_append_json (ct, cass_iterator_get_map_value (iterator), dsPtr, scratchPtr);
+				}
+			}
+
+			cass_iterator_free (iterator);
+			Tcl_DStringAppend (dsPtr, isMap ? "}" : "]", 1);
+			return tclReturn;
+		}
+
+		case CASS_VALUE_TYPE_BOOLEAN: {
+			cass_bool_t b;
+
+			cass_value_get_bool (value, &b);
+			Tcl_DStringAppend (dsPtr, b ? "true" : "false", -1);
+			return TCL_OK;
+		}
+
+		case CASS_VALUE_TYPE_DOUBLE:
+		case CASS_VALUE_TYPE_FLOAT: {
+			double d;
+
+			if (valueType == CASS_VALUE_TYPE_DOUBLE) {
+				cass_double_t cassDouble;
+
+				cass_value_get_double (value, &cassDouble);
+				d = cassDouble;
+			} else {
+				cass_float_t cassFloat;
+
+				cass_value_get_float (value, &cassFloat);
+				d = cassFloat;
+			}
+
+			if (!isfinite (d)) {
+				Tcl_DStringAppend (dsPtr, "null", 4);
+				return TCL_OK;
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	Tcl_DStringSetLength (scratchPtr, 0);
+	if (casstcl_export_append_plain (ct, value, scratchPtr, &isText) == TCL_ERROR) {
+		return TCL_ERROR;
+	}
+
+	if (isText) {
+		casstcl_export_append_json_string (dsPtr, Tcl_DStringValue (scratchPtr), Tcl_DStringLength (scratchPtr));
+	} else {
+		Tcl_DStringAppend (dsPtr, Tcl_DStringValue (scratchPtr), Tcl_DStringLength (scratchPtr));
+	}
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_export_append_rows -- format all of the rows of a page
+ *   onto the end of the output buffer
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_export_append_rows (casstcl_sessionClientData *ct, const CassResult *result, int format, Tcl_Obj **names, Tcl_DString *dsPtr, Tcl_DString *fieldPtr, Tcl_DString *scratchPtr)
+{
+	int columnCount = cass_result_column_count (result);
+	CassIterator *iterator = cass_iterator_from_result (result);
+	int tclReturn = TCL_OK;
+
+	while (tclReturn == TCL_OK && cass_iterator_next (iterator)) {
+		const CassRow *row = cass_iterator_get_row (iterator);
+		int didOne = 0;
+		int i;
+
+		if (format == CASSTCL_EXPORT_FORMAT_JSON) {
+			Tcl_DStringAppend (dsPtr, "{", 1);
+		}
+
+		for (i = 0; i < columnCount; i++) {
+			const CassValue *value = cass_row_get_column (row, i);
+			int isText;
+
+			if (format == CASSTCL_EXPORT_FORMAT_JSON) {
+				char *name;
+				int nameLength;
+
+				// nulls are left out, as they are from a select's dicts
+				if (cass_value_is_null (value)) {
+					continue;
+				}
+
+				if (didOne) {
+					Tcl_DStringAppend (dsPtr, ",", 1);
+				}
+				didOne = 1;
+
+				name = Tcl_GetStringFromObj (names[i], &nameLength);
+				casstcl_export_append_json_string (dsPtr, name, nameLength);
+				Tcl_DStringAppend (dsPtr, ":", 1);
+				tclReturn = casstcl_export_append_json (ct, value, dsPtr, scratchPtr);
+				if (tclReturn == TCL_ERROR) {
+					break;
+				}
+				continue;
+			}
+
+			if (i > 0) {
+				Tcl_DStringAppend (dsPtr, (format == CASSTCL_EXPORT_FORMAT_CSV) ? "," : "\t", 1);
+			}
+
+			// a null is an empty field
+			if (cass_value_is_null (value)) {
+				continue;
+			}
+
+			Tcl_DStringSetLength (fieldPtr, 0);
+			if (casstcl_export_append_plain (ct, value, fieldPtr, &isText) == TCL_ERROR) {
+				tclReturn = TCL_ERROR;
+				break;
+			}
+
+			if (format == CASSTCL_EXPORT_FORMAT_CSV) {
+				casstcl_export_append_csv (dsPtr, Tcl_DStringValue (fieldPtr), Tcl_DStringLength (fieldPtr));
+			} else {
+				casstcl_export_append_tsv (dsPtr, Tcl_DStringValue (fieldPtr), Tcl_DStringLength (fieldPtr));
+			}
+		}
+
+		if (format == CASSTCL_EXPORT_FORMAT_JSON) {
+			Tcl_DStringAppend (dsPtr, "}", 1);
+		}
+		Tcl_DStringAppend (dsPtr, "\n", 1);
+	}
+
+	cass_iterator_free (iterator);
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_export_write -- write out and empty the output buffer
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_export_write (Tcl_Interp *interp, Tcl_Channel channel, Tcl_DString *dsPtr)
+{
+	if (Tcl_WriteChars (channel, Tcl_DStringValue (dsPtr), Tcl_DStringLength (dsPtr)) < 0) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "error writing \"", Tcl_GetChannelName (channel), "\": ", Tcl_PosixError (interp), NULL);
+		return TCL_ERROR;
+	}
+
+	Tcl_DStringSetLength (dsPtr, 0);
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_export -- write the rows of a query to a channel
+ *
+ *   The query is paged through in C.  The request for each page
+ *   after the first is made as soon as the page before it has
+ *   arrived, so that the cluster is fetching one page while the
+ *   one before it is being formatted and written.  Each page is
+ *   formatted into one buffer that is reused for every page and
+ *   written to the channel in one go.
+ *
+ *   csv and tsv rows are preceded by a line of the column names
+ *   if header is set; json rows are objects, one to a line.
+ *
+ * Results:
+ *      A standard Tcl result.  On success the interpreter result is
+ *      a list of key-value pairs: rows, the number of rows written,
+ *      pages, the number of pages, and seconds, how long it took.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_export (casstcl_sessionClientData *ct, Tcl_Channel channel, char *query, int format, int pagingSize, CassConsistency *consistencyPtr, int header)
+{
+	Tcl_Interp *interp = ct->interp;
+	CassStatement *statement = cass_statement_new (query, 0);
+	CassFuture *future;
+	Tcl_Obj **names = NULL;
+	int columnCount = 0;
+	Tcl_WideInt rows = 0;
+	int pages = 0;
+	int tclReturn = TCL_OK;
+	Tcl_DString ds;
+	Tcl_DString field;
+	Tcl_DString scratch;
+	Tcl_Time startTime;
+	Tcl_Time endTime;
+
+	if (casstcl_setStatementConsistency (ct, statement, consistencyPtr) != TCL_OK) {
+		cass_statement_free (statement);
+		return TCL_ERROR;
+	}
+
+	cass_statement_set_paging_size (statement, pagingSize);
+	casstcl_statement_set_execution (statement, 1, -1);
+
+	Tcl_DStringInit (&ds);
+	Tcl_DStringInit (&field);
+	Tcl_DStringInit (&scratch);
+	Tcl_GetTime (&startTime);
+
+	future = cass_session_execute (ct->session, statement);
+
+	while (future != NULL) {
+		CassError rc = cass_future_error_code (future);
+		const CassResult *result;
+
+		if (rc != CASS_OK) {
+			tclReturn = casstcl_future_error_to_tcl (ct, rc, future);
+			cass_future_free (future);
+			break;
+		}
+
+		result = cass_future_get_result (future);
+		cass_future_free (future);
+		future = NULL;
+
+		if (result == NULL) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "future has no result", NULL);
+			tclReturn = TCL_ERROR;
+			break;
+		}
+
+		// ask for the next page before doing this one
+		if (cass_result_has_more_pages (result)) {
+			cass_statement_set_paging_state (statement, result);
+			future = cass_session_execute (ct->session, statement);
+		}
+
+		if (names == NULL) {
+			int i;
+
+			names = casstcl_result_column_names (result, &columnCount);
+
+			if (header && format != CASSTCL_EXPORT_FORMAT_JSON) {
+				for (i = 0; i < columnCount; i++) {
+					char *name;
+					int nameLength;
+
+					name = Tcl_GetStringFromObj (names[i], &nameLength);
+					if (i > 0) {
+						Tcl_DStringAppend (&ds, (format == CASSTCL_EXPORT_FORMAT_CSV) ? "," : "\t", 1);
+					}
+					Tcl_DStringAppend (&ds, name, nameLength);
+				}
+				Tcl_DStringAppend (&ds, "\n", 1);
+			}
+		}
+
+		pages++;
+		rows += cass_result_row_count (result);
+		tclReturn = casstcl_export_append_rows (ct, result, format, names, &ds, &field, &scratch);
+		cass_result_free (result);
+
+		if (tclReturn == TCL_OK) {
+			tclReturn = casstcl_export_write (interp, channel, &ds);
+		}
+
+		if (tclReturn != TCL_OK) {
+			// the driver sees the page that was asked for through to
+			// the end without us
+			if (future != NULL) {
+				cass_future_free (future);
+			}
+			break;
+		}
+	}
+
+	Tcl_GetTime (&endTime);
+
+	if (tclReturn == TCL_OK) {
+		Tcl_Obj *listObj = Tcl_NewObj ();
+
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ("rows", -1));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewWideIntObj (rows));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ("pages", -1));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewIntObj (pages));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ("seconds", -1));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewDoubleObj ((endTime.sec - startTime.sec) + (endTime.usec - startTime.usec) / 1000000.0));
+		Tcl_SetObjResult (interp, listObj);
+	}
+
+	casstcl_free_column_names (names, columnCount);
+	cass_statement_free (statement);
+	Tcl_DStringFree (&ds);
+	Tcl_DStringFree (&field);
+	Tcl_DStringFree (&scratch);
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_export_from_objv -- parse the arguments of the export
+ *   method of a cassandra object and do the export
+ *
+ *   $cass export -channel chan ?-format csv|tsv|json? ?-pagesize n?
+ *       ?-consistency level? ?-noheader? query
+ *
+ *   objv[0] is the first of the options.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_export_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[])
+{
+	Tcl_Interp *interp = ct->interp;
+	Tcl_Channel channel = NULL;
+	int format = CASSTCL_EXPORT_FORMAT_CSV;
+	int pagingSize = CASSTCL_EXPORT_DEFAULT_PAGESIZE;
+	CassConsistency consistency;
+	CassConsistency *consistencyPtr = NULL;
+	int header = 1;
+	int arg;
+
+	static CONST char *options[] = {
+		"-channel",
+		"-format",
+		"-pagesize",
+		"-consistency",
+		"-noheader",
+		NULL
+	};
+
+	enum options {
+		OPT_CHANNEL,
+		OPT_FORMAT,
+		OPT_PAGESIZE,
+		OPT_CONSISTENCY,
+		OPT_NOHEADER
+	};
+
+	static CONST char *formats[] = {
+		"csv",
+		"tsv",
+		"json",
+		NULL
+	};
+
+	// the options all start with a dash; the query never does
+	for (arg = 0; arg + 1 < objc && *Tcl_GetString (objv[arg]) == '-'; arg++) {
+		int optIndex;
+		int mode;
+
+		if (Tcl_GetIndexFromObj (interp, objv[arg], options, "option", TCL_EXACT, &optIndex) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		if ((enum options) optIndex == OPT_NOHEADER) {
+			header = 0;
+			continue;
+		}
+
+		if (arg + 2 == objc) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "value for \"", Tcl_GetString (objv[arg]), "\" missing", NULL);
+			return TCL_ERROR;
+		}
+		arg++;
+
+		switch ((enum options) optIndex) {
+			case OPT_CHANNEL:
+				channel = Tcl_GetChannel (interp, Tcl_GetString (objv[arg]), &mode);
+				if (channel == NULL) {
+					return TCL_ERROR;
+				}
+
+				if (!(mode & TCL_WRITABLE)) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "channel \"", Tcl_GetString (objv[arg]), "\" wasn't opened for writing", NULL);
+					return TCL_ERROR;
+				}
+				break;
+
+			case OPT_FORMAT:
+				if (Tcl_GetIndexFromObj (interp, objv[arg], formats, "format", TCL_EXACT, &format) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				break;
+
+			case OPT_PAGESIZE:
+				if (Tcl_GetIntFromObj (interp, objv[arg], &pagingSize) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting paging size", NULL);
+					return TCL_ERROR;
+				}
+				break;
+
+			case OPT_CONSISTENCY:
+				if (casstcl_obj_to_cass_consistency (ct, objv[arg], &consistency) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				consistencyPtr = &consistency;
+				break;
+
+			case OPT_NOHEADER:
+				break;
+		}
+	}
+
+	if (arg + 1 != objc || channel == NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "a -channel and a query must be given", NULL);
+		return TCL_ERROR;
+	}
+
+	return casstcl_export (ct, channel, Tcl_GetString (objv[arg]), format, pagingSize, consistencyPtr, header);
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,59 @@
+/*
+ *
+ * Include file for casstcl_export
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_export -- write the rows of a query to a channel
+ *
+ *   The query is paged through in C.  The request for each page
+ *   after the first is made as soon as the page before it has
+ *   arrived, so that the cluster is fetching one page while the
+ *   one before it is being formatted and written.  Each page is
+ *   formatted into one buffer that is reused for every page and
+ *   written to the channel in one go.
+ *
+ *   csv and tsv rows are preceded by a line of the column names
+ *   if header is set; json rows are objects, one to a line.
+ *
+ * Results:
+ *      A standard Tcl result.  On success the interpreter result is
+ *      a list of key-value pairs: rows, the number of rows written,
+ *      pages, the number of pages, and seconds, how long it took.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_export (casstcl_sessionClientData *ct, Tcl_Channel channel, char *query, int format, int pagingSize, CassConsistency *consistencyPtr, int header);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_export_from_objv -- parse the arguments of the export
+ *   method of a cassandra object and do the export
+ *
+ *   $cass export -channel chan ?-format csv|tsv|json? ?-pagesize n?
+ *       ?-consistency level? ?-noheader? query
+ *
+ *   objv[0] is the first of the options.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_export_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[]);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -9,20 +9,117 @@
  */
 
 #include "casstcl.h"
+#include "casstcl_await.h"
 #include "casstcl_cassandra.h"
 #include "casstcl_future.h"
 #include "casstcl_error.h"
 #include "casstcl_event.h"
+#include "casstcl_inflight.h"
+#include "casstcl_manifest.h"
+#include "casstcl_stats.h"
+#include "casstcl_shared.h"
+#include "casstcl_result.h"
 
 #include <assert.h>
+#include <ctype.h>
+#include <stdlib.h>
+
+// guards the waiters of multigets and scans, shared with the driver's
+// threads that call back for their futures
+TCL_DECLARE_MUTEX(casstcl_futureWaiterMutex)
+
+// Tcl type definition for future handles, as returned by async -handle
+//
+// the internal representation is the slot number of the future in its
+// session's slab and the generation of the slot at the time the handle
+// was made, which fit in the two pointers of the Tcl_Obj so there is
+// nothing to free.  the string representation, "future#slot.generation",
+// is only made if somebody asks for it
+
+#define CASSTCL_FUTURE_HANDLE_PREFIX "future#"
+
+static void DupCassFutureHandleInternalRep (Tcl_Obj *srcPtr, Tcl_Obj *copyPtr);
+static int SetCassFutureHandleFromAny (Tcl_Interp *interp, Tcl_Obj *obj);
+static void UpdateCassFutureHandleString (Tcl_Obj *obj);
+
+Tcl_ObjType casstcl_futureHandleTclType = {
+	"CassFutureHandle",
+	NULL,
+	DupCassFutureHandleInternalRep,
+	UpdateCassFutureHandleString,
+	SetCassFutureHandleFromAny
+};
+
+// copy the internal representation of a future handle to a new Tcl object
+static void
+DupCassFutureHandleInternalRep (Tcl_Obj *srcPtr, Tcl_Obj *copyPtr)
+{
+	copyPtr->internalRep.twoPtrValue = srcPtr->internalRep.twoPtrValue;
+	copyPtr->typePtr = &casstcl_futureHandleTclType;
+}
+
+// convert a string like future#12.3 to a future handle
+static int
+SetCassFutureHandleFromAny (Tcl_Interp *interp, Tcl_Obj *obj)
+{
+	const char *string = Tcl_GetString (obj);
+	size_t prefixLength = strlen (CASSTCL_FUTURE_HANDLE_PREFIX);
+	unsigned long slot;
+	unsigned long generation;
+	char *end;
+
+	if (strncmp (string, CASSTCL_FUTURE_HANDLE_PREFIX, prefixLength) != 0 || !isdigit ((unsigned char)string[prefixLength])) {
+		goto invalid;
+	}
+
+	errno = 0;
+	slot = strtoul (&string[prefixLength], &end, 10);
+	if (*end != '.' || !isdigit ((unsigned char)end[1]) || errno != 0 || slot > INT_MAX) {
+		goto invalid;
+	}
+
+	generation = strtoul (&end[1], &end, 10);
+	if (*end != '\0' || errno != 0) {
+		goto invalid;
+	}
+
+	if (obj->typePtr != NULL && obj->typePtr->freeIntRepProc != NULL) {
+		obj->typePtr->freeIntRepProc (obj);
+	}
+
+	obj->internalRep.twoPtrValue.ptr1 = (void *)(size_t)slot;
+	obj->internalRep.twoPtrValue.ptr2 = (void *)(size_t)generation;
+	obj->typePtr = &casstcl_futureHandleTclType;
+	return TCL_OK;
+
+  invalid:
+	if (interp != NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "expected future handle but got \"", string, "\"", NULL);
+	}
+	return TCL_ERROR;
+}
+
+// generate the string representation of a future handle
+static void
+UpdateCassFutureHandleString (Tcl_Obj *obj)
+{
+	char buf[sizeof (CASSTCL_FUTURE_HANDLE_PREFIX) + 2 * TCL_INTEGER_SPACE + 2];
+	int len = sprintf (buf, "%s%lu.%lu", CASSTCL_FUTURE_HANDLE_PREFIX,
+		(unsigned long)(size_t)obj->internalRep.twoPtrValue.ptr1,
+		(unsigned long)(size_t)obj->internalRep.twoPtrValue.ptr2);
+
+	obj->bytes = ckalloc (len + 1);
+	memcpy (obj->bytes, buf, len + 1);
+	obj->length = len;
+}
 
 /*
  *----------------------------------------------------------------------
  *
- * casstcl_future_eventProc --
+ * casstcl_future_run_callback --
  *
- *    this routine is called by the Tcl event handler to process callbacks
- *    we have set up from future (result objects) we've gotten from Cassandra
+ *    run the Tcl callback of one future whose request has completed
  *
  * Results:
  *    The callback routine set when the async method was invoked is
@@ -35,17 +132,36 @@
  *
  *----------------------------------------------------------------------
  */
-int
-casstcl_future_eventProc (Tcl_Event *tevPtr, int flags) {
+static void
+casstcl_future_run_callback (casstcl_futureClientData *fcd) {
+	Tcl_Interp *interp = fcd->ct->interp;
 
-	// we got called with a Tcl_Event pointer but really it's a pointer to
-	// our casstcl_futureEvent structure that has the Tcl_Event plus a pointer
-	// to casstcl_futureClientData, which is our key to the kindgdom.
-	// Go get that.
+	// a handle future deleted while its request was outstanding has only
+	// been waiting for this to be able to go back onto the free list
+	if (fcd->cmdToken == NULL) {
+		fcd->flags &= ~CASSTCL_FUTURE_CALLBACK_PENDING_FLAG;
+		if ((fcd->flags & CASSTCL_FUTURE_DELETED_FLAG) == CASSTCL_FUTURE_DELETED_FLAG) {
+			casstcl_future_slot_release (fcd);
+			return;
+		}
+	}
 
-	casstcl_futureEvent *evPtr = (casstcl_futureEvent *)tevPtr;
-	casstcl_futureClientData *fcd = evPtr->fcd;
-	Tcl_Interp *interp = fcd->ct->interp;
+	// the coroutine of an await resumes with the handle and deletes the
+	// future itself; one that gave up on it, or is gone, leaves it here
+	if ((fcd->flags & CASSTCL_FUTURE_AWAIT_FLAG) == CASSTCL_FUTURE_AWAIT_FLAG) {
+		if ((fcd->callbackObj == NULL) || (Tcl_FindCommand (interp, Tcl_GetString (fcd->callbackObj), NULL, TCL_GLOBAL_ONLY) == NULL)) {
+			casstcl_future_slot_release (fcd);
+			return;
+		}
+	}
+
+	// the statements of a connect -prepare are prepared before its
+	// callback is run, which brings the future back here once more
+	if ((fcd->flags & CASSTCL_FUTURE_MANIFEST_FLAG) == CASSTCL_FUTURE_MANIFEST_FLAG) {
+		if (!casstcl_manifest_connected (fcd)) {
+			return;
+		}
+	}
 
 	// eval the command.  it should be the callback we were told as the
 	// first argument and the future object we created, like future0, as
@@ -57,17 +173,97 @@ casstcl_future_eventProc (Tcl_Event *tevPtr, int flags) {
 	if ( ((fcd->flags & CASSTCL_FUTURE_CALLBACK_ON_ERROR_ONLY) != CASSTCL_FUTURE_CALLBACK_ON_ERROR_ONLY ) || 
 		(casstcl_future_error_to_tcl(fcd->ct, rc, fcd->future) == TCL_ERROR ) ) { 
 		// get the name of the future object this callback is related to
-		// into an object so that we can pass it as an argument
+		// (or a handle to it) into an object so that we can pass it as
+		// an argument
 
-		Tcl_Obj *futureObj = Tcl_NewObj();
-		Tcl_GetCommandFullName(interp, fcd->cmdToken, futureObj);
+		Tcl_Obj *futureObj;
+
+		if (fcd->cmdToken == NULL) {
+			futureObj = casstcl_future_handle_obj (fcd);
+		} else {
+			futureObj = Tcl_NewObj();
+			Tcl_GetCommandFullName(interp, fcd->cmdToken, futureObj);
+		}
 	
 		casstcl_invoke_callback_with_argument (interp, fcd->callbackObj, futureObj);
 	
+	} else if (fcd->cmdToken == NULL) {
+
+		casstcl_future_slot_release (fcd);
+
 	} else {
 	
 		Tcl_DeleteCommandFromToken (interp, fcd->cmdToken);
 	}
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_eventProc --
+ *
+ *    this routine is called by the Tcl event handler to process callbacks
+ *    we have set up from future (result objects) we've gotten from Cassandra
+ *
+ *    one of these events is queued by casstcl_future_collect_completions
+ *    when there are completed futures waiting; it runs the callbacks of as
+ *    many of them as the session's completion budget allows, those queued
+ *    with -head first, in the order in which they completed
+ *
+ * Results:
+ *    The callbacks are run as described in casstcl_future_run_callback.
+ *    Any futures left over because of the budget wait for the next
+ *    pass through the event loop.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_future_eventProc (Tcl_Event *tevPtr, int flags) {
+
+	// we got called with a Tcl_Event pointer but really it's a pointer to
+	// our casstcl_futureEvent structure that has the Tcl_Event plus a pointer
+	// to casstcl_sessionClientData, which is our key to the kindgdom.
+	// Go get that.
+
+	casstcl_futureEvent *evPtr = (casstcl_futureEvent *)tevPtr;
+	casstcl_sessionClientData *ct = evPtr->ct;
+	int budget = ct->completionBudget;
+	int count = 0;
+
+	ct->completionEventQueued = 0;
+
+	// a callback may delete the session, which discards the rest
+	Tcl_Preserve ((ClientData)ct);
+
+	while (budget == 0 || count < budget) {
+		casstcl_futureClientData *fcd;
+
+		if (ct->cass_session_magic != CASS_SESSION_MAGIC) {
+			break;
+		}
+
+		if (ct->priorityHead != NULL) {
+			fcd = ct->priorityHead;
+			ct->priorityHead = fcd->nextCompletion;
+			if (ct->priorityHead == NULL) {
+				ct->priorityTail = NULL;
+			}
+		} else if (ct->completionHead != NULL) {
+			fcd = ct->completionHead;
+			ct->completionHead = fcd->nextCompletion;
+			if (ct->completionHead == NULL) {
+				ct->completionTail = NULL;
+			}
+		} else {
+			break;
+		}
+
+		fcd->nextCompletion = NULL;
+		casstcl_future_run_callback (fcd);
+		count++;
+	}
+
+	Tcl_Release ((ClientData)ct);
 
 	// tell the dispatcher we handled it.  0 would mean we didn't deal with
 	// it and don't want it removed from the queue
@@ -84,12 +280,15 @@ casstcl_future_eventProc (Tcl_Event *tevPtr, int flags) {
  *
  *    this occurs when the request has completed or errored
  *
- *    this generates a Tcl event and queues it to the thread that issued
- *    the command to do an asynchronous cassandra command with callback
- *    in the first place.
+ *    this pushes the future onto the completion stack of its session,
+ *    without locking or allocating anything, and, if the stack was
+ *    empty, wakes up the thread that issued the command to do an
+ *    asynchronous cassandra command with callback in the first place.
  *
- *    when Tcl processes the event, casstcl_future_eventProc will be invoked.
- *    that guy will do a Tcl eval to invoke the callback
+ *    that thread's event source then collects the stack and queues a
+ *    single Tcl event for however many futures have completed; when Tcl
+ *    processes it, casstcl_future_eventProc will be invoked.  that guy
+ *    will do a Tcl eval to invoke the callbacks
  *
  * Results:
  *    stuff
@@ -97,15 +296,223 @@ casstcl_future_eventProc (Tcl_Event *tevPtr, int flags) {
  *----------------------------------------------------------------------
  */
 void casstcl_future_callback (CassFuture* future, void* data) {
-	casstcl_futureEvent *evPtr;
-
 	casstcl_futureClientData *fcd = data;
-	evPtr = (casstcl_futureEvent *) ckalloc (sizeof (casstcl_futureEvent));
-	evPtr->event.proc = casstcl_future_eventProc;
-	evPtr->fcd = fcd;
-	int queueEnd = ((fcd->flags & CASSTCL_FUTURE_QUEUE_HEAD_FLAG) == CASSTCL_FUTURE_QUEUE_HEAD_FLAG) ? 
-					TCL_QUEUE_HEAD : TCL_QUEUE_TAIL;
-	Tcl_ThreadQueueEvent(fcd->ct->threadId, (Tcl_Event *)evPtr, queueEnd);
+	casstcl_sessionClientData *ct = fcd->ct;
+	casstcl_futureClientData *head;
+
+	casstcl_stats_finish (&fcd->timer, future, cass_future_error_code (future));
+
+	// the request has left the window whether or not Tcl has got round
+	// to its callback yet
+	if ((fcd->flags & CASSTCL_FUTURE_COUNTED_FLAG) == CASSTCL_FUTURE_COUNTED_FLAG) {
+		casstcl_inflight_finished (ct);
+	}
+
+	head = __atomic_load_n (&ct->completionStack, __ATOMIC_RELAXED);
+	do {
+		fcd->nextCompletion = head;
+	} while (!__atomic_compare_exchange_n (&ct->completionStack, &head, fcd, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	// only the first completion since the stack was last collected needs
+	// to wake the thread up, the rest will be collected with it
+	if (head == NULL) {
+		Tcl_ThreadAlert (ct->threadId);
+	}
+
+	casstcl_await_wakeup (ct);
+	casstcl_callback_finished (ct);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_completions_pending --
+ *
+ *    see if a session has completed futures whose callbacks haven't been
+ *    run yet, whether still on the stack pushed by the driver's threads
+ *    or already collected
+ *
+ * Results:
+ *    1 if there are, 0 if not
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_future_completions_pending (casstcl_sessionClientData *ct) {
+	return ((ct->priorityHead != NULL) || (ct->completionHead != NULL) ||
+		(__atomic_load_n (&ct->completionStack, __ATOMIC_RELAXED) != NULL));
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_collect_completions --
+ *
+ *    take everything pushed onto a session's completion stack by the
+ *    driver's threads, append it in order of completion to the priority
+ *    or normal completion list and, if there is anything to run and no
+ *    event queued to run it, queue one
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void
+casstcl_future_collect_completions (casstcl_sessionClientData *ct) {
+	casstcl_futureClientData *stack = __atomic_exchange_n (&ct->completionStack, NULL, __ATOMIC_ACQUIRE);
+	casstcl_futureClientData *ordered = NULL;
+
+	// the stack is newest first; turn it around
+	while (stack != NULL) {
+		casstcl_futureClientData *next = stack->nextCompletion;
+
+		stack->nextCompletion = ordered;
+		ordered = stack;
+		stack = next;
+	}
+
+	while (ordered != NULL) {
+		casstcl_futureClientData *fcd = ordered;
+		casstcl_futureClientData **headPtr = &ct->completionHead;
+		casstcl_futureClientData **tailPtr = &ct->completionTail;
+
+		ordered = fcd->nextCompletion;
+		fcd->nextCompletion = NULL;
+
+		if ((fcd->flags & CASSTCL_FUTURE_QUEUE_HEAD_FLAG) == CASSTCL_FUTURE_QUEUE_HEAD_FLAG) {
+			headPtr = &ct->priorityHead;
+			tailPtr = &ct->priorityTail;
+		}
+
+		if (*tailPtr == NULL) {
+			*headPtr = fcd;
+		} else {
+			(*tailPtr)->nextCompletion = fcd;
+		}
+		*tailPtr = fcd;
+	}
+
+	if (!ct->completionEventQueued && ((ct->priorityHead != NULL) || (ct->completionHead != NULL))) {
+		casstcl_futureEvent *evPtr = (casstcl_futureEvent *) ckalloc (sizeof (casstcl_futureEvent));
+
+		evPtr->event.proc = casstcl_future_eventProc;
+		evPtr->ct = ct;
+		Tcl_QueueEvent ((Tcl_Event *)evPtr, (ct->priorityHead != NULL) ? TCL_QUEUE_HEAD : TCL_QUEUE_TAIL);
+		ct->completionEventQueued = 1;
+	}
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_event_match --
+ *
+ *    Tcl_DeleteEvents predicate matching the completion event of a
+ *    session
+ *
+ * Results:
+ *    1 if the event is ours and for the session, 0 otherwise
+ *
+ *----------------------------------------------------------------------
+ */
+static int
+casstcl_future_event_match (Tcl_Event *tevPtr, ClientData clientData) {
+	return ((tevPtr->proc == casstcl_future_eventProc) && (((casstcl_futureEvent *)tevPtr)->ct == clientData));
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_discard_completions --
+ *
+ *    called when a session is being deleted to forget about any
+ *    completed futures whose callbacks haven't been run and remove its
+ *    queued completion event, if any
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void
+casstcl_future_discard_completions (casstcl_sessionClientData *ct) {
+	Tcl_DeleteEvents (casstcl_future_event_match, (ClientData)ct);
+	ct->completionEventQueued = 0;
+
+	__atomic_store_n (&ct->completionStack, NULL, __ATOMIC_RELAXED);
+	ct->priorityHead = ct->priorityTail = NULL;
+	ct->completionHead = ct->completionTail = NULL;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_set_timer --
+ *
+ *    give a new future the timer its request is to be recorded with,
+ *    or one that records nothing if timer is NULL
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+static void
+casstcl_future_set_timer (casstcl_futureClientData *fcd, casstcl_requestTimer *timer)
+{
+	if (timer != NULL) {
+		fcd->timer = *timer;
+	} else {
+		fcd->timer.kind = CASSTCL_STATS_NONE;
+		fcd->timer.startTime = 0;
+		fcd->timer.request = NULL;
+		fcd->timer.writes.tables = NULL;
+		fcd->timer.writes.count = 0;
+	}
+
+	// the timer callback needs the session even for an untimed request,
+	// to take it out of the in-flight window
+	fcd->timer.ct = fcd->ct;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_attach --
+ *
+ *    give a future the driver future of its request, now that the
+ *    request has been executed, and arrange to hear from the driver when
+ *    it completes: to run the Tcl callback, if there is one, or else
+ *    just to take the request out of the session's in-flight window if
+ *    it is counted against it
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void
+casstcl_future_attach (casstcl_futureClientData *fcd, CassFuture *future)
+{
+	fcd->future = future;
+
+	if (fcd->callbackObj != NULL) {
+		if (fcd->cmdToken == NULL) {
+			fcd->flags |= CASSTCL_FUTURE_CALLBACK_PENDING_FLAG;
+		}
+		casstcl_callback_started (fcd->ct);
+		cass_future_set_callback (future, casstcl_future_callback, fcd);
+	} else if ((fcd->flags & CASSTCL_FUTURE_COUNTED_FLAG) == CASSTCL_FUTURE_COUNTED_FLAG) {
+		// a copy of the timer, not the future, so that it doesn't
+		// matter if the future is deleted first
+		casstcl_callback_started (fcd->ct);
+		cass_future_set_callback (future, casstcl_stats_timer_callback, casstcl_stats_timer_copy (&fcd->timer));
+		fcd->timer.kind = CASSTCL_STATS_NONE;
+		fcd->timer.request = NULL;
+		fcd->timer.writes.tables = NULL;
+		fcd->timer.writes.count = 0;
+	}
 }
 
 /*
@@ -119,29 +526,51 @@ void casstcl_future_callback (CassFuture* future, void* data) {
  *    "future17" that can be invoked with method arguments to access,
  *    manipulate and destroy cassandra future objects.
  *
+ *    The future may be NULL if the request has been put on the
+ *    session's request queue; it is given the driver future with
+ *    casstcl_future_attach when the request is executed.  If fcdPtr
+ *    isn't NULL the new future's client data is stored there.
+ *
+ *    The request is recorded in the session's statistics with timer
+ *    when it completes, if timer isn't NULL.
+ *
  * Results:
  *    A standard Tcl result
  *
  *----------------------------------------------------------------------
  */
 int
-casstcl_createFutureObjectCommand (casstcl_sessionClientData *ct, CassFuture *future, Tcl_Obj *callbackObj, int flags)
+casstcl_createFutureObjectCommand (casstcl_sessionClientData *ct, CassFuture *future, Tcl_Obj *callbackObj, int flags, casstcl_requestTimer *timer, casstcl_futureClientData **fcdPtr)
 {
     // allocate one of our cass future objects for Tcl and configure it
 	casstcl_futureClientData *fcd;
 
-	CassError rc = cass_future_error_code (future);
-	if (rc != CASS_OK) {
-		casstcl_future_error_to_tcl (ct, rc, future);
-		cass_future_free (future);
-		return TCL_ERROR;
+	if (future != NULL) {
+		CassError rc = cass_future_error_code (future);
+		if (rc != CASS_OK) {
+			casstcl_future_error_to_tcl (ct, rc, future);
+
+			// nothing is going to call back for it now
+			if (timer != NULL) {
+				casstcl_stats_finish (timer, future, rc);
+			}
+			cass_future_free (future);
+			if ((flags & CASSTCL_FUTURE_COUNTED_FLAG) == CASSTCL_FUTURE_COUNTED_FLAG) {
+				casstcl_inflight_finished (ct);
+			}
+			return TCL_ERROR;
+		}
 	}
 
     fcd = (casstcl_futureClientData *)ckalloc (sizeof (casstcl_futureClientData));
     fcd->cass_future_magic = CASS_FUTURE_MAGIC;
 	fcd->ct = ct;
-	fcd->future = future;
+	fcd->future = NULL;
 	fcd->flags = flags;
+	fcd->nextCompletion = NULL;
+	fcd->slot = -1;
+	fcd->generation = 0;
+	casstcl_future_set_timer (fcd, timer);
 	Tcl_Interp *interp = ct->interp;
 
 	if (callbackObj != NULL) {
@@ -149,10 +578,6 @@ casstcl_createFutureObjectCommand (casstcl_sessionClientData *ct, CassFuture *fu
 	}
 	fcd->callbackObj = callbackObj;
 
-	if (callbackObj != NULL) {
-		cass_future_set_callback (future, casstcl_future_callback, fcd);
-	}
-
 	static unsigned long nextAutoCounter = 0;
 	char *commandName;
 	int    baseNameLength;
@@ -163,13 +588,295 @@ casstcl_createFutureObjectCommand (casstcl_sessionClientData *ct, CassFuture *fu
 	snprintf (commandName, baseNameLength, "%s%lu", FUTURESTRING, nextAutoCounter++);
 
     // create a Tcl command to interface to cass
+#ifdef CASSTCL_HAVE_NRE
+    fcd->cmdToken = Tcl_NRCreateCommand (interp, commandName, casstcl_futureObjectObjCmd, casstcl_futureObjectNRObjCmd, fcd, casstcl_futureObjectDelete);
+#else
     fcd->cmdToken = Tcl_CreateObjCommand (interp, commandName, casstcl_futureObjectObjCmd, fcd, casstcl_futureObjectDelete);
+#endif
     Tcl_SetObjResult (interp, Tcl_NewStringObj (commandName, -1));
 	ckfree(commandName);
+
+	if (future != NULL) {
+		casstcl_future_attach (fcd, future);
+	}
+
+	if (fcdPtr != NULL) {
+		*fcdPtr = fcd;
+	}
     return TCL_OK;
 }
 
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_slot_alloc --
+ *
+ *    get a free slot from a session's future slab, growing the slab by
+ *    a chunk of slots if there are none
+ *
+ * Results:
+ *    A pointer to the slot, which stays valid until the session is
+ *    deleted
+ *
+ *----------------------------------------------------------------------
+ */
+static casstcl_futureClientData *
+casstcl_future_slot_alloc (casstcl_sessionClientData *ct)
+{
+	casstcl_futureClientData *fcd;
+
+	if (ct->futureFreeList == NULL) {
+		int chunk = ct->futureSlabChunks;
+		int i;
+
+		ct->futureSlab = (casstcl_futureClientData **)ckrealloc ((char *)ct->futureSlab, sizeof (casstcl_futureClientData *) * (chunk + 1));
+		ct->futureSlab[chunk] = (casstcl_futureClientData *)ckalloc (sizeof (casstcl_futureClientData) * CASSTCL_FUTURE_SLAB_CHUNK);
+		ct->futureSlabChunks++;
+
+		// thread the new slots onto the free list so that the lowest
+		// numbered one comes off first
+		for (i = CASSTCL_FUTURE_SLAB_CHUNK - 1; i >= 0; i--) {
+			fcd = &ct->futureSlab[chunk][i];
+			fcd->cass_future_magic = 0;
+			fcd->slot = chunk * CASSTCL_FUTURE_SLAB_CHUNK + i;
+			fcd->generation = 0;
+			fcd->nextCompletion = ct->futureFreeList;
+			ct->futureFreeList = fcd;
+		}
+	}
+
+	fcd = ct->futureFreeList;
+	ct->futureFreeList = fcd->nextCompletion;
+	fcd->nextCompletion = NULL;
+	return fcd;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_slot_release --
+ *
+ *    free the future and callback of a handle future and put its slot
+ *    back on its session's free list, making any handles to it stale
+ *
+ *    if the driver has yet to call back for the future, the slot can't
+ *    be reused until it has, so the future is only marked as deleted
+ *    and casstcl_future_run_callback finishes the job
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void
+casstcl_future_slot_release (casstcl_futureClientData *fcd)
+{
+	casstcl_sessionClientData *ct = fcd->ct;
+
+	assert (fcd->cass_future_magic == CASS_FUTURE_MAGIC);
+	assert (fcd->cmdToken == NULL);
+
+	if ((fcd->flags & CASSTCL_FUTURE_CALLBACK_PENDING_FLAG) == CASSTCL_FUTURE_CALLBACK_PENDING_FLAG) {
+		fcd->flags |= CASSTCL_FUTURE_DELETED_FLAG;
+		return;
+	}
+
+	if ((fcd->flags & CASSTCL_FUTURE_QUEUED_FLAG) == CASSTCL_FUTURE_QUEUED_FLAG) {
+		casstcl_inflight_forget (ct, fcd);
+	}
+
+	if (fcd->future != NULL) {
+		cass_future_free (fcd->future);
+		fcd->future = NULL;
+	}
+
+	if (fcd->callbackObj != NULL) {
+		Tcl_DecrRefCount (fcd->callbackObj);
+		fcd->callbackObj = NULL;
+	}
+
+	fcd->cass_future_magic = 0;
+	fcd->generation++;
+	fcd->nextCompletion = ct->futureFreeList;
+	ct->futureFreeList = fcd;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_slab_free --
+ *
+ *    called when a session is being deleted to free all of the handle
+ *    futures that haven't been deleted and the slab itself
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void
+casstcl_future_slab_free (casstcl_sessionClientData *ct)
+{
+	int chunk;
+	int i;
+
+	for (chunk = 0; chunk < ct->futureSlabChunks; chunk++) {
+		for (i = 0; i < CASSTCL_FUTURE_SLAB_CHUNK; i++) {
+			casstcl_futureClientData *fcd = &ct->futureSlab[chunk][i];
+
+			// the session is gone, nothing is going to be called back
+			if (fcd->cass_future_magic == CASS_FUTURE_MAGIC) {
+				fcd->flags &= ~CASSTCL_FUTURE_CALLBACK_PENDING_FLAG;
+				casstcl_future_slot_release (fcd);
+			}
+		}
+		ckfree ((char *)ct->futureSlab[chunk]);
+	}
+
+	if (ct->futureSlab != NULL) {
+		ckfree ((char *)ct->futureSlab);
+	}
+
+	ct->futureSlab = NULL;
+	ct->futureSlabChunks = 0;
+	ct->futureFreeList = NULL;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_handle_obj --
+ *
+ *    make a Tcl object that is a handle to a handle future
+ *
+ * Results:
+ *    A new object; its string representation isn't generated until it
+ *    is asked for
+ *
+ *----------------------------------------------------------------------
+ */
+Tcl_Obj *
+casstcl_future_handle_obj (casstcl_futureClientData *fcd)
+{
+	Tcl_Obj *obj = Tcl_NewObj ();
+
+	Tcl_InvalidateStringRep (obj);
+	obj->internalRep.twoPtrValue.ptr1 = (void *)(size_t)fcd->slot;
+	obj->internalRep.twoPtrValue.ptr2 = (void *)(size_t)fcd->generation;
+	obj->typePtr = &casstcl_futureHandleTclType;
+	return obj;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_handle_to_futureClientData --
+ *
+ *    given a session and a future handle object, find the future
+ *
+ * Results:
+ *    A pointer to the future's client data, or NULL if the object isn't
+ *    a future handle or the future it referred to has been deleted
+ *
+ *----------------------------------------------------------------------
+ */
+casstcl_futureClientData *
+casstcl_future_handle_to_futureClientData (casstcl_sessionClientData *ct, Tcl_Obj *handleObj)
+{
+	casstcl_futureClientData *fcd;
+	size_t slot;
+
+	if (Tcl_ConvertToType (NULL, handleObj, &casstcl_futureHandleTclType) != TCL_OK) {
+		return NULL;
+	}
+
+	slot = (size_t)handleObj->internalRep.twoPtrValue.ptr1;
+	if (slot >= (size_t)ct->futureSlabChunks * CASSTCL_FUTURE_SLAB_CHUNK) {
+		return NULL;
+	}
+
+	fcd = &ct->futureSlab[slot / CASSTCL_FUTURE_SLAB_CHUNK][slot % CASSTCL_FUTURE_SLAB_CHUNK];
+	if ((fcd->cass_future_magic != CASS_FUTURE_MAGIC) || (fcd->generation != (unsigned long)(size_t)handleObj->internalRep.twoPtrValue.ptr2)) {
+		return NULL;
+	}
+
+	if ((fcd->flags & CASSTCL_FUTURE_DELETED_FLAG) == CASSTCL_FUTURE_DELETED_FLAG) {
+		return NULL;
+	}
+
+	return fcd;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_createFutureHandle --
+ *
+ *    given a casstcl_sessionClientData pointer, a pointer to a
+ *    CassFuture structure and a Tcl callback object (containing a
+ *    function name), this routine puts the future in a slot of the
+ *    session's future slab instead of creating a Tcl command for it.
+ *    The methods of the future are invoked through the session, like
+ *    "$cass future $handle wait".
+ *
+ *    If the callback is only wanted on error, nothing is returned and
+ *    nothing the Tcl code can see is ever created unless there is an
+ *    error; the slot is simply reused when the request succeeds.
+ *
+ *    This doesn't wait for the request, so errors are never returned
+ *    from here, only through the callback or the methods of the future.
+ *
+ *    As with casstcl_createFutureObjectCommand, the future may be NULL
+ *    for a queued request, the client data is stored in *fcdPtr if
+ *    fcdPtr isn't NULL and the request is recorded with timer if it
+ *    isn't NULL.
+ *
+ * Results:
+ *    A standard Tcl result; the handle object, or nothing in the
+ *    -error_only case, is the interpreter result
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_createFutureHandle (casstcl_sessionClientData *ct, CassFuture *future, Tcl_Obj *callbackObj, int flags, casstcl_requestTimer *timer, casstcl_futureClientData **fcdPtr)
+{
+	casstcl_futureClientData *fcd;
+	Tcl_Interp *interp = ct->interp;
+
+	// unlike casstcl_createFutureObjectCommand we don't look at the
+	// error code here, since it waits for the request to complete;
+	// errors are reported through the callback or the status method
+	fcd = casstcl_future_slot_alloc (ct);
+	fcd->cass_future_magic = CASS_FUTURE_MAGIC;
+	fcd->ct = ct;
+	fcd->future = NULL;
+	fcd->flags = flags;
+	fcd->cmdToken = NULL;
+	casstcl_future_set_timer (fcd, timer);
+
+	if (callbackObj != NULL) {
+		Tcl_IncrRefCount(callbackObj);
+	}
+	fcd->callbackObj = callbackObj;
+
+	if ((callbackObj != NULL) && ((flags & CASSTCL_FUTURE_CALLBACK_ON_ERROR_ONLY) == CASSTCL_FUTURE_CALLBACK_ON_ERROR_ONLY)) {
+		Tcl_ResetResult (interp);
+	} else {
+		Tcl_SetObjResult (interp, casstcl_future_handle_obj (fcd));
+	}
+
+	if (future != NULL) {
+		casstcl_future_attach (fcd, future);
+	}
+
+	if (fcdPtr != NULL) {
+		*fcdPtr = fcd;
+	}
+	return TCL_OK;
+}
+
+
 /*
  *----------------------------------------------------------------------
  *
@@ -193,8 +900,11 @@ casstcl_futureObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
         "isready",
         "wait",
         "foreach",
+		"rows",
+		"columns",
 		"status",
 		"error_message",
+		"await",
 		"delete",
         NULL
     };
@@ -203,8 +913,11 @@ casstcl_futureObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
         OPT_ISREADY,
         OPT_WAIT,
         OPT_FOREACH,
+		OPT_ROWS,
+		OPT_COLUMNS,
 		OPT_STATUS,
 		OPT_ERRORMESSAGE,
+		OPT_AWAIT,
 		OPT_DELETE
     };
 
@@ -218,9 +931,32 @@ casstcl_futureObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 		return TCL_ERROR;
     }
 
+	// a future whose request is still queued for room in the session's
+	// in-flight window isn't ready, can be deleted or awaited, and
+	// otherwise has to wait for its request to be executed
+	if ((optIndex != OPT_ISREADY) && (optIndex != OPT_DELETE) && (optIndex != OPT_AWAIT)) {
+		if ((fcd->flags & CASSTCL_FUTURE_QUEUED_FLAG) == CASSTCL_FUTURE_QUEUED_FLAG) {
+			if (casstcl_inflight_wait (fcd->ct, fcd) == TCL_ERROR) {
+				return TCL_ERROR;
+			}
+		}
+
+		if ((fcd->cass_future_magic != CASS_FUTURE_MAGIC) || (fcd->future == NULL)) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "future's request was never executed", NULL);
+			return TCL_ERROR;
+		}
+	}
+
     switch ((enum options) optIndex) {
+		case OPT_AWAIT: {
+			// only reached when await can't yield, see
+			// casstcl_futureObjectNRObjCmd
+			return casstcl_await_unavailable (interp);
+		}
+
 		case OPT_ISREADY: {
-			Tcl_SetBooleanObj (Tcl_GetObjResult(interp), cass_future_ready (fcd->future));
+			Tcl_SetBooleanObj (Tcl_GetObjResult(interp), (fcd->future != NULL) && cass_future_ready (fcd->future));
 			break;
 		}
 
@@ -257,13 +993,88 @@ casstcl_futureObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
 			break;
 		}
 
+		case OPT_ROWS:
+		case OPT_COLUMNS: {
+			int rowStyle = CASSTCL_ROWS_LIST;
+			const CassResult* result = NULL;
+			casstcl_resultRef *resultRef = NULL;
+			Tcl_Obj **columnNames = NULL;
+			int columnCount = 0;
+			Tcl_Obj *resultObj = NULL;
+
+			static CONST char *subOptions[] = {
+				"-list",
+				"-dict",
+				NULL
+			};
+
+			enum subOptions {
+				SUBOPT_LIST,
+				SUBOPT_DICT
+			};
+
+			if ((enum options) optIndex == OPT_COLUMNS) {
+				if (objc != 2) {
+					Tcl_WrongNumArgs (interp, 2, objv, "");
+					return TCL_ERROR;
+				}
+			} else {
+				int subOptIndex;
+
+				if (objc > 3) {
+					Tcl_WrongNumArgs (interp, 2, objv, "?-list|-dict?");
+					return TCL_ERROR;
+				}
+
+				if (objc == 3) {
+					if (Tcl_GetIndexFromObj (interp, objv[2], subOptions, "subOption", TCL_EXACT, &subOptIndex) != TCL_OK) {
+						return TCL_ERROR;
+					}
+					rowStyle = (subOptIndex == SUBOPT_DICT) ? CASSTCL_ROWS_DICT : CASSTCL_ROWS_LIST;
+				}
+			}
+
+			CassError rc = cass_future_error_code (fcd->future);
+			if (rc != CASS_OK) {
+				return casstcl_future_error_to_tcl (fcd->ct, rc, fcd->future);
+			}
+
+			// a successful future may not have a result, for instance
+			// that of an insert or a connect, in which case there are
+			// no rows and no columns
+			result = cass_future_get_result (fcd->future);
+			if (result == NULL) {
+				Tcl_ResetResult (interp);
+				break;
+			}
+
+			columnNames = casstcl_result_column_names (result, &columnCount);
+			resultRef = casstcl_result_ref_new (result);
+
+			if ((enum options) optIndex == OPT_COLUMNS) {
+				resultObj = Tcl_NewListObj (columnCount, columnNames);
+			} else if (casstcl_result_rows_to_obj (fcd->ct, resultRef, columnNames, columnCount, rowStyle, &resultObj) == TCL_ERROR) {
+				resultCode = TCL_ERROR;
+			}
+
+			casstcl_free_column_names (columnNames, columnCount);
+			casstcl_result_ref_release (resultRef);
+
+			if (resultCode == TCL_OK) {
+				Tcl_SetObjResult (interp, resultObj);
+			}
+			break;
+		}
+
 		case OPT_DELETE: {
 			if (objc != 2) {
 				Tcl_WrongNumArgs (interp, 2, objv, "");
 				return TCL_ERROR;
 			}
 
-			if (Tcl_DeleteCommandFromToken (interp, fcd->cmdToken) == TCL_ERROR) {
+			if (fcd->cmdToken == NULL) {
+				casstcl_future_slot_release (fcd);
+			} else if (Tcl_DeleteCommandFromToken (interp, fcd->cmdToken) == TCL_ERROR) {
 				resultCode = TCL_ERROR;
 			}
 			break;
@@ -302,9 +1113,9 @@ casstcl_futureObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_O
  *
  * Note that it is up to the caller to free the future.
  *
- * Also note that this code bears way too much in common with casstcl_select
- * but it doesn't quite go to call this from that because that uses paging
- * through the results
+ * Also note that the row loop is shared with casstcl_select, in
+ * casstcl_result_rows_to_array, but this only walks the one page of
+ * results in the future while that one pages through the results
  *
  *----------------------------------------------------------------------
  */
@@ -313,12 +1124,10 @@ casstcl_iterate_over_future (casstcl_sessionClientData *ct, CassFuture *future,
 {
 	int tclReturn = TCL_OK;
 	const CassResult* result = NULL;
-	CassIterator* iterator;
 	int rc = cass_future_error_code(future);
 
 	if (rc != CASS_OK) {
 		casstcl_future_error_to_tcl (ct, rc, future);
-		cass_future_free (future);
 		return TCL_ERROR;
 	}
 
@@ -333,73 +1142,28 @@ casstcl_iterate_over_future (casstcl_sessionClientData *ct, CassFuture *future,
 		Tcl_ResetResult(interp);
 		return TCL_OK;
 	}
-	iterator = cass_iterator_from_result(result);
-
-	int columnCount = cass_result_column_count (result);
-
-	while (cass_iterator_next(iterator)) {
-		CassString cassNameString;
-		int i;
 
-		const CassRow* row = cass_iterator_get_row(iterator);
-
-		// process all the columns into the tcl array
-		for (i = 0; i < columnCount; i++) {
-			Tcl_Obj *newObj = NULL;
-			const char *columnName;
-			const CassValue *columnValue;
-
-			cass_result_column_name (result, i, &cassNameString.data, &cassNameString.length);
-			columnName = cassNameString.data;
-
-			columnValue = cass_row_get_column (row, i);
-
-			if (cass_value_is_null (columnValue)) {
-				Tcl_UnsetVar2 (interp, arrayName, columnName, 0);
-				continue;
-			}
-
-			if (casstcl_cass_value_to_tcl_obj (ct, columnValue, &newObj) == TCL_ERROR) {
-				tclReturn = TCL_ERROR;
-				break;
-			}
-
-			if (newObj == NULL) {
-				Tcl_UnsetVar2 (interp, arrayName, columnName, 0);
-			} else {
-				if (Tcl_SetVar2Ex (interp, arrayName, columnName, newObj, (TCL_LEAVE_ERR_MSG)) == NULL) {
-					tclReturn = TCL_ERROR;
-					break;
-				}
-			}
-		}
-
-		// now execute the code body (this version of eval does not
-		// require any reference count management of the object).
-		//
-		// as with the other place where we do this, TCL_BREAK and TCL_CONTINUE
-		// are for us, we want TCL_BREAK to break us out but return TCL_OK
-		// because our caller isn't to get a break.  TCL_RETURN, on the
-		// other hand, means a return even past our caller, so we pass that
-		// through.
-		//
-		int evalReturnCode = Tcl_EvalObjEx(interp, codeObj, 0);
-		if ((evalReturnCode != TCL_OK) && (evalReturnCode != TCL_CONTINUE)) {
-			if (evalReturnCode == TCL_RETURN) {
-				tclReturn = TCL_RETURN;
-			} else if (evalReturnCode == TCL_ERROR) {
-				char        msg[60];
-				tclReturn = TCL_ERROR;
-
-				sprintf(msg, "\n    (\"select\" body line %d)",
-						Tcl_GetErrorLine(interp));
-				Tcl_AddErrorInfo(interp, msg);
-			}
-
-			break;
-		}
+	// the column names and the array name are made into objects once
+	// and used for every row
+	int columnCount;
+	Tcl_Obj **columnNames = casstcl_result_column_names (result, &columnCount);
+	casstcl_resultRef *resultRef = casstcl_result_ref_new (result);
+	Tcl_Obj *arrayNameObj = Tcl_NewStringObj (arrayName, -1);
+	Tcl_IncrRefCount (arrayNameObj);
+
+	// as with the other place where we do this, TCL_BREAK and TCL_CONTINUE
+	// are for us, we want TCL_BREAK to break us out but return TCL_OK
+	// because our caller isn't to get a break.  TCL_RETURN, on the
+	// other hand, means a return even past our caller, so we pass that
+	// through.
+	int evalReturnCode = casstcl_result_rows_to_array (ct, resultRef, columnNames, columnCount, arrayNameObj, codeObj);
+	if ((evalReturnCode == TCL_ERROR) || (evalReturnCode == TCL_RETURN)) {
+		tclReturn = evalReturnCode;
 	}
-	cass_iterator_free(iterator);
+
+	Tcl_DecrRefCount (arrayNameObj);
+	casstcl_free_column_names (columnNames, columnCount);
+	casstcl_result_ref_release (resultRef);
 	return tclReturn;
 }
 
@@ -424,13 +1188,21 @@ casstcl_futureObjectDelete (ClientData clientData)
 
     assert (fcd->cass_future_magic == CASS_FUTURE_MAGIC);
 
-	cass_future_free (fcd->future);
+	if ((fcd->flags & CASSTCL_FUTURE_QUEUED_FLAG) == CASSTCL_FUTURE_QUEUED_FLAG) {
+		casstcl_inflight_forget (fcd->ct, fcd);
+	}
+
+	if (fcd->future != NULL) {
+		cass_future_free (fcd->future);
+	}
 
 	if (fcd->callbackObj != NULL) {
 		Tcl_DecrRefCount(fcd->callbackObj);
 	}
 
-    ckfree((char *)clientData);
+	// casstcl_inflight_wait may be holding on to it
+	fcd->cass_future_magic = 0;
+    Tcl_EventuallyFree((ClientData)clientData, TCL_DYNAMIC);
 }
 
 /*
@@ -465,4 +1237,130 @@ casstcl_future_command_to_futureClientData (Tcl_Interp *interp, char *futureComm
 	return fcd;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_waiter_new --
+ *
+ *    make something to wait on for any of several futures to be done,
+ *    holding the caller's reference to it
+ *
+ * Results:
+ *    The waiter.
+ *
+ *----------------------------------------------------------------------
+ */
+casstcl_futureWaiter *
+casstcl_future_waiter_new (void)
+{
+	casstcl_futureWaiter *waiter = (casstcl_futureWaiter *)ckalloc (sizeof (casstcl_futureWaiter));
+
+	waiter->ready = NULL;
+	waiter->nReady = 0;
+	waiter->refCount = 1;
+	return waiter;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_waiter_release --
+ *
+ *    drop a reference to a waiter, freeing it if it was the last
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void
+casstcl_future_waiter_release (casstcl_futureWaiter *waiter)
+{
+	int last;
+
+	Tcl_MutexLock (&casstcl_futureWaiterMutex);
+	last = (--waiter->refCount == 0);
+	Tcl_MutexUnlock (&casstcl_futureWaiterMutex);
+
+	if (last) {
+		Tcl_ConditionFinalize (&waiter->ready);
+		ckfree ((char *)waiter);
+	}
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_waiter_callback --
+ *
+ *    called by the driver when a future being watched by a waiter is
+ *    done, to wake the thread waiting on it
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+static void
+casstcl_future_waiter_callback (CassFuture *future, void *data)
+{
+	casstcl_futureWaiter *waiter = (casstcl_futureWaiter *)data;
+
+	Tcl_MutexLock (&casstcl_futureWaiterMutex);
+	waiter->nReady++;
+	Tcl_ConditionNotify (&waiter->ready);
+	Tcl_MutexUnlock (&casstcl_futureWaiterMutex);
+
+	casstcl_future_waiter_release (waiter);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_waiter_watch --
+ *
+ *    have a waiter woken when a future is done
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void
+casstcl_future_waiter_watch (casstcl_futureWaiter *waiter, CassFuture *future)
+{
+	Tcl_MutexLock (&casstcl_futureWaiterMutex);
+	waiter->refCount++;
+	Tcl_MutexUnlock (&casstcl_futureWaiterMutex);
+
+	cass_future_set_callback (future, casstcl_future_waiter_callback, waiter);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_waiter_wait --
+ *
+ *    wait for one of the futures a waiter watches to be done, unless
+ *    one already is that hasn't been waited for
+ *
+ *    the caller checks its futures again afterwards, as the one that
+ *    woke it may be one it has already taken
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void
+casstcl_future_waiter_wait (casstcl_futureWaiter *waiter)
+{
+	Tcl_MutexLock (&casstcl_futureWaiterMutex);
+	while (waiter->nReady == 0) {
+		Tcl_ConditionWait (&waiter->ready, &casstcl_futureWaiterMutex, NULL);
+	}
+	waiter->nReady--;
+	Tcl_MutexUnlock (&casstcl_futureWaiterMutex);
+}
+
 /* vim: set ts=4 sw=4 sts=4 noet : */
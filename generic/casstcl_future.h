@@ -16,14 +16,15 @@
  *    this routine is called by the Tcl event handler to process callbacks
  *    we have set up from future (result objects) we've gotten from Cassandra
  *
- * Results:
- *    The callback routine set when the async method was invoked is
- *    invoked in the Tcl interpreter with one argument, that being the
- *    future object that was also created when the async method was
- *    invoked
+ *    one of these events is queued by casstcl_future_collect_completions
+ *    when there are completed futures waiting; it runs the callbacks of as
+ *    many of them as the session's completion budget allows, those queued
+ *    with -head first, in the order in which they completed
  *
- *    If an uncaught error occurs when evaluating the command, a Tcl
- *    background exception is invoked
+ * Results:
+ *    The callbacks are run as described in casstcl_future_run_callback.
+ *    Any futures left over because of the budget wait for the next
+ *    pass through the event loop.
  *
  *----------------------------------------------------------------------
  */
@@ -39,12 +40,15 @@ int casstcl_future_eventProc (Tcl_Event *tevPtr, int flags);
  *
  *    this occurs when the request has completed or errored
  *
- *    this generates a Tcl event and queues it to the thread that issued
- *    the command to do an asynchronous cassandra command with callback
- *    in the first place.
+ *    this pushes the future onto the completion stack of its session,
+ *    without locking or allocating anything, and, if the stack was
+ *    empty, wakes up the thread that issued the command to do an
+ *    asynchronous cassandra command with callback in the first place.
  *
- *    when Tcl processes the event, casstcl_future_eventProc will be invoked.
- *    that guy will do a Tcl eval to invoke the callback
+ *    that thread's event source then collects the stack and queues a
+ *    single Tcl event for however many futures have completed; when Tcl
+ *    processes it, casstcl_future_eventProc will be invoked.  that guy
+ *    will do a Tcl eval to invoke the callbacks
  *
  * Results:
  *    stuff
@@ -53,6 +57,73 @@ int casstcl_future_eventProc (Tcl_Event *tevPtr, int flags);
  */
 void casstcl_future_callback (CassFuture* future, void* data);
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_completions_pending --
+ *
+ *    see if a session has completed futures whose callbacks haven't been
+ *    run yet, whether still on the stack pushed by the driver's threads
+ *    or already collected
+ *
+ * Results:
+ *    1 if there are, 0 if not
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_future_completions_pending (casstcl_sessionClientData *ct);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_collect_completions --
+ *
+ *    take everything pushed onto a session's completion stack by the
+ *    driver's threads, append it in order of completion to the priority
+ *    or normal completion list and, if there is anything to run and no
+ *    event queued to run it, queue one
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void casstcl_future_collect_completions (casstcl_sessionClientData *ct);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_discard_completions --
+ *
+ *    called when a session is being deleted to forget about any
+ *    completed futures whose callbacks haven't been run and remove its
+ *    queued completion event, if any
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void casstcl_future_discard_completions (casstcl_sessionClientData *ct);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_attach --
+ *
+ *    give a future the driver future of its request, now that the
+ *    request has been executed, and arrange to hear from the driver when
+ *    it completes: to run the Tcl callback, if there is one, or else
+ *    just to take the request out of the session's in-flight window if
+ *    it is counted against it
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void casstcl_future_attach (casstcl_futureClientData *fcd, CassFuture *future);
+
 /*
  *----------------------------------------------------------------------
  *
@@ -64,16 +135,116 @@ void casstcl_future_callback (CassFuture* future, void* data);
  *    "future17" that can be invoked with method arguments to access,
  *    manipulate and destroy cassandra future objects.
  *
+ *    The future may be NULL if the request has been put on the
+ *    session's request queue; it is given the driver future with
+ *    casstcl_future_attach when the request is executed.  If fcdPtr
+ *    isn't NULL the new future's client data is stored there.
+ *
+ *    The request is recorded in the session's statistics with timer
+ *    when it completes, if timer isn't NULL.
+ *
  * Results:
  *    A standard Tcl result
  *
  *----------------------------------------------------------------------
  */
-int casstcl_createFutureObjectCommand (
-	casstcl_sessionClientData *ct, 
-	CassFuture *future, 
-	Tcl_Obj *callbackObj, 
-	int flags);
+int casstcl_createFutureObjectCommand (casstcl_sessionClientData *ct, CassFuture *future, Tcl_Obj *callbackObj, int flags, casstcl_requestTimer *timer, casstcl_futureClientData **fcdPtr);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_createFutureHandle --
+ *
+ *    given a casstcl_sessionClientData pointer, a pointer to a
+ *    CassFuture structure and a Tcl callback object (containing a
+ *    function name), this routine puts the future in a slot of the
+ *    session's future slab instead of creating a Tcl command for it.
+ *    The methods of the future are invoked through the session, like
+ *    "$cass future $handle wait".
+ *
+ *    If the callback is only wanted on error, nothing is returned and
+ *    nothing the Tcl code can see is ever created unless there is an
+ *    error; the slot is simply reused when the request succeeds.
+ *
+ *    This doesn't wait for the request, so errors are never returned
+ *    from here, only through the callback or the methods of the future.
+ *
+ *    As with casstcl_createFutureObjectCommand, the future may be NULL
+ *    for a queued request, the client data is stored in *fcdPtr if
+ *    fcdPtr isn't NULL and the request is recorded with timer if it
+ *    isn't NULL.
+ *
+ * Results:
+ *    A standard Tcl result; the handle object, or nothing in the
+ *    -error_only case, is the interpreter result
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_createFutureHandle (casstcl_sessionClientData *ct, CassFuture *future, Tcl_Obj *callbackObj, int flags, casstcl_requestTimer *timer, casstcl_futureClientData **fcdPtr);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_slot_release --
+ *
+ *    free the future and callback of a handle future and put its slot
+ *    back on its session's free list, making any handles to it stale
+ *
+ *    if the driver has yet to call back for the future, the slot can't
+ *    be reused until it has, so the future is only marked as deleted
+ *    and casstcl_future_run_callback finishes the job
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void casstcl_future_slot_release (casstcl_futureClientData *fcd);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_slab_free --
+ *
+ *    called when a session is being deleted to free all of the handle
+ *    futures that haven't been deleted and the slab itself
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void casstcl_future_slab_free (casstcl_sessionClientData *ct);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_handle_obj --
+ *
+ *    make a Tcl object that is a handle to a handle future
+ *
+ * Results:
+ *    A new object; its string representation isn't generated until it
+ *    is asked for
+ *
+ *----------------------------------------------------------------------
+ */
+Tcl_Obj *casstcl_future_handle_obj (casstcl_futureClientData *fcd);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_handle_to_futureClientData --
+ *
+ *    given a session and a future handle object, find the future
+ *
+ * Results:
+ *    A pointer to the future's client data, or NULL if the object isn't
+ *    a future handle or the future it referred to has been deleted
+ *
+ *----------------------------------------------------------------------
+ */
+casstcl_futureClientData *casstcl_future_handle_to_futureClientData (casstcl_sessionClientData *ct, Tcl_Obj *handleObj);
 
 
 /*
@@ -110,9 +281,9 @@ int casstcl_futureObjectObjCmd(
  *
  * Note that it is up to the caller to free the future.
  *
- * Also note that this code bears way too much in common with casstcl_select
- * but it doesn't quite go to call this from that because that uses paging
- * through the results
+ * Also note that the row loop is shared with casstcl_select, in
+ * casstcl_result_rows_to_array, but this only walks the one page of
+ * results in the future while that one pages through the results
  *
  *----------------------------------------------------------------------
  */
@@ -154,4 +325,65 @@ void casstcl_futureObjectDelete (ClientData clientData);
  */
 casstcl_futureClientData * casstcl_future_command_to_futureClientData (Tcl_Interp *interp, char *futureCommandName);
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_waiter_new --
+ *
+ *    make something to wait on for any of several futures to be done,
+ *    holding the caller's reference to it
+ *
+ * Results:
+ *    The waiter.
+ *
+ *----------------------------------------------------------------------
+ */
+casstcl_futureWaiter *casstcl_future_waiter_new (void);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_waiter_release --
+ *
+ *    drop a reference to a waiter, freeing it if it was the last
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void casstcl_future_waiter_release (casstcl_futureWaiter *waiter);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_waiter_watch --
+ *
+ *    have a waiter woken when a future is done
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void casstcl_future_waiter_watch (casstcl_futureWaiter *waiter, CassFuture *future);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_future_waiter_wait --
+ *
+ *    wait for one of the futures a waiter watches to be done, unless
+ *    one already is that hasn't been waited for
+ *
+ *    the caller checks its futures again afterwards, as the one that
+ *    woke it may be one it has already taken
+ *
+ * Results:
+ *    None.
+ *
+ *----------------------------------------------------------------------
+ */
+void casstcl_future_waiter_wait (casstcl_futureWaiter *waiter);
+
 /* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,480 @@
+/*
+ * casstcl_inflight - Functions for limiting the number of asynchronous
+ *                    requests a session has outstanding at one time
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_inflight.h"
+#include "casstcl_future.h"
+#include "casstcl_stats.h"
+#include "casstcl_slowlog.h"
+
+#include <assert.h>
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_init -- initialize the in-flight window of
+ *   a session, with no limit
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_inflight_init (casstcl_sessionClientData *ct)
+{
+	ct->inFlight = 0;
+	ct->peakInFlight = 0;
+	ct->maxInFlight = 0;
+	ct->inFlightMode = CASSTCL_INFLIGHT_BLOCK;
+	ct->inFlightWaiters = 0;
+	ct->inFlightWakeup = 0;
+	ct->requestQueueHead = NULL;
+	ct->requestQueueTail = NULL;
+	ct->queuedCount = 0;
+	ct->peakQueued = 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_full -- see if a session's in-flight window
+ *   is full
+ *
+ * Results:
+ *      1 if there is a limit and it has been reached, else 0
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_inflight_full (casstcl_sessionClientData *ct)
+{
+	return ((ct->maxInFlight > 0) && (__atomic_load_n (&ct->inFlight, __ATOMIC_ACQUIRE) >= ct->maxInFlight));
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_must_queue -- see if a new request has to go
+ *   onto the session's request queue rather than be executed
+ *
+ *   Once anything is queued everything after it is too, so that
+ *   the requests go out in the order they were made.
+ *
+ * Results:
+ *      1 if the request should be queued, else 0
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_inflight_must_queue (casstcl_sessionClientData *ct)
+{
+	if (ct->inFlightMode != CASSTCL_INFLIGHT_QUEUE) {
+		return 0;
+	}
+
+	return ((ct->requestQueueHead != NULL) || casstcl_inflight_full (ct));
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_started -- count a request that has been
+ *   handed to the driver
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The peak is updated.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_inflight_started (casstcl_sessionClientData *ct)
+{
+	int inFlight = __atomic_add_fetch (&ct->inFlight, 1, __ATOMIC_ACQ_REL);
+
+	if (inFlight > ct->peakInFlight) {
+		ct->peakInFlight = inFlight;
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_finished -- count a request that has
+ *   completed
+ *
+ *   This is called from the driver's threads.  If the window was
+ *   full, the session's thread is woken up so that its event source
+ *   can execute queued requests or let a waiter go.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_inflight_finished (casstcl_sessionClientData *ct)
+{
+	int inFlight = __atomic_fetch_sub (&ct->inFlight, 1, __ATOMIC_ACQ_REL);
+	int maxInFlight = ct->maxInFlight;
+
+	if ((maxInFlight > 0) && (inFlight >= maxInFlight)) {
+		__atomic_store_n (&ct->inFlightWakeup, 1, __ATOMIC_RELEASE);
+		Tcl_ThreadAlert (ct->threadId);
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_execute -- hand a statement to the driver on
+ *   behalf of a future and count it
+ *
+ * Results:
+ *      The driver's future for the statement.
+ *
+ * Side effects:
+ *      The statement is not freed, that's up to the caller.
+ *
+ *--------------------------------------------------------------
+ */
+CassFuture *
+casstcl_inflight_execute (casstcl_sessionClientData *ct, CassStatement *statement)
+{
+	casstcl_inflight_started (ct);
+	return cass_session_execute (ct->session, statement);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_enqueue -- put a statement on the session's
+ *   request queue for a future that has been created without a
+ *   driver future
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The queue takes over the statement.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_inflight_enqueue (casstcl_sessionClientData *ct, CassStatement *statement, casstcl_futureClientData *fcd)
+{
+	casstcl_queuedRequest *request = (casstcl_queuedRequest *)ckalloc (sizeof (casstcl_queuedRequest));
+
+	assert (fcd->future == NULL);
+
+	request->next = NULL;
+	request->statement = statement;
+	request->fcd = fcd;
+	fcd->flags |= CASSTCL_FUTURE_QUEUED_FLAG;
+
+	if (ct->requestQueueTail == NULL) {
+		ct->requestQueueHead = request;
+	} else {
+		ct->requestQueueTail->next = request;
+	}
+	ct->requestQueueTail = request;
+
+	ct->queuedCount++;
+	if (ct->queuedCount > ct->peakQueued) {
+		ct->peakQueued = ct->queuedCount;
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_forget -- remove the queued request of a
+ *   future that is being deleted before it was ever executed
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The statement is freed.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_inflight_forget (casstcl_sessionClientData *ct, casstcl_futureClientData *fcd)
+{
+	casstcl_queuedRequest **requestPtr = &ct->requestQueueHead;
+	casstcl_queuedRequest *prev = NULL;
+
+	while (*requestPtr != NULL) {
+		casstcl_queuedRequest *request = *requestPtr;
+
+		if (request->fcd == fcd) {
+			*requestPtr = request->next;
+			if (ct->requestQueueTail == request) {
+				ct->requestQueueTail = prev;
+			}
+			ct->queuedCount--;
+			fcd->flags &= ~CASSTCL_FUTURE_QUEUED_FLAG;
+			casstcl_stats_discard (&fcd->timer);
+			cass_statement_free (request->statement);
+			ckfree ((char *)request);
+			return;
+		}
+
+		prev = request;
+		requestPtr = &request->next;
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_discard -- called when a session is being
+ *   deleted to throw away the requests still on its queue
+ *
+ *   The futures they belong to are left without a driver future
+ *   and their methods report that they were never executed.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_inflight_discard (casstcl_sessionClientData *ct)
+{
+	while (ct->requestQueueHead != NULL) {
+		casstcl_queuedRequest *request = ct->requestQueueHead;
+
+		ct->requestQueueHead = request->next;
+		request->fcd->flags &= ~CASSTCL_FUTURE_QUEUED_FLAG;
+		casstcl_stats_discard (&request->fcd->timer);
+		cass_statement_free (request->statement);
+		ckfree ((char *)request);
+	}
+
+	ct->requestQueueTail = NULL;
+	ct->queuedCount = 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_inflight_eventProc --
+ *
+ *    this event is queued when there is room in the window for whoever
+ *    is waiting in casstcl_inflight_wait; it doesn't do anything other
+ *    than make sure that the Tcl_DoOneEvent they are in returns
+ *
+ * Results:
+ *    returns 1 to say we handled the event and the dispatcher can delete it
+ *
+ *----------------------------------------------------------------------
+ */
+static int
+casstcl_inflight_eventProc (Tcl_Event *tevPtr, int flags)
+{
+	return 1;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_check -- called from the session's event
+ *   source to execute queued requests while there is room in the
+ *   window and to wake up anybody waiting for room
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_inflight_check (casstcl_sessionClientData *ct)
+{
+	int wakeup = __atomic_exchange_n (&ct->inFlightWakeup, 0, __ATOMIC_ACQ_REL);
+
+	while ((ct->requestQueueHead != NULL) && !casstcl_inflight_full (ct)) {
+		casstcl_queuedRequest *request = ct->requestQueueHead;
+		casstcl_slowlogRequest *slowlogRequest;
+		casstcl_writeList writes;
+
+		ct->requestQueueHead = request->next;
+		if (ct->requestQueueHead == NULL) {
+			ct->requestQueueTail = NULL;
+		}
+		ct->queuedCount--;
+		request->fcd->flags &= ~CASSTCL_FUTURE_QUEUED_FLAG;
+
+		// the request is timed from when it is executed, not from when
+		// it was queued.  the slow request log saw it when it was queued,
+		// and its upserts have been in flight since then
+		slowlogRequest = request->fcd->timer.request;
+		writes = request->fcd->timer.writes;
+		casstcl_stats_start (ct, request->fcd->timer.kind, &request->fcd->timer);
+		request->fcd->timer.request = slowlogRequest;
+		request->fcd->timer.writes = writes;
+		casstcl_future_attach (request->fcd, casstcl_inflight_execute (ct, request->statement));
+		cass_statement_free (request->statement);
+		ckfree ((char *)request);
+		wakeup = 1;
+	}
+
+	if (wakeup && (ct->inFlightWaiters > 0)) {
+		Tcl_Event *evPtr = (Tcl_Event *)ckalloc (sizeof (Tcl_Event));
+
+		evPtr->proc = casstcl_inflight_eventProc;
+		Tcl_QueueEvent (evPtr, TCL_QUEUE_HEAD);
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_ready -- see if the session's event source
+ *   has work to do for the window without waiting
+ *
+ * Results:
+ *      1 if queued requests can be executed or requests have
+ *      completed since the window was last full, else 0
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_inflight_ready (casstcl_sessionClientData *ct)
+{
+	if (__atomic_load_n (&ct->inFlightWakeup, __ATOMIC_ACQUIRE)) {
+		return 1;
+	}
+
+	return ((ct->requestQueueHead != NULL) && !casstcl_inflight_full (ct));
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_wait -- wait, servicing events, until there
+ *   is room in the session's window or, if fcd isn't NULL, until
+ *   that future's queued request has been executed
+ *
+ *   Callbacks run while we wait may well make more requests and
+ *   end up in here again, which is fine.
+ *
+ * Results:
+ *      A standard Tcl result; it is an error for the session to be
+ *      deleted while we wait.
+ *
+ * Side effects:
+ *      Any events may be serviced.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_inflight_wait (casstcl_sessionClientData *ct, casstcl_futureClientData *fcd)
+{
+	Tcl_Interp *interp = ct->interp;
+	int preserveFuture = ((fcd != NULL) && (fcd->cmdToken != NULL));
+	int tclReturn = TCL_OK;
+
+	Tcl_Preserve ((ClientData)ct);
+	if (preserveFuture) {
+		Tcl_Preserve ((ClientData)fcd);
+	}
+	ct->inFlightWaiters++;
+
+	while (1) {
+		if (ct->cass_session_magic != CASS_SESSION_MAGIC) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "session was deleted while waiting for room in its in-flight window", NULL);
+			tclReturn = TCL_ERROR;
+			break;
+		}
+
+		if (fcd == NULL) {
+			if (!casstcl_inflight_full (ct)) {
+				break;
+			}
+		} else if ((fcd->cass_future_magic != CASS_FUTURE_MAGIC) || ((fcd->flags & CASSTCL_FUTURE_QUEUED_FLAG) == 0)) {
+			break;
+		}
+
+		Tcl_DoOneEvent (TCL_ALL_EVENTS);
+	}
+
+	ct->inFlightWaiters--;
+	if (preserveFuture) {
+		Tcl_Release ((ClientData)fcd);
+	}
+	Tcl_Release ((ClientData)ct);
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_stats_obj -- describe the in-flight window
+ *   of a session
+ *
+ * Results:
+ *      A new list of key-value pairs: current, peak, limit, mode,
+ *      queued and peak_queued.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *
+casstcl_inflight_stats_obj (casstcl_sessionClientData *ct)
+{
+	Tcl_Obj *listObjv[12];
+
+	listObjv[0] = Tcl_NewStringObj ("current", -1);
+	listObjv[1] = Tcl_NewIntObj (__atomic_load_n (&ct->inFlight, __ATOMIC_ACQUIRE));
+	listObjv[2] = Tcl_NewStringObj ("peak", -1);
+	listObjv[3] = Tcl_NewIntObj (ct->peakInFlight);
+	listObjv[4] = Tcl_NewStringObj ("limit", -1);
+	listObjv[5] = Tcl_NewIntObj (ct->maxInFlight);
+	listObjv[6] = Tcl_NewStringObj ("mode", -1);
+	listObjv[7] = Tcl_NewStringObj ((ct->inFlightMode == CASSTCL_INFLIGHT_QUEUE) ? "queue" : "block", -1);
+	listObjv[8] = Tcl_NewStringObj ("queued", -1);
+	listObjv[9] = Tcl_NewIntObj (ct->queuedCount);
+	listObjv[10] = Tcl_NewStringObj ("peak_queued", -1);
+	listObjv[11] = Tcl_NewIntObj (ct->peakQueued);
+
+	return Tcl_NewListObj (12, listObjv);
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,238 @@
+/*
+ *
+ * Include file for casstcl_inflight
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_init -- initialize the in-flight window of
+ *   a session, with no limit
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_inflight_init (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_full -- see if a session's in-flight window
+ *   is full
+ *
+ * Results:
+ *      1 if there is a limit and it has been reached, else 0
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_inflight_full (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_must_queue -- see if a new request has to go
+ *   onto the session's request queue rather than be executed
+ *
+ *   Once anything is queued everything after it is too, so that
+ *   the requests go out in the order they were made.
+ *
+ * Results:
+ *      1 if the request should be queued, else 0
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_inflight_must_queue (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_started -- count a request that has been
+ *   handed to the driver
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The peak is updated.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_inflight_started (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_finished -- count a request that has
+ *   completed
+ *
+ *   This is called from the driver's threads.  If the window was
+ *   full, the session's thread is woken up so that its event source
+ *   can execute queued requests or let a waiter go.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_inflight_finished (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_execute -- hand a statement to the driver on
+ *   behalf of a future and count it
+ *
+ * Results:
+ *      The driver's future for the statement.
+ *
+ * Side effects:
+ *      The statement is not freed, that's up to the caller.
+ *
+ *--------------------------------------------------------------
+ */
+CassFuture *casstcl_inflight_execute (casstcl_sessionClientData *ct, CassStatement *statement);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_enqueue -- put a statement on the session's
+ *   request queue for a future that has been created without a
+ *   driver future
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The queue takes over the statement.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_inflight_enqueue (casstcl_sessionClientData *ct, CassStatement *statement, casstcl_futureClientData *fcd);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_forget -- remove the queued request of a
+ *   future that is being deleted before it was ever executed
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The statement is freed.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_inflight_forget (casstcl_sessionClientData *ct, casstcl_futureClientData *fcd);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_discard -- called when a session is being
+ *   deleted to throw away the requests still on its queue
+ *
+ *   The futures they belong to are left without a driver future
+ *   and their methods report that they were never executed.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_inflight_discard (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_check -- called from the session's event
+ *   source to execute queued requests while there is room in the
+ *   window and to wake up anybody waiting for room
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_inflight_check (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_ready -- see if the session's event source
+ *   has work to do for the window without waiting
+ *
+ * Results:
+ *      1 if queued requests can be executed or requests have
+ *      completed since the window was last full, else 0
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_inflight_ready (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_wait -- wait, servicing events, until there
+ *   is room in the session's window or, if fcd isn't NULL, until
+ *   that future's queued request has been executed
+ *
+ *   Callbacks run while we wait may well make more requests and
+ *   end up in here again, which is fine.
+ *
+ * Results:
+ *      A standard Tcl result; it is an error for the session to be
+ *      deleted while we wait.
+ *
+ * Side effects:
+ *      Any events may be serviced.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_inflight_wait (casstcl_sessionClientData *ct, casstcl_futureClientData *fcd);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_inflight_stats_obj -- describe the in-flight window
+ *   of a session
+ *
+ * Results:
+ *      A new list of key-value pairs: current, peak, limit, mode,
+ *      queued and peak_queued.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *casstcl_inflight_stats_obj (casstcl_sessionClientData *ct);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,988 @@
+/*
+ * casstcl_load - Functions for loading rows read from a channel into a
+ *                table, keeping a window of writes in flight
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_load.h"
+#include "casstcl_cassandra.h"
+#include "casstcl_consistency.h"
+#include "casstcl_error.h"
+#include "casstcl_prepared.h"
+#include "casstcl_schema.h"
+#include "casstcl_types.h"
+
+#include <assert.h>
+
+// a write that has been handed to the driver and the line its row
+// started on, for reporting if it fails
+typedef struct casstcl_loadWrite
+{
+	CassFuture *future;
+	Tcl_WideInt lineNumber;
+} casstcl_loadWrite;
+
+typedef struct casstcl_loadState
+{
+	casstcl_sessionClientData *ct;
+	Tcl_Channel channel;
+	char *tableName;
+	int format;
+	int ifNotExists;
+	CassConsistency *consistencyPtr;
+	int maxErrors;
+
+	// for csv and tsv, every row has the same columns, so the insert is
+	// made, prepared and its column types looked up once
+	int nColumns;
+	Tcl_Obj **columnObjs;
+	casstcl_cassTypeInfo *typeInfo;
+	Tcl_DString query;
+	const CassPrepared *prepared;
+
+	// the fields of the row being loaded, NULL for a null, and the text
+	// of the record they came from, which may span lines
+	int nFields;
+	int fieldsAllocated;
+	Tcl_Obj **fieldObjs;
+	Tcl_Obj *lineObj;
+	Tcl_DString record;
+	Tcl_DString field;
+
+	// the ring of writes in flight, oldest at windowHead
+	casstcl_loadWrite *window;
+	int windowSize;
+	int windowHead;
+	int windowCount;
+
+	Tcl_WideInt lineNumber;
+	Tcl_WideInt rows;
+	Tcl_WideInt errors;
+	Tcl_Obj *errorListObj;
+} casstcl_loadState;
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_note_error -- count a row that couldn't be loaded
+ *   and remember what went wrong with one of the first few
+ *
+ *   The message is the interpreter result, which is reset.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_load_note_error (casstcl_loadState *ls, Tcl_WideInt lineNumber)
+{
+	Tcl_Interp *interp = ls->ct->interp;
+	int nKept;
+
+	ls->errors++;
+
+	Tcl_ListObjLength (NULL, ls->errorListObj, &nKept);
+	if (nKept < CASSTCL_LOAD_ERRORS_KEPT * 2) {
+		Tcl_ListObjAppendElement (NULL, ls->errorListObj, Tcl_NewWideIntObj (lineNumber));
+		Tcl_ListObjAppendElement (NULL, ls->errorListObj, Tcl_GetObjResult (interp));
+	}
+
+	Tcl_ResetResult (interp);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_reap -- wait for the oldest write in flight and
+ *   count how it went
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_load_reap (casstcl_loadState *ls)
+{
+	casstcl_loadWrite *write = &ls->window[ls->windowHead];
+	CassError rc;
+
+	assert (ls->windowCount > 0);
+
+	rc = cass_future_error_code (write->future);
+	if (rc == CASS_OK) {
+		ls->rows++;
+	} else {
+		casstcl_future_error_to_tcl (ls->ct, rc, write->future);
+		casstcl_load_note_error (ls, write->lineNumber);
+	}
+
+	cass_future_free (write->future);
+	write->future = NULL;
+
+	ls->windowHead = (ls->windowHead + 1) % ls->windowSize;
+	ls->windowCount--;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_submit -- hand a statement to the driver, first
+ *   waiting for the oldest write if the window is full
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The statement is freed.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_load_submit (casstcl_loadState *ls, CassStatement *statement, Tcl_WideInt lineNumber)
+{
+	casstcl_loadWrite *write;
+
+	if (ls->windowCount == ls->windowSize) {
+		casstcl_load_reap (ls);
+	}
+
+	write = &ls->window[(ls->windowHead + ls->windowCount) % ls->windowSize];
+	write->future = cass_session_execute (ls->ct->session, statement);
+	write->lineNumber = lineNumber;
+	ls->windowCount++;
+
+	cass_statement_free (statement);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_add_field -- add a field to the row being loaded
+ *
+ *   A NULL field stands for a null.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_load_add_field (casstcl_loadState *ls, const char *string, int length, int isNull)
+{
+	Tcl_Obj *fieldObj = NULL;
+
+	if (ls->nFields == ls->fieldsAllocated) {
+		ls->fieldsAllocated = (ls->fieldsAllocated == 0) ? 16 : ls->fieldsAllocated * 2;
+		ls->fieldObjs = (Tcl_Obj **)ckrealloc ((char *)ls->fieldObjs, sizeof (Tcl_Obj *) * ls->fieldsAllocated);
+	}
+
+	if (!isNull) {
+		fieldObj = Tcl_NewStringObj (string, length);
+		Tcl_IncrRefCount (fieldObj);
+	}
+	ls->fieldObjs[ls->nFields++] = fieldObj;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_clear_fields -- let go of the fields of the row
+ *   that has been loaded
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_load_clear_fields (casstcl_loadState *ls)
+{
+	int i;
+
+	for (i = 0; i < ls->nFields; i++) {
+		if (ls->fieldObjs[i] != NULL) {
+			Tcl_DecrRefCount (ls->fieldObjs[i]);
+		}
+	}
+	ls->nFields = 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_split_csv -- split a csv record into fields
+ *
+ *   Fields are separated by commas.  A field may be quoted with
+ *   double quotes, in which case it may contain commas, newlines
+ *   and double quotes, which are doubled.  An empty field that
+ *   isn't quoted is a null.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_load_split_csv (casstcl_loadState *ls, const char *p, const char *end)
+{
+	while (1) {
+		if (p < end && *p == '"') {
+			p++;
+			Tcl_DStringSetLength (&ls->field, 0);
+
+			while (1) {
+				const char *quote = memchr (p, '"', end - p);
+
+				// the quotes of the record balance, but a stray quote
+				// in an unquoted field can still leave this one open
+				if (quote == NULL) {
+					Tcl_ResetResult (ls->ct->interp);
+					Tcl_AppendResult (ls->ct->interp, "unterminated quoted csv field", NULL);
+					return TCL_ERROR;
+				}
+
+				Tcl_DStringAppend (&ls->field, p, quote - p);
+				p = quote + 1;
+
+				if (p < end && *p == '"') {
+					Tcl_DStringAppend (&ls->field, "\"", 1);
+					p++;
+					continue;
+				}
+				break;
+			}
+
+			if (p < end && *p != ',') {
+				char msg[60];
+
+				sprintf (msg, "%d", ls->nFields + 1);
+				Tcl_ResetResult (ls->ct->interp);
+				Tcl_AppendResult (ls->ct->interp, "unexpected character after closing quote in csv field ", msg, NULL);
+				return TCL_ERROR;
+			}
+
+			casstcl_load_add_field (ls, Tcl_DStringValue (&ls->field), Tcl_DStringLength (&ls->field), 0);
+		} else {
+			const char *comma = memchr (p, ',', end - p);
+			const char *fieldEnd = (comma == NULL) ? end : comma;
+
+			casstcl_load_add_field (ls, p, fieldEnd - p, (fieldEnd == p));
+			p = fieldEnd;
+		}
+
+		if (p == end) {
+			return TCL_OK;
+		}
+
+		// skip the comma
+		p++;
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_split_tsv -- split a tsv record into fields
+ *
+ *   Fields are separated by tabs.  \\, \t, \n and \r in a field
+ *   stand for a backslash, a tab, a newline and a carriage return,
+ *   the way export writes them; any other backslash is kept.  An
+ *   empty field is a null.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_load_split_tsv (casstcl_loadState *ls, const char *p, const char *end)
+{
+	while (1) {
+		const char *tab = memchr (p, '\t', end - p);
+		const char *fieldEnd = (tab == NULL) ? end : tab;
+		const char *backslash = memchr (p, '\\', fieldEnd - p);
+
+		if (backslash == NULL) {
+			casstcl_load_add_field (ls, p, fieldEnd - p, (fieldEnd == p));
+		} else {
+			Tcl_DStringSetLength (&ls->field, 0);
+
+			while (backslash != NULL && backslash + 1 < fieldEnd) {
+				const char *unescaped;
+
+				switch (backslash[1]) {
+					case '\\': unescaped = "\\"; break;
+					case 't': unescaped = "\t"; break;
+					case 'n': unescaped = "\n"; break;
+					case 'r': unescaped = "\r"; break;
+					default: unescaped = NULL; break;
+				}
+
+				if (unescaped == NULL) {
+					Tcl_DStringAppend (&ls->field, p, backslash + 1 - p);
+					p = backslash + 1;
+				} else {
+					Tcl_DStringAppend (&ls->field, p, backslash - p);
+					Tcl_DStringAppend (&ls->field, unescaped, 1);
+					p = backslash + 2;
+				}
+				backslash = memchr (p, '\\', fieldEnd - p);
+			}
+
+			Tcl_DStringAppend (&ls->field, p, fieldEnd - p);
+			casstcl_load_add_field (ls, Tcl_DStringValue (&ls->field), Tcl_DStringLength (&ls->field), 0);
+		}
+		if (tab == NULL) {
+			return;
+		}
+		p = tab + 1;
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_count_quotes -- count the double quotes in a
+ *   string
+ *
+ * Results:
+ *      The number of double quotes.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_load_count_quotes (const char *string, int length)
+{
+	const char *end = string + length;
+	int count = 0;
+
+	while ((string = memchr (string, '"', end - string)) != NULL) {
+		count++;
+		string++;
+	}
+	return count;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_read_record -- read the next record from the
+ *   channel, skipping blank lines
+ *
+ *   For csv the record goes on over as many lines as it takes for
+ *   its quotes to balance.  For csv and tsv the record is split
+ *   into ls->fieldObjs; for dictlines it is left in ls->lineObj.
+ *
+ * Results:
+ *      1 if a record was read, 0 at the end of the channel, and -1
+ *      if the record couldn't be split, with *lineNumberPtr set to
+ *      the line the record started on and the error message in the
+ *      interpreter result.  TCL_ERROR in *errorPtr means the channel
+ *      couldn't be read.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_load_read_record (casstcl_loadState *ls, Tcl_WideInt *lineNumberPtr, int *errorPtr)
+{
+	Tcl_Interp *interp = ls->ct->interp;
+	char *string;
+	int length;
+	int quotes;
+
+	*errorPtr = TCL_OK;
+	casstcl_load_clear_fields (ls);
+
+	do {
+		Tcl_SetObjLength (ls->lineObj, 0);
+		if (Tcl_GetsObj (ls->channel, ls->lineObj) < 0) {
+			if (!Tcl_Eof (ls->channel) && !Tcl_InputBlocked (ls->channel)) {
+				Tcl_ResetResult (interp);
+				Tcl_AppendResult (interp, "error reading \"", Tcl_GetChannelName (ls->channel), "\": ", Tcl_PosixError (interp), NULL);
+				*errorPtr = TCL_ERROR;
+			}
+			return 0;
+		}
+		ls->lineNumber++;
+		string = Tcl_GetStringFromObj (ls->lineObj, &length);
+	} while (length == 0);
+
+	*lineNumberPtr = ls->lineNumber;
+
+	switch (ls->format) {
+		case CASSTCL_LOAD_FORMAT_DICTLINES:
+			return 1;
+
+		case CASSTCL_LOAD_FORMAT_TSV:
+			casstcl_load_split_tsv (ls, string, string + length);
+			return 1;
+
+		case CASSTCL_LOAD_FORMAT_CSV:
+			break;
+	}
+
+	quotes = casstcl_load_count_quotes (string, length);
+	if ((quotes & 1) == 0) {
+		return (casstcl_load_split_csv (ls, string, string + length) == TCL_OK) ? 1 : -1;
+	}
+
+	// a quoted field has a newline in it; gather up the lines of the
+	// record until its quotes balance
+	Tcl_DStringSetLength (&ls->record, 0);
+	Tcl_DStringAppend (&ls->record, string, length);
+
+	while (quotes & 1) {
+		Tcl_SetObjLength (ls->lineObj, 0);
+		if (Tcl_GetsObj (ls->channel, ls->lineObj) < 0) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "unterminated quoted csv field at end of file", NULL);
+			return -1;
+		}
+		ls->lineNumber++;
+		string = Tcl_GetStringFromObj (ls->lineObj, &length);
+		Tcl_DStringAppend (&ls->record, "\n", 1);
+		Tcl_DStringAppend (&ls->record, string, length);
+		quotes += casstcl_load_count_quotes (string, length);
+	}
+
+	string = Tcl_DStringValue (&ls->record);
+	length = Tcl_DStringLength (&ls->record);
+	return (casstcl_load_split_csv (ls, string, string + length) == TCL_OK) ? 1 : -1;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_set_columns -- look up the types of the columns
+ *   that csv and tsv rows are loaded into and make the insert for
+ *   them, preparing it through the session's cache
+ *
+ *   The insert is the same one an upsert of those columns makes,
+ *   so the two share the prepared statement.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_load_set_columns (casstcl_loadState *ls, int objc, Tcl_Obj **objv)
+{
+	Tcl_Interp *interp = ls->ct->interp;
+	casstcl_tableInfo *tableInfo;
+	int i;
+
+	if (objc == 0) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "no columns to load into table '", ls->tableName, "'", NULL);
+		return TCL_ERROR;
+	}
+
+	tableInfo = casstcl_lookup_table (ls->ct, ls->tableName);
+
+	ls->nColumns = objc;
+	ls->columnObjs = (Tcl_Obj **)ckalloc (sizeof (Tcl_Obj *) * objc);
+	ls->typeInfo = (casstcl_cassTypeInfo *)ckalloc (sizeof (casstcl_cassTypeInfo) * objc);
+
+	Tcl_DStringAppend (&ls->query, "INSERT INTO ", -1);
+	Tcl_DStringAppend (&ls->query, ls->tableName, -1);
+	Tcl_DStringAppend (&ls->query, " (", 2);
+
+	for (i = 0; i < objc; i++) {
+		ls->columnObjs[i] = objv[i];
+		Tcl_IncrRefCount (objv[i]);
+	}
+
+	for (i = 0; i < objc; i++) {
+		int tclReturn = casstcl_lookup_column_type (interp, tableInfo, objv[i], &ls->typeInfo[i]);
+
+		if (tclReturn == TCL_ERROR) {
+			return TCL_ERROR;
+		}
+
+		if (tclReturn == TCL_CONTINUE) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "unknown column '", Tcl_GetString (objv[i]), "' in load for table '", ls->tableName, "'", NULL);
+			return TCL_ERROR;
+		}
+
+		if (i > 0) {
+			Tcl_DStringAppend (&ls->query, ",", 1);
+		}
+		Tcl_DStringAppend (&ls->query, Tcl_GetString (objv[i]), -1);
+	}
+
+	Tcl_DStringAppend (&ls->query, ") values (", -1);
+	for (i = 0; i < objc; i++) {
+		Tcl_DStringAppend (&ls->query, (i > 0) ? ",?" : "?", -1);
+	}
+	Tcl_DStringAppend (&ls->query, ls->ifNotExists ? ") IF NOT EXISTS" : ")", -1);
+
+	return casstcl_prepared_cache_lookup (ls->ct, Tcl_DStringValue (&ls->query), &ls->prepared);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_bind_fields -- make a statement inserting the
+ *   fields of a csv or tsv row
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_load_bind_fields (casstcl_loadState *ls, CassStatement **statementPtr)
+{
+	casstcl_sessionClientData *ct = ls->ct;
+	Tcl_Interp *interp = ct->interp;
+	CassStatement *statement;
+	int i;
+
+	if (ls->nFields != ls->nColumns) {
+		Tcl_ResetResult (interp);
+		Tcl_SetObjResult (interp, Tcl_ObjPrintf ("row has %d fields but %d columns are being loaded", ls->nFields, ls->nColumns));
+		return TCL_ERROR;
+	}
+
+	if (ls->prepared != NULL) {
+		statement = cass_prepared_bind (ls->prepared);
+	} else {
+		statement = cass_statement_new (Tcl_DStringValue (&ls->query), ls->nColumns);
+	}
+
+	if (casstcl_setStatementConsistency (ct, statement, ls->consistencyPtr) != TCL_OK) {
+		cass_statement_free (statement);
+		return TCL_ERROR;
+	}
+
+	for (i = 0; i < ls->nColumns; i++) {
+		if (ls->fieldObjs[i] == NULL) {
+			CassError cassError = cass_statement_bind_null (statement, i);
+
+			if (cassError != CASS_OK) {
+				casstcl_cass_error_to_tcl (ct, cassError);
+				cass_statement_free (statement);
+				return TCL_ERROR;
+			}
+			continue;
+		}
+
+		if (casstcl_bind_tcl_obj (ct, statement, NULL, 0, i, &ls->typeInfo[i], ls->fieldObjs[i]) == TCL_ERROR) {
+			Tcl_AppendResult (interp, " while attempting to bind field '", Tcl_GetString (ls->columnObjs[i]), "' of type '", casstcl_cass_value_type_to_string (ls->typeInfo[i].cassValueType), "', value '", Tcl_GetString (ls->fieldObjs[i]), "'", NULL);
+			cass_statement_free (statement);
+			return TCL_ERROR;
+		}
+	}
+
+	*statementPtr = statement;
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_free -- release everything held by a load
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_load_free (casstcl_loadState *ls)
+{
+	int i;
+
+	casstcl_load_clear_fields (ls);
+	if (ls->fieldObjs != NULL) {
+		ckfree ((char *)ls->fieldObjs);
+	}
+
+	for (i = 0; i < ls->nColumns; i++) {
+		Tcl_DecrRefCount (ls->columnObjs[i]);
+	}
+	if (ls->columnObjs != NULL) {
+		ckfree ((char *)ls->columnObjs);
+	}
+	if (ls->typeInfo != NULL) {
+		ckfree ((char *)ls->typeInfo);
+	}
+
+	ckfree ((char *)ls->window);
+	Tcl_DecrRefCount (ls->lineObj);
+	Tcl_DecrRefCount (ls->errorListObj);
+	Tcl_DStringFree (&ls->query);
+	Tcl_DStringFree (&ls->record);
+	Tcl_DStringFree (&ls->field);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load -- load the rows read from a channel into a table
+ *
+ *   Each record read is made into an insert, which is handed to the
+ *   driver without waiting for it, up to a window of writes in
+ *   flight; when the window is full the oldest write is waited for
+ *   before the next goes out.  Rows that can't be parsed, bound or
+ *   written are counted and loading carries on, unless there are
+ *   more than maxErrors of them (when it is not negative).
+ *
+ *   columnsObj gives the columns of csv and tsv rows, in order.  If
+ *   it is NULL the first record is read as the names of the columns.
+ *   dictlines rows are lists of column names and values, each being
+ *   upserted as with exec -upsert.
+ *
+ * Results:
+ *      A standard Tcl result.  On success the interpreter result is
+ *      a list of key-value pairs: lines, the number of lines read,
+ *      rows, the number of rows written, errors, the number of rows
+ *      that couldn't be, seconds, rows_per_second, and first_errors,
+ *      a list of the line and message of up to the first
+ *      CASSTCL_LOAD_ERRORS_KEPT errors.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_load (casstcl_sessionClientData *ct, Tcl_Channel channel, char *tableName, int format, Tcl_Obj *columnsObj, int ifNotExists, CassConsistency *consistencyPtr, int windowSize, int maxErrors)
+{
+	Tcl_Interp *interp = ct->interp;
+	casstcl_loadState ls;
+	Tcl_Time startTime;
+	Tcl_Time endTime;
+	int tclReturn = TCL_OK;
+	int status = 1;
+
+	assert (windowSize > 0);
+
+	memset (&ls, 0, sizeof (ls));
+	ls.ct = ct;
+	ls.channel = channel;
+	ls.tableName = tableName;
+	ls.format = format;
+	ls.ifNotExists = ifNotExists;
+	ls.consistencyPtr = consistencyPtr;
+	ls.maxErrors = maxErrors;
+	ls.windowSize = windowSize;
+	ls.window = (casstcl_loadWrite *)ckalloc (sizeof (casstcl_loadWrite) * windowSize);
+	ls.lineObj = Tcl_NewObj ();
+	Tcl_IncrRefCount (ls.lineObj);
+	ls.errorListObj = Tcl_NewObj ();
+	Tcl_IncrRefCount (ls.errorListObj);
+	Tcl_DStringInit (&ls.query);
+	Tcl_DStringInit (&ls.record);
+	Tcl_DStringInit (&ls.field);
+
+	Tcl_GetTime (&startTime);
+
+	if (format != CASSTCL_LOAD_FORMAT_DICTLINES) {
+		int columnObjc;
+		Tcl_Obj **columnObjv;
+
+		if (columnsObj != NULL) {
+			if (Tcl_ListObjGetElements (interp, columnsObj, &columnObjc, &columnObjv) == TCL_ERROR) {
+				Tcl_AppendResult (interp, " while parsing list of columns", NULL);
+				tclReturn = TCL_ERROR;
+			} else {
+				tclReturn = casstcl_load_set_columns (&ls, columnObjc, columnObjv);
+			}
+		} else {
+			Tcl_WideInt lineNumber = 0;
+			char msg[60];
+
+			status = casstcl_load_read_record (&ls, &lineNumber, &tclReturn);
+			sprintf (msg, "%" TCL_LL_MODIFIER "d", (Tcl_WideInt)lineNumber);
+			if (status < 0) {
+				Tcl_AppendResult (interp, " in header on line ", msg, NULL);
+				tclReturn = TCL_ERROR;
+			} else if (status > 0) {
+				Tcl_Obj **headerObjs = ls.fieldObjs;
+				int i;
+
+				for (i = 0; i < ls.nFields; i++) {
+					if (headerObjs[i] == NULL) {
+						Tcl_ResetResult (interp);
+						Tcl_AppendResult (interp, "empty column name in header on line ", msg, NULL);
+						tclReturn = TCL_ERROR;
+						break;
+					}
+				}
+
+				if (tclReturn == TCL_OK) {
+					tclReturn = casstcl_load_set_columns (&ls, ls.nFields, headerObjs);
+				}
+			}
+		}
+	}
+
+	while (tclReturn == TCL_OK && status != 0) {
+		CassStatement *statement = NULL;
+		Tcl_WideInt lineNumber = 0;
+
+		status = casstcl_load_read_record (&ls, &lineNumber, &tclReturn);
+		if (status == 0) {
+			break;
+		}
+
+		if (status > 0) {
+			if (format == CASSTCL_LOAD_FORMAT_DICTLINES) {
+				if (casstcl_make_upsert_statement (ct, tableName, ls.lineObj, consistencyPtr, &statement, NULL, 0, ifNotExists) == TCL_ERROR) {
+					status = -1;
+				}
+			} else if (casstcl_load_bind_fields (&ls, &statement) == TCL_ERROR) {
+				status = -1;
+			}
+		}
+
+		if (status > 0) {
+			casstcl_load_submit (&ls, statement, lineNumber);
+		} else {
+			casstcl_load_note_error (&ls, lineNumber);
+		}
+
+		if (maxErrors >= 0 && ls.errors > maxErrors) {
+			break;
+		}
+	}
+
+	// the writes still in flight are waited for even when giving up,
+	// so that none of them outlive the load
+	while (ls.windowCount > 0) {
+		casstcl_load_reap (&ls);
+	}
+
+	Tcl_GetTime (&endTime);
+
+	if (tclReturn == TCL_OK && maxErrors >= 0 && ls.errors > maxErrors) {
+		Tcl_Obj *messageObj = NULL;
+
+		Tcl_ListObjIndex (NULL, ls.errorListObj, 1, &messageObj);
+		Tcl_ResetResult (interp);
+		Tcl_SetObjResult (interp, Tcl_ObjPrintf ("load into table '%s' stopped after %" TCL_LL_MODIFIER "d errors with %" TCL_LL_MODIFIER "d rows written, the first being: %s", tableName, (Tcl_WideInt)ls.errors, (Tcl_WideInt)ls.rows, (messageObj == NULL) ? "" : Tcl_GetString (messageObj)));
+		tclReturn = TCL_ERROR;
+	}
+
+	if (tclReturn == TCL_OK) {
+		double seconds = (endTime.sec - startTime.sec) + (endTime.usec - startTime.usec) / 1000000.0;
+		Tcl_Obj *listObj = Tcl_NewObj ();
+
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ("lines", -1));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewWideIntObj (ls.lineNumber));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ("rows", -1));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewWideIntObj (ls.rows));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ("errors", -1));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewWideIntObj (ls.errors));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ("seconds", -1));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewDoubleObj (seconds));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ("rows_per_second", -1));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewDoubleObj ((seconds > 0) ? ls.rows / seconds : 0.0));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ("first_errors", -1));
+		Tcl_ListObjAppendElement (NULL, listObj, ls.errorListObj);
+		Tcl_SetObjResult (interp, listObj);
+	}
+
+	casstcl_load_free (&ls);
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_from_objv -- parse the arguments of the load
+ *   method of a cassandra object and do the load
+ *
+ *   $cass load -table ks.table -channel chan ?-format csv|tsv|dictlines?
+ *       ?-columns list? ?-window n? ?-maxerrors n? ?-consistency level?
+ *       ?-ifnotexists?
+ *
+ *   objv[0] is the first of the options.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_load_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[])
+{
+	Tcl_Interp *interp = ct->interp;
+	char *tableName = NULL;
+	Tcl_Channel channel = NULL;
+	int format = CASSTCL_LOAD_FORMAT_CSV;
+	Tcl_Obj *columnsObj = NULL;
+	int windowSize = CASSTCL_LOAD_DEFAULT_WINDOW;
+	int maxErrors = -1;
+	CassConsistency consistency;
+	CassConsistency *consistencyPtr = NULL;
+	int ifNotExists = 0;
+	int arg;
+
+	static CONST char *options[] = {
+		"-table",
+		"-channel",
+		"-format",
+		"-columns",
+		"-window",
+		"-maxerrors",
+		"-consistency",
+		"-ifnotexists",
+		NULL
+	};
+
+	enum options {
+		OPT_TABLE,
+		OPT_CHANNEL,
+		OPT_FORMAT,
+		OPT_COLUMNS,
+		OPT_WINDOW,
+		OPT_MAXERRORS,
+		OPT_CONSISTENCY,
+		OPT_IFNOTEXISTS
+	};
+
+	static CONST char *formats[] = {
+		"csv",
+		"tsv",
+		"dictlines",
+		NULL
+	};
+
+	for (arg = 0; arg < objc; arg++) {
+		int optIndex;
+		int mode;
+
+		if (Tcl_GetIndexFromObj (interp, objv[arg], options, "option", TCL_EXACT, &optIndex) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		if ((enum options) optIndex == OPT_IFNOTEXISTS) {
+			ifNotExists = 1;
+			continue;
+		}
+
+		if (arg + 1 == objc) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "value for \"", Tcl_GetString (objv[arg]), "\" missing", NULL);
+			return TCL_ERROR;
+		}
+		arg++;
+
+		switch ((enum options) optIndex) {
+			case OPT_TABLE:
+				tableName = Tcl_GetString (objv[arg]);
+				break;
+
+			case OPT_CHANNEL:
+				channel = Tcl_GetChannel (interp, Tcl_GetString (objv[arg]), &mode);
+				if (channel == NULL) {
+					return TCL_ERROR;
+				}
+
+				if (!(mode & TCL_READABLE)) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "channel \"", Tcl_GetString (objv[arg]), "\" wasn't opened for reading", NULL);
+					return TCL_ERROR;
+				}
+				break;
+
+			case OPT_FORMAT:
+				if (Tcl_GetIndexFromObj (interp, objv[arg], formats, "format", TCL_EXACT, &format) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				break;
+
+			case OPT_COLUMNS:
+				columnsObj = objv[arg];
+				break;
+
+			case OPT_WINDOW:
+				if (Tcl_GetIntFromObj (interp, objv[arg], &windowSize) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting window element", NULL);
+					return TCL_ERROR;
+				}
+
+				if (windowSize < 1) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "load window must be at least 1", NULL);
+					return TCL_ERROR;
+				}
+				break;
+
+			case OPT_MAXERRORS:
+				if (Tcl_GetIntFromObj (interp, objv[arg], &maxErrors) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting maxerrors element", NULL);
+					return TCL_ERROR;
+				}
+				break;
+
+			case OPT_CONSISTENCY:
+				if (casstcl_obj_to_cass_consistency (ct, objv[arg], &consistency) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				consistencyPtr = &consistency;
+				break;
+
+			case OPT_IFNOTEXISTS:
+				break;
+		}
+	}
+
+	if (tableName == NULL || channel == NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "-table and -channel must be given", NULL);
+		return TCL_ERROR;
+	}
+
+	return casstcl_load (ct, channel, tableName, format, columnsObj, ifNotExists, consistencyPtr, windowSize, maxErrors);
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,65 @@
+/*
+ *
+ * Include file for casstcl_load
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load -- load the rows read from a channel into a table
+ *
+ *   Each record read is made into an insert, which is handed to the
+ *   driver without waiting for it, up to a window of writes in
+ *   flight; when the window is full the oldest write is waited for
+ *   before the next goes out.  Rows that can't be parsed, bound or
+ *   written are counted and loading carries on, unless there are
+ *   more than maxErrors of them (when it is not negative).
+ *
+ *   columnsObj gives the columns of csv and tsv rows, in order.  If
+ *   it is NULL the first record is read as the names of the columns.
+ *   dictlines rows are lists of column names and values, each being
+ *   upserted as with exec -upsert.
+ *
+ * Results:
+ *      A standard Tcl result.  On success the interpreter result is
+ *      a list of key-value pairs: lines, the number of lines read,
+ *      rows, the number of rows written, errors, the number of rows
+ *      that couldn't be, seconds, rows_per_second, and first_errors,
+ *      a list of the line and message of up to the first
+ *      CASSTCL_LOAD_ERRORS_KEPT errors.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_load (casstcl_sessionClientData *ct, Tcl_Channel channel, char *tableName, int format, Tcl_Obj *columnsObj, int ifNotExists, CassConsistency *consistencyPtr, int windowSize, int maxErrors);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_load_from_objv -- parse the arguments of the load
+ *   method of a cassandra object and do the load
+ *
+ *   $cass load -table ks.table -channel chan ?-format csv|tsv|dictlines?
+ *       ?-columns list? ?-window n? ?-maxerrors n? ?-consistency level?
+ *       ?-ifnotexists?
+ *
+ *   objv[0] is the first of the options.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_load_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[]);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -10,6 +10,53 @@
 
 #include "casstcl.h"
 #include "casstcl_log.h"
+#include "casstcl_cassandra.h"
+
+#include <stdint.h>
+
+/*
+ * The ring of log messages.  Any of the driver's threads may put a message
+ * in it, without a lock: a thread claims the slot at enqueuePosition by
+ * advancing it, copies the message in and then sets the slot's sequence
+ * to say it is full.  Only the Tcl thread takes messages out.  The
+ * sequence of a slot at position p is p when it is free for a message at
+ * that position and p + 1 when it holds one.
+ */
+typedef struct casstcl_logSlot {
+	unsigned long sequence;
+	CassLogMessage message;
+} casstcl_logSlot;
+
+static casstcl_logSlot casstcl_logRing[CASSTCL_LOG_RING_SIZE];
+static unsigned long casstcl_logEnqueuePosition = 0;
+static unsigned long casstcl_logDequeuePosition = 0;
+static int casstcl_logRingReady = 0;
+static int casstcl_logDrainQueued = 0;
+static int casstcl_logDraining = 0;
+static int casstcl_logOverflows = 0;
+
+/*
+ * Each log level may be limited to so many messages a second, counted
+ * in windows of one whole second of the messages' clocks.  Zero means
+ * no limit.
+ */
+typedef struct casstcl_logRateLimit {
+	int limit;
+	Tcl_WideInt window;
+	int count;
+	int dropped;
+} casstcl_logRateLimit;
+
+static casstcl_logRateLimit casstcl_logRateLimits[CASS_LOG_LAST_ENTRY];
+
+/*
+ * When messages are taken out of the ring, repeats of the same message
+ * are collapsed into the first of them, with a count.
+ */
+typedef struct casstcl_logEntry {
+	CassLogMessage message;
+	int count;
+} casstcl_logEntry;
 
 /*
  *--------------------------------------------------------------
@@ -143,4 +190,395 @@ casstcl_cass_log_level_to_string (CassLogLevel severity) {
 	}
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_log_ring_init -- set up the ring of log messages
+ *
+ *   This is done once, the first time a logging callback is set,
+ *   before the driver is told to call casstcl_logging_callback.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_log_ring_init (void)
+{
+	unsigned long i;
+
+	if (casstcl_logRingReady) {
+		return;
+	}
+
+	for (i = 0; i < CASSTCL_LOG_RING_SIZE; i++) {
+		casstcl_logRing[i].sequence = i;
+	}
+	casstcl_logRingReady = 1;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_log_rate_limited -- see if a message is over the rate
+ *   limit of its level
+ *
+ *   This is called from the driver's threads.  The window and
+ *   count are updated without a lock, so a few messages more than
+ *   the limit may get through when the window changes.
+ *
+ * Results:
+ *      1 if the message should be dropped, else 0.
+ *
+ * Side effects:
+ *      Dropped messages are counted.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_log_rate_limited (const CassLogMessage *message)
+{
+	casstcl_logRateLimit *rate;
+	Tcl_WideInt window;
+	Tcl_WideInt lastWindow;
+	int limit;
+
+	if ((int)message->severity < 0 || message->severity >= CASS_LOG_LAST_ENTRY) {
+		return 0;
+	}
+
+	rate = &casstcl_logRateLimits[message->severity];
+	limit = __atomic_load_n (&rate->limit, __ATOMIC_RELAXED);
+	if (limit <= 0) {
+		return 0;
+	}
+
+	window = (Tcl_WideInt)(message->time_ms / 1000);
+	lastWindow = __atomic_load_n (&rate->window, __ATOMIC_RELAXED);
+	if (window != lastWindow && __atomic_compare_exchange_n (&rate->window, &lastWindow, window, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+		__atomic_store_n (&rate->count, 0, __ATOMIC_RELAXED);
+	}
+
+	if (__atomic_add_fetch (&rate->count, 1, __ATOMIC_RELAXED) <= limit) {
+		return 0;
+	}
+
+	__atomic_add_fetch (&rate->dropped, 1, __ATOMIC_RELAXED);
+	return 1;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_log_enqueue -- put a message from the driver in the
+ *   ring
+ *
+ *   This is called from the driver's threads.  Messages over
+ *   their level's rate limit, and messages that don't fit because
+ *   the ring is full, are counted and dropped.
+ *
+ * Results:
+ *      1 if nothing was waiting to drain the ring, so that the
+ *      caller should queue an event to do it, else 0.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_log_enqueue (const CassLogMessage *message)
+{
+	unsigned long position;
+	casstcl_logSlot *slot;
+
+	// the drain reports how many were dropped
+	if (casstcl_log_rate_limited (message)) {
+		return (__atomic_exchange_n (&casstcl_logDrainQueued, 1, __ATOMIC_ACQ_REL) == 0);
+	}
+
+	position = __atomic_load_n (&casstcl_logEnqueuePosition, __ATOMIC_RELAXED);
+	for (;;) {
+		long difference;
+
+		slot = &casstcl_logRing[position & (CASSTCL_LOG_RING_SIZE - 1)];
+		difference = (long)(__atomic_load_n (&slot->sequence, __ATOMIC_ACQUIRE) - position);
+
+		if (difference == 0) {
+			// the slot is free; claim it if nobody else has
+			if (__atomic_compare_exchange_n (&casstcl_logEnqueuePosition, &position, position + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if (difference < 0) {
+			// the slot still holds the message from a lap ago
+			__atomic_add_fetch (&casstcl_logOverflows, 1, __ATOMIC_RELAXED);
+			return (__atomic_exchange_n (&casstcl_logDrainQueued, 1, __ATOMIC_ACQ_REL) == 0);
+		} else {
+			position = __atomic_load_n (&casstcl_logEnqueuePosition, __ATOMIC_RELAXED);
+		}
+	}
+
+	slot->message = *message; /* structure copy */
+	__atomic_store_n (&slot->sequence, position + 1, __ATOMIC_RELEASE);
+
+	return (__atomic_exchange_n (&casstcl_logDrainQueued, 1, __ATOMIC_ACQ_REL) == 0);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_log_message_obj -- make the list of key-value pairs
+ *   a logging callback gets for a message
+ *
+ * Results:
+ *      A new list object.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static Tcl_Obj *
+casstcl_log_message_obj (casstcl_logEntry *entry)
+{
+	CassLogMessage *message = &entry->message;
+	Tcl_Obj *listObjv[14];
+
+	listObjv[0] = Tcl_NewStringObj ("clock", -1);
+	listObjv[1] = Tcl_NewDoubleObj (message->time_ms / 1000.0);
+
+	listObjv[2] = Tcl_NewStringObj ("severity", -1);
+	listObjv[3] = Tcl_NewStringObj (casstcl_cass_log_level_to_string (message->severity), -1);
+
+	listObjv[4] = Tcl_NewStringObj ("file", -1);
+	listObjv[5] = Tcl_NewStringObj ((message->file != NULL) ? message->file : "", -1);
+
+	listObjv[6] = Tcl_NewStringObj ("line", -1);
+	listObjv[7] = Tcl_NewIntObj (message->line);
+
+	listObjv[8] = Tcl_NewStringObj ("function", -1);
+	listObjv[9] = Tcl_NewStringObj ((message->function != NULL) ? message->function : "", -1);
+
+	listObjv[10] = Tcl_NewStringObj ("message", -1);
+	listObjv[11] = Tcl_NewStringObj (message->message, strnlen (message->message, CASS_LOG_MAX_MESSAGE_SIZE));
+
+	listObjv[12] = Tcl_NewStringObj ("count", -1);
+	listObjv[13] = Tcl_NewIntObj (entry->count);
+
+	return Tcl_NewListObj (14, listObjv);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_log_add_entry -- add a message taken out of the ring
+ *   to a batch, or count it against the same message already
+ *   in the batch
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      *nEntriesPtr is incremented if a new entry is made.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_log_add_entry (Tcl_HashTable *entryHash, casstcl_logEntry *entries, int *nEntriesPtr, const CassLogMessage *message, int count)
+{
+	Tcl_HashEntry *hashEntry;
+	Tcl_DString key;
+	char prefix[40];
+	int new;
+
+	snprintf (prefix, sizeof (prefix), "%d:%d:", (int)message->severity, message->line);
+	Tcl_DStringInit (&key);
+	Tcl_DStringAppend (&key, prefix, -1);
+	Tcl_DStringAppend (&key, (message->file != NULL) ? message->file : "", -1);
+	Tcl_DStringAppend (&key, ":", 1);
+	Tcl_DStringAppend (&key, message->message, strnlen (message->message, CASS_LOG_MAX_MESSAGE_SIZE));
+
+	hashEntry = Tcl_CreateHashEntry (entryHash, Tcl_DStringValue (&key), &new);
+	Tcl_DStringFree (&key);
+
+	if (!new) {
+		entries[(int)(intptr_t)Tcl_GetHashValue (hashEntry)].count += count;
+		return;
+	}
+
+	Tcl_SetHashValue (hashEntry, (ClientData)(intptr_t)*nEntriesPtr);
+	entries[*nEntriesPtr].message = *message; /* structure copy */
+	entries[*nEntriesPtr].count = count;
+	(*nEntriesPtr)++;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_log_add_dropped -- add an entry to a batch for
+ *   messages that were dropped
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      *nEntriesPtr is incremented if a new entry is made.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_log_add_dropped (Tcl_HashTable *entryHash, casstcl_logEntry *entries, int *nEntriesPtr, CassLogLevel severity, const char *text, int count)
+{
+	CassLogMessage message;
+	Tcl_Time now;
+
+	Tcl_GetTime (&now);
+	memset (&message, 0, sizeof (message));
+	message.time_ms = (cass_uint64_t)now.sec * 1000 + now.usec / 1000;
+	message.severity = severity;
+	message.file = "";
+	message.function = "";
+	snprintf (message.message, sizeof (message.message), "%s", text);
+
+	casstcl_log_add_entry (entryHash, entries, nEntriesPtr, &message, count);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_log_drain -- take the messages out of the ring and
+ *   hand them to the logging callback
+ *
+ *   Repeats of a message among those taken out at once are
+ *   collapsed into the first, whose count says how many times it
+ *   was logged.  Messages dropped since the last drain, for being
+ *   over a rate limit or for not fitting in the ring, are reported
+ *   as one message for each level, with the number dropped as
+ *   its count.
+ *
+ *   If the callback was set with -list it is invoked once with a
+ *   list of the messages; otherwise it is invoked for each one.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      Errors in the callback are reported as background errors.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_log_drain (Tcl_Interp *interp)
+{
+	// a callback that enters the event loop may find another drain
+	// event; the messages it is for are picked up when we loop
+	if (casstcl_logDraining) {
+		return;
+	}
+	casstcl_logDraining = 1;
+
+	// messages put in the ring from now on need another event
+	__atomic_store_n (&casstcl_logDrainQueued, 0, __ATOMIC_RELEASE);
+
+	for (;;) {
+		casstcl_logEntry *entries;
+		Tcl_HashTable entryHash;
+		int nEntries = 0;
+		int nMessages = 0;
+		int dropped;
+		int level;
+		int i;
+
+		entries = (casstcl_logEntry *)ckalloc (sizeof (casstcl_logEntry) * (CASSTCL_LOG_RING_SIZE + CASS_LOG_LAST_ENTRY + 1));
+		Tcl_InitHashTable (&entryHash, TCL_STRING_KEYS);
+
+		while (nMessages < CASSTCL_LOG_RING_SIZE) {
+			unsigned long position = casstcl_logDequeuePosition;
+			casstcl_logSlot *slot = &casstcl_logRing[position & (CASSTCL_LOG_RING_SIZE - 1)];
+
+			if (__atomic_load_n (&slot->sequence, __ATOMIC_ACQUIRE) != position + 1) {
+				break;
+			}
+
+			casstcl_log_add_entry (&entryHash, entries, &nEntries, &slot->message, 1);
+			__atomic_store_n (&slot->sequence, position + CASSTCL_LOG_RING_SIZE, __ATOMIC_RELEASE);
+			casstcl_logDequeuePosition = position + 1;
+			nMessages++;
+		}
+
+		for (level = 0; level < CASS_LOG_LAST_ENTRY; level++) {
+			dropped = __atomic_exchange_n (&casstcl_logRateLimits[level].dropped, 0, __ATOMIC_ACQ_REL);
+			if (dropped > 0) {
+				casstcl_log_add_dropped (&entryHash, entries, &nEntries, (CassLogLevel)level, "casstcl dropped messages over the rate limit for this level", dropped);
+			}
+		}
+
+		dropped = __atomic_exchange_n (&casstcl_logOverflows, 0, __ATOMIC_ACQ_REL);
+		if (dropped > 0) {
+			casstcl_log_add_dropped (&entryHash, entries, &nEntries, CASS_LOG_WARN, "casstcl dropped messages because its log buffer was full", dropped);
+		}
+
+		Tcl_DeleteHashTable (&entryHash);
+
+		if (nEntries > 0 && casstcl_loggingCallbackObj != NULL) {
+			if (casstcl_loggingCallbackList) {
+				Tcl_Obj *listObj = Tcl_NewObj ();
+
+				for (i = 0; i < nEntries; i++) {
+					Tcl_ListObjAppendElement (NULL, listObj, casstcl_log_message_obj (&entries[i]));
+				}
+				casstcl_invoke_callback_with_argument (interp, casstcl_loggingCallbackObj, listObj);
+			} else {
+				for (i = 0; i < nEntries && casstcl_loggingCallbackObj != NULL; i++) {
+					casstcl_invoke_callback_with_argument (interp, casstcl_loggingCallbackObj, casstcl_log_message_obj (&entries[i]));
+				}
+			}
+		}
+
+		ckfree ((char *)entries);
+
+		// stop once the ring is empty; more may have come in while the
+		// callback ran, and their event will have found us draining
+		if (nEntries == 0) {
+			break;
+		}
+		__atomic_store_n (&casstcl_logDrainQueued, 0, __ATOMIC_RELEASE);
+	}
+
+	casstcl_logDraining = 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_log_rate_limit -- get or set the number of messages
+ *   a second that are delivered for a log level
+ *
+ *   If limit is negative the limit is left as it is.  Zero means
+ *   no limit.
+ *
+ * Results:
+ *      The limit before it was changed.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_log_rate_limit (CassLogLevel level, int limit)
+{
+	int oldLimit = __atomic_load_n (&casstcl_logRateLimits[level].limit, __ATOMIC_RELAXED);
+
+	if (limit >= 0) {
+		__atomic_store_n (&casstcl_logRateLimits[level].limit, limit, __ATOMIC_RELAXED);
+	}
+
+	return oldLimit;
+}
+
 /* vim: set ts=4 sw=4 sts=4 noet : */
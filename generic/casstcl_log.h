@@ -46,5 +46,89 @@ int casstcl_obj_to_cass_log_level (Tcl_Interp *interp, Tcl_Obj *tclObj, CassLogL
  */
 const char * casstcl_cass_log_level_to_string (CassLogLevel severity);
 
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_log_ring_init -- set up the ring of log messages
+ *
+ *   This is done once, the first time a logging callback is set,
+ *   before the driver is told to call casstcl_logging_callback.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_log_ring_init (void);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_log_enqueue -- put a message from the driver in the
+ *   ring
+ *
+ *   This is called from the driver's threads.  Messages over
+ *   their level's rate limit, and messages that don't fit because
+ *   the ring is full, are counted and dropped.
+ *
+ * Results:
+ *      1 if nothing was waiting to drain the ring, so that the
+ *      caller should queue an event to do it, else 0.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_log_enqueue (const CassLogMessage *message);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_log_drain -- take the messages out of the ring and
+ *   hand them to the logging callback
+ *
+ *   Repeats of a message among those taken out at once are
+ *   collapsed into the first, whose count says how many times it
+ *   was logged.  Messages dropped since the last drain, for being
+ *   over a rate limit or for not fitting in the ring, are reported
+ *   as one message for each level, with the number dropped as
+ *   its count.
+ *
+ *   If the callback was set with -list it is invoked once with a
+ *   list of the messages; otherwise it is invoked for each one.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      Errors in the callback are reported as background errors.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_log_drain (Tcl_Interp *interp);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_log_rate_limit -- get or set the number of messages
+ *   a second that are delivered for a log level
+ *
+ *   If limit is negative the limit is left as it is.  Zero means
+ *   no limit.
+ *
+ * Results:
+ *      The limit before it was changed.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_log_rate_limit (CassLogLevel level, int limit);
+
 /* vim: set ts=4 sw=4 sts=4 noet : */
 
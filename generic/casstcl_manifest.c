@@ -0,0 +1,511 @@
+/*
+ * casstcl_manifest - Functions for preparing a manifest of statements
+ *                    while connecting, so that they are ready by the time
+ *                    the first requests are made
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_manifest.h"
+#include "casstcl_cassandra.h"
+#include "casstcl_error.h"
+#include "casstcl_future.h"
+#include "casstcl_prepared.h"
+#include "casstcl_shared.h"
+
+#include <assert.h>
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_init -- set up the table of manifest
+ *   statements of a session
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_manifest_init (casstcl_sessionClientData *ct)
+{
+	ct->connectManifest = NULL;
+	Tcl_InitHashTable (&ct->manifestHash, TCL_STRING_KEYS);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_new -- parse the manifest given to
+ *   connect -prepare, a list of name, table and statement
+ *   triples like the arguments of the prepare method
+ *
+ * Results:
+ *      The new manifest, or NULL with an error in the interpreter
+ *      result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_manifest *
+casstcl_manifest_new (casstcl_sessionClientData *ct, Tcl_Obj *manifestObj)
+{
+	Tcl_Interp *interp = ct->interp;
+	casstcl_manifest *manifest;
+	Tcl_Obj **listObjv;
+	int listObjc;
+	int i;
+
+	if (Tcl_ListObjGetElements (interp, manifestObj, &listObjc, &listObjv) == TCL_ERROR) {
+		Tcl_AppendResult (interp, " while parsing the manifest of statements to prepare", NULL);
+		return NULL;
+	}
+
+	if (listObjc % 3 != 0) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "the manifest of statements to prepare must be a list of name, table and statement triples", NULL);
+		return NULL;
+	}
+
+	manifest = (casstcl_manifest *)ckalloc (sizeof (casstcl_manifest));
+	manifest->ct = ct;
+	manifest->fcd = NULL;
+	manifest->count = listObjc / 3;
+	manifest->started = 0;
+	manifest->pending = 0;
+	manifest->statements = (casstcl_manifestStatement *)ckalloc (sizeof (casstcl_manifestStatement) * (manifest->count + 1));
+
+	for (i = 0; i < manifest->count; i++) {
+		casstcl_manifestStatement *statement = &manifest->statements[i];
+
+		statement->nameObj = listObjv[i * 3];
+		statement->tableObj = listObjv[i * 3 + 1];
+		statement->statementObj = listObjv[i * 3 + 2];
+		statement->future = NULL;
+		Tcl_IncrRefCount (statement->nameObj);
+		Tcl_IncrRefCount (statement->tableObj);
+		Tcl_IncrRefCount (statement->statementObj);
+	}
+
+	return manifest;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_free -- free a manifest and the futures of
+ *   any of its statements that are still being prepared
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_manifest_free (casstcl_manifest *manifest)
+{
+	int i;
+
+	for (i = 0; i < manifest->count; i++) {
+		casstcl_manifestStatement *statement = &manifest->statements[i];
+
+		if (statement->future != NULL) {
+			cass_future_free (statement->future);
+		}
+		Tcl_DecrRefCount (statement->nameObj);
+		Tcl_DecrRefCount (statement->tableObj);
+		Tcl_DecrRefCount (statement->statementObj);
+	}
+
+	ckfree ((char *)manifest->statements);
+	ckfree ((char *)manifest);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_prepared -- driver callback for a statement of
+ *   the manifest of a connect -callback having been prepared
+ *
+ *   The last one to be prepared completes the connect future once
+ *   more by hand, so that Tcl gets round to its callback.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_manifest_prepared (CassFuture *future, void *data)
+{
+	casstcl_manifest *manifest = (casstcl_manifest *)data;
+	casstcl_sessionClientData *ct = manifest->ct;
+
+	if (__atomic_sub_fetch (&manifest->pending, 1, __ATOMIC_ACQ_REL) == 0) {
+		casstcl_callback_started (ct);
+		casstcl_future_callback (manifest->fcd->future, manifest->fcd);
+	}
+
+	casstcl_callback_finished (ct);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_prepare -- send all of the statements of a
+ *   manifest to be prepared at once, and import the schema while
+ *   the cluster is preparing them
+ *
+ *   For a connect with -callback, the driver calls back as each
+ *   is prepared; see casstcl_manifest_prepared.
+ *
+ * Results:
+ *      For a connect with -callback, 1 if every statement has
+ *      already been prepared, else 0.  0 otherwise.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_manifest_prepare (casstcl_manifest *manifest)
+{
+	casstcl_sessionClientData *ct = manifest->ct;
+	int i;
+
+	manifest->started = 1;
+	manifest->pending = manifest->count + 1;
+
+	for (i = 0; i < manifest->count; i++) {
+		casstcl_manifestStatement *statement = &manifest->statements[i];
+
+		statement->future = cass_session_prepare (ct->session, Tcl_GetString (statement->statementObj));
+		if (manifest->fcd != NULL) {
+			casstcl_callback_started (ct);
+			cass_future_set_callback (statement->future, casstcl_manifest_prepared, manifest);
+		}
+	}
+
+	// import the schema keyspaces, tables, columns and types
+	casstcl_reimport_column_type_map (ct);
+
+	return (manifest->fcd != NULL) && (__atomic_sub_fetch (&manifest->pending, 1, __ATOMIC_ACQ_REL) == 0);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_finish -- make prepared objects of the
+ *   statements of a manifest, waiting for any that are still
+ *   being prepared, and file them under their names
+ *
+ *   A statement that couldn't be prepared is filed with its
+ *   error instead; the others are prepared regardless.
+ *
+ * Results:
+ *      A standard Tcl result; the error is that of the first
+ *      statement that couldn't be prepared.
+ *
+ * Side effects:
+ *      Replaces the statements of earlier manifests with the same
+ *      names, without deleting their prepared objects.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_manifest_finish (casstcl_manifest *manifest)
+{
+	casstcl_sessionClientData *ct = manifest->ct;
+	Tcl_Interp *interp = ct->interp;
+	Tcl_Obj *firstErrorObj = NULL;
+	int i;
+
+	for (i = 0; i < manifest->count; i++) {
+		casstcl_manifestStatement *statement = &manifest->statements[i];
+		casstcl_manifestEntry *entry;
+		Tcl_HashEntry *hashEntry;
+		int new;
+
+		CassError rc = cass_future_error_code (statement->future);
+
+		hashEntry = Tcl_CreateHashEntry (&ct->manifestHash, Tcl_GetString (statement->nameObj), &new);
+		if (new) {
+			entry = (casstcl_manifestEntry *)ckalloc (sizeof (casstcl_manifestEntry));
+			Tcl_SetHashValue (hashEntry, entry);
+		} else {
+			entry = (casstcl_manifestEntry *)Tcl_GetHashValue (hashEntry);
+			if (entry->commandObj != NULL) {
+				Tcl_DecrRefCount (entry->commandObj);
+			}
+			if (entry->errorObj != NULL) {
+				Tcl_DecrRefCount (entry->errorObj);
+			}
+		}
+		entry->commandObj = NULL;
+		entry->errorObj = NULL;
+
+		if (rc == CASS_OK) {
+			const CassPrepared *cassPrepared = cass_future_get_prepared (statement->future);
+
+			casstcl_createPreparedObjectCommand (ct, "#auto", statement->tableObj, statement->statementObj, cassPrepared);
+			entry->commandObj = Tcl_GetObjResult (interp);
+			Tcl_IncrRefCount (entry->commandObj);
+		} else {
+			casstcl_future_error_to_tcl (ct, rc, statement->future);
+			Tcl_AppendResult (interp, " while attempting to prepare statement '", Tcl_GetString (statement->nameObj), "'", NULL);
+			entry->errorObj = Tcl_GetObjResult (interp);
+			Tcl_IncrRefCount (entry->errorObj);
+			if (firstErrorObj == NULL) {
+				firstErrorObj = entry->errorObj;
+				Tcl_IncrRefCount (firstErrorObj);
+			}
+		}
+
+		cass_future_free (statement->future);
+		statement->future = NULL;
+	}
+
+	if (firstErrorObj != NULL) {
+		Tcl_SetObjResult (interp, firstErrorObj);
+		Tcl_DecrRefCount (firstErrorObj);
+		return TCL_ERROR;
+	}
+
+	Tcl_ResetResult (interp);
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_connect -- prepare the statements of a
+ *   manifest on a session that has just connected, waiting for
+ *   them all
+ *
+ * Results:
+ *      A standard Tcl result, as for casstcl_manifest_finish.
+ *
+ * Side effects:
+ *      The manifest is freed.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_manifest_connect (casstcl_manifest *manifest)
+{
+	int tclReturn;
+
+	casstcl_manifest_prepare (manifest);
+	tclReturn = casstcl_manifest_finish (manifest);
+	casstcl_manifest_free (manifest);
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_connect_async -- arrange for the statements of
+ *   a manifest to be prepared once the future of a
+ *   connect -callback completes, before its callback is run
+ *
+ *   Only one connect -callback -prepare can be under way at a
+ *   time, which is for the caller to check.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      Takes over the manifest.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_manifest_connect_async (casstcl_manifest *manifest, casstcl_futureClientData *fcd)
+{
+	casstcl_sessionClientData *ct = manifest->ct;
+
+	assert (ct->connectManifest == NULL);
+
+	manifest->fcd = fcd;
+	ct->connectManifest = manifest;
+	fcd->flags |= CASSTCL_FUTURE_MANIFEST_FLAG;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_connected -- called by
+ *   casstcl_future_run_callback for the future of a
+ *   connect -callback -prepare, before running its callback
+ *
+ *   The first time, once connected, the statements are sent to
+ *   be prepared; the future is completed again when they all
+ *   have been, and this time prepared objects are made of them.
+ *   An error preparing one is left for the prepared method to
+ *   return.
+ *
+ * Results:
+ *      1 if the callback is to be run now, 0 if it must wait.
+ *
+ * Side effects:
+ *      The manifest is freed once its statements are prepared.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_manifest_connected (casstcl_futureClientData *fcd)
+{
+	casstcl_sessionClientData *ct = fcd->ct;
+	casstcl_manifest *manifest = ct->connectManifest;
+
+	assert (manifest != NULL && manifest->fcd == fcd);
+
+	if (!manifest->started && cass_future_error_code (fcd->future) == CASS_OK) {
+		if (!casstcl_manifest_prepare (manifest)) {
+			return 0;
+		}
+	}
+
+	if (manifest->started) {
+		casstcl_manifest_finish (manifest);
+		Tcl_ResetResult (ct->interp);
+	}
+
+	casstcl_manifest_free (manifest);
+	ct->connectManifest = NULL;
+	fcd->flags &= ~CASSTCL_FUTURE_MANIFEST_FLAG;
+	return 1;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_lookup -- find the prepared object made of the
+ *   statement of a connect manifest with a given name
+ *
+ * Results:
+ *      A standard Tcl result; the interpreter result is the name
+ *      of the prepared object, or the error preparing it.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_manifest_lookup (casstcl_sessionClientData *ct, Tcl_Obj *nameObj)
+{
+	Tcl_Interp *interp = ct->interp;
+	Tcl_HashEntry *hashEntry = Tcl_FindHashEntry (&ct->manifestHash, Tcl_GetString (nameObj));
+	casstcl_manifestEntry *entry;
+
+	if (hashEntry == NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "no statement named '", Tcl_GetString (nameObj), "' was prepared at connect", NULL);
+		return TCL_ERROR;
+	}
+
+	entry = (casstcl_manifestEntry *)Tcl_GetHashValue (hashEntry);
+	if (entry->errorObj != NULL) {
+		Tcl_SetObjResult (interp, entry->errorObj);
+		return TCL_ERROR;
+	}
+
+	if (casstcl_prepared_command_to_preparedClientData (interp, Tcl_GetString (entry->commandObj)) == NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "the prepared object of statement '", Tcl_GetString (nameObj), "' has been deleted", NULL);
+		return TCL_ERROR;
+	}
+
+	Tcl_SetObjResult (interp, entry->commandObj);
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_names -- list the names of the statements
+ *   prepared at connect
+ *
+ * Results:
+ *      A new Tcl object.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *
+casstcl_manifest_names (casstcl_sessionClientData *ct)
+{
+	Tcl_Obj *listObj = Tcl_NewObj ();
+	Tcl_HashSearch search;
+	Tcl_HashEntry *hashEntry;
+
+	for (hashEntry = Tcl_FirstHashEntry (&ct->manifestHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj (Tcl_GetHashKey (&ct->manifestHash, hashEntry), -1));
+	}
+
+	return listObj;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_forget -- free the manifest of a connect still
+ *   under way and the table of manifest statements of a session
+ *   that is being deleted
+ *
+ *   The prepared objects themselves are left alone.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_manifest_forget (casstcl_sessionClientData *ct)
+{
+	Tcl_HashSearch search;
+	Tcl_HashEntry *hashEntry;
+
+	if (ct->connectManifest != NULL) {
+		casstcl_manifest_free (ct->connectManifest);
+		ct->connectManifest = NULL;
+	}
+
+	for (hashEntry = Tcl_FirstHashEntry (&ct->manifestHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+		casstcl_manifestEntry *entry = (casstcl_manifestEntry *)Tcl_GetHashValue (hashEntry);
+
+		if (entry->commandObj != NULL) {
+			Tcl_DecrRefCount (entry->commandObj);
+		}
+		if (entry->errorObj != NULL) {
+			Tcl_DecrRefCount (entry->errorObj);
+		}
+		ckfree ((char *)entry);
+	}
+	Tcl_DeleteHashTable (&ct->manifestHash);
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,173 @@
+/*
+ *
+ * Include file for casstcl_manifest
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_init -- set up the table of manifest
+ *   statements of a session
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_manifest_init (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_new -- parse the manifest given to
+ *   connect -prepare, a list of name, table and statement
+ *   triples like the arguments of the prepare method
+ *
+ * Results:
+ *      The new manifest, or NULL with an error in the interpreter
+ *      result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_manifest *casstcl_manifest_new (casstcl_sessionClientData *ct, Tcl_Obj *manifestObj);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_free -- free a manifest and the futures of
+ *   any of its statements that are still being prepared
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_manifest_free (casstcl_manifest *manifest);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_connect -- prepare the statements of a
+ *   manifest on a session that has just connected, waiting for
+ *   them all
+ *
+ * Results:
+ *      A standard Tcl result, as for casstcl_manifest_finish.
+ *
+ * Side effects:
+ *      The manifest is freed.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_manifest_connect (casstcl_manifest *manifest);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_connect_async -- arrange for the statements of
+ *   a manifest to be prepared once the future of a
+ *   connect -callback completes, before its callback is run
+ *
+ *   Only one connect -callback -prepare can be under way at a
+ *   time, which is for the caller to check.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      Takes over the manifest.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_manifest_connect_async (casstcl_manifest *manifest, casstcl_futureClientData *fcd);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_connected -- called by
+ *   casstcl_future_run_callback for the future of a
+ *   connect -callback -prepare, before running its callback
+ *
+ *   The first time, once connected, the statements are sent to
+ *   be prepared; the future is completed again when they all
+ *   have been, and this time prepared objects are made of them.
+ *   An error preparing one is left for the prepared method to
+ *   return.
+ *
+ * Results:
+ *      1 if the callback is to be run now, 0 if it must wait.
+ *
+ * Side effects:
+ *      The manifest is freed once its statements are prepared.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_manifest_connected (casstcl_futureClientData *fcd);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_lookup -- find the prepared object made of the
+ *   statement of a connect manifest with a given name
+ *
+ * Results:
+ *      A standard Tcl result; the interpreter result is the name
+ *      of the prepared object, or the error preparing it.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_manifest_lookup (casstcl_sessionClientData *ct, Tcl_Obj *nameObj);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_names -- list the names of the statements
+ *   prepared at connect
+ *
+ * Results:
+ *      A new Tcl object.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *casstcl_manifest_names (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_manifest_forget -- free the manifest of a connect still
+ *   under way and the table of manifest statements of a session
+ *   that is being deleted
+ *
+ *   The prepared objects themselves are left alone.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_manifest_forget (casstcl_sessionClientData *ct);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
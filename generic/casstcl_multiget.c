@@ -0,0 +1,522 @@
+/*
+ * casstcl_multiget - Functions for looking up many keys at once through
+ *                    a prepared statement
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_multiget.h"
+#include "casstcl_consistency.h"
+#include "casstcl_error.h"
+#include "casstcl_execution.h"
+#include "casstcl_future.h"
+#include "casstcl_prepared.h"
+#include "casstcl_result.h"
+
+/*
+ * Each stream of a multiget looks up one key at a time, with its own
+ * statement so that a key whose rows come in more than one page can be
+ * paged through.  A stream whose future is NULL has no more keys to do.
+ */
+typedef struct casstcl_multigetStream {
+	CassStatement *statement;
+	CassFuture *future;
+	int key;
+	Tcl_Obj *rowsObj;
+} casstcl_multigetStream;
+
+typedef struct casstcl_multigetState {
+	casstcl_sessionClientData *ct;
+	casstcl_preparedClientData *pcd;
+	CassConsistency *consistencyPtr;
+	int timeoutMS;
+	int nKeys;
+	Tcl_Obj **keyObjs;
+	int nextKey;
+	Tcl_Obj *errorsObj;
+	casstcl_futureWaiter *waiter;
+} casstcl_multigetState;
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_multiget_failed -- deal with the lookup of a key that
+ *   failed, with the error in the interpreter result
+ *
+ *   If the errors are being collected, the error is filed under
+ *   the key and the multiget carries on.  Otherwise the key is
+ *   added to the error, which ends the multiget.
+ *
+ * Results:
+ *      TCL_OK if the multiget should carry on, else TCL_ERROR.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_multiget_failed (casstcl_multigetState *ms, int key)
+{
+	Tcl_Interp *interp = ms->ct->interp;
+
+	if (ms->errorsObj == NULL) {
+		Tcl_AppendResult (interp, " while looking up key '", Tcl_GetString (ms->keyObjs[key]), "'", NULL);
+		return TCL_ERROR;
+	}
+
+	Tcl_DictObjPut (NULL, ms->errorsObj, ms->keyObjs[key], Tcl_GetObjResult (interp));
+	Tcl_ResetResult (interp);
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_multiget_start_key -- give a stream the next key of
+ *   the multiget and ask for its rows
+ *
+ *   With a statement of one parameter each key is the value to
+ *   bind to it, otherwise a list of the values of its parameters
+ *   in order.  A key that can't be bound fails without being
+ *   sent and the stream goes on to the key after it.
+ *
+ * Results:
+ *      A standard Tcl result.  If there are no keys left, the
+ *      stream's future is left NULL.
+ *
+ * Side effects:
+ *      Any statement the stream had for its last key is freed.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_multiget_start_key (casstcl_multigetState *ms, casstcl_multigetStream *stream)
+{
+	Tcl_Interp *interp = ms->ct->interp;
+
+	if (stream->statement != NULL) {
+		cass_statement_free (stream->statement);
+		stream->statement = NULL;
+	}
+	stream->future = NULL;
+
+	while (ms->nextKey < ms->nKeys) {
+		int key = ms->nextKey++;
+		Tcl_Obj **valueObjs = &ms->keyObjs[key];
+		int nValues = 1;
+		int tclReturn = TCL_OK;
+
+		if (ms->pcd->nParameters != 1) {
+			tclReturn = Tcl_ListObjGetElements (interp, ms->keyObjs[key], &nValues, &valueObjs);
+		}
+
+		if (tclReturn == TCL_OK) {
+			tclReturn = casstcl_bind_values_from_prepared (ms->pcd, nValues, valueObjs, ms->consistencyPtr, &stream->statement);
+		}
+
+		if (tclReturn == TCL_ERROR) {
+			if (casstcl_multiget_failed (ms, key) == TCL_ERROR) {
+				return TCL_ERROR;
+			}
+			continue;
+		}
+
+		// reads can always be retried or sent to another replica
+		casstcl_statement_set_execution (stream->statement, 1, ms->timeoutMS);
+
+		stream->key = key;
+		stream->future = cass_session_execute (ms->ct->session, stream->statement);
+		casstcl_future_waiter_watch (ms->waiter, stream->future);
+		return TCL_OK;
+	}
+
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_multiget -- look up many keys through a prepared
+ *   statement, up to concurrency of them at once
+ *
+ *   The rows of each key are collected, as dicts or, if rowStyle
+ *   is CASSTCL_ROWS_LIST, as lists.  As soon as a stream has all
+ *   of the rows of its key it starts on the next key not yet
+ *   begun.
+ *   The driver routes each lookup to a replica of its partition
+ *   when token aware routing is on, as the key's values make up
+ *   the routing key of a bound statement.
+ *
+ *   If errorsVarObj isn't NULL, keys whose lookup failed get no
+ *   rows and the variable is set to a dict of the keys and their
+ *   errors; otherwise the first key to fail ends the multiget with
+ *   an error.
+ *
+ * Results:
+ *      A standard Tcl result.  Once every key is done, the
+ *      interpreter result is a list of the rows of each key in the
+ *      order of the keys or, if arrayNameObj isn't NULL, the number
+ *      of keys with rows and the array is set to the rows of each
+ *      of them.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_multiget (casstcl_sessionClientData *ct, casstcl_preparedClientData *pcd, Tcl_Obj *keyListObj, int concurrency, CassConsistency *consistencyPtr, int timeoutMS, int rowStyle, Tcl_Obj *arrayNameObj, Tcl_Obj *errorsVarObj)
+{
+	Tcl_Interp *interp = ct->interp;
+	casstcl_multigetState ms;
+	casstcl_multigetStream *streams;
+	Tcl_Obj **resultObjs;
+	Tcl_Obj **names = NULL;
+	int columnCount = 0;
+	int active = 0;
+	int tclReturn = TCL_OK;
+	int i;
+
+	ms.ct = ct;
+	ms.pcd = pcd;
+	ms.consistencyPtr = consistencyPtr;
+	ms.timeoutMS = timeoutMS;
+	ms.nextKey = 0;
+	ms.errorsObj = NULL;
+
+	if (Tcl_ListObjGetElements (interp, keyListObj, &ms.nKeys, &ms.keyObjs) == TCL_ERROR) {
+		Tcl_AppendResult (interp, " while parsing list of keys", NULL);
+		return TCL_ERROR;
+	}
+
+	// hold on to the keys in case converting one shimmers the list
+	Tcl_IncrRefCount (keyListObj);
+
+	if (errorsVarObj != NULL) {
+		ms.errorsObj = Tcl_NewDictObj ();
+		Tcl_IncrRefCount (ms.errorsObj);
+	}
+
+	if (concurrency > ms.nKeys) {
+		concurrency = ms.nKeys;
+	}
+
+	ms.waiter = casstcl_future_waiter_new ();
+
+	resultObjs = (Tcl_Obj **)ckalloc (sizeof (Tcl_Obj *) * (ms.nKeys + 1));
+	for (i = 0; i < ms.nKeys; i++) {
+		resultObjs[i] = NULL;
+	}
+
+	streams = (casstcl_multigetStream *)ckalloc (sizeof (casstcl_multigetStream) * (concurrency + 1));
+	for (i = 0; i < concurrency; i++) {
+		streams[i].statement = NULL;
+		streams[i].future = NULL;
+		streams[i].rowsObj = NULL;
+	}
+
+	for (i = 0; i < concurrency && tclReturn == TCL_OK; i++) {
+		tclReturn = casstcl_multiget_start_key (&ms, &streams[i]);
+		if (streams[i].future != NULL) {
+			active++;
+		}
+	}
+
+	while (tclReturn == TCL_OK && active > 0) {
+		casstcl_multigetStream *stream = NULL;
+		casstcl_resultRef *resultRef;
+		const CassResult *result;
+		Tcl_Obj *pageObj;
+		CassError rc;
+
+		// take whichever lookup has finished first, and if none has,
+		// wait for the first to
+		while (stream == NULL) {
+			for (i = 0; i < concurrency; i++) {
+				if (streams[i].future != NULL && cass_future_ready (streams[i].future)) {
+					stream = &streams[i];
+					break;
+				}
+			}
+
+			if (stream == NULL) {
+				casstcl_future_waiter_wait (ms.waiter);
+			}
+		}
+
+		rc = cass_future_error_code (stream->future);
+		if (rc != CASS_OK) {
+			casstcl_future_error_to_tcl (ct, rc, stream->future);
+			cass_future_free (stream->future);
+			stream->future = NULL;
+			if (stream->rowsObj != NULL) {
+				Tcl_DecrRefCount (stream->rowsObj);
+				stream->rowsObj = NULL;
+			}
+
+			if ((tclReturn = casstcl_multiget_failed (&ms, stream->key)) == TCL_OK) {
+				tclReturn = casstcl_multiget_start_key (&ms, stream);
+			}
+			if (stream->future == NULL) {
+				active--;
+			}
+			continue;
+		}
+
+		result = cass_future_get_result (stream->future);
+		cass_future_free (stream->future);
+		stream->future = NULL;
+
+		if (result == NULL) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "future has no result", NULL);
+			tclReturn = TCL_ERROR;
+			break;
+		}
+
+		// every key is looked up with the same statement so they all
+		// have the same columns
+		if (names == NULL) {
+			names = casstcl_result_column_names (result, &columnCount);
+		}
+
+		resultRef = casstcl_result_ref_new (result);
+		tclReturn = casstcl_result_rows_to_obj (ct, resultRef, names, columnCount, rowStyle, &pageObj);
+
+		if (tclReturn == TCL_OK) {
+			if (stream->rowsObj == NULL) {
+				stream->rowsObj = pageObj;
+				Tcl_IncrRefCount (stream->rowsObj);
+			} else {
+				Tcl_ListObjAppendList (NULL, stream->rowsObj, pageObj);
+				Tcl_IncrRefCount (pageObj);
+				Tcl_DecrRefCount (pageObj);
+			}
+
+			if (cass_result_has_more_pages (result)) {
+				cass_statement_set_paging_state (stream->statement, result);
+				stream->future = cass_session_execute (ct->session, stream->statement);
+				casstcl_future_waiter_watch (ms.waiter, stream->future);
+			} else {
+				resultObjs[stream->key] = stream->rowsObj;
+				stream->rowsObj = NULL;
+				tclReturn = casstcl_multiget_start_key (&ms, stream);
+				if (stream->future == NULL) {
+					active--;
+				}
+			}
+		}
+
+		casstcl_result_ref_release (resultRef);
+	}
+
+	// the driver sees any lookups still running through to the end
+	// without us
+	for (i = 0; i < concurrency; i++) {
+		if (streams[i].future != NULL) {
+			cass_future_free (streams[i].future);
+		}
+		if (streams[i].rowsObj != NULL) {
+			Tcl_DecrRefCount (streams[i].rowsObj);
+		}
+		if (streams[i].statement != NULL) {
+			cass_statement_free (streams[i].statement);
+		}
+	}
+	ckfree ((char *)streams);
+	casstcl_future_waiter_release (ms.waiter);
+	casstcl_free_column_names (names, columnCount);
+
+	if (tclReturn == TCL_OK && errorsVarObj != NULL) {
+		if (Tcl_ObjSetVar2 (interp, errorsVarObj, NULL, ms.errorsObj, (TCL_LEAVE_ERR_MSG)) == NULL) {
+			tclReturn = TCL_ERROR;
+		}
+	}
+
+	if (tclReturn == TCL_OK && arrayNameObj != NULL) {
+		int found = 0;
+
+		for (i = 0; i < ms.nKeys && tclReturn == TCL_OK; i++) {
+			if (resultObjs[i] == NULL) {
+				continue;
+			}
+
+			if (Tcl_ObjSetVar2 (interp, arrayNameObj, ms.keyObjs[i], resultObjs[i], (TCL_LEAVE_ERR_MSG)) == NULL) {
+				tclReturn = TCL_ERROR;
+			}
+			found++;
+		}
+
+		if (tclReturn == TCL_OK) {
+			Tcl_SetObjResult (interp, Tcl_NewIntObj (found));
+		}
+	} else if (tclReturn == TCL_OK) {
+		Tcl_Obj *listObj = Tcl_NewListObj (0, NULL);
+
+		for (i = 0; i < ms.nKeys; i++) {
+			Tcl_ListObjAppendElement (NULL, listObj, (resultObjs[i] != NULL) ? resultObjs[i] : Tcl_NewObj ());
+		}
+		Tcl_SetObjResult (interp, listObj);
+	}
+
+	for (i = 0; i < ms.nKeys; i++) {
+		if (resultObjs[i] != NULL) {
+			Tcl_DecrRefCount (resultObjs[i]);
+		}
+	}
+	ckfree ((char *)resultObjs);
+
+	if (ms.errorsObj != NULL) {
+		Tcl_DecrRefCount (ms.errorsObj);
+	}
+	Tcl_DecrRefCount (keyListObj);
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_multiget_from_objv -- parse the arguments of the
+ *   multiget method of a cassandra object and do the lookups
+ *
+ *   $cass multiget ?-concurrency n? ?-consistency level?
+ *       ?-timeout ms? ?-list|-dict? ?-array arrayName?
+ *       ?-errors varName? prepared keyList
+ *
+ *   objv[0] is the first of the options.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_multiget_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[])
+{
+	Tcl_Interp *interp = ct->interp;
+	casstcl_preparedClientData *pcd;
+	int concurrency = CASSTCL_MULTIGET_DEFAULT_CONCURRENCY;
+	int timeoutMS = -1;
+	CassConsistency consistency;
+	CassConsistency *consistencyPtr = NULL;
+	int rowStyle = CASSTCL_ROWS_DICT;
+	Tcl_Obj *arrayNameObj = NULL;
+	Tcl_Obj *errorsVarObj = NULL;
+	char *preparedName;
+	int arg;
+
+	static CONST char *options[] = {
+		"-concurrency",
+		"-consistency",
+		"-timeout",
+		"-list",
+		"-dict",
+		"-array",
+		"-errors",
+		NULL
+	};
+
+	enum options {
+		OPT_CONCURRENCY,
+		OPT_CONSISTENCY,
+		OPT_TIMEOUT,
+		OPT_LIST,
+		OPT_DICT,
+		OPT_ARRAY,
+		OPT_ERRORS
+	};
+
+	// the options all start with a dash; the prepared statement's
+	// name never does
+	for (arg = 0; arg + 2 < objc && *Tcl_GetString (objv[arg]) == '-'; arg++) {
+		int optIndex;
+
+		if (Tcl_GetIndexFromObj (interp, objv[arg], options, "option", TCL_EXACT, &optIndex) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		if ((enum options) optIndex == OPT_LIST) {
+			rowStyle = CASSTCL_ROWS_LIST;
+			continue;
+		}
+
+		if ((enum options) optIndex == OPT_DICT) {
+			rowStyle = CASSTCL_ROWS_DICT;
+			continue;
+		}
+
+		if (arg + 3 == objc) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "value for \"", Tcl_GetString (objv[arg]), "\" missing", NULL);
+			return TCL_ERROR;
+		}
+		arg++;
+
+		switch ((enum options) optIndex) {
+			case OPT_CONCURRENCY:
+				if (Tcl_GetIntFromObj (interp, objv[arg], &concurrency) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting concurrency", NULL);
+					return TCL_ERROR;
+				}
+
+				if (concurrency < 1) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "concurrency must be at least 1", NULL);
+					return TCL_ERROR;
+				}
+				break;
+
+			case OPT_CONSISTENCY:
+				if (casstcl_obj_to_cass_consistency (ct, objv[arg], &consistency) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				consistencyPtr = &consistency;
+				break;
+
+			case OPT_TIMEOUT:
+				if (casstcl_obj_to_request_timeout (ct, objv[arg], &timeoutMS) == TCL_ERROR) {
+					return TCL_ERROR;
+				}
+				break;
+
+			case OPT_ARRAY:
+				arrayNameObj = objv[arg];
+				break;
+
+			case OPT_ERRORS:
+				errorsVarObj = objv[arg];
+				break;
+
+			case OPT_LIST:
+			case OPT_DICT:
+				break;
+		}
+	}
+
+	if (arg + 2 != objc) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "a prepared statement and a list of keys must follow the options", NULL);
+		return TCL_ERROR;
+	}
+
+	preparedName = Tcl_GetString (objv[arg]);
+	pcd = casstcl_prepared_command_to_preparedClientData (interp, preparedName);
+	if (pcd == NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "'", preparedName, "' isn't a valid prepared statement object", NULL);
+		return TCL_ERROR;
+	}
+
+	return casstcl_multiget (ct, pcd, objv[arg + 1], concurrency, consistencyPtr, timeoutMS, rowStyle, arrayNameObj, errorsVarObj);
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,66 @@
+/*
+ *
+ * Include file for casstcl_multiget
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_multiget -- look up many keys through a prepared
+ *   statement, up to concurrency of them at once
+ *
+ *   The rows of each key are collected, as dicts or, if rowStyle
+ *   is CASSTCL_ROWS_LIST, as lists.  As soon as a stream has all
+ *   of the rows of its key it starts on the next key not yet
+ *   begun.
+ *   The driver routes each lookup to a replica of its partition
+ *   when token aware routing is on, as the key's values make up
+ *   the routing key of a bound statement.
+ *
+ *   If errorsVarObj isn't NULL, keys whose lookup failed get no
+ *   rows and the variable is set to a dict of the keys and their
+ *   errors; otherwise the first key to fail ends the multiget with
+ *   an error.
+ *
+ * Results:
+ *      A standard Tcl result.  Once every key is done, the
+ *      interpreter result is a list of the rows of each key in the
+ *      order of the keys or, if arrayNameObj isn't NULL, the number
+ *      of keys with rows and the array is set to the rows of each
+ *      of them.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_multiget (casstcl_sessionClientData *ct, casstcl_preparedClientData *pcd, Tcl_Obj *keyListObj, int concurrency, CassConsistency *consistencyPtr, int timeoutMS, int rowStyle, Tcl_Obj *arrayNameObj, Tcl_Obj *errorsVarObj);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_multiget_from_objv -- parse the arguments of the
+ *   multiget method of a cassandra object and do the lookups
+ *
+ *   $cass multiget ?-concurrency n? ?-consistency level?
+ *       ?-timeout ms? ?-list|-dict? ?-array arrayName?
+ *       ?-errors varName? prepared keyList
+ *
+ *   objv[0] is the first of the options.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_multiget_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[]);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
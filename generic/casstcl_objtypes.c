@@ -0,0 +1,803 @@
+/*
+ * casstcl_objtypes - Tcl object types for cassandra timestamps, uuids,
+ *                    inet addresses and blob references
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_objtypes.h"
+#include "casstcl_result.h"
+
+#include <assert.h>
+
+// Tcl type definitions for values fetched from cassandra
+//
+// values of these types carry what the driver gave us, so that binding
+// them back (say, when copying rows from one table to another) needs no
+// parsing.  the string representation is only made if somebody asks for
+// it, and looks just like what casstcl has always returned for the type.
+// strings can also be converted to these types, which is done for uuids
+// and inet addresses when they are bound so a value used over and over
+// gets parsed only once.
+//
+// a timestamp is the number of milliseconds since the epoch, which fits
+// in the Tcl_Obj.  uuids and inet addresses don't fit everywhere, so the
+// internal representation points to a ckalloc'ed copy
+
+static void DupCassTimestampInternalRep (Tcl_Obj *srcPtr, Tcl_Obj *copyPtr);
+static int SetCassTimestampFromAny (Tcl_Interp *interp, Tcl_Obj *obj);
+static void UpdateCassTimestampString (Tcl_Obj *obj);
+
+static void FreeCassUuidInternalRep (Tcl_Obj *obj);
+static void DupCassUuidInternalRep (Tcl_Obj *srcPtr, Tcl_Obj *copyPtr);
+static int SetCassUuidFromAny (Tcl_Interp *interp, Tcl_Obj *obj);
+static void UpdateCassUuidString (Tcl_Obj *obj);
+
+static void FreeCassInetInternalRep (Tcl_Obj *obj);
+static void DupCassInetInternalRep (Tcl_Obj *srcPtr, Tcl_Obj *copyPtr);
+static int SetCassInetFromAny (Tcl_Interp *interp, Tcl_Obj *obj);
+static void UpdateCassInetString (Tcl_Obj *obj);
+
+static void FreeCassBlobRefInternalRep (Tcl_Obj *obj);
+static void DupCassBlobRefInternalRep (Tcl_Obj *srcPtr, Tcl_Obj *copyPtr);
+static int SetCassBlobRefFromAny (Tcl_Interp *interp, Tcl_Obj *obj);
+static void UpdateCassBlobRefString (Tcl_Obj *obj);
+
+Tcl_ObjType casstcl_timestampTclType = {
+	"CassTimestamp",
+	NULL,
+	DupCassTimestampInternalRep,
+	UpdateCassTimestampString,
+	SetCassTimestampFromAny
+};
+
+Tcl_ObjType casstcl_uuidTclType = {
+	"CassUuid",
+	FreeCassUuidInternalRep,
+	DupCassUuidInternalRep,
+	UpdateCassUuidString,
+	SetCassUuidFromAny
+};
+
+Tcl_ObjType casstcl_inetTclType = {
+	"CassInet",
+	FreeCassInetInternalRep,
+	DupCassInetInternalRep,
+	UpdateCassInetString,
+	SetCassInetFromAny
+};
+
+// a blob reference is a blob fetched from cassandra that hasn't been
+// copied out of the result it came in.  it holds a reference to that
+// result, which stays alive until the last such object goes away or
+// is converted to something else (which is when the blob is copied)
+typedef struct casstcl_blobRef
+{
+	casstcl_resultRef *owner;
+	const cass_byte_t *data;
+	size_t size;
+} casstcl_blobRef;
+
+Tcl_ObjType casstcl_blobRefTclType = {
+	"CassBlobRef",
+	FreeCassBlobRefInternalRep,
+	DupCassBlobRefInternalRep,
+	UpdateCassBlobRefString,
+	SetCassBlobRefFromAny
+};
+
+// give an object the string representation held in a buffer
+static void
+casstcl_set_string_rep (Tcl_Obj *obj, const char *string)
+{
+	size_t length = strlen (string);
+
+	obj->bytes = ckalloc (length + 1);
+	memcpy (obj->bytes, string, length + 1);
+	obj->length = length;
+}
+
+// get rid of whatever internal representation an object has
+static void
+casstcl_free_int_rep (Tcl_Obj *obj)
+{
+	if (obj->typePtr != NULL && obj->typePtr->freeIntRepProc != NULL) {
+		obj->typePtr->freeIntRepProc (obj);
+	}
+	obj->typePtr = NULL;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_parse_timestamp --
+ *
+ *  Accepts a Tcl object value that specifies a whole number of
+ *  seconds and optionally a fractional number of seconds, and
+ *  converts the value to the whole number of milliseconds.
+ *
+ * Results:
+ *  A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+static int
+casstcl_parse_timestamp (Tcl_Interp *interp, Tcl_Obj *objPtr, cass_int64_t *milliseconds)
+{
+  Tcl_WideInt wideVal;
+  if (Tcl_GetWideIntFromObj(NULL, objPtr, &wideVal) == TCL_OK) {
+    if (wideVal < CASS_TIMESTAMP_LOWER_LIMIT ||
+            wideVal > CASS_TIMESTAMP_UPPER_LIMIT) {
+      if (interp != NULL) {
+        Tcl_ResetResult(interp);
+        Tcl_AppendResult(interp, "whole seconds cannot exceed ",
+            STRINGIFY(CASS_TIMESTAMP_UPPER_LIMIT), NULL);
+      }
+      return TCL_ERROR;
+    } else {
+      *milliseconds = wideVal * 1000; /* SAFE: See 'if' above. */
+    }
+  } else {
+    double doubleVal;
+    if (Tcl_GetDoubleFromObj(interp, objPtr, &doubleVal) == TCL_OK) {
+      if ((Tcl_WideInt)doubleVal < CASS_TIMESTAMP_LOWER_LIMIT ||
+              (Tcl_WideInt)doubleVal > CASS_TIMESTAMP_UPPER_LIMIT) {
+        if (interp != NULL) {
+          Tcl_ResetResult(interp);
+          Tcl_AppendResult(interp, "whole seconds cannot exceed ",
+              STRINGIFY(CASS_TIMESTAMP_UPPER_LIMIT), NULL);
+        }
+        return TCL_ERROR;
+      } else {
+        wideVal = (Tcl_WideInt)doubleVal; /* SAFE: See 'if' above. */
+        doubleVal -= (double)wideVal;
+        doubleVal *= 1000.0;
+        *milliseconds = (wideVal * 1000) + (Tcl_WideInt)doubleVal;
+      }
+    } else {
+      return TCL_ERROR;
+    }
+  }
+  return TCL_OK;
+}
+
+// copy the internal representation of a timestamp to a new Tcl object
+static void
+DupCassTimestampInternalRep (Tcl_Obj *srcPtr, Tcl_Obj *copyPtr)
+{
+	copyPtr->internalRep.wideValue = srcPtr->internalRep.wideValue;
+	copyPtr->typePtr = &casstcl_timestampTclType;
+}
+
+// convert a number of seconds, possibly fractional, to a timestamp
+static int
+SetCassTimestampFromAny (Tcl_Interp *interp, Tcl_Obj *obj)
+{
+	cass_int64_t milliseconds;
+
+	// make sure the string survives the number shimmering away
+	Tcl_GetString (obj);
+
+	if (casstcl_parse_timestamp (interp, obj, &milliseconds) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	casstcl_free_int_rep (obj);
+	obj->internalRep.wideValue = milliseconds;
+	obj->typePtr = &casstcl_timestampTclType;
+	return TCL_OK;
+}
+
+// generate the string representation of a timestamp, whole seconds as
+// an integer and anything else as a double
+static void
+UpdateCassTimestampString (Tcl_Obj *obj)
+{
+	Tcl_WideInt milliseconds = obj->internalRep.wideValue;
+	char buf[TCL_DOUBLE_SPACE + TCL_INTEGER_SPACE];
+
+	if ((milliseconds % 1000) == 0) {
+		sprintf (buf, "%" TCL_LL_MODIFIER "d", milliseconds / 1000);
+	} else {
+		Tcl_PrintDouble (NULL, (double)milliseconds / 1000.0, buf);
+	}
+	casstcl_set_string_rep (obj, buf);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_GetTimestampFromObj --
+ *
+ *  Accepts a Tcl object value that specifies a whole number of
+ *  seconds and optionally a fractional number of seconds, and
+ *  converts the value to the whole number of milliseconds.
+ *
+ *  Timestamps fetched from cassandra are used as they are.  Other
+ *  values are parsed but not converted, since they are usually
+ *  numbers the script is also doing arithmetic on.
+ *
+ * Results:
+ *  A standard Tcl result.
+ *
+ * Side effects:
+ *  None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+casstcl_GetTimestampFromObj(
+    Tcl_Interp *interp,   /* Used for error reporting if not NULL. */
+    Tcl_Obj *objPtr,    /* Object from which to get milliseconds. */
+    cass_int64_t *milliseconds) /* Place to store whole milliseconds. */
+{
+	if (objPtr->typePtr == &casstcl_timestampTclType) {
+		*milliseconds = objPtr->internalRep.wideValue;
+		return TCL_OK;
+	}
+
+	return casstcl_parse_timestamp (interp, objPtr, milliseconds);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_NewTimestampObj --
+ *
+ *  Accepts a Cassandra 'timestamp' value, in milliseconds, and
+ *  creates a Tcl object based on it.  If the milliseconds is
+ *  evenly divisible by 1000, the string representation is the
+ *  exact number of seconds as an integer.  Otherwise, it is an
+ *  approximate double, where the fractional portion represents
+ *  the milliseconds and the whole portion the number of seconds.
+ *
+ *  The object keeps the milliseconds, so binding it to a timestamp
+ *  needs no conversion, and its string representation is only made
+ *  when needed.
+ *
+ * Results:
+ *  The newly created Tcl object, having a reference count of zero.
+ *
+ * Side effects:
+ *  None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tcl_Obj *casstcl_NewTimestampObj(
+  cass_int64_t milliseconds
+){
+	Tcl_Obj *obj = Tcl_NewObj ();
+
+	Tcl_InvalidateStringRep (obj);
+	obj->internalRep.wideValue = milliseconds;
+	obj->typePtr = &casstcl_timestampTclType;
+	return obj;
+}
+
+// free the copy of a uuid
+static void
+FreeCassUuidInternalRep (Tcl_Obj *obj)
+{
+	ckfree ((char *)obj->internalRep.otherValuePtr);
+}
+
+// copy the internal representation of a uuid to a new Tcl object
+static void
+DupCassUuidInternalRep (Tcl_Obj *srcPtr, Tcl_Obj *copyPtr)
+{
+	CassUuid *uuidPtr = (CassUuid *)ckalloc (sizeof (CassUuid));
+
+	*uuidPtr = *(CassUuid *)srcPtr->internalRep.otherValuePtr;
+	copyPtr->internalRep.otherValuePtr = uuidPtr;
+	copyPtr->typePtr = &casstcl_uuidTclType;
+}
+
+// convert a string like 550e8400-e29b-41d4-a716-446655440000 to a uuid
+static int
+SetCassUuidFromAny (Tcl_Interp *interp, Tcl_Obj *obj)
+{
+	const char *string = Tcl_GetString (obj);
+	CassUuid uuid;
+	CassUuid *uuidPtr;
+
+	if (cass_uuid_from_string (string, &uuid) != CASS_OK) {
+		if (interp != NULL) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "expected uuid but got \"", string, "\"", NULL);
+		}
+		return TCL_ERROR;
+	}
+
+	uuidPtr = (CassUuid *)ckalloc (sizeof (CassUuid));
+	*uuidPtr = uuid;
+	casstcl_free_int_rep (obj);
+	obj->internalRep.otherValuePtr = uuidPtr;
+	obj->typePtr = &casstcl_uuidTclType;
+	return TCL_OK;
+}
+
+// generate the string representation of a uuid
+static void
+UpdateCassUuidString (Tcl_Obj *obj)
+{
+	char buf[CASS_UUID_STRING_LENGTH];
+
+	cass_uuid_string (*(CassUuid *)obj->internalRep.otherValuePtr, buf);
+	casstcl_set_string_rep (obj, buf);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_GetUuidFromObj --
+ *
+ *  Attempt to return a uuid (or a timeuuid) from the Tcl object
+ *  "objPtr", converting it to a uuid object so that it needn't be
+ *  parsed again.
+ *
+ * Results:
+ *  A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_GetUuidFromObj (Tcl_Interp *interp, Tcl_Obj *objPtr, CassUuid *uuidPtr)
+{
+	if (Tcl_ConvertToType (interp, objPtr, &casstcl_uuidTclType) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	*uuidPtr = *(CassUuid *)objPtr->internalRep.otherValuePtr;
+	return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_NewUuidObj --
+ *
+ *  Create a Tcl object holding a uuid (or a timeuuid), whose string
+ *  representation is only made when needed.
+ *
+ * Results:
+ *  The newly created Tcl object, having a reference count of zero.
+ *
+ *----------------------------------------------------------------------
+ */
+Tcl_Obj *
+casstcl_NewUuidObj (CassUuid uuid)
+{
+	Tcl_Obj *obj = Tcl_NewObj ();
+	CassUuid *uuidPtr = (CassUuid *)ckalloc (sizeof (CassUuid));
+
+	*uuidPtr = uuid;
+	Tcl_InvalidateStringRep (obj);
+	obj->internalRep.otherValuePtr = uuidPtr;
+	obj->typePtr = &casstcl_uuidTclType;
+	return obj;
+}
+
+// free the copy of an inet address
+static void
+FreeCassInetInternalRep (Tcl_Obj *obj)
+{
+	ckfree ((char *)obj->internalRep.otherValuePtr);
+}
+
+// copy the internal representation of an inet address to a new Tcl object
+static void
+DupCassInetInternalRep (Tcl_Obj *srcPtr, Tcl_Obj *copyPtr)
+{
+	CassInet *inetPtr = (CassInet *)ckalloc (sizeof (CassInet));
+
+	*inetPtr = *(CassInet *)srcPtr->internalRep.otherValuePtr;
+	copyPtr->internalRep.otherValuePtr = inetPtr;
+	copyPtr->typePtr = &casstcl_inetTclType;
+}
+
+// convert a numeric IPv4 or IPv6 address to an inet address
+static int
+SetCassInetFromAny (Tcl_Interp *interp, Tcl_Obj *obj)
+{
+  const char *value = Tcl_GetString(obj);
+  struct addrinfo hints;
+  struct addrinfo *result = NULL;
+  CassInet inet;
+  int rc;
+
+  memset(&hints, 0, sizeof(struct addrinfo));
+  hints.ai_flags = AI_NUMERICHOST;
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  rc = getaddrinfo(value, NULL, &hints, &result);
+
+  if (rc != 0) {
+    if (interp != NULL) {
+      Tcl_ResetResult(interp);
+      Tcl_AppendResult(interp, gai_strerror(rc), NULL);
+    }
+    return TCL_ERROR;
+  }
+
+#if 0
+  casstcl_DumpAddrInfo(stdout, result, 0);
+#endif
+  assert(result != NULL);
+  memset(&inet, 0, sizeof(CassInet));
+  // ai_addrlen is the length of the whole sockaddr, not of the address
+  if (result->ai_family == AF_INET) {
+    struct sockaddr_in *pSockAddr = (struct sockaddr_in *)result->ai_addr;
+    assert(result->ai_addrlen >= sizeof(struct sockaddr_in));
+    inet = cass_inet_init_v4((const cass_uint8_t *)&pSockAddr->sin_addr.s_addr);
+  } else if (result->ai_family == AF_INET6) {
+    struct sockaddr_in6 *pSockAddr = (struct sockaddr_in6 *)result->ai_addr;
+    assert(result->ai_addrlen >= sizeof(struct sockaddr_in6));
+    inet = cass_inet_init_v6((const cass_uint8_t *)&pSockAddr->sin6_addr.s6_addr);
+  } else {
+    if (interp != NULL) {
+      Tcl_ResetResult(interp);
+      Tcl_AppendResult(interp, "address \"", value, "\" is not IPv4 or IPv6", NULL);
+    }
+    freeaddrinfo(result);
+    return TCL_ERROR;
+  }
+  freeaddrinfo(result);
+
+  CassInet *inetPtr = (CassInet *)ckalloc (sizeof (CassInet));
+  *inetPtr = inet;
+  casstcl_free_int_rep (obj);
+  obj->internalRep.otherValuePtr = inetPtr;
+  obj->typePtr = &casstcl_inetTclType;
+  return TCL_OK;
+}
+
+// generate the string representation of an inet address
+static void
+UpdateCassInetString (Tcl_Obj *obj)
+{
+	CassInet *inetPtr = (CassInet *)obj->internalRep.otherValuePtr;
+	char addrBuf[INET6_ADDRSTRLEN];
+	int isIpV6 = (inetPtr->address_length == CASS_INET_V6_LENGTH);
+
+	assert(INET6_ADDRSTRLEN >= INET_ADDRSTRLEN);
+	memset(addrBuf, 0, INET6_ADDRSTRLEN);
+	inet_ntop(isIpV6 ? AF_INET6 : AF_INET, inetPtr->address, addrBuf, INET6_ADDRSTRLEN);
+	casstcl_set_string_rep (obj, addrBuf);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_GetInetFromObj --
+ *
+ *  Attempt to return an Inet from the Tcl object "objPtr",
+ *  converting it to an inet object so that it needn't be parsed
+ *  again.
+ *
+ * Results:
+ *  A standard Tcl result.
+ *
+ * Side effects:
+ *  None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+casstcl_GetInetFromObj(
+    Tcl_Interp *interp, /* Used for error reporting if not NULL. */
+    Tcl_Obj *objPtr,  /* The object from which to get an Inet. */
+    CassInet *inetPtr)  /* Place to store resulting Inet. */
+{
+	if (Tcl_ConvertToType (interp, objPtr, &casstcl_inetTclType) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	*inetPtr = *(CassInet *)objPtr->internalRep.otherValuePtr;
+	return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_NewInetObj --
+ *
+ *  Create a Tcl object holding an inet address, whose string
+ *  representation is only made when needed.
+ *
+ * Results:
+ *  The newly created Tcl object, having a reference count of zero.
+ *
+ *----------------------------------------------------------------------
+ */
+Tcl_Obj *
+casstcl_NewInetObj (CassInet inet)
+{
+	Tcl_Obj *obj = Tcl_NewObj ();
+	CassInet *inetPtr = (CassInet *)ckalloc (sizeof (CassInet));
+
+	*inetPtr = inet;
+	Tcl_InvalidateStringRep (obj);
+	obj->internalRep.otherValuePtr = inetPtr;
+	obj->typePtr = &casstcl_inetTclType;
+	return obj;
+}
+
+static void
+FreeCassBlobRefInternalRep (Tcl_Obj *obj)
+{
+	casstcl_blobRef *blobRef = (casstcl_blobRef *)obj->internalRep.otherValuePtr;
+
+	casstcl_result_ref_release (blobRef->owner);
+	ckfree ((char *)blobRef);
+	obj->typePtr = NULL;
+}
+
+static void
+DupCassBlobRefInternalRep (Tcl_Obj *srcPtr, Tcl_Obj *copyPtr)
+{
+	casstcl_blobRef *srcRef = (casstcl_blobRef *)srcPtr->internalRep.otherValuePtr;
+	casstcl_blobRef *blobRef = (casstcl_blobRef *)ckalloc (sizeof (casstcl_blobRef));
+
+	*blobRef = *srcRef;
+	casstcl_result_ref_retain (blobRef->owner);
+	copyPtr->internalRep.otherValuePtr = blobRef;
+	copyPtr->typePtr = &casstcl_blobRefTclType;
+}
+
+// there is no result for a string to refer to
+static int
+SetCassBlobRefFromAny (Tcl_Interp *interp, Tcl_Obj *obj)
+{
+	if (interp != NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "can't make a blob reference from \"", Tcl_GetString (obj), "\"", NULL);
+	}
+	return TCL_ERROR;
+}
+
+// the string is the same as that of a byte array holding the blob: each
+// byte is the character with that code, in Tcl's utf-8, where the null
+// character is two bytes
+static void
+UpdateCassBlobRefString (Tcl_Obj *obj)
+{
+	casstcl_blobRef *blobRef = (casstcl_blobRef *)obj->internalRep.otherValuePtr;
+	size_t length = 0;
+	size_t i;
+	char *dst;
+
+	for (i = 0; i < blobRef->size; i++) {
+		length += (blobRef->data[i] > 0 && blobRef->data[i] < 0x80) ? 1 : 2;
+	}
+
+	dst = obj->bytes = ckalloc (length + 1);
+	for (i = 0; i < blobRef->size; i++) {
+		cass_byte_t byte = blobRef->data[i];
+
+		if (byte > 0 && byte < 0x80) {
+			*dst++ = byte;
+		} else {
+			*dst++ = 0xc0 | (byte >> 6);
+			*dst++ = 0x80 | (byte & 0x3f);
+		}
+	}
+	*dst = '\0';
+	obj->length = length;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_NewBlobRefObj --
+ *
+ *  Create a Tcl object for a blob that points into the result the
+ *  blob was fetched in rather than holding a copy of it.  The
+ *  object holds a reference to the result.
+ *
+ * Results:
+ *  The newly created Tcl object, having a reference count of zero.
+ *
+ *----------------------------------------------------------------------
+ */
+Tcl_Obj *
+casstcl_NewBlobRefObj (casstcl_resultRef *owner, const cass_byte_t *data, size_t size)
+{
+	Tcl_Obj *obj = Tcl_NewObj ();
+	casstcl_blobRef *blobRef = (casstcl_blobRef *)ckalloc (sizeof (casstcl_blobRef));
+
+	blobRef->owner = owner;
+	blobRef->data = data;
+	blobRef->size = size;
+	casstcl_result_ref_retain (owner);
+
+	Tcl_InvalidateStringRep (obj);
+	obj->internalRep.otherValuePtr = blobRef;
+	obj->typePtr = &casstcl_blobRefTclType;
+	return obj;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_GetBlobFromObj --
+ *
+ *  Get the bytes of a blob from the Tcl object "objPtr".  For a blob
+ *  reference those are the bytes in the result it was fetched in;
+ *  anything else is taken as a byte array.
+ *
+ *  The bytes belong to the object and are good for as long as it
+ *  keeps its internal representation.
+ *
+ * Results:
+ *  None.
+ *
+ *----------------------------------------------------------------------
+ */
+void
+casstcl_GetBlobFromObj (Tcl_Obj *objPtr, const cass_byte_t **dataPtr, size_t *sizePtr)
+{
+	if (objPtr->typePtr == &casstcl_blobRefTclType) {
+		casstcl_blobRef *blobRef = (casstcl_blobRef *)objPtr->internalRep.otherValuePtr;
+
+		*dataPtr = blobRef->data;
+		*sizePtr = blobRef->size;
+	} else {
+		int length = 0;
+
+		*dataPtr = Tcl_GetByteArrayFromObj (objPtr, &length);
+		*sizePtr = length;
+	}
+}
+
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_blob_to_channel --
+ *
+ *  Write the bytes of a blob to a channel, straight from the result
+ *  for a blob reference, without making a byte array of it first.
+ *  The channel should be in binary mode.
+ *
+ * Results:
+ *  A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_blob_to_channel (Tcl_Interp *interp, Tcl_Channel channel, Tcl_Obj *blobObj)
+{
+	const cass_byte_t *data = NULL;
+	size_t size = 0;
+
+	casstcl_GetBlobFromObj (blobObj, &data, &size);
+
+	if (Tcl_Write (channel, (const char *)data, (int)size) < 0) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "error writing \"", Tcl_GetChannelName (channel), "\": ", Tcl_PosixError (interp), NULL);
+		return TCL_ERROR;
+	}
+
+	Tcl_SetObjResult (interp, Tcl_NewWideIntObj ((Tcl_WideInt)size));
+	return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_blob_from_channel --
+ *
+ *  Read a blob from a channel into a byte array, which binds to a
+ *  blob column without any conversion.  Up to "size" bytes are read,
+ *  or everything up to the end of file if size is negative; the
+ *  array is made at its final size when that's known up front.
+ *  The channel should be in binary mode.  Blobs of more than
+ *  INT_MAX bytes, which a byte array can't hold, are an error.
+ *
+ * Results:
+ *  A standard Tcl result; the byte array is the interpreter result.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_blob_from_channel (Tcl_Interp *interp, Tcl_Channel channel, Tcl_WideInt size)
+{
+	Tcl_Obj *blobObj = Tcl_NewObj ();
+	Tcl_WideInt allocated = size;
+	Tcl_WideInt length = 0;
+	int nRead = 0;
+
+	// for a file, the rest of it is as much as there can be
+	if (allocated < 0) {
+		Tcl_WideInt here = Tcl_Tell (channel);
+
+		if (here >= 0) {
+			Tcl_WideInt end = Tcl_Seek (channel, 0, SEEK_END);
+
+			if (end >= 0 && Tcl_Seek (channel, here, SEEK_SET) >= 0 && end >= here) {
+				allocated = end - here;
+			}
+		}
+	}
+
+	if (allocated < 0) {
+		allocated = 65536;
+	}
+
+	Tcl_IncrRefCount (blobObj);
+
+	while (size < 0 || length < size) {
+		unsigned char *bytes;
+
+		if (allocated > INT_MAX) {
+			goto tooBig;
+		}
+
+		if (length < allocated) {
+			bytes = Tcl_SetByteArrayLength (blobObj, (int)allocated);
+			nRead = Tcl_Read (channel, (char *)bytes + length, (int)(allocated - length));
+		} else {
+			char probe[4096];
+
+			// the array is full and there's no size to stop at.  see if
+			// there's any more before doubling it, so that a file that
+			// was sized exactly isn't given twice the room
+			nRead = Tcl_Read (channel, probe, sizeof (probe));
+			if (nRead > 0) {
+				// an array that was sized from the file may be smaller
+				// than what was read past its end
+				allocated *= 2;
+				if (allocated < length + nRead) {
+					allocated = length + nRead;
+				}
+				if (allocated < 65536) {
+					allocated = 65536;
+				}
+
+				// byte arrays are at most INT_MAX long
+				if (length + nRead > INT_MAX) {
+					goto tooBig;
+				}
+				if (allocated > INT_MAX) {
+					allocated = INT_MAX;
+				}
+
+				bytes = Tcl_SetByteArrayLength (blobObj, (int)allocated);
+				memcpy (bytes + length, probe, nRead);
+			}
+		}
+
+		if (nRead <= 0) {
+			break;
+		}
+		length += nRead;
+	}
+
+	if (nRead < 0) {
+		Tcl_DecrRefCount (blobObj);
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "error reading \"", Tcl_GetChannelName (channel), "\": ", Tcl_PosixError (interp), NULL);
+		return TCL_ERROR;
+	}
+
+	Tcl_SetByteArrayLength (blobObj, (int)length);
+	Tcl_SetObjResult (interp, blobObj);
+	Tcl_DecrRefCount (blobObj);
+	return TCL_OK;
+
+  tooBig:
+	Tcl_DecrRefCount (blobObj);
+	Tcl_ResetResult (interp);
+	Tcl_AppendResult (interp, "blob from \"", Tcl_GetChannelName (channel), "\" is too big", NULL);
+	return TCL_ERROR;
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
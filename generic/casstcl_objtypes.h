@@ -0,0 +1,206 @@
+/*
+ *
+ * Include file for casstcl_objtypes
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_GetTimestampFromObj --
+ *
+ *  Accepts a Tcl object value that specifies a whole number of
+ *  seconds and optionally a fractional number of seconds, and
+ *  converts the value to the whole number of milliseconds.
+ *
+ *  Timestamps fetched from cassandra are used as they are.  Other
+ *  values are parsed but not converted, since they are usually
+ *  numbers the script is also doing arithmetic on.
+ *
+ * Results:
+ *  A standard Tcl result.
+ *
+ * Side effects:
+ *  None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+casstcl_GetTimestampFromObj(
+    Tcl_Interp *interp,		/* Used for error reporting if not NULL. */
+    Tcl_Obj *objPtr,		/* Object from which to get milliseconds. */
+    cass_int64_t *milliseconds);	/* Place to store whole milliseconds. */
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_NewTimestampObj --
+ *
+ *  Accepts a Cassandra 'timestamp' value, in milliseconds, and
+ *  creates a Tcl object based on it.  If the milliseconds is
+ *  evenly divisible by 1000, the string representation is the
+ *  exact number of seconds as an integer.  Otherwise, it is an
+ *  approximate double, where the fractional portion represents
+ *  the milliseconds and the whole portion the number of seconds.
+ *
+ *  The object keeps the milliseconds, so binding it to a timestamp
+ *  needs no conversion, and its string representation is only made
+ *  when needed.
+ *
+ * Results:
+ *  The newly created Tcl object, having a reference count of zero.
+ *
+ * Side effects:
+ *  None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tcl_Obj *casstcl_NewTimestampObj(cass_int64_t milliseconds);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_GetUuidFromObj --
+ *
+ *  Attempt to return a uuid (or a timeuuid) from the Tcl object
+ *  "objPtr", converting it to a uuid object so that it needn't be
+ *  parsed again.
+ *
+ * Results:
+ *  A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_GetUuidFromObj (Tcl_Interp *interp, Tcl_Obj *objPtr, CassUuid *uuidPtr);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_NewUuidObj --
+ *
+ *  Create a Tcl object holding a uuid (or a timeuuid), whose string
+ *  representation is only made when needed.
+ *
+ * Results:
+ *  The newly created Tcl object, having a reference count of zero.
+ *
+ *----------------------------------------------------------------------
+ */
+Tcl_Obj *casstcl_NewUuidObj (CassUuid uuid);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_GetInetFromObj --
+ *
+ *  Attempt to return an Inet from the Tcl object "objPtr",
+ *  converting it to an inet object so that it needn't be parsed
+ *  again.
+ *
+ * Results:
+ *  A standard Tcl result.
+ *
+ * Side effects:
+ *  None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+casstcl_GetInetFromObj(
+    Tcl_Interp *interp, /* Used for error reporting if not NULL. */
+    Tcl_Obj *objPtr,  /* The object from which to get an Inet. */
+    CassInet *inetPtr);  /* Place to store resulting Inet. */
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_NewInetObj --
+ *
+ *  Create a Tcl object holding an inet address, whose string
+ *  representation is only made when needed.
+ *
+ * Results:
+ *  The newly created Tcl object, having a reference count of zero.
+ *
+ *----------------------------------------------------------------------
+ */
+Tcl_Obj *casstcl_NewInetObj (CassInet inet);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_NewBlobRefObj --
+ *
+ *  Create a Tcl object for a blob that points into the result the
+ *  blob was fetched in rather than holding a copy of it.  The
+ *  object holds a reference to the result.
+ *
+ * Results:
+ *  The newly created Tcl object, having a reference count of zero.
+ *
+ *----------------------------------------------------------------------
+ */
+Tcl_Obj *casstcl_NewBlobRefObj (casstcl_resultRef *owner, const cass_byte_t *data, size_t size);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_GetBlobFromObj --
+ *
+ *  Get the bytes of a blob from the Tcl object "objPtr".  For a blob
+ *  reference those are the bytes in the result it was fetched in;
+ *  anything else is taken as a byte array.
+ *
+ *  The bytes belong to the object and are good for as long as it
+ *  keeps its internal representation.
+ *
+ * Results:
+ *  None.
+ *
+ *----------------------------------------------------------------------
+ */
+void casstcl_GetBlobFromObj (Tcl_Obj *objPtr, const cass_byte_t **dataPtr, size_t *sizePtr);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_blob_to_channel --
+ *
+ *  Write the bytes of a blob to a channel, straight from the result
+ *  for a blob reference, without making a byte array of it first.
+ *  The channel should be in binary mode.
+ *
+ * Results:
+ *  A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_blob_to_channel (Tcl_Interp *interp, Tcl_Channel channel, Tcl_Obj *blobObj);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_blob_from_channel --
+ *
+ *  Read a blob from a channel into a byte array, which binds to a
+ *  blob column without any conversion.  Up to "size" bytes are read,
+ *  or everything up to the end of file if size is negative; the
+ *  array is made at its final size when that's known up front.
+ *  The channel should be in binary mode.  Blobs of more than
+ *  INT_MAX bytes, which a byte array can't hold, are an error.
+ *
+ * Results:
+ *  A standard Tcl result; the byte array is the interpreter result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_blob_from_channel (Tcl_Interp *interp, Tcl_Channel channel, Tcl_WideInt size);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
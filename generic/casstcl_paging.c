@@ -0,0 +1,494 @@
+/*
+ * casstcl_paging - Functions for choosing the page sizes of selects
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_paging.h"
+
+#define CASSTCL_PAGING_APPEND(name, obj) \
+	Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ((name), -1)); \
+	Tcl_ListObjAppendElement (NULL, listObj, (obj))
+
+// each value of a row carries a four byte length in the protocol, which
+// also keeps rows of empty values from looking free
+#define CASSTCL_PAGING_VALUE_OVERHEAD 4
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_paging_now -- the current time in microseconds
+ *
+ * Results:
+ *      The time.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static Tcl_WideInt
+casstcl_paging_now (void)
+{
+	Tcl_Time now;
+
+	Tcl_GetTime (&now);
+	return ((Tcl_WideInt)now.sec * 1000000) + now.usec;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_paging_clamp -- bring a page size within the bounds
+ *   of a paging policy
+ *
+ * Results:
+ *      The page size.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_paging_clamp (casstcl_pagingPolicy *policy, Tcl_WideInt pageSize)
+{
+	if (pageSize < policy->minRows) {
+		return policy->minRows;
+	}
+
+	if (pageSize > policy->maxRows) {
+		return policy->maxRows;
+	}
+	return (int)pageSize;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_paging_note_size -- record a page size chosen for an
+ *   adaptively paged select in a session's paging statistics
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_paging_note_size (casstcl_pagingStats *stats, int pageSize)
+{
+	stats->lastSize = pageSize;
+	if (stats->smallestSize == 0 || pageSize < stats->smallestSize) {
+		stats->smallestSize = pageSize;
+	}
+	if (pageSize > stats->largestSize) {
+		stats->largestSize = pageSize;
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_paging_init -- give a session the default paging
+ *   policy and clear its paging statistics
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_paging_init (casstcl_sessionClientData *ct)
+{
+	casstcl_pagingPolicy *policy = &ct->pagingPolicy;
+
+	policy->enabled = 0;
+	policy->initialRows = CASSTCL_DEFAULT_PAGING_INITIAL_ROWS;
+	policy->minRows = CASSTCL_DEFAULT_PAGING_MIN_ROWS;
+	policy->maxRows = CASSTCL_DEFAULT_PAGING_MAX_ROWS;
+	policy->targetBytes = CASSTCL_DEFAULT_PAGING_TARGET_BYTES;
+	policy->targetLatencyMS = CASSTCL_DEFAULT_PAGING_TARGET_LATENCY_MS;
+
+	casstcl_paging_stats_reset (ct);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_paging_stats_reset -- clear the paging statistics of
+ *   a session
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_paging_stats_reset (casstcl_sessionClientData *ct)
+{
+	memset (&ct->pagingStats, 0, sizeof (casstcl_pagingStats));
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_paging_stats_obj -- describe what adaptive paging has
+ *   done for a session
+ *
+ * Results:
+ *      A new list of key-value pairs.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *
+casstcl_paging_stats_obj (casstcl_sessionClientData *ct)
+{
+	casstcl_pagingStats *stats = &ct->pagingStats;
+	Tcl_Obj *listObj = Tcl_NewObj ();
+
+	CASSTCL_PAGING_APPEND ("selects", Tcl_NewWideIntObj (stats->selects));
+	CASSTCL_PAGING_APPEND ("pages", Tcl_NewWideIntObj (stats->pages));
+	CASSTCL_PAGING_APPEND ("rows", Tcl_NewWideIntObj (stats->rows));
+	CASSTCL_PAGING_APPEND ("bytes", Tcl_NewWideIntObj (stats->bytes));
+	CASSTCL_PAGING_APPEND ("mean_rows_per_page", Tcl_NewWideIntObj ((stats->pages > 0) ? stats->rows / stats->pages : 0));
+	CASSTCL_PAGING_APPEND ("mean_bytes_per_page", Tcl_NewWideIntObj ((stats->pages > 0) ? stats->bytes / stats->pages : 0));
+	CASSTCL_PAGING_APPEND ("last_page_size", Tcl_NewIntObj (stats->lastSize));
+	CASSTCL_PAGING_APPEND ("smallest_page_size", Tcl_NewIntObj (stats->smallestSize));
+	CASSTCL_PAGING_APPEND ("largest_page_size", Tcl_NewIntObj (stats->largestSize));
+	CASSTCL_PAGING_APPEND ("grown", Tcl_NewWideIntObj (stats->grown));
+	CASSTCL_PAGING_APPEND ("shrunk", Tcl_NewWideIntObj (stats->shrunk));
+	return listObj;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_paging_policy_obj -- describe the paging policy of a
+ *   session, as returned by the adaptive_paging method
+ *
+ * Results:
+ *      A new list of key-value pairs.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static Tcl_Obj *
+casstcl_paging_policy_obj (casstcl_pagingPolicy *policy)
+{
+	Tcl_Obj *listObj = Tcl_NewObj ();
+
+	CASSTCL_PAGING_APPEND ("enabled", Tcl_NewBooleanObj (policy->enabled));
+	CASSTCL_PAGING_APPEND ("initial", Tcl_NewIntObj (policy->initialRows));
+	CASSTCL_PAGING_APPEND ("min", Tcl_NewIntObj (policy->minRows));
+	CASSTCL_PAGING_APPEND ("max", Tcl_NewIntObj (policy->maxRows));
+	CASSTCL_PAGING_APPEND ("target_bytes", Tcl_NewWideIntObj (policy->targetBytes));
+	CASSTCL_PAGING_APPEND ("target_latency", Tcl_NewIntObj (policy->targetLatencyMS));
+	return listObj;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_paging_policy_cmd -- the adaptive_paging method of a
+ *   session: change the options of its paging policy given as
+ *   arguments, if any, and return the policy
+ *
+ *   The options are -enable (a boolean), -initial, -min and -max
+ *   (page sizes in rows), -target_bytes and -target_latency (in
+ *   milliseconds).  Nothing is changed unless all of them are
+ *   valid.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_paging_policy_cmd (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[])
+{
+	Tcl_Interp *interp = ct->interp;
+	casstcl_pagingPolicy policy = ct->pagingPolicy;
+	int optIndex;
+	int arg;
+
+	static CONST char *options[] = {
+		"-enable",
+		"-initial",
+		"-min",
+		"-max",
+		"-target_bytes",
+		"-target_latency",
+		NULL
+	};
+
+	enum options {
+		OPT_ENABLE,
+		OPT_INITIAL,
+		OPT_MIN,
+		OPT_MAX,
+		OPT_TARGET_BYTES,
+		OPT_TARGET_LATENCY
+	};
+
+	if ((objc - 2) % 2 != 0) {
+		Tcl_WrongNumArgs (interp, 2, objv, "?-enable boolean? ?-initial rows? ?-min rows? ?-max rows? ?-target_bytes bytes? ?-target_latency ms?");
+		return TCL_ERROR;
+	}
+
+	for (arg = 2; arg < objc; arg += 2) {
+		if (Tcl_GetIndexFromObj (interp, objv[arg], options, "option", TCL_EXACT, &optIndex) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		switch ((enum options) optIndex) {
+			case OPT_ENABLE: {
+				if (Tcl_GetBooleanFromObj (interp, objv[arg + 1], &policy.enabled) == TCL_ERROR) {
+					return TCL_ERROR;
+				}
+				break;
+			}
+
+			case OPT_INITIAL: {
+				if (Tcl_GetIntFromObj (interp, objv[arg + 1], &policy.initialRows) == TCL_ERROR) {
+					return TCL_ERROR;
+				}
+				break;
+			}
+
+			case OPT_MIN: {
+				if (Tcl_GetIntFromObj (interp, objv[arg + 1], &policy.minRows) == TCL_ERROR) {
+					return TCL_ERROR;
+				}
+				break;
+			}
+
+			case OPT_MAX: {
+				if (Tcl_GetIntFromObj (interp, objv[arg + 1], &policy.maxRows) == TCL_ERROR) {
+					return TCL_ERROR;
+				}
+				break;
+			}
+
+			case OPT_TARGET_BYTES: {
+				if (Tcl_GetWideIntFromObj (interp, objv[arg + 1], &policy.targetBytes) == TCL_ERROR) {
+					return TCL_ERROR;
+				}
+				break;
+			}
+
+			case OPT_TARGET_LATENCY: {
+				if (Tcl_GetIntFromObj (interp, objv[arg + 1], &policy.targetLatencyMS) == TCL_ERROR) {
+					return TCL_ERROR;
+				}
+				break;
+			}
+		}
+	}
+
+	if (policy.minRows < 1 || policy.maxRows < policy.minRows) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "page sizes must be at least 1 and -max can't be less than -min", NULL);
+		return TCL_ERROR;
+	}
+
+	if (policy.targetBytes < 1 || policy.targetLatencyMS < 0) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "-target_bytes must be at least 1 and -target_latency can't be negative", NULL);
+		return TCL_ERROR;
+	}
+
+	policy.initialRows = casstcl_paging_clamp (&policy, policy.initialRows);
+	ct->pagingPolicy = policy;
+
+	Tcl_SetObjResult (interp, casstcl_paging_policy_obj (&policy));
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_pager_start -- set up the paging of a select, given
+ *   the page size it was asked for: a number of rows,
+ *   CASSTCL_PAGING_ADAPTIVE, or zero if none was given, which
+ *   pages adaptively if the session's policy is enabled and by
+ *   the default of 100 rows otherwise
+ *
+ * Results:
+ *      The size of the first page.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_pager_start (casstcl_sessionClientData *ct, casstcl_pager *pager, int pagingSize)
+{
+	pager->bytesPerRow = 0.0;
+	pager->requestTime = 0;
+
+	if (pagingSize == 0) {
+		pagingSize = ct->pagingPolicy.enabled ? CASSTCL_PAGING_ADAPTIVE : CASSTCL_DEFAULT_PAGING_INITIAL_ROWS;
+	}
+
+	if (pagingSize != CASSTCL_PAGING_ADAPTIVE) {
+		pager->adaptive = 0;
+		pager->pageSize = pagingSize;
+		return pagingSize;
+	}
+
+	pager->adaptive = 1;
+	pager->pageSize = casstcl_paging_clamp (&ct->pagingPolicy, ct->pagingPolicy.initialRows);
+	ct->pagingStats.selects++;
+	casstcl_paging_note_size (&ct->pagingStats, pager->pageSize);
+	return pager->pageSize;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_pager_requested -- note that a select has asked for a
+ *   page, so that the time it takes to come back can be measured
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_pager_requested (casstcl_pager *pager)
+{
+	if (pager->adaptive) {
+		pager->requestTime = casstcl_paging_now ();
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_pager_next -- work out the size of the next page of
+ *   an adaptively paged select from the page that just arrived
+ *
+ *   The size of the page is measured from its values, which are
+ *   still in the form the cluster sent them.  The rows per page
+ *   that would come to the policy's target bytes, given the
+ *   smoothed bytes per row, is limited further, if the page took
+ *   longer than the target latency, to the rows that would have
+ *   come back in that time.  The page size moves to that at once
+ *   when it is smaller, so that wide rows don't run away with
+ *   memory, but at most doubles when it is larger.
+ *
+ * Results:
+ *      The page size for the next request, which is the same as for
+ *      this one if the select isn't adaptive.
+ *
+ * Side effects:
+ *      The session's paging statistics are updated.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_pager_next (casstcl_sessionClientData *ct, casstcl_pager *pager, const CassResult *result, int columnCount)
+{
+	casstcl_pagingPolicy *policy = &ct->pagingPolicy;
+	casstcl_pagingStats *stats = &ct->pagingStats;
+	Tcl_WideInt latency;
+	Tcl_WideInt bytes = 0;
+	Tcl_WideInt wanted;
+	int rowCount;
+	int pageSize;
+	CassIterator *iterator;
+
+	if (!pager->adaptive) {
+		return pager->pageSize;
+	}
+
+	latency = casstcl_paging_now () - pager->requestTime;
+	rowCount = cass_result_row_count (result);
+
+	iterator = cass_iterator_from_result (result);
+	while (cass_iterator_next (iterator)) {
+		const CassRow *row = cass_iterator_get_row (iterator);
+		int i;
+
+		for (i = 0; i < columnCount; i++) {
+			const CassValue *value = cass_row_get_column (row, i);
+			const cass_byte_t *data;
+			size_t size;
+
+			bytes += CASSTCL_PAGING_VALUE_OVERHEAD;
+			if (!cass_value_is_null (value) && cass_value_get_bytes (value, &data, &size) == CASS_OK) {
+				bytes += size;
+			}
+		}
+	}
+	cass_iterator_free (iterator);
+
+	stats->pages++;
+	stats->rows += rowCount;
+	stats->bytes += bytes;
+
+	// a page with no rows says nothing about how big they are
+	if (rowCount == 0) {
+		return pager->pageSize;
+	}
+
+	if (pager->bytesPerRow == 0.0) {
+		pager->bytesPerRow = (double)bytes / rowCount;
+	} else {
+		pager->bytesPerRow = (pager->bytesPerRow + (double)bytes / rowCount) / 2.0;
+	}
+
+	wanted = (Tcl_WideInt)(policy->targetBytes / pager->bytesPerRow);
+
+	if (policy->targetLatencyMS > 0 && latency > (Tcl_WideInt)policy->targetLatencyMS * 1000) {
+		Tcl_WideInt inTime = (Tcl_WideInt)rowCount * policy->targetLatencyMS * 1000 / latency;
+
+		if (inTime < wanted) {
+			wanted = inTime;
+		}
+	}
+
+	if (wanted > (Tcl_WideInt)pager->pageSize * 2) {
+		wanted = (Tcl_WideInt)pager->pageSize * 2;
+	}
+
+	pageSize = casstcl_paging_clamp (policy, wanted);
+
+	if (pageSize > pager->pageSize) {
+		stats->grown++;
+	} else if (pageSize < pager->pageSize) {
+		stats->shrunk++;
+	}
+
+	casstcl_paging_note_size (stats, pageSize);
+	pager->pageSize = pageSize;
+	return pageSize;
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
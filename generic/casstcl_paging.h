@@ -0,0 +1,142 @@
+/*
+ *
+ * Include file for casstcl_paging
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_paging_init -- give a session the default paging
+ *   policy and clear its paging statistics
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_paging_init (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_paging_stats_reset -- clear the paging statistics of
+ *   a session
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_paging_stats_reset (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_paging_stats_obj -- describe what adaptive paging has
+ *   done for a session
+ *
+ * Results:
+ *      A new list of key-value pairs.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *casstcl_paging_stats_obj (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_paging_policy_cmd -- the adaptive_paging method of a
+ *   session: change the options of its paging policy given as
+ *   arguments, if any, and return the policy
+ *
+ *   The options are -enable (a boolean), -initial, -min and -max
+ *   (page sizes in rows), -target_bytes and -target_latency (in
+ *   milliseconds).  Nothing is changed unless all of them are
+ *   valid.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_paging_policy_cmd (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[]);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_pager_start -- set up the paging of a select, given
+ *   the page size it was asked for: a number of rows,
+ *   CASSTCL_PAGING_ADAPTIVE, or zero if none was given, which
+ *   pages adaptively if the session's policy is enabled and by
+ *   the default of 100 rows otherwise
+ *
+ * Results:
+ *      The size of the first page.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_pager_start (casstcl_sessionClientData *ct, casstcl_pager *pager, int pagingSize);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_pager_requested -- note that a select has asked for a
+ *   page, so that the time it takes to come back can be measured
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_pager_requested (casstcl_pager *pager);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_pager_next -- work out the size of the next page of
+ *   an adaptively paged select from the page that just arrived
+ *
+ *   The size of the page is measured from its values, which are
+ *   still in the form the cluster sent them.  The rows per page
+ *   that would come to the policy's target bytes, given the
+ *   smoothed bytes per row, is limited further, if the page took
+ *   longer than the target latency, to the rows that would have
+ *   come back in that time.  The page size moves to that at once
+ *   when it is smaller, so that wide rows don't run away with
+ *   memory, but at most doubles when it is larger.
+ *
+ * Results:
+ *      The page size for the next request, which is the same as for
+ *      this one if the select isn't adaptive.
+ *
+ * Side effects:
+ *      The session's paging statistics are updated.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_pager_next (casstcl_sessionClientData *ct, casstcl_pager *pager, const CassResult *result, int columnCount);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,651 @@
+/*
+ * casstcl_partitioned - Functions used to create, delete, and handle
+ *                       partitioned batches, which keep a separate batch
+ *                       for each partition that upserts are made into
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_partitioned.h"
+#include "casstcl_batch.h"
+#include "casstcl_cassandra.h"
+#include "casstcl_consistency.h"
+#include "casstcl_error.h"
+#include "casstcl_schema.h"
+
+#include <assert.h>
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_partitioned_batch_drop -- remove a per partition batch
+ *   from its partitioned batch and free it
+ *
+ *   This is also the emptiedProc of the per partition batches, so
+ *   that one which its age timer has flushed goes away rather than
+ *   sitting empty in the table.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_partitioned_batch_drop (casstcl_batchClientData *bcd)
+{
+	Tcl_DeleteHashEntry ((Tcl_HashEntry *)bcd->emptiedData);
+	casstcl_batch_free (bcd);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_partitioned_batch_free_partitions -- free all of the
+ *   per partition batches of a partitioned batch, throwing away
+ *   any statements in them
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The partition table is left empty.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_partitioned_batch_free_partitions (casstcl_partitionedBatchClientData *pbcd)
+{
+	Tcl_HashSearch search;
+	Tcl_HashEntry *hashEntry;
+
+	for (hashEntry = Tcl_FirstHashEntry (&pbcd->partitionHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+		casstcl_batch_free ((casstcl_batchClientData *)Tcl_GetHashValue (hashEntry));
+	}
+
+	Tcl_DeleteHashTable (&pbcd->partitionHash);
+	Tcl_InitHashTable (&pbcd->partitionHash, TCL_STRING_KEYS);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_partitionedBatchObjectDelete -- command deletion
+ *   callback routine.
+ *
+ * Results:
+ *      ...destroys the partitioned batch object and its per
+ *         partition batches.
+ *      ...frees memory.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_partitionedBatchObjectDelete (ClientData clientData)
+{
+	casstcl_partitionedBatchClientData *pbcd = (casstcl_partitionedBatchClientData *)clientData;
+
+	assert (pbcd->cass_partitioned_batch_magic == CASS_PARTITIONED_BATCH_MAGIC);
+
+	casstcl_partitioned_batch_free_partitions (pbcd);
+	Tcl_DeleteHashTable (&pbcd->partitionHash);
+
+	if (pbcd->flushCallbackObj != NULL) {
+		Tcl_DecrRefCount (pbcd->flushCallbackObj);
+	}
+
+	// an upsert waiting for room in the in-flight window may be holding
+	// on to it
+	pbcd->cass_partitioned_batch_magic = 0;
+	Tcl_EventuallyFree ((ClientData)pbcd, TCL_DYNAMIC);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_partition_key -- make the key that an upsert's row is
+ *   filed under in a partitioned batch
+ *
+ *   The key is the fully qualified table name followed by the
+ *   value of each column of the table's partition key, in key
+ *   order, each preceded by its length so that different values
+ *   can't run together into the same key.  Rows with the same key
+ *   go to the same partition, and so to the same replicas.
+ *
+ * Results:
+ *      A standard Tcl result; on success the key is left in the
+ *      DString, which the caller must free either way.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_partition_key (casstcl_sessionClientData *ct, char *tableName, Tcl_Obj *listObj, Tcl_DString *keyPtr)
+{
+	Tcl_Interp *interp = ct->interp;
+	casstcl_tableInfo *tableInfo = casstcl_lookup_table (ct, tableName);
+	Tcl_Obj **listObjv;
+	int listObjc;
+	int i;
+
+	if (tableInfo == NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "table '", tableName, "' isn't in the column type map", NULL);
+		return TCL_ERROR;
+	}
+
+	if (tableInfo->nPartitionKeys == 0) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "the partition key of table '", tableName, "' isn't known", NULL);
+		return TCL_ERROR;
+	}
+
+	if (Tcl_ListObjGetElements (interp, listObj, &listObjc, &listObjv) == TCL_ERROR) {
+		Tcl_AppendResult (interp, " while parsing list of key-value pairs", NULL);
+		return TCL_ERROR;
+	}
+
+	Tcl_DStringAppend (keyPtr, tableInfo->fullName, -1);
+
+	for (i = 0; i < tableInfo->nPartitionKeys; i++) {
+		casstcl_columnInfo *columnInfo = tableInfo->partitionKey[i];
+		Tcl_Obj *valueObj = NULL;
+		char lengthString[24];
+		char *value;
+		int length;
+		int j;
+
+		for (j = 0; j + 1 < listObjc; j += 2) {
+			if (strcmp (Tcl_GetString (listObjv[j]), columnInfo->name) == 0) {
+				valueObj = listObjv[j + 1];
+				break;
+			}
+		}
+
+		if (valueObj == NULL) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "upsert into '", tableName, "' is missing partition key column '", columnInfo->name, "'", NULL);
+			return TCL_ERROR;
+		}
+
+		value = Tcl_GetStringFromObj (valueObj, &length);
+		snprintf (lengthString, sizeof (lengthString), " %d:", length);
+		Tcl_DStringAppend (keyPtr, lengthString, -1);
+		Tcl_DStringAppend (keyPtr, value, length);
+	}
+
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_partitioned_batch_upsert -- make an upsert statement
+ *   from the arguments of a partitioned batch's upsert method and
+ *   add it to the batch for its partition, creating that batch if
+ *   there isn't one
+ *
+ *   The per partition batch flushes itself according to the auto
+ *   flush limits of the partitioned batch; if that leaves it empty
+ *   it is dropped.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_partitioned_batch_upsert (casstcl_partitionedBatchClientData *pbcd, int objc, Tcl_Obj *CONST objv[])
+{
+	casstcl_sessionClientData *ct = pbcd->ct;
+	CassStatement *statement = NULL;
+	casstcl_batchClientData *bcd;
+	Tcl_HashEntry *hashEntry;
+	Tcl_DString key;
+	int tclReturn;
+	int new;
+
+	if (casstcl_make_upsert_statement_from_objv (ct, objc, objv, NULL, &statement) == TCL_ERROR) {
+		return TCL_ERROR;
+	}
+
+	// the table and the key-value list are always the last two
+	// arguments, casstcl_make_upsert_statement_from_objv has checked
+	Tcl_DStringInit (&key);
+	if (casstcl_partition_key (ct, Tcl_GetString (objv[objc - 2]), objv[objc - 1], &key) == TCL_ERROR) {
+		Tcl_DStringFree (&key);
+		cass_statement_free (statement);
+		return TCL_ERROR;
+	}
+
+	hashEntry = Tcl_CreateHashEntry (&pbcd->partitionHash, Tcl_DStringValue (&key), &new);
+	Tcl_DStringFree (&key);
+
+	if (new) {
+		bcd = casstcl_batch_new (ct, pbcd->batchType);
+		bcd->consistency = pbcd->consistency;
+		cass_batch_set_consistency (bcd->batch, bcd->consistency);
+		bcd->maxStatements = pbcd->maxStatements;
+		bcd->maxBytes = pbcd->maxBytes;
+		bcd->maxAge = pbcd->maxAge;
+		casstcl_batch_set_flush_callback (bcd, pbcd->flushCallbackObj);
+		bcd->emptiedProc = casstcl_partitioned_batch_drop;
+		bcd->emptiedData = (ClientData)hashEntry;
+		Tcl_SetHashValue (hashEntry, bcd);
+	} else {
+		bcd = (casstcl_batchClientData *)Tcl_GetHashValue (hashEntry);
+	}
+
+	// adding can flush, which can wait for room in the in-flight
+	// window, which runs events that might delete us
+	Tcl_Preserve ((ClientData)pbcd);
+	Tcl_Preserve ((ClientData)bcd);
+
+	tclReturn = casstcl_batch_add_statement (bcd, statement, Tcl_GetString (objv[objc - 2]), objc, objv);
+
+	if ((pbcd->cass_partitioned_batch_magic == CASS_PARTITIONED_BATCH_MAGIC) &&
+		(bcd->cass_batch_magic == CASS_BATCH_MAGIC) && (bcd->count == 0)) {
+		casstcl_partitioned_batch_drop (bcd);
+	}
+
+	Tcl_Release ((ClientData)bcd);
+	Tcl_Release ((ClientData)pbcd);
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_partitioned_batch_flush -- flush the batch of every
+ *   partition of a partitioned batch, as with a batch's flush
+ *   method, and drop them
+ *
+ * Results:
+ *      A standard Tcl result; if there is a callback the
+ *      interpreter result is a list of the future objects created,
+ *      one per partition.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_partitioned_batch_flush (casstcl_partitionedBatchClientData *pbcd, Tcl_Obj *callbackObj)
+{
+	Tcl_Interp *interp = pbcd->ct->interp;
+	Tcl_Obj *resultObj = Tcl_NewObj ();
+	casstcl_batchClientData **batches;
+	Tcl_HashSearch search;
+	Tcl_HashEntry *hashEntry;
+	int tclReturn = TCL_OK;
+	int nBatches = 0;
+	int i;
+
+	// flushing can run events that add to the partitions or delete
+	// them, so take a list of them first, holding on to each
+	batches = (casstcl_batchClientData **)ckalloc (sizeof (casstcl_batchClientData *) * (pbcd->partitionHash.numEntries + 1));
+	for (hashEntry = Tcl_FirstHashEntry (&pbcd->partitionHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+		batches[nBatches] = (casstcl_batchClientData *)Tcl_GetHashValue (hashEntry);
+		Tcl_Preserve ((ClientData)batches[nBatches]);
+		nBatches++;
+	}
+
+	Tcl_IncrRefCount (resultObj);
+	Tcl_Preserve ((ClientData)pbcd);
+
+	for (i = 0; i < nBatches; i++) {
+		casstcl_batchClientData *bcd = batches[i];
+
+		if ((tclReturn == TCL_OK) && (pbcd->cass_partitioned_batch_magic == CASS_PARTITIONED_BATCH_MAGIC) &&
+			(bcd->cass_batch_magic == CASS_BATCH_MAGIC)) {
+			tclReturn = casstcl_batch_flush (bcd, callbackObj);
+			if (tclReturn == TCL_OK) {
+				if (callbackObj != NULL) {
+					Tcl_ListObjAppendElement (NULL, resultObj, Tcl_GetObjResult (interp));
+				}
+
+				if ((pbcd->cass_partitioned_batch_magic == CASS_PARTITIONED_BATCH_MAGIC) &&
+					(bcd->cass_batch_magic == CASS_BATCH_MAGIC) && (bcd->count == 0)) {
+					casstcl_partitioned_batch_drop (bcd);
+				}
+			}
+		}
+
+		Tcl_Release ((ClientData)bcd);
+	}
+
+	Tcl_Release ((ClientData)pbcd);
+	ckfree ((char *)batches);
+
+	if (tclReturn == TCL_OK) {
+		Tcl_SetObjResult (interp, resultObj);
+	}
+	Tcl_DecrRefCount (resultObj);
+	return tclReturn;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_createPartitionedBatchObjectCommand --
+ *
+ *    given a casstcl_sessionClientData pointer, an object name (or
+ *    "#auto"), and a CASS_BATCH_TYPE, create a corresponding partitioned
+ *    batch object command
+ *
+ * Results:
+ *    A standard Tcl result
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_createPartitionedBatchObjectCommand (casstcl_sessionClientData *ct, char *commandName, CassBatchType cassBatchType)
+{
+	// allocate one of our partitioned batch objects for Tcl and configure it
+	casstcl_partitionedBatchClientData *pbcd = (casstcl_partitionedBatchClientData *)ckalloc (sizeof (casstcl_partitionedBatchClientData));
+	Tcl_Interp *interp = ct->interp;
+
+	pbcd->cass_partitioned_batch_magic = CASS_PARTITIONED_BATCH_MAGIC;
+	pbcd->ct = ct;
+	pbcd->batchType = cassBatchType;
+	pbcd->consistency = CASS_CONSISTENCY_ONE;
+	Tcl_InitHashTable (&pbcd->partitionHash, TCL_STRING_KEYS);
+	pbcd->maxStatements = 0;
+	pbcd->maxBytes = 0;
+	pbcd->maxAge = 0;
+	pbcd->flushCallbackObj = NULL;
+
+#define PARTITIONED_BATCH_STRING_FORMAT "partitioned_batch%lu"
+	// if commandName is #auto, generate a unique name for the object
+	int autoGeneratedName = 0;
+	if (strcmp (commandName, "#auto") == 0) {
+		static unsigned long nextAutoCounter = 0;
+		int baseNameLength = snprintf (NULL, 0, PARTITIONED_BATCH_STRING_FORMAT, nextAutoCounter) + 1;
+		commandName = ckalloc (baseNameLength);
+		snprintf (commandName, baseNameLength, PARTITIONED_BATCH_STRING_FORMAT, nextAutoCounter++);
+		autoGeneratedName = 1;
+	}
+
+	// create a Tcl command to interface to the partitioned batch object
+	pbcd->cmdToken = Tcl_CreateObjCommand (interp, commandName, casstcl_partitionedBatchObjectObjCmd, pbcd, casstcl_partitionedBatchObjectDelete);
+	// set the full name to the command in the interpreter result
+	Tcl_GetCommandFullName(interp, pbcd->cmdToken, Tcl_GetObjResult (interp));
+	if (autoGeneratedName == 1) {
+		ckfree(commandName);
+	}
+
+	return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_partitionedBatchObjectObjCmd --
+ *
+ *    dispatches the subcommands of a casstcl partitioned batch command
+ *
+ * Results:
+ *    stuff
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_partitionedBatchObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[])
+{
+	int optIndex;
+	casstcl_partitionedBatchClientData *pbcd = (casstcl_partitionedBatchClientData *)cData;
+	Tcl_HashSearch search;
+	Tcl_HashEntry *hashEntry;
+	int resultCode = TCL_OK;
+
+	static CONST char *options[] = {
+		"upsert",
+		"count",
+		"bytes",
+		"partitions",
+		"consistency",
+		"auto_flush",
+		"flush",
+		"reset",
+		"delete",
+		NULL
+	};
+
+	enum options {
+		OPT_UPSERT,
+		OPT_COUNT,
+		OPT_BYTES,
+		OPT_PARTITIONS,
+		OPT_CONSISTENCY,
+		OPT_AUTO_FLUSH,
+		OPT_FLUSH,
+		OPT_RESET,
+		OPT_DELETE
+	};
+
+	/* basic validation of command line arguments */
+	if (objc < 2) {
+		Tcl_WrongNumArgs (interp, 1, objv, "subcommand ?args?");
+		return TCL_ERROR;
+	}
+
+	if (Tcl_GetIndexFromObj (interp, objv[1], options, "option", TCL_EXACT, &optIndex) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	switch ((enum options) optIndex) {
+		case OPT_UPSERT: {
+			resultCode = casstcl_partitioned_batch_upsert (pbcd, objc - 2, &objv[2]);
+			break;
+		}
+
+		// count and bytes - the totals over all of the partitions
+		case OPT_COUNT:
+		case OPT_BYTES: {
+			int total = 0;
+
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
+			}
+
+			for (hashEntry = Tcl_FirstHashEntry (&pbcd->partitionHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+				casstcl_batchClientData *bcd = (casstcl_batchClientData *)Tcl_GetHashValue (hashEntry);
+
+				total += ((enum options) optIndex == OPT_COUNT) ? bcd->count : bcd->bytes;
+			}
+
+			Tcl_SetObjResult (interp, Tcl_NewIntObj (total));
+			break;
+		}
+
+		// partitions - the number of partitions with statements waiting
+		case OPT_PARTITIONS: {
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
+			}
+
+			Tcl_SetObjResult (interp, Tcl_NewIntObj (pbcd->partitionHash.numEntries));
+			break;
+		}
+
+		case OPT_CONSISTENCY: {
+			CassConsistency cassConsistency;
+
+			if ((objc < 2) || (objc > 3)) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?consistency?");
+				return TCL_ERROR;
+			}
+
+			if (objc == 2) {
+				Tcl_SetObjResult (interp, Tcl_NewStringObj (casstcl_cass_consistency_to_string (pbcd->consistency), -1));
+				return TCL_OK;
+			}
+
+			if (casstcl_obj_to_cass_consistency(pbcd->ct, objv[2], &cassConsistency) == TCL_ERROR) {
+				return TCL_ERROR;
+			}
+
+			pbcd->consistency = cassConsistency;
+			for (hashEntry = Tcl_FirstHashEntry (&pbcd->partitionHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+				casstcl_batchClientData *bcd = (casstcl_batchClientData *)Tcl_GetHashValue (hashEntry);
+
+				bcd->consistency = cassConsistency;
+				CassError cassError = cass_batch_set_consistency (bcd->batch, cassConsistency);
+				if (cassError != CASS_OK) {
+					return casstcl_cass_error_to_tcl (pbcd->ct, cassError);
+				}
+			}
+			break;
+		}
+
+		case OPT_AUTO_FLUSH: {
+			int arg;
+			int subOptIndex;
+
+			static CONST char *subOptions[] = {
+				"-statements",
+				"-bytes",
+				"-age",
+				"-callback",
+				NULL
+			};
+
+			enum subOptions {
+				SUBOPT_STATEMENTS,
+				SUBOPT_BYTES,
+				SUBOPT_AGE,
+				SUBOPT_CALLBACK
+			};
+
+			if ((objc % 2) != 0) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-statements count? ?-bytes bytes? ?-age ms? ?-callback callback?");
+				return TCL_ERROR;
+			}
+
+			for (arg = 2; arg < objc; arg += 2) {
+				int value = 0;
+
+				if (Tcl_GetIndexFromObj (interp, objv[arg], subOptions, "subOption", TCL_EXACT, &subOptIndex) != TCL_OK) {
+					return TCL_ERROR;
+				}
+
+				if ((enum subOptions) subOptIndex == SUBOPT_CALLBACK) {
+					if (pbcd->flushCallbackObj != NULL) {
+						Tcl_DecrRefCount (pbcd->flushCallbackObj);
+						pbcd->flushCallbackObj = NULL;
+					}
+
+					if (Tcl_GetCharLength (objv[arg + 1]) > 0) {
+						pbcd->flushCallbackObj = objv[arg + 1];
+						Tcl_IncrRefCount (pbcd->flushCallbackObj);
+					}
+				} else {
+					if (Tcl_GetIntFromObj (interp, objv[arg + 1], &value) == TCL_ERROR) {
+						Tcl_AppendResult (interp, " while converting ", Tcl_GetString (objv[arg]), " element", NULL);
+						return TCL_ERROR;
+					}
+
+					if (value < 0) {
+						Tcl_ResetResult (interp);
+						Tcl_AppendResult (interp, "auto flush limit ", Tcl_GetString (objv[arg]), " must not be negative", NULL);
+						return TCL_ERROR;
+					}
+
+					if ((enum subOptions) subOptIndex == SUBOPT_STATEMENTS) {
+						pbcd->maxStatements = value;
+					} else if ((enum subOptions) subOptIndex == SUBOPT_BYTES) {
+						pbcd->maxBytes = value;
+					} else {
+						pbcd->maxAge = value;
+					}
+				}
+			}
+
+			// the new limits apply to the partitions already started too
+			if (objc > 2) {
+				for (hashEntry = Tcl_FirstHashEntry (&pbcd->partitionHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+					casstcl_batchClientData *bcd = (casstcl_batchClientData *)Tcl_GetHashValue (hashEntry);
+
+					bcd->maxStatements = pbcd->maxStatements;
+					bcd->maxBytes = pbcd->maxBytes;
+					if (bcd->maxAge != pbcd->maxAge) {
+						casstcl_batch_set_max_age (bcd, pbcd->maxAge);
+					}
+					casstcl_batch_set_flush_callback (bcd, pbcd->flushCallbackObj);
+				}
+			}
+
+			Tcl_Obj *listObjv[8];
+
+			listObjv[0] = Tcl_NewStringObj ("-statements", -1);
+			listObjv[1] = Tcl_NewIntObj (pbcd->maxStatements);
+			listObjv[2] = Tcl_NewStringObj ("-bytes", -1);
+			listObjv[3] = Tcl_NewIntObj (pbcd->maxBytes);
+			listObjv[4] = Tcl_NewStringObj ("-age", -1);
+			listObjv[5] = Tcl_NewIntObj (pbcd->maxAge);
+			listObjv[6] = Tcl_NewStringObj ("-callback", -1);
+			listObjv[7] = (pbcd->flushCallbackObj != NULL) ? pbcd->flushCallbackObj : Tcl_NewObj ();
+			Tcl_SetObjResult (interp, Tcl_NewListObj (8, listObjv));
+			break;
+		}
+
+		case OPT_FLUSH: {
+			Tcl_Obj *callbackObj = pbcd->flushCallbackObj;
+
+			if ((objc != 2) && !((objc == 4) && (strcmp (Tcl_GetString (objv[2]), "-callback") == 0))) {
+				Tcl_WrongNumArgs (interp, 2, objv, "?-callback callback?");
+				return TCL_ERROR;
+			}
+
+			if (objc == 4) {
+				callbackObj = (Tcl_GetCharLength (objv[3]) > 0) ? objv[3] : NULL;
+			}
+
+			resultCode = casstcl_partitioned_batch_flush (pbcd, callbackObj);
+			break;
+		}
+
+		case OPT_RESET: {
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
+			}
+
+			casstcl_partitioned_batch_free_partitions (pbcd);
+			break;
+		}
+
+		case OPT_DELETE: {
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
+			}
+
+			if (Tcl_DeleteCommandFromToken (pbcd->ct->interp, pbcd->cmdToken) == TCL_ERROR) {
+				resultCode = TCL_ERROR;
+			}
+			break;
+		}
+	}
+	return resultCode;
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
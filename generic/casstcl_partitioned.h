@@ -0,0 +1,59 @@
+/*
+ *
+ * Include file for casstcl_partitioned
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_partitionedBatchObjectDelete -- command deletion
+ *   callback routine.
+ *
+ * Results:
+ *      ...destroys the partitioned batch object and its per
+ *         partition batches.
+ *      ...frees memory.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_partitionedBatchObjectDelete (ClientData clientData);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_createPartitionedBatchObjectCommand --
+ *
+ *    given a casstcl_sessionClientData pointer, an object name (or
+ *    "#auto"), and a CASS_BATCH_TYPE, create a corresponding partitioned
+ *    batch object command
+ *
+ * Results:
+ *    A standard Tcl result
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_createPartitionedBatchObjectCommand (casstcl_sessionClientData *ct, char *commandName, CassBatchType cassBatchType);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_partitionedBatchObjectObjCmd --
+ *
+ *    dispatches the subcommands of a casstcl partitioned batch command
+ *
+ * Results:
+ *    stuff
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_partitionedBatchObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
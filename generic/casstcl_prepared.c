@@ -12,8 +12,41 @@
 #include "casstcl_prepared.h"
 #include "casstcl_types.h"
 #include "casstcl_consistency.h"
+#include "casstcl_error.h"
+#include "casstcl_schema.h"
 
 #include <assert.h>
+#include <ctype.h>
+
+// the kinds of tokens casstcl_cql_token finds in a CQL statement
+#define CASSTCL_CQL_END 0
+#define CASSTCL_CQL_WORD 1
+#define CASSTCL_CQL_MARKER 2
+#define CASSTCL_CQL_PUNCT 3
+#define CASSTCL_CQL_LITERAL 4
+#define CASSTCL_CQL_ERROR 5
+
+typedef struct casstcl_cqlToken
+{
+	int type;
+	char *text;
+} casstcl_cqlToken;
+
+// a column name given to exec -prepared remembers which parameter of
+// which prepared statement it names, so that it is only looked up the
+// first time.  ptr1 is the serial number of the prepared statement and
+// ptr2 the index of the parameter, or -1 if it isn't one
+static void DupCassPreparedParameterInternalRep (Tcl_Obj *srcPtr, Tcl_Obj *copyPtr);
+
+static Tcl_ObjType casstcl_preparedParameterTclType = {
+	"CassPreparedParameter",
+	NULL,
+	DupCassPreparedParameterInternalRep,
+	NULL,
+	NULL
+};
+
+static unsigned long casstcl_preparedSerial = 0;
 
 /*
  *--------------------------------------------------------------
@@ -39,6 +72,7 @@ casstcl_preparedObjectDelete (ClientData clientData)
 	cass_prepared_free (pcd->prepared);
 	Tcl_DecrRefCount (pcd->tableNameObj);
 	ckfree (pcd->string);
+	casstcl_prepared_free_parameters (pcd);
     ckfree((char *)clientData);
 }
 
@@ -60,21 +94,1009 @@ casstcl_preparedObjectDelete (ClientData clientData)
 casstcl_preparedClientData *
 casstcl_prepared_command_to_preparedClientData (Tcl_Interp *interp, char *preparedCommandName)
 {
-	Tcl_CmdInfo preparedCmdInfo;
+	Tcl_CmdInfo preparedCmdInfo;
+
+	if (!Tcl_GetCommandInfo (interp, preparedCommandName, &preparedCmdInfo)) {
+		return NULL;
+	}
+
+	casstcl_preparedClientData *pcd = (casstcl_preparedClientData *)preparedCmdInfo.objClientData;
+    if (pcd->cass_prepared_magic != CASS_PREPARED_MAGIC) {
+		return NULL;
+	}
+
+	return pcd;
+}
+
+
+/*
+ *--------------------------------------------------------------
+ *
+ * DupCassPreparedParameterInternalRep -- copy the prepared
+ *   statement parameter a column name has been resolved to
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+DupCassPreparedParameterInternalRep (Tcl_Obj *srcPtr, Tcl_Obj *copyPtr)
+{
+	copyPtr->internalRep.twoPtrValue = srcPtr->internalRep.twoPtrValue;
+	copyPtr->typePtr = &casstcl_preparedParameterTclType;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_cql_token -- read the next token of a CQL statement
+ *   into a dynamic string
+ *
+ *   White space and comments are skipped.  Unquoted words are
+ *   folded to lower case, as cassandra does, and double-quoted
+ *   ones are taken as they are.  A bind marker is either a ?,
+ *   which leaves the string empty, or a :name, which leaves the
+ *   name.  Strings, numbers and other constants are literals,
+ *   and anything else is punctuation, one character at a time
+ *   but for the comparison operators of two.
+ *
+ * Results:
+ *      A pointer just past the token, whose type is stored in
+ *      *typePtr; CASSTCL_CQL_ERROR means an unterminated string or
+ *      comment.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static const char *
+casstcl_cql_token (const char *p, int *typePtr, Tcl_DString *dsPtr)
+{
+	Tcl_DStringSetLength (dsPtr, 0);
+
+	for (;;) {
+		while (isspace ((unsigned char)*p)) {
+			p++;
+		}
+
+		if ((p[0] == '-' && p[1] == '-') || (p[0] == '/' && p[1] == '/')) {
+			while (*p != '\0' && *p != '\n') {
+				p++;
+			}
+			continue;
+		}
+
+		if (p[0] == '/' && p[1] == '*') {
+			const char *end = strstr (p + 2, "*/");
+
+			if (end == NULL) {
+				*typePtr = CASSTCL_CQL_ERROR;
+				return p;
+			}
+			p = end + 2;
+			continue;
+		}
+		break;
+	}
+
+	if (*p == '\0') {
+		*typePtr = CASSTCL_CQL_END;
+		return p;
+	}
+
+	// quoted identifiers and strings, the quote being doubled inside them
+	if (*p == '"' || *p == '\'') {
+		char quote = *p;
+
+		for (p++; *p != quote || p[1] == quote; p++) {
+			if (*p == '\0') {
+				*typePtr = CASSTCL_CQL_ERROR;
+				return p;
+			}
+			if (*p == quote) {
+				p++;
+			}
+			Tcl_DStringAppend (dsPtr, p, 1);
+		}
+		*typePtr = (quote == '"') ? CASSTCL_CQL_WORD : CASSTCL_CQL_LITERAL;
+		return p + 1;
+	}
+
+	if (p[0] == '$' && p[1] == '$') {
+		const char *end = strstr (p + 2, "$$");
+
+		if (end == NULL) {
+			*typePtr = CASSTCL_CQL_ERROR;
+			return p;
+		}
+		*typePtr = CASSTCL_CQL_LITERAL;
+		return end + 2;
+	}
+
+	if (*p == '?') {
+		*typePtr = CASSTCL_CQL_MARKER;
+		return p + 1;
+	}
+
+	if (*p == ':' && (isalpha ((unsigned char)p[1]) || p[1] == '_')) {
+		for (p++; isalnum ((unsigned char)*p) || *p == '_'; p++) {
+			char c = tolower ((unsigned char)*p);
+
+			Tcl_DStringAppend (dsPtr, &c, 1);
+		}
+		*typePtr = CASSTCL_CQL_MARKER;
+		return p;
+	}
+
+	if (isalpha ((unsigned char)*p) || *p == '_') {
+		for (; isalnum ((unsigned char)*p) || *p == '_'; p++) {
+			char c = tolower ((unsigned char)*p);
+
+			Tcl_DStringAppend (dsPtr, &c, 1);
+		}
+		*typePtr = CASSTCL_CQL_WORD;
+		return p;
+	}
+
+	// numbers, including exponents, and uuids that start with a digit
+	if (isdigit ((unsigned char)*p) || ((*p == '-' || *p == '.') && isdigit ((unsigned char)p[1]))) {
+		for (p++; isalnum ((unsigned char)*p) || *p == '.' || *p == '-' || (*p == '+' && (p[-1] == 'e' || p[-1] == 'E')); p++) {
+		}
+		*typePtr = CASSTCL_CQL_LITERAL;
+		return p;
+	}
+
+	if ((p[0] == '<' || p[0] == '>' || p[0] == '!') && p[1] == '=') {
+		Tcl_DStringAppend (dsPtr, p, 2);
+		*typePtr = CASSTCL_CQL_PUNCT;
+		return p + 2;
+	}
+
+	Tcl_DStringAppend (dsPtr, p, 1);
+	*typePtr = CASSTCL_CQL_PUNCT;
+	return p + 1;
+}
+
+// see if a token is a given word or piece of punctuation
+#define CASSTCL_CQL_IS(token, tokenType, string) ((token)->type == (tokenType) && strcmp ((token)->text, (string)) == 0)
+
+// see if a token is one of the comparison operators
+#define CASSTCL_CQL_IS_COMPARISON(token) ((token)->type == CASSTCL_CQL_PUNCT && (strcmp ((token)->text, "=") == 0 || strcmp ((token)->text, "<") == 0 || strcmp ((token)->text, ">") == 0 || strcmp ((token)->text, "<=") == 0 || strcmp ((token)->text, ">=") == 0 || strcmp ((token)->text, "!=") == 0))
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_cql_enclosing -- find the bracket that the token at i
+ *   is inside of
+ *
+ *   For a closing bracket this is the bracket it closes.
+ *
+ * Results:
+ *      The index of the opening (, [ or {, or -1 if there isn't
+ *      one; the number of commas between it and the token, at its
+ *      level, is stored in *positionPtr.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_cql_enclosing (casstcl_cqlToken *tokens, int i, int *positionPtr)
+{
+	int depth = 0;
+	int position = 0;
+
+	for (i--; i >= 0; i--) {
+		if (tokens[i].type != CASSTCL_CQL_PUNCT) {
+			continue;
+		}
+
+		if (strchr (")]}", tokens[i].text[0]) != NULL) {
+			depth++;
+		} else if (strchr ("([{", tokens[i].text[0]) != NULL) {
+			if (depth-- == 0) {
+				*positionPtr = position;
+				return i;
+			}
+		} else if (depth == 0 && tokens[i].text[0] == ',') {
+			position++;
+		}
+	}
+	return -1;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_cql_tuple_column -- find a column of a parenthesized
+ *   list of columns, as on the left of a tuple comparison
+ *
+ * Results:
+ *      1 if the list closed by the ) at close has a column at
+ *      position, which is appended to columnPtr; otherwise 0.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_cql_tuple_column (casstcl_cqlToken *tokens, int close, int position, Tcl_DString *columnPtr)
+{
+	int count;
+	int open = casstcl_cql_enclosing (tokens, close, &count);
+	int i;
+
+	if (open < 0 || !CASSTCL_CQL_IS (&tokens[open], CASSTCL_CQL_PUNCT, "(") || close == open + 1 || (close - open) % 2 != 0 || position > count) {
+		return 0;
+	}
+
+	// nothing but columns and the commas between them
+	for (i = open + 1; i < close; i++) {
+		if (((i - open) % 2 == 1) ? (tokens[i].type != CASSTCL_CQL_WORD) : !CASSTCL_CQL_IS (&tokens[i], CASSTCL_CQL_PUNCT, ",")) {
+			return 0;
+		}
+	}
+
+	Tcl_DStringAppend (columnPtr, tokens[open + 1 + position * 2].text, -1);
+	return 1;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_cql_parameter_column -- work out what a bind marker
+ *   that isn't in the VALUES of an INSERT is bound to from the
+ *   tokens around it
+ *
+ *   These are the forms understood, named as cassandra names
+ *   their parameters:
+ *
+ *       column = ?  (or any other comparison), as in SET, WHERE
+ *                   and IF clauses
+ *       column = column + ?  (or -), for collections and counters
+ *       column IN (?, ...)
+ *       (column, ...) = (?, ...)  (or any other comparison, or IN
+ *                   with a list of them)
+ *       TTL ?, TIMESTAMP ?, LIMIT ?  as [ttl], [timestamp], [limit]
+ *       column IN ?  as in(column)
+ *       column CONTAINS ?  as value(column)
+ *       column CONTAINS KEY ?  as key(column)
+ *       column[?] = ?  as key(column) and value(column)
+ *       token(column, ...) > ?  (or any other comparison) as
+ *                   partition key token
+ *
+ * Results:
+ *      1 if the marker is in one of those forms, with what it is
+ *      bound to appended to columnPtr; otherwise 0.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_cql_parameter_column (casstcl_cqlToken *tokens, int i, Tcl_DString *columnPtr)
+{
+	casstcl_cqlToken *prev;
+	int position;
+	int open;
+
+	if (i == 0) {
+		return 0;
+	}
+	prev = &tokens[i - 1];
+
+	if (prev->type == CASSTCL_CQL_WORD) {
+		casstcl_cqlToken *column;
+		const char *form;
+
+		if (strcmp (prev->text, "ttl") == 0) {
+			Tcl_DStringAppend (columnPtr, "[ttl]", -1);
+			return 1;
+		} else if (strcmp (prev->text, "timestamp") == 0) {
+			Tcl_DStringAppend (columnPtr, "[timestamp]", -1);
+			return 1;
+		} else if (strcmp (prev->text, "limit") == 0) {
+			Tcl_DStringAppend (columnPtr, "[limit]", -1);
+			return 1;
+		}
+
+		if (strcmp (prev->text, "key") == 0 && i >= 3 && CASSTCL_CQL_IS (&tokens[i - 2], CASSTCL_CQL_WORD, "contains") && tokens[i - 3].type == CASSTCL_CQL_WORD) {
+			form = "key(";
+			column = &tokens[i - 3];
+		} else if (strcmp (prev->text, "contains") == 0 && i >= 2 && tokens[i - 2].type == CASSTCL_CQL_WORD) {
+			form = "value(";
+			column = &tokens[i - 2];
+		} else if (strcmp (prev->text, "in") == 0 && i >= 2 && tokens[i - 2].type == CASSTCL_CQL_WORD) {
+			form = "in(";
+			column = &tokens[i - 2];
+		} else {
+			return 0;
+		}
+		Tcl_DStringAppend (columnPtr, form, -1);
+		Tcl_DStringAppend (columnPtr, column->text, -1);
+		Tcl_DStringAppend (columnPtr, ")", -1);
+		return 1;
+	}
+
+	if (prev->type != CASSTCL_CQL_PUNCT) {
+		return 0;
+	}
+
+	// the key of a map element or index of a list element
+	if (CASSTCL_CQL_IS (prev, CASSTCL_CQL_PUNCT, "[") && i >= 2 && tokens[i - 2].type == CASSTCL_CQL_WORD && CASSTCL_CQL_IS (&tokens[i + 1], CASSTCL_CQL_PUNCT, "]")) {
+		Tcl_DStringAppend (columnPtr, "key(", -1);
+		Tcl_DStringAppend (columnPtr, tokens[i - 2].text, -1);
+		Tcl_DStringAppend (columnPtr, ")", -1);
+		return 1;
+	}
+
+	if (CASSTCL_CQL_IS_COMPARISON (prev) && i >= 2) {
+		casstcl_cqlToken *left = &tokens[i - 2];
+
+		if (left->type == CASSTCL_CQL_WORD) {
+			Tcl_DStringAppend (columnPtr, left->text, -1);
+			return 1;
+		}
+
+		// column[key] = ?
+		if (CASSTCL_CQL_IS (left, CASSTCL_CQL_PUNCT, "]")) {
+			open = casstcl_cql_enclosing (tokens, i - 2, &position);
+			if (open >= 1 && CASSTCL_CQL_IS (&tokens[open], CASSTCL_CQL_PUNCT, "[") && tokens[open - 1].type == CASSTCL_CQL_WORD) {
+				Tcl_DStringAppend (columnPtr, "value(", -1);
+				Tcl_DStringAppend (columnPtr, tokens[open - 1].text, -1);
+				Tcl_DStringAppend (columnPtr, ")", -1);
+				return 1;
+			}
+		}
+
+		// token(column, ...) > ?
+		if (CASSTCL_CQL_IS (left, CASSTCL_CQL_PUNCT, ")")) {
+			open = casstcl_cql_enclosing (tokens, i - 2, &position);
+			if (open >= 1 && CASSTCL_CQL_IS (&tokens[open], CASSTCL_CQL_PUNCT, "(") && CASSTCL_CQL_IS (&tokens[open - 1], CASSTCL_CQL_WORD, "token")) {
+				Tcl_DStringAppend (columnPtr, "partition key token", -1);
+				return 1;
+			}
+		}
+		return 0;
+	}
+
+	if ((strcmp (prev->text, "+") == 0 || strcmp (prev->text, "-") == 0) && i >= 4 && tokens[i - 2].type == CASSTCL_CQL_WORD && CASSTCL_CQL_IS (&tokens[i - 3], CASSTCL_CQL_PUNCT, "=") && tokens[i - 4].type == CASSTCL_CQL_WORD && strcmp (tokens[i - 4].text, tokens[i - 2].text) == 0) {
+		Tcl_DStringAppend (columnPtr, tokens[i - 2].text, -1);
+		return 1;
+	}
+
+	if (!CASSTCL_CQL_IS (prev, CASSTCL_CQL_PUNCT, "(") && !CASSTCL_CQL_IS (prev, CASSTCL_CQL_PUNCT, ",")) {
+		return 0;
+	}
+
+	// one of a parenthesized list of values
+	open = casstcl_cql_enclosing (tokens, i, &position);
+	if (open < 1 || !CASSTCL_CQL_IS (&tokens[open], CASSTCL_CQL_PUNCT, "(")) {
+		return 0;
+	}
+
+	if (CASSTCL_CQL_IS (&tokens[open - 1], CASSTCL_CQL_WORD, "in") && open >= 2 && tokens[open - 2].type == CASSTCL_CQL_WORD) {
+		Tcl_DStringAppend (columnPtr, tokens[open - 2].text, -1);
+		return 1;
+	}
+
+	// a tuple in the list of an IN is matched up with the columns
+	// on the left of the IN
+	if (CASSTCL_CQL_IS (&tokens[open - 1], CASSTCL_CQL_PUNCT, "(") || CASSTCL_CQL_IS (&tokens[open - 1], CASSTCL_CQL_PUNCT, ",")) {
+		int listPosition;
+		int list = casstcl_cql_enclosing (tokens, open, &listPosition);
+
+		if (list < 1 || !CASSTCL_CQL_IS (&tokens[list], CASSTCL_CQL_PUNCT, "(") || !CASSTCL_CQL_IS (&tokens[list - 1], CASSTCL_CQL_WORD, "in")) {
+			return 0;
+		}
+		open = list;
+	}
+
+	if ((CASSTCL_CQL_IS_COMPARISON (&tokens[open - 1]) || CASSTCL_CQL_IS (&tokens[open - 1], CASSTCL_CQL_WORD, "in")) && open >= 2 && CASSTCL_CQL_IS (&tokens[open - 2], CASSTCL_CQL_PUNCT, ")")) {
+		return casstcl_cql_tuple_column (tokens, open - 2, position, columnPtr);
+	}
+	return 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_cql_select_table -- find the table a SELECT statement
+ *   reads from, the name after its FROM
+ *
+ *   The name is folded as by casstcl_cql_token, and is given as
+ *   keyspace.table if the statement qualifies it.
+ *
+ * Results:
+ *      1 if the statement is a SELECT whose table was found, with
+ *      the name appended to tablePtr; otherwise 0.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_cql_select_table (const char *statement, Tcl_DString *tablePtr)
+{
+	const char *p = statement;
+	Tcl_DString ds;
+	int found = 0;
+	int type;
+
+	Tcl_DStringInit (&ds);
+	p = casstcl_cql_token (p, &type, &ds);
+
+	if (type == CASSTCL_CQL_WORD && strcmp (Tcl_DStringValue (&ds), "select") == 0) {
+		do {
+			p = casstcl_cql_token (p, &type, &ds);
+		} while (type != CASSTCL_CQL_END && type != CASSTCL_CQL_ERROR && !(type == CASSTCL_CQL_WORD && strcmp (Tcl_DStringValue (&ds), "from") == 0));
+
+		if (type == CASSTCL_CQL_WORD) {
+			p = casstcl_cql_token (p, &type, &ds);
+		}
+
+		if (type == CASSTCL_CQL_WORD) {
+			Tcl_DStringAppend (tablePtr, Tcl_DStringValue (&ds), Tcl_DStringLength (&ds));
+			found = 1;
+
+			p = casstcl_cql_token (p, &type, &ds);
+			if (type == CASSTCL_CQL_PUNCT && strcmp (Tcl_DStringValue (&ds), ".") == 0) {
+				p = casstcl_cql_token (p, &type, &ds);
+				if (type == CASSTCL_CQL_WORD) {
+					Tcl_DStringAppend (tablePtr, ".", 1);
+					Tcl_DStringAppend (tablePtr, Tcl_DStringValue (&ds), Tcl_DStringLength (&ds));
+				}
+			}
+		}
+	}
+
+	Tcl_DStringFree (&ds);
+	return found;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_cql_scan_parameters -- find the bind markers of a
+ *   CQL statement and what each of them is bound to
+ *
+ *   Before version 2.3 the cpp-driver doesn't tell us the names
+ *   and types of the parameters of a prepared statement, so they
+ *   are worked out from its text.  The values of an INSERT go with its column
+ *   list by position; see casstcl_cql_parameter_column for the
+ *   other markers.
+ *
+ * Results:
+ *      A standard Tcl result; TCL_ERROR, with nothing in the
+ *      interpreter result, if the statement can't be scanned.
+ *      Otherwise a name and a column is appended to listObj for
+ *      each marker.  The name is the column, or the marker's name
+ *      for a :name; the column is empty if it isn't known.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_cql_scan_parameters (const char *statement, Tcl_Obj *listObj)
+{
+	casstcl_cqlToken *tokens = NULL;
+	const char **valueColumns;
+	int *columnTokens;
+	int nTokens = 0;
+	int nColumns = 0;
+	int tokenSpace = 0;
+	int tclReturn = TCL_OK;
+	const char *p = statement;
+	Tcl_DString ds;
+	int type;
+	int i;
+
+	Tcl_DStringInit (&ds);
+	do {
+		p = casstcl_cql_token (p, &type, &ds);
+		if (type == CASSTCL_CQL_ERROR) {
+			tclReturn = TCL_ERROR;
+			break;
+		}
+
+		if (nTokens == tokenSpace) {
+			tokenSpace = (tokenSpace == 0) ? 32 : tokenSpace * 2;
+			tokens = (casstcl_cqlToken *)ckrealloc ((char *)tokens, sizeof (casstcl_cqlToken) * tokenSpace);
+		}
+		tokens[nTokens].type = type;
+		tokens[nTokens].text = ckalloc (Tcl_DStringLength (&ds) + 1);
+		memcpy (tokens[nTokens].text, Tcl_DStringValue (&ds), Tcl_DStringLength (&ds) + 1);
+		nTokens++;
+	} while (type != CASSTCL_CQL_END);
+	Tcl_DStringFree (&ds);
+
+	if (tclReturn != TCL_OK) {
+		goto done;
+	}
+
+	valueColumns = (const char **)ckalloc (sizeof (const char *) * nTokens);
+	columnTokens = (int *)ckalloc (sizeof (int) * nTokens);
+	memset (valueColumns, 0, sizeof (const char *) * nTokens);
+
+	// INSERT INTO table (column, ...) VALUES (value, ...)
+	if (CASSTCL_CQL_IS (&tokens[0], CASSTCL_CQL_WORD, "insert")) {
+		for (i = 1; tokens[i].type != CASSTCL_CQL_END && !CASSTCL_CQL_IS (&tokens[i], CASSTCL_CQL_PUNCT, "("); i++) {
+		}
+
+		for (i++; tokens[i].type == CASSTCL_CQL_WORD; i += 2) {
+			columnTokens[nColumns++] = i;
+			if (!CASSTCL_CQL_IS (&tokens[i + 1], CASSTCL_CQL_PUNCT, ",")) {
+				i++;
+				break;
+			}
+		}
+
+		if (CASSTCL_CQL_IS (&tokens[i], CASSTCL_CQL_PUNCT, ")") && CASSTCL_CQL_IS (&tokens[i + 1], CASSTCL_CQL_WORD, "values") && CASSTCL_CQL_IS (&tokens[i + 2], CASSTCL_CQL_PUNCT, "(")) {
+			int depth = 0;
+			int position = 0;
+
+			for (i += 3; tokens[i].type != CASSTCL_CQL_END; i++) {
+				casstcl_cqlToken *token = &tokens[i];
+
+				if (token->type == CASSTCL_CQL_MARKER) {
+					if (depth == 0 && position < nColumns) {
+						valueColumns[i] = tokens[columnTokens[position]].text;
+					}
+				} else if (token->type != CASSTCL_CQL_PUNCT) {
+					continue;
+				} else if (strchr ("([{", token->text[0]) != NULL) {
+					depth++;
+				} else if (strchr (")]}", token->text[0]) != NULL) {
+					if (depth-- == 0) {
+						break;
+					}
+				} else if (depth == 0 && token->text[0] == ',') {
+					position++;
+				}
+			}
+		}
+	}
+
+	Tcl_DStringInit (&ds);
+	for (i = 0; i < nTokens; i++) {
+		const char *column = NULL;
+		const char *name;
+
+		if (tokens[i].type != CASSTCL_CQL_MARKER) {
+			continue;
+		}
+
+		Tcl_DStringSetLength (&ds, 0);
+		if (valueColumns[i] != NULL) {
+			column = valueColumns[i];
+		} else if (casstcl_cql_parameter_column (tokens, i, &ds)) {
+			column = Tcl_DStringValue (&ds);
+		}
+
+		// a named marker is known by its name, and is taken to be for
+		// the column of that name if nothing else says which it is for
+		name = (column != NULL) ? column : "";
+		if (tokens[i].text[0] != '\0') {
+			name = tokens[i].text;
+			if (column == NULL) {
+				column = name;
+			}
+		}
+
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj (name, -1));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ((column != NULL) ? column : "", -1));
+	}
+	Tcl_DStringFree (&ds);
+
+	ckfree ((char *)valueColumns);
+	ckfree ((char *)columnTokens);
+
+  done:
+	for (i = 0; i < nTokens; i++) {
+		ckfree (tokens[i].text);
+	}
+	ckfree ((char *)tokens);
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_name_parameter -- give a parameter of a
+ *   prepared statement its name and note which one it names
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_prepared_name_parameter (casstcl_preparedClientData *pcd, int i, const char *name, size_t length)
+{
+	Tcl_HashEntry *hashEntry;
+	int new;
+
+	pcd->parameters[i].name = ckalloc (length + 1);
+	memcpy (pcd->parameters[i].name, name, length);
+	pcd->parameters[i].name[length] = '\0';
+	if (length == 0) {
+		return;
+	}
+
+	// a name used for more than one parameter can't pick one out
+	hashEntry = Tcl_CreateHashEntry (&pcd->parameterHash, pcd->parameters[i].name, &new);
+	Tcl_SetHashValue (hashEntry, (ClientData)(size_t)(new ? i : -1));
+}
+
+#ifdef CASSTCL_HAVE_PARAMETER_TYPES
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_driver_parameters -- take the parameters of
+ *   a newly prepared statement and their types from what the
+ *   cluster told the driver when it was prepared
+ *
+ *   A parameter of a type casstcl can't bind, such as a UDT or
+ *   a collection of collections, is kept with a typeStatus of
+ *   TCL_ERROR.
+ *
+ * Results:
+ *      TCL_OK if the parameters were set up, TCL_ERROR if the
+ *      driver couldn't name them all.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_prepared_driver_parameters (casstcl_preparedClientData *pcd)
+{
+	int nParameters = 0;
+	int i;
+
+	// the driver doesn't count them, but has no type past the last
+	while (cass_prepared_parameter_data_type (pcd->prepared, nParameters) != NULL) {
+		nParameters++;
+	}
+
+	pcd->nParameters = nParameters;
+	pcd->parameters = (casstcl_preparedParameter *)ckalloc (sizeof (casstcl_preparedParameter) * (nParameters + 1));
+
+	for (i = 0; i < nParameters; i++) {
+		casstcl_preparedParameter *parameter = &pcd->parameters[i];
+		const CassDataType *dataType = cass_prepared_parameter_data_type (pcd->prepared, i);
+		Tcl_Obj *typeObj;
+		char *typeString;
+		const char *name;
+		size_t length;
+
+		if (cass_prepared_parameter_name (pcd->prepared, i, &name, &length) != CASS_OK) {
+			// give up on all of them, freeing the ones done so far
+			pcd->nParameters = i;
+			casstcl_prepared_free_parameters (pcd);
+			pcd->nParameters = -1;
+			pcd->parameters = NULL;
+			Tcl_InitHashTable (&pcd->parameterHash, TCL_STRING_KEYS);
+			return TCL_ERROR;
+		}
+		casstcl_prepared_name_parameter (pcd, i, name, length);
+
+		parameter->typeInfo.cassValueType = CASS_VALUE_TYPE_UNKNOWN;
+		parameter->typeInfo.valueSubType1 = CASS_VALUE_TYPE_UNKNOWN;
+		parameter->typeInfo.valueSubType2 = CASS_VALUE_TYPE_UNKNOWN;
+		parameter->typeStatus = casstcl_data_type_to_type_obj (dataType, &parameter->typeInfo, &typeObj);
+
+		Tcl_IncrRefCount (typeObj);
+		typeString = Tcl_GetString (typeObj);
+		parameter->typeString = ckalloc (strlen (typeString) + 1);
+		strcpy (parameter->typeString, typeString);
+		Tcl_DecrRefCount (typeObj);
+	}
+
+	return TCL_OK;
+}
+#endif
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_column_type -- give a parameter the type of
+ *   what casstcl_cql_scan_parameters found it to be bound to
+ *
+ *   Besides a column this may be [ttl], [limit], [timestamp] or
+ *   partition key token, or in(column), key(column) or
+ *   value(column) for a list of values of a column, and for the
+ *   keys and the elements of a collection, a list index being
+ *   its key.
+ *
+ * Results:
+ *      None.  The parameter's typeStatus is TCL_ERROR if the column
+ *      can't be found or its type isn't one casstcl can bind.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_prepared_column_type (casstcl_tableInfo *tableInfo, const char *column, casstcl_preparedParameter *parameter)
+{
+	casstcl_cassTypeInfo *typeInfo = &parameter->typeInfo;
+	casstcl_columnInfo *columnInfo;
+	const char *open = strchr (column, '(');
+	size_t length = strlen (column);
+	Tcl_DString typeString;
+	Tcl_Obj *columnObj;
+
+	parameter->typeStatus = TCL_OK;
+	typeInfo->cassValueType = CASS_VALUE_TYPE_UNKNOWN;
+	typeInfo->valueSubType1 = CASS_VALUE_TYPE_UNKNOWN;
+	typeInfo->valueSubType2 = CASS_VALUE_TYPE_UNKNOWN;
+	Tcl_DStringInit (&typeString);
+
+	if (strcmp (column, "[ttl]") == 0 || strcmp (column, "[limit]") == 0) {
+		typeInfo->cassValueType = CASS_VALUE_TYPE_INT;
+	} else if (strcmp (column, "[timestamp]") == 0 || strcmp (column, "partition key token") == 0) {
+		typeInfo->cassValueType = CASS_VALUE_TYPE_BIGINT;
+	} else if (open != NULL && column[length - 1] == ')') {
+		CassValueType collectionType;
+
+		columnObj = Tcl_NewStringObj (open + 1, length - (open - column) - 2);
+		Tcl_IncrRefCount (columnObj);
+		columnInfo = casstcl_lookup_column (tableInfo, columnObj);
+		Tcl_DecrRefCount (columnObj);
+
+		if (columnInfo == NULL || columnInfo->typeStatus != TCL_OK) {
+			parameter->typeStatus = TCL_ERROR;
+		} else if (strncmp (column, "in(", 3) == 0) {
+			// a list of values of a column that isn't a collection
+			if (columnInfo->typeInfo.valueSubType1 == CASS_VALUE_TYPE_UNKNOWN) {
+				typeInfo->cassValueType = CASS_VALUE_TYPE_LIST;
+				typeInfo->valueSubType1 = columnInfo->typeInfo.cassValueType;
+				Tcl_DStringAppend (&typeString, "list ", -1);
+				Tcl_DStringAppend (&typeString, columnInfo->typeString, -1);
+			} else {
+				parameter->typeStatus = TCL_ERROR;
+			}
+		} else {
+			collectionType = columnInfo->typeInfo.cassValueType;
+
+			if (strncmp (column, "key(", 4) == 0 && collectionType == CASS_VALUE_TYPE_MAP) {
+				typeInfo->cassValueType = columnInfo->typeInfo.valueSubType1;
+			} else if (strncmp (column, "key(", 4) == 0 && collectionType == CASS_VALUE_TYPE_LIST) {
+				typeInfo->cassValueType = CASS_VALUE_TYPE_INT;
+			} else if (strncmp (column, "value(", 6) == 0 && collectionType == CASS_VALUE_TYPE_MAP) {
+				typeInfo->cassValueType = columnInfo->typeInfo.valueSubType2;
+			} else if (strncmp (column, "value(", 6) == 0 && (collectionType == CASS_VALUE_TYPE_LIST || collectionType == CASS_VALUE_TYPE_SET)) {
+				typeInfo->cassValueType = columnInfo->typeInfo.valueSubType1;
+			} else {
+				parameter->typeStatus = TCL_ERROR;
+			}
+		}
+	} else {
+		columnObj = Tcl_NewStringObj (column, -1);
+		Tcl_IncrRefCount (columnObj);
+		columnInfo = casstcl_lookup_column (tableInfo, columnObj);
+		Tcl_DecrRefCount (columnObj);
+
+		if (columnInfo != NULL) {
+			parameter->typeStatus = columnInfo->typeStatus;
+			parameter->typeInfo = columnInfo->typeInfo;
+			Tcl_DStringAppend (&typeString, columnInfo->typeString, -1);
+		} else {
+			parameter->typeStatus = TCL_ERROR;
+		}
+	}
+
+	// a simple type worked out here is named after its value type
+	if (parameter->typeStatus == TCL_OK && Tcl_DStringLength (&typeString) == 0 && typeInfo->cassValueType != CASS_VALUE_TYPE_UNKNOWN) {
+		Tcl_DStringAppend (&typeString, casstcl_cass_value_type_to_string (typeInfo->cassValueType), -1);
+	}
+
+	parameter->typeString = ckalloc (Tcl_DStringLength (&typeString) + 1);
+	strcpy (parameter->typeString, Tcl_DStringValue (&typeString));
+	Tcl_DStringFree (&typeString);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_init_parameters -- work out the parameters
+ *   of a newly prepared statement and their types, so that they
+ *   don't have to be looked up every time it is bound
+ *
+ *   They're taken from the driver when it knows them.  Older
+ *   drivers don't, so they're then worked out from the text of
+ *   the statement and the column types of its table.
+ *
+ *   A parameter whose column can't be found, or is of a type
+ *   casstcl can't bind, is kept with a typeStatus of TCL_ERROR.
+ *   If the statement can't be scanned at all, nParameters is -1
+ *   and the statement can only be bound by name.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_prepared_init_parameters (casstcl_preparedClientData *pcd)
+{
+	Tcl_Obj *listObj;
+	casstcl_tableInfo *tableInfo;
+	Tcl_Obj **listObjv;
+	int listObjc;
+	int i;
+
+	pcd->serial = __atomic_add_fetch (&casstcl_preparedSerial, 1, __ATOMIC_RELAXED);
+	pcd->nParameters = -1;
+	pcd->parameters = NULL;
+	Tcl_InitHashTable (&pcd->parameterHash, TCL_STRING_KEYS);
+
+#ifdef CASSTCL_HAVE_PARAMETER_TYPES
+	if (casstcl_prepared_driver_parameters (pcd) == TCL_OK) {
+		return;
+	}
+#endif
+
+	listObj = Tcl_NewObj ();
+	Tcl_IncrRefCount (listObj);
+	if (casstcl_cql_scan_parameters (pcd->string, listObj) != TCL_OK) {
+		Tcl_DecrRefCount (listObj);
+		return;
+	}
+	Tcl_ListObjGetElements (NULL, listObj, &listObjc, &listObjv);
+
+	tableInfo = casstcl_lookup_table (pcd->ct, Tcl_GetString (pcd->tableNameObj));
+
+	pcd->nParameters = listObjc / 2;
+	pcd->parameters = (casstcl_preparedParameter *)ckalloc (sizeof (casstcl_preparedParameter) * (pcd->nParameters + 1));
+
+	for (i = 0; i < pcd->nParameters; i++) {
+		char *name = Tcl_GetString (listObjv[i * 2]);
+
+		casstcl_prepared_name_parameter (pcd, i, name, strlen (name));
+		casstcl_prepared_column_type (tableInfo, Tcl_GetString (listObjv[i * 2 + 1]), &pcd->parameters[i]);
+	}
+
+	Tcl_DecrRefCount (listObj);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_free_parameters -- free what
+ *   casstcl_prepared_init_parameters worked out
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_prepared_free_parameters (casstcl_preparedClientData *pcd)
+{
+	int i;
+
+	for (i = 0; i < pcd->nParameters; i++) {
+		ckfree (pcd->parameters[i].name);
+		ckfree (pcd->parameters[i].typeString);
+	}
+
+	if (pcd->parameters != NULL) {
+		ckfree ((char *)pcd->parameters);
+	}
+	Tcl_DeleteHashTable (&pcd->parameterHash);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_parameter_index -- find the parameter of a
+ *   prepared statement a Tcl object names
+ *
+ *   The answer is kept in the object, so a name that is used
+ *   over and over with the same statement, such as a literal in
+ *   a procedure, is only looked up once.
+ *
+ * Results:
+ *      The index of the parameter, or -1 if the name isn't that of
+ *      exactly one of the statement's parameters.
+ *
+ * Side effects:
+ *      The object's internal representation may be changed.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_prepared_parameter_index (casstcl_preparedClientData *pcd, Tcl_Obj *nameObj)
+{
+	Tcl_HashEntry *hashEntry;
+	int index = -1;
+
+	if (nameObj->typePtr == &casstcl_preparedParameterTclType && nameObj->internalRep.twoPtrValue.ptr1 == (void *)(size_t)pcd->serial) {
+		return (int)(size_t)nameObj->internalRep.twoPtrValue.ptr2;
+	}
+
+	if (pcd->nParameters <= 0) {
+		return -1;
+	}
+
+	hashEntry = Tcl_FindHashEntry (&pcd->parameterHash, Tcl_GetString (nameObj));
+	if (hashEntry != NULL) {
+		index = (int)(size_t)Tcl_GetHashValue (hashEntry);
+	}
+
+	// the string representation was made above, so the old internal
+	// representation can go
+	if (nameObj->typePtr != NULL && nameObj->typePtr->freeIntRepProc != NULL) {
+		nameObj->typePtr->freeIntRepProc (nameObj);
+	}
+	nameObj->internalRep.twoPtrValue.ptr1 = (void *)(size_t)pcd->serial;
+	nameObj->internalRep.twoPtrValue.ptr2 = (void *)(size_t)index;
+	nameObj->typePtr = &casstcl_preparedParameterTclType;
+
+	return index;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_parameters_obj -- return a Tcl list of the
+ *   name and type of each parameter of a prepared statement, the
+ *   type being empty if it couldn't be worked out
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_prepared_parameters_obj (casstcl_preparedClientData *pcd, Tcl_Obj **objPtr)
+{
+	Tcl_Obj *listObj;
+	int i;
 
-	if (!Tcl_GetCommandInfo (interp, preparedCommandName, &preparedCmdInfo)) {
-		return NULL;
+	if (pcd->nParameters < 0) {
+		Tcl_ResetResult (pcd->ct->interp);
+		Tcl_AppendResult (pcd->ct->interp, "the parameters of the statement couldn't be worked out from its text", NULL);
+		return TCL_ERROR;
 	}
 
-	casstcl_preparedClientData *pcd = (casstcl_preparedClientData *)preparedCmdInfo.objClientData;
-    if (pcd->cass_prepared_magic != CASS_PREPARED_MAGIC) {
-		return NULL;
+	listObj = Tcl_NewObj ();
+	for (i = 0; i < pcd->nParameters; i++) {
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj (pcd->parameters[i].name, -1));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj (pcd->parameters[i].typeString, -1));
 	}
 
-	return pcd;
+	*objPtr = listObj;
+	return TCL_OK;
 }
 
-
 /*
  *----------------------------------------------------------------------
  *
@@ -94,6 +1116,11 @@ casstcl_prepared_command_to_preparedClientData (Tcl_Interp *interp, char *prepar
  *   to prepared statements, and makes things a little easier on the
  *   developer.
  *
+ *   Names that are those of parameters worked out when the statement
+ *   was prepared are bound by index with the type found then; others
+ *   have their type looked up in the statement's table and are bound
+ *   by name.
+ *
  * Results:
  *      A standard Tcl result.
  *
@@ -109,6 +1136,8 @@ casstcl_bind_names_from_prepared (casstcl_preparedClientData *pcd, int objc, Tcl
 	int masterReturn = TCL_OK;
 	int tclReturn = TCL_OK;
 	char *table = Tcl_GetString (pcd->tableNameObj);
+	casstcl_tableInfo *tableInfo = NULL;
+	int haveTableInfo = 0;
 
 	casstcl_cassTypeInfo typeInfo;
 
@@ -118,53 +1147,429 @@ casstcl_bind_names_from_prepared (casstcl_preparedClientData *pcd, int objc, Tcl
 		return TCL_ERROR;
 	}
 
-//printf("objc = %d\n", objc);
 	for (i = 0; i < objc; i += 2) {
-// printf("i = %d, objv[i] = '%s', objc = %d\n", i, Tcl_GetString(objv[i]), objc);
+		Tcl_Obj *valueObj = objv[i+1];
+		int index = casstcl_prepared_parameter_index (pcd, objv[i]);
+
+		if (index >= 0 && pcd->parameters[index].typeStatus == TCL_OK) {
+			casstcl_preparedParameter *parameter = &pcd->parameters[index];
+
+			tclReturn = casstcl_bind_tcl_obj (ct, statement, NULL, 0, index, &parameter->typeInfo, valueObj);
+			if (tclReturn == TCL_ERROR) {
+				Tcl_AppendResult (interp, " while attempting to bind field name of '", parameter->name, "' of type '", parameter->typeString, "' referencing table '", table, "'", NULL);
+				masterReturn = TCL_ERROR;
+				break;
+			}
+			continue;
+		}
+
+		// the table is only looked up if a name needs it
+		if (!haveTableInfo) {
+			tableInfo = casstcl_lookup_table (ct, table);
+			haveTableInfo = 1;
+		}
 
-		tclReturn = casstcl_typename_obj_to_cass_value_types (interp, table, objv[i], &typeInfo);
+		tclReturn = casstcl_lookup_column_type (interp, tableInfo, objv[i], &typeInfo);
 
 		if (tclReturn == TCL_ERROR) {
-//printf ("error from casstcl_obj_to_compound_cass_value_types\n");
 			masterReturn = TCL_ERROR;
 			break;
 		}
 
-		// failed to find it?  in this case it's an error
+		// failed to find it?  then it isn't a column and is ignored
 		if (tclReturn == TCL_CONTINUE) {
-			// Tcl_ResetResult (interp);
-			// Tcl_AppendResult (interp, "couldn't look up data type for column '", Tcl_GetString (objv[i]), "' from table '", table, "'", NULL);
-			// masterReturn = TCL_ERROR;
-			// break;
 			continue;
 		}
 
-		// get the value out of the list
-		Tcl_Obj *valueObj = objv[i+1];
-                int name_length = 0;
+		int name_length = 0;
 		char *name = Tcl_GetStringFromObj (objv[i], &name_length);
 
-// printf("requesting bind by name for '%s', valueType %d\n", name, typeInfo.cassValueTYpe);
 		tclReturn = casstcl_bind_tcl_obj (ct, statement, name, name_length, 0, &typeInfo, valueObj);
-// printf ("tried to bind arg '%s' as type %d %d %d value '%s'\n", name, typeInfo.cassValueType, typeInfo.valueSubType1, typeInfo.valueSubType2, Tcl_GetString(valueObj));
 		if (tclReturn == TCL_ERROR) {
-//printf ("error from casstcl_bind_tcl_obj\n");
 			Tcl_AppendResult (interp, " while attempting to bind field name of '", name, "' of type '", casstcl_cass_value_type_to_string(typeInfo.cassValueType), "' referencing table '", table, "'", NULL);
 			masterReturn = TCL_ERROR;
 			break;
 		}
 	}
 
-//printf("finished the loop, i = %d, objc = %d\n", i, objc);
 	if (masterReturn == TCL_OK) {
-//printf("theoretically got a good statement\n");
 		*statementPtr = statement;
+	} else {
+		cass_statement_free (statement);
 	}
 
-//printf("return code is %d\n", masterReturn);
 	return masterReturn;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_bind_values_from_prepared --
+ *
+ *   binds a list of values into a prepared statement by position
+ *
+ *   takes a prepared statement client data, the values, one for each
+ *   parameter of the statement in the order they appear in it, and a
+ *   pointer to a pointer to a cassandra statement
+ *
+ *   It creates a cassandra statement
+ *
+ *   This is the fast way to bind a prepared statement, as the types of
+ *   the parameters were worked out when it was prepared and nothing has
+ *   to be looked up by name.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_bind_values_from_prepared (casstcl_preparedClientData *pcd, int objc, Tcl_Obj *CONST objv[], CassConsistency *consistencyPtr, CassStatement **statementPtr)
+{
+	Tcl_Interp *interp = pcd->ct->interp;
+	casstcl_sessionClientData *ct = pcd->ct;
+	CassStatement *statement;
+	char number[TCL_INTEGER_SPACE];
+	int i;
+
+	*statementPtr = NULL;
+
+	if (pcd->nParameters < 0) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "the parameters of the statement couldn't be worked out from its text, bind its values by name instead", NULL);
+		return TCL_ERROR;
+	}
+
+	if (objc != pcd->nParameters) {
+		char expected[TCL_INTEGER_SPACE];
+
+		sprintf (expected, "%d", pcd->nParameters);
+		sprintf (number, "%d", objc);
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "wrong number of values for prepared statement: expected ", expected, ", got ", number, NULL);
+		return TCL_ERROR;
+	}
+
+	for (i = 0; i < objc; i++) {
+		if (pcd->parameters[i].typeStatus != TCL_OK) {
+			sprintf (number, "%d", i + 1);
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "the type of parameter ", number, " ('", pcd->parameters[i].name, "') of the statement isn't known, bind its values by name instead", NULL);
+			return TCL_ERROR;
+		}
+	}
+
+	statement = cass_prepared_bind (pcd->prepared);
+
+	if (casstcl_setStatementConsistency(ct, statement, consistencyPtr) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	for (i = 0; i < objc; i++) {
+		casstcl_preparedParameter *parameter = &pcd->parameters[i];
+
+		if (casstcl_bind_tcl_obj (ct, statement, NULL, 0, i, &parameter->typeInfo, objv[i]) == TCL_ERROR) {
+			sprintf (number, "%d", i + 1);
+			Tcl_AppendResult (interp, " while attempting to bind value ", number, " ('", parameter->name, "') of type '", parameter->typeString, "' referencing table '", Tcl_GetString (pcd->tableNameObj), "'", NULL);
+			cass_statement_free (statement);
+			return TCL_ERROR;
+		}
+	}
+
+	*statementPtr = statement;
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_init -- initialize a session's cache of
+ *   prepared statements, keyed on the text of the statement, and
+ *   set the maximum number of entries it may hold
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_prepared_cache_init (casstcl_preparedCache *cache, int limit)
+{
+	Tcl_InitHashTable (&cache->hashTable, TCL_STRING_KEYS);
+	cache->head = NULL;
+	cache->tail = NULL;
+	cache->size = 0;
+	cache->limit = limit;
+	cache->hits = 0;
+	cache->misses = 0;
+	cache->evictions = 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_unlink -- remove an entry from the most
+ *   recently used list of the cache without freeing it
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_prepared_cache_unlink (casstcl_preparedCache *cache, casstcl_preparedCacheEntry *entry)
+{
+	if (entry->prev != NULL) {
+		entry->prev->next = entry->next;
+	} else {
+		cache->head = entry->next;
+	}
+
+	if (entry->next != NULL) {
+		entry->next->prev = entry->prev;
+	} else {
+		cache->tail = entry->prev;
+	}
+
+	entry->prev = NULL;
+	entry->next = NULL;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_remove -- remove an entry from the cache,
+ *   releasing the prepared statement and freeing the entry
+ *
+ *   Statements previously bound from the prepared statement hold
+ *   their own reference to it within the driver and remain valid.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_prepared_cache_remove (casstcl_preparedCache *cache, casstcl_preparedCacheEntry *entry)
+{
+	casstcl_prepared_cache_unlink (cache, entry);
+	Tcl_DeleteHashEntry (entry->hashEntry);
+	cass_prepared_free (entry->prepared);
+	ckfree ((char *)entry);
+	cache->size--;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_flush -- release every prepared statement
+ *   held in the cache.  The counters are left alone.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_prepared_cache_flush (casstcl_preparedCache *cache)
+{
+	while (cache->head != NULL) {
+		casstcl_prepared_cache_remove (cache, cache->head);
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_free -- release every prepared statement
+ *   held in the cache and free the cache's hash table
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_prepared_cache_free (casstcl_preparedCache *cache)
+{
+	casstcl_prepared_cache_flush (cache);
+	Tcl_DeleteHashTable (&cache->hashTable);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_set_limit -- set the maximum number of
+ *   entries the cache may hold, evicting the least recently used
+ *   entries if it is currently holding more than that
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_prepared_cache_set_limit (casstcl_preparedCache *cache, int limit)
+{
+	cache->limit = limit;
+
+	while (cache->size > cache->limit && cache->tail != NULL) {
+		casstcl_prepared_cache_remove (cache, cache->tail);
+		cache->evictions++;
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_lookup -- given a session and the text of
+ *   a statement, find the prepared statement for it in the session's
+ *   cache, preparing it (synchronously) and adding it to the cache if
+ *   it isn't there
+ *
+ *   If the cache is disabled (its limit is zero), the caller's pointer
+ *   is set to NULL and the caller should fall back to an unprepared
+ *   statement.
+ *
+ *   The cache retains ownership of the prepared statement; the caller
+ *   should only use it to cass_prepared_bind a new statement.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      The least recently used entry may be evicted.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_prepared_cache_lookup (casstcl_sessionClientData *ct, const char *query, const CassPrepared **preparedPtr)
+{
+	casstcl_preparedCache *cache = &ct->preparedCache;
+	casstcl_preparedCacheEntry *entry;
+	Tcl_HashEntry *hashEntry;
+	CassFuture *future;
+	CassError rc;
+	int new;
+
+	*preparedPtr = NULL;
+
+	if (cache->limit <= 0) {
+		return TCL_OK;
+	}
+
+	hashEntry = Tcl_FindHashEntry (&cache->hashTable, query);
+	if (hashEntry != NULL) {
+		entry = (casstcl_preparedCacheEntry *)Tcl_GetHashValue (hashEntry);
+
+		// move it to the front of the most recently used list
+		if (entry != cache->head) {
+			casstcl_prepared_cache_unlink (cache, entry);
+			entry->next = cache->head;
+			cache->head->prev = entry;
+			cache->head = entry;
+		}
+
+		cache->hits++;
+		*preparedPtr = entry->prepared;
+		return TCL_OK;
+	}
+
+	cache->misses++;
+
+	future = cass_session_prepare (ct->session, query);
+	cass_future_wait (future);
+
+	rc = cass_future_error_code (future);
+	if (rc != CASS_OK) {
+		casstcl_future_error_to_tcl (ct, rc, future);
+		cass_future_free (future);
+		Tcl_AppendResult (ct->interp, " while attempting to prepare statement '", query, "'", NULL);
+		return TCL_ERROR;
+	}
+
+	entry = (casstcl_preparedCacheEntry *)ckalloc (sizeof (casstcl_preparedCacheEntry));
+	entry->prepared = cass_future_get_prepared (future);
+	cass_future_free (future);
+
+	// make room for it if the cache is full
+	while (cache->size >= cache->limit && cache->tail != NULL) {
+		casstcl_prepared_cache_remove (cache, cache->tail);
+		cache->evictions++;
+	}
+
+	entry->hashEntry = Tcl_CreateHashEntry (&cache->hashTable, query, &new);
+	Tcl_SetHashValue (entry->hashEntry, entry);
+
+	entry->prev = NULL;
+	entry->next = cache->head;
+	if (cache->head != NULL) {
+		cache->head->prev = entry;
+	} else {
+		cache->tail = entry;
+	}
+	cache->head = entry;
+	cache->size++;
+
+	*preparedPtr = entry->prepared;
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_stats_obj -- return a Tcl list of key-value
+ *   pairs describing the state of a prepared statement cache
+ *
+ * Results:
+ *      A new Tcl object.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *
+casstcl_prepared_cache_stats_obj (casstcl_preparedCache *cache)
+{
+	Tcl_Obj *listObjv[10];
+
+	listObjv[0] = Tcl_NewStringObj ("size", -1);
+	listObjv[1] = Tcl_NewIntObj (cache->size);
+
+	listObjv[2] = Tcl_NewStringObj ("limit", -1);
+	listObjv[3] = Tcl_NewIntObj (cache->limit);
+
+	listObjv[4] = Tcl_NewStringObj ("hits", -1);
+	listObjv[5] = Tcl_NewWideIntObj (cache->hits);
+
+	listObjv[6] = Tcl_NewStringObj ("misses", -1);
+	listObjv[7] = Tcl_NewWideIntObj (cache->misses);
+
+	listObjv[8] = Tcl_NewStringObj ("evictions", -1);
+	listObjv[9] = Tcl_NewWideIntObj (cache->evictions);
+
+	return Tcl_NewListObj (10, listObjv);
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -187,12 +1592,14 @@ casstcl_preparedObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 
     static CONST char *options[] = {
         "statement",
+        "parameters",
         "delete",
         NULL
     };
 
     enum options {
 		OPT_STATEMENT,
+		OPT_PARAMETERS,
 		OPT_DELETE
     };
 
@@ -216,6 +1623,20 @@ casstcl_preparedObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl
 
 			break;
 		}
+		case OPT_PARAMETERS: {
+			Tcl_Obj *listObj;
+
+			if (objc != 2) {
+				Tcl_WrongNumArgs (interp, 2, objv, "");
+				return TCL_ERROR;
+			}
+
+			if (casstcl_prepared_parameters_obj (pcd, &listObj) != TCL_OK) {
+				return TCL_ERROR;
+			}
+			Tcl_SetObjResult (interp, listObj);
+			break;
+		}
 		case OPT_DELETE: {
 			if (objc != 2) {
 				Tcl_WrongNumArgs (interp, 2, objv, "");
@@ -231,4 +1652,64 @@ casstcl_preparedObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl
     return resultCode;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_createPreparedObjectCommand --
+ *
+ *    given a casstcl_sessionClientData pointer, an object name (or
+ *    "#auto"), the table the statement refers to, the statement and what
+ *    the driver prepared from it, create a corresponding prepared object
+ *    command, which takes over the CassPrepared
+ *
+ * Results:
+ *    A standard Tcl result
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_createPreparedObjectCommand (casstcl_sessionClientData *ct, char *commandName, Tcl_Obj *tableNameObj, Tcl_Obj *statementObj, const CassPrepared *cassPrepared)
+{
+	Tcl_Interp *interp = ct->interp;
+	char *statementString;
+	int statementStringLength;
+
+	// allocate one of our cass prepared data objects for Tcl
+	// and configure it
+	casstcl_preparedClientData *pcd = (casstcl_preparedClientData *)ckalloc (sizeof (casstcl_preparedClientData));
+
+	pcd->cass_prepared_magic = CASS_PREPARED_MAGIC;
+	pcd->ct = ct;
+	pcd->prepared = cassPrepared;
+
+	statementString = Tcl_GetStringFromObj (statementObj, &statementStringLength);
+	pcd->string = ckalloc (statementStringLength + 1);
+	memcpy (pcd->string, statementString, statementStringLength + 1);
+
+	pcd->tableNameObj = tableNameObj;
+	Tcl_IncrRefCount (pcd->tableNameObj);
+
+	casstcl_prepared_init_parameters (pcd);
+
+#define PREPARED_STRING_FORMAT "prepared%lu"
+	// if commandName is #auto, generate a unique name for the object
+	int autoGeneratedName = 0;
+	if (strcmp (commandName, "#auto") == 0) {
+		static unsigned long nextAutoCounter = 0;
+		int baseNameLength = snprintf (NULL, 0, PREPARED_STRING_FORMAT, nextAutoCounter) + 1;
+		commandName = ckalloc (baseNameLength);
+		snprintf (commandName, baseNameLength, PREPARED_STRING_FORMAT, nextAutoCounter++);
+		autoGeneratedName = 1;
+	}
+
+	// create a Tcl command to interface to cass
+	pcd->cmdToken = Tcl_CreateObjCommand (interp, commandName, casstcl_preparedObjectObjCmd, pcd, casstcl_preparedObjectDelete);
+	Tcl_SetObjResult (interp, Tcl_NewStringObj (commandName, -1));
+	if (autoGeneratedName == 1) {
+		ckfree(commandName);
+	}
+
+	return TCL_OK;
+}
+
 /* vim: set ts=4 sw=4 sts=4 noet : */
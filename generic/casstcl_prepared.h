@@ -25,6 +25,65 @@
  */
 casstcl_preparedClientData * casstcl_prepared_command_to_preparedClientData (Tcl_Interp *interp, char *preparedCommandName);
 
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_cql_select_table -- find the table a SELECT statement
+ *   reads from, the name after its FROM
+ *
+ *   The name is folded as by casstcl_cql_token, and is given as
+ *   keyspace.table if the statement qualifies it.
+ *
+ * Results:
+ *      1 if the statement is a SELECT whose table was found, with
+ *      the name appended to tablePtr; otherwise 0.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_cql_select_table (const char *statement, Tcl_DString *tablePtr);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_init_parameters -- work out the parameters
+ *   of a newly prepared statement and their types, from its
+ *   text and the column types of its table, so that they don't
+ *   have to be looked up every time it is bound
+ *
+ *   A parameter whose column can't be found, or is of a type
+ *   casstcl can't bind, is kept with a typeStatus of TCL_ERROR.
+ *   If the statement can't be scanned at all, nParameters is -1
+ *   and the statement can only be bound by name.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_prepared_init_parameters (casstcl_preparedClientData *pcd);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_free_parameters -- free what
+ *   casstcl_prepared_init_parameters worked out
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_prepared_free_parameters (casstcl_preparedClientData *pcd);
+
 /*
  *--------------------------------------------------------------
  *
@@ -72,6 +131,31 @@ int casstcl_bind_names_from_prepared (
 	Tcl_Obj *CONST objv[], 
 	CassConsistency *consistencyPtr, 
 	CassStatement **statementPtr);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_bind_values_from_prepared --
+ *
+ *   binds a list of values into a prepared statement by position
+ *
+ *   takes a prepared statement client data, the values, one for each
+ *   parameter of the statement in the order they appear in it, and a
+ *   pointer to a pointer to a cassandra statement
+ *
+ *   It creates a cassandra statement
+ *
+ *   This is the fast way to bind a prepared statement, as the types of
+ *   the parameters were worked out when it was prepared and nothing has
+ *   to be looked up by name.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_bind_values_from_prepared (casstcl_preparedClientData *pcd, int objc, Tcl_Obj *CONST objv[], CassConsistency *consistencyPtr, CassStatement **statementPtr);
+
 /*
  *----------------------------------------------------------------------
  *
@@ -87,4 +171,126 @@ int casstcl_bind_names_from_prepared (
  */
 int casstcl_preparedObjectObjCmd(ClientData cData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]);
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_createPreparedObjectCommand --
+ *
+ *    given a casstcl_sessionClientData pointer, an object name (or
+ *    "#auto"), the table the statement refers to, the statement and what
+ *    the driver prepared from it, create a corresponding prepared object
+ *    command, which takes over the CassPrepared
+ *
+ * Results:
+ *    A standard Tcl result
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_createPreparedObjectCommand (casstcl_sessionClientData *ct, char *commandName, Tcl_Obj *tableNameObj, Tcl_Obj *statementObj, const CassPrepared *cassPrepared);
+
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_init -- initialize a session's cache of
+ *   prepared statements, keyed on the text of the statement, and
+ *   set the maximum number of entries it may hold
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_prepared_cache_init (casstcl_preparedCache *cache, int limit);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_flush -- release every prepared statement
+ *   held in the cache.  The counters are left alone.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_prepared_cache_flush (casstcl_preparedCache *cache);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_free -- release every prepared statement
+ *   held in the cache and free the cache's hash table
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_prepared_cache_free (casstcl_preparedCache *cache);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_set_limit -- set the maximum number of
+ *   entries the cache may hold, evicting the least recently used
+ *   entries if it is currently holding more than that
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_prepared_cache_set_limit (casstcl_preparedCache *cache, int limit);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_lookup -- given a session and the text of
+ *   a statement, find the prepared statement for it in the session's
+ *   cache, preparing it (synchronously) and adding it to the cache if
+ *   it isn't there
+ *
+ *   If the cache is disabled (its limit is zero), the caller's pointer
+ *   is set to NULL and the caller should fall back to an unprepared
+ *   statement.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      The least recently used entry may be evicted.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_prepared_cache_lookup (casstcl_sessionClientData *ct, const char *query, const CassPrepared **preparedPtr);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_prepared_cache_stats_obj -- return a Tcl list of key-value
+ *   pairs describing the state of a prepared statement cache
+ *
+ * Results:
+ *      A new Tcl object.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *casstcl_prepared_cache_stats_obj (casstcl_preparedCache *cache);
+
 /* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,415 @@
+/*
+ * casstcl_result - Functions for delivering whole pages of result rows
+ *                  to Tcl as lists of lists or lists of dicts
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_result.h"
+#include "casstcl_types.h"
+
+#include <assert.h>
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_column_names -- create a Tcl object for the
+ *   name of each column of a result
+ *
+ *   The objects are created once so that every row built from
+ *   this result, and from further pages of the same query, can
+ *   share them rather than making new copies of the names.
+ *
+ * Results:
+ *      A ckalloc'ed vector of column name objects, each holding
+ *      a reference, and the number of columns in *countPtr.  Free
+ *      it with casstcl_free_column_names.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj **
+casstcl_result_column_names (const CassResult *result, int *countPtr)
+{
+	int columnCount = cass_result_column_count (result);
+	Tcl_Obj **names = (Tcl_Obj **)ckalloc (sizeof (Tcl_Obj *) * (columnCount + 1));
+	int i;
+
+	for (i = 0; i < columnCount; i++) {
+		CassString cassNameString;
+
+		cass_result_column_name (result, i, &cassNameString.data, &cassNameString.length);
+		names[i] = Tcl_NewStringObj (cassNameString.data, cassNameString.length);
+		Tcl_IncrRefCount (names[i]);
+	}
+
+	*countPtr = columnCount;
+	return names;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_free_column_names -- release the column name objects
+ *   created by casstcl_result_column_names
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_free_column_names (Tcl_Obj **names, int count)
+{
+	int i;
+
+	if (names == NULL) {
+		return;
+	}
+
+	for (i = 0; i < count; i++) {
+		Tcl_DecrRefCount (names[i]);
+	}
+	ckfree ((char *)names);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_ref_new -- wrap a result the caller got from
+ *   a future so that it can be shared
+ *
+ *   Rows are converted from the reference rather than the bare
+ *   result so that blob values can point into the result's
+ *   buffer instead of being copied out of it; each of those
+ *   holds a reference of its own.
+ *
+ * Results:
+ *      A reference holding the result, with a count of one that
+ *      belongs to the caller.  Drop it with
+ *      casstcl_result_ref_release rather than freeing the result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_resultRef *
+casstcl_result_ref_new (const CassResult *result)
+{
+	casstcl_resultRef *ref = (casstcl_resultRef *)ckalloc (sizeof (casstcl_resultRef));
+
+	ref->result = result;
+	ref->refCount = 1;
+	return ref;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_ref_retain -- add a reference to a shared result
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_result_ref_retain (casstcl_resultRef *ref)
+{
+	ref->refCount++;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_ref_release -- drop a reference to a shared
+ *   result
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The result is freed when its last reference is dropped.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_result_ref_release (casstcl_resultRef *ref)
+{
+	assert (ref->refCount > 0);
+
+	if (--ref->refCount == 0) {
+		cass_result_free (ref->result);
+		ckfree ((char *)ref);
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_rows_to_obj -- convert all of the rows of a
+ *   result (one page) into a single Tcl list
+ *
+ *   With CASSTCL_ROWS_LIST each row is a list of the column
+ *   values in column order, null values being empty strings so
+ *   that the positions line up with the column names.  With
+ *   CASSTCL_ROWS_DICT each row is a dict of column names and
+ *   values, null values being left out, the same as they are
+ *   left out of the array filled by select.
+ *
+ *   The lists are created at their final size and the column
+ *   name objects passed in are shared by every row.  Large blobs
+ *   may refer to the result, see casstcl_cass_value_to_tcl_obj.
+ *
+ * Results:
+ *      A standard Tcl result; on success *rowsObjPtr is set to
+ *      a new, unshared list object with one element per row.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_result_rows_to_obj (casstcl_sessionClientData *ct, casstcl_resultRef *resultRef, Tcl_Obj **names, int columnCount, int rowStyle, Tcl_Obj **rowsObjPtr)
+{
+	const CassResult *result = resultRef->result;
+	casstcl_resultRef *savedBlobSource = ct->blobSource;
+	int rowCount = cass_result_row_count (result);
+	Tcl_Obj **rowObjs = (Tcl_Obj **)ckalloc (sizeof (Tcl_Obj *) * (rowCount + 1));
+	Tcl_Obj **valueObjs = (Tcl_Obj **)ckalloc (sizeof (Tcl_Obj *) * (columnCount + 1));
+	Tcl_Obj *emptyObj = NULL;
+	CassIterator* iterator = cass_iterator_from_result (result);
+	int tclReturn = TCL_OK;
+	int nRows = 0;
+
+	assert (rowStyle == CASSTCL_ROWS_LIST || rowStyle == CASSTCL_ROWS_DICT);
+
+	ct->blobSource = resultRef;
+
+	while (nRows < rowCount && cass_iterator_next (iterator)) {
+		const CassRow* row = cass_iterator_get_row (iterator);
+		int nValues = 0;
+		int i;
+
+		for (i = 0; i < columnCount; i++) {
+			Tcl_Obj *newObj = NULL;
+			const CassValue *columnValue = cass_row_get_column (row, i);
+
+			if (!cass_value_is_null (columnValue)) {
+				if (casstcl_cass_value_to_tcl_obj (ct, columnValue, &newObj) == TCL_ERROR) {
+					tclReturn = TCL_ERROR;
+					break;
+				}
+			}
+
+			// a list row needs a placeholder for a null; one empty
+			// object is shared by all of them
+			if (newObj == NULL && rowStyle == CASSTCL_ROWS_LIST) {
+				if (emptyObj == NULL) {
+					emptyObj = Tcl_NewObj ();
+					Tcl_IncrRefCount (emptyObj);
+				}
+				newObj = emptyObj;
+			}
+			valueObjs[nValues++] = newObj;
+		}
+
+		if (tclReturn == TCL_ERROR) {
+			for (i = 0; i < nValues; i++) {
+				if (valueObjs[i] != NULL && valueObjs[i] != emptyObj) {
+					Tcl_IncrRefCount (valueObjs[i]);
+					Tcl_DecrRefCount (valueObjs[i]);
+				}
+			}
+			break;
+		}
+
+		if (rowStyle == CASSTCL_ROWS_LIST) {
+			rowObjs[nRows++] = Tcl_NewListObj (nValues, valueObjs);
+		} else {
+			Tcl_Obj *dictObj = Tcl_NewDictObj ();
+
+			for (i = 0; i < nValues; i++) {
+				if (valueObjs[i] != NULL) {
+					Tcl_DictObjPut (NULL, dictObj, names[i], valueObjs[i]);
+				}
+			}
+			rowObjs[nRows++] = dictObj;
+		}
+	}
+
+	cass_iterator_free (iterator);
+	ct->blobSource = savedBlobSource;
+
+	if (tclReturn == TCL_OK) {
+		*rowsObjPtr = Tcl_NewListObj (nRows, rowObjs);
+	} else {
+		int i;
+
+		for (i = 0; i < nRows; i++) {
+			Tcl_IncrRefCount (rowObjs[i]);
+			Tcl_DecrRefCount (rowObjs[i]);
+		}
+	}
+
+	if (emptyObj != NULL) {
+		Tcl_DecrRefCount (emptyObj);
+	}
+
+	ckfree ((char *)valueObjs);
+	ckfree ((char *)rowObjs);
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_rows_to_array -- fill an array with each row
+ *   of a result (one page) in turn and execute code against it
+ *
+ *   The array elements are set through the shared column name
+ *   objects and an array name object that lives for the whole
+ *   loop, so that neither has to be converted from a C string
+ *   again for every row.  Null values are unset from the array.
+ *
+ * Results:
+ *      TCL_OK if all of the rows were processed, TCL_BREAK if the
+ *      code did a break (which the caller should not pass on),
+ *      TCL_RETURN if it did a return, or TCL_ERROR.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_result_rows_to_array (casstcl_sessionClientData *ct, casstcl_resultRef *resultRef, Tcl_Obj **names, int columnCount, Tcl_Obj *arrayNameObj, Tcl_Obj *codeObj)
+{
+	Tcl_Interp *interp = ct->interp;
+	CassIterator* iterator = cass_iterator_from_result (resultRef->result);
+	casstcl_resultRef *savedBlobSource = ct->blobSource;
+	char *arrayName = Tcl_GetString (arrayNameObj);
+	int tclReturn = TCL_OK;
+
+	// queries made by the code body set and restore their own source
+	ct->blobSource = resultRef;
+
+	while (tclReturn == TCL_OK && cass_iterator_next (iterator)) {
+		const CassRow* row = cass_iterator_get_row (iterator);
+		int i;
+
+		// process all the columns into the tcl array
+		for (i = 0; i < columnCount; i++) {
+			Tcl_Obj *newObj = NULL;
+			const CassValue *columnValue = cass_row_get_column (row, i);
+
+			if (!cass_value_is_null (columnValue)) {
+				if (casstcl_cass_value_to_tcl_obj (ct, columnValue, &newObj) == TCL_ERROR) {
+					tclReturn = TCL_ERROR;
+					break;
+				}
+			}
+
+			if (newObj == NULL) {
+				Tcl_UnsetVar2 (interp, arrayName, Tcl_GetString (names[i]), 0);
+			} else if (Tcl_ObjSetVar2 (interp, arrayNameObj, names[i], newObj, (TCL_LEAVE_ERR_MSG)) == NULL) {
+				tclReturn = TCL_ERROR;
+				break;
+			}
+		}
+
+		if (tclReturn != TCL_OK) {
+			break;
+		}
+
+		// now execute the code body.  continue is the same as ok
+		// as far as we're concerned; break, return and error
+		// stop us and are handed to our caller to sort out.
+		int evalReturnCode = Tcl_EvalObjEx (interp, codeObj, 0);
+		if ((evalReturnCode != TCL_OK) && (evalReturnCode != TCL_CONTINUE)) {
+			tclReturn = evalReturnCode;
+
+			if (evalReturnCode == TCL_ERROR) {
+				char        msg[60];
+
+				sprintf(msg, "\n    (\"select\" body line %d)",
+						Tcl_GetErrorLine(interp));
+				Tcl_AddErrorInfo(interp, msg);
+			}
+		}
+	}
+
+	cass_iterator_free (iterator);
+	ct->blobSource = savedBlobSource;
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_eval_page -- hand one page of a result to the
+ *   body of a select
+ *
+ *   With CASSTCL_ROWS_ARRAY the named array is filled with each
+ *   row in turn and the code executed for each.  Otherwise the
+ *   named variable is set to all of the rows of the page, as a
+ *   list of lists or of dicts, and the code executed once.
+ *
+ * Results:
+ *      The code of the last evaluation of the body, or TCL_ERROR.
+ *      TCL_OK and TCL_CONTINUE mean the caller should carry on with
+ *      the next page; the others mean it should stop.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_result_eval_page (casstcl_sessionClientData *ct, casstcl_resultRef *resultRef, Tcl_Obj **names, int columnCount, int rowStyle, Tcl_Obj *varNameObj, Tcl_Obj *codeObj)
+{
+	Tcl_Interp *interp = ct->interp;
+	Tcl_Obj *rowsObj = NULL;
+	int evalReturnCode;
+
+	if (rowStyle == CASSTCL_ROWS_ARRAY) {
+		return casstcl_result_rows_to_array (ct, resultRef, names, columnCount, varNameObj, codeObj);
+	}
+
+	if (casstcl_result_rows_to_obj (ct, resultRef, names, columnCount, rowStyle, &rowsObj) == TCL_ERROR) {
+		return TCL_ERROR;
+	}
+
+	if (Tcl_ObjSetVar2 (interp, varNameObj, NULL, rowsObj, (TCL_LEAVE_ERR_MSG)) == NULL) {
+		return TCL_ERROR;
+	}
+
+	evalReturnCode = Tcl_EvalObjEx (interp, codeObj, 0);
+
+	if (evalReturnCode == TCL_ERROR) {
+		char        msg[60];
+
+		sprintf(msg, "\n    (\"select\" body line %d)",
+				Tcl_GetErrorLine(interp));
+		Tcl_AddErrorInfo(interp, msg);
+	}
+
+	return evalReturnCode;
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
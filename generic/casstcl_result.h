@@ -0,0 +1,178 @@
+/*
+ *
+ * Include file for casstcl_result
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_column_names -- create a Tcl object for the
+ *   name of each column of a result
+ *
+ *   The objects are created once so that every row built from
+ *   this result, and from further pages of the same query, can
+ *   share them rather than making new copies of the names.
+ *
+ * Results:
+ *      A ckalloc'ed vector of column name objects, each holding
+ *      a reference, and the number of columns in *countPtr.  Free
+ *      it with casstcl_free_column_names.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj **casstcl_result_column_names (const CassResult *result, int *countPtr);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_free_column_names -- release the column name objects
+ *   created by casstcl_result_column_names
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_free_column_names (Tcl_Obj **names, int count);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_ref_new -- wrap a result the caller got from
+ *   a future so that it can be shared
+ *
+ *   Rows are converted from the reference rather than the bare
+ *   result so that blob values can point into the result's
+ *   buffer instead of being copied out of it; each of those
+ *   holds a reference of its own.
+ *
+ * Results:
+ *      A reference holding the result, with a count of one that
+ *      belongs to the caller.  Drop it with
+ *      casstcl_result_ref_release rather than freeing the result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_resultRef *casstcl_result_ref_new (const CassResult *result);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_ref_retain -- add a reference to a shared result
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_result_ref_retain (casstcl_resultRef *ref);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_ref_release -- drop a reference to a shared
+ *   result
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The result is freed when its last reference is dropped.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_result_ref_release (casstcl_resultRef *ref);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_rows_to_obj -- convert all of the rows of a
+ *   result (one page) into a single Tcl list
+ *
+ *   With CASSTCL_ROWS_LIST each row is a list of the column
+ *   values in column order, null values being empty strings so
+ *   that the positions line up with the column names.  With
+ *   CASSTCL_ROWS_DICT each row is a dict of column names and
+ *   values, null values being left out, the same as they are
+ *   left out of the array filled by select.
+ *
+ *   The lists are created at their final size and the column
+ *   name objects passed in are shared by every row.  Large blobs
+ *   may refer to the result, see casstcl_cass_value_to_tcl_obj.
+ *
+ * Results:
+ *      A standard Tcl result; on success *rowsObjPtr is set to
+ *      a new, unshared list object with one element per row.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_result_rows_to_obj (casstcl_sessionClientData *ct, casstcl_resultRef *resultRef, Tcl_Obj **names, int columnCount, int rowStyle, Tcl_Obj **rowsObjPtr);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_rows_to_array -- fill an array with each row
+ *   of a result (one page) in turn and execute code against it
+ *
+ *   The array elements are set through the shared column name
+ *   objects and an array name object that lives for the whole
+ *   loop, so that neither has to be converted from a C string
+ *   again for every row.  Null values are unset from the array.
+ *
+ * Results:
+ *      TCL_OK if all of the rows were processed, TCL_BREAK if the
+ *      code did a break (which the caller should not pass on),
+ *      TCL_RETURN if it did a return, or TCL_ERROR.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_result_rows_to_array (casstcl_sessionClientData *ct, casstcl_resultRef *resultRef, Tcl_Obj **names, int columnCount, Tcl_Obj *arrayNameObj, Tcl_Obj *codeObj);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_result_eval_page -- hand one page of a result to the
+ *   body of a select
+ *
+ *   With CASSTCL_ROWS_ARRAY the named array is filled with each
+ *   row in turn and the code executed for each.  Otherwise the
+ *   named variable is set to all of the rows of the page, as a
+ *   list of lists or of dicts, and the code executed once.
+ *
+ * Results:
+ *      The code of the last evaluation of the body, or TCL_ERROR.
+ *      TCL_OK and TCL_CONTINUE mean the caller should carry on with
+ *      the next page; the others mean it should stop.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_result_eval_page (casstcl_sessionClientData *ct, casstcl_resultRef *resultRef, Tcl_Obj **names, int columnCount, int rowStyle, Tcl_Obj *varNameObj, Tcl_Obj *codeObj);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,975 @@
+/*
+ * casstcl_rowcache - Functions for the row cache, which keeps the rows of
+ *                    repeated point reads so that they don't have to go to
+ *                    the cluster again
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_rowcache.h"
+#include "casstcl_prepared.h"
+#include "casstcl_result.h"
+
+#include <assert.h>
+#include <ctype.h>
+
+// what a dict entry costs on top of its key and value objects
+#define CASSTCL_ROW_CACHE_DICT_ENTRY_BYTES 48
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_now -- the current time in milliseconds
+ *
+ * Results:
+ *      The time.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static Tcl_WideInt
+casstcl_row_cache_now (void)
+{
+	Tcl_Time now;
+
+	Tcl_GetTime (&now);
+	return ((Tcl_WideInt)now.sec * 1000) + (now.usec / 1000);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_table_name -- fold the name of a table to
+ *   lower case for filing cache entries under it, so that the
+ *   name a select was made with matches the one an upsert is
+ *
+ *   The keyspace is left off, as a select may name the table
+ *   without it; tables of the same name in other keyspaces are
+ *   only invalidated together.
+ *
+ * Results:
+ *      None; the name is appended to tablePtr.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_row_cache_table_name (const char *table, Tcl_DString *tablePtr)
+{
+	const char *dot = strrchr (table, '.');
+
+	if (dot != NULL) {
+		table = dot + 1;
+	}
+
+	for (; *table != '\0'; table++) {
+		char c = tolower ((unsigned char)*table);
+
+		if (c != '"') {
+			Tcl_DStringAppend (tablePtr, &c, 1);
+		}
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_obj_bytes -- estimate the memory taken up by
+ *   a value converted from a row
+ *
+ *   Values that have no string representation yet are counted by
+ *   their internal representation, without generating one.
+ *
+ * Results:
+ *      The estimate in bytes.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_row_cache_obj_bytes (Tcl_Obj *obj)
+{
+	static const Tcl_ObjType *byteArrayType = NULL;
+	static const Tcl_ObjType *listType = NULL;
+	static const Tcl_ObjType *dictType = NULL;
+	int bytes = sizeof (Tcl_Obj);
+
+	if (listType == NULL) {
+		byteArrayType = Tcl_GetObjType ("bytearray");
+		listType = Tcl_GetObjType ("list");
+		dictType = Tcl_GetObjType ("dict");
+	}
+
+	if (obj->bytes != NULL) {
+		bytes += obj->length;
+	}
+
+	if (obj->typePtr == byteArrayType && obj->bytes == NULL) {
+		int length;
+
+		Tcl_GetByteArrayFromObj (obj, &length);
+		bytes += length;
+	} else if (obj->typePtr == listType) {
+		Tcl_Obj **elements;
+		int count;
+		int i;
+
+		Tcl_ListObjGetElements (NULL, obj, &count, &elements);
+		for (i = 0; i < count; i++) {
+			bytes += sizeof (Tcl_Obj *) + casstcl_row_cache_obj_bytes (elements[i]);
+		}
+	} else if (obj->typePtr == dictType) {
+		Tcl_DictSearch search;
+		Tcl_Obj *keyObj;
+		Tcl_Obj *valueObj;
+		int done;
+
+		Tcl_DictObjFirst (NULL, obj, &search, &keyObj, &valueObj, &done);
+		for (; !done; Tcl_DictObjNext (&search, &keyObj, &valueObj, &done)) {
+			// the keys of rows are the shared column names, but
+			// those of map values aren't
+			bytes += CASSTCL_ROW_CACHE_DICT_ENTRY_BYTES + casstcl_row_cache_obj_bytes (valueObj);
+		}
+		Tcl_DictObjDone (&search);
+	} else if (obj->bytes == NULL) {
+		bytes += sizeof (Tcl_WideInt);
+	}
+
+	return bytes;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_init -- set up the empty row cache of a new
+ *   session, which is off until it is given a limit
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_row_cache_init (casstcl_sessionClientData *ct)
+{
+	casstcl_rowCache *cache = &ct->rowCache;
+
+	memset (cache, 0, sizeof (casstcl_rowCache));
+	Tcl_InitHashTable (&cache->hashTable, TCL_STRING_KEYS);
+	Tcl_InitHashTable (&cache->tableHash, TCL_STRING_KEYS);
+	Tcl_InitHashTable (&cache->writeHash, TCL_STRING_KEYS);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_remove -- take an entry out of the row cache
+ *   and free it
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_row_cache_remove (casstcl_rowCache *cache, casstcl_rowCacheEntry *entry)
+{
+	if (entry->prev != NULL) {
+		entry->prev->next = entry->next;
+	} else {
+		cache->head = entry->next;
+	}
+
+	if (entry->next != NULL) {
+		entry->next->prev = entry->prev;
+	} else {
+		cache->tail = entry->prev;
+	}
+
+	if (entry->tableEntry != NULL) {
+		if (entry->tableNext != NULL) {
+			entry->tableNext->tablePrev = entry->tablePrev;
+		}
+
+		if (entry->tablePrev != NULL) {
+			entry->tablePrev->tableNext = entry->tableNext;
+		} else if (entry->tableNext != NULL) {
+			Tcl_SetHashValue (entry->tableEntry, entry->tableNext);
+		} else {
+			Tcl_DeleteHashEntry (entry->tableEntry);
+		}
+	}
+
+	Tcl_DeleteHashEntry (entry->hashEntry);
+	Tcl_DecrRefCount (entry->columnsObj);
+	Tcl_DecrRefCount (entry->rowsObj);
+	cache->bytes -= entry->bytes;
+	ckfree ((char *)entry);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_invalidate -- throw away the cached rows of
+ *   a table, or of every table if table is NULL
+ *
+ *   Upserts call this with the table they write to, so that the
+ *   session doesn't go on reading what it has changed.
+ *
+ * Results:
+ *      The number of entries thrown away.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_row_cache_invalidate (casstcl_sessionClientData *ct, const char *table)
+{
+	casstcl_rowCache *cache = &ct->rowCache;
+	Tcl_HashEntry *tableEntry;
+	Tcl_DString ds;
+	int count = 0;
+
+	if (cache->hashTable.numEntries == 0) {
+		return 0;
+	}
+
+	if (table == NULL) {
+		while (cache->head != NULL) {
+			casstcl_row_cache_remove (cache, cache->head);
+			count++;
+		}
+		cache->invalidations += count;
+		return count;
+	}
+
+	Tcl_DStringInit (&ds);
+	casstcl_row_cache_table_name (table, &ds);
+	tableEntry = Tcl_FindHashEntry (&cache->tableHash, Tcl_DStringValue (&ds));
+	Tcl_DStringFree (&ds);
+
+	// removing the last entry of the table deletes its hash entry
+	while (tableEntry != NULL) {
+		casstcl_rowCacheEntry *entry = (casstcl_rowCacheEntry *)Tcl_GetHashValue (tableEntry);
+		int last = (entry->tableNext == NULL);
+
+		casstcl_row_cache_remove (cache, entry);
+		count++;
+		if (last) {
+			break;
+		}
+	}
+
+	cache->invalidations += count;
+	return count;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_free -- free everything in the row cache of
+ *   a session that is being deleted
+ *
+ *   This is called once the driver can no longer complete any of
+ *   the session's requests, which hold on to the writes in flight
+ *   of the tables they upsert into.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_row_cache_free (casstcl_sessionClientData *ct)
+{
+	casstcl_rowCache *cache = &ct->rowCache;
+	Tcl_HashSearch search;
+	Tcl_HashEntry *hashEntry;
+
+	while (cache->head != NULL) {
+		casstcl_row_cache_remove (cache, cache->head);
+	}
+
+	for (hashEntry = Tcl_FirstHashEntry (&cache->writeHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+		ckfree ((char *)Tcl_GetHashValue (hashEntry));
+	}
+
+	Tcl_DeleteHashTable (&cache->hashTable);
+	Tcl_DeleteHashTable (&cache->tableHash);
+	Tcl_DeleteHashTable (&cache->writeHash);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_write_started -- note an upsert into a table
+ *   that is on its way to the cluster, adding it to the writes
+ *   of the request or batch it is in
+ *
+ *   Until the write is finished with casstcl_row_cache_writes_
+ *   finished, selects of the table neither use the row cache nor
+ *   fill it, as what they would find or keep may be what the
+ *   table held before the write.  table may be NULL, for
+ *   requests that aren't upserts.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_row_cache_write_started (casstcl_sessionClientData *ct, const char *table, casstcl_writeList *writes)
+{
+	casstcl_rowCache *cache = &ct->rowCache;
+	casstcl_tableWrites *tableWrites;
+	Tcl_HashEntry *hashEntry;
+	Tcl_DString ds;
+	int new;
+
+	if (table == NULL) {
+		return;
+	}
+
+	Tcl_DStringInit (&ds);
+	casstcl_row_cache_table_name (table, &ds);
+	hashEntry = Tcl_CreateHashEntry (&cache->writeHash, Tcl_DStringValue (&ds), &new);
+	Tcl_DStringFree (&ds);
+
+	if (new) {
+		tableWrites = (casstcl_tableWrites *)ckalloc (sizeof (casstcl_tableWrites));
+		tableWrites->pending = 0;
+		Tcl_SetHashValue (hashEntry, tableWrites);
+	} else {
+		tableWrites = (casstcl_tableWrites *)Tcl_GetHashValue (hashEntry);
+	}
+
+	__atomic_add_fetch (&tableWrites->pending, 1, __ATOMIC_RELAXED);
+
+	// the list doubles in size whenever its count reaches a power of two
+	if ((writes->count & (writes->count - 1)) == 0) {
+		writes->tables = (casstcl_tableWrites **)ckrealloc ((char *)writes->tables, sizeof (casstcl_tableWrites *) * (writes->count ? writes->count * 2 : 1));
+	}
+	writes->tables[writes->count++] = tableWrites;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_writes_copy -- give a request the writes of
+ *   a batch it executes, which the batch keeps as well
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_row_cache_writes_copy (casstcl_writeList *from, casstcl_writeList *to)
+{
+	int i;
+
+	to->tables = NULL;
+	to->count = from->count;
+	if (from->count == 0) {
+		return;
+	}
+
+	to->tables = (casstcl_tableWrites **)ckalloc (sizeof (casstcl_tableWrites *) * from->count);
+	for (i = 0; i < from->count; i++) {
+		to->tables[i] = from->tables[i];
+		__atomic_add_fetch (&to->tables[i]->pending, 1, __ATOMIC_RELAXED);
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_writes_finished -- note that the writes of a
+ *   request have completed, or that they won't be made
+ *
+ *   This may be called from the driver's threads.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The list is emptied.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_row_cache_writes_finished (casstcl_writeList *writes)
+{
+	int i;
+
+	for (i = 0; i < writes->count; i++) {
+		__atomic_sub_fetch (&writes->tables[i]->pending, 1, __ATOMIC_RELEASE);
+	}
+
+	if (writes->tables != NULL) {
+		ckfree ((char *)writes->tables);
+	}
+	writes->tables = NULL;
+	writes->count = 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_writing -- see if a table, named as by
+ *   casstcl_row_cache_key, has upserts in flight
+ *
+ *   A select that finds none can use the row cache and fill it,
+ *   since no more can be made until it is done.
+ *
+ * Results:
+ *      1 if there are writes in flight, otherwise 0.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_row_cache_writing (casstcl_sessionClientData *ct, const char *table)
+{
+	Tcl_HashEntry *hashEntry = Tcl_FindHashEntry (&ct->rowCache.writeHash, table);
+
+	if (hashEntry == NULL) {
+		return 0;
+	}
+	return (__atomic_load_n (&((casstcl_tableWrites *)Tcl_GetHashValue (hashEntry))->pending, __ATOMIC_ACQUIRE) > 0);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_evict -- evict least recently used entries
+ *   until the cache has room for bytes more
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_row_cache_evict (casstcl_rowCache *cache, int bytes)
+{
+	while (cache->tail != NULL && cache->bytes + bytes > cache->limit) {
+		casstcl_row_cache_remove (cache, cache->tail);
+		cache->evictions++;
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_key -- make the key the rows of a select are
+ *   cached under, and find the table they are read from
+ *
+ *   The key is the form the rows are kept in, lists for
+ *   CASSTCL_ROWS_LIST and dicts otherwise, and the consistency
+ *   level the select is made at, or CASSTCL_CONSISTENCY_DEFAULT
+ *   if consistencyPtr is NULL, followed by the text of the
+ *   statement or, if pcd isn't NULL, the serial number of the
+ *   prepared statement and the values bound to it.  The
+ *   table is the one the prepared statement was made for, or the
+ *   one after the FROM of the statement.
+ *
+ *   A statement that doesn't name the keyspace of its table reads
+ *   from whichever keyspace the driver session is using when it
+ *   runs, which a USE by any object attached to the session can
+ *   change, so its rows aren't cached.
+ *
+ * Results:
+ *      1 if the rows can be cached, with the key and table
+ *      appended to keyPtr and tablePtr; otherwise 0.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_row_cache_key (int rowStyle, CassConsistency *consistencyPtr, char *query, casstcl_preparedClientData *pcd, Tcl_Obj *valuesObj, Tcl_DString *keyPtr, Tcl_DString *tablePtr)
+{
+	const char *style = (rowStyle == CASSTCL_ROWS_LIST) ? "l " : "d ";
+	char level[TCL_INTEGER_SPACE + 2];
+
+	snprintf (level, sizeof (level), "%d ", (consistencyPtr != NULL) ? (int)*consistencyPtr : CASSTCL_CONSISTENCY_DEFAULT);
+
+	if (pcd != NULL) {
+		char serial[TCL_INTEGER_SPACE + 2];
+		int length;
+		char *values = Tcl_GetStringFromObj (valuesObj, &length);
+
+		Tcl_DStringAppend (keyPtr, style, 2);
+		Tcl_DStringAppend (keyPtr, level, -1);
+		snprintf (serial, sizeof (serial), "p%lu ", pcd->serial);
+		Tcl_DStringAppend (keyPtr, serial, -1);
+		Tcl_DStringAppend (keyPtr, values, length);
+		if (pcd->tableNameObj != NULL) {
+			casstcl_row_cache_table_name (Tcl_GetString (pcd->tableNameObj), tablePtr);
+		}
+		return 1;
+	}
+
+	Tcl_DString ds;
+	int cacheable = 0;
+
+	Tcl_DStringInit (&ds);
+	if (casstcl_cql_select_table (query, &ds) && strchr (Tcl_DStringValue (&ds), '.') != NULL) {
+		Tcl_DStringAppend (keyPtr, style, 2);
+		Tcl_DStringAppend (keyPtr, level, -1);
+		Tcl_DStringAppend (keyPtr, "q ", 2);
+		Tcl_DStringAppend (keyPtr, query, -1);
+		casstcl_row_cache_table_name (Tcl_DStringValue (&ds), tablePtr);
+		cacheable = 1;
+	}
+	Tcl_DStringFree (&ds);
+	return cacheable;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_lookup -- find the cached rows for a key
+ *
+ *   An entry older than the cache's time to live is thrown away
+ *   rather than returned.  Lookups aren't counted while the cache
+ *   is off.
+ *
+ * Results:
+ *      The entry, which becomes the most recently used, or NULL.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_rowCacheEntry *
+casstcl_row_cache_lookup (casstcl_sessionClientData *ct, const char *key)
+{
+	casstcl_rowCache *cache = &ct->rowCache;
+	Tcl_HashEntry *hashEntry;
+	casstcl_rowCacheEntry *entry;
+
+	if (cache->limit == 0) {
+		return NULL;
+	}
+
+	hashEntry = Tcl_FindHashEntry (&cache->hashTable, key);
+	if (hashEntry == NULL) {
+		cache->misses++;
+		return NULL;
+	}
+
+	entry = (casstcl_rowCacheEntry *)Tcl_GetHashValue (hashEntry);
+	if (entry->expires != 0 && casstcl_row_cache_now () >= entry->expires) {
+		casstcl_row_cache_remove (cache, entry);
+		cache->expirations++;
+		cache->misses++;
+		return NULL;
+	}
+
+	// move it to the head of the list
+	if (entry != cache->head) {
+		entry->prev->next = entry->next;
+		if (entry->next != NULL) {
+			entry->next->prev = entry->prev;
+		} else {
+			cache->tail = entry->prev;
+		}
+		entry->prev = NULL;
+		entry->next = cache->head;
+		cache->head->prev = entry;
+		cache->head = entry;
+	}
+
+	cache->hits++;
+	return entry;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_store -- cache the rows of a select under a
+ *   key, filed under the table they were read from, if there is
+ *   one
+ *
+ *   rowsObj is a list of rows in the form the key says.  Least
+ *   recently used entries are evicted to make room; rows that
+ *   would take up more than the whole limit aren't cached.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      rowsObj and columnsObj are held by the cache.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_row_cache_store (casstcl_sessionClientData *ct, const char *key, const char *table, Tcl_Obj *columnsObj, Tcl_Obj *rowsObj)
+{
+	casstcl_rowCache *cache = &ct->rowCache;
+	casstcl_rowCacheEntry *entry;
+	Tcl_HashEntry *hashEntry;
+	Tcl_Obj **rowObjs;
+	int rowCount;
+	int bytes;
+	int new;
+	int i;
+
+	if (cache->limit == 0) {
+		return;
+	}
+
+	bytes = sizeof (casstcl_rowCacheEntry) + sizeof (Tcl_HashEntry) + strlen (key) + casstcl_row_cache_obj_bytes (columnsObj);
+	Tcl_ListObjGetElements (NULL, rowsObj, &rowCount, &rowObjs);
+	bytes += sizeof (Tcl_Obj) + rowCount * sizeof (Tcl_Obj *);
+	for (i = 0; i < rowCount; i++) {
+		bytes += casstcl_row_cache_obj_bytes (rowObjs[i]);
+	}
+
+	if (bytes > cache->limit) {
+		cache->uncacheable++;
+		return;
+	}
+
+	hashEntry = Tcl_FindHashEntry (&cache->hashTable, key);
+	if (hashEntry != NULL) {
+		casstcl_row_cache_remove (cache, (casstcl_rowCacheEntry *)Tcl_GetHashValue (hashEntry));
+	}
+
+	casstcl_row_cache_evict (cache, bytes);
+
+	entry = (casstcl_rowCacheEntry *)ckalloc (sizeof (casstcl_rowCacheEntry));
+	entry->hashEntry = Tcl_CreateHashEntry (&cache->hashTable, key, &new);
+	Tcl_SetHashValue (entry->hashEntry, entry);
+	entry->columnsObj = columnsObj;
+	Tcl_IncrRefCount (columnsObj);
+	entry->rowsObj = rowsObj;
+	Tcl_IncrRefCount (rowsObj);
+	entry->bytes = bytes;
+	entry->expires = (cache->ttl > 0) ? casstcl_row_cache_now () + cache->ttl : 0;
+
+	entry->prev = NULL;
+	entry->next = cache->head;
+	if (cache->head != NULL) {
+		cache->head->prev = entry;
+	} else {
+		cache->tail = entry;
+	}
+	cache->head = entry;
+
+	// the table's entries hang off the hash entry for it
+	entry->tableEntry = NULL;
+	entry->tablePrev = NULL;
+	entry->tableNext = NULL;
+	if (*table != '\0') {
+		entry->tableEntry = Tcl_CreateHashEntry (&cache->tableHash, table, &new);
+		if (!new) {
+			entry->tableNext = (casstcl_rowCacheEntry *)Tcl_GetHashValue (entry->tableEntry);
+			entry->tableNext->tablePrev = entry;
+		}
+		Tcl_SetHashValue (entry->tableEntry, entry);
+	}
+
+	cache->bytes += bytes;
+	cache->stores++;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_eval -- hand cached rows to the body of a
+ *   select, the same way casstcl_result_eval_page hands it a
+ *   page of a result
+ *
+ *   With CASSTCL_ROWS_ARRAY the rows are dicts, and the columns
+ *   missing from each, its null values, are unset from the array.
+ *
+ * Results:
+ *      The code of the last evaluation of the body, or TCL_ERROR.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_row_cache_eval (casstcl_sessionClientData *ct, Tcl_Obj *columnsObj, Tcl_Obj *rowsObj, int rowStyle, Tcl_Obj *varNameObj, Tcl_Obj *codeObj)
+{
+	Tcl_Interp *interp = ct->interp;
+	Tcl_Obj **rowObjs;
+	Tcl_Obj **columnObjs;
+	int evalReturnCode = TCL_OK;
+	int columnCount;
+	int rowCount;
+	int row;
+
+	if (rowStyle != CASSTCL_ROWS_ARRAY) {
+		if (Tcl_ObjSetVar2 (interp, varNameObj, NULL, rowsObj, (TCL_LEAVE_ERR_MSG)) == NULL) {
+			return TCL_ERROR;
+		}
+		evalReturnCode = Tcl_EvalObjEx (interp, codeObj, 0);
+	} else {
+		Tcl_ListObjGetElements (NULL, rowsObj, &rowCount, &rowObjs);
+		Tcl_ListObjGetElements (NULL, columnsObj, &columnCount, &columnObjs);
+
+		// hold on to the rows in case the body empties the cache
+		Tcl_IncrRefCount (rowsObj);
+		Tcl_IncrRefCount (columnsObj);
+
+		for (row = 0; row < rowCount; row++) {
+			int i;
+
+			for (i = 0; i < columnCount; i++) {
+				Tcl_Obj *valueObj = NULL;
+
+				Tcl_DictObjGet (NULL, rowObjs[row], columnObjs[i], &valueObj);
+				if (valueObj == NULL) {
+					Tcl_UnsetVar2 (interp, Tcl_GetString (varNameObj), Tcl_GetString (columnObjs[i]), 0);
+				} else if (Tcl_ObjSetVar2 (interp, varNameObj, columnObjs[i], valueObj, (TCL_LEAVE_ERR_MSG)) == NULL) {
+					evalReturnCode = TCL_ERROR;
+					break;
+				}
+			}
+
+			if (evalReturnCode == TCL_ERROR) {
+				break;
+			}
+
+			evalReturnCode = Tcl_EvalObjEx (interp, codeObj, 0);
+			if ((evalReturnCode != TCL_OK) && (evalReturnCode != TCL_CONTINUE)) {
+				break;
+			}
+		}
+
+		Tcl_DecrRefCount (columnsObj);
+		Tcl_DecrRefCount (rowsObj);
+	}
+
+	if (evalReturnCode == TCL_ERROR) {
+		char        msg[60];
+
+		sprintf(msg, "\n    (\"select\" body line %d)",
+				Tcl_GetErrorLine(interp));
+		Tcl_AddErrorInfo(interp, msg);
+	}
+
+	return evalReturnCode;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_eval_page -- cache the rows of the only page
+ *   of a select's result under a key, then hand them to the body
+ *   of the select
+ *
+ *   The rows are converted without blob references, as cached
+ *   rows mustn't keep the result they came from alive.  The body
+ *   sees the very rows the cache holds, as it does on a hit.
+ *
+ * Results:
+ *      The code of the last evaluation of the body, or TCL_ERROR.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_row_cache_eval_page (casstcl_sessionClientData *ct, casstcl_resultRef *resultRef, Tcl_Obj **names, int columnCount, int rowStyle, const char *key, const char *table, Tcl_Obj *varNameObj, Tcl_Obj *codeObj)
+{
+	int blobRefMinimum = ct->blobRefMinimum;
+	Tcl_Obj *columnsObj;
+	Tcl_Obj *rowsObj;
+	int tclReturn;
+
+	ct->blobRefMinimum = 0;
+	tclReturn = casstcl_result_rows_to_obj (ct, resultRef, names, columnCount, (rowStyle == CASSTCL_ROWS_LIST) ? CASSTCL_ROWS_LIST : CASSTCL_ROWS_DICT, &rowsObj);
+	ct->blobRefMinimum = blobRefMinimum;
+
+	if (tclReturn == TCL_ERROR) {
+		return TCL_ERROR;
+	}
+
+	columnsObj = Tcl_NewListObj (columnCount, names);
+	Tcl_IncrRefCount (columnsObj);
+	Tcl_IncrRefCount (rowsObj);
+
+	casstcl_row_cache_store (ct, key, table, columnsObj, rowsObj);
+	tclReturn = casstcl_row_cache_eval (ct, columnsObj, rowsObj, rowStyle, varNameObj, codeObj);
+
+	Tcl_DecrRefCount (rowsObj);
+	Tcl_DecrRefCount (columnsObj);
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_configure -- set the options given of the row
+ *   cache of a session from the arguments of the row_cache
+ *   method, ?-limit bytes? ?-ttl ms?
+ *
+ *   Lowering the limit evicts what no longer fits; a limit of
+ *   zero empties the cache and turns it off.  A new time to live
+ *   only applies to rows cached after it is set.
+ *
+ * Results:
+ *      A standard Tcl result; the interpreter result is a list of
+ *      the options and their values.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_row_cache_configure (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[])
+{
+	Tcl_Interp *interp = ct->interp;
+	casstcl_rowCache *cache = &ct->rowCache;
+	Tcl_WideInt limit = cache->limit;
+	int ttl = cache->ttl;
+	int arg;
+	int subOptIndex;
+
+	static CONST char *subOptions[] = {
+		"-limit",
+		"-ttl",
+		NULL
+	};
+
+	enum subOptions {
+		SUBOPT_LIMIT,
+		SUBOPT_TTL
+	};
+
+	if ((objc % 2) != 0) {
+		Tcl_WrongNumArgs (interp, 2, objv, "?-limit bytes? ?-ttl ms?");
+		return TCL_ERROR;
+	}
+
+	for (arg = 2; arg < objc; arg += 2) {
+		if (Tcl_GetIndexFromObj (interp, objv[arg], subOptions, "subOption", TCL_EXACT, &subOptIndex) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		if ((enum subOptions) subOptIndex == SUBOPT_LIMIT) {
+			if (Tcl_GetWideIntFromObj (interp, objv[arg + 1], &limit) == TCL_ERROR) {
+				Tcl_AppendResult (interp, " while converting -limit element", NULL);
+				return TCL_ERROR;
+			}
+		} else if (Tcl_GetIntFromObj (interp, objv[arg + 1], &ttl) == TCL_ERROR) {
+			Tcl_AppendResult (interp, " while converting -ttl element", NULL);
+			return TCL_ERROR;
+		}
+	}
+
+	if (limit < 0 || ttl < 0) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "row cache limit and time to live must not be negative", NULL);
+		return TCL_ERROR;
+	}
+
+	cache->limit = limit;
+	cache->ttl = ttl;
+	casstcl_row_cache_evict (cache, 0);
+
+	Tcl_Obj *listObjv[4];
+
+	listObjv[0] = Tcl_NewStringObj ("limit", -1);
+	listObjv[1] = Tcl_NewWideIntObj (cache->limit);
+	listObjv[2] = Tcl_NewStringObj ("ttl", -1);
+	listObjv[3] = Tcl_NewIntObj (cache->ttl);
+	Tcl_SetObjResult (interp, Tcl_NewListObj (4, listObjv));
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_stats_obj -- describe the row cache of a
+ *   session, clearing its counters afterwards if reset is set
+ *
+ * Results:
+ *      A new list of key-value pairs.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *
+casstcl_row_cache_stats_obj (casstcl_sessionClientData *ct, int reset)
+{
+	casstcl_rowCache *cache = &ct->rowCache;
+	Tcl_Obj *listObj = Tcl_NewObj ();
+
+#define CASSTCL_ROW_CACHE_APPEND(name, obj) \
+	Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ((name), -1)); \
+	Tcl_ListObjAppendElement (NULL, listObj, (obj))
+
+	CASSTCL_ROW_CACHE_APPEND ("size", Tcl_NewIntObj (cache->hashTable.numEntries));
+	CASSTCL_ROW_CACHE_APPEND ("bytes", Tcl_NewWideIntObj (cache->bytes));
+	CASSTCL_ROW_CACHE_APPEND ("limit", Tcl_NewWideIntObj (cache->limit));
+	CASSTCL_ROW_CACHE_APPEND ("ttl", Tcl_NewIntObj (cache->ttl));
+	CASSTCL_ROW_CACHE_APPEND ("hits", Tcl_NewWideIntObj (cache->hits));
+	CASSTCL_ROW_CACHE_APPEND ("misses", Tcl_NewWideIntObj (cache->misses));
+	CASSTCL_ROW_CACHE_APPEND ("stores", Tcl_NewWideIntObj (cache->stores));
+	CASSTCL_ROW_CACHE_APPEND ("uncacheable", Tcl_NewWideIntObj (cache->uncacheable));
+	CASSTCL_ROW_CACHE_APPEND ("evictions", Tcl_NewWideIntObj (cache->evictions));
+	CASSTCL_ROW_CACHE_APPEND ("expirations", Tcl_NewWideIntObj (cache->expirations));
+	CASSTCL_ROW_CACHE_APPEND ("invalidations", Tcl_NewWideIntObj (cache->invalidations));
+
+#undef CASSTCL_ROW_CACHE_APPEND
+
+	if (reset) {
+		cache->hits = 0;
+		cache->misses = 0;
+		cache->stores = 0;
+		cache->uncacheable = 0;
+		cache->evictions = 0;
+		cache->expirations = 0;
+		cache->invalidations = 0;
+	}
+	return listObj;
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,292 @@
+/*
+ *
+ * Include file for casstcl_rowcache
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_init -- set up the empty row cache of a new
+ *   session, which is off until it is given a limit
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_row_cache_init (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_invalidate -- throw away the cached rows of
+ *   a table, or of every table if table is NULL
+ *
+ *   Upserts call this with the table they write to, so that the
+ *   session doesn't go on reading what it has changed.
+ *
+ * Results:
+ *      The number of entries thrown away.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_row_cache_invalidate (casstcl_sessionClientData *ct, const char *table);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_free -- free everything in the row cache of
+ *   a session that is being deleted
+ *
+ *   This is called once the driver can no longer complete any of
+ *   the session's requests, which hold on to the writes in flight
+ *   of the tables they upsert into.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_row_cache_free (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_key -- make the key the rows of a select are
+ *   cached under, and find the table they are read from
+ *
+ *   The key is the form the rows are kept in, lists for
+ *   CASSTCL_ROWS_LIST and dicts otherwise, and the consistency
+ *   level the select is made at, or CASSTCL_CONSISTENCY_DEFAULT
+ *   if consistencyPtr is NULL, followed by the text of the
+ *   statement or, if pcd isn't NULL, the serial number of the
+ *   prepared statement and the values bound to it.  The
+ *   table is the one the prepared statement was made for, or the
+ *   one after the FROM of the statement.
+ *
+ *   A statement that doesn't name the keyspace of its table reads
+ *   from whichever keyspace the driver session is using when it
+ *   runs, which a USE by any object attached to the session can
+ *   change, so its rows aren't cached.
+ *
+ * Results:
+ *      1 if the rows can be cached, with the key and table
+ *      appended to keyPtr and tablePtr; otherwise 0.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_row_cache_key (int rowStyle, CassConsistency *consistencyPtr, char *query, casstcl_preparedClientData *pcd, Tcl_Obj *valuesObj, Tcl_DString *keyPtr, Tcl_DString *tablePtr);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_lookup -- find the cached rows for a key
+ *
+ *   An entry older than the cache's time to live is thrown away
+ *   rather than returned.  Lookups aren't counted while the cache
+ *   is off.
+ *
+ * Results:
+ *      The entry, which becomes the most recently used, or NULL.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_rowCacheEntry *casstcl_row_cache_lookup (casstcl_sessionClientData *ct, const char *key);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_store -- cache the rows of a select under a
+ *   key, filed under the table they were read from, if there is
+ *   one
+ *
+ *   rowsObj is a list of rows in the form the key says.  Least
+ *   recently used entries are evicted to make room; rows that
+ *   would take up more than the whole limit aren't cached.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      rowsObj and columnsObj are held by the cache.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_row_cache_store (casstcl_sessionClientData *ct, const char *key, const char *table, Tcl_Obj *columnsObj, Tcl_Obj *rowsObj);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_eval -- hand cached rows to the body of a
+ *   select, the same way casstcl_result_eval_page hands it a
+ *   page of a result
+ *
+ *   With CASSTCL_ROWS_ARRAY the rows are dicts, and the columns
+ *   missing from each, its null values, are unset from the array.
+ *
+ * Results:
+ *      The code of the last evaluation of the body, or TCL_ERROR.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_row_cache_eval (casstcl_sessionClientData *ct, Tcl_Obj *columnsObj, Tcl_Obj *rowsObj, int rowStyle, Tcl_Obj *varNameObj, Tcl_Obj *codeObj);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_eval_page -- cache the rows of the only page
+ *   of a select's result under a key, then hand them to the body
+ *   of the select
+ *
+ *   The rows are converted without blob references, as cached
+ *   rows mustn't keep the result they came from alive.  The body
+ *   sees the very rows the cache holds, as it does on a hit.
+ *
+ * Results:
+ *      The code of the last evaluation of the body, or TCL_ERROR.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_row_cache_eval_page (casstcl_sessionClientData *ct, casstcl_resultRef *resultRef, Tcl_Obj **names, int columnCount, int rowStyle, const char *key, const char *table, Tcl_Obj *varNameObj, Tcl_Obj *codeObj);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_configure -- set the options given of the row
+ *   cache of a session from the arguments of the row_cache
+ *   method, ?-limit bytes? ?-ttl ms?
+ *
+ *   Lowering the limit evicts what no longer fits; a limit of
+ *   zero empties the cache and turns it off.  A new time to live
+ *   only applies to rows cached after it is set.
+ *
+ * Results:
+ *      A standard Tcl result; the interpreter result is a list of
+ *      the options and their values.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_row_cache_configure (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[]);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_stats_obj -- describe the row cache of a
+ *   session, clearing its counters afterwards if reset is set
+ *
+ * Results:
+ *      A new list of key-value pairs.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *casstcl_row_cache_stats_obj (casstcl_sessionClientData *ct, int reset);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_write_started -- note an upsert into a table
+ *   that is on its way to the cluster, adding it to the writes
+ *   of the request or batch it is in
+ *
+ *   Until the write is finished with casstcl_row_cache_writes_
+ *   finished, selects of the table neither use the row cache nor
+ *   fill it, as what they would find or keep may be what the
+ *   table held before the write.  table may be NULL, for
+ *   requests that aren't upserts.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_row_cache_write_started (casstcl_sessionClientData *ct, const char *table, casstcl_writeList *writes);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_writes_copy -- give a request the writes of
+ *   a batch it executes, which the batch keeps as well
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_row_cache_writes_copy (casstcl_writeList *from, casstcl_writeList *to);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_writes_finished -- note that the writes of a
+ *   request have completed, or that they won't be made
+ *
+ *   This may be called from the driver's threads.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The list is emptied.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_row_cache_writes_finished (casstcl_writeList *writes);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_row_cache_writing -- see if a table, named as by
+ *   casstcl_row_cache_key, has upserts in flight
+ *
+ *   A select that finds none can use the row cache and fill it,
+ *   since no more can be made until it is done.
+ *
+ * Results:
+ *      1 if there are writes in flight, otherwise 0.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_row_cache_writing (casstcl_sessionClientData *ct, const char *table);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
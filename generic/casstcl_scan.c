@@ -0,0 +1,527 @@
+/*
+ * casstcl_scan - Functions for reading a whole table by splitting its
+ *                token ring into ranges and querying several at once
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_scan.h"
+#include "casstcl_consistency.h"
+#include "casstcl_error.h"
+#include "casstcl_execution.h"
+#include "casstcl_future.h"
+#include "casstcl_prepared.h"
+#include "casstcl_result.h"
+#include "casstcl_schema.h"
+
+#include <stdint.h>
+
+/*
+ * Each stream of a scan walks one token range at a time, page by page,
+ * with its own statement so that it has its own paging state.  A stream
+ * whose future is NULL has no more ranges to do.
+ */
+typedef struct casstcl_scanStream {
+	CassStatement *statement;
+	CassFuture *future;
+} casstcl_scanStream;
+
+typedef struct casstcl_scanState {
+	casstcl_sessionClientData *ct;
+	Tcl_DString query;
+	const CassPrepared *prepared;
+	CassConsistency *consistencyPtr;
+	int pagingSize;
+	int splits;
+	int nextSplit;
+	casstcl_futureWaiter *waiter;
+} casstcl_scanState;
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_scan_token -- find the token that one of the ranges
+ *   of a scan starts after
+ *
+ *   The Murmur3 token ring runs from -2^63 to 2^63-1 and is cut
+ *   into splits ranges of (almost) the same width.  The lowest
+ *   token, -2^63, is never given to a partition, so the first
+ *   range starting after it leaves nothing out.
+ *
+ * Results:
+ *      The token.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static cass_int64_t
+casstcl_scan_token (int split, int splits)
+{
+	uint64_t width = UINT64_MAX / (uint64_t)splits;
+
+	if (split == splits) {
+		return INT64_MAX;
+	}
+
+	return (cass_int64_t)((uint64_t)INT64_MIN + width * (uint64_t)split);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_scan_make_query -- build the query of a scan
+ *
+ *   The query selects the requested columns of the table whose
+ *   partition key's token is in a range given by two bound
+ *   values, with any extra condition added on the end.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      The query is left in the scan state.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_scan_make_query (casstcl_scanState *ss, char *tableName, Tcl_Obj *columnsObj, char *where)
+{
+	Tcl_Interp *interp = ss->ct->interp;
+	casstcl_tableInfo *tableInfo = casstcl_lookup_table (ss->ct, tableName);
+	Tcl_DString token;
+	int i;
+
+	if (tableInfo == NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "table '", tableName, "' isn't in the column type map", NULL);
+		return TCL_ERROR;
+	}
+
+	if (tableInfo->nPartitionKeys == 0) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "the partition key of table '", tableName, "' isn't known", NULL);
+		return TCL_ERROR;
+	}
+
+	Tcl_DStringAppend (&ss->query, "SELECT ", -1);
+
+	if (columnsObj == NULL) {
+		Tcl_DStringAppend (&ss->query, "*", 1);
+	} else {
+		Tcl_Obj **columnObjv;
+		int columnObjc;
+
+		if (Tcl_ListObjGetElements (interp, columnsObj, &columnObjc, &columnObjv) == TCL_ERROR) {
+			Tcl_AppendResult (interp, " while parsing list of columns", NULL);
+			return TCL_ERROR;
+		}
+
+		if (columnObjc == 0) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "no columns to scan in table '", tableName, "'", NULL);
+			return TCL_ERROR;
+		}
+
+		for (i = 0; i < columnObjc; i++) {
+			if (i > 0) {
+				Tcl_DStringAppend (&ss->query, ", ", 2);
+			}
+			Tcl_DStringAppend (&ss->query, Tcl_GetString (columnObjv[i]), -1);
+		}
+	}
+
+	Tcl_DStringAppend (&ss->query, " FROM ", -1);
+	Tcl_DStringAppend (&ss->query, tableInfo->fullName, -1);
+
+	Tcl_DStringInit (&token);
+	Tcl_DStringAppend (&token, "token(", -1);
+	for (i = 0; i < tableInfo->nPartitionKeys; i++) {
+		if (i > 0) {
+			Tcl_DStringAppend (&token, ", ", 2);
+		}
+		Tcl_DStringAppend (&token, tableInfo->partitionKey[i]->name, -1);
+	}
+	Tcl_DStringAppend (&token, ")", 1);
+
+	Tcl_DStringAppend (&ss->query, " WHERE ", -1);
+	Tcl_DStringAppend (&ss->query, Tcl_DStringValue (&token), Tcl_DStringLength (&token));
+	Tcl_DStringAppend (&ss->query, " > ? AND ", -1);
+	Tcl_DStringAppend (&ss->query, Tcl_DStringValue (&token), Tcl_DStringLength (&token));
+	Tcl_DStringAppend (&ss->query, " <= ?", -1);
+	Tcl_DStringFree (&token);
+
+	if (where != NULL && *where != '\0') {
+		Tcl_DStringAppend (&ss->query, " AND ", -1);
+		Tcl_DStringAppend (&ss->query, where, -1);
+	}
+
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_scan_start_range -- give a stream the next range of
+ *   the scan and ask for its first page
+ *
+ * Results:
+ *      A standard Tcl result.  If there are no ranges left, the
+ *      stream's future is left NULL.
+ *
+ * Side effects:
+ *      Any statement the stream had for its last range is freed.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_scan_start_range (casstcl_scanState *ss, casstcl_scanStream *stream)
+{
+	int split = ss->nextSplit;
+
+	if (stream->statement != NULL) {
+		cass_statement_free (stream->statement);
+		stream->statement = NULL;
+	}
+	stream->future = NULL;
+
+	if (split == ss->splits) {
+		return TCL_OK;
+	}
+	ss->nextSplit++;
+
+	if (ss->prepared != NULL) {
+		stream->statement = cass_prepared_bind (ss->prepared);
+	} else {
+		stream->statement = cass_statement_new (Tcl_DStringValue (&ss->query), 2);
+	}
+
+	if (casstcl_setStatementConsistency (ss->ct, stream->statement, ss->consistencyPtr) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	cass_statement_set_paging_size (stream->statement, ss->pagingSize);
+	casstcl_statement_set_execution (stream->statement, 1, -1);
+	cass_statement_bind_int64 (stream->statement, 0, casstcl_scan_token (split, ss->splits));
+	cass_statement_bind_int64 (stream->statement, 1, casstcl_scan_token (split + 1, ss->splits));
+
+	stream->future = cass_session_execute (ss->ct->session, stream->statement);
+	casstcl_future_waiter_watch (ss->waiter, stream->future);
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_scan -- read a whole table a token range at a time
+ *
+ *   The token ring is cut into splits ranges and up to parallelism
+ *   of them are queried at once.  Pages are handed to the code body
+ *   one at a time, in the order they arrive, the same as select
+ *   does.  As soon as a page has been handled, the stream it came
+ *   from asks for its next page or, at the end of its range, starts
+ *   on the next range not yet begun.
+ *
+ * Results:
+ *      A standard Tcl result.  break stops the scan without an error
+ *      and return returns from the caller.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_scan (casstcl_sessionClientData *ct, char *tableName, Tcl_Obj *columnsObj, char *where, int splits, int parallelism, int pagingSize, CassConsistency *consistencyPtr, int rowStyle, Tcl_Obj *varNameObj, Tcl_Obj *codeObj)
+{
+	Tcl_Interp *interp = ct->interp;
+	casstcl_scanState ss;
+	casstcl_scanStream *streams = NULL;
+	Tcl_Obj **names = NULL;
+	int columnCount = 0;
+	int active = 0;
+	int tclReturn = TCL_OK;
+	int i;
+
+	if (parallelism > splits) {
+		parallelism = splits;
+	}
+
+	ss.ct = ct;
+	ss.prepared = NULL;
+	ss.consistencyPtr = consistencyPtr;
+	ss.pagingSize = pagingSize;
+	ss.splits = splits;
+	ss.nextSplit = 0;
+	Tcl_DStringInit (&ss.query);
+
+	if (casstcl_scan_make_query (&ss, tableName, columnsObj, where) != TCL_OK ||
+			casstcl_prepared_cache_lookup (ct, Tcl_DStringValue (&ss.query), &ss.prepared) != TCL_OK) {
+		Tcl_DStringFree (&ss.query);
+		return TCL_ERROR;
+	}
+
+	ss.waiter = casstcl_future_waiter_new ();
+
+	streams = (casstcl_scanStream *)ckalloc (sizeof (casstcl_scanStream) * parallelism);
+	for (i = 0; i < parallelism; i++) {
+		streams[i].statement = NULL;
+		streams[i].future = NULL;
+	}
+
+	for (i = 0; i < parallelism && tclReturn == TCL_OK; i++) {
+		tclReturn = casstcl_scan_start_range (&ss, &streams[i]);
+		if (streams[i].future != NULL) {
+			active++;
+		}
+	}
+
+	while (tclReturn == TCL_OK && active > 0) {
+		casstcl_scanStream *stream = NULL;
+		casstcl_resultRef *resultRef;
+		const CassResult *result;
+		CassError rc;
+		int evalReturnCode;
+
+		// take whichever page has arrived first, and if none has,
+		// wait for the first to
+		while (stream == NULL) {
+			for (i = 0; i < parallelism; i++) {
+				if (streams[i].future != NULL && cass_future_ready (streams[i].future)) {
+					stream = &streams[i];
+					break;
+				}
+			}
+
+			if (stream == NULL) {
+				casstcl_future_waiter_wait (ss.waiter);
+			}
+		}
+
+		rc = cass_future_error_code (stream->future);
+		if (rc != CASS_OK) {
+			tclReturn = casstcl_future_error_to_tcl (ct, rc, stream->future);
+			break;
+		}
+
+		result = cass_future_get_result (stream->future);
+		cass_future_free (stream->future);
+		stream->future = NULL;
+
+		if (result == NULL) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "future has no result", NULL);
+			tclReturn = TCL_ERROR;
+			break;
+		}
+
+		if (names == NULL) {
+			names = casstcl_result_column_names (result, &columnCount);
+		}
+
+		resultRef = casstcl_result_ref_new (result);
+		evalReturnCode = casstcl_result_eval_page (ct, resultRef, names, columnCount, rowStyle, varNameObj, codeObj);
+
+		if (evalReturnCode == TCL_OK || evalReturnCode == TCL_CONTINUE) {
+			if (cass_result_has_more_pages (result)) {
+				cass_statement_set_paging_state (stream->statement, result);
+				stream->future = cass_session_execute (ct->session, stream->statement);
+				casstcl_future_waiter_watch (ss.waiter, stream->future);
+			} else {
+				tclReturn = casstcl_scan_start_range (&ss, stream);
+				if (stream->future == NULL) {
+					active--;
+				}
+			}
+		} else {
+			// break stops the scan but isn't passed on, the same as
+			// with select; return and error are
+			if (evalReturnCode != TCL_BREAK) {
+				tclReturn = evalReturnCode;
+			}
+			casstcl_result_ref_release (resultRef);
+			break;
+		}
+
+		casstcl_result_ref_release (resultRef);
+	}
+
+	// the driver sees any queries still running through to the end
+	// without us
+	for (i = 0; i < parallelism; i++) {
+		if (streams[i].future != NULL) {
+			cass_future_free (streams[i].future);
+		}
+		if (streams[i].statement != NULL) {
+			cass_statement_free (streams[i].statement);
+		}
+	}
+
+	ckfree ((char *)streams);
+	casstcl_future_waiter_release (ss.waiter);
+	casstcl_free_column_names (names, columnCount);
+	Tcl_DStringFree (&ss.query);
+	Tcl_UnsetVar (interp, Tcl_GetString (varNameObj), 0);
+	return tclReturn;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_scan_from_objv -- parse the arguments of the scan
+ *   method of a cassandra object and do the scan
+ *
+ *   $cass scan ?-columns list? ?-where condition? ?-splits n?
+ *       ?-parallelism n? ?-pagesize n? ?-consistency level?
+ *       ?-list|-dict? table arrayName code
+ *
+ *   objv[0] is the first of the options.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_scan_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[])
+{
+	Tcl_Interp *interp = ct->interp;
+	Tcl_Obj *columnsObj = NULL;
+	char *where = NULL;
+	int parallelism = CASSTCL_SCAN_DEFAULT_PARALLELISM;
+	int splits = 0;
+	int pagingSize = 100;
+	CassConsistency consistency;
+	CassConsistency *consistencyPtr = NULL;
+	int rowStyle = CASSTCL_ROWS_ARRAY;
+	int arg;
+
+	static CONST char *options[] = {
+		"-columns",
+		"-where",
+		"-splits",
+		"-parallelism",
+		"-pagesize",
+		"-consistency",
+		"-list",
+		"-dict",
+		NULL
+	};
+
+	enum options {
+		OPT_COLUMNS,
+		OPT_WHERE,
+		OPT_SPLITS,
+		OPT_PARALLELISM,
+		OPT_PAGESIZE,
+		OPT_CONSISTENCY,
+		OPT_LIST,
+		OPT_DICT
+	};
+
+	// the options all start with a dash; the table name never does
+	for (arg = 0; arg + 3 < objc && *Tcl_GetString (objv[arg]) == '-'; arg++) {
+		int optIndex;
+
+		if (Tcl_GetIndexFromObj (interp, objv[arg], options, "option", TCL_EXACT, &optIndex) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		if ((enum options) optIndex == OPT_LIST) {
+			rowStyle = CASSTCL_ROWS_LIST;
+			continue;
+		}
+
+		if ((enum options) optIndex == OPT_DICT) {
+			rowStyle = CASSTCL_ROWS_DICT;
+			continue;
+		}
+
+		if (arg + 4 == objc) {
+			Tcl_ResetResult (interp);
+			Tcl_AppendResult (interp, "value for \"", Tcl_GetString (objv[arg]), "\" missing", NULL);
+			return TCL_ERROR;
+		}
+		arg++;
+
+		switch ((enum options) optIndex) {
+			case OPT_COLUMNS:
+				columnsObj = objv[arg];
+				break;
+
+			case OPT_WHERE:
+				where = Tcl_GetString (objv[arg]);
+				break;
+
+			case OPT_SPLITS:
+				if (Tcl_GetIntFromObj (interp, objv[arg], &splits) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting number of splits", NULL);
+					return TCL_ERROR;
+				}
+
+				if (splits < 1) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "number of splits must be at least 1", NULL);
+					return TCL_ERROR;
+				}
+				break;
+
+			case OPT_PARALLELISM:
+				if (Tcl_GetIntFromObj (interp, objv[arg], &parallelism) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting parallelism", NULL);
+					return TCL_ERROR;
+				}
+
+				if (parallelism < 1) {
+					Tcl_ResetResult (interp);
+					Tcl_AppendResult (interp, "parallelism must be at least 1", NULL);
+					return TCL_ERROR;
+				}
+				break;
+
+			case OPT_PAGESIZE:
+				if (Tcl_GetIntFromObj (interp, objv[arg], &pagingSize) == TCL_ERROR) {
+					Tcl_AppendResult (interp, " while converting paging size", NULL);
+					return TCL_ERROR;
+				}
+				break;
+
+			case OPT_CONSISTENCY:
+				if (casstcl_obj_to_cass_consistency (ct, objv[arg], &consistency) != TCL_OK) {
+					return TCL_ERROR;
+				}
+				consistencyPtr = &consistency;
+				break;
+
+			case OPT_LIST:
+			case OPT_DICT:
+				break;
+		}
+	}
+
+	if (arg + 3 != objc) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "a table, an array name and code must follow the options", NULL);
+		return TCL_ERROR;
+	}
+
+	// the driver doesn't let us see the token map, so the ring is cut
+	// into a few ranges for each stream, enough that a stream that
+	// finishes early has another to go on to
+	if (splits == 0) {
+		splits = parallelism * CASSTCL_SCAN_SPLITS_PER_STREAM;
+	}
+
+	return casstcl_scan (ct, Tcl_GetString (objv[arg]), columnsObj, where, splits, parallelism, pagingSize, consistencyPtr, rowStyle, objv[arg + 1], objv[arg + 2]);
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,56 @@
+/*
+ *
+ * Include file for casstcl_scan
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_scan -- read a whole table a token range at a time
+ *
+ *   The token ring is cut into splits ranges and up to parallelism
+ *   of them are queried at once.  Pages are handed to the code body
+ *   one at a time, in the order they arrive, the same as select
+ *   does.  As soon as a page has been handled, the stream it came
+ *   from asks for its next page or, at the end of its range, starts
+ *   on the next range not yet begun.
+ *
+ * Results:
+ *      A standard Tcl result.  break stops the scan without an error
+ *      and return returns from the caller.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_scan (casstcl_sessionClientData *ct, char *tableName, Tcl_Obj *columnsObj, char *where, int splits, int parallelism, int pagingSize, CassConsistency *consistencyPtr, int rowStyle, Tcl_Obj *varNameObj, Tcl_Obj *codeObj);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_scan_from_objv -- parse the arguments of the scan
+ *   method of a cassandra object and do the scan
+ *
+ *   $cass scan ?-columns list? ?-where condition? ?-splits n?
+ *       ?-parallelism n? ?-pagesize n? ?-consistency level?
+ *       ?-list|-dict? table arrayName code
+ *
+ *   objv[0] is the first of the options.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_scan_from_objv (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[]);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
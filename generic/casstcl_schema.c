@@ -0,0 +1,1534 @@
+/*
+ * casstcl_schema - Functions for importing the column types of the tables
+ *                  in the cluster and looking them up when binding values
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_schema.h"
+#include "casstcl_shared.h"
+#include "casstcl_types.h"
+
+#include <assert.h>
+#include <ctype.h>
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_strndup -- make a null-terminated ckalloc'ed copy of
+ *   a string of a given length
+ *
+ * Results:
+ *      The copy.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static char *
+casstcl_strndup (const char *string, size_t length)
+{
+	char *copy = ckalloc (length + 1);
+
+	memcpy (copy, string, length);
+	copy[length] = '\0';
+	return copy;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_release_table_info -- drop a reference to a table
+ *   descriptor, freeing it and the descriptors of all of its
+ *   columns if it was the last one
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_release_table_info (casstcl_tableInfo *tableInfo)
+{
+	int i;
+
+	// the column type maps of sessions on other threads may hold it too
+	if (__atomic_sub_fetch (&tableInfo->refCount, 1, __ATOMIC_ACQ_REL) > 0) {
+		return;
+	}
+
+	for (i = 0; i < tableInfo->nColumns; i++) {
+		ckfree (tableInfo->columns[i].name);
+		ckfree (tableInfo->columns[i].typeString);
+	}
+
+	Tcl_DeleteHashTable (&tableInfo->columnHash);
+	ckfree ((char *)tableInfo->partitionKey);
+	ckfree ((char *)tableInfo->columns);
+	ckfree (tableInfo->keyspace);
+	ckfree (tableInfo->name);
+	ckfree (tableInfo->fullName);
+	ckfree ((char *)tableInfo);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_column_type_map_init -- initialize an empty column
+ *   type map
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_column_type_map_init (casstcl_columnTypeMap *map)
+{
+	Tcl_InitHashTable (&map->keyspaceHash, TCL_STRING_KEYS);
+	Tcl_InitHashTable (&map->tableHash, TCL_STRING_KEYS);
+	map->lazy = 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_column_type_map_clear -- remove and free all of the
+ *   keyspaces, tables and columns in a column type map
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_column_type_map_clear (casstcl_columnTypeMap *map)
+{
+	Tcl_HashEntry *keyspaceEntry;
+	Tcl_HashSearch keyspaceSearch;
+
+	for (keyspaceEntry = Tcl_FirstHashEntry (&map->keyspaceHash, &keyspaceSearch); keyspaceEntry != NULL; keyspaceEntry = Tcl_NextHashEntry (&keyspaceSearch)) {
+		casstcl_keyspaceInfo *keyspaceInfo = (casstcl_keyspaceInfo *)Tcl_GetHashValue (keyspaceEntry);
+		Tcl_HashEntry *tableEntry;
+		Tcl_HashSearch tableSearch;
+
+		for (tableEntry = Tcl_FirstHashEntry (&keyspaceInfo->tableHash, &tableSearch); tableEntry != NULL; tableEntry = Tcl_NextHashEntry (&tableSearch)) {
+			casstcl_release_table_info ((casstcl_tableInfo *)Tcl_GetHashValue (tableEntry));
+		}
+
+		Tcl_DeleteHashTable (&keyspaceInfo->tableHash);
+		ckfree (keyspaceInfo->name);
+		ckfree ((char *)keyspaceInfo);
+	}
+
+	// start over empty but keep the import mode
+	Tcl_DeleteHashTable (&map->keyspaceHash);
+	Tcl_DeleteHashTable (&map->tableHash);
+	Tcl_InitHashTable (&map->keyspaceHash, TCL_STRING_KEYS);
+	Tcl_InitHashTable (&map->tableHash, TCL_STRING_KEYS);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_column_type_map_add -- put a table descriptor into a
+ *   column type map, creating its keyspace if need be and
+ *   replacing any previous descriptor of the same table.  The map
+ *   takes over the caller's reference to the descriptor
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_column_type_map_add (casstcl_columnTypeMap *map, casstcl_tableInfo *tableInfo)
+{
+	casstcl_keyspaceInfo *keyspaceInfo;
+	Tcl_HashEntry *hashEntry;
+	int new;
+
+	hashEntry = Tcl_CreateHashEntry (&map->keyspaceHash, tableInfo->keyspace, &new);
+	if (new) {
+		keyspaceInfo = (casstcl_keyspaceInfo *)ckalloc (sizeof (casstcl_keyspaceInfo));
+		keyspaceInfo->name = casstcl_strndup (tableInfo->keyspace, strlen (tableInfo->keyspace));
+		Tcl_InitHashTable (&keyspaceInfo->tableHash, TCL_STRING_KEYS);
+		Tcl_SetHashValue (hashEntry, keyspaceInfo);
+	} else {
+		keyspaceInfo = (casstcl_keyspaceInfo *)Tcl_GetHashValue (hashEntry);
+	}
+
+	hashEntry = Tcl_CreateHashEntry (&keyspaceInfo->tableHash, tableInfo->name, &new);
+	if (!new) {
+		casstcl_release_table_info ((casstcl_tableInfo *)Tcl_GetHashValue (hashEntry));
+	}
+	Tcl_SetHashValue (hashEntry, tableInfo);
+
+	hashEntry = Tcl_CreateHashEntry (&map->tableHash, tableInfo->fullName, &new);
+	Tcl_SetHashValue (hashEntry, tableInfo);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_column_type_map_free -- free everything in a column
+ *   type map
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_column_type_map_free (casstcl_columnTypeMap *map)
+{
+	casstcl_column_type_map_clear (map);
+	Tcl_DeleteHashTable (&map->keyspaceHash);
+	Tcl_DeleteHashTable (&map->tableHash);
+}
+
+#ifndef CASSTCL_HAVE_SCHEMA_META
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_validator_to_type_obj --
+ *
+ *      Translate a cassandra validator class name such as
+ *      org.apache.cassandra.db.marshal.UTF8Type into a casstcl type
+ *      such as text, consulting the ::casstcl::validatorTypeLookupCache
+ *      array directly and only calling ::casstcl::validator_to_type if
+ *      it isn't found there.
+ *
+ *      The returned object is either an element of the lookup cache
+ *      array or the interpreter result, so it should be used (or have
+ *      its reference count incremented) before the interpreter
+ *      result is next changed.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_validator_to_type_obj (casstcl_sessionClientData *ct, const char *validator, size_t length, Tcl_Obj **typeObjPtr)
+{
+	Tcl_Interp *interp = ct->interp;
+	Tcl_Obj *evalObjv[2];
+	Tcl_Obj *elementObj;
+	int tclReturn;
+
+	// check the cache array directly from C to avoid calling
+	// Tcl_Eval if possible
+	elementObj = Tcl_GetVar2Ex (interp, "::casstcl::validatorTypeLookupCache", validator, (TCL_GLOBAL_ONLY));
+
+	if (elementObj != NULL) {
+		*typeObjPtr = elementObj;
+		return TCL_OK;
+	}
+
+	// not there, gotta call Tcl to do the heavy lifting
+	// construct a call to our casstcl.tcl library function
+	// validator_to_type to translate the value to a cassandra
+	// data type to text/list
+	evalObjv[0] = Tcl_NewStringObj ("::casstcl::validator_to_type", -1);
+	evalObjv[1] = Tcl_NewStringObj (validator, length);
+
+	Tcl_IncrRefCount (evalObjv[0]);
+	Tcl_IncrRefCount (evalObjv[1]);
+	tclReturn = Tcl_EvalObjv (interp, 2, evalObjv, (TCL_EVAL_GLOBAL|TCL_EVAL_DIRECT));
+	Tcl_DecrRefCount(evalObjv[0]);
+	Tcl_DecrRefCount(evalObjv[1]);
+
+	if (tclReturn == TCL_ERROR) {
+		return TCL_ERROR;
+	}
+
+	*typeObjPtr = Tcl_GetObjResult (interp);
+	return TCL_OK;
+}
+
+#endif
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_schema_get -- take a snapshot of the schema metadata
+ *   maintained by the driver, to be freed with
+ *   casstcl_schema_free
+ *
+ *   The functions from here to casstcl_schema_partition_key_index
+ *   read the metadata the way the version of the driver being
+ *   built against has it.
+ *
+ * Results:
+ *      The snapshot.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static const casstcl_schema *
+casstcl_schema_get (casstcl_sessionClientData *ct)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	return cass_session_get_schema_meta (ct->session);
+#else
+	return cass_session_get_schema (ct->session);
+#endif
+}
+
+static void
+casstcl_schema_free (const casstcl_schema *schema)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	cass_schema_meta_free (schema);
+#else
+	cass_schema_free (schema);
+#endif
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_schema_keyspace, casstcl_schema_table -- find a
+ *   keyspace of the schema, or a table of a keyspace, by name
+ *
+ * Results:
+ *      Its metadata, or NULL if there is none by that name.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static const casstcl_keyspaceMeta *
+casstcl_schema_keyspace (const casstcl_schema *schema, const char *keyspace)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	return cass_schema_meta_keyspace_by_name (schema, keyspace);
+#else
+	return cass_schema_get_keyspace (schema, keyspace);
+#endif
+}
+
+static const casstcl_tableMeta *
+casstcl_schema_table (const casstcl_keyspaceMeta *keyspaceMeta, const char *table)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	return cass_keyspace_meta_table_by_name (keyspaceMeta, table);
+#else
+	return cass_schema_meta_get_entry (keyspaceMeta, table);
+#endif
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_schema_keyspaces, casstcl_schema_tables,
+ *   casstcl_schema_columns -- iterate over the keyspaces of the
+ *   schema, the tables of a keyspace or the columns of a table,
+ *   each got from the iterator with the matching
+ *   casstcl_schema_iterator_* function
+ *
+ * Results:
+ *      An iterator, to be freed with cass_iterator_free.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static CassIterator *
+casstcl_schema_keyspaces (const casstcl_schema *schema)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	return cass_iterator_keyspaces_from_schema_meta (schema);
+#else
+	return cass_iterator_from_schema (schema);
+#endif
+}
+
+static CassIterator *
+casstcl_schema_tables (const casstcl_keyspaceMeta *keyspaceMeta)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	return cass_iterator_tables_from_keyspace_meta (keyspaceMeta);
+#else
+	return cass_iterator_from_schema_meta (keyspaceMeta);
+#endif
+}
+
+static CassIterator *
+casstcl_schema_columns (const casstcl_tableMeta *tableMeta)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	return cass_iterator_columns_from_table_meta (tableMeta);
+#else
+	return cass_iterator_from_schema_meta (tableMeta);
+#endif
+}
+
+static const casstcl_keyspaceMeta *
+casstcl_schema_iterator_keyspace (CassIterator *iterator)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	return cass_iterator_get_keyspace_meta (iterator);
+#else
+	return cass_iterator_get_schema_meta (iterator);
+#endif
+}
+
+static const casstcl_tableMeta *
+casstcl_schema_iterator_table (CassIterator *iterator)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	return cass_iterator_get_table_meta (iterator);
+#else
+	const CassSchemaMeta *tableMeta = cass_iterator_get_schema_meta (iterator);
+
+	assert (cass_schema_meta_type (tableMeta) == CASS_SCHEMA_META_TYPE_TABLE);
+	return tableMeta;
+#endif
+}
+
+static const casstcl_columnMeta *
+casstcl_schema_iterator_column (CassIterator *iterator)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	return cass_iterator_get_column_meta (iterator);
+#else
+	const CassSchemaMeta *columnMeta = cass_iterator_get_schema_meta (iterator);
+
+	assert (cass_schema_meta_type (columnMeta) == CASS_SCHEMA_META_TYPE_COLUMN);
+	return columnMeta;
+#endif
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_schema_keyspace_name, casstcl_schema_table_name,
+ *   casstcl_schema_column_name -- get the name of a keyspace,
+ *   table or column, which isn't null-terminated
+ *
+ *   Some columns, such as one in system.IndexInfo, have no name
+ *   and have to be skipped; with the older drivers reading the
+ *   name of one crashes.
+ *
+ * Results:
+ *      The name is stored in *namePtr.  casstcl_schema_column_name
+ *      returns 0 if the column has no name, else 1.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_schema_keyspace_name (const casstcl_keyspaceMeta *keyspaceMeta, CassString *namePtr)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	cass_keyspace_meta_name (keyspaceMeta, &namePtr->data, &namePtr->length);
+#else
+	const CassSchemaMetaField *field = cass_schema_meta_get_field (keyspaceMeta, "keyspace_name");
+
+	assert (field != NULL);
+	cass_value_get_string (cass_schema_meta_field_value (field), &namePtr->data, &namePtr->length);
+#endif
+}
+
+static void
+casstcl_schema_table_name (const casstcl_tableMeta *tableMeta, CassString *namePtr)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	cass_table_meta_name (tableMeta, &namePtr->data, &namePtr->length);
+#else
+	const CassSchemaMetaField *field = cass_schema_meta_get_field (tableMeta, "columnfamily_name");
+
+	assert (field != NULL);
+	cass_value_get_string (cass_schema_meta_field_value (field), &namePtr->data, &namePtr->length);
+#endif
+}
+
+static int
+casstcl_schema_column_name (const casstcl_columnMeta *columnMeta, CassString *namePtr)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	cass_column_meta_name (columnMeta, &namePtr->data, &namePtr->length);
+	return (namePtr->length > 0);
+#else
+	const CassSchemaMetaField *field = cass_schema_meta_get_field (columnMeta, "column_name");
+	const CassValue *fieldValue;
+
+	assert (field != NULL);
+	fieldValue = cass_schema_meta_field_value (field);
+	if (cass_value_type (fieldValue) != CASS_VALUE_TYPE_VARCHAR) {
+		return 0;
+	}
+	cass_value_get_string (fieldValue, &namePtr->data, &namePtr->length);
+	return 1;
+#endif
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_schema_column_type -- get the casstcl type of a
+ *   column, such as "map text bigint", and whether values of it
+ *   can be bound
+ *
+ *   The older drivers only have the validator class of the
+ *   column, which is translated by casstcl_validator_to_type_obj;
+ *   the later ones have its data type.
+ *
+ * Results:
+ *      A standard Tcl result; it's an error if the type couldn't be
+ *      worked out at all.  Otherwise *typeObjPtr is set to the type,
+ *      which the caller must use before changing the interpreter
+ *      result, and *typeStatusPtr to TCL_OK, with *typeInfo set, if
+ *      the type can be bound, or TCL_ERROR if it can't.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_schema_column_type (casstcl_sessionClientData *ct, const casstcl_columnMeta *columnMeta, Tcl_Obj **typeObjPtr, casstcl_cassTypeInfo *typeInfo, int *typeStatusPtr)
+{
+	typeInfo->cassValueType = CASS_VALUE_TYPE_UNKNOWN;
+	typeInfo->valueSubType1 = CASS_VALUE_TYPE_UNKNOWN;
+	typeInfo->valueSubType2 = CASS_VALUE_TYPE_UNKNOWN;
+
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	*typeStatusPtr = casstcl_data_type_to_type_obj (cass_column_meta_data_type (columnMeta), typeInfo, typeObjPtr);
+	return TCL_OK;
+#else
+	Tcl_Interp *interp = ct->interp;
+	const CassSchemaMetaField *field = cass_schema_meta_get_field (columnMeta, "validator");
+	CassString validator;
+	int typeLength;
+
+	assert (field != NULL);
+	cass_value_get_string (cass_schema_meta_field_value (field), &validator.data, &validator.length);
+
+	if (casstcl_validator_to_type_obj (ct, validator.data, validator.length, typeObjPtr) == TCL_ERROR) {
+		return TCL_ERROR;
+	}
+
+	*typeStatusPtr = TCL_ERROR;
+	Tcl_GetStringFromObj (*typeObjPtr, &typeLength);
+	if (typeLength > 0) {
+		if (Tcl_ConvertToType (interp, *typeObjPtr, &casstcl_cassTypeTclType) == TCL_OK) {
+			*typeInfo = *(casstcl_cassTypeInfo *)&(*typeObjPtr)->internalRep.otherValuePtr;
+			*typeStatusPtr = TCL_OK;
+		}
+	}
+	return TCL_OK;
+#endif
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_schema_partition_key_index -- find where a column of
+ *   a table goes in its partition key
+ *
+ *   With the older drivers that is the column's component index,
+ *   which is null when the key has only one column.
+ *
+ * Results:
+ *      The position of the column in the key, or -1 if it isn't
+ *      part of the key.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_schema_partition_key_index (const casstcl_tableMeta *tableMeta, const casstcl_columnMeta *columnMeta)
+{
+#ifdef CASSTCL_HAVE_SCHEMA_META
+	size_t i;
+
+	for (i = 0; i < cass_table_meta_partition_key_count (tableMeta); i++) {
+		if (cass_table_meta_partition_key (tableMeta, i) == columnMeta) {
+			return (int)i;
+		}
+	}
+	return -1;
+#else
+	const CassSchemaMetaField *field = cass_schema_meta_get_field (columnMeta, "type");
+	cass_int32_t componentIndex = 0;
+	CassString kind;
+
+	if (field == NULL) {
+		return -1;
+	}
+
+	cass_value_get_string (cass_schema_meta_field_value (field), &kind.data, &kind.length);
+	if ((kind.length != 13) || (strncmp (kind.data, "partition_key", 13) != 0)) {
+		return -1;
+	}
+
+	field = cass_schema_meta_get_field (columnMeta, "component_index");
+	if ((field != NULL) && !cass_value_is_null (cass_schema_meta_field_value (field))) {
+		cass_value_get_int32 (cass_schema_meta_field_value (field), &componentIndex);
+	}
+	return componentIndex;
+#endif
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_import_table_columns --
+ *
+ *      Given the schema metadata for a table, build a descriptor for
+ *      it and each of its columns and add it to the session's column
+ *      type map, replacing any descriptor previously imported for the
+ *      same table.  If the session is attached to a shared session,
+ *      the descriptor is also published for the others attached to it.
+ *
+ *      The type of each column is converted to casstcl_cassTypeInfo
+ *      right here so that binding never has to.  Columns of a type we
+ *      can't bind are kept with a typeStatus of TCL_ERROR and the
+ *      error is reported if they are used.  The partition key columns
+ *      are noted too, for partitioned batches.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_import_table_columns (casstcl_sessionClientData *ct, const char *keyspace, const casstcl_tableMeta *tableMeta, casstcl_tableInfo **tableInfoPtr)
+{
+	casstcl_columnTypeMap *map = &ct->columnTypeMap;
+	Tcl_Interp *interp = ct->interp;
+	casstcl_tableInfo *tableInfo;
+	Tcl_HashEntry *hashEntry;
+	CassIterator *iterator;
+	CassString name;
+	Tcl_DString ds;
+	int nColumns = 0;
+	int new;
+
+	casstcl_schema_table_name (tableMeta, &name);
+
+	// count the columns so the descriptors can be allocated in one go
+	iterator = casstcl_schema_columns (tableMeta);
+	while (cass_iterator_next (iterator)) {
+		nColumns++;
+	}
+	cass_iterator_free (iterator);
+
+	tableInfo = (casstcl_tableInfo *)ckalloc (sizeof (casstcl_tableInfo));
+	tableInfo->keyspace = casstcl_strndup (keyspace, strlen (keyspace));
+	tableInfo->name = casstcl_strndup (name.data, name.length);
+	tableInfo->nColumns = 0;
+	tableInfo->columns = (casstcl_columnInfo *)ckalloc (sizeof (casstcl_columnInfo) * (nColumns + 1));
+	tableInfo->nPartitionKeys = 0;
+	tableInfo->partitionKey = (casstcl_columnInfo **)ckalloc (sizeof (casstcl_columnInfo *) * (nColumns + 1));
+	Tcl_InitHashTable (&tableInfo->columnHash, TCL_STRING_KEYS);
+	tableInfo->refCount = 1;
+	tableInfo->stale = 0;
+
+	Tcl_DStringInit (&ds);
+	Tcl_DStringAppend (&ds, keyspace, -1);
+	Tcl_DStringAppend (&ds, ".", 1);
+	Tcl_DStringAppend (&ds, name.data, name.length);
+	tableInfo->fullName = casstcl_strndup (Tcl_DStringValue (&ds), Tcl_DStringLength (&ds));
+	Tcl_DStringFree (&ds);
+
+	// iterate on the columns within the table
+	iterator = casstcl_schema_columns (tableMeta);
+	while (cass_iterator_next (iterator)) {
+		const casstcl_columnMeta *columnMeta = casstcl_schema_iterator_column (iterator);
+		casstcl_columnInfo *columnInfo = &tableInfo->columns[tableInfo->nColumns];
+		Tcl_Obj *typeObj = NULL;
+		int typeLength;
+		char *typeString;
+
+		if (!casstcl_schema_column_name (columnMeta, &name)) {
+			continue;
+		}
+
+		if (casstcl_schema_column_type (ct, columnMeta, &typeObj, &columnInfo->typeInfo, &columnInfo->typeStatus) == TCL_ERROR) {
+			// the column name isn't terminated
+			Tcl_DStringInit (&ds);
+			Tcl_DStringAppend (&ds, name.data, name.length);
+			Tcl_AppendResult (interp, " while importing the type of column '", tableInfo->fullName, ".", Tcl_DStringValue (&ds), "'", NULL);
+			Tcl_DStringFree (&ds);
+			cass_iterator_free (iterator);
+			casstcl_release_table_info (tableInfo);
+			return TCL_ERROR;
+		}
+
+		Tcl_IncrRefCount (typeObj);
+		typeString = Tcl_GetStringFromObj (typeObj, &typeLength);
+
+		columnInfo->name = casstcl_strndup (name.data, name.length);
+		columnInfo->index = tableInfo->nColumns;
+		columnInfo->typeString = casstcl_strndup (typeString, typeLength);
+		Tcl_DecrRefCount (typeObj);
+		Tcl_ResetResult (interp);
+
+		// note the columns of the partition key and where they go in it
+		columnInfo->partitionKeyIndex = casstcl_schema_partition_key_index (tableMeta, columnMeta);
+		if (columnInfo->partitionKeyIndex >= 0) {
+			tableInfo->nPartitionKeys++;
+		}
+
+		hashEntry = Tcl_CreateHashEntry (&tableInfo->columnHash, columnInfo->name, &new);
+		Tcl_SetHashValue (hashEntry, columnInfo);
+		tableInfo->nColumns++;
+	}
+	cass_iterator_free (iterator);
+
+	// list the partition key columns in key order.  if the indexes
+	// don't make sense, fall back to the order the columns came in
+	if (tableInfo->nPartitionKeys > 0) {
+		int i;
+		int nKeys = 0;
+
+		memset (tableInfo->partitionKey, 0, sizeof (casstcl_columnInfo *) * tableInfo->nPartitionKeys);
+		for (i = 0; i < tableInfo->nColumns; i++) {
+			casstcl_columnInfo *columnInfo = &tableInfo->columns[i];
+			int keyIndex = columnInfo->partitionKeyIndex;
+
+			if (keyIndex < 0) {
+				continue;
+			}
+
+			if ((keyIndex >= tableInfo->nPartitionKeys) || (tableInfo->partitionKey[keyIndex] != NULL)) {
+				break;
+			}
+			tableInfo->partitionKey[keyIndex] = columnInfo;
+			nKeys++;
+		}
+
+		if (nKeys != tableInfo->nPartitionKeys) {
+			nKeys = 0;
+			for (i = 0; i < tableInfo->nColumns; i++) {
+				if (tableInfo->columns[i].partitionKeyIndex >= 0) {
+					tableInfo->columns[i].partitionKeyIndex = nKeys;
+					tableInfo->partitionKey[nKeys++] = &tableInfo->columns[i];
+				}
+			}
+		}
+	}
+
+	// sessions attached to the same shared session can use it too
+	if (ct->shared != NULL) {
+		casstcl_shared_publish_table (ct->shared, tableInfo);
+	}
+
+	casstcl_column_type_map_add (map, tableInfo);
+
+	if (tableInfoPtr != NULL) {
+		*tableInfoPtr = tableInfo;
+	}
+	return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_mirror_table_columns --
+ *
+ *      Copy the column types of a table from the session's column type
+ *      map into the ::casstcl::columnTypeMap array, which is kept for
+ *      the benefit of Tcl code such as ::casstcl::typeof.  casstcl
+ *      itself never reads the array.
+ *
+ * Results:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+void
+casstcl_mirror_table_columns (casstcl_sessionClientData *ct, casstcl_tableInfo *tableInfo)
+{
+	Tcl_Interp *interp = ct->interp;
+	Tcl_DString ds;
+	int fullNameLength = strlen (tableInfo->fullName);
+	int i;
+
+	Tcl_DStringInit (&ds);
+	for (i = 0; i < tableInfo->nColumns; i++) {
+		casstcl_columnInfo *columnInfo = &tableInfo->columns[i];
+
+		Tcl_DStringSetLength (&ds, 0);
+		Tcl_DStringAppend (&ds, tableInfo->fullName, fullNameLength);
+		Tcl_DStringAppend (&ds, ".", 1);
+		Tcl_DStringAppend (&ds, columnInfo->name, -1);
+
+		Tcl_SetVar2Ex (interp, "::casstcl::columnTypeMap", Tcl_DStringValue (&ds), Tcl_NewStringObj (columnInfo->typeString, -1), (TCL_GLOBAL_ONLY));
+	}
+	Tcl_DStringFree (&ds);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_unmirror_table_columns --
+ *
+ *      Remove the columns of a table from the ::casstcl::columnTypeMap
+ *      array.
+ *
+ * Results:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+static void
+casstcl_unmirror_table_columns (casstcl_sessionClientData *ct, casstcl_tableInfo *tableInfo)
+{
+	Tcl_DString ds;
+	int fullNameLength = strlen (tableInfo->fullName);
+	int i;
+
+	Tcl_DStringInit (&ds);
+	for (i = 0; i < tableInfo->nColumns; i++) {
+		Tcl_DStringSetLength (&ds, 0);
+		Tcl_DStringAppend (&ds, tableInfo->fullName, fullNameLength);
+		Tcl_DStringAppend (&ds, ".", 1);
+		Tcl_DStringAppend (&ds, tableInfo->columns[i].name, -1);
+
+		Tcl_UnsetVar2 (ct->interp, "::casstcl::columnTypeMap", Tcl_DStringValue (&ds), (TCL_GLOBAL_ONLY));
+	}
+	Tcl_DStringFree (&ds);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_column_type_map_forget --
+ *
+ *      Drop a table from the session's column type map and from the
+ *      ::casstcl::columnTypeMap array, leaving a marker behind so that
+ *      it gets reimported the next time it is looked up, even if the
+ *      map isn't lazy.  It doesn't matter whether the table was known.
+ *      A shared session's copy of the table is dropped as well.
+ *
+ * Results:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+void
+casstcl_column_type_map_forget (casstcl_sessionClientData *ct, const char *keyspace, const char *table)
+{
+	casstcl_columnTypeMap *map = &ct->columnTypeMap;
+	Tcl_HashEntry *hashEntry;
+	Tcl_DString ds;
+	int new;
+
+	hashEntry = Tcl_FindHashEntry (&map->keyspaceHash, keyspace);
+	if (hashEntry != NULL) {
+		casstcl_keyspaceInfo *keyspaceInfo = (casstcl_keyspaceInfo *)Tcl_GetHashValue (hashEntry);
+
+		hashEntry = Tcl_FindHashEntry (&keyspaceInfo->tableHash, table);
+		if (hashEntry != NULL) {
+			casstcl_tableInfo *tableInfo = (casstcl_tableInfo *)Tcl_GetHashValue (hashEntry);
+
+			Tcl_DeleteHashEntry (hashEntry);
+			casstcl_unmirror_table_columns (ct, tableInfo);
+			casstcl_release_table_info (tableInfo);
+		}
+	}
+
+	Tcl_DStringInit (&ds);
+	Tcl_DStringAppend (&ds, keyspace, -1);
+	Tcl_DStringAppend (&ds, ".", 1);
+	Tcl_DStringAppend (&ds, table, -1);
+	hashEntry = Tcl_CreateHashEntry (&map->tableHash, Tcl_DStringValue (&ds), &new);
+	Tcl_SetHashValue (hashEntry, NULL);
+
+	// the other sessions attached to a shared session see their copies
+	// go stale and reimport the table when they next look it up
+	if (ct->shared != NULL) {
+		casstcl_shared_forget_table (ct->shared, Tcl_DStringValue (&ds));
+	}
+	Tcl_DStringFree (&ds);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_column_type_map_forget_keyspace --
+ *
+ *      Drop all of the tables of a keyspace from the session's column
+ *      type map, as casstcl_column_type_map_forget does for one.
+ *
+ * Results:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+void
+casstcl_column_type_map_forget_keyspace (casstcl_sessionClientData *ct, const char *keyspace)
+{
+	Tcl_HashEntry *hashEntry = Tcl_FindHashEntry (&ct->columnTypeMap.keyspaceHash, keyspace);
+	casstcl_keyspaceInfo *keyspaceInfo;
+	Tcl_HashEntry *tableEntry;
+	Tcl_HashSearch tableSearch;
+
+	if (hashEntry == NULL) {
+		return;
+	}
+	keyspaceInfo = (casstcl_keyspaceInfo *)Tcl_GetHashValue (hashEntry);
+
+	// forgetting a table deletes its entry, so restart the search each time
+	while ((tableEntry = Tcl_FirstHashEntry (&keyspaceInfo->tableHash, &tableSearch)) != NULL) {
+		casstcl_tableInfo *tableInfo = (casstcl_tableInfo *)Tcl_GetHashValue (tableEntry);
+
+		casstcl_column_type_map_forget (ct, keyspace, tableInfo->name);
+	}
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_import_table --
+ *
+ *      Import the columns of just one table, given its fully qualified
+ *      name, from the schema metadata managed by the driver into the
+ *      session's column type map, replacing any previous import of it,
+ *      and mirror them into the ::casstcl::columnTypeMap array.
+ *
+ *      If the table isn't in the metadata, any previous import of it is
+ *      dropped and the caller's pointer is set to NULL.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_import_table (casstcl_sessionClientData *ct, const char *table, casstcl_tableInfo **tableInfoPtr)
+{
+	const char *dot = strchr (table, '.');
+	const casstcl_schema *schema;
+	const casstcl_keyspaceMeta *keyspaceMeta;
+	const casstcl_tableMeta *tableMeta = NULL;
+	Tcl_HashEntry *hashEntry;
+	char *keyspace;
+	int tclReturn = TCL_OK;
+
+	*tableInfoPtr = NULL;
+	if (dot == NULL) {
+		return TCL_OK;
+	}
+	keyspace = casstcl_strndup (table, dot - table);
+
+	schema = casstcl_schema_get (ct);
+	keyspaceMeta = casstcl_schema_keyspace (schema, keyspace);
+	if (keyspaceMeta != NULL) {
+		tableMeta = casstcl_schema_table (keyspaceMeta, dot + 1);
+	}
+
+	if (tableMeta == NULL) {
+		// it's gone (or never was), so don't keep the old one around
+		casstcl_column_type_map_forget (ct, keyspace, dot + 1);
+		hashEntry = Tcl_FindHashEntry (&ct->columnTypeMap.tableHash, table);
+		if (hashEntry != NULL) {
+			Tcl_DeleteHashEntry (hashEntry);
+		}
+	} else {
+		tclReturn = casstcl_import_table_columns (ct, keyspace, tableMeta, tableInfoPtr);
+		if (tclReturn == TCL_OK) {
+			casstcl_mirror_table_columns (ct, *tableInfoPtr);
+		}
+	}
+
+	casstcl_schema_free (schema);
+	ckfree (keyspace);
+	return tclReturn;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_import_column_type_map --
+ *
+ *      Traverse the schema metadata managed by the driver, importing
+ *      the columns of every table of every keyspace into the session's
+ *      column type map, which is emptied first, and mirror the result
+ *      into the ::casstcl::columnTypeMap array.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_import_column_type_map (casstcl_sessionClientData *ct)
+{
+	const casstcl_schema *schema = casstcl_schema_get (ct);
+	CassIterator *keyspaceIterator = casstcl_schema_keyspaces (schema);
+	Tcl_Interp *interp = ct->interp;
+	int tclReturn = TCL_OK;
+
+	casstcl_column_type_map_clear (&ct->columnTypeMap);
+	Tcl_UnsetVar (interp, "::casstcl::columnTypeMap", (TCL_GLOBAL_ONLY));
+
+	while (tclReturn == TCL_OK && cass_iterator_next (keyspaceIterator)) {
+		const casstcl_keyspaceMeta *keyspaceMeta = casstcl_schema_iterator_keyspace (keyspaceIterator);
+		CassString name;
+		char *keyspace;
+
+		casstcl_schema_keyspace_name (keyspaceMeta, &name);
+		keyspace = casstcl_strndup (name.data, name.length);
+
+		CassIterator *tableIterator = casstcl_schema_tables (keyspaceMeta);
+		while (cass_iterator_next (tableIterator)) {
+			const casstcl_tableMeta *tableMeta = casstcl_schema_iterator_table (tableIterator);
+			casstcl_tableInfo *tableInfo;
+
+			tclReturn = casstcl_import_table_columns (ct, keyspace, tableMeta, &tableInfo);
+			if (tclReturn != TCL_OK) {
+				break;
+			}
+
+			casstcl_mirror_table_columns (ct, tableInfo);
+		}
+		cass_iterator_free (tableIterator);
+		ckfree (keyspace);
+	}
+
+	cass_iterator_free (keyspaceIterator);
+	casstcl_schema_free (schema);
+
+	if (tclReturn == TCL_OK && ct->shared != NULL) {
+		casstcl_shared_set_complete (ct->shared);
+	}
+	return tclReturn;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_list_keyspaces --
+ *
+ *      Return a list of the extant keyspaces in the cluster by
+ *      examining the metadata managed by the driver.
+ *
+ *      The cpp-driver docs indicate that the driver stays abreast with
+ *      changes to the schema so we prefer to ask it rather than
+ *      caching our own copy, or something.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_list_keyspaces (casstcl_sessionClientData *ct, Tcl_Obj **objPtr) {
+	const casstcl_schema *schema = casstcl_schema_get (ct);
+	CassIterator *iterator = casstcl_schema_keyspaces (schema);
+	Tcl_Obj *listObj = Tcl_NewObj();
+	int tclReturn = TCL_OK;
+
+	while (cass_iterator_next(iterator)) {
+		CassString name;
+
+		casstcl_schema_keyspace_name (casstcl_schema_iterator_keyspace (iterator), &name);
+		if (Tcl_ListObjAppendElement (ct->interp, listObj, Tcl_NewStringObj (name.data, name.length)) == TCL_ERROR) {
+			tclReturn = TCL_ERROR;
+			break;
+		}
+	}
+	cass_iterator_free(iterator);
+	casstcl_schema_free(schema);
+	*objPtr = listObj;
+	return tclReturn;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_list_tables --
+ *
+ *      Set the Tcl result to a list of the extant tables in a keyspace by
+ *      examining the metadata managed by the driver.
+ *
+ *      This is cool because the driver will update the metadata if the
+ *      schema changes during the session and further examinations of the
+ *      metadata by the casstcl metadata-accessing functions will see the
+ *      changes
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_list_tables (casstcl_sessionClientData *ct, char *keyspace, Tcl_Obj **objPtr) {
+	const casstcl_schema *schema = casstcl_schema_get (ct);
+	const casstcl_keyspaceMeta *keyspaceMeta = casstcl_schema_keyspace (schema, keyspace);
+	Tcl_Interp *interp = ct->interp;
+
+	if (keyspaceMeta == NULL) {
+		casstcl_schema_free (schema);
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "keyspace '", keyspace, "' not found", NULL);
+		return TCL_ERROR;
+	}
+
+	CassIterator *iterator = casstcl_schema_tables (keyspaceMeta);
+	Tcl_Obj *listObj = Tcl_NewObj();
+	int tclReturn = TCL_OK;
+
+	while (cass_iterator_next(iterator)) {
+		CassString name;
+
+		casstcl_schema_table_name (casstcl_schema_iterator_table (iterator), &name);
+		if (Tcl_ListObjAppendElement (interp, listObj, Tcl_NewStringObj (name.data, name.length)) == TCL_ERROR) {
+			tclReturn = TCL_ERROR;
+			break;
+		}
+	}
+	cass_iterator_free(iterator);
+	casstcl_schema_free(schema);
+	*objPtr = listObj;
+	return tclReturn;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_list_columns --
+ *
+ *      Set a Tcl object pointer to a list of the extant columns in the
+ *      specified table in the specified keyspace by examining the
+ *      metadata managed by the driver.
+ *
+ *      If includeTypes is 1 then instead of listing just the columns it
+ *      also lists their data types, as a list of key-value pairs.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_list_columns (casstcl_sessionClientData *ct, char *keyspace, char *table, int includeTypes, Tcl_Obj **objPtr) {
+	const casstcl_schema *schema = casstcl_schema_get (ct);
+	Tcl_Interp *interp = ct->interp;
+
+	// locate the keyspace
+	const casstcl_keyspaceMeta *keyspaceMeta = casstcl_schema_keyspace (schema, keyspace);
+
+	if (keyspaceMeta == NULL) {
+		casstcl_schema_free (schema);
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "keyspace '", keyspace, "' not found", NULL);
+		return TCL_ERROR;
+	}
+
+	// locate the table within the keyspace
+	const casstcl_tableMeta *tableMeta = casstcl_schema_table (keyspaceMeta, table);
+
+	if (tableMeta == NULL) {
+		casstcl_schema_free (schema);
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "table '", table, "' not found in keyspace '", keyspace, "'", NULL);
+		return TCL_ERROR;
+	}
+
+	// prepare to iterate on the columns within the table
+	CassIterator *iterator = casstcl_schema_columns (tableMeta);
+	Tcl_Obj *listObj = Tcl_NewObj();
+	int tclReturn = TCL_OK;
+
+	// iterate on the columns within the table
+	while (cass_iterator_next(iterator)) {
+		const casstcl_columnMeta *columnMeta = casstcl_schema_iterator_column (iterator);
+		CassString name;
+
+		// get the column name and append it to the list we are creating
+		if (!casstcl_schema_column_name (columnMeta, &name)) {
+			continue;
+		}
+		if (Tcl_ListObjAppendElement (interp, listObj, Tcl_NewStringObj (name.data, name.length)) == TCL_ERROR) {
+			tclReturn = TCL_ERROR;
+			break;
+		}
+
+		// if including types then get the data type and append it to the
+		// list too
+		if (includeTypes) {
+			Tcl_Obj *elementObj = NULL;
+			casstcl_cassTypeInfo typeInfo;
+			int typeStatus;
+
+			tclReturn = casstcl_schema_column_type (ct, columnMeta, &elementObj, &typeInfo, &typeStatus);
+
+			if (tclReturn == TCL_ERROR) {
+				goto error;
+			}
+
+			if (Tcl_ListObjAppendElement (interp, listObj, elementObj) == TCL_ERROR) {
+				tclReturn = TCL_ERROR;
+				break;
+			}
+		}
+	}
+  error:
+	cass_iterator_free(iterator);
+	casstcl_schema_free(schema);
+	*objPtr = listObj;
+
+	if (tclReturn == TCL_OK) {
+		Tcl_ResetResult (interp);
+	}
+
+	return tclReturn;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_adopt_shared_column_type_map --
+ *
+ *      Fill the column type map of a session attached to a shared
+ *      session with the table descriptors already imported by the
+ *      others attached to it, and mirror them into the
+ *      ::casstcl::columnTypeMap array, instead of traversing the
+ *      driver's schema metadata again.
+ *
+ * Results:
+ *      1 if the map was filled, 0 if the shared session doesn't hold
+ *      an import of the whole schema yet and nothing was done.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_adopt_shared_column_type_map (casstcl_sessionClientData *ct)
+{
+	casstcl_tableInfo **tables;
+	int nTables;
+	int i;
+
+	if (ct->shared == NULL || (tables = casstcl_shared_tables (ct->shared, &nTables)) == NULL) {
+		return 0;
+	}
+
+	casstcl_column_type_map_clear (&ct->columnTypeMap);
+	Tcl_UnsetVar (ct->interp, "::casstcl::columnTypeMap", (TCL_GLOBAL_ONLY));
+
+	for (i = 0; i < nTables; i++) {
+		casstcl_column_type_map_add (&ct->columnTypeMap, tables[i]);
+		casstcl_mirror_table_columns (ct, tables[i]);
+	}
+
+	ckfree ((char *)tables);
+	return 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_lookup_table --
+ *
+ *      Find the descriptor of a table in the session's column type map
+ *      given its fully qualified name, such as wx.wx_metar.
+ *
+ *      A table that isn't there yet in a lazy map, or that has been
+ *      marked for reimport, is imported from the driver's metadata
+ *      first.  Since that replaces the descriptor, callers shouldn't
+ *      hold on to one across calls that might look tables up.
+ *
+ *      In a session attached to a shared session, a descriptor that
+ *      another session has replaced is stale and reimported too, and
+ *      a table another session has already imported, even one created
+ *      since this map was filled, is taken from the shared session
+ *      rather than from the driver.
+ *
+ * Results:
+ *      The table descriptor, or NULL if the table isn't known.
+ *
+ *----------------------------------------------------------------------
+ */
+casstcl_tableInfo *
+casstcl_lookup_table (casstcl_sessionClientData *ct, const char *table)
+{
+	Tcl_HashEntry *hashEntry = Tcl_FindHashEntry (&ct->columnTypeMap.tableHash, table);
+	casstcl_tableInfo *tableInfo;
+
+	if (hashEntry != NULL && (tableInfo = (casstcl_tableInfo *)Tcl_GetHashValue (hashEntry)) != NULL) {
+		if (!__atomic_load_n (&tableInfo->stale, __ATOMIC_ACQUIRE)) {
+			return tableInfo;
+		}
+	}
+
+	if (ct->shared != NULL && (tableInfo = casstcl_shared_find_table (ct->shared, table)) != NULL) {
+		casstcl_column_type_map_add (&ct->columnTypeMap, tableInfo);
+		casstcl_mirror_table_columns (ct, tableInfo);
+		return tableInfo;
+	}
+
+	if (hashEntry == NULL && !ct->columnTypeMap.lazy) {
+		return NULL;
+	}
+
+	// callers report unknown tables in their own terms, so an import
+	// that fails leaves the table unknown rather than an error behind
+	if (casstcl_import_table (ct, table, &tableInfo) != TCL_OK) {
+		Tcl_ResetResult (ct->interp);
+		return NULL;
+	}
+	return tableInfo;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_schema_statement_word --
+ *
+ *      Read a keyword or an identifier of a CQL statement into a
+ *      dynamic string, after skipping any white space.  Unquoted words
+ *      are folded to lower case, as cassandra does; double-quoted ones
+ *      are taken as they are.
+ *
+ * Results:
+ *      A pointer just past the word; the string is left empty if there
+ *      isn't one.
+ *
+ *----------------------------------------------------------------------
+ */
+static const char *
+casstcl_schema_statement_word (const char *p, Tcl_DString *dsPtr)
+{
+	Tcl_DStringSetLength (dsPtr, 0);
+
+	while (isspace ((unsigned char)*p)) {
+		p++;
+	}
+
+	if (*p == '"') {
+		for (p++; *p != '\0'; p++) {
+			if (*p == '"') {
+				if (p[1] != '"') {
+					return p + 1;
+				}
+				p++;
+			}
+			Tcl_DStringAppend (dsPtr, p, 1);
+		}
+		return p;
+	}
+
+	while (isalnum ((unsigned char)*p) || *p == '_') {
+		char c = tolower ((unsigned char)*p);
+
+		Tcl_DStringAppend (dsPtr, &c, 1);
+		p++;
+	}
+	return p;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_schema_note_statement --
+ *
+ *      Look at a CQL statement about to be executed and, if it creates,
+ *      alters or drops a table or a keyspace, drop what it affects from
+ *      the session's column type map so it is reimported from the
+ *      driver's metadata the next time it is used.  A table whose name
+ *      isn't qualified by a keyspace is dropped from all of them.
+ *
+ *      This is called for every statement passed as text, so anything
+ *      that doesn't start with one of the three verbs is let go as soon
+ *      as possible.
+ *
+ * Results:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+void
+casstcl_schema_note_statement (casstcl_sessionClientData *ct, const char *query)
+{
+	const char *p = query;
+	Tcl_DString word;
+	Tcl_DString name;
+	int isTable;
+
+	while (isspace ((unsigned char)*p)) {
+		p++;
+	}
+
+	switch (*p) {
+		case 'a': case 'A':
+		case 'c': case 'C':
+		case 'd': case 'D':
+			break;
+
+		default:
+			return;
+	}
+
+	Tcl_DStringInit (&word);
+	Tcl_DStringInit (&name);
+
+	p = casstcl_schema_statement_word (p, &word);
+	if (strcmp (Tcl_DStringValue (&word), "create") != 0 && strcmp (Tcl_DStringValue (&word), "alter") != 0 && strcmp (Tcl_DStringValue (&word), "drop") != 0) {
+		goto done;
+	}
+
+	p = casstcl_schema_statement_word (p, &word);
+	if (strcmp (Tcl_DStringValue (&word), "table") == 0 || strcmp (Tcl_DStringValue (&word), "columnfamily") == 0) {
+		isTable = 1;
+	} else if (strcmp (Tcl_DStringValue (&word), "keyspace") == 0 || strcmp (Tcl_DStringValue (&word), "schema") == 0) {
+		isTable = 0;
+	} else {
+		goto done;
+	}
+
+	// skip IF EXISTS or IF NOT EXISTS
+	p = casstcl_schema_statement_word (p, &name);
+	if (strcmp (Tcl_DStringValue (&name), "if") == 0) {
+		p = casstcl_schema_statement_word (p, &name);
+		if (strcmp (Tcl_DStringValue (&name), "not") == 0) {
+			p = casstcl_schema_statement_word (p, &name);
+		}
+		p = casstcl_schema_statement_word (p, &name);
+	}
+
+	if (Tcl_DStringLength (&name) == 0) {
+		goto done;
+	}
+
+	if (!isTable) {
+		if (strcmp (Tcl_DStringValue (&word), "create") != 0) {
+			casstcl_column_type_map_forget_keyspace (ct, Tcl_DStringValue (&name));
+		}
+		goto done;
+	}
+
+	if (*p == '.') {
+		// name is the keyspace, the table follows
+		Tcl_DStringSetLength (&word, 0);
+		Tcl_DStringAppend (&word, Tcl_DStringValue (&name), Tcl_DStringLength (&name));
+		casstcl_schema_statement_word (p + 1, &name);
+		if (Tcl_DStringLength (&name) != 0) {
+			casstcl_column_type_map_forget (ct, Tcl_DStringValue (&word), Tcl_DStringValue (&name));
+		}
+	} else {
+		Tcl_HashEntry *hashEntry;
+		Tcl_HashSearch search;
+
+		for (hashEntry = Tcl_FirstHashEntry (&ct->columnTypeMap.keyspaceHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+			casstcl_keyspaceInfo *keyspaceInfo = (casstcl_keyspaceInfo *)Tcl_GetHashValue (hashEntry);
+
+			casstcl_column_type_map_forget (ct, keyspaceInfo->name, Tcl_DStringValue (&name));
+		}
+	}
+
+  done:
+	Tcl_DStringFree (&word);
+	Tcl_DStringFree (&name);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_lookup_column --
+ *
+ *      Find the descriptor of a column within a table descriptor given
+ *      a Tcl object containing the column's name.
+ *
+ * Results:
+ *      The column descriptor, or NULL if the column (or the table,
+ *      if tableInfo is NULL) isn't known.
+ *
+ *----------------------------------------------------------------------
+ */
+casstcl_columnInfo *
+casstcl_lookup_column (casstcl_tableInfo *tableInfo, Tcl_Obj *columnObj)
+{
+	Tcl_HashEntry *hashEntry;
+
+	if (tableInfo == NULL) {
+		return NULL;
+	}
+
+	hashEntry = Tcl_FindHashEntry (&tableInfo->columnHash, Tcl_GetString (columnObj));
+
+	if (hashEntry == NULL) {
+		return NULL;
+	}
+
+	return (casstcl_columnInfo *)Tcl_GetHashValue (hashEntry);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_lookup_column_type --
+ *
+ *      Given a table descriptor (which may be NULL) and a Tcl object
+ *      containing a column name, set the caller's type info to the
+ *      type of the column.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *      TCL_CONTINUE is returned if the column isn't found.  Also in
+ *      that case, the value types are set to CASS_VALUE_TYPE_UNKNOWN.
+ *
+ *      TCL_ERROR is returned if the column is of a type casstcl can't
+ *      handle.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_lookup_column_type (Tcl_Interp *interp, casstcl_tableInfo *tableInfo, Tcl_Obj *columnObj, casstcl_cassTypeInfo *typeInfoPtr)
+{
+	casstcl_columnInfo *columnInfo = casstcl_lookup_column (tableInfo, columnObj);
+
+	if (columnInfo == NULL) {
+		typeInfoPtr->cassValueType = CASS_VALUE_TYPE_UNKNOWN;
+		typeInfoPtr->valueSubType1 = CASS_VALUE_TYPE_UNKNOWN;
+		typeInfoPtr->valueSubType2 = CASS_VALUE_TYPE_UNKNOWN;
+		return TCL_CONTINUE;
+	}
+
+	if (columnInfo->typeStatus != TCL_OK) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "unsupported cassandra type '", columnInfo->typeString, "' for column '", columnInfo->name, "' of table '", tableInfo->fullName, "'", NULL);
+		return TCL_ERROR;
+	}
+
+	*typeInfoPtr = columnInfo->typeInfo; // structure copy
+	return TCL_OK;
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,375 @@
+/*
+ *
+ * Include file for casstcl_schema
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_release_table_info -- drop a reference to a table
+ *   descriptor, freeing it and the descriptors of all of its
+ *   columns if it was the last one
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_release_table_info (casstcl_tableInfo *tableInfo);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_column_type_map_init -- initialize an empty column
+ *   type map
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_column_type_map_init (casstcl_columnTypeMap *map);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_column_type_map_clear -- remove and free all of the
+ *   keyspaces, tables and columns in a column type map
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_column_type_map_clear (casstcl_columnTypeMap *map);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_column_type_map_free -- free everything in a column
+ *   type map
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_column_type_map_free (casstcl_columnTypeMap *map);
+
+#ifndef CASSTCL_HAVE_SCHEMA_META
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_validator_to_type_obj --
+ *
+ *      Translate a cassandra validator class name such as
+ *      org.apache.cassandra.db.marshal.UTF8Type into a casstcl type
+ *      such as text, consulting the ::casstcl::validatorTypeLookupCache
+ *      array directly and only calling ::casstcl::validator_to_type if
+ *      it isn't found there.
+ *
+ *      The returned object is either an element of the lookup cache
+ *      array or the interpreter result, so it should be used (or have
+ *      its reference count incremented) before the interpreter
+ *      result is next changed.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_validator_to_type_obj (casstcl_sessionClientData *ct, const char *validator, size_t length, Tcl_Obj **typeObjPtr);
+#endif
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_import_table_columns --
+ *
+ *      Given the schema metadata for a table, build a descriptor for
+ *      it and each of its columns and add it to the session's column
+ *      type map, replacing any descriptor previously imported for the
+ *      same table.  If the session is attached to a shared session,
+ *      the descriptor is also published for the others attached to it.
+ *
+ *      The type of each column is converted to casstcl_cassTypeInfo
+ *      right here so that binding never has to.  Columns of a type we
+ *      can't bind are kept with a typeStatus of TCL_ERROR and the
+ *      error is reported if they are used.  The partition key columns
+ *      are noted too, for partitioned batches.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_import_table_columns (casstcl_sessionClientData *ct, const char *keyspace, const casstcl_tableMeta *tableMeta, casstcl_tableInfo **tableInfoPtr);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_mirror_table_columns --
+ *
+ *      Copy the column types of a table from the session's column type
+ *      map into the ::casstcl::columnTypeMap array, which is kept for
+ *      the benefit of Tcl code such as ::casstcl::typeof.  casstcl
+ *      itself never reads the array.
+ *
+ * Results:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+void casstcl_mirror_table_columns (casstcl_sessionClientData *ct, casstcl_tableInfo *tableInfo);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_column_type_map_forget --
+ *
+ *      Drop a table from the session's column type map and from the
+ *      ::casstcl::columnTypeMap array, leaving a marker behind so that
+ *      it gets reimported the next time it is looked up, even if the
+ *      map isn't lazy.  It doesn't matter whether the table was known.
+ *      A shared session's copy of the table is dropped as well.
+ *
+ * Results:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+void casstcl_column_type_map_forget (casstcl_sessionClientData *ct, const char *keyspace, const char *table);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_column_type_map_forget_keyspace --
+ *
+ *      Drop all of the tables of a keyspace from the session's column
+ *      type map, as casstcl_column_type_map_forget does for one.
+ *
+ * Results:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+void casstcl_column_type_map_forget_keyspace (casstcl_sessionClientData *ct, const char *keyspace);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_import_table --
+ *
+ *      Import the columns of just one table, given its fully qualified
+ *      name, from the schema metadata managed by the driver into the
+ *      session's column type map, replacing any previous import of it,
+ *      and mirror them into the ::casstcl::columnTypeMap array.
+ *
+ *      If the table isn't in the metadata, any previous import of it is
+ *      dropped and the caller's pointer is set to NULL.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_import_table (casstcl_sessionClientData *ct, const char *table, casstcl_tableInfo **tableInfoPtr);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_import_column_type_map --
+ *
+ *      Traverse the schema metadata managed by the driver, importing
+ *      the columns of every table of every keyspace into the session's
+ *      column type map, which is emptied first, and mirror the result
+ *      into the ::casstcl::columnTypeMap array.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_import_column_type_map (casstcl_sessionClientData *ct);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_list_keyspaces --
+ *
+ *      Return a list of the extant keyspaces in the cluster by
+ *      examining the metadata managed by the driver.
+ *
+ *      The cpp-driver docs indicate that the driver stays abreast with
+ *      changes to the schema so we prefer to ask it rather than
+ *      caching our own copy, or something.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_list_keyspaces (casstcl_sessionClientData *ct, Tcl_Obj **objPtr);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_list_tables --
+ *
+ *      Set the Tcl result to a list of the extant tables in a keyspace by
+ *      examining the metadata managed by the driver.
+ *
+ *      This is cool because the driver will update the metadata if the
+ *      schema changes during the session and further examinations of the
+ *      metadata by the casstcl metadata-accessing functions will see the
+ *      changes
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_list_tables (casstcl_sessionClientData *ct, char *keyspace, Tcl_Obj **objPtr);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_list_columns --
+ *
+ *      Set a Tcl object pointer to a list of the extant columns in the
+ *      specified table in the specified keyspace by examining the
+ *      metadata managed by the driver.
+ *
+ *      If includeTypes is 1 then instead of listing just the columns it
+ *      also lists their data types, as a list of key-value pairs.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_list_columns (casstcl_sessionClientData *ct, char *keyspace, char *table, int includeTypes, Tcl_Obj **objPtr);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_adopt_shared_column_type_map --
+ *
+ *      Fill the column type map of a session attached to a shared
+ *      session with the table descriptors already imported by the
+ *      others attached to it, and mirror them into the
+ *      ::casstcl::columnTypeMap array, instead of traversing the
+ *      driver's schema metadata again.
+ *
+ * Results:
+ *      1 if the map was filled, 0 if the shared session doesn't hold
+ *      an import of the whole schema yet and nothing was done.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_adopt_shared_column_type_map (casstcl_sessionClientData *ct);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_lookup_table --
+ *
+ *      Find the descriptor of a table in the session's column type map
+ *      given its fully qualified name, such as wx.wx_metar.
+ *
+ *      A table that isn't there yet in a lazy map, or that has been
+ *      marked for reimport, is imported from the driver's metadata
+ *      first.  Since that replaces the descriptor, callers shouldn't
+ *      hold on to one across calls that might look tables up.
+ *
+ *      In a session attached to a shared session, a descriptor that
+ *      another session has replaced is stale and reimported too, and
+ *      a table another session has already imported, even one created
+ *      since this map was filled, is taken from the shared session
+ *      rather than from the driver.
+ *
+ * Results:
+ *      The table descriptor, or NULL if the table isn't known.
+ *
+ *----------------------------------------------------------------------
+ */
+casstcl_tableInfo *casstcl_lookup_table (casstcl_sessionClientData *ct, const char *table);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_schema_note_statement --
+ *
+ *      Look at a CQL statement about to be executed and, if it creates,
+ *      alters or drops a table or a keyspace, drop what it affects from
+ *      the session's column type map so it is reimported from the
+ *      driver's metadata the next time it is used.  A table whose name
+ *      isn't qualified by a keyspace is dropped from all of them.
+ *
+ *      This is called for every statement passed as text, so anything
+ *      that doesn't start with one of the three verbs is let go as soon
+ *      as possible.
+ *
+ * Results:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+void casstcl_schema_note_statement (casstcl_sessionClientData *ct, const char *query);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_lookup_column --
+ *
+ *      Find the descriptor of a column within a table descriptor given
+ *      a Tcl object containing the column's name.
+ *
+ * Results:
+ *      The column descriptor, or NULL if the column (or the table,
+ *      if tableInfo is NULL) isn't known.
+ *
+ *----------------------------------------------------------------------
+ */
+casstcl_columnInfo *casstcl_lookup_column (casstcl_tableInfo *tableInfo, Tcl_Obj *columnObj);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_lookup_column_type --
+ *
+ *      Given a table descriptor (which may be NULL) and a Tcl object
+ *      containing a column name, set the caller's type info to the
+ *      type of the column.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *      TCL_CONTINUE is returned if the column isn't found.  Also in
+ *      that case, the value types are set to CASS_VALUE_TYPE_UNKNOWN.
+ *
+ *      TCL_ERROR is returned if the column is of a type casstcl can't
+ *      handle.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_lookup_column_type (Tcl_Interp *interp, casstcl_tableInfo *tableInfo, Tcl_Obj *columnObj, casstcl_cassTypeInfo *typeInfoPtr);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,389 @@
+/*
+ * casstcl_select - Functions for paging through the results of a select
+ *                  asynchronously, delivering the pages to a callback
+ *                  from the Tcl event loop
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_select.h"
+#include "casstcl_cassandra.h"
+#include "casstcl_consistency.h"
+#include "casstcl_error.h"
+#include "casstcl_paging.h"
+#include "casstcl_execution.h"
+#include "casstcl_result.h"
+#include "casstcl_stats.h"
+#include "casstcl_shared.h"
+#include "casstcl_slowlog.h"
+
+#include <assert.h>
+
+static void casstcl_select_future_callback (CassFuture* future, void* data);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_select_free -- unlink an asynchronous select from its
+ *   session (if it still has one) and free it
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_select_free (casstcl_selectClientData *scd)
+{
+	assert (scd->cass_select_magic == CASS_SELECT_MAGIC);
+	assert (scd->future == NULL);
+
+	if (scd->ct != NULL) {
+		if (scd->prev != NULL) {
+			scd->prev->next = scd->next;
+		} else {
+			scd->ct->selectList = scd->next;
+		}
+
+		if (scd->next != NULL) {
+			scd->next->prev = scd->prev;
+		}
+	}
+
+	casstcl_free_column_names (scd->columnNames, scd->columnCount);
+	Tcl_DecrRefCount (scd->callbackObj);
+	cass_statement_free (scd->statement);
+	if (scd->info.text != NULL) {
+		ckfree ((char *)scd->info.text);
+	}
+	scd->cass_select_magic = 0;
+	ckfree ((char *)scd);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_select_fetch -- request the next page of an
+ *   asynchronous select
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      casstcl_select_future_callback will be invoked by the
+ *      driver when the page arrives.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_select_fetch (casstcl_selectClientData *scd)
+{
+	casstcl_stats_start (scd->ct, CASSTCL_STATS_SELECT, &scd->timer);
+	casstcl_slowlog_start (scd->ct, &scd->timer, scd->statement, &scd->info);
+	casstcl_pager_requested (&scd->pager);
+	scd->future = cass_session_execute (scd->ct->session, scd->statement);
+	casstcl_callback_started (scd->ct);
+	cass_future_set_callback (scd->future, casstcl_select_future_callback, scd);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_select_deliver -- invoke the callback of an
+ *   asynchronous select with one page
+ *
+ *   The callback gets a list of key-value pairs: status and
+ *   error_message, as returned by the methods of the same name
+ *   of a future, page, the number of the page starting from 1,
+ *   more, true if there are pages after this one, columns, the
+ *   column names, and rows, the rows of the page.
+ *
+ * Results:
+ *      The return code of the callback.
+ *
+ * Side effects:
+ *      A background error is raised if the callback fails.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_select_deliver (casstcl_selectClientData *scd, CassFuture *future, Tcl_Obj *rowsObj, int more)
+{
+	Tcl_Interp *interp = scd->ct->interp;
+	Tcl_Obj *listObjv[12];
+	CassString cassErrorDesc;
+	CassError rc = cass_future_error_code (future);
+	int tclReturn;
+
+	cass_future_error_message (future, &cassErrorDesc.data, &cassErrorDesc.length);
+
+	listObjv[0] = Tcl_NewStringObj ("status", -1);
+	listObjv[1] = Tcl_NewStringObj (casstcl_cass_error_to_errorcode_string (rc), -1);
+	listObjv[2] = Tcl_NewStringObj ("error_message", -1);
+	listObjv[3] = Tcl_NewStringObj (cassErrorDesc.data, cassErrorDesc.length);
+	listObjv[4] = Tcl_NewStringObj ("page", -1);
+	listObjv[5] = Tcl_NewIntObj (scd->pageCount);
+	listObjv[6] = Tcl_NewStringObj ("more", -1);
+	listObjv[7] = Tcl_NewBooleanObj (more);
+	listObjv[8] = Tcl_NewStringObj ("columns", -1);
+	listObjv[9] = Tcl_NewListObj (scd->columnCount, scd->columnNames);
+	listObjv[10] = Tcl_NewStringObj ("rows", -1);
+	listObjv[11] = (rowsObj != NULL) ? rowsObj : Tcl_NewObj ();
+
+	scd->delivering = 1;
+	tclReturn = casstcl_invoke_callback_with_argument (interp, scd->callbackObj, Tcl_NewListObj (12, listObjv));
+	scd->delivering = 0;
+
+	return tclReturn;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_select_eventProc --
+ *
+ *    this routine is called by the Tcl event handler when a page of
+ *    an asynchronous select has arrived
+ *
+ * Results:
+ *    If there are more pages, the next one is requested and then the
+ *    rows of this one are delivered to the callback.  The select is
+ *    freed after its last page, an error, or a break or error from
+ *    the callback.
+ *
+ *----------------------------------------------------------------------
+ */
+static int
+casstcl_select_eventProc (Tcl_Event *tevPtr, int flags) {
+	casstcl_selectEvent *evPtr = (casstcl_selectEvent *)tevPtr;
+	casstcl_selectClientData *scd = evPtr->scd;
+	CassFuture *future = scd->future;
+	const CassResult *result = NULL;
+	casstcl_resultRef *resultRef = NULL;
+	Tcl_Obj *rowsObj = NULL;
+	int more = 0;
+	int tclReturn;
+
+	assert (scd->cass_select_magic == CASS_SELECT_MAGIC);
+
+	// if the callback is entering the event loop while it looks at
+	// the previous page, leave this page queued until it's done so
+	// that the pages are delivered in order
+	if (scd->delivering) {
+		return 0;
+	}
+
+	scd->future = NULL;
+
+	// we were told to stop, or the session went away, while this page
+	// was in flight
+	if (scd->cancelled) {
+		cass_future_free (future);
+		casstcl_select_free (scd);
+		return 1;
+	}
+
+	scd->pageCount++;
+
+	CassError rc = cass_future_error_code (future);
+	if (rc == CASS_OK) {
+		result = cass_future_get_result (future);
+	}
+
+	if (result == NULL) {
+		casstcl_select_deliver (scd, future, NULL, 0);
+		cass_future_free (future);
+		casstcl_select_free (scd);
+		return 1;
+	}
+
+	if (scd->columnNames == NULL) {
+		scd->columnNames = casstcl_result_column_names (result, &scd->columnCount);
+	}
+
+	// start fetching the next page before delivering this one so that
+	// the cluster is working on it while Tcl works on these rows
+	if (cass_result_has_more_pages (result)) {
+		int pageSize = scd->pager.pageSize;
+
+		more = 1;
+		if (casstcl_pager_next (scd->ct, &scd->pager, result, scd->columnCount) != pageSize) {
+			cass_statement_set_paging_size (scd->statement, scd->pager.pageSize);
+		}
+		cass_statement_set_paging_state (scd->statement, result);
+		casstcl_select_fetch (scd);
+	}
+
+	resultRef = casstcl_result_ref_new (result);
+
+	if (casstcl_result_rows_to_obj (scd->ct, resultRef, scd->columnNames, scd->columnCount, scd->rowStyle, &rowsObj) == TCL_ERROR) {
+		Tcl_BackgroundError (scd->ct->interp);
+		tclReturn = TCL_ERROR;
+	} else {
+		tclReturn = casstcl_select_deliver (scd, future, rowsObj, more);
+	}
+
+	casstcl_result_ref_release (resultRef);
+	cass_future_free (future);
+
+	// a break (or an error) from the callback stops the select; if the
+	// next page is already on its way it will be thrown away when it
+	// gets here
+	if ((tclReturn == TCL_BREAK) || (tclReturn == TCL_ERROR)) {
+		scd->cancelled = 1;
+	}
+
+	if (scd->future == NULL) {
+		casstcl_select_free (scd);
+	}
+
+	return 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_select_future_callback --
+ *
+ *    this routine is called by the cassandra cpp-driver, from one of its
+ *    own threads, when a page requested by an asynchronous select has
+ *    arrived or failed
+ *
+ * Results:
+ *    an event is queued to the thread that started the select
+ *
+ *----------------------------------------------------------------------
+ */
+static void
+casstcl_select_future_callback (CassFuture* future, void* data) {
+	casstcl_selectClientData *scd = data;
+	casstcl_sessionClientData *ct = scd->timer.ct;
+	casstcl_selectEvent *evPtr;
+
+	casstcl_stats_finish (&scd->timer, future, cass_future_error_code (future));
+
+	evPtr = (casstcl_selectEvent *) ckalloc (sizeof (casstcl_selectEvent));
+	evPtr->event.proc = casstcl_select_eventProc;
+	evPtr->scd = scd;
+	Tcl_ThreadQueueEvent (scd->threadId, (Tcl_Event *)evPtr, TCL_QUEUE_TAIL);
+	Tcl_ThreadAlert (scd->threadId);
+
+	// scd->ct may have been cleared by now, but not the timer's
+	casstcl_callback_finished (ct);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_select_async --
+ *
+ *      Given a cassandra statement and a callback, start paging through
+ *      the results of the statement without waiting for them; the
+ *      statement is freed when the select is done.  As each page
+ *      arrives, the callback is invoked from the event loop with the
+ *      rows of the page, as lists or as dicts according to rowStyle.
+ *      timeoutMS, unless it is -1, is the request timeout of each page.
+ *      pagingSize is the number of rows per page, or as for
+ *      casstcl_pager_start.  info describes the statement to the slow
+ *      request log.
+ *
+ *      The request for each page after the first is issued as soon as
+ *      the page before it has arrived, before its rows are given to the
+ *      callback, so that fetching a page overlaps processing the one
+ *      before it.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_select_async (casstcl_sessionClientData *ct, CassStatement *statement, casstcl_statementInfo *info, Tcl_Obj *callbackObj, int pagingSize, int timeoutMS, int rowStyle)
+{
+	casstcl_selectClientData *scd;
+
+	casstcl_statement_set_execution (statement, 1, timeoutMS);
+
+	scd = (casstcl_selectClientData *)ckalloc (sizeof (casstcl_selectClientData));
+	cass_statement_set_paging_size (statement, casstcl_pager_start (ct, &scd->pager, pagingSize));
+	scd->cass_select_magic = CASS_SELECT_MAGIC;
+	scd->ct = ct;
+	scd->threadId = ct->threadId;
+	scd->statement = statement;
+	scd->future = NULL;
+	scd->callbackObj = callbackObj;
+	Tcl_IncrRefCount (callbackObj);
+	scd->rowStyle = (rowStyle == CASSTCL_ROWS_LIST) ? CASSTCL_ROWS_LIST : CASSTCL_ROWS_DICT;
+	scd->pageCount = 0;
+	scd->delivering = 0;
+	scd->cancelled = 0;
+	scd->columnNames = NULL;
+	scd->columnCount = 0;
+
+	scd->info.text = NULL;
+	scd->info.consistency = info->consistency;
+	if (ct->slowlog.limit > 0 && info->text != NULL) {
+		char *text = ckalloc (strlen (info->text) + 1);
+
+		strcpy (text, info->text);
+		scd->info.text = text;
+	}
+
+	scd->prev = NULL;
+	scd->next = ct->selectList;
+	if (scd->next != NULL) {
+		scd->next->prev = scd;
+	}
+	ct->selectList = scd;
+
+	casstcl_select_fetch (scd);
+
+	Tcl_ResetResult (ct->interp);
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_select_orphan_all -- called when a session is being
+ *   deleted to detach it from any asynchronous selects that are
+ *   still running
+ *
+ *   The selects are cancelled; each is freed when its page in
+ *   flight arrives, without invoking its callback.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_select_orphan_all (casstcl_sessionClientData *ct)
+{
+	casstcl_selectClientData *scd = ct->selectList;
+
+	while (scd != NULL) {
+		casstcl_selectClientData *next = scd->next;
+
+		scd->cancelled = 1;
+		scd->prev = NULL;
+		scd->next = NULL;
+		scd->ct = NULL;
+		scd = next;
+	}
+
+	ct->selectList = NULL;
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,58 @@
+/*
+ *
+ * Include file for casstcl_select
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_select_async --
+ *
+ *      Given a cassandra statement and a callback, start paging through
+ *      the results of the statement without waiting for them; the
+ *      statement is freed when the select is done.  As each page
+ *      arrives, the callback is invoked from the event loop with the
+ *      rows of the page, as lists or as dicts according to rowStyle.
+ *      timeoutMS, unless it is -1, is the request timeout of each page.
+ *      pagingSize is the number of rows per page, or as for
+ *      casstcl_pager_start.  info describes the statement to the slow
+ *      request log.
+ *
+ *      The request for each page after the first is issued as soon as
+ *      the page before it has arrived, before its rows are given to the
+ *      callback, so that fetching a page overlaps processing the one
+ *      before it.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_select_async (casstcl_sessionClientData *ct, CassStatement *statement, casstcl_statementInfo *info, Tcl_Obj *callbackObj, int pagingSize, int timeoutMS, int rowStyle);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_select_orphan_all -- called when a session is being
+ *   deleted to detach it from any asynchronous selects that are
+ *   still running
+ *
+ *   The selects are cancelled; each is freed when its page in
+ *   flight arrives, without invoking its callback.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_select_orphan_all (casstcl_sessionClientData *ct);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,512 @@
+/*
+ * casstcl_shared - Functions for sharing one driver session among the
+ *                  session objects of several interpreters and threads
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_shared.h"
+#include "casstcl_schema.h"
+
+#include <assert.h>
+
+// the shared sessions of the process, by name
+static casstcl_sharedSession *casstcl_sharedSessions = NULL;
+TCL_DECLARE_MUTEX(casstcl_sharedSessionsMutex)
+
+// guards the last of a session object's callbacks finishing against
+// casstcl_callbacks_wait, which frees the object once it has
+TCL_DECLARE_MUTEX(casstcl_callbacksMutex)
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_find -- find a shared session by name; the
+ *   caller must hold casstcl_sharedSessionsMutex
+ *
+ * Results:
+ *      The shared session, or NULL if there is none by that name.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static casstcl_sharedSession *
+casstcl_shared_find (const char *name)
+{
+	casstcl_sharedSession *shared;
+
+	for (shared = casstcl_sharedSessions; shared != NULL; shared = shared->next) {
+		if (strcmp (shared->name, name) == 0) {
+			break;
+		}
+	}
+	return shared;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_share -- publish the driver session of a
+ *   session object under a name, so that session objects in
+ *   other interpreters and threads can attach to it
+ *
+ *   The session object holds the first reference to the shared
+ *   session and stops owning its cluster, session and ssl
+ *   context; they are freed when the last object attached to the
+ *   shared session is deleted.  The tables already in its column
+ *   type map are published along with it.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_shared_share (casstcl_sessionClientData *ct, const char *name)
+{
+	casstcl_sharedSession *shared;
+	Tcl_HashEntry *hashEntry;
+	Tcl_HashSearch search;
+	int complete;
+
+	if (ct->shared != NULL) {
+		Tcl_ResetResult (ct->interp);
+		Tcl_AppendResult (ct->interp, "session is already shared as '", ct->shared->name, "'", NULL);
+		return TCL_ERROR;
+	}
+
+	Tcl_MutexLock (&casstcl_sharedSessionsMutex);
+	if (casstcl_shared_find (name) != NULL) {
+		Tcl_MutexUnlock (&casstcl_sharedSessionsMutex);
+		Tcl_ResetResult (ct->interp);
+		Tcl_AppendResult (ct->interp, "a shared session named '", name, "' already exists", NULL);
+		return TCL_ERROR;
+	}
+
+	shared = (casstcl_sharedSession *)ckalloc (sizeof (casstcl_sharedSession));
+	shared->name = ckalloc (strlen (name) + 1);
+	strcpy (shared->name, name);
+	shared->refCount = 1;
+	shared->cluster = ct->cluster;
+	shared->session = ct->session;
+	shared->ssl = ct->ssl;
+	shared->mutex = NULL;
+	Tcl_InitHashTable (&shared->tableHash, TCL_STRING_KEYS);
+	shared->complete = 0;
+
+	shared->next = casstcl_sharedSessions;
+	casstcl_sharedSessions = shared;
+	Tcl_MutexUnlock (&casstcl_sharedSessionsMutex);
+
+	// start the shared session off with the tables the object has
+	// imported.  it holds the whole schema unless the map is lazy or
+	// has tables marked for reimport
+	complete = !ct->columnTypeMap.lazy;
+	for (hashEntry = Tcl_FirstHashEntry (&ct->columnTypeMap.tableHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+		casstcl_tableInfo *tableInfo = (casstcl_tableInfo *)Tcl_GetHashValue (hashEntry);
+
+		if (tableInfo == NULL) {
+			complete = 0;
+		} else {
+			casstcl_shared_publish_table (shared, tableInfo);
+		}
+	}
+	if (complete) {
+		casstcl_shared_set_complete (shared);
+	}
+
+	ct->shared = shared;
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_attach -- find a shared session by name and
+ *   take a reference to it
+ *
+ * Results:
+ *      The shared session, or NULL with an error message in the
+ *      interpreter result if there is none by that name.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_sharedSession *
+casstcl_shared_attach (Tcl_Interp *interp, const char *name)
+{
+	casstcl_sharedSession *shared;
+
+	Tcl_MutexLock (&casstcl_sharedSessionsMutex);
+	shared = casstcl_shared_find (name);
+	if (shared != NULL) {
+		shared->refCount++;
+	}
+	Tcl_MutexUnlock (&casstcl_sharedSessionsMutex);
+
+	if (shared == NULL) {
+		Tcl_ResetResult (interp);
+		Tcl_AppendResult (interp, "no shared session named '", name, "'", NULL);
+	}
+	return shared;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_release -- drop a reference to a shared
+ *   session
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      When the last reference goes, the shared session is taken
+ *      off the list, the driver session is closed and freed, which
+ *      waits for any requests still outstanding on it, and the
+ *      cluster, ssl context and shared table descriptors are freed.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_shared_release (casstcl_sharedSession *shared)
+{
+	casstcl_sharedSession **sharedPtr;
+	Tcl_HashEntry *hashEntry;
+	Tcl_HashSearch search;
+
+	Tcl_MutexLock (&casstcl_sharedSessionsMutex);
+	if (--shared->refCount > 0) {
+		Tcl_MutexUnlock (&casstcl_sharedSessionsMutex);
+		return;
+	}
+
+	for (sharedPtr = &casstcl_sharedSessions; *sharedPtr != shared; sharedPtr = &(*sharedPtr)->next) {
+		assert (*sharedPtr != NULL);
+	}
+	*sharedPtr = shared->next;
+	Tcl_MutexUnlock (&casstcl_sharedSessionsMutex);
+
+	cass_session_free (shared->session);
+	cass_cluster_free (shared->cluster);
+	cass_ssl_free (shared->ssl);
+
+	for (hashEntry = Tcl_FirstHashEntry (&shared->tableHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+		casstcl_release_table_info ((casstcl_tableInfo *)Tcl_GetHashValue (hashEntry));
+	}
+	Tcl_DeleteHashTable (&shared->tableHash);
+	Tcl_MutexFinalize (&shared->mutex);
+
+	ckfree (shared->name);
+	ckfree ((char *)shared);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_list -- set the interpreter result to a list
+ *   of the names of the shared sessions and how many session
+ *   objects are attached to each of them
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_shared_list (Tcl_Interp *interp)
+{
+	Tcl_Obj *listObj = Tcl_NewObj ();
+	casstcl_sharedSession *shared;
+
+	Tcl_MutexLock (&casstcl_sharedSessionsMutex);
+	for (shared = casstcl_sharedSessions; shared != NULL; shared = shared->next) {
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj (shared->name, -1));
+		Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewIntObj (shared->refCount));
+	}
+	Tcl_MutexUnlock (&casstcl_sharedSessionsMutex);
+
+	Tcl_SetObjResult (interp, listObj);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_publish_table -- make a newly imported table
+ *   descriptor available to all of the session objects attached
+ *   to a shared session
+ *
+ *   The shared session takes a reference of its own.  A
+ *   descriptor previously published for the same table is marked
+ *   stale, so that the session objects holding it take the new
+ *   one the next time they look the table up.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_shared_publish_table (casstcl_sharedSession *shared, casstcl_tableInfo *tableInfo)
+{
+	casstcl_tableInfo *oldTableInfo = NULL;
+	Tcl_HashEntry *hashEntry;
+	int new;
+
+	__atomic_add_fetch (&tableInfo->refCount, 1, __ATOMIC_RELAXED);
+
+	Tcl_MutexLock (&shared->mutex);
+	hashEntry = Tcl_CreateHashEntry (&shared->tableHash, tableInfo->fullName, &new);
+	if (!new) {
+		oldTableInfo = (casstcl_tableInfo *)Tcl_GetHashValue (hashEntry);
+	}
+	Tcl_SetHashValue (hashEntry, tableInfo);
+	Tcl_MutexUnlock (&shared->mutex);
+
+	if (oldTableInfo != NULL) {
+		__atomic_store_n (&oldTableInfo->stale, 1, __ATOMIC_RELEASE);
+		casstcl_release_table_info (oldTableInfo);
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_find_table -- find the descriptor of a table
+ *   in a shared session, given its fully qualified name
+ *
+ * Results:
+ *      The descriptor, with a reference taken for the caller, or
+ *      NULL if no session attached to the shared session has
+ *      imported the table.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_tableInfo *
+casstcl_shared_find_table (casstcl_sharedSession *shared, const char *table)
+{
+	casstcl_tableInfo *tableInfo = NULL;
+	Tcl_HashEntry *hashEntry;
+
+	Tcl_MutexLock (&shared->mutex);
+	hashEntry = Tcl_FindHashEntry (&shared->tableHash, table);
+	if (hashEntry != NULL) {
+		tableInfo = (casstcl_tableInfo *)Tcl_GetHashValue (hashEntry);
+		__atomic_add_fetch (&tableInfo->refCount, 1, __ATOMIC_RELAXED);
+	}
+	Tcl_MutexUnlock (&shared->mutex);
+
+	return tableInfo;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_forget_table -- drop a table that a schema
+ *   statement has changed from a shared session, marking its
+ *   descriptor stale for the session objects still holding it
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The shared session no longer counts as holding the whole
+ *      schema, so session objects attaching to it import it from
+ *      the driver again.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_shared_forget_table (casstcl_sharedSession *shared, const char *table)
+{
+	casstcl_tableInfo *tableInfo = NULL;
+	Tcl_HashEntry *hashEntry;
+
+	Tcl_MutexLock (&shared->mutex);
+	hashEntry = Tcl_FindHashEntry (&shared->tableHash, table);
+	if (hashEntry != NULL) {
+		tableInfo = (casstcl_tableInfo *)Tcl_GetHashValue (hashEntry);
+		Tcl_DeleteHashEntry (hashEntry);
+	}
+	shared->complete = 0;
+	Tcl_MutexUnlock (&shared->mutex);
+
+	if (tableInfo != NULL) {
+		__atomic_store_n (&tableInfo->stale, 1, __ATOMIC_RELEASE);
+		casstcl_release_table_info (tableInfo);
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_set_complete -- note that the whole schema has
+ *   been imported into a shared session
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_shared_set_complete (casstcl_sharedSession *shared)
+{
+	Tcl_MutexLock (&shared->mutex);
+	shared->complete = 1;
+	Tcl_MutexUnlock (&shared->mutex);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_tables -- get all of the table descriptors of
+ *   a shared session that holds the whole schema
+ *
+ * Results:
+ *      A ckalloc'ed array of the descriptors, with a reference
+ *      taken to each for the caller, and their number, or NULL if
+ *      the whole schema hasn't been imported.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_tableInfo **
+casstcl_shared_tables (casstcl_sharedSession *shared, int *countPtr)
+{
+	casstcl_tableInfo **tables = NULL;
+	Tcl_HashEntry *hashEntry;
+	Tcl_HashSearch search;
+	int count = 0;
+
+	Tcl_MutexLock (&shared->mutex);
+	if (shared->complete) {
+		tables = (casstcl_tableInfo **)ckalloc (sizeof (casstcl_tableInfo *) * (shared->tableHash.numEntries + 1));
+		for (hashEntry = Tcl_FirstHashEntry (&shared->tableHash, &search); hashEntry != NULL; hashEntry = Tcl_NextHashEntry (&search)) {
+			casstcl_tableInfo *tableInfo = (casstcl_tableInfo *)Tcl_GetHashValue (hashEntry);
+
+			__atomic_add_fetch (&tableInfo->refCount, 1, __ATOMIC_RELAXED);
+			tables[count++] = tableInfo;
+		}
+	}
+	Tcl_MutexUnlock (&shared->mutex);
+
+	*countPtr = count;
+	return tables;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_callback_started -- note that a driver callback that
+ *   uses a session object has been set
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_callback_started (casstcl_sessionClientData *ct)
+{
+	__atomic_add_fetch (&ct->pendingCallbacks, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_callback_finished -- note that a driver callback is
+ *   done with its session object; this must be the last thing
+ *   the callback does with it
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_callback_finished (casstcl_sessionClientData *ct)
+{
+	int pending = __atomic_load_n (&ct->pendingCallbacks, __ATOMIC_RELAXED);
+
+	// a waiter only wakes for the last one, so the others needn't lock
+	while (pending > 1) {
+		if (__atomic_compare_exchange_n (&ct->pendingCallbacks, &pending, pending - 1, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+			return;
+		}
+	}
+
+	// the count only drops to zero with the mutex held, so a waiter
+	// can't see it and free the object until this is done with it
+	Tcl_MutexLock (&casstcl_callbacksMutex);
+	if (__atomic_sub_fetch (&ct->pendingCallbacks, 1, __ATOMIC_RELEASE) == 0) {
+		Tcl_ConditionNotify (&ct->callbacksDone);
+	}
+	Tcl_MutexUnlock (&casstcl_callbacksMutex);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_callbacks_wait -- wait for all of the driver
+ *   callbacks that use a session object to have run
+ *
+ *   An object attached to a shared session uses this when it is
+ *   deleted, since the driver session, and the wait done by
+ *   cass_session_free, outlives it.  The callbacks only queue
+ *   work for the object's thread and never wait for it, so this
+ *   can't deadlock, but it lasts as long as the slowest of the
+ *   object's requests, up to the request timeout.  The last of
+ *   the callbacks wakes it.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_callbacks_wait (casstcl_sessionClientData *ct)
+{
+	Tcl_MutexLock (&casstcl_callbacksMutex);
+	while (__atomic_load_n (&ct->pendingCallbacks, __ATOMIC_ACQUIRE) > 0) {
+		Tcl_ConditionWait (&ct->callbacksDone, &casstcl_callbacksMutex, NULL);
+	}
+	Tcl_MutexUnlock (&casstcl_callbacksMutex);
+	Tcl_ConditionFinalize (&ct->callbacksDone);
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,237 @@
+/*
+ *
+ * Include file for casstcl_shared
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_share -- publish the driver session of a
+ *   session object under a name, so that session objects in
+ *   other interpreters and threads can attach to it
+ *
+ *   The session object holds the first reference to the shared
+ *   session and stops owning its cluster, session and ssl
+ *   context; they are freed when the last object attached to the
+ *   shared session is deleted.  The tables already in its column
+ *   type map are published along with it.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_shared_share (casstcl_sessionClientData *ct, const char *name);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_attach -- find a shared session by name and
+ *   take a reference to it
+ *
+ * Results:
+ *      The shared session, or NULL with an error message in the
+ *      interpreter result if there is none by that name.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_sharedSession *casstcl_shared_attach (Tcl_Interp *interp, const char *name);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_release -- drop a reference to a shared
+ *   session
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      When the last reference goes, the shared session is taken
+ *      off the list, the driver session is closed and freed, which
+ *      waits for any requests still outstanding on it, and the
+ *      cluster, ssl context and shared table descriptors are freed.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_shared_release (casstcl_sharedSession *shared);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_list -- set the interpreter result to a list
+ *   of the names of the shared sessions and how many session
+ *   objects are attached to each of them
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_shared_list (Tcl_Interp *interp);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_publish_table -- make a newly imported table
+ *   descriptor available to all of the session objects attached
+ *   to a shared session
+ *
+ *   The shared session takes a reference of its own.  A
+ *   descriptor previously published for the same table is marked
+ *   stale, so that the session objects holding it take the new
+ *   one the next time they look the table up.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_shared_publish_table (casstcl_sharedSession *shared, casstcl_tableInfo *tableInfo);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_find_table -- find the descriptor of a table
+ *   in a shared session, given its fully qualified name
+ *
+ * Results:
+ *      The descriptor, with a reference taken for the caller, or
+ *      NULL if no session attached to the shared session has
+ *      imported the table.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_tableInfo *casstcl_shared_find_table (casstcl_sharedSession *shared, const char *table);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_forget_table -- drop a table that a schema
+ *   statement has changed from a shared session, marking its
+ *   descriptor stale for the session objects still holding it
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The shared session no longer counts as holding the whole
+ *      schema, so session objects attaching to it import it from
+ *      the driver again.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_shared_forget_table (casstcl_sharedSession *shared, const char *table);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_set_complete -- note that the whole schema has
+ *   been imported into a shared session
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_shared_set_complete (casstcl_sharedSession *shared);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_shared_tables -- get all of the table descriptors of
+ *   a shared session that holds the whole schema
+ *
+ * Results:
+ *      A ckalloc'ed array of the descriptors, with a reference
+ *      taken to each for the caller, and their number, or NULL if
+ *      the whole schema hasn't been imported.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_tableInfo **casstcl_shared_tables (casstcl_sharedSession *shared, int *countPtr);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_callback_started -- note that a driver callback that
+ *   uses a session object has been set
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_callback_started (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_callback_finished -- note that a driver callback is
+ *   done with its session object; this must be the last thing
+ *   the callback does with it
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_callback_finished (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_callbacks_wait -- wait for all of the driver
+ *   callbacks that use a session object to have run
+ *
+ *   An object attached to a shared session uses this when it is
+ *   deleted, since the driver session, and the wait done by
+ *   cass_session_free, outlives it.  The callbacks only queue
+ *   work for the object's thread and never wait for it, so this
+ *   can't deadlock, but it lasts as long as the slowest of the
+ *   object's requests, up to the request timeout.  The last of
+ *   the callbacks wakes it.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_callbacks_wait (casstcl_sessionClientData *ct);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
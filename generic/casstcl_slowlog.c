@@ -0,0 +1,583 @@
+/*
+ * casstcl_slowlog - Functions for keeping the slowest requests of a
+ *                   session, optionally with tracing turned on for them
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_slowlog.h"
+#include "casstcl_stats.h"
+#include "casstcl_error.h"
+#include "casstcl_consistency.h"
+#include "casstcl_objtypes.h"
+
+#include <stdlib.h>
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_init -- set up the slow request log of a new
+ *   session, turned off
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_slowlog_init (casstcl_sessionClientData *ct)
+{
+	casstcl_slowlog *slowlog = &ct->slowlog;
+
+	slowlog->mutex = NULL;
+	slowlog->entries = NULL;
+	slowlog->limit = 0;
+	slowlog->count = 0;
+	slowlog->floor = -1;
+	slowlog->sampleRate = 0.0;
+	slowlog->seen = 0;
+
+	// any seed but zero will do, this one differs between sessions
+	slowlog->sampleSeed = (unsigned int)(((size_t)ct >> 4) | 1);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_clear -- throw away the entries of a slow
+ *   request log
+ *
+ *   The caller must hold the log's mutex, if anyone else may be
+ *   using it.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The saved requests are freed.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_slowlog_clear (casstcl_slowlog *slowlog)
+{
+	int i;
+
+	for (i = 0; i < slowlog->count; i++) {
+		ckfree ((char *)slowlog->entries[i].request);
+	}
+	slowlog->count = 0;
+	__atomic_store_n (&slowlog->floor, -1, __ATOMIC_RELEASE);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_free -- free the slow request log of a session
+ *
+ *   This is called once the driver can no longer complete any
+ *   of the session's requests.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_slowlog_free (casstcl_sessionClientData *ct)
+{
+	casstcl_slowlog *slowlog = &ct->slowlog;
+
+	casstcl_slowlog_clear (slowlog);
+	if (slowlog->entries != NULL) {
+		ckfree ((char *)slowlog->entries);
+		slowlog->entries = NULL;
+	}
+	slowlog->limit = 0;
+	Tcl_MutexFinalize (&slowlog->mutex);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_start -- note what a request is about as it is
+ *   handed to the driver, if the slow request log is on
+ *
+ *   This is called just after casstcl_stats_start, from the
+ *   session's thread.  If the request is picked by the sample
+ *   rate, tracing is turned on for statement, which may be NULL
+ *   for batches, whose tracing can't be set in this driver.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The timer's request is set, to be recorded or freed by
+ *      casstcl_stats_finish.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_slowlog_start (casstcl_sessionClientData *ct, casstcl_requestTimer *timer, CassStatement *statement, casstcl_statementInfo *info)
+{
+	casstcl_slowlog *slowlog = &ct->slowlog;
+	casstcl_slowlogRequest *request;
+	const char *text;
+	size_t length;
+
+	if (slowlog->limit == 0 || timer->kind == CASSTCL_STATS_NONE) {
+		return;
+	}
+
+	text = (info->text != NULL) ? info->text : "";
+	length = strlen (text);
+	request = (casstcl_slowlogRequest *)ckalloc (sizeof (casstcl_slowlogRequest) + length);
+	request->consistency = info->consistency;
+	request->traced = 0;
+	memcpy (request->text, text, length + 1);
+
+#ifdef CASSTCL_HAVE_TRACING
+	if (statement != NULL && slowlog->sampleRate > 0.0) {
+		unsigned int seed = slowlog->sampleSeed;
+
+		// xorshift, only the session's thread samples
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		slowlog->sampleSeed = seed;
+
+		// set either way, since the pages of a select share their
+		// statement
+		request->traced = (seed / 4294967296.0 < slowlog->sampleRate);
+		cass_statement_set_tracing (statement, request->traced ? cass_true : cass_false);
+	}
+#endif
+
+	timer->request = request;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_discard -- forget what the slow request log
+ *   was told about a request that was never executed
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The timer's request is freed.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_slowlog_discard (casstcl_requestTimer *timer)
+{
+	if (timer->request != NULL) {
+		ckfree ((char *)timer->request);
+		timer->request = NULL;
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_finish -- offer a completed request to the
+ *   slow request log
+ *
+ *   This may be called from the driver's threads.  Requests no
+ *   slower than the fastest of a full log are turned away
+ *   without taking the mutex.  future, if it isn't NULL, is
+ *   where the tracing id of a traced request is found.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The request is either kept by the log or freed.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_slowlog_finish (casstcl_sessionClientData *ct, casstcl_slowlogRequest *request, int kind, Tcl_WideInt startTime, Tcl_WideInt latency, CassError rc, CassFuture *future)
+{
+	casstcl_slowlog *slowlog = &ct->slowlog;
+	casstcl_slowlogEntry *entry;
+	int haveTracingId = 0;
+	CassUuid tracingId;
+	int i;
+
+	__atomic_add_fetch (&slowlog->seen, 1, __ATOMIC_RELAXED);
+
+	if (latency <= __atomic_load_n (&slowlog->floor, __ATOMIC_ACQUIRE)) {
+		ckfree ((char *)request);
+		return;
+	}
+
+#ifdef CASSTCL_HAVE_TRACING
+	// outside of the mutex, a timed out trace may be some time coming
+	if (request->traced && future != NULL && cass_future_tracing_id (future, &tracingId) == CASS_OK) {
+		haveTracingId = 1;
+	}
+#endif
+
+	Tcl_MutexLock (&slowlog->mutex);
+
+	// the log may have been turned off or filled up in the meantime
+	if (slowlog->limit == 0 || latency <= slowlog->floor) {
+		Tcl_MutexUnlock (&slowlog->mutex);
+		ckfree ((char *)request);
+		return;
+	}
+
+	if (slowlog->count < slowlog->limit) {
+		entry = &slowlog->entries[slowlog->count++];
+	} else {
+		// replace the fastest, which is what the floor is
+		entry = &slowlog->entries[0];
+		for (i = 1; i < slowlog->count; i++) {
+			if (slowlog->entries[i].latency < entry->latency) {
+				entry = &slowlog->entries[i];
+			}
+		}
+		ckfree ((char *)entry->request);
+	}
+
+	entry->latency = latency;
+	entry->startTime = startTime;
+	entry->kind = kind;
+	entry->rc = rc;
+	entry->haveTracingId = haveTracingId;
+	if (haveTracingId) {
+		entry->tracingId = tracingId;
+	}
+	entry->haveCoordinator = 0;
+	entry->request = request;
+
+	if (slowlog->count == slowlog->limit) {
+		Tcl_WideInt floor = slowlog->entries[0].latency;
+
+		for (i = 1; i < slowlog->count; i++) {
+			if (slowlog->entries[i].latency < floor) {
+				floor = slowlog->entries[i].latency;
+			}
+		}
+		__atomic_store_n (&slowlog->floor, floor, __ATOMIC_RELEASE);
+	}
+
+	Tcl_MutexUnlock (&slowlog->mutex);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_configure -- the slowlog_config method of a
+ *   session, which sets how many requests the slow request log
+ *   keeps and what fraction of requests are traced
+ *
+ *   objv starts with the object and method names.  A limit of
+ *   zero turns the log off.  Changing the limit empties the log.
+ *
+ * Results:
+ *      A standard Tcl result, which on success is a list of the
+ *      settings and the number of requests the log has looked at.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_slowlog_configure (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[])
+{
+	Tcl_Interp *interp = ct->interp;
+	casstcl_slowlog *slowlog = &ct->slowlog;
+	int limit = -1;
+	double sampleRate = slowlog->sampleRate;
+	int arg;
+	int subOptIndex;
+
+	static CONST char *subOptions[] = {
+		"-limit",
+		"-sample",
+		NULL
+	};
+
+	enum subOptions {
+		SUBOPT_LIMIT,
+		SUBOPT_SAMPLE
+	};
+
+	if ((objc % 2) != 0) {
+		Tcl_WrongNumArgs (interp, 2, objv, "?-limit count? ?-sample fraction?");
+		return TCL_ERROR;
+	}
+
+	for (arg = 2; arg < objc; arg += 2) {
+		if (Tcl_GetIndexFromObj (interp, objv[arg], subOptions, "subOption", TCL_EXACT, &subOptIndex) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		if ((enum subOptions) subOptIndex == SUBOPT_LIMIT) {
+			if (Tcl_GetIntFromObj (interp, objv[arg + 1], &limit) == TCL_ERROR) {
+				Tcl_AppendResult (interp, " while converting -limit element", NULL);
+				return TCL_ERROR;
+			}
+
+			if (limit < 0) {
+				Tcl_ResetResult (interp);
+				Tcl_AppendResult (interp, "slow request log limit must not be negative", NULL);
+				return TCL_ERROR;
+			}
+		} else {
+			if (Tcl_GetDoubleFromObj (interp, objv[arg + 1], &sampleRate) == TCL_ERROR) {
+				Tcl_AppendResult (interp, " while converting -sample element", NULL);
+				return TCL_ERROR;
+			}
+
+			if (sampleRate < 0.0 || sampleRate > 1.0) {
+				Tcl_ResetResult (interp);
+				Tcl_AppendResult (interp, "slow request log sample must be between 0 and 1", NULL);
+				return TCL_ERROR;
+			}
+
+#ifndef CASSTCL_HAVE_TRACING
+			if (sampleRate > 0.0) {
+				Tcl_ResetResult (interp);
+				Tcl_AppendResult (interp, "request tracing requires cpp-driver 2.10 or later", NULL);
+				return TCL_ERROR;
+			}
+#endif
+		}
+	}
+
+	// sampling is no use without somewhere to keep what it finds
+	if (limit < 0 && slowlog->limit == 0 && sampleRate > 0.0) {
+		limit = CASSTCL_SLOWLOG_DEFAULT_LIMIT;
+	}
+
+	Tcl_MutexLock (&slowlog->mutex);
+	if (limit >= 0 && limit != slowlog->limit) {
+		casstcl_slowlog_clear (slowlog);
+		if (slowlog->entries != NULL) {
+			ckfree ((char *)slowlog->entries);
+			slowlog->entries = NULL;
+		}
+		if (limit > 0) {
+			slowlog->entries = (casstcl_slowlogEntry *)ckalloc (sizeof (casstcl_slowlogEntry) * limit);
+		}
+		slowlog->limit = limit;
+	}
+	slowlog->sampleRate = sampleRate;
+	Tcl_MutexUnlock (&slowlog->mutex);
+
+	Tcl_Obj *listObjv[6];
+
+	listObjv[0] = Tcl_NewStringObj ("limit", -1);
+	listObjv[1] = Tcl_NewIntObj (slowlog->limit);
+	listObjv[2] = Tcl_NewStringObj ("sample", -1);
+	listObjv[3] = Tcl_NewDoubleObj (slowlog->sampleRate);
+	listObjv[4] = Tcl_NewStringObj ("seen", -1);
+	listObjv[5] = Tcl_NewWideIntObj (__atomic_load_n (&slowlog->seen, __ATOMIC_RELAXED));
+	Tcl_SetObjResult (interp, Tcl_NewListObj (6, listObjv));
+	return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_compare -- qsort comparison putting the
+ *   slowest entries first
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_slowlog_compare (const void *a, const void *b)
+{
+	const casstcl_slowlogEntry *entryA = a;
+	const casstcl_slowlogEntry *entryB = b;
+
+	if (entryA->latency != entryB->latency) {
+		return (entryA->latency > entryB->latency) ? -1 : 1;
+	}
+	return 0;
+}
+
+#ifdef CASSTCL_HAVE_TRACING
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_find_coordinators -- look up in
+ *   system_traces.sessions the coordinator of each traced entry
+ *   of the slow request log that doesn't have one yet
+ *
+ *   The cluster writes a trace after answering the request, so a
+ *   trace may not be there yet; its entry is looked up again the
+ *   next time.  The lookups run all at once, without the log's
+ *   mutex, and entries are matched up again by tracing id
+ *   afterwards since the log may have changed in the meantime.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The coordinators found are saved in the log.
+ *
+ *--------------------------------------------------------------
+ */
+static void
+casstcl_slowlog_find_coordinators (casstcl_sessionClientData *ct)
+{
+	casstcl_slowlog *slowlog = &ct->slowlog;
+	CassUuid *tracingIds;
+	CassFuture **futures;
+	int count = 0;
+	int i;
+	int j;
+
+	Tcl_MutexLock (&slowlog->mutex);
+	tracingIds = (CassUuid *)ckalloc (sizeof (CassUuid) * (slowlog->count + 1));
+	for (i = 0; i < slowlog->count; i++) {
+		if (slowlog->entries[i].haveTracingId && !slowlog->entries[i].haveCoordinator) {
+			tracingIds[count++] = slowlog->entries[i].tracingId;
+		}
+	}
+	Tcl_MutexUnlock (&slowlog->mutex);
+
+	if (count == 0) {
+		ckfree ((char *)tracingIds);
+		return;
+	}
+
+	futures = (CassFuture **)ckalloc (sizeof (CassFuture *) * count);
+	for (i = 0; i < count; i++) {
+		CassStatement *statement = cass_statement_new ("SELECT coordinator FROM system_traces.sessions WHERE session_id = ?", 1);
+
+		cass_statement_bind_uuid (statement, 0, tracingIds[i]);
+		futures[i] = cass_session_execute (ct->session, statement);
+		cass_statement_free (statement);
+	}
+
+	for (i = 0; i < count; i++) {
+		const CassResult *result;
+		const CassRow *row;
+		CassInet coordinator;
+
+		cass_future_wait (futures[i]);
+		result = (cass_future_error_code (futures[i]) == CASS_OK) ? cass_future_get_result (futures[i]) : NULL;
+		cass_future_free (futures[i]);
+
+		if (result == NULL) {
+			continue;
+		}
+
+		row = cass_result_first_row (result);
+		if (row != NULL && cass_value_get_inet (cass_row_get_column (row, 0), &coordinator) == CASS_OK) {
+			Tcl_MutexLock (&slowlog->mutex);
+			for (j = 0; j < slowlog->count; j++) {
+				casstcl_slowlogEntry *entry = &slowlog->entries[j];
+
+				if (entry->haveTracingId && entry->tracingId.time_and_version == tracingIds[i].time_and_version && entry->tracingId.clock_seq_and_node == tracingIds[i].clock_seq_and_node) {
+					entry->coordinator = coordinator;
+					entry->haveCoordinator = 1;
+				}
+			}
+			Tcl_MutexUnlock (&slowlog->mutex);
+		}
+		cass_result_free (result);
+	}
+
+	ckfree ((char *)futures);
+	ckfree ((char *)tracingIds);
+}
+#endif
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_obj -- describe the requests in the slow
+ *   request log of a session, emptying it afterwards if reset
+ *   is set
+ *
+ * Results:
+ *      A new list with a dict for each request, slowest first,
+ *      giving its latency_us, kind, status, statement text,
+ *      consistency, whether it was traced and if so its
+ *      tracing_id and coordinator, and when it was started as
+ *      started_ms.
+ *
+ * Side effects:
+ *      The coordinators of traced requests are looked up, waiting
+ *      for the cluster.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *
+casstcl_slowlog_obj (casstcl_sessionClientData *ct, int reset)
+{
+	casstcl_slowlog *slowlog = &ct->slowlog;
+	Tcl_Obj *listObj = Tcl_NewObj ();
+	int i;
+
+#ifdef CASSTCL_HAVE_TRACING
+	casstcl_slowlog_find_coordinators (ct);
+#endif
+
+#define CASSTCL_SLOWLOG_APPEND(name, obj) \
+	Tcl_ListObjAppendElement (NULL, entryObj, Tcl_NewStringObj ((name), -1)); \
+	Tcl_ListObjAppendElement (NULL, entryObj, (obj))
+
+	Tcl_MutexLock (&slowlog->mutex);
+	qsort (slowlog->entries, slowlog->count, sizeof (casstcl_slowlogEntry), casstcl_slowlog_compare);
+
+	for (i = 0; i < slowlog->count; i++) {
+		casstcl_slowlogEntry *entry = &slowlog->entries[i];
+		casstcl_slowlogRequest *request = entry->request;
+		Tcl_Obj *entryObj = Tcl_NewObj ();
+		const char *consistency = "default";
+		char tracingId[CASS_UUID_STRING_LENGTH];
+
+		if (request->consistency != CASSTCL_CONSISTENCY_DEFAULT) {
+			consistency = casstcl_cass_consistency_to_string ((CassConsistency)request->consistency);
+		}
+
+		tracingId[0] = '\0';
+		if (entry->haveTracingId) {
+			cass_uuid_string (entry->tracingId, tracingId);
+		}
+
+		CASSTCL_SLOWLOG_APPEND ("latency_us", Tcl_NewWideIntObj (entry->latency));
+		CASSTCL_SLOWLOG_APPEND ("kind", Tcl_NewStringObj (casstcl_stats_kind_name (entry->kind), -1));
+		CASSTCL_SLOWLOG_APPEND ("status", Tcl_NewStringObj (casstcl_cass_error_to_errorcode_string (entry->rc), -1));
+		CASSTCL_SLOWLOG_APPEND ("statement", Tcl_NewStringObj (request->text, -1));
+		CASSTCL_SLOWLOG_APPEND ("consistency", Tcl_NewStringObj (consistency, -1));
+		CASSTCL_SLOWLOG_APPEND ("traced", Tcl_NewBooleanObj (request->traced));
+		CASSTCL_SLOWLOG_APPEND ("tracing_id", Tcl_NewStringObj (tracingId, -1));
+		CASSTCL_SLOWLOG_APPEND ("coordinator", entry->haveCoordinator ? casstcl_NewInetObj (entry->coordinator) : Tcl_NewObj ());
+		CASSTCL_SLOWLOG_APPEND ("started_ms", Tcl_NewWideIntObj (entry->startTime / 1000));
+
+		Tcl_ListObjAppendElement (NULL, listObj, entryObj);
+	}
+
+	if (reset) {
+		casstcl_slowlog_clear (slowlog);
+	}
+	Tcl_MutexUnlock (&slowlog->mutex);
+
+#undef CASSTCL_SLOWLOG_APPEND
+
+	return listObj;
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
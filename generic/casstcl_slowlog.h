@@ -0,0 +1,147 @@
+/*
+ *
+ * Include file for casstcl_slowlog
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_init -- set up the slow request log of a new
+ *   session, turned off
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_slowlog_init (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_free -- free the slow request log of a session
+ *
+ *   This is called once the driver can no longer complete any
+ *   of the session's requests.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_slowlog_free (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_start -- note what a request is about as it is
+ *   handed to the driver, if the slow request log is on
+ *
+ *   This is called just after casstcl_stats_start, from the
+ *   session's thread.  If the request is picked by the sample
+ *   rate, tracing is turned on for statement, which may be NULL
+ *   for batches, whose tracing can't be set in this driver.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The timer's request is set, to be recorded or freed by
+ *      casstcl_stats_finish.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_slowlog_start (casstcl_sessionClientData *ct, casstcl_requestTimer *timer, CassStatement *statement, casstcl_statementInfo *info);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_discard -- forget what the slow request log
+ *   was told about a request that was never executed
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The timer's request is freed.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_slowlog_discard (casstcl_requestTimer *timer);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_finish -- offer a completed request to the
+ *   slow request log
+ *
+ *   This may be called from the driver's threads.  Requests no
+ *   slower than the fastest of a full log are turned away
+ *   without taking the mutex.  future, if it isn't NULL, is
+ *   where the tracing id of a traced request is found.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The request is either kept by the log or freed.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_slowlog_finish (casstcl_sessionClientData *ct, casstcl_slowlogRequest *request, int kind, Tcl_WideInt startTime, Tcl_WideInt latency, CassError rc, CassFuture *future);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_configure -- the slowlog_config method of a
+ *   session, which sets how many requests the slow request log
+ *   keeps and what fraction of requests are traced
+ *
+ *   objv starts with the object and method names.  A limit of
+ *   zero turns the log off.  Changing the limit empties the log.
+ *
+ * Results:
+ *      A standard Tcl result, which on success is a list of the
+ *      settings and the number of requests the log has looked at.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int casstcl_slowlog_configure (casstcl_sessionClientData *ct, int objc, Tcl_Obj *CONST objv[]);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_slowlog_obj -- describe the requests in the slow
+ *   request log of a session, emptying it afterwards if reset
+ *   is set
+ *
+ * Results:
+ *      A new list with a dict for each request, slowest first,
+ *      giving its latency_us, kind, status, statement text,
+ *      consistency, whether it was traced and if so its
+ *      tracing_id and coordinator, and when it was started as
+ *      started_ms.
+ *
+ * Side effects:
+ *      The coordinators of traced requests are looked up, waiting
+ *      for the cluster.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *casstcl_slowlog_obj (casstcl_sessionClientData *ct, int reset);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
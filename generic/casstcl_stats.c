@@ -0,0 +1,592 @@
+/*
+ * casstcl_stats - Functions for counting the requests of a session and
+ *                 keeping histograms of their latencies
+ *
+ * casstcl - Tcl interface to CassDB
+ *
+ * Copyright (C) 2014 FlightAware LLC
+ *
+ * freely redistributable under the Berkeley license
+ */
+
+#include "casstcl.h"
+#include "casstcl_stats.h"
+#include "casstcl_shared.h"
+#include "casstcl_inflight.h"
+#include "casstcl_paging.h"
+#include "casstcl_slowlog.h"
+#include "casstcl_rowcache.h"
+#include "casstcl_await.h"
+
+static CONST char *casstcl_stats_kind_names[] = {
+	"exec",
+	"async",
+	"select",
+	"batch",
+	"counter",
+	NULL
+};
+
+// append a key and its value to listObj
+#define CASSTCL_STATS_APPEND(name, obj) \
+	Tcl_ListObjAppendElement (NULL, listObj, Tcl_NewStringObj ((name), -1)); \
+	Tcl_ListObjAppendElement (NULL, listObj, (obj))
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_now -- the current time in microseconds
+ *
+ * Results:
+ *      The time.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static Tcl_WideInt
+casstcl_stats_now (void)
+{
+	Tcl_Time now;
+
+	Tcl_GetTime (&now);
+	return ((Tcl_WideInt)now.sec * 1000000) + now.usec;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_bucket -- find the histogram bucket for a
+ *   latency
+ *
+ * Results:
+ *      The index of the bucket.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static int
+casstcl_stats_bucket (Tcl_WideInt us)
+{
+	int bits = 0;
+
+	if (us < (1 << CASSTCL_STATS_SUB_BUCKET_BITS)) {
+		return (us < 0) ? 0 : (int)us;
+	}
+
+	if (us >= ((Tcl_WideInt)1 << CASSTCL_STATS_MAX_BITS)) {
+		return CASSTCL_STATS_BUCKETS - 1;
+	}
+
+	while ((us >> bits) >= (2 << CASSTCL_STATS_SUB_BUCKET_BITS)) {
+		bits++;
+	}
+
+	// us >> bits is now between 2^SUB_BUCKET_BITS and twice that, and
+	// its low bits pick the bucket within its power of two
+	return ((bits + 1) << CASSTCL_STATS_SUB_BUCKET_BITS) + (int)((us >> bits) & ((1 << CASSTCL_STATS_SUB_BUCKET_BITS) - 1));
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_bucket_limit -- find the highest latency that
+ *   goes in a histogram bucket
+ *
+ * Results:
+ *      The latency, in microseconds.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static Tcl_WideInt
+casstcl_stats_bucket_limit (int bucket)
+{
+	int bits = (bucket >> CASSTCL_STATS_SUB_BUCKET_BITS) - 1;
+	Tcl_WideInt subBucket = bucket & ((1 << CASSTCL_STATS_SUB_BUCKET_BITS) - 1);
+
+	if (bits < 0) {
+		return bucket;
+	}
+
+	return (((subBucket + (1 << CASSTCL_STATS_SUB_BUCKET_BITS) + 1) << bits) - 1);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_init -- set up the request statistics of a new
+ *   session, with everything zero
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_stats_init (casstcl_sessionClientData *ct)
+{
+	memset (ct->requestStats, 0, sizeof (ct->requestStats));
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_reset -- clear the request statistics of a
+ *   session
+ *
+ *   The in-flight gauges are kept, since the requests that are
+ *   outstanding will still be counted out when they complete.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_stats_reset (casstcl_sessionClientData *ct)
+{
+	int kind;
+
+	for (kind = 0; kind < CASSTCL_STATS_KINDS; kind++) {
+		casstcl_requestStats *stats = &ct->requestStats[kind];
+		int inFlight = __atomic_load_n (&stats->inFlight, __ATOMIC_ACQUIRE);
+
+		memset (stats, 0, sizeof (casstcl_requestStats));
+		__atomic_store_n (&stats->inFlight, inFlight, __ATOMIC_RELEASE);
+		stats->peakInFlight = inFlight;
+	}
+
+	casstcl_paging_stats_reset (ct);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_start -- count a request that is being handed
+ *   to the driver and start timing it
+ *
+ *   A timer of kind CASSTCL_STATS_NONE is set up to not count
+ *   anything, for requests that are recorded elsewhere or not
+ *   at all.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The timer is filled in.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_stats_start (casstcl_sessionClientData *ct, int kind, casstcl_requestTimer *timer)
+{
+	casstcl_requestStats *stats;
+	int inFlight;
+
+	timer->ct = ct;
+	timer->kind = kind;
+	timer->startTime = 0;
+	timer->request = NULL;
+	timer->writes.tables = NULL;
+	timer->writes.count = 0;
+
+	if (kind == CASSTCL_STATS_NONE) {
+		return;
+	}
+
+	stats = &ct->requestStats[kind];
+	timer->startTime = casstcl_stats_now ();
+	__atomic_add_fetch (&stats->requests, 1, __ATOMIC_RELAXED);
+	inFlight = __atomic_add_fetch (&stats->inFlight, 1, __ATOMIC_ACQ_REL);
+
+	// only the session's thread starts requests, so there is nobody to
+	// race with for the peak
+	if (inFlight > stats->peakInFlight) {
+		stats->peakInFlight = inFlight;
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_finish -- record a request that has completed
+ *
+ *   This may be called from the driver's threads.  The request is
+ *   also offered to the slow request log, which looks for its
+ *   tracing id in future, if that isn't NULL, and the upserts it
+ *   made are no longer in flight for the row cache.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The timer is set to CASSTCL_STATS_NONE, so that the request
+ *      can't be counted twice.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_stats_finish (casstcl_requestTimer *timer, CassFuture *future, CassError rc)
+{
+	casstcl_requestStats *stats;
+	Tcl_WideInt latency;
+	Tcl_WideInt latencyMax;
+	int kind = timer->kind;
+
+	if (kind == CASSTCL_STATS_NONE) {
+		casstcl_stats_discard (timer);
+		return;
+	}
+
+	stats = &timer->ct->requestStats[kind];
+	timer->kind = CASSTCL_STATS_NONE;
+	casstcl_row_cache_writes_finished (&timer->writes);
+
+	latency = casstcl_stats_now () - timer->startTime;
+	if (latency < 0) {
+		latency = 0;
+	}
+
+	if (timer->request != NULL) {
+		casstcl_slowlog_finish (timer->ct, timer->request, kind, timer->startTime, latency, rc, future);
+		timer->request = NULL;
+	}
+
+	__atomic_sub_fetch (&stats->inFlight, 1, __ATOMIC_ACQ_REL);
+	__atomic_add_fetch (&stats->histogram[casstcl_stats_bucket (latency)], 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch (&stats->latencyTotal, latency, __ATOMIC_RELAXED);
+
+	latencyMax = __atomic_load_n (&stats->latencyMax, __ATOMIC_RELAXED);
+	while (latency > latencyMax && !__atomic_compare_exchange_n (&stats->latencyMax, &latencyMax, latency, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+	}
+
+	if (rc == CASS_OK) {
+		return;
+	}
+
+	__atomic_add_fetch (&stats->errors, 1, __ATOMIC_RELAXED);
+	if (CASS_ERROR_SOURCE (rc) < 4) {
+		__atomic_add_fetch (&stats->sourceErrors[CASS_ERROR_SOURCE (rc)], 1, __ATOMIC_RELAXED);
+	}
+
+	switch (rc) {
+		case CASS_ERROR_LIB_REQUEST_TIMED_OUT:
+		case CASS_ERROR_SERVER_READ_TIMEOUT:
+		case CASS_ERROR_SERVER_WRITE_TIMEOUT:
+			__atomic_add_fetch (&stats->timeouts, 1, __ATOMIC_RELAXED);
+			break;
+
+		case CASS_ERROR_SERVER_UNAVAILABLE:
+		case CASS_ERROR_LIB_NO_HOSTS_AVAILABLE:
+			__atomic_add_fetch (&stats->unavailable, 1, __ATOMIC_RELAXED);
+			break;
+
+		default:
+			break;
+	}
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_discard -- let go of what a timer holds for a
+ *   request that was never executed, or isn't counted
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The timer's slow request log entry is freed and its writes
+ *      are finished.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_stats_discard (casstcl_requestTimer *timer)
+{
+	casstcl_slowlog_discard (timer);
+	casstcl_row_cache_writes_finished (&timer->writes);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_timer_copy -- copy a timer for a driver
+ *   callback to finish when the request completes
+ *
+ *   This is for requests whose future may be gone before the
+ *   request completes, so that the timer can't live in it.
+ *
+ * Results:
+ *      A new timer, which casstcl_stats_timer_callback frees.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_requestTimer *
+casstcl_stats_timer_copy (casstcl_requestTimer *timer)
+{
+	casstcl_requestTimer *copy = (casstcl_requestTimer *)ckalloc (sizeof (casstcl_requestTimer));
+
+	*copy = *timer;
+	return copy;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_timer_callback -- record a request whose future
+ *   nobody is waiting for as it completes
+ *
+ *   This is called from the driver's threads with a copy made
+ *   by casstcl_stats_timer_copy.  As well as being recorded, the
+ *   request is taken out of the session's in-flight window, and
+ *   anybody awaiting its future is woken up.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The timer is freed.
+ *
+ *--------------------------------------------------------------
+ */
+void
+casstcl_stats_timer_callback (CassFuture* future, void* data)
+{
+	casstcl_requestTimer *timer = data;
+	casstcl_sessionClientData *ct = timer->ct;
+
+	casstcl_stats_finish (timer, future, cass_future_error_code (future));
+	ckfree ((char *)timer);
+	casstcl_inflight_finished (ct);
+	casstcl_await_wakeup (ct);
+	casstcl_callback_finished (ct);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_kind_name -- the name of a kind of request, as
+ *   used in the statistics
+ *
+ * Results:
+ *      The name, or "none" for CASSTCL_STATS_NONE.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+const char *
+casstcl_stats_kind_name (int kind)
+{
+	if (kind < 0 || kind >= CASSTCL_STATS_KINDS) {
+		return "none";
+	}
+	return casstcl_stats_kind_names[kind];
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_percentile -- find the latency below which a
+ *   fraction of a histogram's requests fall
+ *
+ * Results:
+ *      The highest latency in the bucket the percentile falls in,
+ *      but no more than the highest latency seen, or 0 if there
+ *      are no requests.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static Tcl_WideInt
+casstcl_stats_percentile (Tcl_WideInt *histogram, Tcl_WideInt count, Tcl_WideInt latencyMax, double fraction)
+{
+	Tcl_WideInt target = (Tcl_WideInt)(count * fraction + 0.999999);
+	Tcl_WideInt seen = 0;
+	int bucket;
+
+	if (count == 0) {
+		return 0;
+	}
+
+	if (target < 1) {
+		target = 1;
+	}
+
+	for (bucket = 0; bucket < CASSTCL_STATS_BUCKETS; bucket++) {
+		seen += histogram[bucket];
+		if (seen >= target) {
+			Tcl_WideInt limit = casstcl_stats_bucket_limit (bucket);
+
+			return (limit < latencyMax) ? limit : latencyMax;
+		}
+	}
+
+	return latencyMax;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_kind_obj -- describe the statistics of one kind
+ *   of request
+ *
+ * Results:
+ *      A new list of key-value pairs.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static Tcl_Obj *
+casstcl_stats_kind_obj (casstcl_requestStats *stats)
+{
+	Tcl_Obj *listObj = Tcl_NewObj ();
+	Tcl_WideInt *histogram;
+	Tcl_WideInt completed = 0;
+	Tcl_WideInt latencyMax;
+	Tcl_WideInt latencyTotal;
+	int bucket;
+	int i;
+
+	static CONST char *percentileNames[] = {
+		"p50_us",
+		"p90_us",
+		"p99_us",
+		"p999_us"
+	};
+	static double percentiles[] = {0.5, 0.9, 0.99, 0.999};
+
+	// take the histogram first so that the percentiles are all worked
+	// out from the same counts
+	histogram = (Tcl_WideInt *)ckalloc (sizeof (Tcl_WideInt) * CASSTCL_STATS_BUCKETS);
+	for (bucket = 0; bucket < CASSTCL_STATS_BUCKETS; bucket++) {
+		histogram[bucket] = __atomic_load_n (&stats->histogram[bucket], __ATOMIC_RELAXED);
+		completed += histogram[bucket];
+	}
+	latencyMax = __atomic_load_n (&stats->latencyMax, __ATOMIC_RELAXED);
+	latencyTotal = __atomic_load_n (&stats->latencyTotal, __ATOMIC_RELAXED);
+
+	CASSTCL_STATS_APPEND ("requests", Tcl_NewWideIntObj (__atomic_load_n (&stats->requests, __ATOMIC_RELAXED)));
+	CASSTCL_STATS_APPEND ("completed", Tcl_NewWideIntObj (completed));
+	CASSTCL_STATS_APPEND ("errors", Tcl_NewWideIntObj (__atomic_load_n (&stats->errors, __ATOMIC_RELAXED)));
+	CASSTCL_STATS_APPEND ("lib_errors", Tcl_NewWideIntObj (__atomic_load_n (&stats->sourceErrors[CASS_ERROR_SOURCE_LIB], __ATOMIC_RELAXED)));
+	CASSTCL_STATS_APPEND ("server_errors", Tcl_NewWideIntObj (__atomic_load_n (&stats->sourceErrors[CASS_ERROR_SOURCE_SERVER], __ATOMIC_RELAXED)));
+	CASSTCL_STATS_APPEND ("ssl_errors", Tcl_NewWideIntObj (__atomic_load_n (&stats->sourceErrors[CASS_ERROR_SOURCE_SSL], __ATOMIC_RELAXED)));
+	CASSTCL_STATS_APPEND ("timeouts", Tcl_NewWideIntObj (__atomic_load_n (&stats->timeouts, __ATOMIC_RELAXED)));
+	CASSTCL_STATS_APPEND ("unavailable", Tcl_NewWideIntObj (__atomic_load_n (&stats->unavailable, __ATOMIC_RELAXED)));
+	CASSTCL_STATS_APPEND ("in_flight", Tcl_NewIntObj (__atomic_load_n (&stats->inFlight, __ATOMIC_ACQUIRE)));
+	CASSTCL_STATS_APPEND ("peak_in_flight", Tcl_NewIntObj (stats->peakInFlight));
+	CASSTCL_STATS_APPEND ("mean_us", Tcl_NewWideIntObj ((completed > 0) ? latencyTotal / completed : 0));
+	CASSTCL_STATS_APPEND ("max_us", Tcl_NewWideIntObj (latencyMax));
+
+	for (i = 0; i < 4; i++) {
+		CASSTCL_STATS_APPEND (percentileNames[i], Tcl_NewWideIntObj (casstcl_stats_percentile (histogram, completed, latencyMax, percentiles[i])));
+	}
+
+	ckfree ((char *)histogram);
+	return listObj;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_driver_obj -- describe the driver's own metrics
+ *   for a session
+ *
+ * Results:
+ *      A new list of key-value pairs.  The latencies are the
+ *      driver's, in microseconds, and the rates are requests per
+ *      second.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+static Tcl_Obj *
+casstcl_stats_driver_obj (casstcl_sessionClientData *ct)
+{
+	Tcl_Obj *listObj = Tcl_NewObj ();
+	CassMetrics metrics;
+
+	cass_session_get_metrics (ct->session, &metrics);
+
+	CASSTCL_STATS_APPEND ("min_us", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.requests.min));
+	CASSTCL_STATS_APPEND ("max_us", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.requests.max));
+	CASSTCL_STATS_APPEND ("mean_us", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.requests.mean));
+	CASSTCL_STATS_APPEND ("stddev_us", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.requests.stddev));
+	CASSTCL_STATS_APPEND ("p50_us", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.requests.median));
+	CASSTCL_STATS_APPEND ("p75_us", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.requests.percentile_75th));
+	CASSTCL_STATS_APPEND ("p95_us", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.requests.percentile_95th));
+	CASSTCL_STATS_APPEND ("p98_us", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.requests.percentile_98th));
+	CASSTCL_STATS_APPEND ("p99_us", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.requests.percentile_99th));
+	CASSTCL_STATS_APPEND ("p999_us", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.requests.percentile_999th));
+	CASSTCL_STATS_APPEND ("mean_rate", Tcl_NewDoubleObj (metrics.requests.mean_rate));
+	CASSTCL_STATS_APPEND ("one_minute_rate", Tcl_NewDoubleObj (metrics.requests.one_minute_rate));
+	CASSTCL_STATS_APPEND ("five_minute_rate", Tcl_NewDoubleObj (metrics.requests.five_minute_rate));
+	CASSTCL_STATS_APPEND ("fifteen_minute_rate", Tcl_NewDoubleObj (metrics.requests.fifteen_minute_rate));
+	CASSTCL_STATS_APPEND ("total_connections", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.stats.total_connections));
+	CASSTCL_STATS_APPEND ("available_connections", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.stats.available_connections));
+	CASSTCL_STATS_APPEND ("exceeded_pending_requests_water_mark", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.stats.exceeded_pending_requests_water_mark));
+	CASSTCL_STATS_APPEND ("exceeded_write_bytes_water_mark", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.stats.exceeded_write_bytes_water_mark));
+	CASSTCL_STATS_APPEND ("connection_timeouts", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.errors.connection_timeouts));
+	CASSTCL_STATS_APPEND ("pending_request_timeouts", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.errors.pending_request_timeouts));
+	CASSTCL_STATS_APPEND ("request_timeouts", Tcl_NewWideIntObj ((Tcl_WideInt)metrics.errors.request_timeouts));
+
+	return listObj;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_obj -- describe the request statistics of a
+ *   session
+ *
+ * Results:
+ *      A new list of key-value pairs: for each of exec, async,
+ *      select, batch and counter, a list of its counters and latencies,
+ *      for paging, what adaptive paging has done, and for driver,
+ *      the driver's own metrics.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *
+casstcl_stats_obj (casstcl_sessionClientData *ct)
+{
+	Tcl_Obj *listObj = Tcl_NewObj ();
+	int kind;
+
+	for (kind = 0; kind < CASSTCL_STATS_KINDS; kind++) {
+		CASSTCL_STATS_APPEND (casstcl_stats_kind_names[kind], casstcl_stats_kind_obj (&ct->requestStats[kind]));
+	}
+
+	CASSTCL_STATS_APPEND ("paging", casstcl_paging_stats_obj (ct));
+	CASSTCL_STATS_APPEND ("driver", casstcl_stats_driver_obj (ct));
+	return listObj;
+}
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
@@ -0,0 +1,178 @@
+/*
+ *
+ * Include file for casstcl_stats
+ *
+ * Copyright (C) 2015 by FlightAware, All Rights Reserved
+ *
+ * Freely redistributable under the Berkeley copyright, see license.terms
+ * for details.
+ */
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_init -- set up the request statistics of a new
+ *   session, with everything zero
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_stats_init (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_reset -- clear the request statistics of a
+ *   session
+ *
+ *   The in-flight gauges are kept, since the requests that are
+ *   outstanding will still be counted out when they complete.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_stats_reset (casstcl_sessionClientData *ct);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_start -- count a request that is being handed
+ *   to the driver and start timing it
+ *
+ *   A timer of kind CASSTCL_STATS_NONE is set up to not count
+ *   anything, for requests that are recorded elsewhere or not
+ *   at all.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The timer is filled in.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_stats_start (casstcl_sessionClientData *ct, int kind, casstcl_requestTimer *timer);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_finish -- record a request that has completed
+ *
+ *   This may be called from the driver's threads.  The request is
+ *   also offered to the slow request log, which looks for its
+ *   tracing id in future, if that isn't NULL, and the upserts it
+ *   made are no longer in flight for the row cache.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The timer is set to CASSTCL_STATS_NONE, so that the request
+ *      can't be counted twice.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_stats_finish (casstcl_requestTimer *timer, CassFuture *future, CassError rc);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_discard -- let go of what a timer holds for a
+ *   request that was never executed, or isn't counted
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The timer's slow request log entry is freed and its writes
+ *      are finished.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_stats_discard (casstcl_requestTimer *timer);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_timer_copy -- copy a timer for a driver
+ *   callback to finish when the request completes
+ *
+ *   This is for requests whose future may be gone before the
+ *   request completes, so that the timer can't live in it.
+ *
+ * Results:
+ *      A new timer, which casstcl_stats_timer_callback frees.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+casstcl_requestTimer *casstcl_stats_timer_copy (casstcl_requestTimer *timer);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_timer_callback -- record a request whose future
+ *   nobody is waiting for as it completes
+ *
+ *   This is called from the driver's threads with a copy made
+ *   by casstcl_stats_timer_copy.  As well as being recorded, the
+ *   request is taken out of the session's in-flight window.
+ *
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      The timer is freed.
+ *
+ *--------------------------------------------------------------
+ */
+void casstcl_stats_timer_callback (CassFuture* future, void* data);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_kind_name -- the name of a kind of request, as
+ *   used in the statistics
+ *
+ * Results:
+ *      The name, or "none" for CASSTCL_STATS_NONE.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+const char *casstcl_stats_kind_name (int kind);
+
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_stats_obj -- describe the request statistics of a
+ *   session
+ *
+ * Results:
+ *      A new list of key-value pairs: for each of exec, async,
+ *      select, batch and counter, a list of its counters and latencies,
+ *      for paging, what adaptive paging has done, and for driver,
+ *      the driver's own metrics.
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+Tcl_Obj *casstcl_stats_obj (casstcl_sessionClientData *ct);
+
+/* vim: set ts=4 sw=4 sts=4 noet : */
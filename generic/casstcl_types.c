@@ -12,6 +12,8 @@
 #include "casstcl_types.h"
 #include "casstcl_error.h"
 #include "casstcl_consistency.h"
+#include "casstcl_schema.h"
+#include "casstcl_objtypes.h"
 
 #include <assert.h>
 
@@ -280,7 +282,10 @@ casstcl_string_to_cass_value_type (char *string) {
  *
  * casstcl_InitCassBytesFromBignum --
  *
- *  Allocate and initialize a CassBytes from a 'bignum'.
+ *  Allocate and initialize a CassBytes from a 'bignum', encoded the
+ *  way cassandra encodes a varint (and the unscaled value of a
+ *  decimal): big-endian two's complement in as few bytes as will
+ *  hold the sign.
  *
  * Results:
  *  A standard Tcl result.
@@ -299,12 +304,16 @@ casstcl_InitCassBytesFromBignum(
 {
     unsigned char *data;
     unsigned long outlen;
+    unsigned long i;
+    int negative = (a->sign == MP_NEG);
     int status;
 
+    // leave room in front for a sign byte
     outlen = TclBN_mp_unsigned_bin_size(a);
-    data = (cass_byte_t *) ckalloc(outlen);
+    data = (cass_byte_t *) ckalloc(outlen + 1);
+    data[0] = 0;
 
-    status = TclBN_mp_to_unsigned_bin_n(a, data, &outlen);
+    status = TclBN_mp_to_unsigned_bin_n(a, data + 1, &outlen);
 
     if (status != MP_OKAY) {
   if (interp != NULL) {
@@ -315,6 +324,25 @@ casstcl_InitCassBytesFromBignum(
   return TCL_ERROR;
     }
 
+    // negate the magnitude, the sign byte included
+    if (negative) {
+  int carry = 1;
+
+  for (i = outlen + 1; i-- > 0; ) {
+      int byte = (unsigned char)~data[i] + carry;
+
+      data[i] = (unsigned char)byte;
+      carry = byte >> 8;
+  }
+    }
+
+    // the sign byte is only needed if the top bit doesn't already say it
+    if (outlen > 0 && ((data[1] & 0x80) != 0) == negative) {
+  memmove(data, data + 1, outlen);
+    } else {
+  outlen++;
+    }
+
     v->data = data;
     v->size = outlen;
     return TCL_OK;
@@ -326,7 +354,8 @@ casstcl_InitCassBytesFromBignum(
  *
  * casstcl_InitBignumFromCassBytes --
  *
- *  Allocate and initialize a 'bignum' from a CassBytes.
+ *  Allocate and initialize a 'bignum' from a CassBytes holding a
+ *  varint, that is, a big-endian two's complement number.
  *
  * Results:
 * A standard Tcl result.
@@ -343,6 +372,8 @@ casstcl_InitBignumFromCassBytes(
     mp_int *a,      /* Bignum to initialize */
     CassBytes *v)   /* Initial value */
 {
+    int negative = (v->size > 0 && (v->data[0] & 0x80) != 0);
+    unsigned char *magnitude = NULL;
     int status = TclBN_mp_init(a);
 
     if (status != MP_OKAY) {
@@ -353,113 +384,38 @@ casstcl_InitBignumFromCassBytes(
   return TCL_ERROR;
     }
 
-    status = mp_read_unsigned_bin(a, v->data, v->size);
+    if (negative) {
+  cass_size_t i;
+  int carry = 1;
+
+  magnitude = (unsigned char *) ckalloc(v->size);
+  for (i = v->size; i-- > 0; ) {
+      int byte = (unsigned char)~v->data[i] + carry;
+
+      magnitude[i] = (unsigned char)byte;
+      carry = byte >> 8;
+  }
+  status = mp_read_unsigned_bin(a, magnitude, v->size);
+  ckfree((char *)magnitude);
+  if (status == MP_OKAY) {
+      status = TclBN_mp_neg(a, a);
+  }
+    } else {
+  status = mp_read_unsigned_bin(a, v->data, v->size);
+    }
 
     if (status != MP_OKAY) {
   if (interp != NULL) {
       Tcl_ResetResult(interp);
       Tcl_AppendResult(interp, "could not read bignum", NULL);
   }
+  TclBN_mp_clear(a);
   return TCL_ERROR;
     }
 
     return TCL_OK;
 }
 
-/*
- *----------------------------------------------------------------------
- *
- * casstcl_GetTimestampFromObj --
- *
- *  Accepts a Tcl object value that specifies a whole number of
- *  seconds and optionally a fractional number of seconds, and
- *  converts the value to the whole number of milliseconds.
- *
- * Results:
- *  A standard Tcl result.
- *
- * Side effects:
- *  None.
- *
- *----------------------------------------------------------------------
- */
-
-int
-casstcl_GetTimestampFromObj(
-    Tcl_Interp *interp,   /* Used for error reporting if not NULL. */
-    Tcl_Obj *objPtr,    /* Object from which to get milliseconds. */
-    cass_int64_t *milliseconds) /* Place to store whole milliseconds. */
-{
-  Tcl_WideInt wideVal;
-  if (Tcl_GetWideIntFromObj(NULL, objPtr, &wideVal) == TCL_OK) {
-    if (wideVal < CASS_TIMESTAMP_LOWER_LIMIT ||
-            wideVal > CASS_TIMESTAMP_UPPER_LIMIT) {
-      if (interp != NULL) {
-        Tcl_ResetResult(interp);
-        Tcl_AppendResult(interp, "whole seconds cannot exceed ",
-            STRINGIFY(CASS_TIMESTAMP_UPPER_LIMIT), NULL);
-      }
-      return TCL_ERROR;
-    } else {
-      *milliseconds = wideVal * 1000; /* SAFE: See 'if' above. */
-    }
-  } else {
-    double doubleVal;
-    if (Tcl_GetDoubleFromObj(interp, objPtr, &doubleVal) == TCL_OK) {
-      if ((Tcl_WideInt)doubleVal < CASS_TIMESTAMP_LOWER_LIMIT ||
-              (Tcl_WideInt)doubleVal > CASS_TIMESTAMP_UPPER_LIMIT) {
-        if (interp != NULL) {
-          Tcl_ResetResult(interp);
-          Tcl_AppendResult(interp, "whole seconds cannot exceed ",
-              STRINGIFY(CASS_TIMESTAMP_UPPER_LIMIT), NULL);
-        }
-        return TCL_ERROR;
-      } else {
-        wideVal = (Tcl_WideInt)doubleVal; /* SAFE: See 'if' above. */
-        doubleVal -= (double)wideVal;
-        doubleVal *= 1000.0;
-        *milliseconds = (wideVal * 1000) + (Tcl_WideInt)doubleVal;
-      }
-    } else {
-      return TCL_ERROR;
-    }
-  }
-  return TCL_OK;
-}
-
-/*
- *----------------------------------------------------------------------
- *
- * casstcl_NewTimestampObj --
- *
- *  Accepts a Cassandra 'timestamp' value, in milliseconds, and
- *  creates a Tcl object based on it.  If the milliseconds is
- *  evenly divisible by 1000, a Tcl wide integer object will be
- *  returned, containing the exact number of seconds.  Otherwise,
- *  a Tcl double object will be returned with an approximate value,
- *  where the fractional portion of the double will represent the
- *  milliseconds and the whole portion will represent the number
- *  of seconds.
- *
- * Results:
- *  The newly created Tcl object, having a reference count of zero.
- *
- * Side effects:
- *  None.
- *
- *----------------------------------------------------------------------
- */
-
-Tcl_Obj *casstcl_NewTimestampObj(
-  cass_int64_t milliseconds
-){
-  if((milliseconds % 1000) == 0) {
-    return Tcl_NewWideIntObj(milliseconds / 1000);
-  } else {
-    return Tcl_NewDoubleObj((double)milliseconds / 1000.0);
-  }
-}
-
 /*
  *----------------------------------------------------------------------
  *
@@ -519,8 +475,10 @@ int mp_read_unsigned_bin (mp_int * a, const unsigned char *b, int c)
  *
  * casstcl_typename_obj_to_cass_value_types --
  *
- *   Look up the validator in the column type map and decode it into
- *   three CassValueType entries, with extremely fast caching
+ *   Look up the column in the session's column type map and return its
+ *   type as three CassValueType entries.  Code binding several columns
+ *   of the same table should use casstcl_lookup_table once and then
+ *   casstcl_lookup_column_type for each column instead.
  *
  * Results:
  *      A standard Tcl result.
@@ -531,37 +489,10 @@ int mp_read_unsigned_bin (mp_int * a, const unsigned char *b, int c)
  *----------------------------------------------------------------------
  */
 int
-casstcl_typename_obj_to_cass_value_types (Tcl_Interp *interp, char *table, Tcl_Obj *typenameObj, casstcl_cassTypeInfo *typeInfoPtr) {
-  int varNameSize = 0;
-  char *varName = Tcl_GetStringFromObj (typenameObj, &varNameSize);
-  // add two bytes, one for a period and one for a null byte
-  int typeIndexSize = strlen (table) + 2 + varNameSize;
-  char *typeIndexName = ckalloc (typeIndexSize);
-
-  snprintf (typeIndexName, typeIndexSize, "%s.%s", table, varName);
-
-  Tcl_Obj *typeObj = Tcl_GetVar2Ex (interp, "::casstcl::columnTypeMap", typeIndexName, (TCL_GLOBAL_ONLY|TCL_LEAVE_ERR_MSG));
-
-  ckfree (typeIndexName);
-
-  // if not found, the type didn't exist, but it might not be an error,
-  // return TCL_CONTINUE to differentiate it from TCL_OK
-  if (typeObj == NULL) {
-    typeInfoPtr->cassValueType = CASS_VALUE_TYPE_UNKNOWN;
-    typeInfoPtr->valueSubType1 = CASS_VALUE_TYPE_UNKNOWN;
-    typeInfoPtr->valueSubType2 = CASS_VALUE_TYPE_UNKNOWN;
-    return TCL_CONTINUE;
-  }
-
-  if (Tcl_ConvertToType (interp, typeObj, &casstcl_cassTypeTclType) == TCL_ERROR) {
-    return TCL_ERROR;
-  }
+casstcl_typename_obj_to_cass_value_types (casstcl_sessionClientData *ct, char *table, Tcl_Obj *typenameObj, casstcl_cassTypeInfo *typeInfoPtr) {
+  casstcl_tableInfo *tableInfo = casstcl_lookup_table (ct, table);
 
-  casstcl_cassTypeInfo *typeInfo = (casstcl_cassTypeInfo *)&typeObj->internalRep.otherValuePtr;
-  *typeInfoPtr = *typeInfo; // structure copy
-
-// printf("casstcl_typename_obj_to_cass_value_types took table '%s' type '%s' and produced %x, %x, %x\n", table, Tcl_GetString (typenameObj), *valueType, *valueSubType1, *valueSubType2);
-  return TCL_OK;
+  return casstcl_lookup_column_type (ct->interp, tableInfo, typenameObj, typeInfoPtr);
 }
 
 
@@ -575,6 +506,10 @@ casstcl_typename_obj_to_cass_value_types (Tcl_Interp *interp, char *table, Tcl_O
  *
  *      This is a vital routine to the entire edifice.
  *
+ *      Blobs at least as long as the session's blob_references size
+ *      refer to the result being converted, ct->blobSource, instead
+ *      of being copied out of it.
+ *
  * Results:
  *      A standard Tcl result.
  *
@@ -649,7 +584,14 @@ int casstcl_cass_value_to_tcl_obj (casstcl_sessionClientData *ct, const CassValu
       CassBytes bytes;
 
       cass_value_get_bytes(cassValue, &bytes.data, &bytes.size);
-      *tclObj = Tcl_NewByteArrayObj (bytes.data, bytes.size);
+
+      // big blobs can be left where they are in the result, which
+      // the object then keeps alive, rather than being copied
+      if (ct->blobSource != NULL && ct->blobRefMinimum > 0 && bytes.size >= (size_t)ct->blobRefMinimum) {
+        *tclObj = casstcl_NewBlobRefObj (ct->blobSource, bytes.data, bytes.size);
+      } else {
+        *tclObj = Tcl_NewByteArrayObj (bytes.data, bytes.size);
+      }
       return TCL_OK;
     }
 
@@ -736,7 +678,6 @@ int casstcl_cass_value_to_tcl_obj (casstcl_sessionClientData *ct, const CassValu
     case CASS_VALUE_TYPE_TIMEUUID: {
       CassUuid key;
       CassError cassError;
-      char key_str[CASS_UUID_STRING_LENGTH];
 
       cassError = cass_value_get_uuid(cassValue, &key);
 
@@ -744,17 +685,22 @@ int casstcl_cass_value_to_tcl_obj (casstcl_sessionClientData *ct, const CassValu
         return casstcl_cass_error_to_tcl (ct, cassError);
       }
 
-      cass_uuid_string(key, key_str);
-      *tclObj = Tcl_NewStringObj (key_str, CASS_UUID_STRING_LENGTH - 1);
+      *tclObj = casstcl_NewUuidObj (key);
       return TCL_OK;
     }
 
     case CASS_VALUE_TYPE_VARINT: {
-      Tcl_ResetResult(interp);
-      Tcl_AppendResult(interp, "unsupported value type for get operation 'varint'", NULL);
+      mp_int mpVal;
+      CassBytes bytes;
 
-      *tclObj = NULL;
-      return TCL_ERROR;
+      cass_value_get_bytes(cassValue, &bytes.data, &bytes.size);
+
+      if (casstcl_InitBignumFromCassBytes(interp, &mpVal, &bytes) != TCL_OK) {
+        return TCL_ERROR;
+      }
+
+      *tclObj = Tcl_NewBignumObj(&mpVal);
+      return TCL_OK;
     }
 
 	case CASS_VALUE_TYPE_UDT: {
@@ -782,21 +728,14 @@ int casstcl_cass_value_to_tcl_obj (casstcl_sessionClientData *ct, const CassValu
     case CASS_VALUE_TYPE_INET: {
       CassError cassError;
       CassInet cassInet;
-      char addrBuf[INET6_ADDRSTRLEN];
-      int isIpV6;
 
-      assert(INET6_ADDRSTRLEN >= INET_ADDRSTRLEN);
       cassError = cass_value_get_inet (cassValue, &cassInet);
 
       if (cassError != CASS_OK) {
         return casstcl_cass_error_to_tcl (ct, cassError);
       }
 
-      isIpV6 = (cassInet.address_length == CASS_INET_V6_LENGTH);
-      memset(addrBuf, 0, INET6_ADDRSTRLEN);
-      inet_ntop(isIpV6 ? AF_INET6 : AF_INET, cassInet.address, addrBuf, INET6_ADDRSTRLEN);
-
-      *tclObj = Tcl_NewStringObj(addrBuf, -1);
+      *tclObj = casstcl_NewInetObj (cassInet);
       return TCL_OK;
     }
 
@@ -866,70 +805,6 @@ int casstcl_cass_value_to_tcl_obj (casstcl_sessionClientData *ct, const CassValu
 }
 
 
-/*
- *----------------------------------------------------------------------
- *
- * casstcl_GetInetFromObj --
- *
- *  Attempt to return an Inet from the Tcl object "objPtr".
- *
- * Results:
- *  A standard Tcl result.
- *
- * Side effects:
- *  None.
- *
- *----------------------------------------------------------------------
- */
-
-int
-casstcl_GetInetFromObj(
-    Tcl_Interp *interp, /* Used for error reporting if not NULL. */
-    Tcl_Obj *objPtr,  /* The object from which to get an Inet. */
-    CassInet *inetPtr)  /* Place to store resulting Inet. */
-{
-  const char *value = Tcl_GetString(objPtr);
-  struct addrinfo hints;
-  struct addrinfo *result = NULL;
-  int rc;
-
-  memset(&hints, 0, sizeof(struct addrinfo));
-  hints.ai_flags = AI_NUMERICHOST;
-  hints.ai_family = AF_UNSPEC;
-  hints.ai_socktype = SOCK_STREAM;
-  rc = getaddrinfo(value, NULL, &hints, &result);
-
-  if (rc == 0) {
-#if 0
-    casstcl_DumpAddrInfo(stdout, result, 0);
-#endif
-    assert(result != NULL);
-    assert(result->ai_addrlen >= 0);
-    assert(result->ai_addrlen <= CASS_INET_V6_LENGTH);
-    memset(inetPtr, 0, sizeof(CassInet));
-    if (result->ai_family == AF_INET) {
-      struct sockaddr_in *pSockAddr = (struct sockaddr_in *)result->ai_addr;
-      *inetPtr = cass_inet_init_v4((const cass_uint8_t *)&pSockAddr->sin_addr.s_addr);
-      freeaddrinfo(result);
-      return TCL_OK;
-    } else if (result->ai_family == AF_INET6) {
-      struct sockaddr_in6 *pSockAddr = (struct sockaddr_in6 *)result->ai_addr;
-      *inetPtr = cass_inet_init_v6((const cass_uint8_t *)&pSockAddr->sin6_addr.s6_addr);
-      freeaddrinfo(result);
-      return TCL_OK;
-    } else {
-      Tcl_ResetResult(interp);
-      Tcl_AppendResult(interp, "address \"", value, "\" is not IPv4 or IPv6", NULL);
-      freeaddrinfo(result);
-      return TCL_ERROR;
-    }
-  } else {
-    Tcl_ResetResult(interp);
-    Tcl_AppendResult(interp, gai_strerror(rc), NULL);
-    return TCL_ERROR;
-  }
-}
-
 /*
  *--------------------------------------------------------------
  *
@@ -1074,6 +949,7 @@ casstcl_bind_names_from_array (casstcl_sessionClientData *ct, char *table, char
   Tcl_Interp *interp = ct->interp;
 
   casstcl_cassTypeInfo typeInfo;
+  casstcl_tableInfo *tableInfo = casstcl_lookup_table (ct, table);
 
   *statementPtr = NULL;
 
@@ -1084,7 +960,7 @@ casstcl_bind_names_from_array (casstcl_sessionClientData *ct, char *table, char
   }
 
   for (i = 0; i < objc; i ++) {
-    tclReturn = casstcl_typename_obj_to_cass_value_types (interp, table, objv[i], &typeInfo);
+    tclReturn = casstcl_lookup_column_type (interp, tableInfo, objv[i], &typeInfo);
 
     if (tclReturn == TCL_ERROR) {
       masterReturn = TCL_ERROR;
@@ -1152,6 +1028,7 @@ casstcl_bind_names_from_list (casstcl_sessionClientData *ct, char *table, char *
   Tcl_Interp *interp = ct->interp;
 
   casstcl_cassTypeInfo typeInfo;
+  casstcl_tableInfo *tableInfo = casstcl_lookup_table (ct, table);
 
   *statementPtr = NULL;
 
@@ -1162,7 +1039,7 @@ casstcl_bind_names_from_list (casstcl_sessionClientData *ct, char *table, char *
   }
 
   for (i = 0; i < objc; i += 2) {
-    tclReturn = casstcl_typename_obj_to_cass_value_types (interp, table, objv[i], &typeInfo);
+    tclReturn = casstcl_lookup_column_type (interp, tableInfo, objv[i], &typeInfo);
 
     if (tclReturn == TCL_ERROR) {
       masterReturn = TCL_ERROR;
@@ -1292,182 +1169,457 @@ void UpdateCassTypeString (Tcl_Obj *obj) {
 /*
  *----------------------------------------------------------------------
  *
- * casstcl_append_tcl_obj_to_collection
- *
- * Convert a Tcl object to a cassandra value of the specified type and
- * append it to the specified collection
- *
- * This is used for constructing cassandra maps, sets and lists.
- *
- * You create a set or a list by appending elements to it.
+ * casstcl_GetDecimalFromObj --
  *
- * You create a map by appending successions of key elements and value
- * elements to it.
+ *  Get the scale and the unscaled value of a decimal, encoded as a
+ *  varint, from a Tcl object holding a list of the two, as returned
+ *  for decimal columns.
  *
- * They have a specified datatype for sets and lists; for keys there is
- * one for the key and one for the value so for instance the keys can
- * be integers and the values can be strings or whatever.
+ *  The bytes are ckalloc'ed and must be freed by the caller.
  *
  * Results:
- *      A standard Tcl result.
- *
+ *  A standard Tcl result.
  *
  *----------------------------------------------------------------------
  */
-int casstcl_append_tcl_obj_to_collection (casstcl_sessionClientData *ct, CassCollection *collection, CassValueType valueType, Tcl_Obj *obj) {
-  CassError cassError = CASS_OK;
-  Tcl_Interp *interp = ct->interp;
-
-  switch (valueType) {
-    case CASS_VALUE_TYPE_ASCII:
-    case CASS_VALUE_TYPE_TEXT:
-    case CASS_VALUE_TYPE_VARCHAR: {
-      int length = 0;
-      char *value = Tcl_GetStringFromObj (obj, &length);
+int
+casstcl_GetDecimalFromObj (Tcl_Interp *interp, Tcl_Obj *obj, CassDecimal *decimalPtr)
+{
+  int listObjc;
+  Tcl_Obj **listObjv;
+  int scale;
+  mp_int mpVal;
+  int tclReturn;
 
-      cassError = cass_collection_append_string_n (collection, value, length);
-      break;
-    }
+  if (Tcl_ListObjGetElements (interp, obj, &listObjc, &listObjv) == TCL_ERROR) {
+    Tcl_AppendResult (interp, " while getting decimal elements", NULL);
+    return TCL_ERROR;
+  }
 
-    case CASS_VALUE_TYPE_VARINT: {
-      Tcl_ResetResult(interp);
-      Tcl_AppendResult(interp, "unsupported value type for append operation 'varint'", NULL);
-      return TCL_ERROR;
-    }
+  if (listObjc != 2) {
+    Tcl_ResetResult(interp);
+    Tcl_AppendResult(interp, "decimal requires exactly two elements", NULL);
+    return TCL_ERROR;
+  }
 
-    case CASS_VALUE_TYPE_BLOB: {
-      int length = 0;
-      unsigned char *value = Tcl_GetByteArrayFromObj (obj, &length);
+  if (Tcl_GetIntFromObj(interp, listObjv[0], &scale) != TCL_OK) {
+    Tcl_AppendResult (interp, " while converting decimal scale", NULL);
+    return TCL_ERROR;
+  }
 
-      cassError = cass_collection_append_bytes (collection, value, length);
-      break;
-    }
+  if (Tcl_GetBignumFromObj(interp, listObjv[1], &mpVal) != TCL_OK) {
+    Tcl_AppendResult (interp, " while converting decimal bignum", NULL);
+    return TCL_ERROR;
+  }
 
-    case CASS_VALUE_TYPE_BOOLEAN: {
-      int value = 0;
+  tclReturn = casstcl_InitCassBytesFromBignum(interp, &decimalPtr->varint, &mpVal);
+  TclBN_mp_clear(&mpVal);
 
-      if (Tcl_GetBooleanFromObj (interp, obj, &value) == TCL_ERROR) {
-        Tcl_AppendResult (interp, " while converting boolean element", NULL);
-        return TCL_ERROR;
-      }
+  if (tclReturn != TCL_OK) {
+    Tcl_AppendResult (interp, " while creating decimal bytes", NULL);
+    return TCL_ERROR;
+  }
 
-      cassError = cass_collection_append_bool (collection, value);
-      break;
-    }
+  decimalPtr->scale = scale;
+  return TCL_OK;
+}
 
-    case CASS_VALUE_TYPE_TIMESTAMP: {
-      cass_int64_t wideValue = 0;
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_GetVarintFromObj --
+ *
+ *  Get a varint from a Tcl object holding an integer of any size.
+ *
+ *  The bytes are ckalloc'ed and must be freed by the caller.
+ *
+ * Results:
+ *  A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int
+casstcl_GetVarintFromObj (Tcl_Interp *interp, Tcl_Obj *obj, CassBytes *bytesPtr)
+{
+  mp_int mpVal;
+  int tclReturn;
 
-      if (casstcl_GetTimestampFromObj (interp, obj, &wideValue) == TCL_ERROR) {
-        Tcl_AppendResult (interp, " while converting 'timestamp' element", NULL);
-        return TCL_ERROR;
-      }
+  if (Tcl_GetBignumFromObj(interp, obj, &mpVal) != TCL_OK) {
+    Tcl_AppendResult (interp, " while converting varint element", NULL);
+    return TCL_ERROR;
+  }
 
-      cassError = cass_collection_append_int64 (collection, wideValue);
-      break;
-    }
+  tclReturn = casstcl_InitCassBytesFromBignum(interp, bytesPtr, &mpVal);
+  TclBN_mp_clear(&mpVal);
+  return tclReturn;
+}
 
-    case CASS_VALUE_TYPE_BIGINT:
-    case CASS_VALUE_TYPE_COUNTER: {
-      Tcl_WideInt wideValue = 0;
+//
+// collection element converters
+//
+// each of these converts a Tcl object to one cassandra type and appends
+// it to a collection.  a list, set or map is bound by looking up the
+// converter for its element (or key and value) type once and calling it
+// for every element, rather than going through the type switch each time.
+// they return a Tcl result, with any driver error already reported.
+//
 
-      if (Tcl_GetWideIntFromObj (interp, obj, &wideValue) == TCL_ERROR) {
-        Tcl_AppendResult (interp, " while converting wide int element", NULL);
-        return TCL_ERROR;
-      }
+static int
+casstcl_append_string (casstcl_sessionClientData *ct, CassCollection *collection, Tcl_Obj *obj)
+{
+  int length = 0;
+  char *value = Tcl_GetStringFromObj (obj, &length);
 
-      cassError = cass_collection_append_int64 (collection, wideValue);
-      break;
-    }
+  return casstcl_cass_error_to_tcl (ct, cass_collection_append_string_n (collection, value, length));
+}
 
+static int
+casstcl_append_blob (casstcl_sessionClientData *ct, CassCollection *collection, Tcl_Obj *obj)
+{
+  const cass_byte_t *value = NULL;
+  size_t length = 0;
 
-    case CASS_VALUE_TYPE_DOUBLE: {
-      double value = 0;
+  casstcl_GetBlobFromObj (obj, &value, &length);
+  return casstcl_cass_error_to_tcl (ct, cass_collection_append_bytes (collection, value, length));
+}
 
-      if (Tcl_GetDoubleFromObj (interp, obj, &value) == TCL_ERROR) {
-        Tcl_AppendResult (interp, " while converting double element", NULL);
-        return TCL_ERROR;
-      }
+static int
+casstcl_append_boolean (casstcl_sessionClientData *ct, CassCollection *collection, Tcl_Obj *obj)
+{
+  int value = 0;
 
-      cassError = cass_collection_append_double (collection, value);
-      break;
-    }
+  if (Tcl_GetBooleanFromObj (ct->interp, obj, &value) == TCL_ERROR) {
+    Tcl_AppendResult (ct->interp, " while converting boolean element", NULL);
+    return TCL_ERROR;
+  }
 
-    case CASS_VALUE_TYPE_FLOAT: {
-      double value = 0;
+  return casstcl_cass_error_to_tcl (ct, cass_collection_append_bool (collection, value));
+}
 
-      if (Tcl_GetDoubleFromObj (interp, obj, &value) == TCL_ERROR) {
-        Tcl_AppendResult (interp, " while converting float element", NULL);
-        return TCL_ERROR;
-      }
+static int
+casstcl_append_timestamp (casstcl_sessionClientData *ct, CassCollection *collection, Tcl_Obj *obj)
+{
+  cass_int64_t wideValue = 0;
 
-      cassError = cass_collection_append_float (collection, value);
-      break;
-    }
+  if (casstcl_GetTimestampFromObj (ct->interp, obj, &wideValue) == TCL_ERROR) {
+    Tcl_AppendResult (ct->interp, " while converting 'timestamp' element", NULL);
+    return TCL_ERROR;
+  }
 
-    case CASS_VALUE_TYPE_INT: {
-      int value = 0;
+  return casstcl_cass_error_to_tcl (ct, cass_collection_append_int64 (collection, wideValue));
+}
 
-      if (Tcl_GetIntFromObj (interp, obj, &value) == TCL_ERROR) {
-        Tcl_AppendResult (interp, " while converting int element", NULL);
-        return TCL_ERROR;
-      }
+static int
+casstcl_append_bigint (casstcl_sessionClientData *ct, CassCollection *collection, Tcl_Obj *obj)
+{
+  Tcl_WideInt wideValue = 0;
 
-      cassError = cass_collection_append_int32 (collection, value);
-      break;
-    }
+  if (Tcl_GetWideIntFromObj (ct->interp, obj, &wideValue) == TCL_ERROR) {
+    Tcl_AppendResult (ct->interp, " while converting wide int element", NULL);
+    return TCL_ERROR;
+  }
 
-    case CASS_VALUE_TYPE_TIMEUUID:
-    case CASS_VALUE_TYPE_UUID: {
-      CassUuid cassUuid;
+  return casstcl_cass_error_to_tcl (ct, cass_collection_append_int64 (collection, wideValue));
+}
 
-      cassError = cass_uuid_from_string(Tcl_GetString(obj), &cassUuid);
+static int
+casstcl_append_double (casstcl_sessionClientData *ct, CassCollection *collection, Tcl_Obj *obj)
+{
+  double value = 0;
 
-      if (cassError == CASS_OK) {
-        cassError = cass_collection_append_uuid (collection, cassUuid);
-      }
-      break;
-    }
+  if (Tcl_GetDoubleFromObj (ct->interp, obj, &value) == TCL_ERROR) {
+    Tcl_AppendResult (ct->interp, " while converting double element", NULL);
+    return TCL_ERROR;
+  }
 
-    case CASS_VALUE_TYPE_INET: {
-      CassInet cassInet;
-      cass_uint8_t address[CASS_INET_V6_LENGTH];
+  return casstcl_cass_error_to_tcl (ct, cass_collection_append_double (collection, value));
+}
 
-      if (casstcl_GetInetFromObj(interp, obj, &cassInet)) {
-        return TCL_ERROR;
-      }
+static int
+casstcl_append_float (casstcl_sessionClientData *ct, CassCollection *collection, Tcl_Obj *obj)
+{
+  double value = 0;
 
-      memcpy(address, cassInet.address, CASS_INET_V6_LENGTH);
+  if (Tcl_GetDoubleFromObj (ct->interp, obj, &value) == TCL_ERROR) {
+    Tcl_AppendResult (ct->interp, " while converting float element", NULL);
+    return TCL_ERROR;
+  }
 
-      if (cassInet.address_length == CASS_INET_V6_LENGTH) {
-        cassInet = cass_inet_init_v6(address);
-      } else if (cassInet.address_length == CASS_INET_V4_LENGTH) {
-        cassInet = cass_inet_init_v4(address);
-      } else {
-        Tcl_ResetResult(interp);
-        Tcl_AppendResult(interp, "bad 'inet' address length for bind operation", NULL);
-        return TCL_ERROR;
-      }
+  return casstcl_cass_error_to_tcl (ct, cass_collection_append_float (collection, value));
+}
+
+static int
+casstcl_append_int (casstcl_sessionClientData *ct, CassCollection *collection, Tcl_Obj *obj)
+{
+  int value = 0;
+
+  if (Tcl_GetIntFromObj (ct->interp, obj, &value) == TCL_ERROR) {
+    Tcl_AppendResult (ct->interp, " while converting int element", NULL);
+    return TCL_ERROR;
+  }
+
+  return casstcl_cass_error_to_tcl (ct, cass_collection_append_int32 (collection, value));
+}
+
+static int
+casstcl_append_uuid (casstcl_sessionClientData *ct, CassCollection *collection, Tcl_Obj *obj)
+{
+  CassUuid cassUuid;
+
+  // uuids fetched from cassandra or bound before aren't parsed again
+  if (casstcl_GetUuidFromObj (NULL, obj, &cassUuid) != TCL_OK) {
+    return casstcl_cass_error_to_tcl (ct, CASS_ERROR_LIB_BAD_PARAMS);
+  }
+
+  return casstcl_cass_error_to_tcl (ct, cass_collection_append_uuid (collection, cassUuid));
+}
+
+static int
+casstcl_append_inet (casstcl_sessionClientData *ct, CassCollection *collection, Tcl_Obj *obj)
+{
+  CassInet cassInet;
 
-      cassError = cass_collection_append_inet (collection, cassInet);
+  if (casstcl_GetInetFromObj(ct->interp, obj, &cassInet)) {
+    return TCL_ERROR;
+  }
+
+  if (cassInet.address_length != CASS_INET_V6_LENGTH && cassInet.address_length != CASS_INET_V4_LENGTH) {
+    Tcl_ResetResult(ct->interp);
+    Tcl_AppendResult(ct->interp, "bad 'inet' address length for bind operation", NULL);
+    return TCL_ERROR;
+  }
+
+  return casstcl_cass_error_to_tcl (ct, cass_collection_append_inet (collection, cassInet));
+}
+
+static int
+casstcl_append_decimal (casstcl_sessionClientData *ct, CassCollection *collection, Tcl_Obj *obj)
+{
+  CassDecimal cassDecimal;
+  CassError cassError;
+
+  if (casstcl_GetDecimalFromObj (ct->interp, obj, &cassDecimal) != TCL_OK) {
+    return TCL_ERROR;
+  }
+
+  cassError = cass_collection_append_decimal (collection, cassDecimal.varint.data, cassDecimal.varint.size, cassDecimal.scale);
+  ckfree((char *) cassDecimal.varint.data);
+  return casstcl_cass_error_to_tcl (ct, cassError);
+}
+
+static int
+casstcl_append_varint (casstcl_sessionClientData *ct, CassCollection *collection, Tcl_Obj *obj)
+{
+  CassBytes cassBytes;
+  CassError cassError;
+
+  if (casstcl_GetVarintFromObj (ct->interp, obj, &cassBytes) != TCL_OK) {
+    return TCL_ERROR;
+  }
+
+  cassError = cass_collection_append_bytes (collection, cassBytes.data, cassBytes.size);
+  ckfree((char *) cassBytes.data);
+  return casstcl_cass_error_to_tcl (ct, cassError);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_collection_append_proc --
+ *
+ *  Find the function that converts Tcl objects to the given type and
+ *  appends them to a collection.
+ *
+ * Results:
+ *  The function, or NULL if the type can't be an element of a
+ *  collection.
+ *
+ *----------------------------------------------------------------------
+ */
+casstcl_collectionAppendProc *
+casstcl_collection_append_proc (CassValueType valueType)
+{
+  switch (valueType) {
+    case CASS_VALUE_TYPE_ASCII:
+    case CASS_VALUE_TYPE_TEXT:
+    case CASS_VALUE_TYPE_VARCHAR:
+      return casstcl_append_string;
+
+    case CASS_VALUE_TYPE_BLOB:
+      return casstcl_append_blob;
+
+    case CASS_VALUE_TYPE_BOOLEAN:
+      return casstcl_append_boolean;
+
+    case CASS_VALUE_TYPE_TIMESTAMP:
+      return casstcl_append_timestamp;
+
+    case CASS_VALUE_TYPE_BIGINT:
+    case CASS_VALUE_TYPE_COUNTER:
+      return casstcl_append_bigint;
+
+    case CASS_VALUE_TYPE_DOUBLE:
+      return casstcl_append_double;
+
+    case CASS_VALUE_TYPE_FLOAT:
+      return casstcl_append_float;
+
+    case CASS_VALUE_TYPE_INT:
+      return casstcl_append_int;
+
+    case CASS_VALUE_TYPE_TIMEUUID:
+    case CASS_VALUE_TYPE_UUID:
+      return casstcl_append_uuid;
+
+    case CASS_VALUE_TYPE_INET:
+      return casstcl_append_inet;
+
+    case CASS_VALUE_TYPE_DECIMAL:
+      return casstcl_append_decimal;
+
+    case CASS_VALUE_TYPE_VARINT:
+      return casstcl_append_varint;
+
+    default:
+      return NULL;
+  }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_append_tcl_obj_to_collection
+ *
+ * Convert a Tcl object to a cassandra value of the specified type and
+ * append it to the specified collection
+ *
+ * This is used for constructing cassandra maps, sets and lists.
+ *
+ * You create a set or a list by appending elements to it.
+ *
+ * You create a map by appending successions of key elements and value
+ * elements to it.
+ *
+ * They have a specified datatype for sets and lists; for keys there is
+ * one for the key and one for the value so for instance the keys can
+ * be integers and the values can be strings or whatever.
+ *
+ * To append many elements of the same type, look up the converter once
+ * with casstcl_collection_append_proc instead.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_append_tcl_obj_to_collection (casstcl_sessionClientData *ct, CassCollection *collection, CassValueType valueType, Tcl_Obj *obj) {
+  casstcl_collectionAppendProc *appendProc = casstcl_collection_append_proc (valueType);
+
+  if (appendProc == NULL) {
+    char msg[60];
+
+    sprintf(msg, "%X", valueType);
+    Tcl_ResetResult(ct->interp);
+    Tcl_AppendResult(ct->interp, "unrecognized value type for append operation 0x", msg, NULL);
+    return TCL_ERROR;
+  }
+
+  return (*appendProc) (ct, collection, obj);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_bind_collection --
+ *
+ *  Convert a Tcl list to a cassandra list, set or map, as given by
+ *  the type info, and bind it to a statement by index or by name.
+ *
+ *  The element converters are looked up once for the whole list and
+ *  the collection is created with room for all of the elements.
+ *
+ * Results:
+ *  A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+static int
+casstcl_bind_collection (casstcl_sessionClientData *ct, CassStatement *statement, char *name, cass_size_t index, casstcl_cassTypeInfo *typeInfo, Tcl_Obj *obj)
+{
+  Tcl_Interp *interp = ct->interp;
+  casstcl_collectionAppendProc *keyProc;
+  casstcl_collectionAppendProc *valueProc = NULL;
+  CassCollectionType collectionType;
+  CassCollection *collection;
+  CassError cassError;
+  int tclReturn = TCL_OK;
+  int listObjc;
+  Tcl_Obj **listObjv;
+  int i;
+
+  switch (typeInfo->cassValueType) {
+    case CASS_VALUE_TYPE_SET:
+      collectionType = CASS_COLLECTION_TYPE_SET;
       break;
-    }
 
-    default: {
-      char msg[60];
+    case CASS_VALUE_TYPE_LIST:
+      collectionType = CASS_COLLECTION_TYPE_LIST;
+      break;
 
-      sprintf(msg, "%X", valueType);
-      Tcl_ResetResult(interp);
-      Tcl_AppendResult(interp, "unrecognized value type for append operation 0x", msg, NULL);
+    default:
+      collectionType = CASS_COLLECTION_TYPE_MAP;
+      break;
+  }
+
+  keyProc = casstcl_collection_append_proc (typeInfo->valueSubType1);
+  if (collectionType == CASS_COLLECTION_TYPE_MAP) {
+    valueProc = casstcl_collection_append_proc (typeInfo->valueSubType2);
+  }
+
+  if (keyProc == NULL || (collectionType == CASS_COLLECTION_TYPE_MAP && valueProc == NULL)) {
+    Tcl_ResetResult (interp);
+    Tcl_AppendResult (interp, "unsupported element type '", casstcl_cass_value_type_to_string ((keyProc == NULL) ? typeInfo->valueSubType1 : typeInfo->valueSubType2), "' for ", casstcl_cass_value_type_to_string (typeInfo->cassValueType), " bind operation", NULL);
+    return TCL_ERROR;
+  }
+
+  if (Tcl_ListObjGetElements (interp, obj, &listObjc, &listObjv) == TCL_ERROR) {
+    Tcl_AppendResult (interp, " while converting ", casstcl_cass_value_type_to_string (typeInfo->cassValueType), " element", NULL);
+    return TCL_ERROR;
+  }
+
+  if (collectionType == CASS_COLLECTION_TYPE_MAP) {
+    if (listObjc & 1) {
+      Tcl_ResetResult (interp);
+      Tcl_AppendResult (interp, "list must contain an even number of elements while converting map element", NULL);
       return TCL_ERROR;
     }
+
+    collection = cass_collection_new (collectionType, listObjc);
+    for (i = 0; i < listObjc && tclReturn == TCL_OK; i += 2) {
+      tclReturn = (*keyProc) (ct, collection, listObjv[i]);
+      if (tclReturn == TCL_OK) {
+        tclReturn = (*valueProc) (ct, collection, listObjv[i+1]);
+      }
+    }
+  } else {
+    collection = cass_collection_new (collectionType, listObjc);
+    for (i = 0; i < listObjc && tclReturn == TCL_OK; i++) {
+      tclReturn = (*keyProc) (ct, collection, listObjv[i]);
+    }
   }
 
-  if (cassError != CASS_OK) {
-    return casstcl_cass_error_to_tcl (ct, cassError);
+  if (tclReturn == TCL_OK) {
+    if (name == NULL) {
+      cassError = cass_statement_bind_collection (statement, index, collection);
+    } else {
+      cassError = cass_statement_bind_collection_by_name (statement, name, collection);
+    }
+    tclReturn = casstcl_cass_error_to_tcl (ct, cassError);
   }
 
-  return TCL_OK;
+  cass_collection_free (collection);
+  return tclReturn;
 }
 
 /*
@@ -1529,8 +1681,10 @@ int casstcl_bind_tcl_obj (casstcl_sessionClientData *ct, CassStatement *statemen
 
     case CASS_VALUE_TYPE_CUSTOM:
     case CASS_VALUE_TYPE_BLOB: {
-      int length = 0;
-      unsigned char *value = Tcl_GetByteArrayFromObj (obj, &length);
+      const cass_byte_t *value = NULL;
+      size_t length = 0;
+
+      casstcl_GetBlobFromObj (obj, &value, &length);
 
       if (name == NULL) {
         cassError = cass_statement_bind_bytes (statement, index, value, length);
@@ -1590,48 +1744,18 @@ int casstcl_bind_tcl_obj (casstcl_sessionClientData *ct, CassStatement *statemen
     }
 
     case CASS_VALUE_TYPE_DECIMAL: {
-      int listObjc;
-      Tcl_Obj **listObjv;
-      int scale;
-      mp_int mpVal;
-      CassBytes cassBytes;
       CassDecimal cassDecimal;
 
-      if (Tcl_ListObjGetElements (interp, obj, &listObjc, &listObjv) == TCL_ERROR) {
-        Tcl_AppendResult (interp, " while getting decimal elements", NULL);
+      if (casstcl_GetDecimalFromObj (interp, obj, &cassDecimal) != TCL_OK) {
         return TCL_ERROR;
       }
 
-      if (listObjc != 2) {
-        Tcl_ResetResult(interp);
-        Tcl_AppendResult(interp, "decimal requires exactly two elements", NULL);
-        return TCL_ERROR;
-      }
-
-      if (Tcl_GetIntFromObj(interp, listObjv[0], &scale) != TCL_OK) {
-        Tcl_AppendResult (interp, " while converting decimal scale", NULL);
-        return TCL_ERROR;
-      }
-
-      if (Tcl_GetBignumFromObj(interp, listObjv[1], &mpVal) != TCL_OK) {
-        Tcl_AppendResult (interp, " while converting decimal bignum", NULL);
-        return TCL_ERROR;
-      }
-
-      if (casstcl_InitCassBytesFromBignum(interp, &cassBytes, &mpVal) != TCL_OK) {
-        Tcl_AppendResult (interp, " while creating decimal bytes", NULL);
-        return TCL_ERROR;
-      }
-
-      cassDecimal.scale = scale;
-      cassDecimal.varint = cassBytes;
-
       if (name == NULL) {
         cassError = cass_statement_bind_decimal (statement, index, cassDecimal.varint.data, cassDecimal.varint.size, cassDecimal.scale);
       } else {
         cassError = cass_statement_bind_decimal_by_name (statement, name, cassDecimal.varint.data, cassDecimal.varint.size, cassDecimal.scale);
       }
-      ckfree((char *) cassBytes.data);
+      ckfree((char *) cassDecimal.varint.data);
       break;
     }
 
@@ -1687,7 +1811,8 @@ int casstcl_bind_tcl_obj (casstcl_sessionClientData *ct, CassStatement *statemen
     case CASS_VALUE_TYPE_TIMEUUID: {
       CassUuid cassUuid;
 
-      cassError = cass_uuid_from_string(Tcl_GetString(obj), &cassUuid);
+      // uuids fetched from cassandra or bound before aren't parsed again
+      cassError = (casstcl_GetUuidFromObj (NULL, obj, &cassUuid) == TCL_OK) ? CASS_OK : CASS_ERROR_LIB_BAD_PARAMS;
 
       if (cassError == CASS_OK) {
         if (name == NULL) {
@@ -1700,99 +1825,40 @@ int casstcl_bind_tcl_obj (casstcl_sessionClientData *ct, CassStatement *statemen
     }
 
     case CASS_VALUE_TYPE_VARINT: {
-      Tcl_ResetResult(interp);
-      Tcl_AppendResult(interp, "unsupported value type for bind operation 'varint'", NULL);
-      return TCL_ERROR;
-    }
-
-    case CASS_VALUE_TYPE_INET: {
-      CassInet cassInet;
+      CassBytes cassBytes;
 
-      if (casstcl_GetInetFromObj(interp, obj, &cassInet)) {
+      if (casstcl_GetVarintFromObj (interp, obj, &cassBytes) != TCL_OK) {
         return TCL_ERROR;
       }
 
       if (name == NULL) {
-        cassError = cass_statement_bind_inet (statement, index, cassInet);
+        cassError = cass_statement_bind_bytes (statement, index, cassBytes.data, cassBytes.size);
       } else {
-        cassError = cass_statement_bind_inet_by_name (statement, name, cassInet);
+        cassError = cass_statement_bind_bytes_by_name (statement, name, cassBytes.data, cassBytes.size);
       }
+      ckfree((char *) cassBytes.data);
       break;
     }
 
-    case CASS_VALUE_TYPE_SET:
-    case CASS_VALUE_TYPE_LIST: {
-      int listObjc;
-      Tcl_Obj **listObjv;
-      int i;
-
-      CassCollectionType collectionType = (typeInfo->cassValueType == CASS_VALUE_TYPE_SET) ? CASS_COLLECTION_TYPE_SET : CASS_COLLECTION_TYPE_LIST;
+    case CASS_VALUE_TYPE_INET: {
+      CassInet cassInet;
 
-      if (Tcl_ListObjGetElements (interp, obj, &listObjc, &listObjv) == TCL_ERROR) {
-        Tcl_AppendResult (interp, " while converting map element", NULL);
+      if (casstcl_GetInetFromObj(interp, obj, &cassInet)) {
         return TCL_ERROR;
       }
 
-      CassCollection *collection = cass_collection_new (collectionType, listObjc);
-
-      for (i = 0; i < listObjc; i++) {
-        cassError = casstcl_append_tcl_obj_to_collection (ct, collection, typeInfo->valueSubType1, listObjv[i]);
-        if (cassError != CASS_OK) {
-          break;
-        }
-      }
-
       if (name == NULL) {
-        cassError = cass_statement_bind_collection (statement, index, collection);
+        cassError = cass_statement_bind_inet (statement, index, cassInet);
       } else {
-        cassError = cass_statement_bind_collection_by_name (statement, name, collection);
+        cassError = cass_statement_bind_inet_by_name (statement, name, cassInet);
       }
-      cass_collection_free (collection);
-
       break;
     }
 
+    case CASS_VALUE_TYPE_SET:
+    case CASS_VALUE_TYPE_LIST:
     case CASS_VALUE_TYPE_MAP: {
-      int listObjc;
-      Tcl_Obj **listObjv;
-      int i;
-
-      if (Tcl_ListObjGetElements (interp, obj, &listObjc, &listObjv) == TCL_ERROR) {
-        Tcl_AppendResult (interp, " while converting map element", NULL);
-        return TCL_ERROR;
-      }
-
-      if (listObjc & 1) {
-        Tcl_ResetResult (interp);
-        Tcl_AppendResult (interp, "list must contain an even number of elements while converting map element", NULL);
-        return TCL_ERROR;
-      }
-
-// printf("map collection accumulation started, %d elements\n", listObjc);
-      CassCollection *collection = cass_collection_new (CASS_COLLECTION_TYPE_MAP, listObjc);
-
-      for (i = 0; i < listObjc; i += 2) {
-        cassError = casstcl_append_tcl_obj_to_collection (ct, collection, typeInfo->valueSubType1, listObjv[i]);
-        if (cassError != CASS_OK) {
-          break;
-        }
-
-        cassError = casstcl_append_tcl_obj_to_collection (ct, collection, typeInfo->valueSubType2, listObjv[i+1]);
-        if (cassError != CASS_OK) {
-          break;
-        }
-      }
-
-      if (name == NULL) {
-        cassError = cass_statement_bind_collection (statement, index, collection);
-      } else {
-        cassError = cass_statement_bind_collection_by_name (statement, name, collection);
-      }
-      cass_collection_free (collection);
-
-// printf("bound map collection of %d elements as to statement index %d\n", listObjc, index);
-
-      break;
+      return casstcl_bind_collection (ct, statement, name, index, typeInfo, obj);
     }
 
     default: {
@@ -1889,4 +1955,75 @@ casstcl_bind_values_and_types (casstcl_sessionClientData *ct, char *query, int o
 
 
 
+#ifdef CASSTCL_HAVE_SCHEMA_META
+/*
+ *--------------------------------------------------------------
+ *
+ * casstcl_data_type_to_type_obj -- given a data type of the
+ *   driver, such as that of a column or a prepared statement's
+ *   parameter, make the casstcl type of it
+ *
+ *   The type is spelled as a list of the type and any element
+ *   types, such as "map text bigint".  The cluster describes a
+ *   text column as varchar, which is spelled text.
+ *
+ * Results:
+ *      ...*typeObjPtr is set to a new object holding the type
+ *      ...TCL_OK is returned, with *typeInfo set, if casstcl can
+ *         bind values of the type, else TCL_ERROR, as for a UDT, a
+ *         tuple or a collection of collections
+ *
+ * Side effects:
+ *      None.
+ *
+ *--------------------------------------------------------------
+ */
+int
+casstcl_data_type_to_type_obj (const CassDataType *dataType, casstcl_cassTypeInfo *typeInfo, Tcl_Obj **typeObjPtr) {
+  CassValueType valueTypes[3];
+  int nTypes = 1;
+  int nWanted = 1;
+  int tclReturn = TCL_OK;
+  int i;
+
+  valueTypes[0] = cass_data_type_type (dataType);
+  if (valueTypes[0] == CASS_VALUE_TYPE_LIST || valueTypes[0] == CASS_VALUE_TYPE_SET) {
+    nWanted = 2;
+  } else if (valueTypes[0] == CASS_VALUE_TYPE_MAP) {
+    nWanted = 3;
+  } else if (valueTypes[0] == CASS_VALUE_TYPE_UNKNOWN || valueTypes[0] == CASS_VALUE_TYPE_CUSTOM || valueTypes[0] == CASS_VALUE_TYPE_UDT || valueTypes[0] == CASS_VALUE_TYPE_TUPLE) {
+    tclReturn = TCL_ERROR;
+  }
+
+  for (; nTypes < nWanted; nTypes++) {
+    const CassDataType *subDataType = cass_data_type_sub_data_type (dataType, nTypes - 1);
+
+    if (subDataType == NULL) {
+      tclReturn = TCL_ERROR;
+      break;
+    }
+
+    valueTypes[nTypes] = cass_data_type_type (subDataType);
+    if (valueTypes[nTypes] >= CASS_VALUE_TYPE_LIST || valueTypes[nTypes] == CASS_VALUE_TYPE_CUSTOM) {
+      tclReturn = TCL_ERROR;
+    }
+  }
+
+  *typeObjPtr = Tcl_NewObj ();
+  for (i = 0; i < nTypes; i++) {
+    if (valueTypes[i] == CASS_VALUE_TYPE_VARCHAR) {
+      valueTypes[i] = CASS_VALUE_TYPE_TEXT;
+    }
+    Tcl_ListObjAppendElement (NULL, *typeObjPtr, Tcl_NewStringObj (casstcl_cass_value_type_to_string (valueTypes[i]), -1));
+  }
+
+  if (tclReturn == TCL_OK) {
+    typeInfo->cassValueType = valueTypes[0];
+    typeInfo->valueSubType1 = (nTypes > 1) ? valueTypes[1] : CASS_VALUE_TYPE_UNKNOWN;
+    typeInfo->valueSubType2 = (nTypes > 2) ? valueTypes[2] : CASS_VALUE_TYPE_UNKNOWN;
+  }
+  return tclReturn;
+}
+#endif
+
 /* vim: set ts=4 sw=4 sts=4 noet : */
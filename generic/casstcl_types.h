@@ -97,56 +97,6 @@ casstcl_InitCassBytesFromBignum(
     CassBytes *v,		/* CassBytes to initialize */
     mp_int *a);			/* Initial value */
 
-/*
- *----------------------------------------------------------------------
- *
- * casstcl_GetTimestampFromObj --
- *
- *	Accepts a Tcl object value that specifies a whole number of
- *	seconds and optionally a fractional number of seconds, and
- *	converts the value to the whole number of milliseconds.
- *
- * Results:
- *	A standard Tcl result.
- *
- * Side effects:
- *	None.
- *
- *----------------------------------------------------------------------
- */
-
-int
-casstcl_GetTimestampFromObj(
-    Tcl_Interp *interp,		/* Used for error reporting if not NULL. */
-    Tcl_Obj *objPtr,		/* Object from which to get milliseconds. */
-    cass_int64_t *milliseconds);	/* Place to store whole milliseconds. */
-
-
-/*
- *----------------------------------------------------------------------
- *
- * casstcl_NewTimestampObj --
- *
- *	Accepts a Cassandra 'timestamp' value, in milliseconds, and
- *	creates a Tcl object based on it.  If the milliseconds is
- *	evenly divisible by 1000, a Tcl wide integer object will be
- *	returned, containing the exact number of seconds.  Otherwise,
- *	a Tcl double object will be returned with an approximate value,
- *	where the fractional portion of the double will represent the
- *	milliseconds and the whole portion will represent the number
- *	of seconds.
- *
- * Results:
- *	The newly created Tcl object, having a reference count of zero.
- *
- * Side effects:
- *	None.
- *
- *----------------------------------------------------------------------
- */
-
-Tcl_Obj *casstcl_NewTimestampObj(cass_int64_t milliseconds);
-
 /*
  *----------------------------------------------------------------------
  *
@@ -233,6 +183,40 @@ int casstcl_bind_names_from_array (
   CassConsistency *consistencyPtr, 
   CassStatement **statementPtr);
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_GetDecimalFromObj --
+ *
+ *  Get the scale and the unscaled value of a decimal, encoded as a
+ *  varint, from a Tcl object holding a list of the two, as returned
+ *  for decimal columns.
+ *
+ *  The bytes are ckalloc'ed and must be freed by the caller.
+ *
+ * Results:
+ *  A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_GetDecimalFromObj (Tcl_Interp *interp, Tcl_Obj *obj, CassDecimal *decimalPtr);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_GetVarintFromObj --
+ *
+ *  Get a varint from a Tcl object holding an integer of any size.
+ *
+ *  The bytes are ckalloc'ed and must be freed by the caller.
+ *
+ * Results:
+ *  A standard Tcl result.
+ *
+ *----------------------------------------------------------------------
+ */
+int casstcl_GetVarintFromObj (Tcl_Interp *interp, Tcl_Obj *obj, CassBytes *bytesPtr);
+
 /*
  *----------------------------------------------------------------------
  *
@@ -267,8 +251,10 @@ casstcl_bind_names_from_list (
  *
  * casstcl_typename_obj_to_cass_value_types --
  *
- *   Look up the validator in the column type map and decode it into
- *   three CassValueType entries, with extremely fast caching
+ *   Look up the column in the session's column type map and return its
+ *   type as three CassValueType entries.  Code binding several columns
+ *   of the same table should use casstcl_lookup_table once and then
+ *   casstcl_lookup_column_type for each column instead.
  *
  * Results:
  *      A standard Tcl result.
@@ -279,7 +265,7 @@ casstcl_bind_names_from_list (
  *----------------------------------------------------------------------
  */
 int casstcl_typename_obj_to_cass_value_types (
-  Tcl_Interp *interp, 
+  casstcl_sessionClientData *ct, 
   char *table, 
   Tcl_Obj *typenameObj, 
   casstcl_cassTypeInfo *typeInfoPtr);
@@ -295,6 +281,10 @@ int casstcl_typename_obj_to_cass_value_types (
  *
  *      This is a vital routine to the entire edifice.
  *
+ *      Blobs at least as long as the session's blob_references size
+ *      refer to the result being converted, ct->blobSource, instead
+ *      of being copied out of it.
+ *
  * Results:
  *      A standard Tcl result.
  *
@@ -307,6 +297,28 @@ int casstcl_cass_value_to_tcl_obj (
   const CassValue *cassValue, 
   Tcl_Obj **tclObj);
 
+/*
+ * A function that converts a Tcl object to one cassandra type and appends
+ * it to a collection, returning a standard Tcl result.
+ */
+typedef int (casstcl_collectionAppendProc) (casstcl_sessionClientData *ct, CassCollection *collection, Tcl_Obj *obj);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * casstcl_collection_append_proc --
+ *
+ *  Find the function that converts Tcl objects to the given type and
+ *  appends them to a collection.
+ *
+ * Results:
+ *  The function, or NULL if the type can't be an element of a
+ *  collection.
+ *
+ *----------------------------------------------------------------------
+ */
+casstcl_collectionAppendProc *casstcl_collection_append_proc (CassValueType valueType);
+
 /*
  *----------------------------------------------------------------------
  *
@@ -326,6 +338,9 @@ int casstcl_cass_value_to_tcl_obj (
  * one for the key and one for the value so for instance the keys can
  * be integers and the values can be strings or whatever.
  *
+ * To append many elements of the same type, look up the converter once
+ * with casstcl_collection_append_proc instead.
+ *
  * Results:
  *      A standard Tcl result.
  *
@@ -416,26 +431,31 @@ casstcl_bind_values_and_types (
   CassStatement **statementPtr);
 
 
+#ifdef CASSTCL_HAVE_SCHEMA_META
 /*
- *----------------------------------------------------------------------
+ *--------------------------------------------------------------
  *
- * casstcl_GetInetFromObj --
+ * casstcl_data_type_to_type_obj -- given a data type of the
+ *   driver, such as that of a column or a prepared statement's
+ *   parameter, make the casstcl type of it
  *
- *  Attempt to return an Inet from the Tcl object "objPtr".
+ *   The type is spelled as a list of the type and any element
+ *   types, such as "map text bigint".  The cluster describes a
+ *   text column as varchar, which is spelled text.
  *
  * Results:
- *  A standard Tcl result.
+ *      ...*typeObjPtr is set to a new object holding the type
+ *      ...TCL_OK is returned, with *typeInfo set, if casstcl can
+ *         bind values of the type, else TCL_ERROR, as for a UDT, a
+ *         tuple or a collection of collections
  *
  * Side effects:
- *  None.
+ *      None.
  *
- *----------------------------------------------------------------------
+ *--------------------------------------------------------------
  */
-
 int
-casstcl_GetInetFromObj(
-    Tcl_Interp *interp, /* Used for error reporting if not NULL. */
-    Tcl_Obj *objPtr,  /* The object from which to get an Inet. */
-    CassInet *inetPtr);  /* Place to store resulting Inet. */
+casstcl_data_type_to_type_obj (const CassDataType *dataType, casstcl_cassTypeInfo *typeInfo, Tcl_Obj **typeObjPtr);
+#endif
 
 /* vim: set ts=4 sw=4 sts=4 noet : */
@@ -10,6 +10,7 @@
 #include <tcl.h>
 #include <tclTomMath.h>
 #include "casstcl.h"
+#include "casstcl_bench.h"
 
 #undef TCL_STORAGE_CLASS
 #define TCL_STORAGE_CLASS DLLEXPORT
@@ -58,6 +59,11 @@ Casstcl_Init(Tcl_Interp *interp)
     }
 
 	Tcl_RegisterObjType(&casstcl_cassTypeTclType);
+	Tcl_RegisterObjType(&casstcl_futureHandleTclType);
+	Tcl_RegisterObjType(&casstcl_timestampTclType);
+	Tcl_RegisterObjType(&casstcl_uuidTclType);
+	Tcl_RegisterObjType(&casstcl_inetTclType);
+	Tcl_RegisterObjType(&casstcl_blobRefTclType);
 
     namespace = Tcl_CreateNamespace (interp, "::casstcl", NULL, NULL);
 
@@ -70,6 +76,41 @@ Casstcl_Init(Tcl_Interp *interp)
 }
 
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * Casstcl_bench_Init --
+ *
+ *	Add the command that times value conversions to an interpreter
+ *	that has casstcl, so that it isn't in every interpreter that
+ *	uses casstcl.  The benchmarks load it from the casstcl library
+ *	with "load $libraryFile Casstcl_bench".
+ *
+ * Results:
+ *	A standard Tcl result
+ *
+ * Side effects:
+ *	The command "::casstcl::benchmark" is added to the interpreter.
+ *
+ *----------------------------------------------------------------------
+ */
+
+EXTERN int
+Casstcl_bench_Init(Tcl_Interp *interp)
+{
+    if (Tcl_InitStubs(interp, "8.1", 0) == NULL) {
+		return TCL_ERROR;
+    }
+
+    if (Tcl_PkgRequire(interp, PACKAGE_NAME, PACKAGE_VERSION, 0) == NULL) {
+		return TCL_ERROR;
+    }
+
+    Tcl_CreateObjCommand(interp, "::casstcl::benchmark", (Tcl_ObjCmdProc *) casstcl_benchmarkObjCmd, (ClientData)NULL, (Tcl_CmdDeleteProc *)NULL);
+
+    return TCL_OK;
+}
+
 /*
  *----------------------------------------------------------------------
  *